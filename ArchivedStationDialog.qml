@@ -10,6 +10,7 @@
 
 import QtQuick 2.15
 import QtQuick.Controls 2.15
+import AirQuality 1.0
 
 /**
  * @class Window
@@ -51,7 +52,7 @@ Window {
      */
     Component.onCompleted: {
         console.log("ArchivedStationDialog otwarty z sensorami:", JSON.stringify(mainWindow.sensors))
-        console.log("ArchivedStationDialog otwarty z danymi sensorów:", JSON.stringify(mainWindow.sensorData))
+        console.log("ArchivedStationDialog otwarty z danymi sensorów:", JSON.stringify(mainWindow.sensorSeries.sensorIds()))
     }
 
     /**
@@ -148,7 +149,7 @@ Window {
                                 } else {
                                     delete selectedSensors[modelData.sensorId]
                                 }
-                                chartCanvas.requestPaint()
+                                sensorChart.sensorIds = Object.keys(selectedSensors).map(Number)
                             }
                         }
 
@@ -205,185 +206,131 @@ Window {
                 anchors.rightMargin: 20
 
                 /**
-                 * @brief Płótno do rysowania wykresu danych sensorów.
+                 * @brief Wykres danych sensorów rysowany w grafie sceny.
+                 *
+                 * Linie, siatka i osie rysowane są w C++; etykiety osi i podpowiedź po najechaniu myszą w QML.
                  */
-                Canvas {
-                    id: chartCanvas
+                SensorChart {
+                    id: sensorChart
                     anchors.fill: parent
                     anchors.margins: 50
+                    store: mainWindow.sensorSeries
+                    colors: dialog.colors
 
                     /**
-                     * @brief Rysuje wykres danych sensorów.
-                     *
-                     * Funkcja rysuje siatkę, osie, linie danych sensorów oraz etykiety osi i czasu.
+                     * @brief Komunikat wyświetlany, gdy brak danych do narysowania.
                      */
-                    onPaint: {
-                        var ctx = getContext("2d")
-                        ctx.clearRect(0, 0, width, height)
-                        ctx.strokeStyle = "black"
-                        ctx.lineWidth = 2
-                        ctx.font = "14px Arial"
-
-                        // Rysowanie siatki
-                        ctx.strokeStyle = "#d3d3d3"
-                        ctx.lineWidth = 1
-                        for (var x = 0; x <= width; x += width / 10) {
-                            ctx.beginPath()
-                            ctx.moveTo(x, 0)
-                            ctx.lineTo(x, height)
-                            ctx.stroke()
-                        }
-                        for (var y = 0; y <= height; y += height / 10) {
-                            ctx.beginPath()
-                            ctx.moveTo(0, y)
-                            ctx.lineTo(width, y)
-                            ctx.stroke()
-                        }
+                    Text {
+                        anchors.centerIn: parent
+                        visible: !sensorChart.hasData
+                        font.pixelSize: 14
+                        text: sensorChart.sensorIds.length === 0 ? "Wybierz mierzone parametry aby wyświetlić odczyty." : "Brak danych czasowych."
+                    }
 
-                        // Rysowanie osi
-                        ctx.strokeStyle = "black"
-                        ctx.lineWidth = 2
-                        ctx.beginPath()
-                        ctx.moveTo(0, height)
-                        ctx.lineTo(width, height)
-                        ctx.moveTo(0, 0)
-                        ctx.lineTo(0, height)
-                        ctx.stroke()
-
-                        var sensorData = mainWindow.sensorData
-                        var selectedSensorIds = Object.keys(selectedSensors)
-                        if (selectedSensorIds.length === 0 || Object.keys(sensorData).length === 0) {
-                            ctx.fillText("Wybierz mierzone parametry aby wyświetlić odczyty.", width / 2 - 150, height / 2)
-                            return
+                    /**
+                     * @brief Etykiety osi wartości.
+                     */
+                    Repeater {
+                        model: sensorChart.hasData ? 6 : 0
+                        Text {
+                            x: 10
+                            y: sensorChart.height - index * sensorChart.height / 5 - height - 5
+                            font.pixelSize: 14
+                            text: (sensorChart.minValue + index * (sensorChart.maxValue - sensorChart.minValue) / 5).toFixed(1)
                         }
+                    }
 
-                        // Obliczanie wartości min i max oraz zbieranie punktów czasu
-                        var globalMaxValue = -Number.MAX_VALUE
-                        var globalMinValue = Number.MAX_VALUE
-                        var allDataPoints = []
-                        var timePoints = []
-
-                        for (var i = 0; i < selectedSensorIds.length; i++) {
-                            var sensorId = selectedSensorIds[i]
-                            var data = sensorData[sensorId]
-                            if (!data) {
-                                console.log("Brak danych dla sensora:", sensorId)
-                                continue
-                            }
-
-                            for (var j = 0; j < data.length; j++) {
-                                var value = data[j].value
-                                if (value !== null && !isNaN(value)) {
-                                    globalMaxValue = Math.max(globalMaxValue, value)
-                                    globalMinValue = Math.min(globalMinValue, value)
-                                }
-                                if (i === 0) {
-                                    timePoints.push(data[j].date)
-                                }
-                            }
-                            allDataPoints.push(data)
+                    /**
+                     * @brief Etykiety osi czasu: godziny (co 4 godziny lub rzadziej) i daty pod liniami północy.
+                     */
+                    Repeater {
+                        model: sensorChart.timeTicks
+                        Text {
+                            x: modelData.isDate ? modelData.x - 20 : modelData.x
+                            y: sensorChart.height - (modelData.isDate ? 5 : 10) - height
+                            transformOrigin: Item.BottomLeft
+                            rotation: modelData.isDate ? 0 : -45
+                            font.pixelSize: 14
+                            text: modelData.label
                         }
+                    }
 
-                        console.log("Punkty czasowe:", timePoints.length, "Minimalna wartość:", globalMinValue, "Maksymalna wartość:", globalMaxValue, "Wybrane sensory:", selectedSensorIds)
+                    /**
+                     * @brief Podpis osi czasu z rozdzielczością linii (długie szeregi rysowane są ze średnich).
+                     */
+                    Text {
+                        x: sensorChart.width / 2
+                        y: sensorChart.height + 45
+                        font.pixelSize: 14
+                        text: ["Czas", "Czas (średnie dobowe)", "Czas (średnie miesięczne)"][sensorChart.resolution]
+                    }
 
-                        if (globalMaxValue === globalMinValue) {
-                            globalMaxValue += 1
-                            globalMinValue -= 1
-                        }
-                        if (timePoints.length === 0) {
-                            ctx.fillText("Brak danych czasowych.", width / 2 - 100, height / 2)
-                            return
-                        }
+                    /**
+                     * @brief Podpis osi wartości.
+                     */
+                    Text {
+                        x: 50
+                        y: sensorChart.height / 2
+                        transformOrigin: Item.TopLeft
+                        rotation: -90
+                        font.pixelSize: 14
+                        text: "Wartość (µg/m³)"
+                    }
 
-                        // Rysowanie przerywanych linii dla północy
-                        ctx.strokeStyle = "black"
-                        ctx.lineWidth = 1
-                        ctx.setLineDash([5, 5])
-                        for (var i = 0; i < timePoints.length; i++) {
-                            var time = timePoints[i].split(" ")[1]
-                            if (time === "00:00:00") {
-                                var x = ((timePoints.length - 1 - i) / (timePoints.length - 1)) * width
-                                ctx.beginPath()
-                                ctx.moveTo(x, 0)
-                                ctx.lineTo(x, height)
-                                ctx.stroke()
-                            }
-                        }
-                        ctx.setLineDash([])
-
-                        // Rysowanie wykresów
-                        for (var s = 0; s < selectedSensorIds.length && s < colors.length; s++) {
-                            var sensorId = selectedSensorIds[s]
-                            var data = sensorData[sensorId]
-                            if (!data) continue
-
-                            ctx.strokeStyle = colors[s]
-                            ctx.lineWidth = 2
-                            ctx.beginPath()
-                            var firstPoint = true
-                            for (var i = 0; i < data.length; i++) {
-                                var value = data[i].value
-                                if (value === null || isNaN(value)) continue
-                                var x = ((data.length - 1 - i) / (data.length - 1)) * width
-                                var y = height - ((value - globalMinValue) / (globalMaxValue - globalMinValue)) * height
-                                if (firstPoint) {
-                                    ctx.moveTo(x, y)
-                                    firstPoint = false
-                                } else {
-                                    ctx.lineTo(x, y)
-                                }
-                            }
-                            ctx.stroke()
-                        }
+                    /**
+                     * @brief Obsługa najechania myszą: wyszukuje najbliższe pomiary.
+                     */
+                    MouseArea {
+                        id: chartHover
+                        anchors.fill: parent
+                        hoverEnabled: true
+                        property var point: ({})
+                        onPositionChanged: point = sensorChart.pointAt(mouseX)
+                        onExited: point = ({})
+                    }
 
-                        // Rysowanie etykiet czasu (co 4 godziny) i daty (tylko pod przerywanymi liniami)
-                        ctx.fillStyle = "black"
-                        var lastHour = -1
-                        for (var i = 0; i < timePoints.length; i++) {
-                            var dateTime = timePoints[i].split(" ")
-                            var date = dateTime[0].split("-")
-                            var time = dateTime[1]
-                            var hour = parseInt(time.split(":")[0])
-                            var minutes = time.split(":")[1]
-
-                            var x = ((timePoints.length - 1 - i) / (timePoints.length - 1)) * width
-                            var timeLabel = (hour < 10 ? "0" + hour : hour) + ":" + minutes
-                            var dateLabel = date[2] + "." + date[1] + "." + date[0].slice(2)
-
-                            // Wyświetlanie godziny co 4 godziny
-                            if (hour % 4 === 0 && hour !== lastHour) {
-                                ctx.save()
-                                ctx.translate(x, height - 10)
-                                ctx.rotate(-Math.PI / 4)
-                                ctx.fillText(timeLabel, 0, 0)
-                                ctx.restore()
-                                lastHour = hour
-                            }
+                    /**
+                     * @brief Pionowa linia wskazująca najbliższy pomiar.
+                     */
+                    Rectangle {
+                        id: hoverLine
+                        visible: chartHover.containsMouse && chartHover.point.x !== undefined
+                        x: chartHover.point.x !== undefined ? chartHover.point.x : 0
+                        width: 1
+                        height: parent.height
+                        color: "#808080"
+                    }
 
-                            // Wyświetlanie daty tylko pod przerywanymi liniami (00:00:00)
-                            if (time === "00:00:00") {
-                                ctx.fillText(dateLabel, x - 20, height - 5)
+                    /**
+                     * @brief Podpowiedź z datą i wartościami pomiarów.
+                     */
+                    Rectangle {
+                        visible: hoverLine.visible
+                        x: Math.min(hoverLine.x + 8, sensorChart.width - width)
+                        y: 4
+                        width: hoverColumn.width + 10
+                        height: hoverColumn.height + 10
+                        color: "white"
+                        border.color: "#808080"
+                        radius: 3
+
+                        Column {
+                            id: hoverColumn
+                            x: 5
+                            y: 5
+                            Text {
+                                font.pixelSize: 12
+                                text: chartHover.point.date !== undefined ? chartHover.point.date : ""
                             }
-                        }
-
-                        // Rysowanie etykiet wartości na osi Y
-                        ctx.fillStyle = "black"
-                        for (var i = 0; i <= 5; i++) {
-                            var value = globalMinValue + (i * (globalMaxValue - globalMinValue) / 5)
-                            var y = height - (i * height / 5)
-                            if (!isNaN(value)) {
-                                ctx.fillText(value.toFixed(1), +10, y - 5)
+                            Repeater {
+                                model: chartHover.point.values !== undefined ? chartHover.point.values : []
+                                Text {
+                                    font.pixelSize: 12
+                                    color: modelData.color
+                                    text: (modelData.value !== null && modelData.value !== undefined ? modelData.value.toFixed(2) : "Brak") + " µg/m³"
+                                }
                             }
                         }
-
-                        // Rysowanie podpisów osi
-                        ctx.fillStyle = "black"
-                        ctx.fillText("Czas", width / 2, height + 60)
-                        ctx.save()
-                        ctx.translate(50, height / 2)
-                        ctx.rotate(-Math.PI / 2)
-                        ctx.fillText("Wartość (µg/m³)", 0, 0)
-                        ctx.restore()
                     }
                 }
             }
@@ -438,10 +385,11 @@ Window {
                             latestValueText.text = Qt.binding(function() {
                                 if (currentIndex < 0) return ""
                                 var sensorId = mainWindow.sensors[currentIndex].sensorId
-                                var data = mainWindow.sensorData[sensorId]
-                                if (!data || data.length === 0) return "Brak danych"
-                                var latest = data[0]
-                                return "Ostatni odczyt: " + (latest.value !== null ? latest.value.toFixed(2) : "Brak") + " µg/m³ (" + latest.date + ")"
+                                var store = mainWindow.sensorSeries
+                                store.revision // ponowne obliczenie po zmianie danych
+                                if (store.size(sensorId) === 0) return "Brak danych"
+                                var latest = store.latestValue(sensorId)
+                                return "Ostatni odczyt: " + (!isNaN(latest) ? latest.toFixed(2) : "Brak") + " µg/m³ (" + store.latestDate(sensorId) + ")"
                             })
                         }
                     }
@@ -450,10 +398,18 @@ Window {
                      * @brief Wyświetla statystyki wybranego parametru.
                      */
                     Column {
+                        id: statsColumn
                         width: parent.width
                         spacing: 5
                         visible: paramSelector.currentIndex >= 0
 
+                        /// @property var stats Statystyki wybranego sensora wyznaczone w C++ (przeliczane tylko po zmianie jego danych).
+                        property var stats: {
+                            if (paramSelector.currentIndex < 0) return ({})
+                            mainWindow.sensorSeries.revision // ponowne pobranie po zmianie danych
+                            return mainWindow.sensorSeries.statistics(mainWindow.sensors[paramSelector.currentIndex].sensorId)
+                        }
+
                         Text {
                             id: latestValueText
                             width: parent.width
@@ -468,10 +424,11 @@ Window {
                             text: {
                                 if (paramSelector.currentIndex < 0) return ""
                                 var sensorId = mainWindow.sensors[paramSelector.currentIndex].sensorId
-                                var data = mainWindow.sensorData[sensorId]
-                                if (!data || data.length === 0) return "Brak danych"
-                                var latest = data[0]
-                                return "Ostatni odczyt: " + (latest.value !== null ? latest.value.toFixed(2) : "Brak") + " µg/m³ (" + latest.date + ")"
+                                var store = mainWindow.sensorSeries
+                                store.revision // ponowne obliczenie po zmianie danych
+                                if (store.size(sensorId) === 0) return "Brak danych"
+                                var latest = store.latestValue(sensorId)
+                                return "Ostatni odczyt: " + (!isNaN(latest) ? latest.toFixed(2) : "Brak") + " µg/m³ (" + store.latestDate(sensorId) + ")"
                             }
                         }
 
@@ -480,26 +437,11 @@ Window {
                             font.pixelSize: 14
                             wrapMode: Text.WordWrap
                             /**
-                             * @brief Wyświetla średnią wartość sensora.
-                             *
-                             * Oblicza i wyświetla średnią wartość dla danych sensora.
+                             * @brief Wyświetla średnią wartość i odchylenie standardowe sensora.
                              */
-                            text: {
-                                if (paramSelector.currentIndex < 0) return ""
-                                var sensorId = mainWindow.sensors[paramSelector.currentIndex].sensorId
-                                var data = mainWindow.sensorData[sensorId]
-                                if (!data || data.length === 0) return "Średnia wartość: Brak danych"
-                                var sum = 0
-                                var count = 0
-                                for (var i = 0; i < data.length; i++) {
-                                    if (data[i].value !== null && !isNaN(data[i].value)) {
-                                        sum += data[i].value
-                                        count++
-                                    }
-                                }
-                                var avg = count > 0 ? (sum / count).toFixed(2) : "Brak"
-                                return "Średnia wartość: " + avg + " µg/m³"
-                            }
+                            text: statsColumn.stats.count > 0
+                                  ? "Średnia wartość: " + statsColumn.stats.mean.toFixed(2) + " µg/m³ (odchylenie " + statsColumn.stats.stddev.toFixed(2) + ")"
+                                  : "Średnia wartość: Brak danych"
                         }
 
                         Text {
@@ -507,47 +449,38 @@ Window {
                             font.pixelSize: 14
                             wrapMode: Text.WordWrap
                             /**
-                             * @brief Wyświetla minimalną wartość sensora.
-                             *
-                             * Oblicza i wyświetla minimalną wartość dla danych sensora.
+                             * @brief Wyświetla minimalną i maksymalną wartość sensora.
                              */
-                            text: {
-                                if (paramSelector.currentIndex < 0) return ""
-                                var sensorId = mainWindow.sensors[paramSelector.currentIndex].sensorId
-                                var data = mainWindow.sensorData[sensorId]
-                                if (!data || data.length === 0) return "Minimalna wartość: Brak danych"
-                                var min = Number.MAX_VALUE
-                                for (var i = 0; i < data.length; i++) {
-                                    if (data[i].value !== null && !isNaN(data[i].value)) {
-                                        min = Math.min(min, data[i].value)
-                                    }
-                                }
-                                return "Minimalna wartość: " + (min !== Number.MAX_VALUE ? min.toFixed(2) : "Brak") + " µg/m³"
-                            }
+                            text: statsColumn.stats.count > 0
+                                  ? "Minimalna wartość: " + statsColumn.stats.min.toFixed(2) + " µg/m³, maksymalna: " + statsColumn.stats.max.toFixed(2) + " µg/m³"
+                                  : "Minimalna i maksymalna wartość: Brak danych"
                         }
 
                         Text {
                             width: parent.width
                             font.pixelSize: 14
                             wrapMode: Text.WordWrap
+                            visible: statsColumn.stats.count > 0
                             /**
-                             * @brief Wyświetla maksymalną wartość sensora.
-                             *
-                             * Oblicza i wyświetla maksymalną wartość dla danych sensora.
+                             * @brief Wyświetla medianę oraz percentyle 95 i 98.
                              */
-                            text: {
-                                if (paramSelector.currentIndex < 0) return ""
-                                var sensorId = mainWindow.sensors[paramSelector.currentIndex].sensorId
-                                var data = mainWindow.sensorData[sensorId]
-                                if (!data || data.length === 0) return "Maksymalna wartość: Brak danych"
-                                var max = -Number.MAX_VALUE
-                                for (var i = 0; i < data.length; i++) {
-                                    if (data[i].value !== null && !isNaN(data[i].value)) {
-                                        max = Math.max(max, data[i].value)
-                                    }
-                                }
-                                return "Maksymalna wartość: " + (max !== -Number.MAX_VALUE ? max.toFixed(2) : "Brak") + " µg/m³"
-                            }
+                            text: visible
+                                  ? "Mediana: " + statsColumn.stats.p50.toFixed(2) + ", P95: " + statsColumn.stats.p95.toFixed(2) + ", P98: " + statsColumn.stats.p98.toFixed(2) + " µg/m³"
+                                  : ""
+                        }
+
+                        Text {
+                            width: parent.width
+                            font.pixelSize: 14
+                            wrapMode: Text.WordWrap
+                            visible: statsColumn.stats.count > 0 && statsColumn.stats.threshold !== null && statsColumn.stats.threshold !== undefined
+                            /**
+                             * @brief Wyświetla przekroczenia normy: godzinowe i dni (według reguły parametru).
+                             */
+                            text: visible
+                                  ? "Przekroczenia normy " + statsColumn.stats.threshold + " µg/m³: " + statsColumn.stats.exceedances + " pomiarów, "
+                                    + statsColumn.stats.exceedanceDays + " z " + statsColumn.stats.days + (statsColumn.stats.dayRule === 1 ? " dni (godzina powyżej normy)" : statsColumn.stats.dayRule === 2 ? " dni (średnia 8-godzinna)" : " dni (średnia dobowa)")
+                                  : ""
                         }
                     }
                 }
@@ -558,28 +491,10 @@ Window {
     /**
      * @brief Połączenia z MainWindow.
      *
-     * Reaguje na zmiany danych sensorów, aktualizując wykres i statystyki.
+     * Reaguje na załadowanie danych archiwalnych.
      */
     Connections {
         target: mainWindow
-        /**
-         * @brief Aktualizuje wykres i statystyki po zmianie danych sensorów.
-         *
-         * Po otrzymaniu sygnału sensorDataChanged, odświeża płótno wykresu oraz tekst wyświetlający ostatni odczyt.
-         */
-        function onSensorDataChanged() {
-            console.log("Dane sensorów zmienione, żądanie odświeżenia wykresu i statystyk")
-            chartCanvas.requestPaint()
-            latestValueText.text = Qt.binding(function() {
-                if (paramSelector.currentIndex < 0) return ""
-                var sensorId = mainWindow.sensors[paramSelector.currentIndex].sensorId
-                var data = mainWindow.sensorData[sensorId]
-                if (!data || data.length === 0) return "Brak danych"
-                var latest = data[0]
-                return "Ostatni odczyt: " + (latest.value !== null ? latest.value.toFixed(2) : "Brak") + " µg/m³ (" + latest.date + ")"
-            })
-        }
-
         /**
          * @brief Reaguje na załadowanie danych archiwalnych.
          *
@@ -587,7 +502,7 @@ Window {
          */
         function onArchivedDataLoaded() {
             console.log("Załadowano dane archiwalne, odświeżanie wykresu")
-            chartCanvas.requestPaint()
+            sensorChart.sensorIds = Object.keys(selectedSensors).map(Number)
         }
     }
 
@@ -0,0 +1,200 @@
+/**
+ * @file ComparisonDialog.qml
+ * @brief Okno porównania stacji dla jednego parametru.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje okno z rankingiem stacji, kolumnami podsumowania i paskiem godzinowym
+ * każdej stacji wyrównanym do wspólnej siatki (mainWindow.comparison).
+ */
+
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+
+/**
+ * @class Window
+ * @brief Okno porównania stacji.
+ *
+ * Porównywane są stacje przekazane przy tworzeniu okna (np. wyniki wyszukiwania).
+ */
+Window {
+    id: dialog
+    title: "Porównanie stacji"
+    width: 900
+    height: 560
+    minimumWidth: 600
+    minimumHeight: 300
+    visible: false
+
+    /// @property var stationIds Identyfikatory porównywanych stacji.
+    property var stationIds: []
+
+    /// @property var hourOptions Dostępne długości siatki w godzinach.
+    readonly property var hourOptions: [24, 72, 168, 720]
+
+    /// @property var comparison Porównanie stacji z MainWindow.
+    property var comparison: mainWindow.comparison
+
+    /**
+     * @brief Formatuje wartość kolumny podsumowania.
+     * @param value Wartość (NaN bez pomiarów).
+     * @return Tekst z jedną cyfrą po przecinku lub "—".
+     */
+    function formatValue(value) {
+        return isNaN(value) ? "—" : value.toFixed(1)
+    }
+
+    /**
+     * @brief Wyznacza kolor komórki paska godzinowego.
+     * @param value Wartość pomiaru.
+     * @return Kolor od zielonego (niska wartość) do czerwonego (norma lub maksimum).
+     */
+    function cellColor(value) {
+        var scale = isNaN(comparison.threshold) ? comparison.maxValue : comparison.threshold
+        var ratio = scale > 0 ? Math.min(value / scale, 1) : 0
+        return Qt.hsla(0.33 * (1 - ratio), 0.8, 0.45, 1)
+    }
+
+    /**
+     * @brief Uruchamia porównanie wybranego parametru.
+     */
+    function compare() {
+        comparison.compare(parameterBox.currentText, stationIds, hourOptions[hoursBox.currentIndex])
+    }
+
+    /**
+     * @brief Nagłówek okna.
+     */
+    Rectangle {
+        id: header
+        width: parent.width
+        height: 50
+        color: "#4CAF50"
+
+        Text {
+            anchors.centerIn: parent
+            text: "Porównanie stacji (" + stationIds.length + ")"
+            color: "white"
+            font.pixelSize: 20
+            font.bold: true
+        }
+    }
+
+    /**
+     * @brief Wybór parametru i długości siatki.
+     */
+    Row {
+        id: controls
+        anchors.top: header.bottom
+        anchors.left: parent.left
+        anchors.margins: 10
+        spacing: 10
+
+        ComboBox {
+            id: parameterBox
+            width: 120
+            model: comparison.parameters
+        }
+
+        ComboBox {
+            id: hoursBox
+            width: 120
+            model: ["24 godziny", "3 doby", "Tydzień", "30 dni"]
+            currentIndex: 2
+        }
+
+        Button {
+            text: comparison.busy ? "Porównywanie…" : "Porównaj"
+            enabled: !comparison.busy && stationIds.length > 0
+            onClicked: dialog.compare()
+        }
+    }
+
+    /**
+     * @brief Opis bieżącej macierzy.
+     */
+    Text {
+        id: summaryText
+        anchors.top: controls.bottom
+        anchors.left: parent.left
+        anchors.right: parent.right
+        anchors.margins: 10
+        font.pixelSize: 13
+        color: "#666666"
+        wrapMode: Text.WordWrap
+        text: comparison.rowCount === 0 ? "Wybierz parametr i kliknij Porównaj"
+              : comparison.paramCode + ": " + comparison.rowCount + " stacji, " + comparison.hours + " h od "
+                + comparison.startText + (isNaN(comparison.threshold) ? "" : ", norma " + comparison.threshold + " µg/m³")
+                + ". Kolumny: średnia / maks. / ostatni pomiar, godziny z pomiarem, godziny powyżej normy."
+    }
+
+    /**
+     * @brief Ranking stacji z paskami godzinowymi.
+     */
+    ListView {
+        anchors.top: summaryText.bottom
+        anchors.left: parent.left
+        anchors.right: parent.right
+        anchors.bottom: parent.bottom
+        anchors.margins: 10
+        spacing: 4
+        clip: true
+        model: comparison.summary
+        ScrollBar.vertical: ScrollBar {}
+
+        delegate: Row {
+            width: ListView.view.width
+            height: 24
+            spacing: 8
+
+            Text {
+                width: 260
+                anchors.verticalCenter: parent.verticalCenter
+                font.pixelSize: 13
+                elide: Text.ElideRight
+                text: (modelData.rank > 0 ? modelData.rank + ". " : "–  ")
+                      + (modelData.stationName ? modelData.stationName : "Stacja " + modelData.stationId)
+            }
+
+            Text {
+                width: 230
+                anchors.verticalCenter: parent.verticalCenter
+                font.pixelSize: 13
+                font.family: "monospace"
+                text: modelData.sensorId === 0 ? "brak sensora"
+                      : formatValue(modelData.mean) + " / " + formatValue(modelData.max) + " / "
+                        + formatValue(modelData.latest) + "  " + modelData.coverage + "h  " + modelData.exceedances + "h"
+            }
+
+            /**
+             * @brief Pasek godzinowy stacji (szary tam, gdzie brak pomiaru).
+             */
+            Canvas {
+                width: parent.width - 498
+                height: parent.height
+
+                onPaint: {
+                    var ctx = getContext("2d")
+                    ctx.reset()
+                    ctx.fillStyle = "#eeeeee"
+                    ctx.fillRect(0, 0, width, height)
+                    var values = comparison.rowValues(modelData.row)
+                    var cell = width / Math.max(values.length, 1)
+                    for (var i = 0; i < values.length; ++i) {
+                        if (isNaN(values[i]))
+                            continue
+                        ctx.fillStyle = dialog.cellColor(values[i])
+                        ctx.fillRect(i * cell, 0, Math.ceil(cell), height)
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Otwiera okno dialogowe.
+     */
+    function open() {
+        visible = true
+    }
+}
@@ -0,0 +1,117 @@
+/**
+ * @file DiagnosticsDialog.qml
+ * @brief Panel diagnostyczny z metrykami czasu działania aplikacji.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje okno wyświetlające czasy żądań, parsowania, budowy modeli i operacji
+ * na archiwum oraz liczniki (bajty, trafienia pamięci podręcznej, emisje sygnałów).
+ */
+
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+
+/**
+ * @class Window
+ * @brief Okno panelu diagnostycznego.
+ *
+ * Dane pochodzą z właściwości mainWindow.metrics, odświeżanej najwyżej co 2 s.
+ */
+Window {
+    id: dialog
+    title: "Diagnostyka"
+    width: 760
+    height: 520
+    minimumWidth: 500
+    minimumHeight: 300
+    visible: false
+
+    /// @property var metrics Migawka metryk z MainWindow.
+    property var metrics: mainWindow.metrics
+
+    /**
+     * @brief Formatuje czas w milisekundach.
+     * @param ms Czas w milisekundach.
+     * @return Tekst z jednostką.
+     */
+    function formatMs(ms) {
+        return ms >= 1000 ? (ms / 1000).toFixed(2) + " s" : ms.toFixed(ms < 10 ? 2 : 0) + " ms"
+    }
+
+    /**
+     * @brief Buduje opis udziału trafień pamięci podręcznej.
+     * @return Tekst z udziałem świeżych trafień dla każdego zasobu.
+     */
+    function hitRatesText() {
+        var parts = []
+        for (var endpoint in metrics.cacheHitRates)
+            parts.push(endpoint + ": " + (metrics.cacheHitRates[endpoint] * 100).toFixed(0) + "%")
+        return parts.length > 0 ? parts.join(", ") : "brak danych"
+    }
+
+    /**
+     * @brief Nagłówek okna.
+     */
+    Rectangle {
+        id: header
+        width: parent.width
+        height: 50
+        color: "#4CAF50"
+
+        Text {
+            anchors.centerIn: parent
+            text: "Diagnostyka"
+            color: "white"
+            font.pixelSize: 20
+            font.bold: true
+        }
+    }
+
+    /**
+     * @brief Podsumowanie: czas wypełnienia katalogu i trafienia pamięci podręcznej.
+     */
+    Text {
+        id: summary
+        anchors.top: header.bottom
+        anchors.left: parent.left
+        anchors.right: parent.right
+        anchors.margins: 10
+        font.pixelSize: 14
+        wrapMode: Text.WordWrap
+        text: "Katalog stacji gotowy po: " + (metrics.catalogReadyMs >= 0 ? metrics.catalogReadyMs + " ms" : "—")
+              + "\nŚwieże trafienia pamięci podręcznej: " + hitRatesText()
+    }
+
+    /**
+     * @brief Lista histogramów i liczników.
+     */
+    ListView {
+        anchors.top: summary.bottom
+        anchors.left: parent.left
+        anchors.right: parent.right
+        anchors.bottom: parent.bottom
+        anchors.margins: 10
+        clip: true
+        model: metrics.histograms.concat(metrics.counters)
+        ScrollBar.vertical: ScrollBar {}
+
+        delegate: Text {
+            width: ListView.view.width
+            font.pixelSize: 13
+            font.family: "monospace"
+            wrapMode: Text.WordWrap
+            text: modelData.name + (modelData.labels ? " {" + modelData.labels + "}" : "") + "  "
+                  + (modelData.count !== undefined
+                     ? "n=" + modelData.count + ", p50 " + formatMs(modelData.p50Ms) + ", p95 " + formatMs(modelData.p95Ms)
+                       + ", max " + formatMs(modelData.maxMs)
+                     : "= " + modelData.value)
+        }
+    }
+
+    /**
+     * @brief Otwiera okno dialogowe.
+     */
+    function open() {
+        visible = true
+    }
+}
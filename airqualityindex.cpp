@@ -0,0 +1,462 @@
+/**
+ * @file airqualityindex.cpp
+ * @brief Implementacja klasy AirQualityIndex.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera progi indeksów cząstkowych obu skal, wyznaczanie poziomu stacji
+ * oraz cogodzinny przegląd katalogu pobierający najnowsze pomiary zanieczyszczeń indeksu.
+ */
+
+#include "airqualityindex.h"
+#include "metricsregistry.h"
+#include "stationmonitor.h"
+#include <QDateTime>
+#include <QtConcurrent>
+#include <algorithm>
+#include <utility>
+
+namespace {
+/// Grupa żądań przeglądu; unieważniana po wyłączeniu przeglądu.
+const QString kAirQualityRequests = QStringLiteral("airquality");
+
+/// Maksymalna liczba zadań przeglądu w toku; reszta limitu hosta zostaje dla użytkownika i monitora.
+constexpr int kMaxRunningTasks = 2;
+
+/// Opóźnienie przeglądu względem pełnej godziny (kilka minut po monitorze).
+constexpr int kPublicationDelayMinutes = 15;
+
+/// Liczba stacji, od której przeliczenie odbywa się w puli wątków.
+constexpr int kParallelThreshold = 256;
+
+/**
+ * @brief Pobiera górne granice poziomów indeksów cząstkowych.
+ * @param scale Skala.
+ * @return Granice w µg/m³ według kodu zanieczyszczenia (wartość powyżej ostatniej to najwyższy poziom).
+ */
+const QHash<QString, QVector<double>> &thresholds(AirQualityIndex::Scale scale)
+{
+    // Polski Indeks Jakości Powietrza (GIOŚ, stężenia 1-godzinne)
+    static const QHash<QString, QVector<double>> polish = {
+        { "PM10", { 20, 50, 80, 110, 150 } },
+        { "PM2.5", { 13, 35, 55, 75, 110 } },
+        { "NO2", { 40, 100, 150, 230, 400 } },
+        { "O3", { 70, 120, 150, 180, 240 } },
+        { "SO2", { 50, 100, 200, 350, 500 } }
+    };
+    // CAQI, siatka godzinowa
+    static const QHash<QString, QVector<double>> caqi = {
+        { "PM10", { 25, 50, 90, 180 } },
+        { "PM2.5", { 15, 30, 55, 110 } },
+        { "NO2", { 50, 100, 200, 400 } },
+        { "O3", { 60, 120, 180, 240 } },
+        { "SO2", { 50, 100, 350, 500 } }
+    };
+    return scale == AirQualityIndex::Caqi ? caqi : polish;
+}
+
+/**
+ * @brief Pobiera nazwy poziomów skali.
+ * @param scale Skala.
+ * @return Nazwy od najlepszego poziomu.
+ */
+const QStringList &levelNames(AirQualityIndex::Scale scale)
+{
+    static const QStringList polish = { "Bardzo dobry", "Dobry", "Umiarkowany", "Dostateczny", "Zły", "Bardzo zły" };
+    static const QStringList caqi = { "Bardzo niski", "Niski", "Średni", "Wysoki", "Bardzo wysoki" };
+    return scale == AirQualityIndex::Caqi ? caqi : polish;
+}
+}
+
+/**
+ * @brief Konstruktor obiektu AirQualityIndex.
+ * @param apiClient Klient HTTP.
+ * @param parser Parser odpowiedzi (wspólny dla zadań w tle).
+ * @param parent Rodzic QObject.
+ */
+AirQualityIndex::AirQualityIndex(ApiClient *apiClient, ReplyParser *parser, QObject *parent)
+    : QObject(parent),
+    m_fetch(new StationFetchQueue(apiClient, parser, RequestOptions{ RequestPriority::Background, kAirQualityRequests },
+                                  kMaxRunningTasks, this))
+{
+    m_recomputeTimer.setSingleShot(true);
+    m_recomputeTimer.setInterval(0);
+    connect(&m_recomputeTimer, &QTimer::timeout, this, &AirQualityIndex::recompute);
+
+    m_wakeTimer.setSingleShot(true);
+    m_wakeTimer.setTimerType(Qt::VeryCoarseTimer);
+    connect(&m_wakeTimer, &QTimer::timeout, this, [this]() {
+        scheduleNext();
+        startCycle();
+    });
+
+    connect(m_fetch, &StationFetchQueue::sensorsReady, this, &AirQualityIndex::onSensorsReady);
+    connect(m_fetch, &StationFetchQueue::sensorDataReady, this, [this](int, int sensorId, const SensorSeries &series) {
+        updateSensor(sensorId, series);
+    });
+    connect(m_fetch, &StationFetchQueue::busyChanged, this, &AirQualityIndex::busyChanged);
+}
+
+/**
+ * @brief Pobiera kody zanieczyszczeń uwzględnianych w indeksie.
+ * @return Lista kodów w kolejności rozstrzygania remisów.
+ */
+const QStringList &AirQualityIndex::pollutants()
+{
+    static const QStringList codes = { "PM10", "PM2.5", "NO2", "O3", "SO2" };
+    return codes;
+}
+
+/**
+ * @brief Pobiera kolory poziomów skali.
+ * @param scale Skala.
+ * @return Kolory "#rrggbb" od najlepszego poziomu.
+ */
+const QStringList &AirQualityIndex::levelColors(Scale scale)
+{
+    static const QStringList polish = { "#57b108", "#b0dd10", "#ffd911", "#e58100", "#e50000", "#990000" };
+    static const QStringList caqi = { "#79bc6a", "#bbcf4c", "#eec20b", "#f29305", "#e8416f" };
+    return scale == Caqi ? caqi : polish;
+}
+
+/**
+ * @brief Wyznacza indeks cząstkowy zanieczyszczenia.
+ * @param scale Skala.
+ * @param pollutant Kod zanieczyszczenia.
+ * @param value Stężenie w µg/m³.
+ * @return Poziom lub -1 dla nieznanego zanieczyszczenia i niepoprawnej wartości.
+ */
+int AirQualityIndex::subIndex(Scale scale, const QString &pollutant, double value)
+{
+    const auto it = thresholds(scale).constFind(pollutant.toUpper());
+    if (it == thresholds(scale).constEnd() || qIsNaN(value) || value < 0)
+        return -1;
+    const QVector<double> &bounds = it.value();
+    return int(std::lower_bound(bounds.cbegin(), bounds.cend(), value) - bounds.cbegin());
+}
+
+/**
+ * @brief Wyznacza poziom stacji z jej najnowszych pomiarów.
+ * @param scale Skala.
+ * @param station Pomiary stacji.
+ *
+ * Poziom to najgorszy indeks cząstkowy spośród pomiarów nie starszych niż kMaxReadingAgeHours
+ * od najnowszego pomiaru stacji; przy remisie decyduje kolejność pollutants().
+ */
+void AirQualityIndex::evaluate(Scale scale, StationAirQuality &station)
+{
+    station.level = -1;
+    station.pollutant.clear();
+    station.timestamp = -1;
+
+    qint64 newest = -1;
+    for (const AirQualityReading &reading : std::as_const(station.readings))
+        newest = qMax(newest, reading.timestamp);
+    if (newest < 0)
+        return;
+
+    const qint64 oldest = newest - qint64(kMaxReadingAgeHours) * 3600;
+    for (const QString &pollutant : pollutants()) {
+        const auto it = station.readings.constFind(pollutant);
+        if (it == station.readings.constEnd() || it->timestamp < oldest)
+            continue;
+        const int level = subIndex(scale, pollutant, it->value);
+        if (level > station.level) {
+            station.level = level;
+            station.pollutant = pollutant;
+        }
+    }
+    if (station.level >= 0)
+        station.timestamp = newest;
+}
+
+/**
+ * @brief Włącza lub wyłącza przegląd katalogu.
+ * @param enabled True, aby włączyć przegląd.
+ */
+void AirQualityIndex::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled)
+        return;
+    m_enabled = enabled;
+
+    if (m_enabled) {
+        scheduleNext();
+        startCycle();
+    } else {
+        m_wakeTimer.stop();
+        m_fetch->cancelAll();
+    }
+    emit enabledChanged();
+}
+
+/**
+ * @brief Ustawia skalę indeksu i przelicza wszystkie stacje.
+ * @param scale Skala.
+ */
+void AirQualityIndex::setScale(Scale scale)
+{
+    if (m_scale == scale)
+        return;
+    m_scale = scale;
+    for (auto it = m_stations.cbegin(); it != m_stations.cend(); ++it)
+        m_dirty.insert(it.key());
+    recompute();
+    emit scaleChanged();
+}
+
+/**
+ * @brief Ustawia stacje katalogu objęte przeglądem.
+ * @param stationIds Identyfikatory stacji.
+ *
+ * Przy włączonym przeglądzie nowe stacje trafiają od razu do kolejki.
+ */
+void AirQualityIndex::setStations(const QList<int> &stationIds)
+{
+    const QSet<int> catalog(stationIds.cbegin(), stationIds.cend());
+    QList<int> removed;
+    for (auto it = m_stations.begin(); it != m_stations.end();) {
+        if (catalog.contains(it.key())) {
+            ++it;
+            continue;
+        }
+        if (it->level >= 0)
+            removed.append(it.key());
+        m_dirty.remove(it.key());
+        it = m_stations.erase(it);
+    }
+    for (auto it = m_sensors.begin(); it != m_sensors.end();)
+        it = catalog.contains(it->stationId) ? std::next(it) : m_sensors.erase(it);
+
+    const QSet<int> previous(m_catalog.cbegin(), m_catalog.cend());
+    m_catalog = stationIds;
+    if (m_enabled) {
+        m_cycleHour = StationMonitor::currentMeasurementHour(QDateTime::currentDateTimeUtc());
+        for (int stationId : stationIds) {
+            if (!previous.contains(stationId))
+                m_fetch->enqueueStation(stationId);
+        }
+    }
+
+    if (!removed.isEmpty()) {
+        m_ratedStations -= removed.size();
+        emit levelsChanged(removed);
+        emit readingsChanged();
+    }
+}
+
+/**
+ * @brief Zapamiętuje sensory stacji.
+ * @param stationId Identyfikator stacji.
+ * @param sensors Sensory stacji; zapamiętywane są tylko sensory zanieczyszczeń indeksu.
+ */
+void AirQualityIndex::setSensors(int stationId, const QList<SensorInfo> &sensors)
+{
+    for (const SensorInfo &sensor : sensors) {
+        const QString pollutant = sensor.paramCode.toUpper();
+        if (pollutants().contains(pollutant))
+            m_sensors.insert(sensor.sensorId, { stationId, pollutant });
+    }
+}
+
+/**
+ * @brief Nanosi najnowszy pomiar sensora.
+ * @param sensorId Identyfikator sensora.
+ * @param series Pomiary sensora.
+ *
+ * Stacja jest przeliczana tylko wtedy, gdy najnowszy niepusty pomiar jest nowszy
+ * od zapamiętanego albo został poprawiony.
+ */
+void AirQualityIndex::updateSensor(int sensorId, const SensorSeries &series)
+{
+    const auto ref = m_sensors.constFind(sensorId);
+    if (ref == m_sensors.constEnd())
+        return;
+
+    int latest = series.size() - 1;
+    while (latest >= 0 && series.isNull(latest))
+        --latest;
+    if (latest < 0)
+        return;
+
+    AirQualityReading &reading = m_stations[ref->stationId].readings[ref->pollutant];
+    const qint64 timestamp = series.timestamp(latest);
+    if (timestamp < reading.timestamp || (timestamp == reading.timestamp && series.value(latest) == reading.value))
+        return;
+
+    reading.timestamp = timestamp;
+    reading.value = series.value(latest);
+    m_dirty.insert(ref->stationId);
+    m_recomputeTimer.start();
+}
+
+/**
+ * @brief Przelicza poziomy zmienionych stacji i zgłasza zmiany.
+ *
+ * Stacje są niezależne, więc duża partia (np. po zmianie skali) jest przeliczana
+ * w globalnej puli wątków; wskaźniki do wpisów są stałe, bo w trakcie nic nie jest dodawane.
+ */
+void AirQualityIndex::recompute()
+{
+    m_recomputeTimer.stop();
+    if (m_dirty.isEmpty())
+        return;
+
+    MetricsTimer timer("gios_model_build_duration_ms", "model=air_quality");
+    const QList<int> stationIds = std::exchange(m_dirty, {}).values();
+    QList<StationAirQuality*> targets;
+    QList<int> previous;
+    targets.reserve(stationIds.size());
+    previous.reserve(stationIds.size());
+    for (int stationId : stationIds) {
+        StationAirQuality &station = m_stations[stationId];
+        targets.append(&station);
+        previous.append(station.level);
+    }
+
+    const Scale scale = m_scale;
+    const auto evaluateStation = [scale](StationAirQuality *station) { evaluate(scale, *station); };
+    if (targets.size() >= kParallelThreshold)
+        QtConcurrent::blockingMap(targets, evaluateStation);
+    else
+        std::for_each(targets.begin(), targets.end(), evaluateStation);
+
+    QList<int> changed;
+    for (int i = 0; i < targets.size(); ++i) {
+        const int level = targets.at(i)->level;
+        if (level == previous.at(i))
+            continue;
+        m_ratedStations += (level >= 0) - (previous.at(i) >= 0);
+        changed.append(stationIds.at(i));
+    }
+    if (!changed.isEmpty())
+        emit levelsChanged(changed);
+    emit readingsChanged();
+}
+
+/**
+ * @brief Pobiera najnowsze pomiary zanieczyszczenia we wszystkich stacjach.
+ * @param pollutant Kod zanieczyszczenia.
+ * @return Pomiar według identyfikatora stacji.
+ */
+QHash<int, AirQualityReading> AirQualityIndex::readings(const QString &pollutant) const
+{
+    QHash<int, AirQualityReading> result;
+    const QString code = pollutant.toUpper();
+    for (auto it = m_stations.cbegin(); it != m_stations.cend(); ++it) {
+        const auto reading = it->readings.constFind(code);
+        if (reading != it->readings.constEnd() && reading->timestamp >= 0)
+            result.insert(it.key(), reading.value());
+    }
+    return result;
+}
+
+/**
+ * @brief Pobiera szczegóły indeksu stacji.
+ * @param stationId Identyfikator stacji.
+ * @return Mapa z poziomem, nazwą, kolorem, zanieczyszczeniem decydującym, datą i indeksami cząstkowymi.
+ */
+QVariantMap AirQualityIndex::stationIndex(int stationId) const
+{
+    const StationAirQuality station = m_stations.value(stationId);
+    QVariantMap subIndexes;
+    for (auto it = station.readings.cbegin(); it != station.readings.cend(); ++it) {
+        if (it->timestamp < 0)
+            continue;
+        QVariantMap entry;
+        entry["value"] = it->value;
+        entry["level"] = subIndex(m_scale, it.key(), it->value);
+        entry["date"] = SensorSeries::formatTimestamp(it->timestamp);
+        subIndexes[it.key()] = entry;
+    }
+
+    QVariantMap result;
+    result["level"] = station.level;
+    result["name"] = levelName(station.level);
+    result["color"] = levelColor(station.level);
+    result["pollutant"] = station.pollutant;
+    result["date"] = station.timestamp >= 0 ? SensorSeries::formatTimestamp(station.timestamp) : QString();
+    result["subIndexes"] = subIndexes;
+    return result;
+}
+
+/**
+ * @brief Pobiera nazwę poziomu bieżącej skali.
+ * @param level Poziom.
+ * @return Nazwa poziomu lub "Brak indeksu".
+ */
+QString AirQualityIndex::levelName(int level) const
+{
+    const QStringList &names = levelNames(m_scale);
+    return level >= 0 && level < names.size() ? names.at(level) : QStringLiteral("Brak indeksu");
+}
+
+/**
+ * @brief Pobiera kolor poziomu bieżącej skali.
+ * @param level Poziom.
+ * @return Kolor w zapisie "#rrggbb".
+ */
+QString AirQualityIndex::levelColor(int level) const
+{
+    const QStringList &colors = levelColors(m_scale);
+    return level >= 0 && level < colors.size() ? colors.at(level) : QStringLiteral("#9e9e9e");
+}
+
+/**
+ * @brief Pobiera legendę bieżącej skali.
+ * @return Lista map {level, name, color}.
+ */
+QVariantList AirQualityIndex::legend() const
+{
+    QVariantList entries;
+    for (int level = 0; level < levelNames(m_scale).size(); ++level)
+        entries.append(QVariantMap { { "level", level }, { "name", levelName(level) }, { "color", levelColor(level) } });
+    return entries;
+}
+
+/**
+ * @brief Uruchamia przegląd katalogu bez czekania na pełną godzinę.
+ */
+void AirQualityIndex::refreshNow()
+{
+    startCycle();
+}
+
+/**
+ * @brief Rozpoczyna przegląd wszystkich stacji katalogu.
+ */
+void AirQualityIndex::startCycle()
+{
+    m_cycleHour = StationMonitor::currentMeasurementHour(QDateTime::currentDateTimeUtc());
+    for (int stationId : std::as_const(m_catalog))
+        m_fetch->enqueueStation(stationId);
+}
+
+/**
+ * @brief Ustawia wybudzenie na najbliższą godzinę publikacji.
+ */
+void AirQualityIndex::scheduleNext()
+{
+    const QDateTime now = QDateTime::currentDateTime();
+    m_wakeTimer.start(int(qMax<qint64>(1000, now.msecsTo(StationMonitor::nextWakeUp(now, kPublicationDelayMinutes)))));
+}
+
+/**
+ * @brief Przypisuje sensory stacji i dodaje do kolejki sensory zanieczyszczeń indeksu.
+ * @param stationId Identyfikator stacji.
+ * @param sensors Sensory stacji.
+ *
+ * Pomijane są sensory, których pomiar z bieżącej godziny jest już w indeksie.
+ */
+void AirQualityIndex::onSensorsReady(int stationId, const QList<SensorInfo> &sensors)
+{
+    setSensors(stationId, sensors);
+    const StationAirQuality station = m_stations.value(stationId);
+    for (const SensorInfo &sensor : sensors) {
+        const auto ref = m_sensors.constFind(sensor.sensorId);
+        if (ref == m_sensors.constEnd() || ref->stationId != stationId)
+            continue;
+        if (StationMonitor::isStale(station.readings.value(ref->pollutant).timestamp, m_cycleHour))
+            m_fetch->enqueueSensor(stationId, sensor.sensorId);
+    }
+}
@@ -0,0 +1,302 @@
+/**
+ * @file airqualityindex.h
+ * @brief Plik nagłówkowy dla klasy AirQualityIndex.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje indeks jakości powietrza (Polski Indeks Jakości Powietrza lub CAQI)
+ * wyznaczany dla wszystkich stacji katalogu z najnowszych pomiarów PM10, PM2.5, NO2, O3 i SO2.
+ */
+
+#ifndef AIRQUALITYINDEX_H
+#define AIRQUALITYINDEX_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+#include <QVariantList>
+#include <QVariantMap>
+#include "apiclient.h"
+#include "replyparser.h"
+#include "sensorseries.h"
+#include "stationfetchqueue.h"
+
+/**
+ * @struct AirQualityReading
+ * @brief Najnowszy niepusty pomiar zanieczyszczenia.
+ */
+struct AirQualityReading {
+    qint64 timestamp = -1;   ///< Znacznik czasu ściennego w sekundach (jak w SensorSeries); -1 oznacza brak.
+    double value = 0.0;      ///< Wartość w µg/m³.
+};
+
+/**
+ * @struct StationAirQuality
+ * @brief Najnowsze pomiary stacji i wyznaczony z nich indeks.
+ */
+struct StationAirQuality {
+    QHash<QString, AirQualityReading> readings;   ///< Pomiary według kodu zanieczyszczenia.
+    int level = -1;                               ///< Poziom indeksu (-1 bez danych).
+    QString pollutant;                            ///< Zanieczyszczenie decydujące o poziomie.
+    qint64 timestamp = -1;                        ///< Godzina najnowszego pomiaru użytego w indeksie.
+};
+
+/**
+ * @class AirQualityIndex
+ * @brief Indeks jakości powietrza wszystkich stacji, aktualizowany przyrostowo.
+ *
+ * Poziom stacji to najgorszy z indeksów cząstkowych zanieczyszczeń, liczonych z progów
+ * godzinowych wybranej skali. Pod uwagę brane są pomiary nie starsze niż kMaxReadingAgeHours
+ * od najnowszego pomiaru stacji, więc sensor, który przestał raportować, nie zawyża indeksu.
+ *
+ * Pomiary trafiają do indeksu z trzech źródeł: otwartej stacji (updateSensor() wywoływane
+ * przez MainWindow), monitora obserwowanych stacji oraz własnego przeglądu całego katalogu.
+ * Przegląd korzysta z tej samej StationFetchQueue co StationMonitor: listy sensorów (ważne
+ * dobę) i pomiary tylko pięciu zanieczyszczeń indeksu, z priorytetem Background, najwyżej
+ * kilka żądań naraz, z parsowaniem odpowiedzi we wspólnym parserze zadań w tle; powtarza się
+ * co godzinę po publikacji pomiarów.
+ * Zmiany z jednej iteracji pętli zdarzeń są przeliczane razem (przy dużej liczbie stacji
+ * równolegle w puli wątków) i zgłaszane jednym sygnałem levelsChanged().
+ */
+class AirQualityIndex : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(Scale scale READ scale WRITE setScale NOTIFY scaleChanged)
+    Q_PROPERTY(int ratedStations READ ratedStations NOTIFY levelsChanged)
+    Q_PROPERTY(bool busy READ isBusy NOTIFY busyChanged)
+    Q_PROPERTY(QVariantList legend READ legend NOTIFY scaleChanged)
+
+public:
+    /// Skala indeksu.
+    enum Scale {
+        Polish,   ///< Polski Indeks Jakości Powietrza (GIOŚ), poziomy 0-5.
+        Caqi      ///< Europejski CAQI (progi godzinowe), poziomy 0-4.
+    };
+    Q_ENUM(Scale)
+
+    /// Maksymalny wiek pomiaru względem najnowszego pomiaru stacji w godzinach.
+    static constexpr int kMaxReadingAgeHours = 3;
+
+    /**
+     * @brief Konstruktor obiektu AirQualityIndex.
+     * @param apiClient Klient HTTP.
+     * @param parser Parser odpowiedzi (wspólny dla zadań w tle).
+     * @param parent Rodzic QObject.
+     */
+    AirQualityIndex(ApiClient *apiClient, ReplyParser *parser, QObject *parent = nullptr);
+
+    /**
+     * @brief Sprawdza, czy przegląd katalogu jest włączony.
+     * @return True, jeśli indeks jest odświeżany dla całego katalogu.
+     */
+    bool isEnabled() const { return m_enabled; }
+
+    /**
+     * @brief Włącza lub wyłącza przegląd katalogu.
+     * @param enabled True, aby włączyć przegląd.
+     *
+     * Włączenie uruchamia od razu przegląd wszystkich stacji; wyłączenie unieważnia trwające żądania.
+     * Pomiary z otwartej stacji i monitora trafiają do indeksu niezależnie od tego ustawienia.
+     */
+    void setEnabled(bool enabled);
+
+    /**
+     * @brief Pobiera skalę indeksu.
+     * @return Skala.
+     */
+    Scale scale() const { return m_scale; }
+
+    /**
+     * @brief Ustawia skalę indeksu i przelicza wszystkie stacje.
+     * @param scale Skala.
+     */
+    void setScale(Scale scale);
+
+    /**
+     * @brief Pobiera liczbę stacji z wyznaczonym indeksem.
+     * @return Liczba stacji.
+     */
+    int ratedStations() const { return m_ratedStations; }
+
+    /**
+     * @brief Sprawdza, czy trwa przegląd katalogu.
+     * @return True, jeśli są żądania w kolejce lub w toku.
+     */
+    bool isBusy() const { return m_fetch->isBusy(); }
+
+    /**
+     * @brief Ustawia stacje katalogu objęte przeglądem.
+     * @param stationIds Identyfikatory stacji.
+     *
+     * Dane stacji usuniętych z katalogu są odrzucane.
+     */
+    void setStations(const QList<int> &stationIds);
+
+    /**
+     * @brief Zapamiętuje sensory stacji (przypisanie sensora do stacji i zanieczyszczenia).
+     * @param stationId Identyfikator stacji.
+     * @param sensors Sensory stacji.
+     */
+    void setSensors(int stationId, const QList<SensorInfo> &sensors);
+
+    /**
+     * @brief Nanosi najnowszy pomiar sensora.
+     * @param sensorId Identyfikator sensora.
+     * @param series Pomiary sensora (uporządkowane rosnąco według czasu).
+     *
+     * Sensory nieprzypisane w setSensors() i zanieczyszczenia spoza indeksu są pomijane.
+     */
+    void updateSensor(int sensorId, const SensorSeries &series);
+
+    /**
+     * @brief Pobiera poziom indeksu stacji.
+     * @param stationId Identyfikator stacji.
+     * @return Poziom lub -1, jeśli stacja nie ma pomiarów.
+     */
+    int level(int stationId) const { return m_stations.value(stationId).level; }
+
+    /**
+     * @brief Pobiera najnowsze pomiary zanieczyszczenia we wszystkich stacjach.
+     * @param pollutant Kod zanieczyszczenia (np. "PM10").
+     * @return Pomiar według identyfikatora stacji.
+     */
+    QHash<int, AirQualityReading> readings(const QString &pollutant) const;
+
+    /**
+     * @brief Pobiera szczegóły indeksu stacji.
+     * @param stationId Identyfikator stacji.
+     * @return Mapa: level, name, color, pollutant, date i subIndexes (kod -> {value, level}).
+     */
+    Q_INVOKABLE QVariantMap stationIndex(int stationId) const;
+
+    /**
+     * @brief Pobiera nazwę poziomu bieżącej skali.
+     * @param level Poziom.
+     * @return Nazwa (np. "Dobry") lub "Brak indeksu".
+     */
+    Q_INVOKABLE QString levelName(int level) const;
+
+    /**
+     * @brief Pobiera kolor poziomu bieżącej skali.
+     * @param level Poziom.
+     * @return Kolor w zapisie "#rrggbb" (szary dla -1).
+     */
+    Q_INVOKABLE QString levelColor(int level) const;
+
+    /**
+     * @brief Pobiera legendę bieżącej skali.
+     * @return Lista map {level, name, color}.
+     */
+    QVariantList legend() const;
+
+    /**
+     * @brief Uruchamia przegląd katalogu bez czekania na pełną godzinę.
+     */
+    Q_INVOKABLE void refreshNow();
+
+    /**
+     * @brief Pobiera kody zanieczyszczeń uwzględnianych w indeksie.
+     * @return Lista kodów (PM10, PM2.5, NO2, O3, SO2).
+     */
+    static const QStringList &pollutants();
+
+    /**
+     * @brief Pobiera kolory poziomów skali.
+     * @param scale Skala.
+     * @return Kolory "#rrggbb" od najlepszego poziomu.
+     */
+    static const QStringList &levelColors(Scale scale);
+
+    /**
+     * @brief Wyznacza indeks cząstkowy zanieczyszczenia.
+     * @param scale Skala.
+     * @param pollutant Kod zanieczyszczenia.
+     * @param value Stężenie w µg/m³.
+     * @return Poziom lub -1 dla nieznanego zanieczyszczenia i niepoprawnej wartości.
+     */
+    static int subIndex(Scale scale, const QString &pollutant, double value);
+
+    /**
+     * @brief Wyznacza poziom stacji z jej najnowszych pomiarów.
+     * @param scale Skala.
+     * @param station Pomiary stacji; wynik trafia do pól level, pollutant i timestamp.
+     */
+    static void evaluate(Scale scale, StationAirQuality &station);
+
+signals:
+    /**
+     * @brief Sygnał emitowany po włączeniu lub wyłączeniu przeglądu.
+     */
+    void enabledChanged();
+
+    /**
+     * @brief Sygnał emitowany po zmianie skali.
+     */
+    void scaleChanged();
+
+    /**
+     * @brief Sygnał emitowany po rozpoczęciu lub zakończeniu przeglądu.
+     */
+    void busyChanged();
+
+    /**
+     * @brief Sygnał emitowany po zmianie poziomów stacji.
+     * @param stationIds Stacje, których poziom się zmienił.
+     */
+    void levelsChanged(const QList<int> &stationIds);
+
+    /**
+     * @brief Sygnał emitowany po naniesieniu nowych pomiarów (także bez zmiany poziomów).
+     */
+    void readingsChanged();
+
+private slots:
+    /**
+     * @brief Przypisuje sensory stacji i dodaje do kolejki sensory zanieczyszczeń indeksu.
+     * @param stationId Identyfikator stacji.
+     * @param sensors Sensory stacji.
+     */
+    void onSensorsReady(int stationId, const QList<SensorInfo> &sensors);
+
+private:
+    /**
+     * @struct SensorRef
+     * @brief Przypisanie sensora do stacji i zanieczyszczenia.
+     */
+    struct SensorRef {
+        int stationId = 0;   ///< Identyfikator stacji.
+        QString pollutant;   ///< Kod zanieczyszczenia.
+    };
+
+    /**
+     * @brief Rozpoczyna przegląd wszystkich stacji katalogu.
+     */
+    void startCycle();
+
+    /**
+     * @brief Ustawia wybudzenie na najbliższą godzinę publikacji.
+     */
+    void scheduleNext();
+
+    /**
+     * @brief Przelicza poziomy zmienionych stacji i zgłasza zmiany.
+     */
+    void recompute();
+
+    StationFetchQueue *m_fetch;                   ///< Kolejka żądań przeglądu.
+    bool m_enabled = false;                       ///< Czy przegląd katalogu jest włączony.
+    Scale m_scale = Polish;                       ///< Skala indeksu.
+    QList<int> m_catalog;                         ///< Stacje katalogu.
+    QHash<int, StationAirQuality> m_stations;     ///< Pomiary i indeks według stacji.
+    QHash<int, SensorRef> m_sensors;              ///< Przypisanie sensorów zanieczyszczeń indeksu.
+    QSet<int> m_dirty;                            ///< Stacje z nowymi pomiarami do przeliczenia.
+    QTimer m_recomputeTimer;                      ///< Łączenie zmian w jedno przeliczenie.
+    int m_ratedStations = 0;                      ///< Stacje z wyznaczonym indeksem.
+    QTimer m_wakeTimer;                           ///< Wybudzenie w najbliższej godzinie publikacji.
+    qint64 m_cycleHour = 0;                       ///< Godzina pomiarowa bieżącego przeglądu.
+};
+
+#endif // AIRQUALITYINDEX_H
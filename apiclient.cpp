@@ -0,0 +1,386 @@
+/**
+ * @file apiclient.cpp
+ * @brief Implementacja klasy ApiClient.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera implementację klienta HTTP z dyskową pamięcią podręczną,
+ * czasem ważności zależnym od zasobu i rewalidacją warunkową w tle.
+ */
+
+#include "apiclient.h"
+#include "metricsregistry.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QNetworkRequest>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QTimer>
+
+namespace {
+/**
+ * @brief Zlicza wynik wyszukiwania w pamięci podręcznej.
+ * @param url Adres żądania.
+ * @param cached Wpis z pamięci podręcznej (pusty przy braku wpisu).
+ * @param now Bieżący czas.
+ */
+void recordCacheLookup(const QUrl &url, const CacheEntry &cached, const QDateTime &now)
+{
+    const QString result = !cached.isValid() ? "miss" : cached.isFresh(now) ? "fresh" : "stale";
+    MetricsRegistry::instance().add("gios_http_cache_lookups_total",
+                                    QString("endpoint=%1,result=%2").arg(ApiClient::endpointForUrl(url), result));
+}
+}
+
+/**
+ * @brief Konstruktor obiektu ApiClient.
+ * @param parent Rodzic QObject.
+ */
+ApiClient::ApiClient(QObject *parent)
+    : QObject(parent),
+    m_networkManager(new QNetworkAccessManager(this)),
+    m_scheduler(new RequestScheduler(m_networkManager, this))
+{
+    // Nominatim dopuszcza najwyżej jedno żądanie na sekundę
+    HostPolicy nominatim;
+    nominatim.ratePerSecond = 1.0;
+    nominatim.burst = 1;
+    nominatim.maxConcurrent = 1;
+    m_scheduler->setHostPolicy("nominatim.openstreetmap.org", nominatim);
+
+    // GIOŚ: krótka seria przy otwarciu stacji (lista sensorów i ich pomiary), potem stałe tempo
+    HostPolicy gios;
+    gios.ratePerSecond = 2.0;
+    gios.burst = 8;
+    gios.maxConcurrent = 4;
+    m_scheduler->setHostPolicy("api.gios.gov.pl", gios);
+}
+
+/**
+ * @brief Wysyła żądanie GET z obsługą pamięci podręcznej.
+ * @param url Adres żądania.
+ * @param context Obiekt kontekstu funkcji obsługi (nie może być pusty).
+ * @param callback Funkcja obsługi.
+ *
+ * Świeży wpis jest zwracany bez zapytania do sieci. Przeterminowany wpis jest zwracany od razu
+ * i równolegle rewalidowany; brak wpisu oznacza zwykłe żądanie sieciowe.
+ */
+void ApiClient::get(const QUrl &url, QObject *context, const ApiCallback &callback, const RequestOptions &options)
+{
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    if (ttlForUrl(url, now) <= 0) {
+        fetch(url, context, callback, CacheEntry(), options);
+        return;
+    }
+
+    const CacheEntry cached = m_cache.load(url);
+    recordCacheLookup(url, cached, now);
+    if (!cached.isValid()) {
+        fetch(url, context, callback, CacheEntry(), options);
+        return;
+    }
+
+    ApiResponse response;
+    response.body = cached.body;
+    response.fromCache = true;
+    response.stale = !cached.isFresh(now);
+    deliverQueued(context, callback, response);
+
+    if (response.stale)
+        fetch(url, context, callback, cached, options);
+}
+
+/**
+ * @brief Wysyła żądanie GET i przekazuje treść fragmentami w miarę jej nadchodzenia.
+ * @param url Adres żądania.
+ * @param context Obiekt, którego zniszczenie anuluje wywołanie funkcji obsługi.
+ * @param chunkCallback Funkcja obsługi kolejnego fragmentu treści.
+ * @param callback Funkcja obsługi końca odpowiedzi (treść w ApiResponse jest pusta).
+ * @param options Priorytet i grupa żądania.
+ *
+ * Strumieniowo przekazywana jest tylko odpowiedź bez wpisu w pamięci podręcznej; przy
+ * rewalidacji treść trzeba najpierw porównać z zapisaną, więc trafia jednym fragmentem.
+ */
+void ApiClient::getStreamed(const QUrl &url, QObject *context, const ApiChunkCallback &chunkCallback, const ApiCallback &callback,
+                            const RequestOptions &options)
+{
+    const ApiCallback whole = [chunkCallback, callback](const ApiResponse &response) {
+        if (response.ok() && !response.body.isEmpty())
+            chunkCallback(response.body);
+        ApiResponse done = response;
+        done.body.clear();
+        callback(done);
+    };
+
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    const bool cacheable = ttlForUrl(url, now) > 0;
+    const CacheEntry cached = cacheable ? m_cache.load(url) : CacheEntry();
+    if (cacheable)
+        recordCacheLookup(url, cached, now);
+    if (!cached.isValid()) {
+        fetch(url, context, callback, CacheEntry(), options, chunkCallback);
+        return;
+    }
+
+    ApiResponse response;
+    response.body = cached.body;
+    response.fromCache = true;
+    response.stale = !cached.isFresh(now);
+    deliverQueued(context, whole, response);
+
+    if (response.stale)
+        fetch(url, context, whole, cached, options);
+}
+
+/**
+ * @brief Pobiera najnowszą treść zasobu, wywołując funkcję obsługi dokładnie raz.
+ * @param url Adres żądania.
+ * @param context Obiekt, którego zniszczenie anuluje wywołanie funkcji obsługi.
+ * @param chunkCallback Funkcja obsługi kolejnego fragmentu treści.
+ * @param callback Funkcja obsługi końca odpowiedzi (treść w ApiResponse jest pusta).
+ * @param options Priorytet i grupa żądania.
+ *
+ * W przeciwieństwie do getStreamed() przeterminowany wpis nie jest przekazywany przed
+ * rewalidacją, więc wywołujący dostaje jedną odpowiedź: świeżą treść z pamięci podręcznej,
+ * treść z sieci, flagę notModified, błąd albo anulowanie.
+ */
+void ApiClient::getLatest(const QUrl &url, QObject *context, const ApiChunkCallback &chunkCallback, const ApiCallback &callback,
+                          const RequestOptions &options)
+{
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    const bool cacheable = ttlForUrl(url, now) > 0;
+    const CacheEntry cached = cacheable ? m_cache.load(url) : CacheEntry();
+    if (cacheable)
+        recordCacheLookup(url, cached, now);
+    if (cached.isValid() && cached.isFresh(now)) {
+        QTimer::singleShot(0, context, [chunkCallback, callback, body = cached.body]() {
+            if (!body.isEmpty())
+                chunkCallback(body);
+            ApiResponse response;
+            response.fromCache = true;
+            callback(response);
+        });
+        return;
+    }
+
+    fetch(url, context, callback, cached, options, chunkCallback, true);
+}
+
+/**
+ * @brief Wyznacza czas ważności odpowiedzi dla zasobu.
+ * @param url Adres żądania.
+ * @param now Bieżący czas.
+ * @return Czas ważności w sekundach; 0 oznacza brak zapisu w pamięci podręcznej.
+ */
+qint64 ApiClient::ttlForUrl(const QUrl &url, const QDateTime &now)
+{
+    const QString path = url.path();
+    if (path.endsWith("/station/findAll"))
+        return 3 * 24 * 3600;
+    if (path.contains("/station/sensors/"))
+        return 24 * 3600;
+    if (path.contains("/data/getData/")) {
+        // Pomiary nowej godziny pojawiają się kilka minut po jej początku; wcześniejsza
+        // rewalidacja zwróciłaby te same dane
+        QDateTime publication = now;
+        publication.setTime(QTime(now.time().hour(), kPublicationDelayMinutes));
+        if (publication <= now)
+            publication = publication.addSecs(3600);
+        return qMax<qint64>(1, now.secsTo(publication));
+    }
+    return 0;
+}
+
+/**
+ * @brief Wyznacza nazwę zasobu API do etykiet metryk.
+ * @param url Adres żądania.
+ * @return "findAll", "sensors", "getData", "geocode" lub "other".
+ */
+QString ApiClient::endpointForUrl(const QUrl &url)
+{
+    const QString path = url.path();
+    if (path.endsWith("/station/findAll"))
+        return QStringLiteral("findAll");
+    if (path.contains("/station/sensors/"))
+        return QStringLiteral("sensors");
+    if (path.contains("/data/getData/"))
+        return QStringLiteral("getData");
+    if (path.endsWith("/search"))
+        return QStringLiteral("geocode");
+    return QStringLiteral("other");
+}
+
+/**
+ * @brief Pobiera adres bazowy API GIOŚ.
+ * @return Wartość zmiennej środowiskowej GIOS_API_URL lub adres produkcyjny API.
+ */
+QString ApiClient::giosApiUrl()
+{
+    return qEnvironmentVariable("GIOS_API_URL", QStringLiteral("https://api.gios.gov.pl/pjp-api/rest"));
+}
+
+/**
+ * @brief Pobiera adres wyszukiwania miast w Nominatim.
+ * @return Wartość zmiennej środowiskowej GIOS_GEOCODER_URL lub adres produkcyjny usługi.
+ */
+QString ApiClient::geocoderUrl()
+{
+    return qEnvironmentVariable("GIOS_GEOCODER_URL", QStringLiteral("https://nominatim.openstreetmap.org/search"));
+}
+
+/**
+ * @brief Wysyła żądanie sieciowe.
+ * @param url Adres żądania.
+ * @param context Obiekt kontekstu funkcji obsługi.
+ * @param callback Funkcja obsługi.
+ * @param cached Dotychczasowy wpis (do rewalidacji); pusty dla zwykłego żądania.
+ * @param options Priorytet i grupa żądania.
+ * @param chunkCallback Opcjonalna funkcja obsługi fragmentów treści (tylko bez rewalidacji).
+ *
+ * Żądanie trafia do kolejki RequestScheduler; rewalidacja ma zawsze priorytet Background.
+ * Z funkcją chunkCallback treść odpowiedzi 2xx przekazywana jest przy każdym readyRead
+ * (treść odpowiedzi błędnych, np. 503 przed ponowieniem, jest pomijana), a pełna treść
+ * gromadzona jest tylko wtedy, gdy odpowiedź trafi do pamięci podręcznej.
+ * Przy rewalidacji odpowiedź 304 tylko przedłuża ważność wpisu, błąd sieci jest pomijany
+ * (użytkownik ma już dane z pamięci podręcznej), a funkcja obsługi jest wywoływana
+ * wyłącznie wtedy, gdy treść faktycznie się zmieniła (z flagą reportAlways funkcja obsługi
+ * jest wywoływana zawsze, a 304 ma flagę notModified). Unieważnione żądanie kończy się
+ * odpowiedzią z flagą cancelled. Czas od wywołania (z oczekiwaniem w kolejce), status
+ * i liczba odebranych bajtów trafiają do MetricsRegistry z etykietą zasobu.
+ */
+void ApiClient::fetch(const QUrl &url, QObject *context, const ApiCallback &callback, const CacheEntry &cached,
+                      const RequestOptions &options, const ApiChunkCallback &chunkCallback, bool reportAlways)
+{
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    request.setHeader(QNetworkRequest::UserAgentHeader, "ControlStationsApp/1.0");
+    if (cached.isValid()) {
+        if (!cached.etag.isEmpty())
+            request.setRawHeader("If-None-Match", cached.etag);
+        if (!cached.lastModified.isEmpty())
+            request.setRawHeader("If-Modified-Since", cached.lastModified);
+    }
+
+    RequestOptions scheduling = options;
+    if (cached.isValid() && !reportAlways)
+        scheduling.priority = RequestPriority::Background;
+
+    QPointer<QObject> guard(context);
+    const bool keepBody = ttlForUrl(url, QDateTime::currentDateTimeUtc()) > 0;
+    const QSharedPointer<QByteArray> streamedBody = QSharedPointer<QByteArray>::create();
+    const QString endpoint = "endpoint=" + endpointForUrl(url);
+    QElapsedTimer started;
+    started.start();
+
+    RequestScheduler::StartedHandler onStarted;
+    if (chunkCallback) {
+        onStarted = [guard, chunkCallback, streamedBody, keepBody, endpoint](QNetworkReply *reply) {
+            QObject::connect(reply, &QNetworkReply::readyRead, reply, [reply, guard, chunkCallback, streamedBody, keepBody, endpoint]() {
+                const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+                if (status < 200 || status >= 300)
+                    return;
+                const QByteArray chunk = reply->readAll();
+                MetricsRegistry::instance().add("gios_http_received_bytes_total", endpoint, chunk.size());
+                if (keepBody)
+                    streamedBody->append(chunk);
+                if (guard && !chunk.isEmpty())
+                    chunkCallback(chunk);
+            });
+        };
+    }
+
+    m_scheduler->submit(request, scheduling, onStarted,
+                        [this, url, guard, callback, cached, chunkCallback, streamedBody, reportAlways, endpoint, started](QNetworkReply *reply, bool cancelled) {
+        MetricsRegistry &metrics = MetricsRegistry::instance();
+        if (cancelled) {
+            metrics.add("gios_http_responses_total", endpoint + ",status=cancelled");
+            if ((!cached.isValid() || reportAlways) && guard) {
+                ApiResponse response;
+                response.error = "Żądanie anulowane";
+                response.cancelled = true;
+                callback(response);
+            }
+            return;
+        }
+
+        const QDateTime now = QDateTime::currentDateTimeUtc();
+        const qint64 ttl = ttlForUrl(url, now);
+        const int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        metrics.observe("gios_http_request_duration_ms", endpoint, started.nsecsElapsed() / 1e6);
+        metrics.add("gios_http_responses_total", endpoint + ",status=" + (httpStatus > 0 ? QString::number(httpStatus) : QString("error")));
+
+        if (cached.isValid() && httpStatus == 304) {
+            CacheEntry revalidated = cached;
+            revalidated.storedAt = now;
+            revalidated.expiresAt = now.addSecs(ttl);
+            m_cache.store(url, revalidated);
+            if (reportAlways && guard) {
+                ApiResponse response;
+                response.fromCache = true;
+                response.notModified = true;
+                callback(response);
+            }
+            return;
+        }
+
+        if (reply->error() != QNetworkReply::NoError) {
+            if (cached.isValid() && !reportAlways) {
+                qDebug() << "Rewalidacja nie powiodła się, pozostają dane z pamięci podręcznej:" << url << reply->errorString();
+                return;
+            }
+            if (guard) {
+                ApiResponse response;
+                response.error = reply->errorString();
+                callback(response);
+            }
+            return;
+        }
+
+        ApiResponse response;
+        if (chunkCallback) {
+            const QByteArray rest = reply->readAll();
+            metrics.add("gios_http_received_bytes_total", endpoint, rest.size());
+            if (!rest.isEmpty()) {
+                if (ttl > 0)
+                    streamedBody->append(rest);
+                if (guard)
+                    chunkCallback(rest);
+            }
+        } else {
+            response.body = reply->readAll();
+            metrics.add("gios_http_received_bytes_total", endpoint, response.body.size());
+        }
+
+        if (ttl > 0) {
+            CacheEntry entry;
+            entry.body = chunkCallback ? *streamedBody : response.body;
+            entry.etag = reply->rawHeader("ETag");
+            entry.lastModified = reply->rawHeader("Last-Modified");
+            entry.storedAt = now;
+            entry.expiresAt = now.addSecs(ttl);
+            m_cache.store(url, entry);
+        }
+
+        // Rewalidacja bez zmian treści nie wymaga ponownego przetwarzania
+        if (cached.isValid() && !reportAlways && cached.body == response.body)
+            return;
+
+        if (guard)
+            callback(response);
+    });
+}
+
+/**
+ * @brief Wywołuje funkcję obsługi w kolejnej iteracji pętli zdarzeń.
+ * @param context Obiekt kontekstu funkcji obsługi.
+ * @param callback Funkcja obsługi.
+ * @param response Odpowiedź do przekazania.
+ *
+ * Dzięki temu odpowiedź z pamięci podręcznej jest obsługiwana tak samo asynchronicznie jak odpowiedź sieciowa.
+ */
+void ApiClient::deliverQueued(QObject *context, const ApiCallback &callback, const ApiResponse &response)
+{
+    QTimer::singleShot(0, context, [callback, response]() {
+        callback(response);
+    });
+}
@@ -0,0 +1,190 @@
+/**
+ * @file apiclient.h
+ * @brief Plik nagłówkowy dla klasy ApiClient.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje klienta HTTP używanego do komunikacji z API GIOŚ i Nominatim,
+ * z trwałą pamięcią podręczną odpowiedzi i rewalidacją warunkową.
+ */
+
+#ifndef APICLIENT_H
+#define APICLIENT_H
+
+#include <QObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QUrl>
+#include <functional>
+#include "requestscheduler.h"
+#include "responsecache.h"
+
+/**
+ * @struct ApiResponse
+ * @brief Wynik żądania przekazywany do funkcji obsługi.
+ */
+struct ApiResponse {
+    QByteArray body;         ///< Treść odpowiedzi.
+    QString error;           ///< Opis błędu; pusty oznacza powodzenie.
+    bool fromCache = false;  ///< True, jeśli treść pochodzi z pamięci podręcznej.
+    bool stale = false;      ///< True, jeśli wpis był przeterminowany i trwa jego rewalidacja.
+    bool cancelled = false;  ///< True, jeśli żądanie zostało unieważnione (RequestScheduler::cancelGroup()).
+    bool notModified = false; ///< True, jeśli serwer potwierdził (304), że zapisana treść jest aktualna (tylko getLatest()).
+
+    /**
+     * @brief Sprawdza, czy żądanie zakończyło się powodzeniem.
+     * @return True, jeśli nie wystąpił błąd.
+     */
+    bool ok() const { return error.isEmpty(); }
+};
+
+/// Funkcja obsługi odpowiedzi.
+using ApiCallback = std::function<void(const ApiResponse &)>;
+
+/// Funkcja obsługi kolejnego fragmentu treści odpowiedzi.
+using ApiChunkCallback = std::function<void(const QByteArray &)>;
+
+/**
+ * @class ApiClient
+ * @brief Klient HTTP z dyskową pamięcią podręczną i czasem ważności zależnym od zasobu.
+ *
+ * Świeży wpis jest zwracany bez zapytania do sieci. Przeterminowany wpis jest zwracany
+ * natychmiast, a w tle wysyłane jest żądanie warunkowe (If-None-Match / If-Modified-Since);
+ * jeśli serwer zwróci nową treść, funkcja obsługi jest wywoływana ponownie.
+ *
+ * Żądania sieciowe przechodzą przez RequestScheduler: rewalidacja ma priorytet Background,
+ * a limity hostów GIOŚ i Nominatim są ustawiane w konstruktorze.
+ */
+class ApiClient : public QObject {
+    Q_OBJECT
+
+public:
+    /// Opóźnienie publikacji pomiarów GIOŚ względem pełnej godziny w minutach.
+    static constexpr int kPublicationDelayMinutes = 10;
+
+    /**
+     * @brief Konstruktor obiektu ApiClient.
+     * @param parent Rodzic QObject.
+     */
+    explicit ApiClient(QObject *parent = nullptr);
+
+    /**
+     * @brief Wysyła żądanie GET z obsługą pamięci podręcznej.
+     * @param url Adres żądania.
+     * @param context Obiekt, którego zniszczenie anuluje wywołanie funkcji obsługi.
+     * @param callback Funkcja obsługi; może zostać wywołana dwukrotnie (dane przeterminowane, potem nowe).
+     * @param options Priorytet i grupa żądania.
+     */
+    void get(const QUrl &url, QObject *context, const ApiCallback &callback,
+             const RequestOptions &options = RequestOptions());
+
+    /**
+     * @brief Wysyła żądanie GET i przekazuje treść fragmentami w miarę jej nadchodzenia.
+     * @param url Adres żądania.
+     * @param context Obiekt, którego zniszczenie anuluje wywołanie funkcji obsługi.
+     * @param chunkCallback Funkcja obsługi kolejnego fragmentu treści.
+     * @param callback Funkcja obsługi końca odpowiedzi (treść w ApiResponse jest pusta).
+     * @param options Priorytet i grupa żądania.
+     *
+     * Każda dostarczona treść to ciąg wywołań chunkCallback zakończony wywołaniem callback;
+     * podobnie jak w get() może wystąpić dwukrotnie. Treść z pamięci podręcznej i nowa treść
+     * po rewalidacji przekazywane są jednym fragmentem.
+     */
+    void getStreamed(const QUrl &url, QObject *context, const ApiChunkCallback &chunkCallback, const ApiCallback &callback,
+                     const RequestOptions &options = RequestOptions());
+
+    /**
+     * @brief Pobiera najnowszą treść zasobu, wywołując funkcję obsługi dokładnie raz.
+     * @param url Adres żądania.
+     * @param context Obiekt, którego zniszczenie anuluje wywołanie funkcji obsługi.
+     * @param chunkCallback Funkcja obsługi kolejnego fragmentu treści.
+     * @param callback Funkcja obsługi końca odpowiedzi (treść w ApiResponse jest pusta).
+     * @param options Priorytet i grupa żądania.
+     *
+     * Świeży wpis jest przekazywany jednym fragmentem bez zapytania do sieci. Przeterminowany
+     * wpis nie jest przekazywany: wysyłane jest żądanie warunkowe, a odpowiedź 304 kończy się
+     * flagą notModified bez treści. Przeznaczone dla odświeżania w tle, które musi wiedzieć,
+     * kiedy żądanie się zakończyło.
+     */
+    void getLatest(const QUrl &url, QObject *context, const ApiChunkCallback &chunkCallback, const ApiCallback &callback,
+                   const RequestOptions &options = RequestOptions());
+
+    /**
+     * @brief Pobiera pamięć podręczną odpowiedzi.
+     * @return Referencja do pamięci podręcznej.
+     */
+    ResponseCache &cache() { return m_cache; }
+
+    /**
+     * @brief Pobiera menedżera sieci.
+     * @return Wskaźnik na menedżera sieci.
+     */
+    QNetworkAccessManager *networkManager() const { return m_networkManager; }
+
+    /**
+     * @brief Pobiera kolejkę żądań.
+     * @return Wskaźnik na kolejkę żądań.
+     */
+    RequestScheduler *scheduler() const { return m_scheduler; }
+
+    /**
+     * @brief Wyznacza czas ważności odpowiedzi dla zasobu.
+     * @param url Adres żądania.
+     * @param now Bieżący czas.
+     * @return Czas ważności w sekundach; 0 oznacza brak zapisu w pamięci podręcznej.
+     *
+     * Katalog stacji jest ważny 3 dni, lista sensorów 1 dzień, a pomiary do najbliższej publikacji
+     * (pełna godzina plus kPublicationDelayMinutes).
+     */
+    static qint64 ttlForUrl(const QUrl &url, const QDateTime &now);
+
+    /**
+     * @brief Wyznacza nazwę zasobu API do etykiet metryk.
+     * @param url Adres żądania.
+     * @return "findAll", "sensors", "getData", "geocode" lub "other".
+     */
+    static QString endpointForUrl(const QUrl &url);
+
+    /**
+     * @brief Pobiera adres bazowy API GIOŚ.
+     * @return Wartość zmiennej środowiskowej GIOS_API_URL lub adres produkcyjny API.
+     *
+     * Zmienna pozwala uruchomić aplikację i testy z lokalnym serwerem zastępczym.
+     */
+    static QString giosApiUrl();
+
+    /**
+     * @brief Pobiera adres wyszukiwania miast w Nominatim.
+     * @return Wartość zmiennej środowiskowej GIOS_GEOCODER_URL lub adres produkcyjny usługi.
+     */
+    static QString geocoderUrl();
+
+private:
+    /**
+     * @brief Wysyła żądanie sieciowe.
+     * @param url Adres żądania.
+     * @param context Obiekt kontekstu funkcji obsługi.
+     * @param callback Funkcja obsługi.
+     * @param cached Dotychczasowy wpis (do rewalidacji); pusty dla zwykłego żądania.
+     * @param options Priorytet i grupa żądania.
+     * @param chunkCallback Opcjonalna funkcja obsługi fragmentów treści.
+     * @param reportAlways Czy wywołać funkcję obsługi także po 304, błędzie rewalidacji i niezmienionej treści.
+     */
+    void fetch(const QUrl &url, QObject *context, const ApiCallback &callback, const CacheEntry &cached,
+               const RequestOptions &options, const ApiChunkCallback &chunkCallback = ApiChunkCallback(),
+               bool reportAlways = false);
+
+    /**
+     * @brief Wywołuje funkcję obsługi w kolejnej iteracji pętli zdarzeń.
+     * @param context Obiekt kontekstu funkcji obsługi.
+     * @param callback Funkcja obsługi.
+     * @param response Odpowiedź do przekazania.
+     */
+    static void deliverQueued(QObject *context, const ApiCallback &callback, const ApiResponse &response);
+
+    QNetworkAccessManager *m_networkManager; ///< Menedżer sieci.
+    RequestScheduler *m_scheduler;           ///< Kolejka żądań z priorytetami i limitami hostów.
+    ResponseCache m_cache;                   ///< Dyskowa pamięć podręczna odpowiedzi.
+};
+
+#endif // APICLIENT_H
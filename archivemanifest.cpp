@@ -0,0 +1,321 @@
+/**
+ * @file archivemanifest.cpp
+ * @brief Implementacja klasy ArchiveManifest.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera implementację indeksu plików archiwalnych stacji.
+ */
+
+#include "archivemanifest.h"
+#include "stationarchive.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+
+namespace {
+/// Sygnatura pliku indeksu ("GARC").
+constexpr quint32 kManifestMagic = 0x47415243;
+/// Wersja formatu indeksu.
+constexpr quint16 kManifestVersion = 1;
+/// Opóźnienie uzgadniania po zmianie w katalogu w ms.
+constexpr int kRescanDelayMs = 250;
+
+/**
+ * @brief Tworzy klucz wyszukiwania wpisu.
+ * @param stationId Identyfikator stacji.
+ * @param saveDate Data zapisu.
+ * @return Klucz "stationId|saveDate".
+ */
+QString entryKey(int stationId, const QString &saveDate)
+{
+    return QString::number(stationId) + QLatin1Char('|') + saveDate;
+}
+}
+
+/**
+ * @brief Zamienia wpis na mapę dla QML.
+ * @return Mapa z polami stationId, cityName, address i saveDate.
+ */
+QVariantMap ArchiveEntry::toVariantMap() const
+{
+    QVariantMap map;
+    map["stationId"] = stationId;
+    map["cityName"] = cityName;
+    map["address"] = address;
+    map["saveDate"] = saveDate;
+    return map;
+}
+
+/**
+ * @brief Konstruktor obiektu ArchiveManifest.
+ * @param directory Katalog archiwum.
+ * @param parent Rodzic QObject.
+ *
+ * Zmiany w katalogu zgłaszane przez QFileSystemWatcher są łączone w jedno uzgodnienie.
+ */
+ArchiveManifest::ArchiveManifest(const QString &directory, QObject *parent)
+    : QObject(parent),
+    m_directory(directory)
+{
+    m_rescanTimer.setSingleShot(true);
+    m_rescanTimer.setInterval(kRescanDelayMs);
+    connect(&m_rescanTimer, &QTimer::timeout, this, &ArchiveManifest::rescan);
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, &m_rescanTimer, qOverload<>(&QTimer::start));
+}
+
+/**
+ * @brief Wczytuje indeks z pliku i uzgadnia go z zawartością katalogu.
+ */
+void ArchiveManifest::load()
+{
+    loadManifest();
+    rescan();
+    watchDirectory();
+}
+
+/**
+ * @brief Uzgadnia indeks z zawartością katalogu.
+ * @return True, jeśli indeks się zmienił.
+ *
+ * Pliki o niezmienionym rozmiarze i czasie modyfikacji nie są otwierane.
+ */
+bool ArchiveManifest::rescan()
+{
+    QDir dir(m_directory);
+    dir.setFilter(QDir::Files | QDir::NoDotAndDotDot);
+    dir.setNameFilters(QStringList() << "station_*.json" << "station_*.gar");
+    dir.setSorting(QDir::Name);
+
+    QList<ArchiveEntry> entries;
+    int parsed = 0;
+    const QFileInfoList fileList = dir.entryInfoList();
+    entries.reserve(fileList.size());
+    for (const QFileInfo &fileInfo : fileList) {
+        const qint64 size = fileInfo.size();
+        const qint64 modified = fileInfo.lastModified().toMSecsSinceEpoch();
+
+        const auto known = m_byFileName.constFind(fileInfo.fileName());
+        if (known != m_byFileName.constEnd()) {
+            const ArchiveEntry &entry = m_entries.at(known.value());
+            if (entry.size == size && entry.modified == modified) {
+                entries.append(entry);
+                continue;
+            }
+        }
+
+        ArchiveEntry entry;
+        if (!readHeader(fileInfo.absoluteFilePath(), entry)) {
+            qDebug() << "Nieprawidłowy plik archiwalny:" << fileInfo.absoluteFilePath();
+            continue;
+        }
+        entry.fileName = fileInfo.fileName();
+        entry.size = size;
+        entry.modified = modified;
+        entries.append(entry);
+        ++parsed;
+    }
+
+    const bool changed = parsed > 0 || entries.size() != m_entries.size();
+    if (!changed)
+        return false;
+
+    m_entries = entries;
+    rebuildLookup();
+    saveManifest();
+    emit entriesChanged();
+    return true;
+}
+
+/**
+ * @brief Dodaje lub zastępuje wpis dla właśnie zapisanego pliku.
+ * @param entry Nagłówek pliku; rozmiar i czas modyfikacji uzupełniane są z systemu plików.
+ *
+ * Późniejsze zgłoszenie obserwatora dla tego pliku nie powoduje jego ponownego parsowania.
+ */
+void ArchiveManifest::insert(const ArchiveEntry &entry)
+{
+    const QFileInfo fileInfo(QDir(m_directory).filePath(entry.fileName));
+    ArchiveEntry stored = entry;
+    stored.size = fileInfo.size();
+    stored.modified = fileInfo.lastModified().toMSecsSinceEpoch();
+
+    const auto known = m_byFileName.constFind(stored.fileName);
+    if (known != m_byFileName.constEnd()) {
+        m_entries[known.value()] = stored;
+    } else {
+        auto position = std::lower_bound(m_entries.begin(), m_entries.end(), stored.fileName,
+                                         [](const ArchiveEntry &existing, const QString &fileName) {
+                                             return existing.fileName < fileName;
+                                         });
+        m_entries.insert(position, stored);
+    }
+
+    rebuildLookup();
+    saveManifest();
+    watchDirectory();
+    emit entriesChanged();
+}
+
+/**
+ * @brief Zamienia wpisy na listę dla QML.
+ * @return Lista map z polami stationId, cityName, address i saveDate.
+ */
+QVariantList ArchiveManifest::toVariantList() const
+{
+    QVariantList list;
+    list.reserve(m_entries.size());
+    for (const ArchiveEntry &entry : m_entries)
+        list.append(entry.toVariantMap());
+    return list;
+}
+
+/**
+ * @brief Wyszukuje plik archiwum dla stacji i daty zapisu.
+ * @param stationId Identyfikator stacji.
+ * @param saveDate Data zapisu.
+ * @return Pełna ścieżka pliku lub pusty łańcuch, jeśli nie ma takiego zapisu.
+ */
+QString ArchiveManifest::filePath(int stationId, const QString &saveDate) const
+{
+    const auto found = m_byKey.constFind(entryKey(stationId, saveDate));
+    if (found == m_byKey.constEnd())
+        return QString();
+    return QDir(m_directory).filePath(m_entries.at(found.value()).fileName);
+}
+
+/**
+ * @brief Zwraca ścieżkę pliku indeksu.
+ * @return Ścieżka pliku archive.manifest w katalogu archiwum.
+ */
+QString ArchiveManifest::manifestPath() const
+{
+    return QDir(m_directory).filePath("archive.manifest");
+}
+
+/**
+ * @brief Odczytuje nagłówek pliku archiwalnego.
+ * @param path Ścieżka pliku.
+ * @param entry Wpis, do którego trafiają pola nagłówka.
+ * @return True, jeśli nagłówek został poprawnie wczytany.
+ *
+ * Dla plików .gar odczytywany jest tylko początek pliku.
+ */
+bool ArchiveManifest::readHeader(const QString &path, ArchiveEntry &entry)
+{
+    StationArchiveData data;
+    if (!StationArchive::loadHeader(path, data))
+        return false;
+
+    entry.stationId = data.stationId;
+    entry.cityName = data.cityName;
+    entry.address = data.address;
+    entry.saveDate = data.saveDate;
+    return true;
+}
+
+/**
+ * @brief Wczytuje plik indeksu.
+ * @return True, jeśli plik został poprawnie wczytany.
+ *
+ * Uszkodzony lub nieznany plik jest ignorowany; katalog zostanie wtedy zindeksowany od nowa.
+ */
+bool ArchiveManifest::loadManifest()
+{
+    QFile file(manifestPath());
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint32 count = 0;
+    in >> magic >> version >> count;
+    if (magic != kManifestMagic || version != kManifestVersion)
+        return false;
+
+    QList<ArchiveEntry> loaded;
+    loaded.reserve(qMin<quint32>(count, 100000));
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QByteArray fileName;
+        qint32 stationId = 0;
+        QByteArray city;
+        QByteArray address;
+        QByteArray saveDate;
+        ArchiveEntry entry;
+        in >> fileName >> stationId >> city >> address >> saveDate >> entry.size >> entry.modified;
+        entry.fileName = QString::fromUtf8(fileName);
+        entry.stationId = stationId;
+        entry.cityName = QString::fromUtf8(city);
+        entry.address = QString::fromUtf8(address);
+        entry.saveDate = QString::fromUtf8(saveDate);
+        loaded.append(entry);
+    }
+
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    m_entries = loaded;
+    rebuildLookup();
+    return true;
+}
+
+/**
+ * @brief Zapisuje plik indeksu.
+ */
+void ArchiveManifest::saveManifest() const
+{
+    QDir().mkpath(m_directory);
+
+    QSaveFile file(manifestPath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Nie można zapisać indeksu archiwum:" << manifestPath();
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kManifestMagic << kManifestVersion << quint32(m_entries.size());
+    for (const ArchiveEntry &entry : m_entries) {
+        out << entry.fileName.toUtf8() << qint32(entry.stationId) << entry.cityName.toUtf8()
+            << entry.address.toUtf8() << entry.saveDate.toUtf8() << entry.size << entry.modified;
+    }
+
+    if (out.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return;
+    }
+    file.commit();
+}
+
+/**
+ * @brief Odbudowuje tablicę wyszukiwania po zmianie listy wpisów.
+ */
+void ArchiveManifest::rebuildLookup()
+{
+    m_byFileName.clear();
+    m_byKey.clear();
+    m_byFileName.reserve(m_entries.size());
+    m_byKey.reserve(m_entries.size());
+    for (int i = 0; i < m_entries.size(); ++i) {
+        const ArchiveEntry &entry = m_entries.at(i);
+        m_byFileName.insert(entry.fileName, i);
+        m_byKey.insert(entryKey(entry.stationId, entry.saveDate), i);
+    }
+}
+
+/**
+ * @brief Dodaje katalog do obserwowanych, jeśli już istnieje.
+ */
+void ArchiveManifest::watchDirectory()
+{
+    if (m_watcher.directories().isEmpty() && QFileInfo::exists(m_directory))
+        m_watcher.addPath(m_directory);
+}
@@ -0,0 +1,155 @@
+/**
+ * @file archivemanifest.h
+ * @brief Plik nagłówkowy dla struktury ArchiveEntry i klasy ArchiveManifest.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje indeks zapisanych plików archiwalnych stacji, aktualizowany
+ * przyrostowo przy zapisie i po zmianach w katalogu archiwum.
+ */
+
+#ifndef ARCHIVEMANIFEST_H
+#define ARCHIVEMANIFEST_H
+
+#include <QObject>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QTimer>
+#include <QVariantList>
+
+/**
+ * @struct ArchiveEntry
+ * @brief Nagłówek jednego pliku archiwalnego stacji.
+ */
+struct ArchiveEntry {
+    QString fileName;     ///< Nazwa pliku w katalogu archiwum.
+    int stationId = 0;    ///< Identyfikator stacji.
+    QString cityName;     ///< Nazwa miasta.
+    QString address;      ///< Adres stacji.
+    QString saveDate;     ///< Data zapisu (ISO 8601).
+    qint64 size = -1;     ///< Rozmiar pliku w bajtach przy indeksowaniu.
+    qint64 modified = 0;  ///< Czas modyfikacji pliku przy indeksowaniu (ms od epoki).
+
+    /**
+     * @brief Zamienia wpis na mapę dla QML.
+     * @return Mapa z polami stationId, cityName, address i saveDate.
+     */
+    QVariantMap toVariantMap() const;
+};
+
+/**
+ * @class ArchiveManifest
+ * @brief Indeks plików station_*.json i station_*.gar w katalogu archiwum.
+ *
+ * Nagłówki plików przechowywane są w binarnym pliku archive.manifest obok archiwów.
+ * Przy wczytaniu i po sygnale QFileSystemWatcher porównywane są tylko nazwy, rozmiary
+ * i czasy modyfikacji plików, a parsowane są wyłącznie pliki nowe lub zmienione.
+ * Plik dla pary (stationId, saveDate) wyszukiwany jest w tablicy mieszającej.
+ */
+class ArchiveManifest : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Konstruktor obiektu ArchiveManifest.
+     * @param directory Katalog archiwum.
+     * @param parent Rodzic QObject.
+     */
+    explicit ArchiveManifest(const QString &directory, QObject *parent = nullptr);
+
+    /**
+     * @brief Pobiera katalog archiwum.
+     * @return Ścieżka katalogu.
+     */
+    QString directory() const { return m_directory; }
+
+    /**
+     * @brief Wczytuje indeks z pliku i uzgadnia go z zawartością katalogu.
+     */
+    void load();
+
+    /**
+     * @brief Uzgadnia indeks z zawartością katalogu.
+     * @return True, jeśli indeks się zmienił.
+     */
+    bool rescan();
+
+    /**
+     * @brief Dodaje lub zastępuje wpis dla właśnie zapisanego pliku.
+     * @param entry Nagłówek pliku; rozmiar i czas modyfikacji uzupełniane są z systemu plików.
+     */
+    void insert(const ArchiveEntry &entry);
+
+    /**
+     * @brief Pobiera wpisy posortowane według nazwy pliku.
+     * @return Lista wpisów.
+     */
+    const QList<ArchiveEntry> &entries() const { return m_entries; }
+
+    /**
+     * @brief Zamienia wpisy na listę dla QML.
+     * @return Lista map z polami stationId, cityName, address i saveDate.
+     */
+    QVariantList toVariantList() const;
+
+    /**
+     * @brief Wyszukuje plik archiwum dla stacji i daty zapisu.
+     * @param stationId Identyfikator stacji.
+     * @param saveDate Data zapisu.
+     * @return Pełna ścieżka pliku lub pusty łańcuch, jeśli nie ma takiego zapisu.
+     */
+    QString filePath(int stationId, const QString &saveDate) const;
+
+    /**
+     * @brief Zwraca ścieżkę pliku indeksu.
+     * @return Ścieżka pliku archive.manifest w katalogu archiwum.
+     */
+    QString manifestPath() const;
+
+    /**
+     * @brief Odczytuje nagłówek pliku archiwalnego.
+     * @param path Ścieżka pliku.
+     * @param entry Wpis, do którego trafiają pola nagłówka.
+     * @return True, jeśli nagłówek został poprawnie wczytany.
+     */
+    static bool readHeader(const QString &path, ArchiveEntry &entry);
+
+signals:
+    /**
+     * @brief Sygnał emitowany, gdy zmieni się lista wpisów.
+     */
+    void entriesChanged();
+
+private:
+    /**
+     * @brief Wczytuje plik indeksu.
+     * @return True, jeśli plik został poprawnie wczytany.
+     */
+    bool loadManifest();
+
+    /**
+     * @brief Zapisuje plik indeksu.
+     */
+    void saveManifest() const;
+
+    /**
+     * @brief Odbudowuje tablicę wyszukiwania po zmianie listy wpisów.
+     */
+    void rebuildLookup();
+
+    /**
+     * @brief Dodaje katalog do obserwowanych, jeśli już istnieje.
+     */
+    void watchDirectory();
+
+    QString m_directory;                 ///< Katalog archiwum.
+    QList<ArchiveEntry> m_entries;       ///< Wpisy posortowane według nazwy pliku.
+    QHash<QString, int> m_byFileName;    ///< Indeks wpisu według nazwy pliku.
+    QHash<QString, int> m_byKey;         ///< Indeks wpisu według klucza "stationId|saveDate".
+    QFileSystemWatcher m_watcher;        ///< Obserwator katalogu archiwum.
+    QTimer m_rescanTimer;                ///< Opóźnienie uzgadniania po serii zmian w katalogu.
+};
+
+#endif // ARCHIVEMANIFEST_H
@@ -0,0 +1,202 @@
+/**
+ * @file fieldinterpolator.cpp
+ * @brief Implementacja klas interpolacji przestrzennej pomiarów.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera rzut lokalny współrzędnych, interpolację IDW oraz rozwiązanie
+ * układu krigingu zwyczajnego.
+ */
+
+#include "fieldinterpolator.h"
+#include <QtMath>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace {
+/// Szerokość odniesienia rzutu lokalnego (środek Polski).
+constexpr double kReferenceLat = 52.0;
+
+/// Długość stopnia szerokości geograficznej w km.
+constexpr double kKmPerDegreeLat = 110.574;
+
+/// Długość stopnia długości geograficznej na równiku w km.
+constexpr double kKmPerDegreeLon = 111.320;
+}
+
+/**
+ * @brief Rzutuje współrzędne geograficzne na płaszczyznę lokalną.
+ * @param lat Szerokość geograficzna.
+ * @param lon Długość geograficzna.
+ * @return Punkt w km (z wartością 0).
+ */
+FieldInterpolator::Point FieldInterpolator::project(double lat, double lon)
+{
+    static const double kmPerDegreeLon = kKmPerDegreeLon * qCos(qDegreesToRadians(kReferenceLat));
+    return { lon * kmPerDegreeLon, lat * kKmPerDegreeLat, 0.0 };
+}
+
+/**
+ * @brief Rzutuje pomiary na płaszczyznę lokalną.
+ * @param samples Pomiary punktowe.
+ * @return Punkty w km; pomiary o wartości NaN są pomijane.
+ */
+QVector<FieldInterpolator::Point> FieldInterpolator::project(const QList<FieldSample> &samples)
+{
+    QVector<Point> points;
+    points.reserve(samples.size());
+    for (const FieldSample &sample : samples) {
+        if (qIsNaN(sample.value))
+            continue;
+        Point point = project(sample.lat, sample.lon);
+        point.value = sample.value;
+        points.append(point);
+    }
+    return points;
+}
+
+/**
+ * @brief Przygotowuje interpolację IDW.
+ * @param samples Pomiary punktowe.
+ */
+void InverseDistanceInterpolator::prepare(const QList<FieldSample> &samples)
+{
+    m_points = project(samples);
+}
+
+/**
+ * @brief Wyznacza wartość pola IDW w punkcie.
+ * @param lat Szerokość geograficzna.
+ * @param lon Długość geograficzna.
+ * @return Wartość lub NaN poza zasięgiem stacji.
+ *
+ * Dla wykładnika 2 waga to odwrotność kwadratu odległości, bez pierwiastkowania.
+ */
+double InverseDistanceInterpolator::estimate(double lat, double lon) const
+{
+    const Point target = project(lat, lon);
+    const bool squared = m_power == 2.0;
+    double nearest = std::numeric_limits<double>::max();
+    double weightSum = 0.0;
+    double valueSum = 0.0;
+    for (const Point &point : m_points) {
+        const double dx = point.x - target.x;
+        const double dy = point.y - target.y;
+        const double distanceSquared = dx * dx + dy * dy;
+        if (distanceSquared < 1e-12)
+            return point.value;
+        nearest = qMin(nearest, distanceSquared);
+        const double weight = squared ? 1.0 / distanceSquared : qPow(distanceSquared, -0.5 * m_power);
+        weightSum += weight;
+        valueSum += weight * point.value;
+    }
+    if (m_points.isEmpty() || nearest > m_maxDistanceKm * m_maxDistanceKm)
+        return qQNaN();
+    return valueSum / weightSum;
+}
+
+/**
+ * @brief Wyznacza kowariancję dla odległości.
+ * @param distance Odległość w km.
+ * @return Kowariancja wykładnicza bez samorodka (wariancja znormalizowana do 1).
+ */
+double KrigingInterpolator::covariance(double distance) const
+{
+    return (1.0 - m_nugget) * qExp(-3.0 * distance / m_rangeKm);
+}
+
+/**
+ * @brief Rozwiązuje układ krigingu zwyczajnego.
+ * @param samples Pomiary punktowe.
+ *
+ * Układ [C 1; 1ᵀ 0][w; m] = [z; 0] rozwiązywany jest eliminacją Gaussa z częściowym
+ * wyborem elementu głównego. Jeśli układ jest osobliwy, pole jest stałe (średnia pomiarów).
+ */
+void KrigingInterpolator::prepare(const QList<FieldSample> &samples)
+{
+    m_points = project(samples);
+    m_weights.clear();
+    m_mean = 0.0;
+    const int count = m_points.size();
+    if (count == 0)
+        return;
+
+    const int n = count + 1;
+    QVector<double> matrix(n * n, 0.0);
+    QVector<double> rhs(n, 0.0);
+    for (int i = 0; i < count; ++i) {
+        for (int j = i; j < count; ++j) {
+            const double c = i == j ? 1.0 : covariance(std::hypot(m_points.at(i).x - m_points.at(j).x,
+                                                                  m_points.at(i).y - m_points.at(j).y));
+            matrix[i * n + j] = c;
+            matrix[j * n + i] = c;
+        }
+        matrix[i * n + count] = 1.0;
+        matrix[count * n + i] = 1.0;
+        rhs[i] = m_points.at(i).value;
+    }
+
+    for (int col = 0; col < n; ++col) {
+        int pivot = col;
+        for (int row = col + 1; row < n; ++row) {
+            if (qAbs(matrix.at(row * n + col)) > qAbs(matrix.at(pivot * n + col)))
+                pivot = row;
+        }
+        if (qAbs(matrix.at(pivot * n + col)) < 1e-12) {
+            double sum = 0.0;
+            for (const Point &point : std::as_const(m_points))
+                sum += point.value;
+            m_mean = sum / count;
+            return;
+        }
+        if (pivot != col) {
+            for (int k = 0; k < n; ++k)
+                std::swap(matrix[col * n + k], matrix[pivot * n + k]);
+            std::swap(rhs[col], rhs[pivot]);
+        }
+        for (int row = col + 1; row < n; ++row) {
+            const double factor = matrix.at(row * n + col) / matrix.at(col * n + col);
+            if (factor == 0.0)
+                continue;
+            for (int k = col; k < n; ++k)
+                matrix[row * n + k] -= factor * matrix.at(col * n + k);
+            rhs[row] -= factor * rhs.at(col);
+        }
+    }
+
+    QVector<double> solution(n, 0.0);
+    for (int row = n - 1; row >= 0; --row) {
+        double sum = rhs.at(row);
+        for (int k = row + 1; k < n; ++k)
+            sum -= matrix.at(row * n + k) * solution.at(k);
+        solution[row] = sum / matrix.at(row * n + row);
+    }
+    m_mean = solution.at(count);
+    solution.resize(count);
+    m_weights = solution;
+}
+
+/**
+ * @brief Wyznacza wartość pola krigingu w punkcie.
+ * @param lat Szerokość geograficzna.
+ * @param lon Długość geograficzna.
+ * @return Wartość lub NaN poza zasięgiem stacji.
+ */
+double KrigingInterpolator::estimate(double lat, double lon) const
+{
+    if (m_points.isEmpty())
+        return qQNaN();
+
+    const Point target = project(lat, lon);
+    double nearest = std::numeric_limits<double>::max();
+    double value = m_mean;
+    for (int i = 0; i < m_points.size(); ++i) {
+        const Point &point = m_points.at(i);
+        const double distance = std::hypot(point.x - target.x, point.y - target.y);
+        nearest = qMin(nearest, distance);
+        if (!m_weights.isEmpty())
+            value += m_weights.at(i) * covariance(distance);
+    }
+    return nearest > m_maxDistanceKm ? qQNaN() : value;
+}
@@ -0,0 +1,199 @@
+/**
+ * @file fieldinterpolator.h
+ * @brief Plik nagłówkowy dla klas interpolacji przestrzennej pomiarów.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje wspólny interfejs interpolacji wartości punktowych (stacji)
+ * na dowolny punkt mapy oraz dwie metody: odwrotnych odległości (IDW) i kriging zwyczajny.
+ */
+
+#ifndef FIELDINTERPOLATOR_H
+#define FIELDINTERPOLATOR_H
+
+#include <QList>
+#include <QString>
+#include <QVector>
+
+/**
+ * @struct FieldSample
+ * @brief Pomiar punktowy wejściowy interpolacji.
+ */
+struct FieldSample {
+    int stationId = 0;   ///< Identyfikator stacji.
+    double lat = 0.0;    ///< Szerokość geograficzna.
+    double lon = 0.0;    ///< Długość geograficzna.
+    double value = 0.0;  ///< Wartość pomiaru.
+};
+
+/**
+ * @class FieldInterpolator
+ * @brief Interfejs metody interpolacji przestrzennej.
+ *
+ * prepare() wykonuje jednorazowe obliczenia dla zbioru pomiarów (w wątku wywołującym),
+ * a estimate() jest stała i może być wywoływana równolegle z wielu wątków. Odległości
+ * liczone są w kilometrach w lokalnym rzucie równoodległościowym (wystarczającym dla
+ * obszaru Polski). Punkty dalej niż maxDistanceKm od najbliższej stacji nie mają wartości.
+ */
+class FieldInterpolator {
+public:
+    /// Domyślny zasięg stacji w km, poza którym pole nie jest wyznaczane.
+    static constexpr double kDefaultMaxDistanceKm = 60.0;
+
+    virtual ~FieldInterpolator() = default;
+
+    /**
+     * @brief Pobiera nazwę metody.
+     * @return Krótka nazwa (np. "IDW").
+     */
+    virtual QString name() const = 0;
+
+    /**
+     * @brief Przygotowuje interpolację dla zbioru pomiarów.
+     * @param samples Pomiary punktowe.
+     */
+    virtual void prepare(const QList<FieldSample> &samples) = 0;
+
+    /**
+     * @brief Wyznacza wartość pola w punkcie.
+     * @param lat Szerokość geograficzna.
+     * @param lon Długość geograficzna.
+     * @return Wartość lub NaN poza zasięgiem stacji (i bez pomiarów).
+     */
+    virtual double estimate(double lat, double lon) const = 0;
+
+    /**
+     * @brief Ustawia zasięg stacji.
+     * @param km Odległość w kilometrach.
+     */
+    void setMaxDistance(double km) { m_maxDistanceKm = km; }
+
+    /**
+     * @brief Pobiera zasięg stacji.
+     * @return Odległość w kilometrach.
+     */
+    double maxDistance() const { return m_maxDistanceKm; }
+
+protected:
+    /**
+     * @struct Point
+     * @brief Pomiar w rzucie lokalnym (km).
+     */
+    struct Point {
+        double x;      ///< Współrzędna wschodnia w km.
+        double y;      ///< Współrzędna północna w km.
+        double value;  ///< Wartość pomiaru.
+    };
+
+    /**
+     * @brief Rzutuje pomiary na płaszczyznę lokalną.
+     * @param samples Pomiary punktowe.
+     * @return Punkty w km.
+     */
+    static QVector<Point> project(const QList<FieldSample> &samples);
+
+    /**
+     * @brief Rzutuje współrzędne geograficzne na płaszczyznę lokalną.
+     * @param lat Szerokość geograficzna.
+     * @param lon Długość geograficzna.
+     * @return Punkt w km (z wartością 0).
+     */
+    static Point project(double lat, double lon);
+
+    double m_maxDistanceKm = kDefaultMaxDistanceKm; ///< Zasięg stacji w km.
+};
+
+/**
+ * @class InverseDistanceInterpolator
+ * @brief Interpolacja metodą odwrotnych odległości (IDW).
+ *
+ * Wartość to średnia pomiarów ważona odległością w potędze -power; w punkcie pomiaru
+ * zwracany jest sam pomiar.
+ */
+class InverseDistanceInterpolator final : public FieldInterpolator {
+public:
+    /**
+     * @brief Konstruktor obiektu InverseDistanceInterpolator.
+     * @param power Wykładnik wagi (zwykle 2).
+     */
+    explicit InverseDistanceInterpolator(double power = 2.0) : m_power(power) {}
+
+    /**
+     * @brief Pobiera nazwę metody.
+     * @return "IDW".
+     */
+    QString name() const override { return QStringLiteral("IDW"); }
+
+    /**
+     * @brief Przygotowuje interpolację dla zbioru pomiarów.
+     * @param samples Pomiary punktowe.
+     */
+    void prepare(const QList<FieldSample> &samples) override;
+
+    /**
+     * @brief Wyznacza wartość pola IDW w punkcie.
+     * @param lat Szerokość geograficzna.
+     * @param lon Długość geograficzna.
+     * @return Wartość lub NaN poza zasięgiem stacji.
+     */
+    double estimate(double lat, double lon) const override;
+
+private:
+    double m_power;           ///< Wykładnik wagi.
+    QVector<Point> m_points;  ///< Pomiary w rzucie lokalnym.
+};
+
+/**
+ * @class KrigingInterpolator
+ * @brief Kriging zwyczajny z wykładniczym modelem kowariancji.
+ *
+ * prepare() rozwiązuje raz układ krigingu w postaci dualnej (N + 1 równań), więc
+ * estimate() kosztuje O(N), jak IDW. Efekt samorodka (nugget) wygładza pole i zapewnia
+ * rozwiązywalność układu także dla stacji położonych bardzo blisko siebie.
+ */
+class KrigingInterpolator final : public FieldInterpolator {
+public:
+    /**
+     * @brief Konstruktor obiektu KrigingInterpolator.
+     * @param rangeKm Zasięg praktyczny wariogramu w km.
+     * @param nugget Udział efektu samorodka w wariancji (0-1).
+     */
+    explicit KrigingInterpolator(double rangeKm = 100.0, double nugget = 0.1)
+        : m_rangeKm(rangeKm), m_nugget(nugget) {}
+
+    /**
+     * @brief Pobiera nazwę metody.
+     * @return "Kriging".
+     */
+    QString name() const override { return QStringLiteral("Kriging"); }
+
+    /**
+     * @brief Przygotowuje interpolację dla zbioru pomiarów.
+     * @param samples Pomiary punktowe.
+     */
+    void prepare(const QList<FieldSample> &samples) override;
+
+    /**
+     * @brief Wyznacza wartość pola krigingu w punkcie.
+     * @param lat Szerokość geograficzna.
+     * @param lon Długość geograficzna.
+     * @return Wartość lub NaN poza zasięgiem stacji.
+     */
+    double estimate(double lat, double lon) const override;
+
+private:
+    /**
+     * @brief Wyznacza kowariancję dla odległości.
+     * @param distance Odległość w km.
+     * @return Kowariancja (bez samorodka).
+     */
+    double covariance(double distance) const;
+
+    double m_rangeKm;           ///< Zasięg praktyczny wariogramu.
+    double m_nugget;            ///< Udział efektu samorodka.
+    QVector<Point> m_points;    ///< Pomiary w rzucie lokalnym.
+    QVector<double> m_weights;  ///< Wagi postaci dualnej.
+    double m_mean = 0.0;        ///< Średnia estymowana (mnożnik Lagrange'a).
+};
+
+#endif // FIELDINTERPOLATOR_H
@@ -0,0 +1,306 @@
+/**
+ * @file harvester.cpp
+ * @brief Implementacja klasy Harvester.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera przebieg zbierania danych: katalog stacji, równoległe pobieranie
+ * sensorów i pomiarów oraz zapis każdej zakończonej stacji do archiwum i historii.
+ */
+
+#include "harvester.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QNetworkAccessManager>
+#include <QUrl>
+#include <memory>
+#include <utility>
+
+/**
+ * @brief Konstruktor obiektu Harvester.
+ * @param options Parametry przebiegu.
+ * @param parent Rodzic QObject.
+ */
+Harvester::Harvester(const HarvestOptions &options, QObject *parent)
+    : QObject(parent),
+    m_options(options),
+    m_apiClient(new ApiClient(this)),
+    m_parser(new ReplyParser(this)),
+    m_fetch(new StationFetchQueue(m_apiClient, m_parser, RequestOptions{ RequestPriority::Visible, QStringLiteral("harvester") },
+                                  0, this)),
+    m_manifest(new ArchiveManifest(options.outputDirectory, this)),
+    m_history(QDir(options.outputDirectory).filePath("history"))
+{
+    m_options.maxStationsInFlight = qMax(1, m_options.maxStationsInFlight);
+    m_apiClient->networkManager()->setTransferTimeout(m_options.transferTimeoutMs);
+    m_fetch->setBaseUrl(m_options.apiBaseUrl);
+
+    connect(m_parser, &ReplyParser::stationsParsed, this, &Harvester::onStationsParsed);
+    connect(m_fetch, &StationFetchQueue::sensorsReady, this, &Harvester::onSensorsReady);
+    connect(m_fetch, &StationFetchQueue::sensorDataReady, this, &Harvester::onSensorDataReady);
+    connect(m_fetch, &StationFetchQueue::failed, this, &Harvester::onFetchFailed);
+}
+
+/**
+ * @brief Rozpoczyna przebieg od pobrania katalogu stacji.
+ *
+ * Katalog jest odczytywany fragmentami w miarę pobierania, jak w aplikacji. Odpowiedź 304
+ * oznacza, że zapisany w pamięci podręcznej katalog jest aktualny, więc jest on parsowany
+ * zamiast treści z sieci.
+ */
+void Harvester::start()
+{
+    m_timer.start();
+    QDir().mkpath(m_options.outputDirectory);
+    m_manifest->load();
+
+    const QUrl url = apiUrl("/station/findAll");
+    const auto streamId = std::make_shared<quint64>(0);
+    m_apiClient->getLatest(url, this,
+        [this, streamId](const QByteArray &chunk) {
+            if (*streamId == 0)
+                *streamId = m_parser->beginStations();
+            m_parser->feed(*streamId, chunk);
+        },
+        [this, url, streamId](const ApiResponse &response) {
+            if (response.ok() && response.notModified && *streamId == 0) {
+                *streamId = m_parser->beginStations();
+                m_parser->feed(*streamId, m_apiClient->cache().load(url).body);
+            }
+            if (!response.ok() || *streamId == 0) {
+                if (*streamId != 0)
+                    m_parser->abort(*streamId);
+                qWarning() << "Nie można pobrać katalogu stacji:" << (response.ok() ? QString("pusta odpowiedź") : response.error);
+                finish(CatalogFailed);
+                return;
+            }
+            m_parser->finish(*streamId, response.fromCache);
+        });
+}
+
+/**
+ * @brief Buduje adres zasobu API.
+ * @param path Ścieżka względem adresu bazowego.
+ * @return Pełny adres.
+ */
+QUrl Harvester::apiUrl(const QString &path) const
+{
+    return QUrl(m_options.apiBaseUrl + path);
+}
+
+/**
+ * @brief Ustawia listę stacji do zebrania.
+ * @param result Katalog stacji.
+ *
+ * Niepełny katalog jest zbierany w części, którą udało się odczytać; przebieg kończy się
+ * wtedy kodem PartialFailure.
+ */
+void Harvester::onStationsParsed(StationCatalogResult result)
+{
+    for (const StationRecord &record : std::as_const(result.records)) {
+        if (m_options.stationIds.isEmpty() || m_options.stationIds.contains(record.stationId))
+            m_queue.append(record);
+    }
+    m_summary.catalogComplete = result.complete;
+
+    m_summary.stations = m_queue.size();
+    if (m_queue.isEmpty()) {
+        qWarning() << "Katalog stacji nie zawiera stacji do zebrania";
+        finish(CatalogFailed);
+        return;
+    }
+    pump();
+}
+
+/**
+ * @brief Rozpoczyna kolejne stacje do wyczerpania limitu równoległości.
+ *
+ * Limit dotyczy stacji, a nie żądań: kolejka nie ma własnego limitu, częstość i równoległość
+ * żądań do hosta pilnuje RequestScheduler, a limit stacji ogranicza pamięć zajmowaną przez
+ * zebrane szeregi.
+ */
+void Harvester::pump()
+{
+    while (m_jobs.size() < m_options.maxStationsInFlight && !m_queue.isEmpty()) {
+        const StationRecord record = m_queue.takeFirst();
+        StationJob &job = m_jobs[record.stationId];
+        job.record = record;
+        m_fetch->enqueueStation(record.stationId);
+    }
+}
+
+/**
+ * @brief Dodaje do kolejki pomiary sensorów stacji.
+ * @param stationId Identyfikator stacji.
+ * @param sensors Sensory stacji.
+ */
+void Harvester::onSensorsReady(int stationId, const QList<SensorInfo> &sensors)
+{
+    auto it = m_jobs.find(stationId);
+    if (it == m_jobs.end())
+        return;
+
+    it->sensors = sensors;
+    it->pendingSensors = sensors.size();
+    if (sensors.isEmpty()) {
+        saveStation(stationId);
+        return;
+    }
+    for (const SensorInfo &sensor : sensors)
+        m_fetch->enqueueSensor(stationId, sensor.sensorId);
+}
+
+/**
+ * @brief Zapisuje pomiary sensora w danych stacji.
+ * @param stationId Identyfikator stacji.
+ * @param sensorId Identyfikator sensora.
+ * @param series Pomiary sensora.
+ */
+void Harvester::onSensorDataReady(int stationId, int sensorId, const SensorSeries &series)
+{
+    auto it = m_jobs.find(stationId);
+    if (it == m_jobs.end())
+        return;
+
+    ++m_summary.sensors;
+    m_summary.measurements += series.size();
+    it->series.insert(sensorId, series);
+    sensorDone(stationId);
+}
+
+/**
+ * @brief Kończy stację lub sensor, których nie udało się pobrać.
+ * @param stationId Identyfikator stacji.
+ * @param sensorId Identyfikator sensora; 0 dla listy sensorów.
+ * @param error Opis błędu.
+ *
+ * Błąd listy sensorów kończy całą stację; błąd pomiarów (także niepełna treść) liczy sensor
+ * jako błędny, a stacja jest zapisywana z pozostałymi sensorami.
+ */
+void Harvester::onFetchFailed(int stationId, int sensorId, const QString &error)
+{
+    if (sensorId == 0) {
+        failStation(stationId, "lista sensorów: " + error);
+        return;
+    }
+    auto it = m_jobs.find(stationId);
+    if (it == m_jobs.end())
+        return;
+    ++it->failedSensors;
+    ++m_summary.failedSensors;
+    sensorDone(stationId);
+}
+
+/**
+ * @brief Oznacza koniec żądania sensora; po ostatnim zapisuje stację.
+ * @param stationId Identyfikator stacji.
+ */
+void Harvester::sensorDone(int stationId)
+{
+    auto it = m_jobs.find(stationId);
+    if (it == m_jobs.end())
+        return;
+    if (--it->pendingSensors <= 0)
+        saveStation(stationId);
+}
+
+/**
+ * @brief Zapisuje stację do archiwum i historii.
+ * @param stationId Identyfikator stacji.
+ *
+ * Zapis odpowiada MainWindow::saveStationData(): plik archiwalny, wpis w indeksie archiwum
+ * i dopisanie do historii tylko nowych lub poprawionych pomiarów.
+ */
+void Harvester::saveStation(int stationId)
+{
+    const StationJob job = m_jobs.take(stationId);
+    const QDateTime now = QDateTime::currentDateTime();
+
+    StationArchiveData data;
+    data.stationId = stationId;
+    data.stationName = job.record.stationName;
+    data.cityName = job.record.cityName;
+    data.address = job.record.address;
+    data.lat = job.record.lat;
+    data.lon = job.record.lon;
+    data.saveDate = now.toString(Qt::ISODate);
+
+    HistoryMergeResult history;
+    for (const SensorInfo &info : job.sensors) {
+        ArchivedSensor sensor;
+        sensor.sensorId = info.sensorId;
+        sensor.paramName = info.paramName;
+        sensor.paramCode = info.paramCode;
+        const auto series = job.series.constFind(info.sensorId);
+        if (series != job.series.constEnd()) {
+            sensor.series = series.value();
+            const HistoryMergeResult merged = m_history.merge(info.sensorId, sensor.series);
+            history.appended += merged.appended;
+            history.corrected += merged.corrected;
+        }
+        data.sensors.append(sensor);
+    }
+
+    const QString fileName = StationArchive::fileName(stationId, now, m_options.compact);
+    const QString filePath = QDir(m_options.outputDirectory).filePath(fileName);
+    if (!StationArchive::save(filePath, data)) {
+        ++m_summary.failedStations;
+        stationDone(stationId, "błąd zapisu " + filePath);
+        return;
+    }
+
+    ArchiveEntry entry;
+    entry.fileName = fileName;
+    entry.stationId = stationId;
+    entry.cityName = data.cityName;
+    entry.address = data.address;
+    entry.saveDate = data.saveDate;
+    m_manifest->insert(entry);
+
+    m_summary.appended += history.appended;
+    ++m_summary.savedStations;
+    stationDone(stationId, QString("%1, %2: %3 sensorów (%4 z błędem), %5 nowych pomiarów w historii")
+                               .arg(data.cityName, data.stationName)
+                               .arg(job.sensors.size()).arg(job.failedSensors).arg(history.appended));
+}
+
+/**
+ * @brief Kończy stację niepowodzeniem.
+ * @param stationId Identyfikator stacji.
+ * @param reason Opis błędu.
+ */
+void Harvester::failStation(int stationId, const QString &reason)
+{
+    if (!m_jobs.remove(stationId))
+        return;
+    ++m_summary.failedStations;
+    stationDone(stationId, "błąd: " + reason);
+}
+
+/**
+ * @brief Zgłasza postęp i rozpoczyna kolejne stacje; po ostatniej kończy przebieg.
+ * @param stationId Identyfikator zakończonej stacji.
+ * @param message Opis wyniku.
+ */
+void Harvester::stationDone(int stationId, const QString &message)
+{
+    emit progress(++m_done, m_summary.stations, stationId, message);
+    pump();
+    if (m_jobs.isEmpty() && m_queue.isEmpty())
+        finish(m_summary.failedStations > 0 || m_summary.failedSensors > 0 || !m_summary.catalogComplete
+                   ? PartialFailure : Success);
+}
+
+/**
+ * @brief Kończy przebieg z kodem wyjścia.
+ * @param exitCode Kod wyjścia.
+ */
+void Harvester::finish(int exitCode)
+{
+    if (m_finished)
+        return;
+    m_finished = true;
+    m_summary.elapsedMs = m_timer.elapsed();
+    emit finished(exitCode);
+}
@@ -0,0 +1,228 @@
+/**
+ * @file harvester.h
+ * @brief Plik nagłówkowy dla klasy Harvester.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje zbieranie danych wszystkich stacji bez interfejsu graficznego:
+ * katalog, sensory i pomiary zapisywane do archiwum i historii.
+ */
+
+#ifndef HARVESTER_H
+#define HARVESTER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include "apiclient.h"
+#include "archivemanifest.h"
+#include "historystore.h"
+#include "replyparser.h"
+#include "stationfetchqueue.h"
+
+/**
+ * @struct HarvestOptions
+ * @brief Parametry przebiegu zbierania danych.
+ */
+struct HarvestOptions {
+    QString outputDirectory;                                        ///< Katalog archiwum (historia w podkatalogu "history").
+    QString apiBaseUrl = ApiClient::giosApiUrl();                    ///< Adres bazowy API GIOŚ.
+    QList<int> stationIds;                                          ///< Stacje do zebrania; pusta lista oznacza cały katalog.
+    int maxStationsInFlight = 8;                                    ///< Maksymalna liczba stacji przetwarzanych naraz.
+    bool compact = true;                                            ///< Zapis w formacie .gar (false: JSON).
+    int transferTimeoutMs = 30000;                                  ///< Limit czasu pojedynczego żądania w ms.
+};
+
+/**
+ * @struct HarvestSummary
+ * @brief Podsumowanie przebiegu zbierania danych.
+ */
+struct HarvestSummary {
+    int stations = 0;               ///< Stacje do zebrania.
+    int savedStations = 0;          ///< Stacje zapisane do archiwum.
+    int failedStations = 0;         ///< Stacje, których nie udało się zapisać.
+    bool catalogComplete = true;    ///< False, jeśli katalog stacji był niepełny.
+    int sensors = 0;                ///< Sensory z pobranymi pomiarami.
+    int failedSensors = 0;          ///< Sensory, których pomiarów nie udało się pobrać.
+    int measurements = 0;           ///< Pobrane pomiary.
+    int appended = 0;               ///< Pomiary dopisane do historii.
+    qint64 elapsedMs = 0;           ///< Czas przebiegu w ms.
+
+    /**
+     * @brief Wyznacza przepustowość przebiegu.
+     * @return Liczba zakończonych stacji na minutę.
+     */
+    double stationsPerMinute() const
+    {
+        return elapsedMs > 0 ? (savedStations + failedStations) * 60000.0 / elapsedMs : 0.0;
+    }
+};
+
+/**
+ * @class Harvester
+ * @brief Zbiera sensory i pomiary wszystkich stacji katalogu do archiwum.
+ *
+ * Korzysta z tych samych klas co aplikacja: ApiClient (pamięć podręczna i limity hostów
+ * w RequestScheduler), ReplyParser (parsowanie poza wątkiem głównym), StationFetchQueue
+ * (listy sensorów i pomiary), StationArchive, ArchiveManifest i HistoryStore. Stacje są przetwarzane równolegle, najwyżej
+ * maxStationsInFlight naraz; każda zakończona stacja trafia od razu do archiwum, więc
+ * przerwany przebieg zachowuje to, co zdążył zebrać.
+ *
+ * Kod wyjścia: 0 – wszystkie stacje zapisane, 1 – katalog stacji niedostępny lub pusty,
+ * 2 – część stacji lub sensorów nie została zebrana.
+ */
+class Harvester : public QObject {
+    Q_OBJECT
+
+public:
+    /// Kody wyjścia przebiegu.
+    enum ExitCode {
+        Success = 0,         ///< Wszystkie stacje i sensory zebrane.
+        CatalogFailed = 1,   ///< Katalog stacji niedostępny lub pusty.
+        PartialFailure = 2   ///< Część stacji lub sensorów nie została zebrana.
+    };
+
+    /**
+     * @brief Konstruktor obiektu Harvester.
+     * @param options Parametry przebiegu.
+     * @param parent Rodzic QObject.
+     */
+    explicit Harvester(const HarvestOptions &options, QObject *parent = nullptr);
+
+    /**
+     * @brief Rozpoczyna przebieg od pobrania katalogu stacji.
+     */
+    void start();
+
+    /**
+     * @brief Pobiera podsumowanie przebiegu.
+     * @return Podsumowanie (pełne po sygnale finished()).
+     */
+    const HarvestSummary &summary() const { return m_summary; }
+
+    /**
+     * @brief Pobiera klienta HTTP.
+     * @return Wskaźnik na klienta HTTP.
+     */
+    ApiClient *apiClient() const { return m_apiClient; }
+
+signals:
+    /**
+     * @brief Sygnał emitowany po zakończeniu każdej stacji.
+     * @param done Liczba zakończonych stacji.
+     * @param total Liczba wszystkich stacji.
+     * @param stationId Identyfikator stacji.
+     * @param message Opis wyniku dla stacji.
+     */
+    void progress(int done, int total, int stationId, const QString &message);
+
+    /**
+     * @brief Sygnał emitowany po zakończeniu przebiegu.
+     * @param exitCode Kod wyjścia (ExitCode).
+     */
+    void finished(int exitCode);
+
+private slots:
+    /**
+     * @brief Ustawia listę stacji do zebrania.
+     * @param result Katalog stacji.
+     */
+    void onStationsParsed(StationCatalogResult result);
+
+    /**
+     * @brief Dodaje do kolejki pomiary sensorów stacji.
+     * @param stationId Identyfikator stacji.
+     * @param sensors Sensory stacji.
+     */
+    void onSensorsReady(int stationId, const QList<SensorInfo> &sensors);
+
+    /**
+     * @brief Zapisuje pomiary sensora w danych stacji.
+     * @param stationId Identyfikator stacji.
+     * @param sensorId Identyfikator sensora.
+     * @param series Pomiary sensora.
+     */
+    void onSensorDataReady(int stationId, int sensorId, const SensorSeries &series);
+
+    /**
+     * @brief Kończy stację lub sensor, których nie udało się pobrać.
+     * @param stationId Identyfikator stacji.
+     * @param sensorId Identyfikator sensora; 0 dla listy sensorów.
+     * @param error Opis błędu.
+     */
+    void onFetchFailed(int stationId, int sensorId, const QString &error);
+
+private:
+    /**
+     * @struct StationJob
+     * @brief Stacja w trakcie zbierania.
+     */
+    struct StationJob {
+        StationRecord record;                  ///< Rekord katalogu.
+        QList<SensorInfo> sensors;             ///< Sensory stacji.
+        QHash<int, SensorSeries> series;       ///< Pobrane szeregi według sensora.
+        int pendingSensors = 0;                ///< Sensory z trwającym żądaniem.
+        int failedSensors = 0;                 ///< Sensory z błędem pobierania.
+    };
+
+    /**
+     * @brief Buduje adres zasobu API.
+     * @param path Ścieżka względem adresu bazowego (np. "/station/findAll").
+     * @return Pełny adres.
+     */
+    QUrl apiUrl(const QString &path) const;
+
+    /**
+     * @brief Rozpoczyna kolejne stacje do wyczerpania limitu równoległości.
+     */
+    void pump();
+
+    /**
+     * @brief Oznacza koniec żądania sensora; po ostatnim zapisuje stację.
+     * @param stationId Identyfikator stacji.
+     */
+    void sensorDone(int stationId);
+
+    /**
+     * @brief Zapisuje stację do archiwum i historii.
+     * @param stationId Identyfikator stacji.
+     */
+    void saveStation(int stationId);
+
+    /**
+     * @brief Kończy stację niepowodzeniem.
+     * @param stationId Identyfikator stacji.
+     * @param reason Opis błędu.
+     */
+    void failStation(int stationId, const QString &reason);
+
+    /**
+     * @brief Zgłasza postęp i rozpoczyna kolejne stacje; po ostatniej kończy przebieg.
+     * @param stationId Identyfikator zakończonej stacji.
+     * @param message Opis wyniku.
+     */
+    void stationDone(int stationId, const QString &message);
+
+    /**
+     * @brief Kończy przebieg z kodem wyjścia.
+     * @param exitCode Kod wyjścia.
+     */
+    void finish(int exitCode);
+
+    HarvestOptions m_options;              ///< Parametry przebiegu.
+    ApiClient *m_apiClient;                ///< Klient HTTP.
+    ReplyParser *m_parser;                 ///< Parsowanie odpowiedzi.
+    StationFetchQueue *m_fetch;            ///< Pobieranie list sensorów i pomiarów.
+    ArchiveManifest *m_manifest;           ///< Indeks plików archiwalnych.
+    HistoryStore m_history;                ///< Ciągła historia pomiarów.
+    QList<StationRecord> m_queue;          ///< Stacje czekające na rozpoczęcie.
+    QHash<int, StationJob> m_jobs;         ///< Stacje w trakcie zbierania.
+    HarvestSummary m_summary;              ///< Podsumowanie przebiegu.
+    QElapsedTimer m_timer;                 ///< Pomiar czasu przebiegu.
+    int m_done = 0;                        ///< Zakończone stacje.
+    bool m_finished = false;               ///< Czy przebieg się zakończył.
+};
+
+#endif // HARVESTER_H
@@ -0,0 +1,75 @@
+/**
+ * @file harvester_main.cpp
+ * @brief Punkt wejścia programu zbierającego dane bez interfejsu graficznego.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera funkcję główną programu gios_harvester, uruchamianego z cron lub
+ * timera systemd: zbiera dane wszystkich stacji do archiwum i kończy się kodem wyjścia.
+ */
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QTextStream>
+#include "harvester.h"
+#include "metricsregistry.h"
+
+/**
+ * @brief Główna funkcja programu.
+ * @param argc Liczba argumentów wiersza poleceń.
+ * @param argv Tablica argumentów wiersza poleceń.
+ * @return Kod wyjścia: 0 – powodzenie, 1 – katalog stacji niedostępny, 2 – część danych niezebrana.
+ *
+ * Postęp (jedna linia na stację) trafia na standardowe wyjście, a podsumowanie
+ * z przepustowością w stacjach na minutę jest wypisywane na końcu przebiegu.
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("gios_harvester");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Zbiera sensory i pomiary stacji GIOŚ do archiwum.");
+    parser.addHelpOption();
+    const QCommandLineOption outputOption({ "o", "output" }, "Katalog archiwum.", "katalog", QDir::currentPath());
+    const QCommandLineOption stationsOption({ "s", "stations" }, "Identyfikatory stacji rozdzielone przecinkami (domyślnie cały katalog).", "lista");
+    const QCommandLineOption parallelOption({ "p", "parallel" }, "Liczba stacji przetwarzanych naraz.", "liczba", "8");
+    const QCommandLineOption jsonOption("json", "Zapis w formacie JSON zamiast .gar.");
+    const QCommandLineOption metricsOption("metrics", "Plik metryk w formacie Prometheus zapisywany na końcu przebiegu.", "plik");
+    parser.addOptions({ outputOption, stationsOption, parallelOption, jsonOption, metricsOption });
+    parser.process(app);
+
+    HarvestOptions options;
+    options.outputDirectory = parser.value(outputOption);
+    options.maxStationsInFlight = parser.value(parallelOption).toInt();
+    options.compact = !parser.isSet(jsonOption);
+    const QStringList stationIds = parser.value(stationsOption).split(',', Qt::SkipEmptyParts);
+    for (const QString &stationId : stationIds)
+        options.stationIds.append(stationId.trimmed().toInt());
+
+    QTextStream out(stdout);
+    Harvester harvester(options);
+    QObject::connect(&harvester, &Harvester::progress, &harvester,
+                     [&out](int done, int total, int stationId, const QString &message) {
+        out << QString("[%1/%2] stacja %3: %4").arg(done).arg(total).arg(stationId).arg(message) << Qt::endl;
+    });
+    const QString metricsFile = parser.value(metricsOption);
+    QObject::connect(&harvester, &Harvester::finished, &app, [&out, &harvester, metricsFile](int exitCode) {
+        const HarvestSummary &summary = harvester.summary();
+        out << QString("Stacje: %1 (zapisane %2, błędy %3), sensory: %4 (błędy %5), pomiary: %6 (nowe w historii %7)")
+                   .arg(summary.stations).arg(summary.savedStations).arg(summary.failedStations)
+                   .arg(summary.sensors).arg(summary.failedSensors)
+                   .arg(summary.measurements).arg(summary.appended) << Qt::endl;
+        out << QString("Czas: %1 s, przepustowość: %2 stacji/min, kod wyjścia: %3")
+                   .arg(summary.elapsedMs / 1000.0, 0, 'f', 1)
+                   .arg(summary.stationsPerMinute(), 0, 'f', 1)
+                   .arg(exitCode) << Qt::endl;
+        if (!metricsFile.isEmpty())
+            MetricsRegistry::instance().writePrometheus(metricsFile);
+        QCoreApplication::exit(exitCode);
+    });
+
+    harvester.start();
+    return app.exec();
+}
@@ -0,0 +1,381 @@
+/**
+ * @file historystore.cpp
+ * @brief Implementacja klasy HistoryStore.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera zapis i odczyt segmentów historii pomiarów sensorów.
+ */
+
+#include "historystore.h"
+#include "metricsregistry.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QMap>
+#include <QSaveFile>
+#include <QTimeZone>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+/// Sygnatura segmentu historii ("GHIS").
+constexpr quint32 kSegmentMagic = 0x47484953;
+/// Wersja formatu segmentu.
+constexpr quint16 kSegmentVersion = 1;
+/// Rozmiar nagłówka segmentu w bajtach.
+constexpr qint64 kHeaderSize = 6;
+/// Rozmiar rekordu w bajtach (znacznik czasu, wartość, flagi).
+constexpr qint64 kRecordSize = 17;
+/// Flaga rekordu: pusty pomiar.
+constexpr quint8 kRecordNull = 0x01;
+
+/**
+ * @brief Dopisuje nagłówek segmentu do bufora.
+ * @param bytes Bufor.
+ */
+void appendHeader(QByteArray &bytes)
+{
+    char header[kHeaderSize];
+    qToLittleEndian(kSegmentMagic, header);
+    qToLittleEndian(kSegmentVersion, header + 4);
+    bytes.append(header, kHeaderSize);
+}
+
+/**
+ * @brief Dopisuje rekord do bufora.
+ * @param bytes Bufor.
+ * @param timestamp Znacznik czasu.
+ * @param value Wartość pomiaru.
+ * @param isNull Czy pomiar jest pusty.
+ */
+void appendRecord(QByteArray &bytes, qint64 timestamp, double value, bool isNull)
+{
+    char raw[kRecordSize];
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    qToLittleEndian(timestamp, raw);
+    qToLittleEndian(bits, raw + 8);
+    raw[16] = char(isNull ? kRecordNull : 0);
+    bytes.append(raw, kRecordSize);
+}
+}
+
+/**
+ * @brief Konstruktor obiektu HistoryStore.
+ * @param directory Katalog historii.
+ */
+HistoryStore::HistoryStore(const QString &directory)
+    : m_directory(directory)
+{
+}
+
+/**
+ * @brief Dopisuje do historii pomiary nowsze niż zapisane i poprawki wcześniejszych.
+ * @param sensorId Identyfikator sensora.
+ * @param series Szereg uporządkowany rosnąco według czasu.
+ * @return Liczby pomiarów nowych, poprawionych i niezmienionych.
+ *
+ * Zapisane wartości odczytywane są tylko dla części szeregu, która nakłada się na historię.
+ * Pusty pomiar nie zastępuje zapisanej wartości.
+ */
+HistoryMergeResult HistoryStore::merge(int sensorId, const SensorSeries &series)
+{
+    MetricsTimer timer("gios_history_duration_ms", "op=merge");
+    HistoryMergeResult result;
+    if (series.isEmpty())
+        return result;
+
+    const qint64 last = lastTimestamp(sensorId);
+
+    // Zapisane wersje pomiarów z zakresu, który nakłada się na historię
+    QHash<qint64, Record> stored;
+    if (last >= series.timestamp(0)) {
+        const SensorSeries overlap = query(sensorId, series.timestamp(0), last);
+        stored.reserve(overlap.size());
+        for (int i = 0; i < overlap.size(); ++i)
+            stored.insert(overlap.timestamp(i), { overlap.timestamp(i), overlap.value(i), overlap.isNull(i) });
+    }
+
+    QMap<int, QList<Record>> pending;
+    qint64 newest = last;
+    for (int i = 0; i < series.size(); ++i) {
+        const Record record { series.timestamp(i), series.value(i), series.isNull(i) };
+        if (record.timestamp <= last) {
+            const auto existing = stored.constFind(record.timestamp);
+            if (existing != stored.constEnd()) {
+                const bool same = existing->isNull == record.isNull && (record.isNull || existing->value == record.value);
+                if (same || record.isNull) {
+                    ++result.unchanged;
+                    continue;
+                }
+                ++result.corrected;
+            } else {
+                ++result.appended;
+            }
+        } else {
+            ++result.appended;
+        }
+        pending[monthOf(record.timestamp)].append(record);
+        newest = qMax(newest, record.timestamp);
+    }
+
+    if (pending.isEmpty())
+        return result;
+
+    QDir().mkpath(sensorDirectory(sensorId));
+    for (auto it = pending.cbegin(); it != pending.cend(); ++it) {
+        const QString path = QDir(sensorDirectory(sensorId)).filePath(QString("%1.seg").arg(it.key()));
+        if (!appendRecords(path, it.value())) {
+            qWarning() << "Nie można dopisać historii sensora" << sensorId << "do" << path;
+            m_lastTimestamps.remove(sensorId);
+            return result;
+        }
+    }
+    m_lastTimestamps.insert(sensorId, newest);
+    return result;
+}
+
+/**
+ * @brief Odczytuje pomiary sensora z przedziału czasu.
+ * @param sensorId Identyfikator sensora.
+ * @param from Początek przedziału (sekundy od epoki, włącznie).
+ * @param to Koniec przedziału (sekundy od epoki, włącznie).
+ * @return Szereg uporządkowany rosnąco według czasu, z najnowszą wersją każdego pomiaru.
+ */
+SensorSeries HistoryStore::query(int sensorId, qint64 from, qint64 to) const
+{
+    MetricsTimer timer("gios_history_duration_ms", "op=query");
+    SensorSeries series;
+    if (from > to)
+        return series;
+
+    const int firstMonth = monthOf(from);
+    const int lastMonth = monthOf(to);
+    const QDir dir(sensorDirectory(sensorId));
+    for (int month : segmentMonths(sensorId)) {
+        if (month < firstMonth || month > lastMonth)
+            continue;
+
+        QList<Record> records;
+        readSegment(dir.filePath(QString("%1.seg").arg(month)), records);
+        const auto begin = std::lower_bound(records.cbegin(), records.cend(), from, [](const Record &record, qint64 time) {
+            return record.timestamp < time;
+        });
+        const auto end = std::upper_bound(begin, records.cend(), to, [](qint64 time, const Record &record) {
+            return time < record.timestamp;
+        });
+        series.reserve(series.size() + int(end - begin));
+        for (auto it = begin; it != end; ++it)
+            series.append(it->timestamp, it->value, it->isNull);
+    }
+    return series;
+}
+
+/**
+ * @brief Pobiera znacznik czasu najnowszego zapisanego pomiaru.
+ * @param sensorId Identyfikator sensora.
+ * @return Znacznik czasu lub -1, jeśli sensor nie ma historii.
+ */
+qint64 HistoryStore::lastTimestamp(int sensorId) const
+{
+    const auto cached = m_lastTimestamps.constFind(sensorId);
+    if (cached != m_lastTimestamps.constEnd())
+        return cached.value();
+
+    qint64 last = -1;
+    const QList<int> months = segmentMonths(sensorId);
+    const QDir dir(sensorDirectory(sensorId));
+    for (auto it = months.crbegin(); it != months.crend() && last < 0; ++it) {
+        QList<Record> records;
+        readSegment(dir.filePath(QString("%1.seg").arg(*it)), records);
+        if (!records.isEmpty())
+            last = records.last().timestamp;
+    }
+    m_lastTimestamps.insert(sensorId, last);
+    return last;
+}
+
+/**
+ * @brief Pobiera identyfikatory sensorów z historią.
+ * @return Lista identyfikatorów posortowana rosnąco.
+ */
+QList<int> HistoryStore::sensorIds() const
+{
+    QList<int> ids;
+    const QStringList names = QDir(m_directory).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &name : names) {
+        bool ok = false;
+        const int id = name.toInt(&ok);
+        if (ok)
+            ids.append(id);
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+/**
+ * @brief Przepisuje segmenty sensora bez rekordów zastąpionych poprawkami.
+ * @param sensorId Identyfikator sensora.
+ * @return Liczba usuniętych rekordów.
+ *
+ * Segment zastępowany jest atomowo; segmenty bez poprawek nie są zapisywane.
+ */
+int HistoryStore::compact(int sensorId)
+{
+    int removed = 0;
+    const QDir dir(sensorDirectory(sensorId));
+    for (int month : segmentMonths(sensorId)) {
+        const QString path = dir.filePath(QString("%1.seg").arg(month));
+        QList<Record> records;
+        const int total = readSegment(path, records);
+        if (total == records.size())
+            continue;
+
+        QByteArray bytes;
+        bytes.reserve(kHeaderSize + records.size() * kRecordSize);
+        appendHeader(bytes);
+        for (const Record &record : std::as_const(records))
+            appendRecord(bytes, record.timestamp, record.value, record.isNull);
+
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly) || file.write(bytes) != bytes.size())
+            continue;
+        if (file.commit())
+            removed += total - records.size();
+    }
+    return removed;
+}
+
+/**
+ * @brief Zwraca katalog segmentów sensora.
+ * @param sensorId Identyfikator sensora.
+ * @return Ścieżka katalogu.
+ */
+QString HistoryStore::sensorDirectory(int sensorId) const
+{
+    return QDir(m_directory).filePath(QString::number(sensorId));
+}
+
+/**
+ * @brief Zwraca miesiące segmentów sensora.
+ * @param sensorId Identyfikator sensora.
+ * @return Miesiące w postaci yyyyMM posortowane rosnąco.
+ */
+QList<int> HistoryStore::segmentMonths(int sensorId) const
+{
+    QList<int> months;
+    const QStringList names = QDir(sensorDirectory(sensorId)).entryList(QStringList() << "*.seg", QDir::Files, QDir::Name);
+    for (const QString &name : names) {
+        bool ok = false;
+        const int month = name.chopped(4).toInt(&ok);
+        if (ok)
+            months.append(month);
+    }
+    std::sort(months.begin(), months.end());
+    return months;
+}
+
+/**
+ * @brief Odczytuje rekordy segmentu z pominięciem rekordów zastąpionych.
+ * @param path Ścieżka segmentu.
+ * @param records Lista, do której trafiają rekordy uporządkowane według czasu.
+ * @return Liczba wszystkich rekordów w pliku.
+ *
+ * Niepełny rekord na końcu pliku (przerwany zapis) jest pomijany.
+ */
+int HistoryStore::readSegment(const QString &path, QList<Record> &records)
+{
+    records.clear();
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return 0;
+
+    const qint64 size = file.size();
+    if (size < kHeaderSize)
+        return 0;
+    const uchar *data = file.map(0, size);
+    QByteArray fallback;
+    if (!data) {
+        fallback = file.readAll();
+        data = reinterpret_cast<const uchar *>(fallback.constData());
+    }
+
+    if (qFromLittleEndian<quint32>(data) != kSegmentMagic || qFromLittleEndian<quint16>(data + 4) != kSegmentVersion)
+        return 0;
+
+    const int count = int((size - kHeaderSize) / kRecordSize);
+    records.reserve(count);
+    const uchar *record = data + kHeaderSize;
+    for (int i = 0; i < count; ++i, record += kRecordSize) {
+        Record parsed;
+        parsed.timestamp = qFromLittleEndian<qint64>(record);
+        const quint64 bits = qFromLittleEndian<quint64>(record + 8);
+        std::memcpy(&parsed.value, &bits, sizeof(bits));
+        parsed.isNull = record[16] & kRecordNull;
+        records.append(parsed);
+    }
+
+    // Kolejność dopisania rozstrzyga o wersji, dlatego sortowanie jest stabilne
+    if (!std::is_sorted(records.cbegin(), records.cend(), [](const Record &a, const Record &b) {
+            return a.timestamp < b.timestamp;
+        })) {
+        std::stable_sort(records.begin(), records.end(), [](const Record &a, const Record &b) {
+            return a.timestamp < b.timestamp;
+        });
+    }
+
+    // Dla powtórzonych znaczników czasu zostaje ostatni zapisany rekord
+    int kept = 0;
+    for (int i = 0; i < records.size(); ++i) {
+        if (i + 1 < records.size() && records.at(i + 1).timestamp == records.at(i).timestamp)
+            continue;
+        records[kept++] = records.at(i);
+    }
+    records.resize(kept);
+    return count;
+}
+
+/**
+ * @brief Dopisuje rekordy na końcu segmentu.
+ * @param path Ścieżka segmentu.
+ * @param records Rekordy.
+ * @return True, jeśli zapis się powiódł.
+ *
+ * Nowy segment dostaje nagłówek, a niepełny rekord po przerwanym zapisie jest obcinany.
+ */
+bool HistoryStore::appendRecords(const QString &path, const QList<Record> &records)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadWrite))
+        return false;
+
+    QByteArray bytes;
+    bytes.reserve(kHeaderSize + records.size() * kRecordSize);
+    const qint64 size = file.size();
+    if (size < kHeaderSize) {
+        file.resize(0);
+        appendHeader(bytes);
+    } else if ((size - kHeaderSize) % kRecordSize != 0) {
+        file.resize(size - (size - kHeaderSize) % kRecordSize);
+    }
+
+    for (const Record &record : records)
+        appendRecord(bytes, record.timestamp, record.value, record.isNull);
+
+    file.seek(file.size());
+    return file.write(bytes) == bytes.size();
+}
+
+/**
+ * @brief Wyznacza miesiąc znacznika czasu.
+ * @param timestamp Znacznik czasu (sekundy od epoki).
+ * @return Miesiąc w postaci yyyyMM.
+ */
+int HistoryStore::monthOf(qint64 timestamp)
+{
+    const QDate date = QDateTime::fromSecsSinceEpoch(timestamp, QTimeZone::utc()).date();
+    return date.year() * 100 + date.month();
+}
@@ -0,0 +1,142 @@
+/**
+ * @file historystore.h
+ * @brief Plik nagłówkowy dla klasy HistoryStore.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje ciągłą historię pomiarów sensorów zapisywaną bez powtórzeń
+ * w plikach tylko do dopisywania.
+ */
+
+#ifndef HISTORYSTORE_H
+#define HISTORYSTORE_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include "sensorseries.h"
+
+/**
+ * @struct HistoryMergeResult
+ * @brief Wynik dopisania szeregu do historii.
+ */
+struct HistoryMergeResult {
+    int appended = 0;    ///< Liczba nowych pomiarów.
+    int corrected = 0;   ///< Liczba pomiarów z poprawioną wartością.
+    int unchanged = 0;   ///< Liczba pomiarów już obecnych w historii.
+};
+
+/**
+ * @class HistoryStore
+ * @brief Historia pomiarów z kluczem (sensorId, znacznik czasu).
+ *
+ * Każdy sensor ma katalog z segmentami miesięcznymi (yyyyMM.seg) złożonymi z rekordów
+ * stałej długości: znacznik czasu, wartość i flaga pustego pomiaru. Segmenty są tylko
+ * dopisywane: nowe pomiary i poprawki wartości trafiają na koniec segmentu, a przy odczycie
+ * dla danego znacznika czasu obowiązuje ostatni rekord. Zapytanie o przedział czasu
+ * otwiera wyłącznie segmenty miesięcy, które się z nim przecinają.
+ */
+class HistoryStore {
+public:
+    /**
+     * @brief Konstruktor obiektu HistoryStore.
+     * @param directory Katalog historii.
+     */
+    explicit HistoryStore(const QString &directory);
+
+    /**
+     * @brief Pobiera katalog historii.
+     * @return Ścieżka katalogu.
+     */
+    QString directory() const { return m_directory; }
+
+    /**
+     * @brief Dopisuje do historii pomiary nowsze niż zapisane i poprawki wcześniejszych.
+     * @param sensorId Identyfikator sensora.
+     * @param series Szereg uporządkowany rosnąco według czasu.
+     * @return Liczby pomiarów nowych, poprawionych i niezmienionych.
+     */
+    HistoryMergeResult merge(int sensorId, const SensorSeries &series);
+
+    /**
+     * @brief Odczytuje pomiary sensora z przedziału czasu.
+     * @param sensorId Identyfikator sensora.
+     * @param from Początek przedziału (sekundy od epoki, włącznie).
+     * @param to Koniec przedziału (sekundy od epoki, włącznie).
+     * @return Szereg uporządkowany rosnąco według czasu, z najnowszą wersją każdego pomiaru.
+     */
+    SensorSeries query(int sensorId, qint64 from, qint64 to) const;
+
+    /**
+     * @brief Pobiera znacznik czasu najnowszego zapisanego pomiaru.
+     * @param sensorId Identyfikator sensora.
+     * @return Znacznik czasu lub -1, jeśli sensor nie ma historii.
+     */
+    qint64 lastTimestamp(int sensorId) const;
+
+    /**
+     * @brief Pobiera identyfikatory sensorów z historią.
+     * @return Lista identyfikatorów posortowana rosnąco.
+     */
+    QList<int> sensorIds() const;
+
+    /**
+     * @brief Przepisuje segmenty sensora bez rekordów zastąpionych poprawkami.
+     * @param sensorId Identyfikator sensora.
+     * @return Liczba usuniętych rekordów.
+     */
+    int compact(int sensorId);
+
+private:
+    /**
+     * @struct Record
+     * @brief Rekord segmentu.
+     */
+    struct Record {
+        qint64 timestamp = 0;   ///< Znacznik czasu (sekundy od epoki).
+        double value = 0.0;     ///< Wartość pomiaru.
+        bool isNull = false;    ///< Czy pomiar jest pusty.
+    };
+
+    /**
+     * @brief Zwraca katalog segmentów sensora.
+     * @param sensorId Identyfikator sensora.
+     * @return Ścieżka katalogu.
+     */
+    QString sensorDirectory(int sensorId) const;
+
+    /**
+     * @brief Zwraca miesiące segmentów sensora.
+     * @param sensorId Identyfikator sensora.
+     * @return Miesiące w postaci yyyyMM posortowane rosnąco.
+     */
+    QList<int> segmentMonths(int sensorId) const;
+
+    /**
+     * @brief Odczytuje rekordy segmentu z pominięciem rekordów zastąpionych.
+     * @param path Ścieżka segmentu.
+     * @param records Lista, do której trafiają rekordy uporządkowane według czasu.
+     * @return Liczba wszystkich rekordów w pliku.
+     */
+    static int readSegment(const QString &path, QList<Record> &records);
+
+    /**
+     * @brief Dopisuje rekordy na końcu segmentu.
+     * @param path Ścieżka segmentu.
+     * @param records Rekordy.
+     * @return True, jeśli zapis się powiódł.
+     */
+    static bool appendRecords(const QString &path, const QList<Record> &records);
+
+    /**
+     * @brief Wyznacza miesiąc znacznika czasu.
+     * @param timestamp Znacznik czasu (sekundy od epoki).
+     * @return Miesiąc w postaci yyyyMM.
+     */
+    static int monthOf(qint64 timestamp);
+
+    QString m_directory;                          ///< Katalog historii.
+    mutable QHash<int, qint64> m_lastTimestamps;  ///< Znaczniki najnowszych pomiarów według sensora.
+};
+
+#endif // HISTORYSTORE_H
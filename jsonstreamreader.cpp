@@ -0,0 +1,442 @@
+/**
+ * @file jsonstreamreader.cpp
+ * @brief Implementacja klasy JsonStreamReader.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera przyrostowy lekser JSON z jawną maszyną stanów.
+ */
+
+#include "jsonstreamreader.h"
+
+namespace {
+
+/**
+ * @brief Sprawdza, czy znak jest białym znakiem JSON.
+ * @param c Znak.
+ * @return True dla spacji, tabulacji i znaków końca wiersza.
+ */
+inline bool isJsonSpace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+/**
+ * @brief Zamienia cyfrę szesnastkową na wartość.
+ * @param c Znak.
+ * @return Wartość cyfry lub -1, jeśli znak nie jest cyfrą szesnastkową.
+ */
+inline int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ * @brief Sprawdza, czy znak może należeć do liczby JSON.
+ * @param c Znak.
+ * @return True dla cyfr, znaków, kropki i wykładnika.
+ */
+inline bool isNumberChar(char c)
+{
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+} // namespace
+
+/**
+ * @brief Konstruktor obiektu JsonStreamReader.
+ * @param handler Odbiorca zdarzeń; musi istnieć przez cały czas życia czytnika.
+ */
+JsonStreamReader::JsonStreamReader(JsonStreamHandler *handler)
+    : m_handler(handler)
+{
+}
+
+/**
+ * @brief Przywraca stan początkowy czytnika.
+ */
+void JsonStreamReader::reset()
+{
+    m_state = State::Value;
+    m_stack.clear();
+    m_token.clear();
+    m_tokenIsKey = false;
+    m_unicodeDigits = 0;
+    m_unicodeUnit = 0;
+    m_highSurrogate = 0;
+    m_offset = 0;
+    m_position = 0;
+    m_error.clear();
+}
+
+/**
+ * @brief Przetwarza kolejny fragment dokumentu.
+ * @param data Dane fragmentu.
+ * @param size Rozmiar fragmentu w bajtach.
+ * @return False, jeśli dokument jest niepoprawny.
+ *
+ * Znak kończący liczbę lub literał jest przetwarzany ponownie w następnym stanie,
+ * dlatego indeks jest zwiększany jawnie w każdej gałęzi.
+ */
+bool JsonStreamReader::feed(const char *data, qsizetype size)
+{
+    qsizetype i = 0;
+    while (i < size && m_state != State::Error) {
+        const char c = data[i];
+        m_position = m_offset + i;
+        switch (m_state) {
+        case State::Value:
+            if (!isJsonSpace(c))
+                beginValue(c);
+            ++i;
+            break;
+        case State::ValueOrEnd:
+            if (c == ']') {
+                closeContainer(Container::Array);
+            } else if (!isJsonSpace(c)) {
+                beginValue(c);
+            }
+            ++i;
+            break;
+        case State::KeyOrEnd:
+        case State::Key:
+            if (c == '"') {
+                m_token.clear();
+                m_tokenIsKey = true;
+                m_state = State::String;
+            } else if (c == '}' && m_state == State::KeyOrEnd) {
+                closeContainer(Container::Object);
+            } else if (!isJsonSpace(c)) {
+                fail("oczekiwano klucza");
+            }
+            ++i;
+            break;
+        case State::Colon:
+            if (c == ':')
+                m_state = State::Value;
+            else if (!isJsonSpace(c))
+                fail("oczekiwano ':'");
+            ++i;
+            break;
+        case State::AfterValue:
+            if (c == ',')
+                m_state = m_stack.last() == Container::Object ? State::Key : State::Value;
+            else if (c == '}')
+                closeContainer(Container::Object);
+            else if (c == ']')
+                closeContainer(Container::Array);
+            else if (!isJsonSpace(c))
+                fail("oczekiwano ',' lub końca kontenera");
+            ++i;
+            break;
+        case State::String: {
+            // Kopiuj od razu cały ciąg zwykłych znaków aż do cudzysłowu lub '\'
+            qsizetype end = i;
+            while (end < size && data[end] != '"' && data[end] != '\\'
+                   && static_cast<unsigned char>(data[end]) >= 0x20)
+                ++end;
+            if (end > i) {
+                flushSurrogate();
+                m_token.append(data + i, end - i);
+                i = end;
+                break;
+            }
+            if (c == '"')
+                endString();
+            else if (c == '\\')
+                m_state = State::Escape;
+            else
+                fail("niedozwolony znak sterujący w tekście");
+            ++i;
+            break;
+        }
+        case State::Escape: {
+            char decoded = 0;
+            switch (c) {
+            case '"': decoded = '"'; break;
+            case '\\': decoded = '\\'; break;
+            case '/': decoded = '/'; break;
+            case 'b': decoded = '\b'; break;
+            case 'f': decoded = '\f'; break;
+            case 'n': decoded = '\n'; break;
+            case 'r': decoded = '\r'; break;
+            case 't': decoded = '\t'; break;
+            case 'u':
+                m_unicodeDigits = 0;
+                m_unicodeUnit = 0;
+                m_state = State::Unicode;
+                break;
+            default:
+                fail("niepoprawna sekwencja ucieczki");
+                break;
+            }
+            if (decoded) {
+                flushSurrogate();
+                m_token.append(decoded);
+                m_state = State::String;
+            }
+            ++i;
+            break;
+        }
+        case State::Unicode: {
+            const int digit = hexValue(c);
+            if (digit < 0) {
+                fail("niepoprawna sekwencja \\u");
+            } else {
+                m_unicodeUnit = char16_t((m_unicodeUnit << 4) | digit);
+                if (++m_unicodeDigits == 4) {
+                    appendCodeUnit(m_unicodeUnit);
+                    m_state = State::String;
+                }
+            }
+            ++i;
+            break;
+        }
+        case State::Number:
+            if (isNumberChar(c)) {
+                m_token.append(c);
+                ++i;
+            } else if (endNumber()) {
+                // Znak kończący liczbę należy do następnego stanu
+                valueDone();
+            }
+            break;
+        case State::Literal:
+            if (c >= 'a' && c <= 'z') {
+                m_token.append(c);
+                ++i;
+            } else if (endLiteral()) {
+                valueDone();
+            }
+            break;
+        case State::Done:
+            if (!isJsonSpace(c))
+                fail("dane po końcu dokumentu");
+            ++i;
+            break;
+        case State::Error:
+            break;
+        }
+    }
+
+    if (m_state == State::Error)
+        return false;
+    m_offset += size;
+    return true;
+}
+
+/**
+ * @brief Kończy dokument.
+ * @return True, jeśli dokument był kompletny i poprawny.
+ *
+ * Liczba lub literał na najwyższym poziomie nie ma znaku kończącego, więc jest domykany tutaj.
+ */
+bool JsonStreamReader::finish()
+{
+    if (m_state == State::Number && m_stack.isEmpty()) {
+        if (endNumber())
+            valueDone();
+    } else if (m_state == State::Literal && m_stack.isEmpty()) {
+        if (endLiteral())
+            valueDone();
+    }
+
+    if (m_state == State::Error)
+        return false;
+    if (m_state != State::Done) {
+        m_position = m_offset;
+        return fail("niepełny dokument");
+    }
+    return true;
+}
+
+/**
+ * @brief Rozpoczyna wartość od podanego znaku.
+ * @param c Pierwszy znak wartości.
+ * @return False, jeśli znak nie rozpoczyna żadnej wartości.
+ */
+bool JsonStreamReader::beginValue(char c)
+{
+    m_token.clear();
+    switch (c) {
+    case '{':
+        m_stack.append(Container::Object);
+        m_handler->startObject();
+        m_state = State::KeyOrEnd;
+        return true;
+    case '[':
+        m_stack.append(Container::Array);
+        m_handler->startArray();
+        m_state = State::ValueOrEnd;
+        return true;
+    case '"':
+        m_tokenIsKey = false;
+        m_state = State::String;
+        return true;
+    case 't':
+    case 'f':
+    case 'n':
+        m_token.append(c);
+        m_state = State::Literal;
+        return true;
+    default:
+        if (c == '-' || (c >= '0' && c <= '9')) {
+            m_token.append(c);
+            m_state = State::Number;
+            return true;
+        }
+        return fail("oczekiwano wartości");
+    }
+}
+
+/**
+ * @brief Zamyka kontener.
+ * @param container Rodzaj kontenera wskazany przez znak zamykający.
+ */
+void JsonStreamReader::closeContainer(Container container)
+{
+    if (m_stack.isEmpty() || m_stack.last() != container) {
+        fail("niedopasowany koniec kontenera");
+        return;
+    }
+    m_stack.removeLast();
+    if (container == Container::Object)
+        m_handler->endObject();
+    else
+        m_handler->endArray();
+    valueDone();
+}
+
+/**
+ * @brief Przechodzi do stanu po zakończonej wartości.
+ */
+void JsonStreamReader::valueDone()
+{
+    m_state = m_stack.isEmpty() ? State::Done : State::AfterValue;
+}
+
+/**
+ * @brief Kończy liczbę i przekazuje ją odbiorcy.
+ * @return False, jeśli liczba jest niepoprawna.
+ */
+bool JsonStreamReader::endNumber()
+{
+    bool ok = false;
+    const double number = m_token.toDouble(&ok);
+    if (!ok)
+        return fail("niepoprawna liczba");
+    m_handler->value(QJsonValue(number));
+    return true;
+}
+
+/**
+ * @brief Kończy literał true/false/null i przekazuje go odbiorcy.
+ * @return False, jeśli literał jest nieznany.
+ */
+bool JsonStreamReader::endLiteral()
+{
+    if (m_token == "true")
+        m_handler->value(QJsonValue(true));
+    else if (m_token == "false")
+        m_handler->value(QJsonValue(false));
+    else if (m_token == "null")
+        m_handler->value(QJsonValue(QJsonValue::Null));
+    else
+        return fail("nieznany literał");
+    return true;
+}
+
+/**
+ * @brief Kończy tekst i przekazuje go odbiorcy jako klucz lub wartość.
+ */
+void JsonStreamReader::endString()
+{
+    flushSurrogate();
+    const QString text = QString::fromUtf8(m_token);
+    if (m_tokenIsKey) {
+        m_handler->key(text);
+        m_state = State::Colon;
+    } else {
+        m_handler->value(QJsonValue(text));
+        valueDone();
+    }
+}
+
+/**
+ * @brief Dopisuje jednostkę UTF-16 z sekwencji \\uXXXX.
+ * @param unit Jednostka kodowa.
+ *
+ * Pary surogatów są łączone w jeden znak; osierocony surogat zastępowany jest znakiem U+FFFD.
+ */
+void JsonStreamReader::appendCodeUnit(char16_t unit)
+{
+    if (QChar::isLowSurrogate(unit)) {
+        if (m_highSurrogate) {
+            appendCodePoint(QChar::surrogateToUcs4(m_highSurrogate, unit));
+            m_highSurrogate = 0;
+        } else {
+            appendCodePoint(0xFFFD);
+        }
+        return;
+    }
+
+    flushSurrogate();
+    if (QChar::isHighSurrogate(unit))
+        m_highSurrogate = unit;
+    else
+        appendCodePoint(unit);
+}
+
+/**
+ * @brief Dopisuje znak do bieżącego tekstu w kodowaniu UTF-8.
+ * @param codePoint Kod znaku.
+ */
+void JsonStreamReader::appendCodePoint(char32_t codePoint)
+{
+    if (codePoint < 0x80) {
+        m_token.append(char(codePoint));
+    } else if (codePoint < 0x800) {
+        m_token.append(char(0xC0 | (codePoint >> 6)));
+        m_token.append(char(0x80 | (codePoint & 0x3F)));
+    } else if (codePoint < 0x10000) {
+        m_token.append(char(0xE0 | (codePoint >> 12)));
+        m_token.append(char(0x80 | ((codePoint >> 6) & 0x3F)));
+        m_token.append(char(0x80 | (codePoint & 0x3F)));
+    } else {
+        m_token.append(char(0xF0 | (codePoint >> 18)));
+        m_token.append(char(0x80 | ((codePoint >> 12) & 0x3F)));
+        m_token.append(char(0x80 | ((codePoint >> 6) & 0x3F)));
+        m_token.append(char(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+/**
+ * @brief Zastępuje oczekujący, niesparowany starszy surogat znakiem U+FFFD.
+ */
+void JsonStreamReader::flushSurrogate()
+{
+    if (m_highSurrogate) {
+        m_highSurrogate = 0;
+        appendCodePoint(0xFFFD);
+    }
+}
+
+/**
+ * @brief Oznacza dokument jako niepoprawny.
+ * @param message Opis błędu.
+ * @return Zawsze false.
+ *
+ * Opis zawiera pozycję bajtu, na którym przerwano odczyt.
+ */
+bool JsonStreamReader::fail(const char *message)
+{
+    m_state = State::Error;
+    m_error = QString("%1 (bajt %2)").arg(QString::fromUtf8(message)).arg(m_position);
+    return false;
+}
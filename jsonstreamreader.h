@@ -0,0 +1,152 @@
+/**
+ * @file jsonstreamreader.h
+ * @brief Plik nagłówkowy dla klasy JsonStreamReader.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje przyrostowy czytnik JSON (w stylu SAX) przetwarzający treść
+ * odpowiedzi we fragmentach, bez budowy drzewa dokumentu.
+ */
+
+#ifndef JSONSTREAMREADER_H
+#define JSONSTREAMREADER_H
+
+#include <QByteArray>
+#include <QJsonValue>
+#include <QString>
+#include <QVarLengthArray>
+
+/**
+ * @class JsonStreamHandler
+ * @brief Odbiorca zdarzeń czytnika JsonStreamReader.
+ *
+ * Wartości proste (tekst, liczba, logiczna, null) przekazywane są jako QJsonValue;
+ * obiekty i tablice wyłącznie jako zdarzenia początku i końca.
+ */
+class JsonStreamHandler {
+public:
+    virtual ~JsonStreamHandler() = default;
+
+    /// Początek obiektu.
+    virtual void startObject() = 0;
+    /// Koniec obiektu.
+    virtual void endObject() = 0;
+    /// Początek tablicy.
+    virtual void startArray() = 0;
+    /// Koniec tablicy.
+    virtual void endArray() = 0;
+
+    /**
+     * @brief Klucz pola obiektu; następne zdarzenie dotyczy jego wartości.
+     * @param name Nazwa pola.
+     */
+    virtual void key(const QString &name) = 0;
+
+    /**
+     * @brief Wartość prosta.
+     * @param value Tekst, liczba, wartość logiczna lub null.
+     */
+    virtual void value(const QJsonValue &value) = 0;
+};
+
+/**
+ * @class JsonStreamReader
+ * @brief Przyrostowy czytnik JSON przetwarzający dane fragmentami.
+ *
+ * Stan leksera (niedokończony tekst, liczba, sekwencja \\uXXXX) jest zachowywany między
+ * wywołaniami feed(), więc fragmenty mogą być dzielone w dowolnym miejscu, także w środku
+ * znaku UTF-8. Pamięć czytnika zależy tylko od głębokości zagnieżdżenia i długości
+ * najdłuższego tekstu, a nie od rozmiaru dokumentu.
+ */
+class JsonStreamReader {
+public:
+    /**
+     * @brief Konstruktor obiektu JsonStreamReader.
+     * @param handler Odbiorca zdarzeń; musi istnieć przez cały czas życia czytnika.
+     */
+    explicit JsonStreamReader(JsonStreamHandler *handler);
+
+    /**
+     * @brief Przetwarza kolejny fragment dokumentu.
+     * @param data Dane fragmentu.
+     * @param size Rozmiar fragmentu w bajtach.
+     * @return False, jeśli dokument jest niepoprawny.
+     */
+    bool feed(const char *data, qsizetype size);
+
+    /**
+     * @brief Przetwarza kolejny fragment dokumentu.
+     * @param chunk Fragment dokumentu.
+     * @return False, jeśli dokument jest niepoprawny.
+     */
+    bool feed(const QByteArray &chunk) { return feed(chunk.constData(), chunk.size()); }
+
+    /**
+     * @brief Kończy dokument.
+     * @return True, jeśli dokument był kompletny i poprawny.
+     */
+    bool finish();
+
+    /**
+     * @brief Przywraca stan początkowy czytnika.
+     */
+    void reset();
+
+    /**
+     * @brief Sprawdza, czy wystąpił błąd.
+     * @return True, jeśli dokument okazał się niepoprawny.
+     */
+    bool hasError() const { return m_state == State::Error; }
+
+    /**
+     * @brief Pobiera opis błędu.
+     * @return Opis błędu z pozycją w dokumencie; pusty, jeśli błędu nie było.
+     */
+    QString errorString() const { return m_error; }
+
+private:
+    /// Stan leksera.
+    enum class State {
+        Value,          ///< Oczekiwana wartość.
+        ValueOrEnd,     ///< Oczekiwana wartość lub ']' (zaraz po '[').
+        KeyOrEnd,       ///< Oczekiwany klucz lub '}' (zaraz po '{').
+        Key,            ///< Oczekiwany klucz (po ',' w obiekcie).
+        Colon,          ///< Oczekiwany ':' po kluczu.
+        AfterValue,     ///< Oczekiwany ',' lub koniec kontenera.
+        String,         ///< Wewnątrz tekstu.
+        Escape,         ///< Po '\\' w tekście.
+        Unicode,        ///< Wewnątrz sekwencji \\uXXXX.
+        Number,         ///< Wewnątrz liczby.
+        Literal,        ///< Wewnątrz true/false/null.
+        Done,           ///< Dokument zakończony.
+        Error           ///< Dokument niepoprawny.
+    };
+
+    /// Rodzaj otwartego kontenera.
+    enum class Container : char { Object, Array };
+
+    bool beginValue(char c);
+    void closeContainer(Container container);
+    void valueDone();
+    bool endNumber();
+    bool endLiteral();
+    void endString();
+    void appendCodeUnit(char16_t unit);
+    void appendCodePoint(char32_t codePoint);
+    void flushSurrogate();
+    bool fail(const char *message);
+
+    JsonStreamHandler *m_handler;                  ///< Odbiorca zdarzeń.
+    State m_state = State::Value;                  ///< Bieżący stan.
+    QVarLengthArray<Container, 16> m_stack;        ///< Otwarte kontenery.
+    QByteArray m_token;                            ///< Bieżący tekst, liczba lub literał (UTF-8).
+    bool m_tokenIsKey = false;                     ///< Czy bieżący tekst jest kluczem.
+    int m_unicodeDigits = 0;                       ///< Liczba odczytanych cyfr \\uXXXX.
+    char16_t m_unicodeUnit = 0;                    ///< Bieżąca jednostka \\uXXXX.
+    char16_t m_highSurrogate = 0;                  ///< Oczekujący starszy surogat.
+    qint64 m_offset = 0;                           ///< Pozycja początku bieżącego fragmentu.
+    qint64 m_position = 0;                         ///< Pozycja bieżącego bajtu (do opisu błędu).
+    QString m_error;                               ///< Opis błędu.
+};
+
+#endif // JSONSTREAMREADER_H
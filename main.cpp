@@ -11,7 +11,11 @@
 #include <QGuiApplication>
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
+#include <QQuickWindow>
+#include <QElapsedTimer>
+#include <QDebug>
 #include "mainwindow.h"
+#include "sensorchart.h"
 
 /**
  * @brief Główna funkcja aplikacji.
@@ -26,12 +30,21 @@ int main(int argc, char *argv[])
 {
     QGuiApplication app(argc, argv);
 
+    // Pomiar czasu od startu do pierwszej wyrenderowanej klatki
+    QElapsedTimer startupTimer;
+    startupTimer.start();
+
     // Utworzenie instancji MainWindow
     MainWindow mainWindow;
 
+    // Rejestracja natywnego wykresu sensorów dla QML
+    qmlRegisterType<SensorChart>("AirQuality", 1, 0, "SensorChart");
+
     QQmlApplicationEngine engine;
     // Udostępnienie MainWindow w QML jako "mainWindow"
     engine.rootContext()->setContextProperty("mainWindow", &mainWindow);
+    // Kafelki nakładki pól stężeń (silnik QML przejmuje dostawcę)
+    engine.addImageProvider("pollution", new PollutantTileProvider(mainWindow.pollutantRaster()));
 
     const QUrl url(QStringLiteral("qrc:/main.qml"));
     /**
@@ -45,6 +58,16 @@ int main(int argc, char *argv[])
                          if (!obj && url == objUrl)
                              QCoreApplication::exit(-1);
                      }, Qt::QueuedConnection);
+    QObject::connect(&engine, &QQmlApplicationEngine::objectCreated,
+                     &app, [&startupTimer, &mainWindow](QObject *obj, const QUrl &) {
+                         auto *window = qobject_cast<QQuickWindow*>(obj);
+                         if (!window)
+                             return;
+                         QObject::connect(window, &QQuickWindow::frameSwapped, window, [&startupTimer, &mainWindow]() {
+                             qInfo().noquote() << QString("Pierwsza klatka po %1 ms (%2 stacji na mapie)")
+                                                      .arg(startupTimer.elapsed()).arg(mainWindow.allStations()->count());
+                         }, Qt::SingleShotConnection);
+                     });
     engine.load(url);
 
     return app.exec();
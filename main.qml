@@ -71,13 +71,60 @@ ApplicationWindow {
              */
             TextField {
                 id: cityInput
-                width: parent.width - searchButton.width - archiveButton.width - 20
+                width: parent.width - searchButton.width - archiveButton.width - diagnosticsButton.width - monitorSwitch.width - 40
                 height: 40
                 placeholderText: "Wpisz nazwę miasta"
                 font.pixelSize: 16
                 onAccepted: {
+                    suggestionPopup.close()
                     mainWindow.searchCity(text)
                 }
+                /**
+                 * @brief Aktualizuje podpowiedzi z lokalnego indeksu stacji podczas pisania.
+                 */
+                onTextEdited: {
+                    suggestionList.model = text.length > 0 ? mainWindow.suggest(text, 8) : []
+                    if (suggestionList.count > 0) {
+                        suggestionPopup.open()
+                    } else {
+                        suggestionPopup.close()
+                    }
+                }
+
+                /**
+                 * @brief Lista podpowiedzi (miasta, nazwy stacji, ulice) pod polem wyszukiwania.
+                 */
+                Popup {
+                    id: suggestionPopup
+                    y: cityInput.height
+                    width: cityInput.width
+                    height: Math.min(suggestionList.contentHeight, 320) + topPadding + bottomPadding
+                    padding: 1
+                    closePolicy: Popup.CloseOnEscape | Popup.CloseOnPressOutsideParent
+
+                    ListView {
+                        id: suggestionList
+                        anchors.fill: parent
+                        clip: true
+                        model: []
+
+                        delegate: ItemDelegate {
+                            width: suggestionList.width
+                            font.pixelSize: 14
+                            text: modelData.kind === "city"
+                                  ? modelData.text + " (" + modelData.stationCount + " stacji)"
+                                  : modelData.text + ", " + modelData.cityName
+                            onClicked: {
+                                cityInput.text = modelData.cityName
+                                suggestionPopup.close()
+                                mainWindow.searchCity(modelData.cityName)
+                                if (modelData.stationId >= 0) {
+                                    root.highlightedStationId = modelData.stationId
+                                }
+                            }
+                        }
+                    }
+                }
             }
 
             /**
@@ -113,6 +160,38 @@ ApplicationWindow {
                     }
                 }
             }
+
+            /**
+             * @brief Przycisk do otwierania panelu metryk czasu działania.
+             */
+            Button {
+                id: diagnosticsButton
+                text: "Diagnostyka"
+                width: 110
+                height: 40
+                font.pixelSize: 14
+                onClicked: {
+                    var component = Qt.createComponent("qrc:/DiagnosticsDialog.qml");
+                    if (component.status === Component.Ready) {
+                        var dialog = component.createObject(root);
+                        dialog.open();
+                    } else {
+                        console.log("Error loading DiagnosticsDialog.qml: " + component.errorString());
+                    }
+                }
+            }
+
+            /**
+             * @brief Przełącznik cogodzinnego monitorowania obserwowanych stacji.
+             */
+            Switch {
+                id: monitorSwitch
+                text: mainWindow.monitor.busy ? "Monitorowanie…" : "Monitorowanie"
+                height: 40
+                font.pixelSize: 14
+                checked: mainWindow.monitor.enabled
+                onToggled: mainWindow.monitor.enabled = checked
+            }
         }
 
         /**
@@ -152,6 +231,26 @@ ApplicationWindow {
                     wrapMode: Text.WordWrap
                 }
 
+                /**
+                 * @brief Przycisk porównania wyszukanych stacji dla jednego parametru.
+                 */
+                Button {
+                    id: compareButton
+                    text: "Porównaj stacje"
+                    visible: stationList.count > 1
+                    height: 36
+                    font.pixelSize: 14
+                    onClicked: {
+                        var component = Qt.createComponent("qrc:/ComparisonDialog.qml");
+                        if (component.status === Component.Ready) {
+                            var dialog = component.createObject(root, { "stationIds": mainWindow.stations.stationIds });
+                            dialog.open();
+                        } else {
+                            console.log("Error loading ComparisonDialog.qml: " + component.errorString());
+                        }
+                    }
+                }
+
                 /**
                  * @brief Lista wyszukanych stacji.
                  */
@@ -159,6 +258,7 @@ ApplicationWindow {
                     id: stationList
                     width: parent.width
                     height: parent.height - listHeader.height - parent.spacing
+                            - (compareButton.visible ? compareButton.height + parent.spacing : 0)
                     spacing: 10
                     clip: true
 
@@ -167,7 +267,7 @@ ApplicationWindow {
                     delegate: Rectangle {
                         width: parent.width
                         height: 120
-                        color: modelData.stationId === root.highlightedStationId ? "#e0e0e0" : (mouseArea.containsMouse ? "#e0e0e0" : "#f0f0f0")
+                        color: model.stationId === root.highlightedStationId ? "#e0e0e0" : (mouseArea.containsMouse ? "#e0e0e0" : "#f0f0f0")
                         radius: 5
 
                         /**
@@ -179,21 +279,21 @@ ApplicationWindow {
                             hoverEnabled: true
                             z: 1
                             onEntered: {
-                                root.highlightedStationId = modelData.stationId
+                                root.highlightedStationId = model.stationId
                             }
                             onExited: {
                                 root.highlightedStationId = -1
                             }
                             onClicked: {
-                                mainWindow.fetchSensors(modelData.stationId)
+                                mainWindow.fetchStationData(model.stationId)
                                 var component = Qt.createComponent("qrc:/StationDialog.qml");
                                 if (component.status === Component.Ready) {
-                                    var address = modelData.address ? modelData.address : "Brak danych";
+                                    var address = model.address ? model.address : "Brak danych";
                                     var street = address === "Brak danych" ? "Brak danych" : address.split(" ")[0];
                                     var number = address === "Brak danych" ? "" : (address.split(" ").length > 1 ? address.split(" ")[1] : "");
                                     var dialog = component.createObject(root, {
-                                        "stationId": modelData.stationId,
-                                        "cityName": modelData.cityName,
+                                        "stationId": model.stationId,
+                                        "cityName": model.cityName,
                                         "street": street,
                                         "number": number
                                     });
@@ -212,19 +312,19 @@ ApplicationWindow {
                             z: 0
 
                             Text {
-                                text: "<b>Nazwa:</b> " + modelData.stationName
+                                text: "<b>Nazwa:</b> " + model.stationName
                                 font.pixelSize: 14
                             }
                             Text {
-                                text: "<b>ID:</b> " + modelData.stationId
+                                text: "<b>ID:</b> " + model.stationId
                                 font.pixelSize: 14
                             }
                             Text {
-                                text: "<b>Współrzędne:</b> " + modelData.lat + ", " + modelData.lon
+                                text: "<b>Współrzędne:</b> " + model.lat + ", " + model.lon
                                 font.pixelSize: 14
                             }
                             Text {
-                                text: "<b>Adres:</b> " + (modelData.address ? modelData.address : "Brak danych")
+                                text: "<b>Adres:</b> " + (model.address ? model.address : "Brak danych")
                                 font.pixelSize: 14
                             }
                         }
@@ -265,6 +365,33 @@ ApplicationWindow {
                     center: QtPositioning.coordinate(mainWindow.mapCenter.latitude, mainWindow.mapCenter.longitude)
                     zoomLevel: 8
 
+                    /**
+                     * @brief Przekazuje widoczny obszar mapy do modelu znaczników.
+                     */
+                    function updateViewport() {
+                        var topLeft = map.toCoordinate(Qt.point(0, 0), false)
+                        var bottomRight = map.toCoordinate(Qt.point(map.width, map.height), false)
+                        if (topLeft.isValid && bottomRight.isValid) {
+                            mainWindow.stationClusters.setViewport(topLeft.longitude, bottomRight.latitude,
+                                                                   bottomRight.longitude, topLeft.latitude, map.zoomLevel)
+                        }
+                    }
+
+                    onCenterChanged: viewportTimer.restart()
+                    onZoomLevelChanged: viewportTimer.restart()
+                    onWidthChanged: viewportTimer.restart()
+                    onHeightChanged: viewportTimer.restart()
+                    Component.onCompleted: updateViewport()
+
+                    /**
+                     * @brief Łączy zmiany widoku z jednej klatki w jedno zapytanie o znaczniki.
+                     */
+                    Timer {
+                        id: viewportTimer
+                        interval: 16
+                        onTriggered: map.updateViewport()
+                    }
+
                     Connections {
                         target: mainWindow
                         function onMapCenterChanged() {
@@ -320,14 +447,35 @@ ApplicationWindow {
                     }
 
                     /**
-                     * @brief Wyświetla znaczniki stacji na mapie.
+                     * @brief Wyświetla kafelki pola stężeń wybranego zanieczyszczenia pod znacznikami.
+                     *
+                     * Kafelek ma poziom przybliżenia siatki, więc mapa skaluje go razem z podkładem.
                      */
                     MapItemView {
-                        model: mainWindow.allStations
+                        model: mainWindow.pollutantRaster.tiles
                         delegate: MapQuickItem {
                             coordinate: QtPositioning.coordinate(modelData.lat, modelData.lon)
+                            zoomLevel: modelData.zoom
+                            sourceItem: Image {
+                                source: modelData.source
+                                cache: false
+                                smooth: true
+                            }
+                        }
+                    }
+
+                    /**
+                     * @brief Wyświetla znaczniki stacji i grup stacji na mapie.
+                     *
+                     * Model zawiera tylko znaczniki bieżącego widoku; bliskie stacje są łączone w grupy
+                     * zależnie od przybliżenia.
+                     */
+                    MapItemView {
+                        model: mainWindow.stationClusters
+                        delegate: MapQuickItem {
+                            coordinate: QtPositioning.coordinate(model.lat, model.lon)
                             anchorPoint.x: marker.width / 2
-                            anchorPoint.y: marker.height
+                            anchorPoint.y: model.isCluster ? marker.height / 2 : marker.height
 
                             sourceItem: Item {
                                 width: marker.width
@@ -335,34 +483,63 @@ ApplicationWindow {
 
                                 Rectangle {
                                     id: marker
-                                    width: (modelData.isSearched || modelData.stationId === root.highlightedStationId) ? 16 : 8
+                                    width: model.isCluster ? 22 + 12 * Math.log(model.pointCount) / Math.LN10
+                                                           : ((model.isSearched || model.stationId === root.highlightedStationId) ? 16 : 8)
                                     height: width
-                                    color: modelData.stationId === root.highlightedStationId ? "#4CAF50" : (modelData.isSearched ? "#FF0000" : "#0000FF")
+                                    // Po włączeniu indeksu jakości powietrza wypełnienie oznacza poziom,
+                                    // a wyszukanie czerwoną obwódką
+                                    property bool rated: mainWindow.airQuality.enabled && model.aqiLevel >= 0
+                                    color: model.isCluster ? (rated ? mainWindow.airQuality.levelColor(model.aqiLevel)
+                                                                    : (model.isSearched ? "#E57373" : "#5C6BC0"))
+                                                           : (model.stationId === root.highlightedStationId ? "#4CAF50"
+                                                              : (rated ? mainWindow.airQuality.levelColor(model.aqiLevel)
+                                                                       : (model.isSearched ? "#FF0000" : "#0000FF")))
+                                    opacity: model.isCluster ? 0.85 : 1.0
+                                    border.color: rated && model.isSearched ? "#FF0000" : "white"
+                                    border.width: model.isCluster || (rated && model.isSearched) ? 2 : 0
                                     radius: width / 2
+
+                                    Text {
+                                        anchors.centerIn: parent
+                                        visible: model.isCluster
+                                        text: model.pointCount
+                                        color: "white"
+                                        font.pixelSize: 12
+                                        font.bold: true
+                                    }
                                 }
 
                                 /**
-                                 * @brief Obsługuje interakcje myszą ze znacznikami stacji.
+                                 * @brief Obsługuje interakcje myszą ze znacznikami stacji i grup.
+                                 *
+                                 * Kliknięcie grupy przybliża mapę do poziomu, na którym grupa się rozpada.
                                  */
                                 MouseArea {
                                     anchors.fill: parent
                                     hoverEnabled: true
                                     onEntered: {
-                                        root.highlightedStationId = modelData.stationId
+                                        if (!model.isCluster)
+                                            root.highlightedStationId = model.stationId
                                     }
                                     onExited: {
-                                        root.highlightedStationId = -1
+                                        if (!model.isCluster)
+                                            root.highlightedStationId = -1
                                     }
                                     onClicked: {
-                                        mainWindow.fetchSensors(modelData.stationId)
+                                        if (model.isCluster) {
+                                            map.center = QtPositioning.coordinate(model.lat, model.lon)
+                                            map.zoomLevel = Math.max(model.expansionZoom, map.zoomLevel + 1)
+                                            return
+                                        }
+                                        mainWindow.fetchStationData(model.stationId)
                                         var component = Qt.createComponent("qrc:/StationDialog.qml");
                                         if (component.status === Component.Ready) {
-                                            var address = modelData.address ? modelData.address : "Brak danych";
+                                            var address = model.address ? model.address : "Brak danych";
                                             var street = address === "Brak danych" ? "Brak danych" : address.split(" ")[0];
                                             var number = address === "Brak danych" ? "" : (address.split(" ").length > 1 ? address.split(" ")[1] : "");
                                             var dialog = component.createObject(root, {
-                                                "stationId": modelData.stationId,
-                                                "cityName": modelData.cityName,
+                                                "stationId": model.stationId,
+                                                "cityName": model.cityName,
                                                 "street": street,
                                                 "number": number
                                             });
@@ -374,6 +551,98 @@ ApplicationWindow {
                         }
                     }
                 }
+
+                /**
+                 * @brief Nakładka indeksu jakości powietrza: przełącznik i legenda poziomów.
+                 *
+                 * Włączenie przeglądu pobiera najnowsze pomiary zanieczyszczeń wszystkich stacji
+                 * katalogu i barwi znaczniki poziomem indeksu.
+                 */
+                Rectangle {
+                    anchors.top: parent.top
+                    anchors.right: parent.right
+                    anchors.margins: 10
+                    width: airQualityColumn.width + 16
+                    height: airQualityColumn.height + 16
+                    radius: 5
+                    color: "#E6FFFFFF"
+                    border.color: "#cccccc"
+
+                    Column {
+                        id: airQualityColumn
+                        anchors.centerIn: parent
+                        spacing: 4
+
+                        Switch {
+                            text: mainWindow.airQuality.busy ? "Jakość powietrza…" : "Jakość powietrza"
+                            font.pixelSize: 12
+                            checked: true
+                            onToggled: {
+                                mainWindow.airQuality.enabled = checked
+                                if (!checked) {
+                                    rasterParameter.currentIndex = 0
+                                    mainWindow.pollutantRaster.parameter = ""
+                                }
+                            }
+                            Component.onCompleted: mainWindow.airQuality.enabled = checked
+                        }
+
+                        Repeater {
+                            model: mainWindow.airQuality.enabled ? mainWindow.airQuality.legend : []
+                            delegate: Row {
+                                spacing: 6
+                                Rectangle {
+                                    width: 12
+                                    height: 12
+                                    radius: 6
+                                    color: modelData.color
+                                }
+                                Text {
+                                    text: modelData.name
+                                    font.pixelSize: 12
+                                }
+                            }
+                        }
+
+                        Text {
+                            visible: mainWindow.airQuality.enabled
+                            text: "Stacje z indeksem: " + mainWindow.airQuality.ratedStations
+                            font.pixelSize: 11
+                            color: "#666666"
+                        }
+
+                        /**
+                         * @brief Wybór zanieczyszczenia pola stężeń (interpolacja pomiarów stacji).
+                         */
+                        ComboBox {
+                            id: rasterParameter
+                            visible: mainWindow.airQuality.enabled
+                            width: 150
+                            font.pixelSize: 12
+                            model: ["Bez pola stężeń"].concat(mainWindow.pollutantRaster.parameters)
+                            onActivated: mainWindow.pollutantRaster.parameter = currentIndex > 0 ? currentText : ""
+                        }
+
+                        ComboBox {
+                            visible: mainWindow.airQuality.enabled && rasterParameter.currentIndex > 0
+                            width: 150
+                            font.pixelSize: 12
+                            model: ["IDW", "Kriging"]
+                            currentIndex: mainWindow.pollutantRaster.method
+                            onActivated: mainWindow.pollutantRaster.method = currentIndex
+                        }
+
+                        Text {
+                            visible: mainWindow.airQuality.enabled && rasterParameter.currentIndex > 0
+                            text: mainWindow.pollutantRaster.busy ? "Obliczanie pola…"
+                                  : (mainWindow.pollutantRaster.sampleCount > 0
+                                     ? mainWindow.pollutantRaster.sampleCount + " stacji, " + mainWindow.pollutantRaster.hour
+                                     : "Brak pomiarów")
+                            font.pixelSize: 11
+                            color: "#666666"
+                        }
+                    }
+                }
             }
         }
     }
@@ -12,35 +12,135 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
-#include <QNetworkRequest>
 #include <QUrlQuery>
 #include <QDebug>
 #include <QFile>
 #include <QDateTime>
 #include <QDir>
+#include <QSet>
+#include <memory>
+#include <utility>
+
+namespace {
+/// Katalog zapisanych plików archiwalnych stacji.
+const QString kArchiveDirectory = QStringLiteral("C:/Users/max08/OneDrive/Pulpit/AirAPI/build/Desktop_Qt_6_8_3_MinGW_64_bit-Release");
+
+/// Grupa żądań dotyczących otwartej stacji; unieważniana przy wyborze innej stacji.
+const QString kStationRequests = QStringLiteral("station");
+
+/// Grupa żądań geokodowania; unieważniana przy kolejnym wyszukiwaniu.
+const QString kGeocodeRequests = QStringLiteral("geocode");
+
+/// Czas w ms, po którym zebrane szeregi trafiają do widoku mimo trwających żądań.
+constexpr int kSeriesFlushDeadlineMs = 1500;
+
+/// Odstęp w ms między powiadomieniami o zmianie metryk.
+constexpr int kMetricsRefreshMs = 2000;
+
+/// Odstęp w ms między zapisami metryk do pliku GIOS_METRICS_FILE.
+constexpr int kMetricsDumpMs = 60000;
+
+/// Histogram czasów budowy modeli i indeksów w wątku GUI.
+const QString kModelBuildMetric = QStringLiteral("gios_model_build_duration_ms");
+}
 
 /**
  * @brief Konstruktor obiektu MainWindow.
  * @param parent Rodzic QObject.
  *
- * Inicjalizuje centrum mapy na Poznań, ustawia domyślny komunikat statusu
- * i pobiera wszystkie stacje z API.
+ * Inicjalizuje centrum mapy na Poznań, ustawia domyślny komunikat statusu,
+ * synchronicznie wczytuje katalog stacji z migawki (mapa jest wypełniona przed pierwszą klatką)
+ * i odświeża katalog z API.
  */
 MainWindow::MainWindow(QObject *parent)
     : QObject(parent),
     m_mapCenter(52.4064, 16.9252), // Domyślnie Poznań
+    m_allStations(new StationListModel(this)),
+    m_stations(new StationViewModel(m_allStations, this)),
+    m_stationClusters(new StationClusterModel(m_allStations, this)),
+    m_sensorSeries(new SensorSeriesStore(this)),
     m_status("Wprowadź nazwę miasta i kliknij Szukaj"),
-    m_networkManager(new QNetworkAccessManager(this))
-{
-    // Pobierz wszystkie stacje przy starcie
-    QNetworkRequest request(QUrl("https://api.gios.gov.pl/pjp-api/rest/station/findAll"));
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    QNetworkReply *reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-        onStationsReply(reply);
+    m_archiveManifest(new ArchiveManifest(kArchiveDirectory, this)),
+    m_apiClient(new ApiClient(this)),
+    m_parser(new ReplyParser(this)),
+    m_backgroundParser(new ReplyParser(this)),
+    m_history(QDir(kArchiveDirectory).filePath("history")),
+    m_monitor(new StationMonitor(m_apiClient, m_backgroundParser, &m_history, m_sensorSeries, QString(), this)),
+    m_airQuality(new AirQualityIndex(m_apiClient, m_backgroundParser, this)),
+    m_pollutantRaster(new PollutantRasterEngine(m_airQuality, m_allStations, this)),
+    m_comparison(new StationComparison(m_apiClient, m_backgroundParser, &m_history, m_allStations, this))
+{
+    m_startupTimer.start();
+
+    m_seriesFlushTimer.setSingleShot(true);
+    m_seriesFlushTimer.setInterval(kSeriesFlushDeadlineMs);
+    connect(&m_seriesFlushTimer, &QTimer::timeout, this, &MainWindow::flushPendingSeries);
+
+    // Emisje sygnałów obiektów widocznych w QML trafiają do metryk
+    m_stations->setObjectName("stations");
+    m_allStations->setObjectName("allStations");
+    m_stationClusters->setObjectName("stationClusters");
+    m_parser->setObjectName("parser");
+    m_backgroundParser->setObjectName("backgroundParser");
+    const QList<QObject*> observed = { this, m_stations, m_allStations, m_stationClusters, m_sensorSeries, m_parser,
+                                       m_backgroundParser, m_monitor, m_airQuality, m_pollutantRaster, m_comparison };
+    for (QObject *object : observed)
+        new SignalCounter(object);
+
+    m_metricsTimer.setInterval(kMetricsRefreshMs);
+    connect(&m_metricsTimer, &QTimer::timeout, this, [this]() {
+        if (MetricsRegistry::instance().revision() == m_metricsRevision)
+            return;
+        emit metricsChanged();
+        // Sama emisja jest liczona, więc wersję odczytujemy po niej
+        m_metricsRevision = MetricsRegistry::instance().revision();
     });
+    m_metricsTimer.start();
+
+    m_metricsFile = qEnvironmentVariable("GIOS_METRICS_FILE");
+    if (!m_metricsFile.isEmpty()) {
+        m_metricsDumpTimer.setInterval(kMetricsDumpMs);
+        connect(&m_metricsDumpTimer, &QTimer::timeout, this, [this]() {
+            dumpMetrics(m_metricsFile);
+        });
+        m_metricsDumpTimer.start();
+    }
 
-    // Załaduj zapisane dane archiwalne
+    // Wyniki parsowania w wątkach roboczych wracają do wątku GUI połączeniami kolejkowanymi
+    connect(m_parser, &ReplyParser::stationsStreamed, this, &MainWindow::onStationsStreamed);
+    connect(m_parser, &ReplyParser::stationsParsed, this, &MainWindow::onStationsParsed);
+    connect(m_parser, &ReplyParser::sensorsParsed, this, &MainWindow::onSensorsParsed);
+    connect(m_parser, &ReplyParser::sensorDataParsed, this, &MainWindow::onSensorDataParsed);
+
+    // Pomiary odświeżone przez monitor trafiają też do indeksu jakości powietrza
+    m_stationClusters->setAirQuality(m_airQuality);
+    connect(m_monitor, &StationMonitor::sensorUpdated, this, [this](int, int sensorId) {
+        const qint64 last = m_history.lastTimestamp(sensorId);
+        m_airQuality->updateSensor(sensorId, m_history.query(sensorId, last - qint64(AirQualityIndex::kMaxReadingAgeHours) * 3600, last));
+    });
+    connect(m_parser, &ReplyParser::archiveLoaded, this, &MainWindow::onArchiveLoaded);
+
+    // Wczytaj katalog stacji zapisany przy poprzednim uruchomieniu
+    loadStationSnapshot();
+
+    // Pobierz wszystkie stacje przy starcie (z pamięci podręcznej, jeśli jest aktualna);
+    // treść jest parsowana fragmentami w miarę pobierania
+    const auto streamId = std::make_shared<quint64>(0);
+    m_apiClient->getStreamed(QUrl(ApiClient::giosApiUrl() + "/station/findAll"), this,
+        [this, streamId](const QByteArray &chunk) {
+            if (*streamId == 0)
+                *streamId = m_parser->beginStations();
+            m_parser->feed(*streamId, chunk);
+        },
+        [this, streamId](const ApiResponse &response) {
+            if (*streamId == 0)
+                *streamId = m_parser->beginStations();
+            onStationsReply(response, std::exchange(*streamId, 0));
+        });
+
+    // Załaduj indeks danych archiwalnych (parsowane są tylko pliki zmienione od ostatniego uruchomienia)
+    connect(m_archiveManifest, &ArchiveManifest::entriesChanged, this, &MainWindow::loadArchivedStations);
+    m_archiveManifest->load();
     loadArchivedStations();
 }
 
@@ -48,10 +148,35 @@ MainWindow::MainWindow(QObject *parent)
  * @brief Wyszukuje stacje w podanym mieście.
  * @param city Nazwa miasta do wyszukania.
  *
- * Wysyła żądanie do API Nominatim w celu geokodowania miasta i aktualizuje centrum mapy.
+ * Jeśli miasto występuje w katalogu stacji, wynik jest wyznaczany lokalnie z indeksu tekstowego.
+ * W przeciwnym razie wysyła żądanie do API Nominatim w celu geokodowania miasta i aktualizuje centrum mapy.
+ * Trwające geokodowanie poprzedniego wyszukiwania jest unieważniane w obu przypadkach.
  */
 void MainWindow::searchCity(const QString &city)
 {
+    // Wynik wcześniejszego wyszukiwania nie może nadpisać bieżącego, także lokalnego
+    m_apiClient->scheduler()->cancelGroup(kGeocodeRequests);
+
+    // Miasto obecne w katalogu stacji rozwiązujemy lokalnie, bez zapytania do Nominatim
+    const QList<int> localMatches = m_searchIndex.stationsInCity(city);
+    if (!localMatches.isEmpty()) {
+        showSearchResults(localMatches);
+
+        double latSum = 0.0;
+        double lonSum = 0.0;
+        for (int row = 0; row < m_stations->count(); ++row) {
+            const int catalogRow = m_stations->catalogRow(row);
+            latSum += m_allStations->lat(catalogRow);
+            lonSum += m_allStations->lon(catalogRow);
+        }
+        m_mapCenter = QGeoCoordinate(latSum / m_stations->count(), lonSum / m_stations->count());
+        emit mapCenterChanged();
+
+        m_status = QString("Znaleziono %1 stacji w %2.").arg(m_stations->count()).arg(m_allStations->cityName(m_stations->catalogRow(0)));
+        emit statusChanged();
+        return;
+    }
+
     m_status = "Wyszukiwanie: " + city + "...";
     emit statusChanged();
 
@@ -60,49 +185,396 @@ void MainWindow::searchCity(const QString &city)
     query.addQueryItem("format", "json");
     query.addQueryItem("limit", "1");
 
-    QUrl url("https://nominatim.openstreetmap.org/search");
+    QUrl url(ApiClient::geocoderUrl());
     url.setQuery(query);
 
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::UserAgentHeader, "ControlStationsApp/1.0");
-    QNetworkReply *reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [this, reply, city]() {
-        onGeocodeReply(reply, city);
-    });
+    RequestOptions options;
+    options.group = kGeocodeRequests;
+    m_apiClient->get(url, this, [this, city](const ApiResponse &response) {
+        onGeocodeReply(response, city);
+    }, options);
 }
 
 /**
  * @brief Pobiera sensory dla stacji.
  * @param stationId Identyfikator stacji.
  *
- * Wysyła żądanie do API GIOŚ w celu pobrania sensorów dla danej stacji.
+ * Wysyła żądanie do API GIOŚ w celu pobrania sensorów dla danej stacji. Żądania dotyczące
+ * poprzednio otwartej stacji (lista sensorów i pomiary) są unieważniane: trwające są
+ * przerywane, a wyniki już pobrane pomijane. Lista pomiarów w toku jest czyszczona, więc
+ * odpowiedź poprzedniej stacji, której parsowanie jeszcze trwa, nie blokuje nowego żądania
+ * tego samego sensora.
  */
 void MainWindow::fetchSensors(int stationId)
 {
-    QUrl url(QString("https://api.gios.gov.pl/pjp-api/rest/station/sensors/%1").arg(stationId));
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    QNetworkReply *reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-        onSensorsReply(reply);
-    });
+    m_apiClient->scheduler()->cancelGroup(kStationRequests);
+    ++m_sensorsRequestId;
+    m_sensorDataInFlight.clear();
+    m_sensorsStationId = stationId;
+
+    RequestOptions options;
+    options.group = kStationRequests;
+    QUrl url(ApiClient::giosApiUrl() + QString("/station/sensors/%1").arg(stationId));
+    m_apiClient->get(url, this, [this](const ApiResponse &response) {
+        onSensorsReply(response);
+    }, options);
 }
 
 /**
  * @brief Pobiera dane dla sensora.
  * @param sensorId Identyfikator sensora.
  *
- * Wysyła żądanie do API GIOŚ w celu pobrania danych dla określonego sensora.
+ * Żądanie ma priorytet Visible (dane wybrane przez użytkownika).
  */
 void MainWindow::fetchSensorData(int sensorId)
 {
-    QUrl url(QString("https://api.gios.gov.pl/pjp-api/rest/data/getData/%1").arg(sensorId));
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    QNetworkReply *reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [this, reply, sensorId]() {
-        onSensorDataReply(reply, sensorId);
-    });
+    requestSensorData(sensorId, RequestPriority::Visible);
+}
+
+/**
+ * @brief Pobiera listę sensorów stacji i pomiary wszystkich jej sensorów.
+ * @param stationId Identyfikator stacji.
+ *
+ * Pomiary pobierane są z priorytetem Prefetch w onSensorsParsed() po odczytaniu listy
+ * sensorów; widok dostaje jedną zmianę po zakończeniu wszystkich żądań lub po upływie
+ * kSeriesFlushDeadlineMs.
+ */
+void MainWindow::fetchStationData(int stationId)
+{
+    fetchSensors(stationId);
+    m_stationDataRequestId = m_sensorsRequestId;
+}
+
+/**
+ * @brief Wysyła żądanie pomiarów sensora.
+ * @param sensorId Identyfikator sensora.
+ * @param priority Priorytet żądania.
+ *
+ * Żądanie dla sensora, który jest już pobierany albo którego szereg czeka na wspólną zmianę
+ * magazynu, jest pomijane; wszystkie wywołania korzystają z jednej odpowiedzi. Limit równoległych żądań i częstość zapytań do GIOŚ
+ * pilnuje RequestScheduler. Pomiary odczytywane są fragmentami w miarę pobierania.
+ */
+void MainWindow::requestSensorData(int sensorId, RequestPriority priority)
+{
+    if (m_sensorDataInFlight.contains(sensorId) || m_pendingSeries.contains(sensorId))
+        return;
+
+    if (m_sensorDataInFlight.isEmpty())
+        m_seriesFlushTimer.start();
+    m_sensorDataInFlight.insert(sensorId);
+
+    RequestOptions options;
+    options.priority = priority;
+    options.group = kStationRequests;
+    const quint64 requestId = m_sensorsRequestId;
+    QUrl url(ApiClient::giosApiUrl() + QString("/data/getData/%1").arg(sensorId));
+    const auto streamId = std::make_shared<quint64>(0);
+    m_apiClient->getStreamed(url, this,
+        [this, streamId, sensorId, requestId](const QByteArray &chunk) {
+            if (*streamId == 0)
+                *streamId = m_parser->beginSensorData(sensorId, requestId);
+            m_parser->feed(*streamId, chunk);
+        },
+        [this, streamId, sensorId, requestId](const ApiResponse &response) {
+            if (*streamId == 0)
+                *streamId = m_parser->beginSensorData(sensorId, requestId);
+            onSensorDataReply(response, requestId, sensorId, std::exchange(*streamId, 0));
+        }, options);
+}
+
+/**
+ * @brief Kończy żądanie pomiarów sensora.
+ * @param requestId Numer żądania listy sensorów, do którego należy żądanie pomiarów.
+ * @param sensorId Identyfikator sensora.
+ *
+ * Gdy nie trwa już żadne żądanie, zebrane szeregi trafiają od razu do magazynu. Żądanie
+ * poprzednio otwartej stacji nie zwalnia sensora, bo jego wpis mógł już założyć nowszy
+ * odczyt tego samego sensora.
+ */
+void MainWindow::finishSensorData(quint64 requestId, int sensorId)
+{
+    if (requestId != m_sensorsRequestId)
+        return;
+    m_sensorDataInFlight.remove(sensorId);
+    if (m_sensorDataInFlight.isEmpty())
+        flushPendingSeries();
+}
+
+/**
+ * @brief Przekazuje zebrane szeregi do magazynu jedną zmianą.
+ *
+ * Wywoływane po zakończeniu wszystkich żądań albo po upływie terminu; w tym drugim
+ * przypadku termin jest odliczany ponownie dla pozostałych żądań.
+ */
+void MainWindow::flushPendingSeries()
+{
+    if (m_sensorDataInFlight.isEmpty())
+        m_seriesFlushTimer.stop();
+    else
+        m_seriesFlushTimer.start();
+
+    if (!m_pendingSeries.isEmpty()) {
+        MetricsTimer timer(kModelBuildMetric, "model=series");
+        m_sensorSeries->setSeriesBatch(std::exchange(m_pendingSeries, {}));
+    }
+}
+
+/**
+ * @brief Pobiera migawkę metryk czasu działania dla panelu diagnostycznego.
+ * @return Migawka rejestru z udziałem trafień pamięci podręcznej i czasem wypełnienia katalogu.
+ */
+QVariantMap MainWindow::metrics() const
+{
+    const MetricsRegistry &registry = MetricsRegistry::instance();
+    QVariantMap result = registry.toVariant();
+
+    QVariantMap hitRates;
+    for (const char *endpoint : { "findAll", "sensors", "getData" }) {
+        const QString labels = QString("endpoint=%1,result=").arg(endpoint);
+        const qint64 fresh = registry.counter("gios_http_cache_lookups_total", labels + "fresh");
+        const qint64 total = fresh + registry.counter("gios_http_cache_lookups_total", labels + "stale")
+                             + registry.counter("gios_http_cache_lookups_total", labels + "miss");
+        if (total > 0)
+            hitRates[endpoint] = double(fresh) / total;
+    }
+    result["cacheHitRates"] = hitRates;
+    result["catalogReadyMs"] = m_catalogReadyMs;
+    return result;
+}
+
+/**
+ * @brief Zapisuje metryki w formacie tekstowym Prometheus.
+ * @param path Ścieżka pliku.
+ * @return True, jeśli zapis się powiódł.
+ */
+bool MainWindow::dumpMetrics(const QString &path) const
+{
+    return MetricsRegistry::instance().writePrometheus(path);
+}
+
+/**
+ * @brief Wyszukuje k najbliższych stacji.
+ * @param lat Szerokość geograficzna punktu.
+ * @param lon Długość geograficzna punktu.
+ * @param k Maksymalna liczba stacji.
+ * @return Lista stacji posortowana według odległości.
+ */
+QVariantList MainWindow::nearestStations(double lat, double lon, int k) const
+{
+    return stationDistancesToVariant(m_spatialIndex.nearest(lat, lon, k));
+}
+
+/**
+ * @brief Wyszukuje stacje w zadanym promieniu.
+ * @param lat Szerokość geograficzna punktu.
+ * @param lon Długość geograficzna punktu.
+ * @param radiusKm Promień w kilometrach.
+ * @return Lista stacji posortowana według odległości.
+ */
+QVariantList MainWindow::stationsWithin(double lat, double lon, double radiusKm) const
+{
+    return stationDistancesToVariant(m_spatialIndex.within(lat, lon, radiusKm));
+}
+
+/**
+ * @brief Zamienia wyniki zapytania przestrzennego na listę dla QML.
+ * @param distances Wyniki zapytania przestrzennego.
+ * @return Lista map z danymi stacji i odległością.
+ */
+QVariantList MainWindow::stationDistancesToVariant(const QList<StationDistance> &distances) const
+{
+    QVariantList result;
+    result.reserve(distances.size());
+    for (const StationDistance &entry : distances) {
+        const int row = m_allStations->rowOf(entry.stationId);
+        if (row < 0)
+            continue;
+
+        QVariantMap stationInfo;
+        stationInfo["stationId"] = entry.stationId;
+        stationInfo["stationName"] = m_allStations->stationName(row);
+        stationInfo["cityName"] = m_allStations->cityName(row);
+        stationInfo["address"] = m_allStations->address(row);
+        stationInfo["lat"] = m_allStations->lat(row);
+        stationInfo["lon"] = m_allStations->lon(row);
+        stationInfo["distanceKm"] = entry.distanceKm;
+        result.append(stationInfo);
+    }
+    return result;
+}
+
+/**
+ * @brief Wczytuje katalog stacji z binarnej migawki.
+ *
+ * Wywoływane synchronicznie w konstruktorze, zanim silnik QML utworzy pierwszą klatkę.
+ */
+void MainWindow::loadStationSnapshot()
+{
+    QList<StationRecord> records;
+    if (!StationSnapshot::load(StationSnapshot::defaultPath(), records) || records.isEmpty())
+        return;
+
+    applyStationCatalog(records);
+    reportCatalogReady("migawka");
+}
+
+/**
+ * @brief Porównuje nowy katalog stacji z bieżącym i nanosi tylko różnice.
+ * @param records Rekordy katalogu.
+ * @return True, jeśli katalog się zmienił.
+ *
+ * Nowe stacje są dopisywane, zmienione zastępowane w swoim wierszu (z zachowaniem statusu wyszukiwania),
+ * a usunięte usuwane z katalogu w jednym przebiegu. Pusty model wypełniany jest jednym resetem.
+ */
+bool MainWindow::applyStationCatalog(const QList<StationRecord> &records)
+{
+    MetricsTimer timer(kModelBuildMetric, "model=catalog");
+    if (m_allStations->count() == 0) {
+        if (records.isEmpty())
+            return false;
+
+        m_allStations->setRecords(records);
+        rebuildStationIndexes();
+        return true;
+    }
+
+    QSet<int> freshIds;
+    freshIds.reserve(records.size());
+    for (const StationRecord &record : records)
+        freshIds.insert(record.stationId);
+
+    int changed = 0;
+    int added = 0;
+
+    QList<int> staleIds;
+    for (int row = 0; row < m_allStations->count(); ++row) {
+        const int stationId = m_allStations->stationId(row);
+        if (!freshIds.contains(stationId))
+            staleIds.append(stationId);
+    }
+    const int removed = m_allStations->removeStations(staleIds);
+
+    for (const StationRecord &record : records) {
+        const int row = m_allStations->rowOf(record.stationId);
+        if (row < 0) {
+            m_allStations->appendRecord(record);
+            ++added;
+        } else if (m_allStations->record(row) != record) {
+            m_allStations->replaceRecord(record);
+            ++changed;
+        }
+    }
+
+    if (removed == 0 && changed == 0 && added == 0)
+        return false;
+
+    qInfo() << "Katalog stacji zaktualizowany: dodano" << added << "zmieniono" << changed << "usunięto" << removed;
+    rebuildStationIndexes();
+    return true;
+}
+
+/**
+ * @brief Zapisuje w dzienniku czas od uruchomienia do wypełnienia katalogu stacji.
+ * @param source Źródło katalogu (migawka lub sieć).
+ *
+ * Pomiar wykonywany jest tylko raz, przy pierwszym wypełnieniu katalogu.
+ */
+void MainWindow::reportCatalogReady(const QString &source)
+{
+    if (m_catalogReadyMs >= 0)
+        return;
+
+    m_catalogReadyMs = m_startupTimer.elapsed();
+    MetricsRegistry::instance().observe("gios_startup_catalog_ready_ms", "source=" + source, m_catalogReadyMs);
+    qInfo().noquote() << QString("Katalog stacji gotowy po %1 ms (%2 stacji, źródło: %3)")
+                             .arg(m_catalogReadyMs).arg(m_allStations->count()).arg(source);
+}
+
+/**
+ * @brief Odbudowuje indeksy katalogu stacji po jego zmianie.
+ *
+ * Wywoływane jednorazowo po załadowaniu katalogu, dzięki czemu zapytania
+ * nie muszą przeglądać wszystkich stacji. Indeks jakości powietrza dostaje nową listę stacji.
+ */
+void MainWindow::rebuildStationIndexes()
+{
+    MetricsTimer timer(kModelBuildMetric, "model=station_indexes");
+    QList<StationSpatialIndex::Point> points;
+    points.reserve(m_allStations->count());
+    for (int row = 0; row < m_allStations->count(); ++row)
+        points.append({ m_allStations->stationId(row), m_allStations->lat(row), m_allStations->lon(row) });
+    m_spatialIndex.build(points);
+
+    QList<StationSearchIndex::Record> records;
+    records.reserve(m_allStations->count());
+    for (int row = 0; row < m_allStations->count(); ++row)
+        records.append({ m_allStations->stationId(row), m_allStations->stationName(row),
+                         m_allStations->cityName(row), m_allStations->address(row) });
+    m_searchIndex.build(records);
+
+    QList<int> stationIds;
+    stationIds.reserve(m_allStations->count());
+    for (int row = 0; row < m_allStations->count(); ++row)
+        stationIds.append(m_allStations->stationId(row));
+    m_airQuality->setStations(stationIds);
+}
+
+/**
+ * @brief Zwraca podpowiedzi dla pola wyszukiwania.
+ * @param prefix Wpisany tekst.
+ * @param limit Maksymalna liczba podpowiedzi.
+ * @return Lista podpowiedzi z indeksu katalogu stacji.
+ */
+QVariantList MainWindow::suggest(const QString &prefix, int limit) const
+{
+    return m_searchIndex.suggest(prefix, limit);
+}
+
+/**
+ * @brief Wczytuje do magazynu szeregów pomiary sensora z historii.
+ * @param sensorId Identyfikator sensora.
+ * @param fromDate Początek przedziału ("yyyy-MM-dd HH:mm:ss" lub ISO 8601).
+ * @param toDate Koniec przedziału ("yyyy-MM-dd HH:mm:ss" lub ISO 8601).
+ * @return Liczba wczytanych pomiarów lub -1 dla nieprawidłowej daty.
+ *
+ * Odczytywane są wyłącznie segmenty miesięcy z zadanego przedziału.
+ */
+int MainWindow::loadSensorHistory(int sensorId, const QString &fromDate, const QString &toDate)
+{
+    bool fromOk = false;
+    bool toOk = false;
+    const qint64 from = SensorSeries::parseTimestamp(fromDate, &fromOk);
+    const qint64 to = SensorSeries::parseTimestamp(toDate, &toOk);
+    if (!fromOk || !toOk) {
+        m_status = "Błąd: Nieprawidłowy zakres dat historii.";
+        emit statusChanged();
+        return -1;
+    }
+
+    const SensorSeries series = m_history.query(sensorId, from, to);
+    m_sensorSeries->setSeries(sensorId, series);
+
+    m_status = QString("Wczytano %1 pomiarów z historii sensora %2.").arg(series.size()).arg(sensorId);
+    emit statusChanged();
+    return series.size();
+}
+
+/**
+ * @brief Wypełnia listę wyszukanych stacji i oznacza je na mapie.
+ * @param stationIds Identyfikatory znalezionych stacji.
+ *
+ * Poprzednie wyniki są usuwane, a flaga isSearched jest resetowana tylko dla stacji, które ją miały.
+ */
+void MainWindow::showSearchResults(const QList<int> &stationIds)
+{
+    MetricsTimer timer(kModelBuildMetric, "model=search_results");
+    // Resetuj flagę isSearched tylko dla stacji, które były wyszukane
+    m_allStations->clearSearched();
+    // Lista wyników to widok identyfikatorów w katalogu, bez kopiowania stacji
+    m_stations->setStationIds(stationIds);
+
+    for (int stationId : m_stations->stationIds())
+        updateStationSearchStatus(stationId, true);
 }
 
 /**
@@ -110,16 +582,12 @@ void MainWindow::fetchSensorData(int sensorId)
  * @param stationId Identyfikator stacji.
  * @param isSearched Nowy status wyszukiwania.
  *
- * Aktualizuje właściwość isSearched dla określonej stacji.
+ * Ustawia bit isSearched określonej stacji w katalogu. Model emituje
+ * dataChanged tylko dla wiersza tej stacji i tylko wtedy, gdy status faktycznie się zmienił.
  */
 void MainWindow::updateStationSearchStatus(int stationId, bool isSearched)
 {
-    for (Station *station : m_allStations) {
-        if (station->stationId() == stationId) {
-            station->setIsSearched(isSearched);
-        }
-    }
-    emit allStationsChanged();
+    m_allStations->setSearched(stationId, isSearched);
 }
 
 /**
@@ -130,8 +598,8 @@ void MainWindow::updateStationSearchStatus(int stationId, bool isSearched)
  */
 void MainWindow::removeSensorData(int sensorId)
 {
-    m_sensorData.remove(QString::number(sensorId));
-    emit sensorDataChanged();
+    m_pendingSeries.remove(sensorId);
+    m_sensorSeries->remove(sensorId);
 }
 
 /**
@@ -140,131 +608,100 @@ void MainWindow::removeSensorData(int sensorId)
  * @param cityName Nazwa miasta.
  * @param address Adres stacji.
  *
- * Zapisuje dane stacji i sensorów do pliku JSON.
+ * Zapisuje dane stacji i sensorów w zwartym formacie binarnym (.gar) albo,
+ * gdy wyłączono compactArchive, w formacie JSON. Pomiary nowsze niż zapisane w historii
+ * oraz poprawione wartości są dopisywane do historii sensorów.
  */
 void MainWindow::saveStationData(int stationId, const QString &cityName, const QString &address)
 {
     // Znajdź stację w liście wszystkich stacji
-    Station *station = nullptr;
-    for (Station *s : m_allStations) {
-        if (s->stationId() == stationId) {
-            station = s;
-            break;
-        }
-    }
+    const int row = m_allStations->rowOf(stationId);
 
-    if (!station) {
+    if (row < 0) {
         m_status = "Błąd: Stacja o ID " + QString::number(stationId) + " nie znaleziona.";
         emit statusChanged();
         return;
     }
 
-    // Utwórz obiekt JSON
-    QJsonObject jsonObj;
-    jsonObj["stationId"] = stationId;
-    jsonObj["stationName"] = station->stationName();
-    jsonObj["cityName"] = cityName;
-    jsonObj["address"] = address;
-    jsonObj["latitude"] = station->lat();
-    jsonObj["longitude"] = station->lon();
-    jsonObj["saveDate"] = QDateTime::currentDateTime().toString(Qt::ISODate);
-
-    // Dodaj dane sensorów
-    QJsonArray sensorsArray;
+    const QDateTime now = QDateTime::currentDateTime();
+    StationArchiveData data;
+    data.stationId = stationId;
+    data.stationName = m_allStations->stationName(row);
+    data.cityName = cityName;
+    data.address = address;
+    data.lat = m_allStations->lat(row);
+    data.lon = m_allStations->lon(row);
+    data.saveDate = now.toString(Qt::ISODate);
+
+    // Dodaj dane sensorów i dopisz do historii tylko nowe lub poprawione pomiary
+    HistoryMergeResult history;
     for (const QVariant &sensorVariant : m_sensors) {
         QVariantMap sensorInfo = sensorVariant.toMap();
-        int sensorId = sensorInfo["sensorId"].toInt();
-        QString paramName = sensorInfo["paramName"].toString();
-
-        QJsonObject sensorObj;
-        sensorObj["sensorId"] = sensorId;
-        sensorObj["paramName"] = paramName;
-
-        // Dodaj pomiary
-        QVariantList data = m_sensorData[QString::number(sensorId)].toList();
-        QJsonArray measurementsArray;
-        for (const QVariant &dataPoint : data) {
-            QVariantMap dataMap = dataPoint.toMap();
-            QJsonObject measurementObj;
-            measurementObj["date"] = dataMap["date"].toString();
-            measurementObj["value"] = dataMap["value"].toDouble();
-            measurementsArray.append(measurementObj);
+        ArchivedSensor sensor;
+        sensor.sensorId = sensorInfo["sensorId"].toInt();
+        sensor.paramName = sensorInfo["paramName"].toString();
+        sensor.paramCode = sensorInfo["paramCode"].toString();
+        if (const SensorSeries *series = m_sensorSeries->series(sensor.sensorId)) {
+            sensor.series = *series;
+            const HistoryMergeResult merged = m_history.merge(sensor.sensorId, *series);
+            history.appended += merged.appended;
+            history.corrected += merged.corrected;
+            history.unchanged += merged.unchanged;
         }
-        sensorObj["measurements"] = measurementsArray;
-        sensorsArray.append(sensorObj);
+        data.sensors.append(sensor);
     }
-    jsonObj["sensors"] = sensorsArray;
-
-    // Utwórz dokument JSON
-    QJsonDocument jsonDoc(jsonObj);
 
     // Wygeneruj nazwę pliku na podstawie ID stacji i znacznika czasu
-    QString timestamp = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
-    QString filename = QString("station_%1_%2.json").arg(stationId).arg(timestamp);
+    QString filename = StationArchive::fileName(stationId, now, m_compactArchive);
 
     // Określ ścieżkę katalogu
-    QDir dir("C:/Users/max08/OneDrive/Pulpit/AirAPI/build/Desktop_Qt_6_8_3_MinGW_64_bit-Release");
+    QDir dir(kArchiveDirectory);
     if (!dir.exists()) {
         dir.mkpath(".");
     }
     QString filepath = dir.filePath(filename);
 
     // Zapisz do pliku
-    QFile file(filepath);
-    if (!file.open(QIODevice::WriteOnly)) {
-        m_status = "Błąd: Nie można otworzyć pliku do zapisu: " + filepath;
+    if (!StationArchive::save(filepath, data)) {
+        m_status = "Błąd: Nie można zapisać pliku: " + filepath;
         emit statusChanged();
         return;
     }
 
-    file.write(jsonDoc.toJson(QJsonDocument::Indented));
-    file.close();
-
-    m_status = "Dane zapisano do pliku: " + filepath;
+    m_status = QString("Dane zapisano do pliku: %1 (historia: %2 nowych, %3 poprawionych pomiarów).")
+                   .arg(filepath).arg(history.appended).arg(history.corrected);
     emit statusChanged();
 
-    // Odśwież listę zapisanych stacji
-    loadArchivedStations();
+    // Dopisz plik do indeksu archiwum (odświeża listę zapisanych stacji)
+    ArchiveEntry entry;
+    entry.fileName = filename;
+    entry.stationId = stationId;
+    entry.cityName = cityName;
+    entry.address = address;
+    entry.saveDate = data.saveDate;
+    m_archiveManifest->insert(entry);
 }
 
 /**
- * @brief Ładuje listę zapisanych plików JSON.
+ * @brief Włącza lub wyłącza zapis w zwartym formacie binarnym.
+ * @param compact True dla formatu .gar, false dla JSON.
+ */
+void MainWindow::setCompactArchive(bool compact)
+{
+    if (m_compactArchive == compact)
+        return;
+    m_compactArchive = compact;
+    emit compactArchiveChanged();
+}
+
+/**
+ * @brief Odświeża listę zapisanych stacji z indeksu archiwum.
  *
- * Wyszukuje pliki JSON w określonym katalogu i ładuje ich metadane do listy zapisanych stacji.
+ * Lista budowana jest z nagłówków przechowywanych w indeksie, bez otwierania plików JSON.
  */
 void MainWindow::loadArchivedStations()
 {
-    m_archivedStations.clear();
-
-    QDir dir("C:/Users/max08/OneDrive/Pulpit/AirAPI/build/Desktop_Qt_6_8_3_MinGW_64_bit-Release");
-    dir.setFilter(QDir::Files | QDir::NoDotAndDotDot);
-    dir.setNameFilters(QStringList() << "station_*.json");
-
-    QFileInfoList fileList = dir.entryInfoList();
-    for (const QFileInfo &fileInfo : fileList) {
-        QFile file(fileInfo.absoluteFilePath());
-        if (!file.open(QIODevice::ReadOnly)) {
-            qDebug() << "Nie można otworzyć pliku:" << fileInfo.absoluteFilePath();
-            continue;
-        }
-
-        QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
-        file.close();
-
-        if (doc.isNull() || !doc.isObject()) {
-            qDebug() << "Nieprawidłowy format JSON w pliku:" << fileInfo.absoluteFilePath();
-            continue;
-        }
-
-        QJsonObject jsonObj = doc.object();
-        QVariantMap stationData;
-        stationData["stationId"] = jsonObj["stationId"].toInt();
-        stationData["cityName"] = jsonObj["cityName"].toString();
-        stationData["address"] = jsonObj["address"].toString();
-        stationData["saveDate"] = jsonObj["saveDate"].toString();
-        m_archivedStations.append(stationData);
-    }
-
+    m_archivedStations = m_archiveManifest->toVariantList();
     emit archivedStationsChanged();
 }
 
@@ -273,112 +710,100 @@ void MainWindow::loadArchivedStations()
  * @param stationId Identyfikator stacji.
  * @param saveDate Data zapisu.
  *
- * Wyszukuje i ładuje dane stacji z pliku JSON na podstawie identyfikatora i daty zapisu.
+ * Wyszukuje plik w indeksie archiwum na podstawie identyfikatora i daty zapisu i zleca jego wczytanie
+ * w wątku roboczym (format JSON lub binarny rozpoznawany po rozszerzeniu).
  */
 void MainWindow::loadArchivedStationData(int stationId, const QString &saveDate)
 {
-    QDir dir("C:/Users/max08/OneDrive/Pulpit/AirAPI/build/Desktop_Qt_6_8_3_MinGW_64_bit-Release");
-    dir.setFilter(QDir::Files | QDir::NoDotAndDotDot);
-    dir.setNameFilters(QStringList() << QString("station_%1_*.json").arg(stationId));
+    const QString filepath = m_archiveManifest->filePath(stationId, saveDate);
+    if (filepath.isEmpty()) {
+        m_status = QString("Błąd: Brak zapisu stacji %1 z datą %2.").arg(stationId).arg(saveDate);
+        emit statusChanged();
+        return;
+    }
 
-    QFileInfoList fileList = dir.entryInfoList();
-    for (const QFileInfo &fileInfo : fileList) {
-        QFile file(fileInfo.absoluteFilePath());
-        if (!file.open(QIODevice::ReadOnly)) {
-            m_status = "Błąd: Nie można otworzyć pliku: " + fileInfo.absoluteFilePath();
-            emit statusChanged();
-            continue;
-        }
+    m_parser->loadArchive(filepath, ++m_archiveRequestId);
+}
 
-        QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
-        file.close();
+/**
+ * @brief Nanosi wczytany w tle plik archiwalny.
+ * @param result Zawartość pliku.
+ *
+ * Wynik starszego żądania (użytkownik wybrał w międzyczasie inny zapis) jest pomijany.
+ */
+void MainWindow::onArchiveLoaded(ArchiveLoadResult result)
+{
+    if (result.requestId != m_archiveRequestId)
+        return;
 
-        if (doc.isNull() || !doc.isObject()) {
-            m_status = "Błąd: Nieprawidłowy format JSON w pliku: " + fileInfo.absoluteFilePath();
-            emit statusChanged();
-            continue;
-        }
+    if (!result.ok) {
+        m_status = "Błąd: Nie można wczytać pliku: " + result.path;
+        emit statusChanged();
+        return;
+    }
 
-        QJsonObject jsonObj = doc.object();
-        if (jsonObj["saveDate"].toString() != saveDate) {
-            continue;
-        }
+    MetricsTimer timer(kModelBuildMetric, "model=archive");
 
-        // Zaktualizuj centrum mapy
-        double lat = jsonObj["latitude"].toDouble();
-        double lon = jsonObj["longitude"].toDouble();
-        m_mapCenter = QGeoCoordinate(lat, lon);
+    // Zaktualizuj centrum mapy
+    m_mapCenter = QGeoCoordinate(result.data.lat, result.data.lon);
 
-        // Wyczyść istniejące sensory i dane sensorów
-        m_sensors.clear();
-        m_sensorData.clear();
-        emit sensorsChanged();
-        emit sensorDataChanged();
-
-        // Przygotuj nowe dane
-        QVariantList newSensors;
-        QVariantMap newSensorData;
-        QJsonArray sensorsArray = jsonObj["sensors"].toArray();
-        for (const QJsonValue &sensorValue : sensorsArray) {
-            QJsonObject sensorObj = sensorValue.toObject();
-            QVariantMap sensorInfo;
-            sensorInfo["sensorId"] = sensorObj["sensorId"].toInt();
-            sensorInfo["paramName"] = sensorObj["paramName"].toString();
-            newSensors.append(sensorInfo);
-
-            // Ładuj dane sensorów
-            QVariantList sensorDataList;
-            QJsonArray measurementsArray = sensorObj["measurements"].toArray();
-            for (const QJsonValue &measurementValue : measurementsArray) {
-                QJsonObject measurementObj = measurementValue.toObject();
-                QVariantMap dataPoint;
-                dataPoint["date"] = measurementObj["date"].toString();
-                dataPoint["value"] = measurementObj["value"].toDouble();
-                sensorDataList.append(dataPoint);
-            }
-            newSensorData[QString::number(sensorInfo["sensorId"].toInt())] = sensorDataList;
-        }
+    // Wyczyść istniejące sensory, dane sensorów i oczekujące pobrania
+    m_apiClient->scheduler()->cancelGroup(kStationRequests);
+    m_sensors.clear();
+    m_pendingSeries.clear();
+    m_sensorSeries->clear();
+    emit sensorsChanged();
 
-        // Zaktualizuj dane
-        m_sensors = newSensors;
-        m_sensorData = newSensorData;
+    // Przygotuj nowe dane
+    QVariantList newSensors;
+    for (ArchivedSensor &sensor : result.data.sensors) {
+        QVariantMap sensorInfo;
+        sensorInfo["sensorId"] = sensor.sensorId;
+        sensorInfo["paramName"] = sensor.paramName;
+        sensorInfo["paramCode"] = sensor.paramCode;
+        newSensors.append(sensorInfo);
+        m_sensorSeries->setExceedanceThreshold(sensor.sensorId, SensorStatistics::thresholdForParam(sensor.paramCode),
+                                               SensorStatistics::dayRuleForParam(sensor.paramCode));
+        m_sensorSeries->setSeries(sensor.sensorId, std::move(sensor.series));
+    }
 
-        // Emituj sygnały
-        emit mapCenterChanged();
-        emit sensorsChanged();
-        emit sensorDataChanged();
+    // Zaktualizuj dane
+    m_sensors = newSensors;
 
-        m_status = QString("Załadowano dane archiwalne dla stacji %1 z datą %2.").arg(stationId).arg(saveDate);
-        emit statusChanged();
+    // Emituj sygnały
+    emit mapCenterChanged();
+    emit sensorsChanged();
 
-        emit archivedDataLoaded();
-        break;
-    }
+    m_status = QString("Załadowano dane archiwalne dla stacji %1 z datą %2.").arg(result.data.stationId).arg(result.data.saveDate);
+    emit statusChanged();
+
+    emit archivedDataLoaded();
 }
 
 /**
  * @brief Obsługuje odpowiedź API geokodowania.
- * @param reply Odpowiedź sieciowa.
+ * @param response Odpowiedź API.
  * @param searchedCity Wyszukiwane miasto.
  *
  * Przetwarza odpowiedź z API Nominatim, aktualizuje centrum mapy i wyszukuje stacje.
  */
-void MainWindow::onGeocodeReply(QNetworkReply *reply, const QString &searchedCity)
+void MainWindow::onGeocodeReply(const ApiResponse &response, const QString &searchedCity)
 {
-    if (reply->error() != QNetworkReply::NoError) {
-        m_status = "Błąd wyszukiwania: " + reply->errorString();
+    if (response.cancelled)
+        return;
+
+    if (!response.ok()) {
+        m_status = "Błąd wyszukiwania: " + response.error;
         emit statusChanged();
-        reply->deleteLater();
         return;
     }
 
-    QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
+    QJsonDocument doc = QJsonDocument::fromJson(response.body);
     QJsonArray results = doc.array();
 
     if (results.isEmpty()) {
         m_status = "Nie znaleziono miasta.";
         emit statusChanged();
-        reply->deleteLater();
         return;
     }
 
@@ -389,181 +814,187 @@ void MainWindow::onGeocodeReply(QNetworkReply *reply, const QString &searchedCit
     m_mapCenter = QGeoCoordinate(lat, lon);
     emit mapCenterChanged();
 
-    // Wyczyść listę wyszukanych stacji
-    m_stations.clear();
-    // Resetuj flagę isSearched dla wszystkich stacji
-    for (Station *station : m_allStations) {
-        station->setIsSearched(false);
-    }
-
-    // Znajdź stacje w dokładnie wyszukanym mieście
-    QString normalizedSearchedCity = searchedCity.toLower().simplified();
-    for (Station *station : m_allStations) {
-        QString stationCity = station->cityName().toLower().simplified();
-        if (stationCity == normalizedSearchedCity) {
-            Station *searchedStation = new Station(
-                station->stationId(),
-                station->stationName(),
-                station->cityName(),
-                station->address(),
-                station->lat(),
-                station->lon(),
-                true,
-                this
-                );
-            m_stations.append(searchedStation);
-            updateStationSearchStatus(station->stationId(), true);
+    // Znajdź stacje w wyszukanym mieście (bez względu na wielkość liter i znaki diakrytyczne),
+    // a jeśli to się nie uda, w mieście o nazwie zwróconej przez Nominatim
+    QList<int> matches = m_searchIndex.stationsInCity(searchedCity);
+    if (matches.isEmpty())
+        matches = m_searchIndex.stationsInCity(result["name"].toString());
+    showSearchResults(matches);
+
+    if (m_stations->count() == 0) {
+        // Znajdź najbliższą stację przy użyciu indeksu przestrzennego
+        int closestRow = -1;
+        const QList<StationDistance> nearest = m_spatialIndex.nearest(lat, lon, 1);
+        if (!nearest.isEmpty()) {
+            closestRow = m_allStations->rowOf(nearest.first().stationId);
         }
-    }
 
-    if (m_stations.isEmpty()) {
-        // Znajdź najbliższą stację
-        Station *closestStation = nullptr;
-        double minDistance = std::numeric_limits<double>::max();
-        QGeoCoordinate cityCoord(lat, lon);
-
-        for (Station *station : m_allStations) {
-            QGeoCoordinate stationCoord(station->lat(), station->lon());
-            double distance = cityCoord.distanceTo(stationCoord);
-            if (distance < minDistance) {
-                minDistance = distance;
-                closestStation = station;
-            }
-        }
-
-        if (closestStation) {
-            Station *searchedStation = new Station(
-                closestStation->stationId(),
-                closestStation->stationName(),
-                closestStation->cityName(),
-                closestStation->address(),
-                closestStation->lat(),
-                closestStation->lon(),
-                true,
-                this
-                );
-            m_stations.append(searchedStation);
-            updateStationSearchStatus(closestStation->stationId(), true);
+        if (closestRow >= 0) {
+            showSearchResults({ m_allStations->stationId(closestRow) });
 
             // Wycentruj mapę na najbliższej stacji
-            m_mapCenter = QGeoCoordinate(closestStation->lat(), closestStation->lon());
+            m_mapCenter = QGeoCoordinate(m_allStations->lat(closestRow), m_allStations->lon(closestRow));
             emit mapCenterChanged();
 
-            m_status = QString("Nie znaleziono stacji w %1. Najbliższa stacja znajduje się w %2.").arg(searchedCity, closestStation->cityName());
+            m_status = QString("Nie znaleziono stacji w %1. Najbliższa stacja znajduje się w %2.").arg(searchedCity, m_allStations->cityName(closestRow));
         } else {
             m_status = QString("Nie znaleziono stacji w %1.").arg(searchedCity);
         }
     } else {
-        m_status = QString("Znaleziono %1 stacji w %2.").arg(m_stations.count()).arg(searchedCity);
+        m_status = QString("Znaleziono %1 stacji w %2.").arg(m_stations->count()).arg(searchedCity);
     }
 
-    emit stationsChanged();
     emit statusChanged();
-    reply->deleteLater();
 }
 
 /**
- * @brief Obsługuje odpowiedź API dla stacji.
- * @param reply Odpowiedź sieciowa.
+ * @brief Obsługuje koniec odpowiedzi API dla stacji.
+ * @param response Odpowiedź API.
+ * @param streamId Identyfikator strumienia parsowania.
  *
- * Przetwarza odpowiedź z API GIOŚ w celu wypełnienia listy wszystkich stacji.
+ * Zamyka strumień parsowania; różnice nanoszone są na katalog w onStationsParsed().
  */
-void MainWindow::onStationsReply(QNetworkReply *reply)
+void MainWindow::onStationsReply(const ApiResponse &response, quint64 streamId)
 {
-    if (reply->error() != QNetworkReply::NoError) {
-        m_status = "Błąd pobierania stacji: " + reply->errorString();
+    if (!response.ok()) {
+        m_parser->abort(streamId);
+        m_status = "Błąd pobierania stacji: " + response.error;
         emit statusChanged();
-        reply->deleteLater();
         return;
     }
 
-    QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
-    QJsonArray stations = doc.array();
+    m_parser->finish(streamId, response.fromCache);
+}
 
-    m_allStations.clear();
-    for (const QJsonValue &value : stations) {
-        QJsonObject obj = value.toObject();
-        int id = obj["id"].toInt();
-        QString name = obj["stationName"].toString();
-        QString city = obj["city"].toObject()["name"].toString();
-        QString address = obj["addressStreet"].toString();
-        double lat = obj["gegrLat"].toString().toDouble();
-        double lon = obj["gegrLon"].toString().toDouble();
+/**
+ * @brief Dopisuje do mapy stacje odczytane z kolejnego fragmentu katalogu.
+ * @param records Stacje z zakończonych elementów katalogu.
+ *
+ * Dopisywane są tylko stacje nieobecne w modelu; zmiany i usunięcia nanosi dopiero
+ * onStationsParsed() na podstawie pełnego katalogu.
+ */
+void MainWindow::onStationsStreamed(QList<StationRecord> records)
+{
+    MetricsTimer timer(kModelBuildMetric, "model=catalog_stream");
+    for (const StationRecord &record : std::as_const(records)) {
+        if (m_allStations->appendRecord(record))
+            ++m_streamedStations;
+    }
+}
 
-        m_allStations.append(new Station(id, name, city, address, lat, lon, false, this));
+/**
+ * @brief Nanosi katalog stacji odczytany w tle.
+ * @param result Katalog stacji.
+ *
+ * Niepełny katalog nie jest porównywany z bieżącym, aby nie usunąć stacji,
+ * których odpowiedź nie zdążyła zawierać.
+ */
+void MainWindow::onStationsParsed(StationCatalogResult result)
+{
+    const bool streamed = std::exchange(m_streamedStations, 0) > 0;
+    if (!result.complete) {
+        if (streamed)
+            rebuildStationIndexes();
+        m_status = "Błąd odczytu katalogu stacji";
+        emit statusChanged();
+        return;
     }
 
-    emit allStationsChanged();
-    reply->deleteLater();
+    // Nanieś tylko różnice względem katalogu z migawki i zapisz nową migawkę
+    const bool changed = applyStationCatalog(result.records);
+    if (streamed && !changed)
+        rebuildStationIndexes();
+    if (changed || streamed)
+        StationSnapshot::save(StationSnapshot::defaultPath(), result.records);
+    reportCatalogReady(result.fromCache ? "pamięć podręczna" : "sieć");
 }
 
 /**
  * @brief Obsługuje odpowiedź API dla sensorów.
- * @param reply Odpowiedź sieciowa.
+ * @param response Odpowiedź API.
  *
- * Przetwarza odpowiedź z API GIOŚ w celu wypełnienia listy sensorów.
+ * Zleca parsowanie odpowiedzi z API GIOŚ; lista sensorów wypełniana jest w onSensorsParsed().
  */
-void MainWindow::onSensorsReply(QNetworkReply *reply)
+void MainWindow::onSensorsReply(const ApiResponse &response)
 {
-    if (reply->error() != QNetworkReply::NoError) {
+    if (response.cancelled)
+        return;
+
+    if (!response.ok()) {
         m_sensors.clear();
         emit sensorsChanged();
-        reply->deleteLater();
         return;
     }
 
-    QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
-    QJsonArray sensors = doc.array();
+    m_parser->parseSensors(response.body, m_sensorsRequestId);
+}
+
+/**
+ * @brief Nanosi listę sensorów odczytaną w tle.
+ * @param result Lista sensorów.
+ *
+ * Wynik dla wcześniej wybranej stacji jest pomijany.
+ */
+void MainWindow::onSensorsParsed(SensorListResult result)
+{
+    if (result.requestId != m_sensorsRequestId)
+        return;
 
     m_sensors.clear();
-    for (const QJsonValue &sensorValue : sensors) {
-        QJsonObject obj = sensorValue.toObject();
-        QJsonObject param = obj["param"].toObject();
-        QString paramName = param["paramName"].toString();
-        int sensorId = obj["id"].toInt();
+    for (const SensorInfo &sensor : std::as_const(result.sensors)) {
         QVariantMap sensorInfo;
-        sensorInfo["paramName"] = paramName;
-        sensorInfo["sensorId"] = sensorId;
+        sensorInfo["paramName"] = sensor.paramName;
+        sensorInfo["paramCode"] = sensor.paramCode;
+        sensorInfo["sensorId"] = sensor.sensorId;
         m_sensors.append(sensorInfo);
+        m_sensorSeries->setExceedanceThreshold(sensor.sensorId, SensorStatistics::thresholdForParam(sensor.paramCode),
+                                               SensorStatistics::dayRuleForParam(sensor.paramCode));
     }
+    m_airQuality->setSensors(m_sensorsStationId, result.sensors);
 
     emit sensorsChanged();
-    reply->deleteLater();
+
+    if (result.requestId == m_stationDataRequestId) {
+        for (const SensorInfo &sensor : std::as_const(result.sensors))
+            requestSensorData(sensor.sensorId, RequestPriority::Prefetch);
+    }
 }
 
 /**
- * @brief Obsługuje odpowiedź API dla danych sensora.
- * @param reply Odpowiedź sieciowa.
+ * @brief Obsługuje koniec odpowiedzi API dla danych sensora.
+ * @param response Odpowiedź API.
+ * @param requestId Numer żądania listy sensorów, do którego należy żądanie pomiarów.
  * @param sensorId Identyfikator sensora.
+ * @param streamId Identyfikator strumienia parsowania.
  *
- * Przetwarza odpowiedź z API GIOŚ w celu zapisania danych sensora.
+ * Zamyka strumień parsowania; szereg trafia do magazynu w onSensorDataParsed().
  */
-void MainWindow::onSensorDataReply(QNetworkReply *reply, int sensorId)
+void MainWindow::onSensorDataReply(const ApiResponse &response, quint64 requestId, int sensorId, quint64 streamId)
 {
-    if (reply->error() != QNetworkReply::NoError) {
-        m_sensorData.remove(QString::number(sensorId));
-        emit sensorDataChanged();
-        reply->deleteLater();
+    if (!response.ok()) {
+        m_parser->abort(streamId);
+        if (!response.cancelled && requestId == m_sensorsRequestId) {
+            m_pendingSeries.remove(sensorId);
+            m_sensorSeries->remove(sensorId);
+        }
+        finishSensorData(requestId, sensorId);
         return;
     }
 
-    QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
-    QJsonObject obj = doc.object();
-    QJsonArray values = obj["values"].toArray();
-
-    QVariantList sensorDataList;
-    for (const QJsonValue &value : values) {
-        QJsonObject dataPoint = value.toObject();
-        QString date = dataPoint["date"].toString();
-        QVariant dataValue = dataPoint["value"].toVariant();
-        QVariantMap data;
-        data["date"] = date;
-        data["value"] = dataValue;
-        sensorDataList.append(data);
-    }
+    m_parser->finish(streamId, response.fromCache);
+}
 
-    qDebug() << "ID sensora:" << sensorId << "Punkty danych:" << sensorDataList.size();
-    m_sensorData[QString::number(sensorId)] = sensorDataList;
-    emit sensorDataChanged();
-    reply->deleteLater();
+/**
+ * @brief Nanosi pomiary sensora odczytane w tle.
+ * @param result Pomiary sensora.
+ */
+void MainWindow::onSensorDataParsed(SensorDataResult result)
+{
+    // Pomiary poprzednio otwartej stacji oraz szeregi z niepełnej treści są pomijane
+    if (result.requestId == m_sensorsRequestId && result.complete) {
+        MetricsRegistry::instance().add("gios_sensor_points_total", "source=api", result.series.size());
+        m_airQuality->updateSensor(result.sensorId, result.series);
+        m_pendingSeries.insert(result.sensorId, std::move(result.series));
+    }
+    finishSensorData(result.requestId, result.sensorId);
 }
@@ -1,10 +1,10 @@
 /**
  * @file mainwindow.h
- * @brief Plik nagłówkowy dla klas MainWindow i Station.
+ * @brief Plik nagłówkowy dla klasy MainWindow.
  * @author Adam Fedorowicz
  * @date 2025-04-21
  *
- * Ten plik definiuje klasy MainWindow i Station używane w aplikacji monitorowania jakości powietrza.
+ * Ten plik definiuje klasę MainWindow używaną w aplikacji monitorowania jakości powietrza.
  */
 
 #ifndef MAINWINDOW_H
@@ -12,182 +12,194 @@
 
 #include <QObject>
 #include <QGeoCoordinate>
-#include <QQmlListProperty>
-#include <QNetworkAccessManager>
-#include <QNetworkReply>
 #include <QFile>
 #include <QJsonDocument>
 #include <QDateTime>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QSet>
+#include <QTimer>
+#include "airqualityindex.h"
+#include "apiclient.h"
+#include "archivemanifest.h"
+#include "historystore.h"
+#include "replyparser.h"
+#include "stationlistmodel.h"
+#include "stationviewmodel.h"
+#include "stationclustermodel.h"
+#include "stationspatialindex.h"
+#include "stationsearchindex.h"
+#include "stationsnapshot.h"
+#include "stationmonitor.h"
+#include "sensorseries.h"
+#include "stationarchive.h"
+#include "metricsregistry.h"
+#include "pollutantraster.h"
+#include "stationcomparison.h"
 
 /**
- * @class Station
- * @brief Reprezentuje stację monitorowania jakości powietrza.
+ * @class MainWindow
+ * @brief Główna klasa zarządzająca aplikacją monitorowania jakości powietrza.
  *
- * Ta klasa przechowuje właściwości stacji, takie jak jej identyfikator, nazwa, lokalizacja i status wyszukiwania.
+ * Odpowiada za pobieranie danych z API, zarządzanie stacjami, sensorami i danymi archiwalnymi.
  */
-class Station : public QObject {
+class MainWindow : public QObject {
     Q_OBJECT
-    Q_PROPERTY(int stationId READ stationId CONSTANT)
-    Q_PROPERTY(QString stationName READ stationName CONSTANT)
-    Q_PROPERTY(QString cityName READ cityName CONSTANT)
-    Q_PROPERTY(QString address READ address CONSTANT)
-    Q_PROPERTY(double lat READ lat CONSTANT)
-    Q_PROPERTY(double lon READ lon CONSTANT)
-    Q_PROPERTY(bool isSearched READ isSearched NOTIFY isSearchedChanged)
+    Q_PROPERTY(QGeoCoordinate mapCenter READ mapCenter NOTIFY mapCenterChanged)
+    Q_PROPERTY(StationViewModel* stations READ stations CONSTANT)
+    Q_PROPERTY(StationListModel* allStations READ allStations CONSTANT)
+    Q_PROPERTY(StationClusterModel* stationClusters READ stationClusters CONSTANT)
+    Q_PROPERTY(QVariantList sensors READ sensors NOTIFY sensorsChanged)
+    Q_PROPERTY(SensorSeriesStore* sensorSeries READ sensorSeries CONSTANT)
+    Q_PROPERTY(StationMonitor* monitor READ monitor CONSTANT)
+    Q_PROPERTY(AirQualityIndex* airQuality READ airQuality CONSTANT)
+    Q_PROPERTY(PollutantRasterEngine* pollutantRaster READ pollutantRaster CONSTANT)
+    Q_PROPERTY(StationComparison* comparison READ comparison CONSTANT)
+    Q_PROPERTY(QString status READ status NOTIFY statusChanged)
+    Q_PROPERTY(QVariantList archivedStations READ archivedStations NOTIFY archivedStationsChanged)
+    Q_PROPERTY(bool compactArchive READ compactArchive WRITE setCompactArchive NOTIFY compactArchiveChanged)
+    Q_PROPERTY(QVariantMap metrics READ metrics NOTIFY metricsChanged)
 
 public:
     /**
-     * @brief Konstruktor obiektu Station.
-     * @param id Identyfikator stacji.
-     * @param name Nazwa stacji.
-     * @param city Nazwa miasta.
-     * @param addr Adres stacji.
-     * @param latitude Współrzędna szerokości geograficznej.
-     * @param longitude Współrzędna długości geograficznej.
-     * @param searched Status wyszukiwania.
+     * @brief Konstruktor obiektu MainWindow.
      * @param parent Rodzic QObject.
      */
-    Station(int id, QString name, QString city, QString addr, double latitude, double longitude, bool searched, QObject *parent = nullptr)
-        : QObject(parent), m_stationId(id), m_stationName(name), m_cityName(city), m_address(addr), m_lat(latitude), m_lon(longitude), m_isSearched(searched) {}
+    explicit MainWindow(QObject *parent = nullptr);
 
     /**
-     * @brief Pobiera identyfikator stacji.
-     * @return Identyfikator stacji.
+     * @brief Pobiera centrum mapy.
+     * @return Współrzędne centrum mapy.
      */
-    int stationId() const { return m_stationId; }
+    QGeoCoordinate mapCenter() const { return m_mapCenter; }
 
     /**
-     * @brief Pobiera nazwę stacji.
-     * @return Nazwa stacji.
+     * @brief Pobiera model wyszukanych stacji.
+     * @return Model listy wyszukanych stacji.
      */
-    QString stationName() const { return m_stationName; }
+    StationViewModel *stations() const { return m_stations; }
 
     /**
-     * @brief Pobiera nazwę miasta.
-     * @return Nazwa miasta.
+     * @brief Pobiera model wszystkich stacji.
+     * @return Model listy wszystkich stacji.
      */
-    QString cityName() const { return m_cityName; }
+    StationListModel *allStations() const { return m_allStations; }
 
     /**
-     * @brief Pobiera adres stacji.
-     * @return Adres stacji.
+     * @brief Pobiera model znaczników mapy (grupy stacji w bieżącym widoku).
+     * @return Model znaczników mapy.
      */
-    QString address() const { return m_address; }
+    StationClusterModel *stationClusters() const { return m_stationClusters; }
 
     /**
-     * @brief Pobiera szerokość geograficzną.
-     * @return Współrzędna szerokości geograficznej.
+     * @brief Pobiera listę sensorów.
+     * @return Lista sensorów jako QVariantList.
      */
-    double lat() const { return m_lat; }
+    QVariantList sensors() const { return m_sensors; }
 
     /**
-     * @brief Pobiera długość geograficzną.
-     * @return Współrzędna długości geograficznej.
+     * @brief Pobiera magazyn szeregów czasowych sensorów.
+     * @return Magazyn danych sensorów.
      */
-    double lon() const { return m_lon; }
+    SensorSeriesStore *sensorSeries() const { return m_sensorSeries; }
 
     /**
-     * @brief Pobiera status wyszukiwania.
-     * @return True, jeśli stacja jest oznaczona jako wyszukana.
+     * @brief Pobiera monitor obserwowanych stacji.
+     * @return Monitor odświeżający obserwowane stacje co godzinę.
      */
-    bool isSearched() const { return m_isSearched; }
+    StationMonitor *monitor() const { return m_monitor; }
 
     /**
-     * @brief Ustawia status wyszukiwania.
-     * @param searched Nowy status wyszukiwania.
+     * @brief Pobiera indeks jakości powietrza stacji katalogu.
+     * @return Indeks jakości powietrza barwiący znaczniki mapy.
      */
-    void setIsSearched(bool searched) {
-        if (m_isSearched != searched) {
-            m_isSearched = searched;
-            emit isSearchedChanged();
-        }
-    }
+    AirQualityIndex *airQuality() const { return m_airQuality; }
 
-signals:
     /**
-     * @brief Sygnał emitowany, gdy zmieni się status wyszukiwania.
+     * @brief Pobiera silnik pól stężeń nakładki mapy.
+     * @return Silnik pól stężeń.
      */
-    void isSearchedChanged();
+    PollutantRasterEngine *pollutantRaster() const { return m_pollutantRaster; }
 
-private:
-    int m_stationId;          ///< Identyfikator stacji.
-    QString m_stationName;    ///< Nazwa stacji.
-    QString m_cityName;       ///< Nazwa miasta.
-    QString m_address;        ///< Adres stacji.
-    double m_lat;             ///< Szerokość geograficzna.
-    double m_lon;             ///< Długość geograficzna.
-    bool m_isSearched;        ///< Status wyszukiwania.
-};
+    /**
+     * @brief Pobiera porównanie stacji.
+     * @return Porównanie stacji dla jednego parametru.
+     */
+    StationComparison *comparison() const { return m_comparison; }
 
-/**
- * @class MainWindow
- * @brief Główna klasa zarządzająca aplikacją monitorowania jakości powietrza.
- *
- * Odpowiada za pobieranie danych z API, zarządzanie stacjami, sensorami i danymi archiwalnymi.
- */
-class MainWindow : public QObject {
-    Q_OBJECT
-    Q_PROPERTY(QGeoCoordinate mapCenter READ mapCenter NOTIFY mapCenterChanged)
-    Q_PROPERTY(QQmlListProperty<Station> stations READ stations NOTIFY stationsChanged)
-    Q_PROPERTY(QQmlListProperty<Station> allStations READ allStations NOTIFY allStationsChanged)
-    Q_PROPERTY(QVariantList sensors READ sensors NOTIFY sensorsChanged)
-    Q_PROPERTY(QVariantMap sensorData READ sensorData NOTIFY sensorDataChanged)
-    Q_PROPERTY(QString status READ status NOTIFY statusChanged)
-    Q_PROPERTY(QVariantList archivedStations READ archivedStations NOTIFY archivedStationsChanged)
+    /**
+     * @brief Pobiera komunikat statusu.
+     * @return Aktualny komunikat statusu.
+     */
+    QString status() const { return m_status; }
 
-public:
     /**
-     * @brief Konstruktor obiektu MainWindow.
-     * @param parent Rodzic QObject.
+     * @brief Pobiera listę zapisanych stacji.
+     * @return Lista zapisanych stacji jako QVariantList.
      */
-    explicit MainWindow(QObject *parent = nullptr);
+    QVariantList archivedStations() const { return m_archivedStations; }
 
     /**
-     * @brief Pobiera centrum mapy.
-     * @return Współrzędne centrum mapy.
+     * @brief Sprawdza, czy dane stacji zapisywane są w zwartym formacie binarnym.
+     * @return True dla formatu .gar, false dla JSON.
      */
-    QGeoCoordinate mapCenter() const { return m_mapCenter; }
+    bool compactArchive() const { return m_compactArchive; }
 
     /**
-     * @brief Pobiera listę wyszukanych stacji.
-     * @return Lista stacji w formacie QQmlListProperty.
+     * @brief Włącza lub wyłącza zapis w zwartym formacie binarnym.
+     * @param compact True dla formatu .gar, false dla JSON.
      */
-    QQmlListProperty<Station> stations() {
-        return QQmlListProperty<Station>(this, &m_stations);
-    }
+    void setCompactArchive(bool compact);
 
     /**
-     * @brief Pobiera listę wszystkich stacji.
-     * @return Lista wszystkich stacji w formacie QQmlListProperty.
+     * @brief Pobiera migawkę metryk czasu działania dla panelu diagnostycznego.
+     * @return Mapa z listami "histograms" i "counters" (MetricsRegistry::toVariant()),
+     *         mapą "cacheHitRates" (udział świeżych trafień pamięci podręcznej według zasobu)
+     *         i polem "catalogReadyMs".
      */
-    QQmlListProperty<Station> allStations() {
-        return QQmlListProperty<Station>(this, &m_allStations);
-    }
+    QVariantMap metrics() const;
 
     /**
-     * @brief Pobiera listę sensorów.
-     * @return Lista sensorów jako QVariantList.
+     * @brief Zapisuje metryki w formacie tekstowym Prometheus.
+     * @param path Ścieżka pliku.
+     * @return True, jeśli zapis się powiódł.
      */
-    QVariantList sensors() const { return m_sensors; }
+    Q_INVOKABLE bool dumpMetrics(const QString &path) const;
 
     /**
-     * @brief Pobiera dane sensorów.
-     * @return Mapa danych sensorów jako QVariantMap.
+     * @brief Wyszukuje k najbliższych stacji.
+     * @param lat Szerokość geograficzna punktu.
+     * @param lon Długość geograficzna punktu.
+     * @param k Maksymalna liczba stacji.
+     * @return Lista stacji (mapy z danymi stacji i polem distanceKm) posortowana według odległości.
      */
-    QVariantMap sensorData() const { return m_sensorData; }
+    Q_INVOKABLE QVariantList nearestStations(double lat, double lon, int k) const;
 
     /**
-     * @brief Pobiera komunikat statusu.
-     * @return Aktualny komunikat statusu.
+     * @brief Wyszukuje stacje w zadanym promieniu.
+     * @param lat Szerokość geograficzna punktu.
+     * @param lon Długość geograficzna punktu.
+     * @param radiusKm Promień w kilometrach.
+     * @return Lista stacji (mapy z danymi stacji i polem distanceKm) posortowana według odległości.
      */
-    QString status() const { return m_status; }
+    Q_INVOKABLE QVariantList stationsWithin(double lat, double lon, double radiusKm) const;
 
     /**
-     * @brief Pobiera listę zapisanych stacji.
-     * @return Lista zapisanych stacji jako QVariantList.
+     * @brief Zwraca podpowiedzi dla pola wyszukiwania.
+     * @param prefix Wpisany tekst.
+     * @param limit Maksymalna liczba podpowiedzi.
+     * @return Lista map z polami text, kind, stationId, cityName i stationCount.
      */
-    QVariantList archivedStations() const { return m_archivedStations; }
+    Q_INVOKABLE QVariantList suggest(const QString &prefix, int limit) const;
+
+    /**
+     * @brief Wczytuje do magazynu szeregów pomiary sensora z historii.
+     * @param sensorId Identyfikator sensora.
+     * @param fromDate Początek przedziału ("yyyy-MM-dd HH:mm:ss" lub ISO 8601).
+     * @param toDate Koniec przedziału ("yyyy-MM-dd HH:mm:ss" lub ISO 8601).
+     * @return Liczba wczytanych pomiarów lub -1 dla nieprawidłowej daty.
+     */
+    Q_INVOKABLE int loadSensorHistory(int sensorId, const QString &fromDate, const QString &toDate);
 
 public slots:
     /**
@@ -208,6 +220,12 @@ public slots:
      */
     void fetchSensorData(int sensorId);
 
+    /**
+     * @brief Pobiera listę sensorów stacji i pomiary wszystkich jej sensorów.
+     * @param stationId Identyfikator stacji.
+     */
+    void fetchStationData(int stationId);
+
     /**
      * @brief Aktualizuje status wyszukiwania stacji.
      * @param stationId Identyfikator stacji.
@@ -239,70 +257,169 @@ public slots:
 private slots:
     /**
      * @brief Obsługuje odpowiedź API geokodowania.
-     * @param reply Odpowiedź sieciowa.
+     * @param response Odpowiedź API.
      * @param searchedCity Wyszukiwane miasto.
      */
-    void onGeocodeReply(QNetworkReply *reply, const QString &searchedCity);
+    void onGeocodeReply(const ApiResponse &response, const QString &searchedCity);
 
     /**
-     * @brief Obsługuje odpowiedź API dla stacji.
-     * @param reply Odpowiedź sieciowa.
+     * @brief Obsługuje koniec odpowiedzi API dla stacji.
+     * @param response Odpowiedź API.
+     * @param streamId Identyfikator strumienia parsowania.
      */
-    void onStationsReply(QNetworkReply *reply);
+    void onStationsReply(const ApiResponse &response, quint64 streamId);
 
     /**
      * @brief Obsługuje odpowiedź API dla sensorów.
-     * @param reply Odpowiedź sieciowa.
+     * @param response Odpowiedź API.
      */
-    void onSensorsReply(QNetworkReply *reply);
+    void onSensorsReply(const ApiResponse &response);
 
     /**
-     * @brief Obsługuje odpowiedź API dla danych sensora.
-     * @param reply Odpowiedź sieciowa.
+     * @brief Obsługuje koniec odpowiedzi API dla danych sensora.
+     * @param response Odpowiedź API.
+     * @param requestId Numer żądania listy sensorów, do którego należy żądanie pomiarów.
      * @param sensorId Identyfikator sensora.
+     * @param streamId Identyfikator strumienia parsowania.
+     */
+    void onSensorDataReply(const ApiResponse &response, quint64 requestId, int sensorId, quint64 streamId);
+
+    /**
+     * @brief Dopisuje do mapy stacje odczytane z kolejnego fragmentu katalogu.
+     * @param records Stacje z zakończonych elementów katalogu.
+     */
+    void onStationsStreamed(QList<StationRecord> records);
+
+    /**
+     * @brief Nanosi katalog stacji odczytany w tle.
+     * @param result Katalog stacji.
+     */
+    void onStationsParsed(StationCatalogResult result);
+
+    /**
+     * @brief Nanosi listę sensorów odczytaną w tle.
+     * @param result Lista sensorów.
      */
-    void onSensorDataReply(QNetworkReply *reply, int sensorId);
+    void onSensorsParsed(SensorListResult result);
+
+    /**
+     * @brief Nanosi pomiary sensora odczytane w tle.
+     * @param result Pomiary sensora.
+     */
+    void onSensorDataParsed(SensorDataResult result);
+
+    /**
+     * @brief Nanosi wczytany w tle plik archiwalny.
+     * @param result Zawartość pliku.
+     */
+    void onArchiveLoaded(ArchiveLoadResult result);
 
 private:
     /**
-     * @brief Ładuje listę zapisanych stacji.
+     * @brief Odświeża listę zapisanych stacji z indeksu archiwum.
      */
     void loadArchivedStations();
 
-    QGeoCoordinate m_mapCenter;              ///< Centrum mapy.
-    QList<Station*> m_stations;              ///< Lista wyszukanych stacji.
-    QList<Station*> m_allStations;           ///< Lista wszystkich stacji.
-    QVariantList m_sensors;                  ///< Lista sensorów.
-    QVariantMap m_sensorData;                ///< Dane sensorów.
-    QString m_status;                        ///< Komunikat statusu.
-    QVariantList m_archivedStations;         ///< Lista zapisanych stacji.
-    QNetworkAccessManager *m_networkManager; ///< Menedżer sieci.
+    /**
+     * @brief Wczytuje katalog stacji z binarnej migawki.
+     */
+    void loadStationSnapshot();
 
-signals:
     /**
-     * @brief Sygnał emitowany, gdy zmieni się centrum mapy.
+     * @brief Porównuje nowy katalog stacji z bieżącym i nanosi tylko różnice.
+     * @param records Rekordy katalogu.
+     * @return True, jeśli katalog się zmienił.
      */
-    void mapCenterChanged();
+    bool applyStationCatalog(const QList<StationRecord> &records);
 
     /**
-     * @brief Sygnał emitowany, gdy zmieni się lista wyszukanych stacji.
+     * @brief Wysyła żądanie pomiarów sensora.
+     * @param sensorId Identyfikator sensora.
+     * @param priority Priorytet żądania.
      */
-    void stationsChanged();
+    void requestSensorData(int sensorId, RequestPriority priority);
 
     /**
-     * @brief Sygnał emitowany, gdy zmieni się lista wszystkich stacji.
+     * @brief Kończy żądanie pomiarów sensora.
+     * @param requestId Numer żądania listy sensorów, do którego należy żądanie pomiarów.
+     * @param sensorId Identyfikator sensora.
      */
-    void allStationsChanged();
+    void finishSensorData(quint64 requestId, int sensorId);
 
     /**
-     * @brief Sygnał emitowany, gdy zmieni się lista sensorów.
+     * @brief Przekazuje zebrane szeregi do magazynu jedną zmianą.
      */
-    void sensorsChanged();
+    void flushPendingSeries();
 
     /**
-     * @brief Sygnał emitowany, gdy zmieni się dane sensorów.
+     * @brief Zapisuje w dzienniku czas od uruchomienia do wypełnienia katalogu stacji.
+     * @param source Źródło katalogu.
      */
-    void sensorDataChanged();
+    void reportCatalogReady(const QString &source);
+
+    /**
+     * @brief Wypełnia listę wyszukanych stacji i oznacza je na mapie.
+     * @param stationIds Identyfikatory znalezionych stacji.
+     */
+    void showSearchResults(const QList<int> &stationIds);
+
+    /**
+     * @brief Odbudowuje indeksy katalogu stacji po jego zmianie.
+     */
+    void rebuildStationIndexes();
+
+    /**
+     * @brief Zamienia wyniki zapytania przestrzennego na listę dla QML.
+     * @param distances Wyniki zapytania przestrzennego.
+     * @return Lista map z danymi stacji i odległością.
+     */
+    QVariantList stationDistancesToVariant(const QList<StationDistance> &distances) const;
+
+    QGeoCoordinate m_mapCenter;              ///< Centrum mapy.
+    StationListModel *m_allStations;         ///< Katalog wszystkich stacji.
+    StationViewModel *m_stations;            ///< Widok wyszukanych stacji w katalogu.
+    StationClusterModel *m_stationClusters;  ///< Grupy stacji widoczne na mapie.
+    QVariantList m_sensors;                  ///< Lista sensorów.
+    SensorSeriesStore *m_sensorSeries;       ///< Szeregi czasowe pomiarów sensorów.
+    QString m_status;                        ///< Komunikat statusu.
+    QVariantList m_archivedStations;         ///< Lista zapisanych stacji.
+    ArchiveManifest *m_archiveManifest;      ///< Indeks plików archiwalnych.
+    bool m_compactArchive = true;            ///< Czy zapisywać dane w formacie binarnym.
+    ApiClient *m_apiClient;                  ///< Klient HTTP z pamięcią podręczną odpowiedzi.
+    ReplyParser *m_parser;                   ///< Parsowanie odpowiedzi w wątkach roboczych.
+    ReplyParser *m_backgroundParser;         ///< Parsowanie odpowiedzi zadań w tle (wspólne dla ich kolejek).
+    quint64 m_sensorsRequestId = 0;          ///< Numer ostatniego żądania listy sensorów.
+    int m_sensorsStationId = -1;             ///< Stacja ostatniego żądania listy sensorów.
+    quint64 m_archiveRequestId = 0;          ///< Numer ostatniego żądania pliku archiwalnego.
+    int m_streamedStations = 0;              ///< Stacje dopisane ze strumienia od ostatniego katalogu.
+    quint64 m_stationDataRequestId = 0;      ///< Żądanie listy sensorów, po którym pobierane są wszystkie pomiary.
+    QSet<int> m_sensorDataInFlight;          ///< Sensory z trwającym żądaniem pomiarów.
+    QHash<int, SensorSeries> m_pendingSeries; ///< Szeregi czekające na wspólną zmianę magazynu.
+    QTimer m_seriesFlushTimer;               ///< Termin przekazania szeregów mimo trwających żądań.
+    StationSpatialIndex m_spatialIndex;      ///< Indeks przestrzenny katalogu stacji.
+    StationSearchIndex m_searchIndex;        ///< Indeks tekstowy katalogu stacji.
+    HistoryStore m_history;                  ///< Ciągła historia pomiarów sensorów.
+    StationMonitor *m_monitor;               ///< Cogodzinne odświeżanie obserwowanych stacji.
+    AirQualityIndex *m_airQuality;           ///< Indeks jakości powietrza stacji katalogu.
+    PollutantRasterEngine *m_pollutantRaster; ///< Pola stężeń nakładki mapy.
+    StationComparison *m_comparison;         ///< Porównanie stacji dla jednego parametru.
+    QElapsedTimer m_startupTimer;            ///< Pomiar czasu od utworzenia obiektu.
+    qint64 m_catalogReadyMs = -1;            ///< Czas do wypełnienia katalogu w ms (-1 przed pomiarem).
+    QTimer m_metricsTimer;                   ///< Powiadamianie o zmianie metryk.
+    quint64 m_metricsRevision = 0;           ///< Wersja rejestru metryk z ostatniego powiadomienia.
+    QTimer m_metricsDumpTimer;               ///< Okresowy zapis metryk do pliku.
+    QString m_metricsFile;                   ///< Plik metryk (GIOS_METRICS_FILE); pusty wyłącza zapis.
+
+signals:
+    /**
+     * @brief Sygnał emitowany, gdy zmieni się centrum mapy.
+     */
+    void mapCenterChanged();
+
+    /**
+     * @brief Sygnał emitowany, gdy zmieni się lista sensorów.
+     */
+    void sensorsChanged();
 
     /**
      * @brief Sygnał emitowany, gdy zmieni się komunikat statusu.
@@ -318,6 +435,16 @@ signals:
      * @brief Sygnał emitowany, gdy dane archiwalne zostaną załadowane.
      */
     void archivedDataLoaded();
+
+    /**
+     * @brief Sygnał emitowany, gdy zmieni się format zapisu danych archiwalnych.
+     */
+    void compactArchiveChanged();
+
+    /**
+     * @brief Sygnał emitowany najwyżej co 2 s, gdy zmieniły się metryki.
+     */
+    void metricsChanged();
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,306 @@
+/**
+ * @file metricsregistry.cpp
+ * @brief Implementacja klas MetricsRegistry i SignalCounter.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera zapis histogramów i liczników, szacowanie percentyli
+ * oraz eksport rejestru do QVariantMap i formatu tekstowego Prometheus.
+ */
+
+#include "metricsregistry.h"
+#include <QDebug>
+#include <QMetaMethod>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QVariantList>
+#include <algorithm>
+
+/**
+ * @brief Pobiera rejestr procesu.
+ * @return Referencja do rejestru.
+ */
+MetricsRegistry &MetricsRegistry::instance()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+/**
+ * @brief Pobiera górne granice przedziałów histogramów.
+ * @return Granice w milisekundach, rosnąco (bez +Inf).
+ *
+ * Zakres obejmuje zarówno parsowanie małych odpowiedzi (poniżej milisekundy),
+ * jak i żądania czekające w kolejce na limit hosta (kilkanaście sekund).
+ */
+const QVector<double> &MetricsRegistry::bucketBounds()
+{
+    static const QVector<double> bounds = { 0.5, 1, 2.5, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 30000 };
+    return bounds;
+}
+
+/**
+ * @brief Zapisuje pomiar czasu w histogramie.
+ * @param name Nazwa metryki.
+ * @param labels Etykiety w postaci "klucz=wartość,klucz=wartość".
+ * @param milliseconds Czas w milisekundach.
+ */
+void MetricsRegistry::observe(const QString &name, const QString &labels, double milliseconds)
+{
+    const QVector<double> &bounds = bucketBounds();
+    const int bucket = int(std::lower_bound(bounds.cbegin(), bounds.cend(), milliseconds) - bounds.cbegin());
+
+    QMutexLocker locker(&m_mutex);
+    Histogram &histogram = m_histograms[Key(name, labels)];
+    if (histogram.buckets.isEmpty())
+        histogram.buckets.resize(bounds.size() + 1);
+    ++histogram.buckets[bucket];
+    ++histogram.count;
+    histogram.sum += milliseconds;
+    histogram.max = qMax(histogram.max, milliseconds);
+    ++m_revision;
+}
+
+/**
+ * @brief Zwiększa licznik.
+ * @param name Nazwa metryki.
+ * @param labels Etykiety w postaci "klucz=wartość,klucz=wartość".
+ * @param delta Przyrost.
+ */
+void MetricsRegistry::add(const QString &name, const QString &labels, qint64 delta)
+{
+    QMutexLocker locker(&m_mutex);
+    m_counters[Key(name, labels)] += delta;
+    ++m_revision;
+}
+
+/**
+ * @brief Pobiera wartość licznika.
+ * @param name Nazwa metryki.
+ * @param labels Etykiety.
+ * @return Wartość licznika (0, jeśli nie istnieje).
+ */
+qint64 MetricsRegistry::counter(const QString &name, const QString &labels) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_counters.value(Key(name, labels));
+}
+
+/**
+ * @brief Pobiera liczbę pomiarów histogramu.
+ * @param name Nazwa metryki.
+ * @param labels Etykiety.
+ * @return Liczba pomiarów (0, jeśli histogram nie istnieje).
+ */
+qint64 MetricsRegistry::observations(const QString &name, const QString &labels) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_histograms.value(Key(name, labels)).count;
+}
+
+/**
+ * @brief Pobiera numer wersji zawartości.
+ * @return Numer zwiększany przy każdym zapisie.
+ */
+quint64 MetricsRegistry::revision() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_revision;
+}
+
+/**
+ * @brief Usuwa wszystkie metryki.
+ */
+void MetricsRegistry::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_histograms.clear();
+    m_counters.clear();
+    ++m_revision;
+}
+
+/**
+ * @brief Szacuje percentyl z przedziałów (interpolacja liniowa w przedziale).
+ * @param fraction Rząd percentyla (0-1).
+ * @return Szacowana wartość w ms, nie większa niż największy pomiar.
+ */
+double MetricsRegistry::Histogram::percentile(double fraction) const
+{
+    if (count == 0)
+        return 0.0;
+
+    const QVector<double> &bounds = bucketBounds();
+    const double rank = fraction * count;
+    qint64 cumulative = 0;
+    for (int i = 0; i < buckets.size(); ++i) {
+        if (buckets.at(i) == 0)
+            continue;
+        if (cumulative + buckets.at(i) >= rank) {
+            const double lower = i == 0 ? 0.0 : bounds.at(i - 1);
+            const double upper = i < bounds.size() ? qMin(bounds.at(i), max) : max;
+            return lower + (upper - lower) * (rank - cumulative) / buckets.at(i);
+        }
+        cumulative += buckets.at(i);
+    }
+    return max;
+}
+
+/**
+ * @brief Buduje migawkę rejestru dla QML.
+ * @return Mapa z listami "histograms" i "counters".
+ */
+QVariantMap MetricsRegistry::toVariant() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    QVariantList histograms;
+    for (auto it = m_histograms.cbegin(); it != m_histograms.cend(); ++it) {
+        const Histogram &histogram = it.value();
+        QVariantMap entry;
+        entry["name"] = it.key().first;
+        entry["labels"] = it.key().second;
+        entry["count"] = histogram.count;
+        entry["sumMs"] = histogram.sum;
+        entry["meanMs"] = histogram.count > 0 ? histogram.sum / histogram.count : 0.0;
+        entry["p50Ms"] = histogram.percentile(0.50);
+        entry["p95Ms"] = histogram.percentile(0.95);
+        entry["maxMs"] = histogram.max;
+        histograms.append(entry);
+    }
+
+    QVariantList counters;
+    for (auto it = m_counters.cbegin(); it != m_counters.cend(); ++it) {
+        QVariantMap entry;
+        entry["name"] = it.key().first;
+        entry["labels"] = it.key().second;
+        entry["value"] = it.value();
+        counters.append(entry);
+    }
+
+    QVariantMap result;
+    result["histograms"] = histograms;
+    result["counters"] = counters;
+    return result;
+}
+
+/**
+ * @brief Zamienia etykiety "klucz=wartość" na zapis Prometheus.
+ * @param labels Etykiety.
+ * @param extra Dodatkowa etykieta w zapisie Prometheus (np. le="10").
+ * @return Etykiety w nawiasach klamrowych lub pusty tekst.
+ */
+QByteArray MetricsRegistry::prometheusLabels(const QString &labels, const QByteArray &extra)
+{
+    QByteArrayList parts;
+    const QStringList pairs = labels.split(',', Qt::SkipEmptyParts);
+    for (const QString &pair : pairs) {
+        QString value = pair.section('=', 1);
+        value.replace('\\', "\\\\").replace('"', "\\\"");
+        parts.append(pair.section('=', 0, 0).trimmed().toUtf8() + "=\"" + value.toUtf8() + '"');
+    }
+    if (!extra.isEmpty())
+        parts.append(extra);
+    return parts.isEmpty() ? QByteArray() : '{' + parts.join(',') + '}';
+}
+
+/**
+ * @brief Buduje zawartość rejestru w formacie tekstowym Prometheus.
+ * @return Tekst ekspozycji.
+ *
+ * Każda rodzina metryk ma jeden wiersz # TYPE; przedziały histogramu są skumulowane,
+ * jak wymaga format.
+ */
+QByteArray MetricsRegistry::toPrometheus() const
+{
+    QMutexLocker locker(&m_mutex);
+    const QVector<double> &bounds = bucketBounds();
+    QByteArray text;
+
+    QString family;
+    for (auto it = m_histograms.cbegin(); it != m_histograms.cend(); ++it) {
+        const QByteArray name = it.key().first.toUtf8();
+        if (it.key().first != family) {
+            family = it.key().first;
+            text += "# TYPE " + name + " histogram\n";
+        }
+        const Histogram &histogram = it.value();
+        qint64 cumulative = 0;
+        for (int i = 0; i < histogram.buckets.size(); ++i) {
+            cumulative += histogram.buckets.at(i);
+            const QByteArray le = i < bounds.size() ? QByteArray::number(bounds.at(i)) : QByteArray("+Inf");
+            text += name + "_bucket" + prometheusLabels(it.key().second, "le=\"" + le + '"')
+                    + ' ' + QByteArray::number(cumulative) + '\n';
+        }
+        const QByteArray labels = prometheusLabels(it.key().second);
+        text += name + "_sum" + labels + ' ' + QByteArray::number(histogram.sum, 'f', 3) + '\n';
+        text += name + "_count" + labels + ' ' + QByteArray::number(histogram.count) + '\n';
+    }
+
+    family.clear();
+    for (auto it = m_counters.cbegin(); it != m_counters.cend(); ++it) {
+        const QByteArray name = it.key().first.toUtf8();
+        if (it.key().first != family) {
+            family = it.key().first;
+            text += "# TYPE " + name + " counter\n";
+        }
+        text += name + prometheusLabels(it.key().second) + ' ' + QByteArray::number(it.value()) + '\n';
+    }
+    return text;
+}
+
+/**
+ * @brief Zapisuje zawartość rejestru w formacie Prometheus do pliku.
+ * @param path Ścieżka pliku.
+ * @return True, jeśli zapis się powiódł.
+ *
+ * Zapis przez QSaveFile, więc czytelnik pliku (np. node_exporter textfile collector)
+ * nigdy nie widzi niepełnej zawartości.
+ */
+bool MetricsRegistry::writePrometheus(const QString &path) const
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Nie można zapisać metryk:" << path << file.errorString();
+        return false;
+    }
+    const QByteArray text = toPrometheus();
+    if (file.write(text) != text.size()) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+/**
+ * @brief Rozpoczyna zliczanie sygnałów obiektu.
+ * @param object Obserwowany obiekt (rodzic licznika).
+ *
+ * Etykiety sygnałów (klasa, sygnał i nazwa obiektu, jeśli jest ustawiona) są wyznaczane raz,
+ * tutaj; slot count() tylko je odczytuje, więc może być wywoływany równolegle z wielu wątków.
+ * Kopie sygnałów z parametrami domyślnymi są pomijane, aby emisja nie była liczona dwukrotnie.
+ */
+SignalCounter::SignalCounter(QObject *object)
+    : QObject(object)
+{
+    const QMetaObject *meta = object->metaObject();
+    const QMetaMethod slot = metaObject()->method(metaObject()->indexOfSlot("count()"));
+    for (int i = QObject::staticMetaObject.methodCount(); i < meta->methodCount(); ++i) {
+        const QMetaMethod method = meta->method(i);
+        if (method.methodType() != QMetaMethod::Signal || (method.attributes() & QMetaMethod::Cloned))
+            continue;
+        QString label = QString("signal=%1::%2").arg(QString::fromLatin1(meta->className()),
+                                                     QString::fromLatin1(method.name()));
+        if (!object->objectName().isEmpty())
+            label += ",object=" + object->objectName();
+        m_labels.insert(i, label);
+        connect(object, method, this, slot, Qt::DirectConnection);
+    }
+}
+
+/**
+ * @brief Zwiększa licznik sygnału, który wywołał slot.
+ */
+void SignalCounter::count()
+{
+    MetricsRegistry::instance().add("gios_signal_emissions_total", m_labels.value(senderSignalIndex()));
+}
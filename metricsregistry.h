@@ -0,0 +1,212 @@
+/**
+ * @file metricsregistry.h
+ * @brief Plik nagłówkowy dla klas MetricsRegistry, MetricsTimer i SignalCounter.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje rejestr metryk czasu działania: histogramy czasów (żądania HTTP,
+ * parsowanie, budowa modeli, zapis i odczyt archiwum) oraz liczniki (bajty, trafienia
+ * pamięci podręcznej, emisje sygnałów).
+ */
+
+#ifndef METRICSREGISTRY_H
+#define METRICSREGISTRY_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+#include <QVariantMap>
+#include <QVector>
+
+/**
+ * @class MetricsRegistry
+ * @brief Wspólny dla procesu, bezpieczny wątkowo rejestr histogramów i liczników.
+ *
+ * Metryka jest identyfikowana nazwą w konwencji Prometheus (np. "gios_http_request_duration_ms")
+ * i etykietami zapisanymi jako "klucz=wartość,klucz=wartość" (np. "endpoint=getData").
+ * Histogramy mają stałe przedziały w milisekundach, więc zapis pomiaru to kilka porównań
+ * pod muteksem, a percentyle są szacowane z przedziałów. Zawartość jest dostępna jako
+ * QVariantMap (panel diagnostyczny) i w formacie tekstowym Prometheus (plik).
+ */
+class MetricsRegistry {
+public:
+    /**
+     * @brief Pobiera rejestr procesu.
+     * @return Referencja do rejestru.
+     */
+    static MetricsRegistry &instance();
+
+    /**
+     * @brief Zapisuje pomiar czasu w histogramie.
+     * @param name Nazwa metryki.
+     * @param labels Etykiety w postaci "klucz=wartość,klucz=wartość".
+     * @param milliseconds Czas w milisekundach.
+     */
+    void observe(const QString &name, const QString &labels, double milliseconds);
+
+    /**
+     * @brief Zwiększa licznik.
+     * @param name Nazwa metryki.
+     * @param labels Etykiety w postaci "klucz=wartość,klucz=wartość".
+     * @param delta Przyrost.
+     */
+    void add(const QString &name, const QString &labels, qint64 delta = 1);
+
+    /**
+     * @brief Pobiera wartość licznika.
+     * @param name Nazwa metryki.
+     * @param labels Etykiety.
+     * @return Wartość licznika (0, jeśli nie istnieje).
+     */
+    qint64 counter(const QString &name, const QString &labels) const;
+
+    /**
+     * @brief Pobiera liczbę pomiarów histogramu.
+     * @param name Nazwa metryki.
+     * @param labels Etykiety.
+     * @return Liczba pomiarów (0, jeśli histogram nie istnieje).
+     */
+    qint64 observations(const QString &name, const QString &labels) const;
+
+    /**
+     * @brief Pobiera numer wersji zawartości.
+     * @return Numer zwiększany przy każdym zapisie.
+     */
+    quint64 revision() const;
+
+    /**
+     * @brief Usuwa wszystkie metryki.
+     */
+    void reset();
+
+    /**
+     * @brief Buduje migawkę rejestru dla QML.
+     * @return Mapa z listami "histograms" (name, labels, count, sumMs, meanMs, p50Ms, p95Ms, maxMs)
+     *         i "counters" (name, labels, value).
+     */
+    QVariantMap toVariant() const;
+
+    /**
+     * @brief Buduje zawartość rejestru w formacie tekstowym Prometheus.
+     * @return Tekst ekspozycji (histogramy z przedziałami skumulowanymi, _sum i _count).
+     */
+    QByteArray toPrometheus() const;
+
+    /**
+     * @brief Zapisuje zawartość rejestru w formacie Prometheus do pliku.
+     * @param path Ścieżka pliku (zapis atomowy).
+     * @return True, jeśli zapis się powiódł.
+     */
+    bool writePrometheus(const QString &path) const;
+
+    /**
+     * @brief Pobiera górne granice przedziałów histogramów.
+     * @return Granice w milisekundach, rosnąco (bez +Inf).
+     */
+    static const QVector<double> &bucketBounds();
+
+private:
+    MetricsRegistry() = default;
+    Q_DISABLE_COPY(MetricsRegistry)
+
+    /**
+     * @struct Histogram
+     * @brief Histogram czasów o stałych przedziałach.
+     */
+    struct Histogram {
+        QVector<qint64> buckets;  ///< Liczba pomiarów w przedziałach (ostatni to +Inf).
+        qint64 count = 0;         ///< Liczba pomiarów.
+        double sum = 0.0;         ///< Suma pomiarów w ms.
+        double max = 0.0;         ///< Największy pomiar w ms.
+
+        /**
+         * @brief Szacuje percentyl z przedziałów (interpolacja liniowa w przedziale).
+         * @param fraction Rząd percentyla (0-1).
+         * @return Szacowana wartość w ms.
+         */
+        double percentile(double fraction) const;
+    };
+
+    /// Klucz metryki: nazwa i etykiety.
+    using Key = QPair<QString, QString>;
+
+    /**
+     * @brief Zamienia etykiety "klucz=wartość" na zapis Prometheus.
+     * @param labels Etykiety.
+     * @param extra Dodatkowa etykieta w zapisie Prometheus (np. le="10").
+     * @return Etykiety w nawiasach klamrowych lub pusty tekst.
+     */
+    static QByteArray prometheusLabels(const QString &labels, const QByteArray &extra = QByteArray());
+
+    mutable QMutex m_mutex;              ///< Ochrona dostępu z wielu wątków.
+    QMap<Key, Histogram> m_histograms;   ///< Histogramy według nazwy i etykiet.
+    QMap<Key, qint64> m_counters;        ///< Liczniki według nazwy i etykiet.
+    quint64 m_revision = 0;              ///< Numer wersji zawartości.
+};
+
+/**
+ * @class MetricsTimer
+ * @brief Mierzy czas zakresu i zapisuje go w histogramie przy wyjściu z zakresu.
+ */
+class MetricsTimer {
+public:
+    /**
+     * @brief Rozpoczyna pomiar.
+     * @param name Nazwa metryki.
+     * @param labels Etykiety.
+     */
+    MetricsTimer(const QString &name, const QString &labels)
+        : m_name(name), m_labels(labels)
+    {
+        m_timer.start();
+    }
+
+    /**
+     * @brief Kończy pomiar i zapisuje go w rejestrze.
+     */
+    ~MetricsTimer()
+    {
+        MetricsRegistry::instance().observe(m_name, m_labels, m_timer.nsecsElapsed() / 1e6);
+    }
+
+private:
+    Q_DISABLE_COPY(MetricsTimer)
+
+    QString m_name;          ///< Nazwa metryki.
+    QString m_labels;        ///< Etykiety.
+    QElapsedTimer m_timer;   ///< Pomiar czasu.
+};
+
+/**
+ * @class SignalCounter
+ * @brief Zlicza emisje sygnałów obiektu w liczniku "gios_signal_emissions_total".
+ *
+ * Łączy się ze wszystkimi sygnałami zadeklarowanymi w klasie obiektu (bez sygnałów
+ * QObject) połączeniem bezpośrednim, więc liczy także emisje z wątków roboczych.
+ * Jest dzieckiem obserwowanego obiektu i znika razem z nim.
+ */
+class SignalCounter : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Rozpoczyna zliczanie sygnałów obiektu.
+     * @param object Obserwowany obiekt (rodzic licznika).
+     */
+    explicit SignalCounter(QObject *object);
+
+private slots:
+    /**
+     * @brief Zwiększa licznik sygnału, który wywołał slot.
+     */
+    void count();
+
+private:
+    QHash<int, QString> m_labels;  ///< Etykieta według indeksu sygnału (tylko do odczytu po konstrukcji).
+};
+
+#endif // METRICSREGISTRY_H
@@ -0,0 +1,535 @@
+/**
+ * @file pollutantraster.cpp
+ * @brief Implementacja klasy PollutantRasterEngine.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera geometrię siatki, równoległe wyznaczanie kafelków pola stężeń,
+ * pamięć podręczną rastrów i dostawcę obrazów kafelków dla QML.
+ */
+
+#include "pollutantraster.h"
+#include "metricsregistry.h"
+#include "stationclusterindex.h"
+#include "stationlistmodel.h"
+#include <QColor>
+#include <QtConcurrent>
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+/// Obszar nakładki (Polska z marginesem).
+constexpr double kWest = 14.0;
+constexpr double kSouth = 49.0;
+constexpr double kEast = 24.2;
+constexpr double kNorth = 55.0;
+
+/// Nazwa dostawcy obrazów kafelków w adresach QML.
+const QString kProviderName = QStringLiteral("pollution");
+
+/**
+ * @brief Pobiera szerokość świata w pikselach na poziomie przybliżenia.
+ * @param zoom Poziom przybliżenia.
+ * @return Szerokość świata.
+ */
+double worldSize(int zoom)
+{
+    return StationClusterIndex::kTileSize * std::ldexp(1.0, zoom);
+}
+}
+
+/**
+ * @brief Wyznacza siatkę pokrywającą prostokąt współrzędnych.
+ * @param west Zachodnia granica (długość geograficzna).
+ * @param south Południowa granica (szerokość geograficzna).
+ * @param east Wschodnia granica (długość geograficzna).
+ * @param north Północna granica (szerokość geograficzna).
+ * @param zoom Poziom przybliżenia.
+ * @param tileSize Bok kafelka w komórkach.
+ * @return Siatka.
+ */
+RasterGrid RasterGrid::cover(double west, double south, double east, double north, int zoom, int tileSize)
+{
+    const double world = worldSize(zoom);
+    RasterGrid grid;
+    grid.zoom = zoom;
+    grid.tileSize = tileSize;
+    grid.left = qFloor(StationClusterIndex::lonToX(west) * world);
+    grid.top = qFloor(StationClusterIndex::latToY(north) * world);
+    grid.width = qCeil(StationClusterIndex::lonToX(east) * world) - grid.left;
+    grid.height = qCeil(StationClusterIndex::latToY(south) * world) - grid.top;
+    return grid;
+}
+
+/**
+ * @brief Pobiera obszar kafelka.
+ * @param tile Indeks kafelka.
+ * @return Prostokąt w komórkach siatki.
+ */
+QRect RasterGrid::tileRect(int tile) const
+{
+    const int x = (tile % tileColumns()) * tileSize;
+    const int y = (tile / tileColumns()) * tileSize;
+    return QRect(x, y, qMin(tileSize, width - x), qMin(tileSize, height - y));
+}
+
+/**
+ * @brief Pobiera długość geograficzną kolumny.
+ * @param column Kolumna siatki (0.5 to środek pierwszej komórki).
+ * @return Długość geograficzna.
+ */
+double RasterGrid::columnLon(double column) const
+{
+    return StationClusterIndex::xToLon((left + column) / worldSize(zoom));
+}
+
+/**
+ * @brief Pobiera szerokość geograficzną wiersza.
+ * @param row Wiersz siatki (0.5 to środek pierwszej komórki).
+ * @return Szerokość geograficzna.
+ */
+double RasterGrid::rowLat(double row) const
+{
+    return StationClusterIndex::yToLat((top + row) / worldSize(zoom));
+}
+
+/**
+ * @brief Pobiera identyfikator rastra używany w adresach kafelków.
+ * @return Identyfikator zależny od parametru, godziny, metody, skali i pomiarów.
+ */
+QString PollutantRaster::id() const
+{
+    return QString("%1_%2_%3_%4_%5").arg(parameter).arg(hour).arg(method).arg(scale).arg(quint64(digest), 0, 16);
+}
+
+/**
+ * @brief Pobiera wartość pola w punkcie.
+ * @param lat Szerokość geograficzna.
+ * @param lon Długość geograficzna.
+ * @return Wartość komórki lub NaN poza siatką i zasięgiem stacji.
+ */
+double PollutantRaster::valueAt(double lat, double lon) const
+{
+    const double world = worldSize(grid.zoom);
+    const int column = qFloor(StationClusterIndex::lonToX(lon) * world) - grid.left;
+    const int row = qFloor(StationClusterIndex::latToY(lat) * world) - grid.top;
+    if (column < 0 || row < 0 || column >= grid.width || row >= grid.height)
+        return qQNaN();
+    return values.at(row * grid.width + column);
+}
+
+/**
+ * @brief Konstruktor obiektu PollutantRasterEngine.
+ * @param airQuality Źródło najnowszych pomiarów stacji.
+ * @param stations Model wszystkich stacji (współrzędne).
+ * @param parent Rodzic QObject.
+ *
+ * Obliczenia mają jeden wątek: kolejne zlecenia czekają, a nieaktualne są pomijane,
+ * więc liczony jest zawsze tylko najnowszy stan. Równoległość zapewniają kafelki.
+ */
+PollutantRasterEngine::PollutantRasterEngine(AirQualityIndex *airQuality, StationListModel *stations, QObject *parent)
+    : QObject(parent),
+    m_airQuality(airQuality),
+    m_stations(stations)
+{
+    m_pool.setMaxThreadCount(1);
+
+    m_updateTimer.setSingleShot(true);
+    m_updateTimer.setInterval(kUpdateDelayMs);
+    connect(&m_updateTimer, &QTimer::timeout, this, &PollutantRasterEngine::refresh);
+
+    connect(m_airQuality, &AirQualityIndex::readingsChanged, this, [this]() {
+        if (!m_parameter.isEmpty())
+            m_updateTimer.start();
+    });
+    connect(m_airQuality, &AirQualityIndex::scaleChanged, this, &PollutantRasterEngine::refresh);
+}
+
+/**
+ * @brief Destruktor; czeka na zakończenie trwającego obliczenia.
+ *
+ * Zadanie odwołuje się do obiektu przy przekazaniu wyniku, więc nie może go przeżyć.
+ */
+PollutantRasterEngine::~PollutantRasterEngine()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+/**
+ * @brief Wybiera parametr nakładki.
+ * @param parameter Kod zanieczyszczenia lub pusty napis, aby wyłączyć nakładkę.
+ */
+void PollutantRasterEngine::setParameter(const QString &parameter)
+{
+    if (m_parameter == parameter)
+        return;
+    m_parameter = parameter;
+    emit parameterChanged();
+    refresh();
+}
+
+/**
+ * @brief Ustawia metodę interpolacji.
+ * @param method Metoda.
+ */
+void PollutantRasterEngine::setMethod(Method method)
+{
+    if (m_method == method)
+        return;
+    m_method = method;
+    emit methodChanged();
+    refresh();
+}
+
+/**
+ * @brief Tworzy obiekt metody interpolacji.
+ * @param method Metoda.
+ * @return Nowy obiekt interpolacji.
+ */
+std::unique_ptr<FieldInterpolator> PollutantRasterEngine::createInterpolator(Method method)
+{
+    switch (method) {
+    case Kriging:
+        return std::make_unique<KrigingInterpolator>();
+    case InverseDistance:
+        break;
+    }
+    return std::make_unique<InverseDistanceInterpolator>();
+}
+
+/**
+ * @brief Pobiera siatkę obszaru Polski używaną przez nakładkę.
+ * @return Siatka na poziomie kRasterZoom.
+ */
+RasterGrid PollutantRasterEngine::defaultGrid()
+{
+    return RasterGrid::cover(kWest, kSouth, kEast, kNorth, kRasterZoom, kTileSize);
+}
+
+/**
+ * @brief Zbiera najnowsze pomiary parametru ze stacji.
+ * @param parameter Kod zanieczyszczenia.
+ * @param hour Wyjście: godzina pomiarowa najnowszego pomiaru (-1 bez pomiarów).
+ * @return Pomiary uporządkowane według stacji.
+ */
+QList<FieldSample> PollutantRasterEngine::samples(const QString &parameter, qint64 *hour) const
+{
+    const QHash<int, AirQualityReading> readings = m_airQuality->readings(parameter);
+    qint64 newest = -1;
+    for (const AirQualityReading &reading : readings)
+        newest = qMax(newest, reading.timestamp);
+    if (hour)
+        *hour = newest >= 0 ? newest - newest % 3600 : -1;
+
+    QList<FieldSample> result;
+    const qint64 oldest = newest - qint64(AirQualityIndex::kMaxReadingAgeHours) * 3600;
+    for (auto it = readings.cbegin(); it != readings.cend(); ++it) {
+        const int row = m_stations->rowOf(it.key());
+        if (row < 0 || it->timestamp < oldest)
+            continue;
+        result.append({ it.key(), m_stations->lat(row), m_stations->lon(row), it->value });
+    }
+    std::sort(result.begin(), result.end(), [](const FieldSample &a, const FieldSample &b) {
+        return a.stationId < b.stationId;
+    });
+    return result;
+}
+
+/**
+ * @brief Składa klucz pamięci podręcznej.
+ * @param parameter Kod zanieczyszczenia.
+ * @param hour Godzina pomiarowa.
+ * @param method Metoda.
+ * @param scale Skala barw.
+ * @return Klucz.
+ */
+QString PollutantRasterEngine::cacheKey(const QString &parameter, qint64 hour, int method, int scale)
+{
+    return QString("%1_%2_%3_%4").arg(parameter).arg(hour).arg(method).arg(scale);
+}
+
+/**
+ * @brief Wyznacza skrót pomiarów.
+ * @param samples Pomiary stacji (uporządkowane według stacji).
+ * @return Skrót.
+ */
+size_t PollutantRasterEngine::digestOf(const QList<FieldSample> &samples)
+{
+    size_t digest = 0;
+    for (const FieldSample &sample : samples)
+        digest = qHashMulti(digest, sample.stationId, sample.value);
+    return digest;
+}
+
+/**
+ * @brief Wyznacza pole synchronicznie; kafelki liczone są równolegle.
+ * @param parameter Kod zanieczyszczenia.
+ * @param hour Godzina pomiarowa.
+ * @param method Metoda interpolacji.
+ * @param scale Skala barw kafelków.
+ * @param samples Pomiary stacji.
+ * @param grid Geometria siatki.
+ * @return Raster z wartościami i obrazami kafelków.
+ *
+ * Kolor komórki to kolor poziomu indeksu cząstkowego wartości (jak legenda indeksu);
+ * komórki bez wartości są przezroczyste, a kafelki bez żadnej wartości nie mają obrazu.
+ * Każdy kafelek pisze tylko do własnych komórek, więc kafelki nie wymagają synchronizacji.
+ */
+QSharedPointer<PollutantRaster> PollutantRasterEngine::compute(const QString &parameter, qint64 hour, Method method,
+                                                               AirQualityIndex::Scale scale,
+                                                               const QList<FieldSample> &samples, const RasterGrid &grid)
+{
+    MetricsTimer timer("gios_model_build_duration_ms", "model=pollutant_raster");
+    auto raster = QSharedPointer<PollutantRaster>::create();
+    raster->parameter = parameter;
+    raster->hour = hour;
+    raster->method = method;
+    raster->scale = scale;
+    raster->digest = digestOf(samples);
+    raster->sampleCount = samples.size();
+    raster->grid = grid;
+    raster->values.fill(qQNaN(), grid.width * grid.height);
+    raster->tiles.resize(grid.tileCount());
+
+    const std::unique_ptr<FieldInterpolator> interpolator = createInterpolator(method);
+    interpolator->prepare(samples);
+
+    // Kolory poziomów wyznaczane raz, przed podziałem na kafelki
+    QVector<QRgb> colors;
+    for (const QString &name : AirQualityIndex::levelColors(scale)) {
+        QColor color(name);
+        color.setAlpha(kTileAlpha);
+        colors.append(color.rgba());
+    }
+
+    float *values = raster->values.data();
+    QImage *images = raster->tiles.data();
+    QVector<int> tileIndexes(grid.tileCount());
+    std::iota(tileIndexes.begin(), tileIndexes.end(), 0);
+    QtConcurrent::blockingMap(tileIndexes, [&](int tile) {
+        const QRect rect = grid.tileRect(tile);
+        QImage image(rect.size(), QImage::Format_ARGB32);
+        image.fill(Qt::transparent);
+        bool filled = false;
+        for (int y = 0; y < rect.height(); ++y) {
+            const double lat = grid.rowLat(rect.y() + y + 0.5);
+            QRgb *line = reinterpret_cast<QRgb*>(image.scanLine(y));
+            float *row = values + qint64(rect.y() + y) * grid.width + rect.x();
+            for (int x = 0; x < rect.width(); ++x) {
+                const double value = interpolator->estimate(lat, grid.columnLon(rect.x() + x + 0.5));
+                if (qIsNaN(value))
+                    continue;
+                row[x] = float(value);
+                const int level = AirQualityIndex::subIndex(scale, parameter, value);
+                if (level >= 0 && level < colors.size()) {
+                    line[x] = colors.at(level);
+                    filled = true;
+                }
+            }
+        }
+        if (filled)
+            images[tile] = image;
+    });
+    return raster;
+}
+
+/**
+ * @brief Przelicza pole natychmiast (lub bierze je z pamięci podręcznej).
+ *
+ * Trafienie w pamięci podręcznej wymaga także zgodności skrótu pomiarów: w trakcie
+ * przeglądu stacji godzina się nie zmienia, ale przybywa stacji.
+ */
+void PollutantRasterEngine::refresh()
+{
+    m_updateTimer.stop();
+    const quint64 generation = ++m_generation;
+    if (m_parameter.isEmpty()) {
+        setCurrent(nullptr);
+        setBusy(false);
+        return;
+    }
+
+    qint64 hour = -1;
+    const QList<FieldSample> fieldSamples = samples(m_parameter, &hour);
+    if (fieldSamples.isEmpty()) {
+        setCurrent(nullptr);
+        setBusy(false);
+        return;
+    }
+
+    const AirQualityIndex::Scale scale = m_airQuality->scale();
+    const QString key = cacheKey(m_parameter, hour, m_method, scale);
+    QSharedPointer<const PollutantRaster> cached;
+    {
+        QMutexLocker locker(&m_mutex);
+        cached = m_cache.value(key);
+    }
+    if (cached && cached->digest == digestOf(fieldSamples)) {
+        MetricsRegistry::instance().add("gios_raster_cache_total", "result=hit");
+        store(cached);
+        setCurrent(cached);
+        setBusy(false);
+        return;
+    }
+    MetricsRegistry::instance().add("gios_raster_cache_total", "result=miss");
+
+    setBusy(true);
+    const QString parameter = m_parameter;
+    const Method method = m_method;
+    QtConcurrent::run(&m_pool, [this, generation, parameter, hour, method, scale, fieldSamples]() {
+        if (generation != m_generation.load())
+            return; // Zlecenie nieaktualne, czeka już nowsze
+        const QSharedPointer<const PollutantRaster> raster =
+            compute(parameter, hour, method, scale, fieldSamples, defaultGrid());
+        QMetaObject::invokeMethod(this, [this, generation, raster]() {
+            store(raster);
+            if (generation != m_generation.load())
+                return;
+            setCurrent(raster);
+            setBusy(false);
+        }, Qt::QueuedConnection);
+    });
+}
+
+/**
+ * @brief Ustawia bieżące pole.
+ * @param raster Raster lub nullptr.
+ */
+void PollutantRasterEngine::setCurrent(const QSharedPointer<const PollutantRaster> &raster)
+{
+    if (m_current == raster)
+        return;
+    m_current = raster;
+    emit rasterChanged();
+}
+
+/**
+ * @brief Zapisuje raster w pamięci podręcznej (usuwa najdawniej używany).
+ * @param raster Raster.
+ */
+void PollutantRasterEngine::store(const QSharedPointer<const PollutantRaster> &raster)
+{
+    const QString key = cacheKey(raster->parameter, raster->hour, raster->method, raster->scale);
+    QMutexLocker locker(&m_mutex);
+    m_cacheOrder.removeOne(key);
+    m_cacheOrder.append(key);
+    m_cache.insert(key, raster);
+    while (m_cacheOrder.size() > kCacheSize) {
+        const QString oldest = m_cacheOrder.takeFirst();
+        // Bieżące pole zostaje, bo QML może jeszcze pobierać jego kafelki
+        if (m_current && cacheKey(m_current->parameter, m_current->hour, m_current->method, m_current->scale) == oldest) {
+            m_cacheOrder.append(oldest);
+            continue;
+        }
+        m_cache.remove(oldest);
+    }
+}
+
+/**
+ * @brief Ustawia stan obliczania.
+ * @param busy True w trakcie obliczania.
+ */
+void PollutantRasterEngine::setBusy(bool busy)
+{
+    if (m_busy == busy)
+        return;
+    m_busy = busy;
+    emit busyChanged();
+}
+
+/**
+ * @brief Pobiera kafelki bieżącego pola dla QML.
+ * @return Lista map {source, lat, lon, zoom}; współrzędne to lewy górny róg kafelka.
+ */
+QVariantList PollutantRasterEngine::tiles() const
+{
+    QVariantList result;
+    if (!m_current)
+        return result;
+
+    const RasterGrid &grid = m_current->grid;
+    const QString id = m_current->id();
+    for (int tile = 0; tile < m_current->tiles.size(); ++tile) {
+        if (m_current->tiles.at(tile).isNull())
+            continue;
+        const QRect rect = grid.tileRect(tile);
+        QVariantMap entry;
+        entry["source"] = QString("image://%1/%2/%3").arg(kProviderName, id).arg(tile);
+        entry["lat"] = grid.rowLat(rect.y());
+        entry["lon"] = grid.columnLon(rect.x());
+        entry["zoom"] = grid.zoom;
+        result.append(entry);
+    }
+    return result;
+}
+
+/**
+ * @brief Pobiera godzinę pomiarową bieżącego pola.
+ * @return Data lub pusty napis.
+ */
+QString PollutantRasterEngine::hourText() const
+{
+    return m_current ? SensorSeries::formatTimestamp(m_current->hour) : QString();
+}
+
+/**
+ * @brief Pobiera wartość bieżącego pola w punkcie.
+ * @param lat Szerokość geograficzna.
+ * @param lon Długość geograficzna.
+ * @return Wartość lub NaN.
+ */
+double PollutantRasterEngine::valueAt(double lat, double lon) const
+{
+    return m_current ? m_current->valueAt(lat, lon) : qQNaN();
+}
+
+/**
+ * @brief Pobiera obraz kafelka; bezpieczne dla wątków.
+ * @param id Identyfikator "<raster>/<kafelek>".
+ * @return Obraz lub pusty obraz dla nieznanego kafelka.
+ */
+QImage PollutantRasterEngine::tileImage(const QString &id) const
+{
+    const int separator = id.lastIndexOf('/');
+    bool ok = false;
+    const int tile = id.mid(separator + 1).toInt(&ok);
+    if (separator < 0 || !ok)
+        return QImage();
+
+    const QString rasterId = id.left(separator);
+    QMutexLocker locker(&m_mutex);
+    for (const QSharedPointer<const PollutantRaster> &raster : m_cache) {
+        if (raster->id() == rasterId)
+            return tile >= 0 && tile < raster->tiles.size() ? raster->tiles.at(tile) : QImage();
+    }
+    return QImage();
+}
+
+/**
+ * @brief Pobiera liczbę rastrów w pamięci podręcznej.
+ * @return Liczba rastrów.
+ */
+int PollutantRasterEngine::cachedRasters() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_cache.size();
+}
+
+/**
+ * @brief Zwraca obraz kafelka.
+ * @param id Identyfikator kafelka.
+ * @param size Wyjście: rozmiar obrazu.
+ * @param requestedSize Żądany rozmiar (ignorowany; kafelek ma rozmiar komórek siatki).
+ * @return Obraz kafelka.
+ */
+QImage PollutantTileProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+{
+    Q_UNUSED(requestedSize);
+    const QImage image = m_engine->tileImage(id);
+    if (size)
+        *size = image.size();
+    return image;
+}
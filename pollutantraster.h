@@ -0,0 +1,402 @@
+/**
+ * @file pollutantraster.h
+ * @brief Plik nagłówkowy dla klasy PollutantRasterEngine.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje siatkę (raster) stężeń zanieczyszczenia nad Polską wyznaczaną
+ * z najnowszych pomiarów stacji przez interpolację przestrzenną, liczoną równolegle
+ * w kafelkach i wyświetlaną na mapie jako nakładka.
+ */
+
+#ifndef POLLUTANTRASTER_H
+#define POLLUTANTRASTER_H
+
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QQuickImageProvider>
+#include <QRect>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVariantList>
+#include <QVector>
+#include <atomic>
+#include <memory>
+#include "airqualityindex.h"
+#include "fieldinterpolator.h"
+
+class StationListModel;
+
+/**
+ * @struct RasterGrid
+ * @brief Geometria siatki w pikselach odwzorowania Mercatora na stałym poziomie przybliżenia.
+ *
+ * Komórka siatki to piksel mapy na poziomie zoom, więc kafelek wyświetlony jako
+ * MapQuickItem z tym samym poziomem przybliżenia pokrywa się dokładnie z mapą.
+ */
+struct RasterGrid {
+    int zoom = 0;        ///< Poziom przybliżenia siatki.
+    int left = 0;        ///< Lewa krawędź w pikselach świata.
+    int top = 0;         ///< Górna krawędź w pikselach świata.
+    int width = 0;       ///< Szerokość w komórkach.
+    int height = 0;      ///< Wysokość w komórkach.
+    int tileSize = 128;  ///< Bok kafelka w komórkach.
+
+    /**
+     * @brief Wyznacza siatkę pokrywającą prostokąt współrzędnych.
+     * @param west Zachodnia granica (długość geograficzna).
+     * @param south Południowa granica (szerokość geograficzna).
+     * @param east Wschodnia granica (długość geograficzna).
+     * @param north Północna granica (szerokość geograficzna).
+     * @param zoom Poziom przybliżenia.
+     * @param tileSize Bok kafelka w komórkach.
+     * @return Siatka.
+     */
+    static RasterGrid cover(double west, double south, double east, double north, int zoom, int tileSize);
+
+    /**
+     * @brief Pobiera liczbę kolumn kafelków.
+     * @return Liczba kolumn.
+     */
+    int tileColumns() const { return (width + tileSize - 1) / tileSize; }
+
+    /**
+     * @brief Pobiera liczbę kafelków.
+     * @return Liczba kafelków.
+     */
+    int tileCount() const { return tileColumns() * ((height + tileSize - 1) / tileSize); }
+
+    /**
+     * @brief Pobiera obszar kafelka.
+     * @param tile Indeks kafelka.
+     * @return Prostokąt w komórkach siatki (kafelki brzegowe mogą być mniejsze).
+     */
+    QRect tileRect(int tile) const;
+
+    /**
+     * @brief Pobiera długość geograficzną środka kolumny.
+     * @param column Kolumna siatki.
+     * @return Długość geograficzna.
+     */
+    double columnLon(double column) const;
+
+    /**
+     * @brief Pobiera szerokość geograficzną środka wiersza.
+     * @param row Wiersz siatki.
+     * @return Szerokość geograficzna.
+     */
+    double rowLat(double row) const;
+};
+
+/**
+ * @struct PollutantRaster
+ * @brief Wyznaczone pole stężeń jednego parametru z jednej godziny pomiarowej.
+ */
+struct PollutantRaster {
+    QString parameter;                 ///< Kod zanieczyszczenia.
+    qint64 hour = -1;                  ///< Godzina pomiarowa (najnowszy pomiar, pełna godzina).
+    int method = 0;                    ///< Metoda interpolacji (PollutantRasterEngine::Method).
+    int scale = 0;                     ///< Skala barw (AirQualityIndex::Scale).
+    size_t digest = 0;                 ///< Skrót pomiarów wejściowych.
+    int sampleCount = 0;               ///< Liczba stacji wejściowych.
+    RasterGrid grid;                   ///< Geometria siatki.
+    QVector<float> values;             ///< Wartości komórek wierszami (NaN poza zasięgiem stacji).
+    QList<QImage> tiles;               ///< Obrazy kafelków (pusty obraz dla kafelka bez wartości).
+
+    /**
+     * @brief Pobiera identyfikator rastra używany w adresach kafelków.
+     * @return Identyfikator zależny od parametru, godziny, metody, skali i pomiarów.
+     */
+    QString id() const;
+
+    /**
+     * @brief Pobiera wartość pola w punkcie.
+     * @param lat Szerokość geograficzna.
+     * @param lon Długość geograficzna.
+     * @return Wartość komórki lub NaN poza siatką i zasięgiem stacji.
+     */
+    double valueAt(double lat, double lon) const;
+};
+
+/**
+ * @class PollutantRasterEngine
+ * @brief Wyznacza i przechowuje pola stężeń dla nakładki mapy.
+ *
+ * Wejściem są najnowsze pomiary wybranego parametru ze wszystkich stacji zebrane przez
+ * AirQualityIndex. Pole liczone jest w osobnym wątku: kafelki siatki są niezależne,
+ * więc wyznacza je równolegle globalna pula wątków. Gotowe rastry trafiają do pamięci
+ * podręcznej według (parametr, godzina, metoda, skala); powrót do parametru z tej samej
+ * godziny i z tymi samymi pomiarami nie liczy pola ponownie. Nowe pomiary w trakcie
+ * przeglądu stacji są łączone (kUpdateDelayMs) w jedno przeliczenie.
+ */
+class PollutantRasterEngine : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(QString parameter READ parameter WRITE setParameter NOTIFY parameterChanged)
+    Q_PROPERTY(Method method READ method WRITE setMethod NOTIFY methodChanged)
+    Q_PROPERTY(bool busy READ isBusy NOTIFY busyChanged)
+    Q_PROPERTY(QVariantList tiles READ tiles NOTIFY rasterChanged)
+    Q_PROPERTY(QString hour READ hourText NOTIFY rasterChanged)
+    Q_PROPERTY(int sampleCount READ sampleCount NOTIFY rasterChanged)
+    Q_PROPERTY(QStringList parameters READ parameters CONSTANT)
+
+public:
+    /**
+     * @brief Metoda interpolacji.
+     */
+    enum Method {
+        InverseDistance, ///< Odwrotne odległości (IDW), metoda podstawowa.
+        Kriging          ///< Kriging zwyczajny.
+    };
+    Q_ENUM(Method)
+
+    /// Poziom przybliżenia siatki (komórka to piksel mapy na tym poziomie).
+    static constexpr int kRasterZoom = 7;
+
+    /// Bok kafelka w komórkach.
+    static constexpr int kTileSize = 128;
+
+    /// Liczba rastrów w pamięci podręcznej.
+    static constexpr int kCacheSize = 16;
+
+    /// Opóźnienie przeliczenia po nowych pomiarach w ms.
+    static constexpr int kUpdateDelayMs = 500;
+
+    /// Krycie kafelków (0-255).
+    static constexpr int kTileAlpha = 150;
+
+    /**
+     * @brief Konstruktor obiektu PollutantRasterEngine.
+     * @param airQuality Źródło najnowszych pomiarów stacji.
+     * @param stations Model wszystkich stacji (współrzędne).
+     * @param parent Rodzic QObject.
+     */
+    PollutantRasterEngine(AirQualityIndex *airQuality, StationListModel *stations, QObject *parent = nullptr);
+
+    /**
+     * @brief Destruktor; czeka na zakończenie trwającego obliczenia.
+     */
+    ~PollutantRasterEngine() override;
+
+    /**
+     * @brief Pobiera wybrany parametr.
+     * @return Kod zanieczyszczenia lub pusty napis (nakładka wyłączona).
+     */
+    QString parameter() const { return m_parameter; }
+
+    /**
+     * @brief Wybiera parametr nakładki.
+     * @param parameter Kod zanieczyszczenia lub pusty napis, aby wyłączyć nakładkę.
+     */
+    void setParameter(const QString &parameter);
+
+    /**
+     * @brief Pobiera metodę interpolacji.
+     * @return Metoda.
+     */
+    Method method() const { return m_method; }
+
+    /**
+     * @brief Ustawia metodę interpolacji.
+     * @param method Metoda.
+     */
+    void setMethod(Method method);
+
+    /**
+     * @brief Sprawdza, czy trwa obliczanie pola.
+     * @return True w trakcie obliczania.
+     */
+    bool isBusy() const { return m_busy; }
+
+    /**
+     * @brief Pobiera kafelki bieżącego pola dla QML.
+     * @return Lista map {source, lat, lon, zoom} (tylko kafelki z wartościami).
+     */
+    QVariantList tiles() const;
+
+    /**
+     * @brief Pobiera godzinę pomiarową bieżącego pola.
+     * @return Data w formacie SensorSeries::formatTimestamp() lub pusty napis.
+     */
+    QString hourText() const;
+
+    /**
+     * @brief Pobiera liczbę stacji bieżącego pola.
+     * @return Liczba stacji.
+     */
+    int sampleCount() const { return m_current ? m_current->sampleCount : 0; }
+
+    /**
+     * @brief Pobiera parametry dostępne dla nakładki.
+     * @return Kody zanieczyszczeń indeksu jakości powietrza.
+     */
+    QStringList parameters() const { return AirQualityIndex::pollutants(); }
+
+    /**
+     * @brief Pobiera bieżące pole.
+     * @return Raster lub nullptr.
+     */
+    QSharedPointer<const PollutantRaster> raster() const { return m_current; }
+
+    /**
+     * @brief Pobiera wartość bieżącego pola w punkcie.
+     * @param lat Szerokość geograficzna.
+     * @param lon Długość geograficzna.
+     * @return Wartość lub NaN.
+     */
+    Q_INVOKABLE double valueAt(double lat, double lon) const;
+
+    /**
+     * @brief Przelicza pole natychmiast (lub bierze je z pamięci podręcznej).
+     */
+    Q_INVOKABLE void refresh();
+
+    /**
+     * @brief Pobiera obraz kafelka; bezpieczne dla wątków (dostawca obrazów QML).
+     * @param id Identyfikator "<raster>/<kafelek>".
+     * @return Obraz lub pusty obraz dla nieznanego kafelka.
+     */
+    QImage tileImage(const QString &id) const;
+
+    /**
+     * @brief Pobiera liczbę rastrów w pamięci podręcznej.
+     * @return Liczba rastrów.
+     */
+    int cachedRasters() const;
+
+    /**
+     * @brief Zbiera najnowsze pomiary parametru ze stacji.
+     * @param parameter Kod zanieczyszczenia.
+     * @param hour Wyjście: godzina pomiarowa najnowszego pomiaru (-1 bez pomiarów).
+     * @return Pomiary nie starsze niż AirQualityIndex::kMaxReadingAgeHours od najnowszego.
+     */
+    QList<FieldSample> samples(const QString &parameter, qint64 *hour) const;
+
+    /**
+     * @brief Tworzy obiekt metody interpolacji.
+     * @param method Metoda.
+     * @return Nowy obiekt interpolacji.
+     */
+    static std::unique_ptr<FieldInterpolator> createInterpolator(Method method);
+
+    /**
+     * @brief Pobiera siatkę obszaru Polski używaną przez nakładkę.
+     * @return Siatka na poziomie kRasterZoom.
+     */
+    static RasterGrid defaultGrid();
+
+    /**
+     * @brief Wyznacza pole synchronicznie; kafelki liczone są równolegle.
+     * @param parameter Kod zanieczyszczenia.
+     * @param hour Godzina pomiarowa.
+     * @param method Metoda interpolacji.
+     * @param scale Skala barw kafelków.
+     * @param samples Pomiary stacji.
+     * @param grid Geometria siatki.
+     * @return Raster z wartościami i obrazami kafelków.
+     */
+    static QSharedPointer<PollutantRaster> compute(const QString &parameter, qint64 hour, Method method,
+                                                   AirQualityIndex::Scale scale, const QList<FieldSample> &samples,
+                                                   const RasterGrid &grid);
+
+signals:
+    /**
+     * @brief Sygnał emitowany po zmianie parametru.
+     */
+    void parameterChanged();
+
+    /**
+     * @brief Sygnał emitowany po zmianie metody.
+     */
+    void methodChanged();
+
+    /**
+     * @brief Sygnał emitowany po rozpoczęciu lub zakończeniu obliczania.
+     */
+    void busyChanged();
+
+    /**
+     * @brief Sygnał emitowany po zmianie bieżącego pola.
+     */
+    void rasterChanged();
+
+private:
+    /**
+     * @brief Składa klucz pamięci podręcznej.
+     * @param parameter Kod zanieczyszczenia.
+     * @param hour Godzina pomiarowa.
+     * @param method Metoda.
+     * @param scale Skala barw.
+     * @return Klucz.
+     */
+    static QString cacheKey(const QString &parameter, qint64 hour, int method, int scale);
+
+    /**
+     * @brief Wyznacza skrót pomiarów.
+     * @param samples Pomiary stacji.
+     * @return Skrót.
+     */
+    static size_t digestOf(const QList<FieldSample> &samples);
+
+    /**
+     * @brief Ustawia bieżące pole.
+     * @param raster Raster lub nullptr.
+     */
+    void setCurrent(const QSharedPointer<const PollutantRaster> &raster);
+
+    /**
+     * @brief Zapisuje raster w pamięci podręcznej (usuwa najdawniej używany).
+     * @param raster Raster.
+     */
+    void store(const QSharedPointer<const PollutantRaster> &raster);
+
+    /**
+     * @brief Ustawia stan obliczania.
+     * @param busy True w trakcie obliczania.
+     */
+    void setBusy(bool busy);
+
+    AirQualityIndex *m_airQuality;       ///< Źródło pomiarów.
+    StationListModel *m_stations;        ///< Współrzędne stacji.
+    QString m_parameter;                 ///< Wybrany parametr.
+    Method m_method = InverseDistance;   ///< Metoda interpolacji.
+    bool m_busy = false;                 ///< Czy trwa obliczanie.
+    QTimer m_updateTimer;                ///< Łączenie nowych pomiarów w jedno przeliczenie.
+    QThreadPool m_pool;                  ///< Wątek obliczeń (jedno pole naraz).
+    std::atomic<quint64> m_generation{0}; ///< Numer ostatniego zlecenia; starsze są pomijane.
+    QSharedPointer<const PollutantRaster> m_current; ///< Bieżące pole.
+    mutable QMutex m_mutex;              ///< Ochrona pamięci podręcznej (dostęp z dostawcy obrazów).
+    QHash<QString, QSharedPointer<const PollutantRaster>> m_cache; ///< Rastry według klucza.
+    QList<QString> m_cacheOrder;         ///< Klucze od najdawniej użytego.
+};
+
+/**
+ * @class PollutantTileProvider
+ * @brief Dostawca obrazów QML kafelków nakładki ("image://pollution/<raster>/<kafelek>").
+ */
+class PollutantTileProvider : public QQuickImageProvider {
+public:
+    /**
+     * @brief Konstruktor obiektu PollutantTileProvider.
+     * @param engine Silnik pól (musi żyć dłużej niż silnik QML).
+     */
+    explicit PollutantTileProvider(const PollutantRasterEngine *engine)
+        : QQuickImageProvider(QQuickImageProvider::Image), m_engine(engine) {}
+
+    /**
+     * @brief Zwraca obraz kafelka.
+     * @param id Identyfikator kafelka.
+     * @param size Wyjście: rozmiar obrazu.
+     * @param requestedSize Żądany rozmiar (ignorowany).
+     * @return Obraz kafelka.
+     */
+    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
+
+private:
+    const PollutantRasterEngine *m_engine; ///< Silnik pól.
+};
+
+#endif // POLLUTANTRASTER_H
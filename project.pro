@@ -1,29 +1,103 @@
-QT += core gui network qml quick positioning location testlib
+QT += core gui network concurrent qml quick positioning location testlib
 CONFIG += c++17
 
 TARGET = stacje_pomiarowe
 
 SOURCES += \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    apiclient.cpp \
+    requestscheduler.cpp \
+    archivemanifest.cpp \
+    responsecache.cpp \
+    stationlistmodel.cpp \
+    stationviewmodel.cpp \
+    stationspatialindex.cpp \
+    stationclusterindex.cpp \
+    stationclustermodel.cpp \
+    stationsearchindex.cpp \
+    stationsnapshot.cpp \
+    stationarchive.cpp \
+    historystore.cpp \
+    stationmonitor.cpp \
+    stationfetchqueue.cpp \
+    airqualityindex.cpp \
+    fieldinterpolator.cpp \
+    pollutantraster.cpp \
+    stationcomparison.cpp \
+    replyparser.cpp \
+    jsonstreamreader.cpp \
+    metricsregistry.cpp \
+    sensorseries.cpp \
+    sensorstatistics.cpp \
+    seriesrollup.cpp \
+    sensorchart.cpp
 
 HEADERS += \
-    mainwindow.h
+    mainwindow.h \
+    apiclient.h \
+    requestscheduler.h \
+    archivemanifest.h \
+    responsecache.h \
+    stationlistmodel.h \
+    stationviewmodel.h \
+    stationspatialindex.h \
+    stationclusterindex.h \
+    stationclustermodel.h \
+    stationsearchindex.h \
+    stationsnapshot.h \
+    stationarchive.h \
+    historystore.h \
+    stationmonitor.h \
+    stationfetchqueue.h \
+    airqualityindex.h \
+    fieldinterpolator.h \
+    pollutantraster.h \
+    stationcomparison.h \
+    replyparser.h \
+    jsonstreamreader.h \
+    metricsregistry.h \
+    sensorseries.h \
+    sensorstatistics.h \
+    seriesrollup.h \
+    sensorchart.h
 
 RESOURCES += \
     qml.qrc
 
 DISTFILES += \
     StationDialog.qml \
+    DiagnosticsDialog.qml \
+    ComparisonDialog.qml \
     main.qml \
-    project.pro.user
+    project.pro.user \
+    testdata/station_515_20250424_142935.json
 
 # Konfiguracja dla testów jednostkowych
 test {
     TARGET = tst_mainwindow
     SOURCES -= main.cpp
-    SOURCES += tst_mainwindow.cpp
-    HEADERS += mainwindow.h
+    SOURCES += tst_mainwindow.cpp harvester.cpp
+    HEADERS += mainwindow.h harvester.h
     QT += testlib
     CONFIG += testcase
 }
+
+# Program zbierający dane bez interfejsu graficznego (qmake CONFIG+=harvester)
+harvester {
+    TARGET = gios_harvester
+    QT -= gui qml quick positioning location testlib
+    CONFIG += console
+    CONFIG -= app_bundle
+    SOURCES -= main.cpp mainwindow.cpp stationlistmodel.cpp stationviewmodel.cpp stationspatialindex.cpp \
+               stationclusterindex.cpp stationclustermodel.cpp \
+               stationsearchindex.cpp stationmonitor.cpp airqualityindex.cpp \
+               fieldinterpolator.cpp pollutantraster.cpp stationcomparison.cpp sensorchart.cpp
+    HEADERS -= mainwindow.h stationlistmodel.h stationviewmodel.h stationspatialindex.h \
+               stationclusterindex.h stationclustermodel.h \
+               stationsearchindex.h stationmonitor.h airqualityindex.h \
+               fieldinterpolator.h pollutantraster.h stationcomparison.h sensorchart.h
+    SOURCES += harvester_main.cpp harvester.cpp
+    HEADERS += harvester.h
+    RESOURCES -= qml.qrc
+}
@@ -0,0 +1,450 @@
+/**
+ * @file replyparser.cpp
+ * @brief Implementacja klasy ReplyParser.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera parsowanie odpowiedzi API GIOŚ i plików archiwalnych w wątkach roboczych
+ * oraz przyrostowy odczyt katalogu stacji i pomiarów z fragmentów odpowiedzi.
+ */
+
+#include "replyparser.h"
+#include "metricsregistry.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtConcurrent/QtConcurrentRun>
+
+namespace {
+/// Histogram czasów parsowania odpowiedzi (dla strumieni: suma czasu wszystkich fragmentów).
+const QString kParseMetric = QStringLiteral("gios_parse_duration_ms");
+}
+
+/**
+ * @brief Konstruktor obiektu StationCatalogStream.
+ */
+StationCatalogStream::StationCatalogStream()
+    : m_reader(this)
+{
+}
+
+/**
+ * @brief Kończy odpowiedź.
+ * @return True, jeśli odpowiedź była kompletna i poprawna.
+ */
+bool StationCatalogStream::finish()
+{
+    return m_reader.finish();
+}
+
+/**
+ * @brief Pobiera rekordy zakończone od poprzedniego wywołania.
+ * @return Nowe rekordy katalogu.
+ */
+QList<StationRecord> StationCatalogStream::takeCompleted()
+{
+    const QList<StationRecord> completed = m_records.mid(m_taken);
+    m_taken = m_records.size();
+    return completed;
+}
+
+/**
+ * @brief Obsługuje początek obiektu.
+ *
+ * Głębokość 2 to element tablicy katalogu, głębokość 3 to jego obiekt zagnieżdżony.
+ */
+void StationCatalogStream::startObject()
+{
+    ++m_depth;
+    if (m_depth == 2)
+        m_current = StationRecord();
+    else if (m_depth == 3)
+        m_section = m_key;
+}
+
+/**
+ * @brief Obsługuje koniec obiektu; zamknięty element tablicy staje się rekordem.
+ */
+void StationCatalogStream::endObject()
+{
+    if (m_depth == 2)
+        m_records.append(m_current);
+    else if (m_depth == 3)
+        m_section.clear();
+    --m_depth;
+}
+
+/**
+ * @brief Obsługuje wartość prostą.
+ * @param value Wartość pola.
+ *
+ * Współrzędne w API są tekstem, ale akceptowane są także liczby.
+ */
+void StationCatalogStream::value(const QJsonValue &value)
+{
+    if (m_depth == 2) {
+        if (m_key == QLatin1String("id"))
+            m_current.stationId = value.toInt();
+        else if (m_key == QLatin1String("stationName"))
+            m_current.stationName = value.toString();
+        else if (m_key == QLatin1String("addressStreet"))
+            m_current.address = value.toString();
+        else if (m_key == QLatin1String("gegrLat"))
+            m_current.lat = value.isString() ? value.toString().toDouble() : value.toDouble();
+        else if (m_key == QLatin1String("gegrLon"))
+            m_current.lon = value.isString() ? value.toString().toDouble() : value.toDouble();
+    } else if (m_depth == 3 && m_section == QLatin1String("city") && m_key == QLatin1String("name")) {
+        m_current.cityName = value.toString();
+    }
+}
+
+/**
+ * @brief Konstruktor obiektu SensorSeriesStream.
+ */
+SensorSeriesStream::SensorSeriesStream()
+    : m_reader(this)
+{
+}
+
+/**
+ * @brief Kończy odpowiedź i porządkuje szereg według czasu.
+ * @return True, jeśli odpowiedź była kompletna i poprawna.
+ */
+bool SensorSeriesStream::finish()
+{
+    m_series.sortByTime();
+    return m_reader.finish();
+}
+
+/**
+ * @brief Obsługuje początek obiektu; głębokość 3 w tablicy "values" to pomiar.
+ */
+void SensorSeriesStream::startObject()
+{
+    ++m_depth;
+    if (m_depth == 3 && m_inValues) {
+        m_date.clear();
+        m_value = 0.0;
+        m_isNull = true;
+    }
+}
+
+/**
+ * @brief Obsługuje koniec obiektu; zamknięty pomiar trafia do szeregu.
+ *
+ * Daty parsowane są raz, przy wczytaniu; puste pomiary trafiają do mapy bitowej.
+ */
+void SensorSeriesStream::endObject()
+{
+    if (m_depth == 3 && m_inValues) {
+        bool ok = false;
+        const qint64 timestamp = SensorSeries::parseTimestamp(m_date, &ok);
+        if (ok)
+            m_series.append(timestamp, m_value, m_isNull);
+    }
+    --m_depth;
+}
+
+/**
+ * @brief Obsługuje początek tablicy.
+ */
+void SensorSeriesStream::startArray()
+{
+    ++m_depth;
+    if (m_depth == 2 && m_key == QLatin1String("values"))
+        m_inValues = true;
+}
+
+/**
+ * @brief Obsługuje koniec tablicy.
+ */
+void SensorSeriesStream::endArray()
+{
+    if (m_depth == 2)
+        m_inValues = false;
+    --m_depth;
+}
+
+/**
+ * @brief Obsługuje wartość prostą.
+ * @param value Wartość pola.
+ */
+void SensorSeriesStream::value(const QJsonValue &value)
+{
+    if (m_depth != 3 || !m_inValues)
+        return;
+
+    if (m_key == QLatin1String("date")) {
+        m_date = value.toString();
+    } else if (m_key == QLatin1String("value") && value.isDouble()) {
+        m_value = value.toDouble();
+        m_isNull = false;
+    }
+}
+
+/**
+ * @brief Konstruktor obiektu ReplyParser.
+ * @param parent Rodzic QObject.
+ *
+ * Pula ma co najmniej dwa wątki, aby katalog stacji nie blokował pomiarów sensorów.
+ * Strumienie mają jeden wątek, dzięki czemu fragmenty każdej odpowiedzi są przetwarzane
+ * w kolejności nadejścia.
+ */
+ReplyParser::ReplyParser(QObject *parent)
+    : QObject(parent),
+    m_streamContext(new QObject)
+{
+    m_pool.setMaxThreadCount(qMax(2, QThread::idealThreadCount() - 1));
+
+    m_streamContext->moveToThread(&m_streamThread);
+    connect(&m_streamThread, &QThread::finished, m_streamContext, &QObject::deleteLater);
+    m_streamThread.setObjectName("ReplyParser streams");
+    m_streamThread.start();
+}
+
+/**
+ * @brief Destruktor; czeka na zakończenie rozpoczętych zadań.
+ *
+ * Zadania emitują sygnały tego obiektu, więc nie mogą go przeżyć.
+ */
+ReplyParser::~ReplyParser()
+{
+    m_streamThread.quit();
+    m_streamThread.wait();
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+/**
+ * @brief Zleca parsowanie katalogu stacji.
+ * @param body Treść odpowiedzi findAll.
+ * @param fromCache True, jeśli odpowiedź pochodzi z pamięci podręcznej.
+ */
+void ReplyParser::parseStations(const QByteArray &body, bool fromCache)
+{
+    QtConcurrent::run(&m_pool, [this, body, fromCache]() {
+        StationCatalogResult result;
+        {
+            MetricsTimer timer(kParseMetric, "kind=stations");
+            result.records = stationsFromJson(body, &result.complete);
+        }
+        result.fromCache = fromCache;
+        emit stationsParsed(result);
+    });
+}
+
+/**
+ * @brief Zleca parsowanie listy sensorów stacji.
+ * @param body Treść odpowiedzi station/sensors.
+ * @param requestId Numer żądania przekazywany w wyniku.
+ */
+void ReplyParser::parseSensors(const QByteArray &body, quint64 requestId)
+{
+    QtConcurrent::run(&m_pool, [this, body, requestId]() {
+        SensorListResult result;
+        result.requestId = requestId;
+        {
+            MetricsTimer timer(kParseMetric, "kind=sensors");
+            result.sensors = sensorsFromJson(body);
+        }
+        emit sensorsParsed(result);
+    });
+}
+
+/**
+ * @brief Zleca parsowanie pomiarów sensora.
+ * @param body Treść odpowiedzi data/getData.
+ * @param sensorId Identyfikator sensora.
+ */
+void ReplyParser::parseSensorData(const QByteArray &body, int sensorId)
+{
+    QtConcurrent::run(&m_pool, [this, body, sensorId]() {
+        SensorDataResult result;
+        result.sensorId = sensorId;
+        {
+            MetricsTimer timer(kParseMetric, "kind=sensor_data");
+            result.series = seriesFromJson(body, &result.complete);
+        }
+        emit sensorDataParsed(result);
+    });
+}
+
+/**
+ * @brief Zleca wczytanie pliku archiwalnego.
+ * @param path Ścieżka pliku.
+ * @param requestId Numer żądania przekazywany w wyniku.
+ */
+void ReplyParser::loadArchive(const QString &path, quint64 requestId)
+{
+    QtConcurrent::run(&m_pool, [this, path, requestId]() {
+        ArchiveLoadResult result;
+        result.requestId = requestId;
+        result.path = path;
+        result.ok = StationArchive::load(path, result.data);
+        emit archiveLoaded(result);
+    });
+}
+
+/**
+ * @brief Otwiera strumień katalogu stacji.
+ * @return Identyfikator strumienia.
+ */
+quint64 ReplyParser::beginStations()
+{
+    const quint64 streamId = ++m_nextStreamId;
+    QMetaObject::invokeMethod(m_streamContext, [this, streamId]() {
+        m_stationStreams.insert(streamId, QSharedPointer<StationCatalogStream>::create());
+    }, Qt::QueuedConnection);
+    return streamId;
+}
+
+/**
+ * @brief Otwiera strumień pomiarów sensora.
+ * @param sensorId Identyfikator sensora.
+ * @param requestId Numer żądania przekazywany w wyniku.
+ * @return Identyfikator strumienia.
+ */
+quint64 ReplyParser::beginSensorData(int sensorId, quint64 requestId)
+{
+    const quint64 streamId = ++m_nextStreamId;
+    QMetaObject::invokeMethod(m_streamContext, [this, streamId, sensorId, requestId]() {
+        m_seriesStreams.insert(streamId, QSharedPointer<SensorSeriesStream>::create());
+        m_seriesSensors.insert(streamId, qMakePair(sensorId, requestId));
+    }, Qt::QueuedConnection);
+    return streamId;
+}
+
+/**
+ * @brief Przekazuje kolejny fragment odpowiedzi do strumienia.
+ * @param streamId Identyfikator strumienia.
+ * @param chunk Fragment odpowiedzi.
+ *
+ * Stacje z elementów zamkniętych w tym fragmencie są emitowane od razu, więc pierwsze
+ * stacje trafiają na mapę przed końcem pobierania.
+ */
+void ReplyParser::feed(quint64 streamId, const QByteArray &chunk)
+{
+    QMetaObject::invokeMethod(m_streamContext, [this, streamId, chunk]() {
+        QElapsedTimer timer;
+        timer.start();
+        if (const QSharedPointer<StationCatalogStream> stream = m_stationStreams.value(streamId)) {
+            stream->feed(chunk);
+            const QList<StationRecord> completed = stream->takeCompleted();
+            if (!completed.isEmpty())
+                emit stationsStreamed(completed);
+        } else if (const QSharedPointer<SensorSeriesStream> stream = m_seriesStreams.value(streamId)) {
+            stream->feed(chunk);
+        } else {
+            return;
+        }
+        m_streamNanos[streamId] += timer.nsecsElapsed();
+    }, Qt::QueuedConnection);
+}
+
+/**
+ * @brief Zamyka strumień i emituje pełny wynik.
+ * @param streamId Identyfikator strumienia.
+ * @param fromCache True, jeśli odpowiedź pochodzi z pamięci podręcznej.
+ *
+ * Do metryk trafia łączny czas parsowania wszystkich fragmentów, bez czasu oczekiwania na sieć.
+ */
+void ReplyParser::finish(quint64 streamId, bool fromCache)
+{
+    QMetaObject::invokeMethod(m_streamContext, [this, streamId, fromCache]() {
+        QElapsedTimer timer;
+        timer.start();
+        const qint64 fedNanos = m_streamNanos.take(streamId);
+        if (const QSharedPointer<StationCatalogStream> stream = m_stationStreams.take(streamId)) {
+            StationCatalogResult result;
+            result.complete = stream->finish();
+            MetricsRegistry::instance().observe(kParseMetric, "kind=stations", (fedNanos + timer.nsecsElapsed()) / 1e6);
+            if (!result.complete)
+                qWarning() << "Niepoprawny katalog stacji:" << stream->errorString();
+            result.records = stream->records();
+            result.fromCache = fromCache;
+            emit stationsParsed(result);
+        } else if (const QSharedPointer<SensorSeriesStream> stream = m_seriesStreams.take(streamId)) {
+            SensorDataResult result;
+            result.complete = stream->finish();
+            if (!result.complete)
+                qWarning() << "Niepoprawne pomiary sensora:" << stream->errorString();
+            MetricsRegistry::instance().observe(kParseMetric, "kind=sensor_data", (fedNanos + timer.nsecsElapsed()) / 1e6);
+            const QPair<int, quint64> sensor = m_seriesSensors.take(streamId);
+            result.sensorId = sensor.first;
+            result.requestId = sensor.second;
+            result.series = std::move(stream->series());
+            emit sensorDataParsed(result);
+        }
+    }, Qt::QueuedConnection);
+}
+
+/**
+ * @brief Zamyka strumień bez emitowania wyniku (np. po błędzie sieci).
+ * @param streamId Identyfikator strumienia.
+ */
+void ReplyParser::abort(quint64 streamId)
+{
+    QMetaObject::invokeMethod(m_streamContext, [this, streamId]() {
+        m_stationStreams.remove(streamId);
+        m_seriesStreams.remove(streamId);
+        m_seriesSensors.remove(streamId);
+        m_streamNanos.remove(streamId);
+    }, Qt::QueuedConnection);
+}
+
+/**
+ * @brief Odczytuje katalog stacji z treści odpowiedzi.
+ * @param body Treść odpowiedzi findAll.
+ * @param ok Opcjonalnie: czy treść była kompletna i poprawna.
+ * @return Rekordy katalogu.
+ */
+QList<StationRecord> ReplyParser::stationsFromJson(const QByteArray &body, bool *ok)
+{
+    StationCatalogStream stream;
+    stream.feed(body);
+    const bool complete = stream.finish();
+    if (ok)
+        *ok = complete;
+    return stream.records();
+}
+
+/**
+ * @brief Odczytuje listę sensorów z treści odpowiedzi.
+ * @param body Treść odpowiedzi station/sensors.
+ * @return Sensory stacji.
+ */
+QList<SensorInfo> ReplyParser::sensorsFromJson(const QByteArray &body)
+{
+    const QJsonArray sensors = QJsonDocument::fromJson(body).array();
+
+    QList<SensorInfo> result;
+    result.reserve(sensors.size());
+    for (const QJsonValue &sensorValue : sensors) {
+        const QJsonObject obj = sensorValue.toObject();
+        const QJsonObject param = obj["param"].toObject();
+        SensorInfo info;
+        info.sensorId = obj["id"].toInt();
+        info.paramName = param["paramName"].toString();
+        info.paramCode = param["paramCode"].toString();
+        result.append(info);
+    }
+    return result;
+}
+
+/**
+ * @brief Odczytuje pomiary sensora z treści odpowiedzi.
+ * @param body Treść odpowiedzi data/getData.
+ * @param ok Opcjonalnie: false, jeśli treść była niepełna lub niepoprawna.
+ * @return Szereg uporządkowany rosnąco według czasu.
+ */
+SensorSeries ReplyParser::seriesFromJson(const QByteArray &body, bool *ok)
+{
+    SensorSeriesStream stream;
+    stream.feed(body);
+    const bool complete = stream.finish();
+    if (ok)
+        *ok = complete;
+    return std::move(stream.series());
+}
@@ -0,0 +1,376 @@
+/**
+ * @file replyparser.h
+ * @brief Plik nagłówkowy dla klasy ReplyParser i struktur wyników parsowania.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje etap parsowania odpowiedzi API i plików archiwalnych
+ * wykonywany w puli wątków roboczych.
+ */
+
+#ifndef REPLYPARSER_H
+#define REPLYPARSER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QList>
+#include <QPair>
+#include <QHash>
+#include <QSharedPointer>
+#include <QString>
+#include <QThread>
+#include <QThreadPool>
+#include "jsonstreamreader.h"
+#include "sensorseries.h"
+#include "stationarchive.h"
+#include "stationsnapshot.h"
+
+/**
+ * @struct StationCatalogResult
+ * @brief Katalog stacji odczytany z odpowiedzi findAll.
+ */
+struct StationCatalogResult {
+    QList<StationRecord> records;   ///< Rekordy katalogu.
+    bool fromCache = false;         ///< True, jeśli odpowiedź pochodziła z pamięci podręcznej.
+    bool complete = true;           ///< False, jeśli treść była niepełna lub niepoprawna.
+};
+
+/**
+ * @struct SensorInfo
+ * @brief Opis sensora stacji.
+ */
+struct SensorInfo {
+    int sensorId = 0;    ///< Identyfikator sensora.
+    QString paramName;   ///< Nazwa parametru.
+    QString paramCode;   ///< Kod parametru (np. "PM10").
+};
+
+/**
+ * @struct SensorListResult
+ * @brief Lista sensorów stacji odczytana z odpowiedzi API.
+ */
+struct SensorListResult {
+    quint64 requestId = 0;       ///< Numer żądania, dla którego wykonano parsowanie.
+    QList<SensorInfo> sensors;   ///< Sensory stacji.
+};
+
+/**
+ * @struct SensorDataResult
+ * @brief Szereg pomiarów sensora odczytany z odpowiedzi API.
+ */
+struct SensorDataResult {
+    quint64 requestId = 0; ///< Numer żądania przekazany przy otwarciu strumienia.
+    int sensorId = 0;      ///< Identyfikator sensora.
+    SensorSeries series;   ///< Pomiary uporządkowane rosnąco według czasu.
+    bool complete = true;  ///< False, jeśli treść była niepełna lub niepoprawna (szereg częściowy).
+};
+
+/**
+ * @struct ArchiveLoadResult
+ * @brief Zawartość pliku archiwalnego wczytana w tle.
+ */
+struct ArchiveLoadResult {
+    quint64 requestId = 0;     ///< Numer żądania, dla którego wczytano plik.
+    QString path;              ///< Ścieżka pliku.
+    bool ok = false;           ///< Czy plik został poprawnie wczytany.
+    StationArchiveData data;   ///< Dane stacji.
+};
+
+/**
+ * @class StationCatalogStream
+ * @brief Przyrostowy odczyt katalogu stacji z odpowiedzi findAll.
+ *
+ * Rekord stacji powstaje w chwili zamknięcia obiektu elementu tablicy; pola spoza
+ * katalogu (np. gmina, powiat) są pomijane bez budowy drzewa dokumentu.
+ */
+class StationCatalogStream : private JsonStreamHandler {
+public:
+    /**
+     * @brief Konstruktor obiektu StationCatalogStream.
+     */
+    StationCatalogStream();
+
+    /**
+     * @brief Przetwarza kolejny fragment odpowiedzi.
+     * @param chunk Fragment odpowiedzi.
+     * @return False, jeśli odpowiedź jest niepoprawna.
+     */
+    bool feed(const QByteArray &chunk) { return m_reader.feed(chunk); }
+
+    /**
+     * @brief Kończy odpowiedź.
+     * @return True, jeśli odpowiedź była kompletna i poprawna.
+     */
+    bool finish();
+
+    /**
+     * @brief Pobiera rekordy zakończone od poprzedniego wywołania.
+     * @return Nowe rekordy katalogu.
+     */
+    QList<StationRecord> takeCompleted();
+
+    /**
+     * @brief Pobiera wszystkie odczytane rekordy.
+     * @return Rekordy katalogu w kolejności odpowiedzi.
+     */
+    const QList<StationRecord> &records() const { return m_records; }
+
+    /**
+     * @brief Pobiera opis błędu odczytu.
+     * @return Opis błędu; pusty, jeśli błędu nie było.
+     */
+    QString errorString() const { return m_reader.errorString(); }
+
+private:
+    void startObject() override;
+    void endObject() override;
+    void startArray() override { ++m_depth; }
+    void endArray() override { --m_depth; }
+    void key(const QString &name) override { m_key = name; }
+    void value(const QJsonValue &value) override;
+
+    JsonStreamReader m_reader;        ///< Czytnik JSON.
+    QList<StationRecord> m_records;   ///< Odczytane rekordy.
+    qsizetype m_taken = 0;            ///< Liczba rekordów pobranych przez takeCompleted().
+    StationRecord m_current;          ///< Rekord bieżącego elementu.
+    QString m_key;                    ///< Ostatni klucz.
+    QString m_section;                ///< Klucz zagnieżdżonego obiektu elementu (np. "city").
+    int m_depth = 0;                  ///< Głębokość zagnieżdżenia.
+};
+
+/**
+ * @class SensorSeriesStream
+ * @brief Przyrostowy odczyt pomiarów sensora z odpowiedzi data/getData.
+ *
+ * Pomiar trafia do szeregu w chwili zamknięcia obiektu elementu tablicy "values".
+ */
+class SensorSeriesStream : private JsonStreamHandler {
+public:
+    /**
+     * @brief Konstruktor obiektu SensorSeriesStream.
+     */
+    SensorSeriesStream();
+
+    /**
+     * @brief Przetwarza kolejny fragment odpowiedzi.
+     * @param chunk Fragment odpowiedzi.
+     * @return False, jeśli odpowiedź jest niepoprawna.
+     */
+    bool feed(const QByteArray &chunk) { return m_reader.feed(chunk); }
+
+    /**
+     * @brief Kończy odpowiedź i porządkuje szereg według czasu.
+     * @return True, jeśli odpowiedź była kompletna i poprawna.
+     */
+    bool finish();
+
+    /**
+     * @brief Pobiera odczytany szereg.
+     * @return Szereg pomiarów (uporządkowany po wywołaniu finish()).
+     */
+    SensorSeries &series() { return m_series; }
+
+    /**
+     * @brief Pobiera opis błędu odczytu.
+     * @return Opis błędu; pusty, jeśli błędu nie było.
+     */
+    QString errorString() const { return m_reader.errorString(); }
+
+private:
+    void startObject() override;
+    void endObject() override;
+    void startArray() override;
+    void endArray() override;
+    void key(const QString &name) override { m_key = name; }
+    void value(const QJsonValue &value) override;
+
+    JsonStreamReader m_reader;   ///< Czytnik JSON.
+    SensorSeries m_series;       ///< Odczytany szereg.
+    QString m_key;               ///< Ostatni klucz.
+    QString m_date;              ///< Data bieżącego pomiaru.
+    double m_value = 0.0;        ///< Wartość bieżącego pomiaru.
+    bool m_isNull = true;        ///< Czy bieżący pomiar jest pusty.
+    bool m_inValues = false;     ///< Czy czytnik jest wewnątrz tablicy "values".
+    int m_depth = 0;             ///< Głębokość zagnieżdżenia.
+};
+
+/**
+ * @class ReplyParser
+ * @brief Parsowanie odpowiedzi API i plików archiwalnych w puli wątków.
+ *
+ * Metody parse*() i loadArchive() wracają natychmiast; dekodowanie JSON, parsowanie dat
+ * i budowa struktur wyników odbywa się w wątku roboczym, a wynik trafia do wątku GUI
+ * sygnałem w połączeniu kolejkowanym. Struktury wyników opierają się na kontenerach
+ * współdzielonych niejawnie, więc przekazanie ich między wątkami nie kopiuje danych.
+ *
+ * Odpowiedzi pobierane strumieniowo przetwarzane są fragment po fragmencie (begin*(), feed(),
+ * finish()) w osobnym wątku, w kolejności nadejścia fragmentów; stan strumieni jest
+ * dostępny wyłącznie z tego wątku.
+ */
+class ReplyParser : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Konstruktor obiektu ReplyParser.
+     * @param parent Rodzic QObject.
+     */
+    explicit ReplyParser(QObject *parent = nullptr);
+
+    /**
+     * @brief Destruktor; czeka na zakończenie rozpoczętych zadań.
+     */
+    ~ReplyParser() override;
+
+    /**
+     * @brief Zleca parsowanie katalogu stacji.
+     * @param body Treść odpowiedzi findAll.
+     * @param fromCache True, jeśli odpowiedź pochodzi z pamięci podręcznej.
+     */
+    void parseStations(const QByteArray &body, bool fromCache);
+
+    /**
+     * @brief Zleca parsowanie listy sensorów stacji.
+     * @param body Treść odpowiedzi station/sensors.
+     * @param requestId Numer żądania przekazywany w wyniku.
+     */
+    void parseSensors(const QByteArray &body, quint64 requestId);
+
+    /**
+     * @brief Zleca parsowanie pomiarów sensora.
+     * @param body Treść odpowiedzi data/getData.
+     * @param sensorId Identyfikator sensora.
+     */
+    void parseSensorData(const QByteArray &body, int sensorId);
+
+    /**
+     * @brief Zleca wczytanie pliku archiwalnego.
+     * @param path Ścieżka pliku.
+     * @param requestId Numer żądania przekazywany w wyniku.
+     */
+    void loadArchive(const QString &path, quint64 requestId);
+
+    /**
+     * @brief Otwiera strumień katalogu stacji.
+     * @return Identyfikator strumienia.
+     */
+    quint64 beginStations();
+
+    /**
+     * @brief Otwiera strumień pomiarów sensora.
+     * @param sensorId Identyfikator sensora.
+     * @param requestId Numer żądania przekazywany w wyniku.
+     * @return Identyfikator strumienia.
+     */
+    quint64 beginSensorData(int sensorId, quint64 requestId = 0);
+
+    /**
+     * @brief Przekazuje kolejny fragment odpowiedzi do strumienia.
+     * @param streamId Identyfikator strumienia.
+     * @param chunk Fragment odpowiedzi.
+     */
+    void feed(quint64 streamId, const QByteArray &chunk);
+
+    /**
+     * @brief Zamyka strumień i emituje pełny wynik.
+     * @param streamId Identyfikator strumienia.
+     * @param fromCache True, jeśli odpowiedź pochodzi z pamięci podręcznej.
+     */
+    void finish(quint64 streamId, bool fromCache);
+
+    /**
+     * @brief Zamyka strumień bez emitowania wyniku (np. po błędzie sieci).
+     * @param streamId Identyfikator strumienia.
+     */
+    void abort(quint64 streamId);
+
+    /**
+     * @brief Czeka na zakończenie wszystkich zleconych zadań.
+     * @param msecs Limit czasu w ms (-1 bez limitu).
+     * @return True, jeśli wszystkie zadania się zakończyły.
+     */
+    bool waitForDone(int msecs = -1) { return m_pool.waitForDone(msecs); }
+
+    /**
+     * @brief Nadaje numer żądania niepowtarzalny w obrębie parsera.
+     * @return Numer żądania.
+     *
+     * Obiekty korzystające ze wspólnego parsera rozpoznają po nim swoje wyniki.
+     * Wywoływana wyłącznie z wątku GUI.
+     */
+    quint64 nextRequestId() { return ++m_nextRequestId; }
+
+    /**
+     * @brief Odczytuje katalog stacji z treści odpowiedzi.
+     * @param body Treść odpowiedzi findAll.
+     * @param ok Opcjonalnie: czy treść była kompletna i poprawna.
+     * @return Rekordy katalogu.
+     */
+    static QList<StationRecord> stationsFromJson(const QByteArray &body, bool *ok = nullptr);
+
+    /**
+     * @brief Odczytuje listę sensorów z treści odpowiedzi.
+     * @param body Treść odpowiedzi station/sensors.
+     * @return Sensory stacji.
+     */
+    static QList<SensorInfo> sensorsFromJson(const QByteArray &body);
+
+    /**
+     * @brief Odczytuje pomiary sensora z treści odpowiedzi.
+     * @param body Treść odpowiedzi data/getData.
+     * @param ok Opcjonalnie: false, jeśli treść była niepełna lub niepoprawna.
+     * @return Szereg uporządkowany rosnąco według czasu.
+     */
+    static SensorSeries seriesFromJson(const QByteArray &body, bool *ok = nullptr);
+
+signals:
+    /**
+     * @brief Sygnał emitowany, gdy strumień katalogu odczytał kolejne stacje.
+     * @param records Stacje z elementów zakończonych w ostatnim fragmencie.
+     */
+    void stationsStreamed(const QList<StationRecord> &records);
+
+    /**
+     * @brief Sygnał emitowany po odczytaniu katalogu stacji.
+     * @param result Katalog stacji.
+     */
+    void stationsParsed(const StationCatalogResult &result);
+
+    /**
+     * @brief Sygnał emitowany po odczytaniu listy sensorów.
+     * @param result Lista sensorów.
+     */
+    void sensorsParsed(const SensorListResult &result);
+
+    /**
+     * @brief Sygnał emitowany po odczytaniu pomiarów sensora.
+     * @param result Pomiary sensora.
+     */
+    void sensorDataParsed(const SensorDataResult &result);
+
+    /**
+     * @brief Sygnał emitowany po wczytaniu pliku archiwalnego.
+     * @param result Zawartość pliku.
+     */
+    void archiveLoaded(const ArchiveLoadResult &result);
+
+private:
+    QThreadPool m_pool;          ///< Pula wątków roboczych parsowania.
+    QThread m_streamThread;      ///< Wątek strumieni odpowiedzi.
+    QObject *m_streamContext;    ///< Obiekt kontekstu w wątku strumieni.
+    quint64 m_nextStreamId = 0;  ///< Ostatni nadany identyfikator strumienia.
+    quint64 m_nextRequestId = 0; ///< Ostatni nadany numer żądania.
+
+    // Stan strumieni; dostępny wyłącznie z wątku strumieni
+    QHash<quint64, QSharedPointer<StationCatalogStream>> m_stationStreams;  ///< Strumienie katalogu.
+    QHash<quint64, QSharedPointer<SensorSeriesStream>> m_seriesStreams;     ///< Strumienie pomiarów.
+    QHash<quint64, QPair<int, quint64>> m_seriesSensors;                    ///< Sensor i numer żądania strumienia pomiarów.
+    QHash<quint64, qint64> m_streamNanos;                                   ///< Czas parsowania dotychczasowych fragmentów strumienia w ns.
+};
+
+Q_DECLARE_METATYPE(StationCatalogResult)
+Q_DECLARE_METATYPE(SensorListResult)
+Q_DECLARE_METATYPE(SensorDataResult)
+Q_DECLARE_METATYPE(ArchiveLoadResult)
+
+#endif // REPLYPARSER_H
@@ -0,0 +1,313 @@
+/**
+ * @file requestscheduler.cpp
+ * @brief Implementacja klasy RequestScheduler.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera szeregowanie żądań sieciowych: wybór żądania o najwyższym priorytecie,
+ * kubełki żetonów dla hostów, ponawianie z losowym opóźnieniem i unieważnianie grup.
+ */
+
+#include "requestscheduler.h"
+#include <QDebug>
+#include <QRandomGenerator>
+#include <QtMath>
+
+/**
+ * @brief Konstruktor obiektu RequestScheduler.
+ * @param manager Menedżer sieci wysyłający żądania.
+ * @param parent Rodzic QObject.
+ */
+RequestScheduler::RequestScheduler(QNetworkAccessManager *manager, QObject *parent)
+    : QObject(parent),
+    m_manager(manager)
+{
+    m_clock.start();
+    m_wakeTimer.setSingleShot(true);
+    connect(&m_wakeTimer, &QTimer::timeout, this, &RequestScheduler::schedule);
+}
+
+/**
+ * @brief Ustawia limity dla hosta.
+ * @param host Nazwa hosta (np. "api.gios.gov.pl").
+ * @param policy Limity hosta.
+ *
+ * Kubełek hosta jest napełniany do pełna, więc nowe limity obowiązują od razu.
+ */
+void RequestScheduler::setHostPolicy(const QString &host, const HostPolicy &policy)
+{
+    m_policies.insert(host, policy);
+    HostState &state = hostState(host);
+    state.policy = policy;
+    state.tokens = policy.burst;
+    state.refilledAtMs = m_clock.elapsed();
+    schedule();
+}
+
+/**
+ * @brief Pobiera limity hosta.
+ * @param host Nazwa hosta.
+ * @return Limity hosta lub limity domyślne.
+ */
+HostPolicy RequestScheduler::hostPolicy(const QString &host) const
+{
+    return m_policies.value(host, HostPolicy());
+}
+
+/**
+ * @brief Ustawia zasady ponawiania.
+ * @param maxRetries Maksymalna liczba ponowień (0 wyłącza ponawianie).
+ * @param baseDelayMs Opóźnienie pierwszego ponowienia w ms.
+ * @param maxDelayMs Górna granica opóźnienia w ms.
+ */
+void RequestScheduler::setRetryPolicy(int maxRetries, int baseDelayMs, int maxDelayMs)
+{
+    m_maxRetries = qMax(0, maxRetries);
+    m_baseDelayMs = qMax(1, baseDelayMs);
+    m_maxDelayMs = qMax(m_baseDelayMs, maxDelayMs);
+}
+
+/**
+ * @brief Zleca żądanie GET.
+ * @param request Żądanie sieciowe.
+ * @param options Priorytet i grupa żądania.
+ * @param onStarted Funkcja wywoływana po wysłaniu każdej próby (może być pusta).
+ * @param onFinished Funkcja wywoływana raz po zakończeniu lub anulowaniu żądania.
+ * @return Identyfikator żądania.
+ */
+quint64 RequestScheduler::submit(const QNetworkRequest &request, const RequestOptions &options,
+                                 const StartedHandler &onStarted, const FinishedHandler &onFinished)
+{
+    Job job;
+    job.id = ++m_nextId;
+    job.request = request;
+    job.options = options;
+    job.generation = generation(options.group);
+    job.onStarted = onStarted;
+    job.onFinished = onFinished;
+    m_queue.append(job);
+    schedule();
+    return job.id;
+}
+
+/**
+ * @brief Unieważnia wszystkie żądania grupy.
+ * @param group Nazwa grupy.
+ *
+ * Żądania z kolejki kończą się od razu z flagą anulowania; trwające są przerywane
+ * i kończą się tak samo w onReplyFinished().
+ */
+void RequestScheduler::cancelGroup(const QString &group)
+{
+    if (group.isEmpty())
+        return;
+    ++m_generations[group];
+
+    QList<Job> cancelled;
+    for (int i = m_queue.size() - 1; i >= 0; --i) {
+        if (m_queue.at(i).options.group == group)
+            cancelled.prepend(m_queue.takeAt(i));
+    }
+    for (const Job &job : std::as_const(cancelled))
+        job.onFinished(nullptr, true);
+
+    const QList<QNetworkReply*> replies = m_running.keys();
+    for (QNetworkReply *reply : replies) {
+        auto it = m_running.constFind(reply);
+        if (it != m_running.constEnd() && it->options.group == group)
+            reply->abort();
+    }
+}
+
+/**
+ * @brief Wyznacza opóźnienie ponowienia.
+ * @param attempt Numer ponowienia (od 0).
+ * @param baseDelayMs Opóźnienie pierwszego ponowienia w ms.
+ * @param maxDelayMs Górna granica opóźnienia w ms.
+ * @param jitter Wartość losowa z przedziału [0, 1).
+ * @return Opóźnienie w ms z przedziału [d/2, d), gdzie d = min(maxDelayMs, baseDelayMs * 2^attempt).
+ *
+ * Losowa połowa opóźnienia rozprasza ponowienia wielu klientów po wspólnej awarii serwera.
+ */
+int RequestScheduler::retryDelayMs(int attempt, int baseDelayMs, int maxDelayMs, double jitter)
+{
+    const double exponential = baseDelayMs * qPow(2.0, qBound(0, attempt, 30));
+    const int delay = int(qMin<double>(maxDelayMs, exponential));
+    return delay / 2 + int((delay - delay / 2) * qBound(0.0, jitter, 0.999999));
+}
+
+/**
+ * @brief Sprawdza, czy nieudane żądanie można ponowić.
+ * @param error Błąd sieci.
+ * @param httpStatus Kod statusu HTTP (0, jeśli odpowiedź nie nadeszła).
+ * @return True dla błędów przejściowych.
+ */
+bool RequestScheduler::isRetriable(QNetworkReply::NetworkError error, int httpStatus)
+{
+    if (httpStatus != 0)
+        return httpStatus == 429 || httpStatus == 502 || httpStatus == 503 || httpStatus == 504;
+
+    switch (error) {
+    case QNetworkReply::ConnectionRefusedError:
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+    case QNetworkReply::ProxyTimeoutError:
+    case QNetworkReply::UnknownNetworkError:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Pobiera stan limitów hosta, tworząc go przy pierwszym użyciu.
+ * @param host Nazwa hosta.
+ * @return Referencja do stanu hosta.
+ */
+RequestScheduler::HostState &RequestScheduler::hostState(const QString &host)
+{
+    auto it = m_hosts.find(host);
+    if (it == m_hosts.end()) {
+        HostState state;
+        state.policy = hostPolicy(host);
+        state.tokens = state.policy.burst;
+        state.refilledAtMs = m_clock.elapsed();
+        it = m_hosts.insert(host, state);
+    }
+    return it.value();
+}
+
+/**
+ * @brief Uzupełnia żetony hosta za czas od ostatniego uzupełnienia.
+ * @param state Stan hosta.
+ * @param nowMs Bieżący czas zegara harmonogramu.
+ */
+void RequestScheduler::refill(HostState &state, qint64 nowMs) const
+{
+    const double elapsedSeconds = (nowMs - state.refilledAtMs) / 1000.0;
+    state.tokens = qMin<double>(state.policy.burst, state.tokens + elapsedSeconds * state.policy.ratePerSecond);
+    state.refilledAtMs = nowMs;
+}
+
+/**
+ * @brief Wysyła żądania, na które pozwalają limity, w kolejności priorytetów.
+ *
+ * W każdym kroku wybierane jest żądanie o najwyższym priorytecie (a przy równym
+ * priorytecie najwcześniej zlecone), którego host ma wolny żeton i miejsce na kolejne
+ * równoległe żądanie. Jeśli coś czeka na żeton lub na upływ opóźnienia ponowienia,
+ * harmonogram budzi się w chwili, gdy pierwsze z takich żądań może zostać wysłane.
+ */
+void RequestScheduler::schedule()
+{
+    forever {
+        const qint64 nowMs = m_clock.elapsed();
+        qint64 wakeAtMs = -1;
+        int best = -1;
+
+        for (int i = 0; i < m_queue.size(); ++i) {
+            const Job &job = m_queue.at(i);
+            qint64 readyAtMs = job.notBeforeMs;
+            if (readyAtMs <= nowMs) {
+                HostState &state = hostState(job.request.url().host());
+                if (state.running >= state.policy.maxConcurrent)
+                    continue; // Zwolnienie miejsca wywoła schedule() z onReplyFinished()
+                refill(state, nowMs);
+                if (state.tokens >= 1.0) {
+                    if (best < 0 || job.options.priority < m_queue.at(best).options.priority)
+                        best = i;
+                    continue;
+                }
+                readyAtMs = nowMs + qCeil((1.0 - state.tokens) * 1000.0 / qMax(0.001, state.policy.ratePerSecond));
+            }
+            if (wakeAtMs < 0 || readyAtMs < wakeAtMs)
+                wakeAtMs = readyAtMs;
+        }
+
+        if (best < 0) {
+            if (wakeAtMs >= 0)
+                m_wakeTimer.start(int(qMax<qint64>(0, wakeAtMs - nowMs)));
+            return;
+        }
+
+        Job job = m_queue.takeAt(best);
+        HostState &state = hostState(job.request.url().host());
+        state.tokens -= 1.0;
+        ++state.running;
+        start(job);
+    }
+}
+
+/**
+ * @brief Wysyła próbę żądania.
+ * @param job Żądanie.
+ */
+void RequestScheduler::start(Job job)
+{
+    QNetworkReply *reply = m_manager->get(job.request);
+    const StartedHandler onStarted = job.onStarted;
+    m_running.insert(reply, job);
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+        onReplyFinished(reply);
+    });
+    if (onStarted)
+        onStarted(reply);
+}
+
+/**
+ * @brief Obsługuje zakończenie próby żądania.
+ * @param reply Odpowiedź sieciowa.
+ *
+ * Błąd przejściowy powoduje ponowne umieszczenie żądania w kolejce z opóźnieniem
+ * (co najmniej tak długim, jak wskazuje nagłówek Retry-After); w pozostałych
+ * przypadkach wywoływana jest funkcja onFinished, a odpowiedź usuwana.
+ */
+void RequestScheduler::onReplyFinished(QNetworkReply *reply)
+{
+    auto it = m_running.find(reply);
+    if (it == m_running.end())
+        return;
+    Job job = it.value();
+    m_running.erase(it);
+    reply->deleteLater();
+
+    HostState &state = hostState(job.request.url().host());
+    --state.running;
+
+    if (isSuperseded(job)) {
+        job.onFinished(reply, true);
+        schedule();
+        return;
+    }
+
+    const int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (reply->error() != QNetworkReply::NoError && job.attempt < m_maxRetries
+        && isRetriable(reply->error(), httpStatus)) {
+        int delayMs = retryDelayMs(job.attempt, m_baseDelayMs, m_maxDelayMs, QRandomGenerator::global()->generateDouble());
+        bool ok = false;
+        const int retryAfterSeconds = reply->rawHeader("Retry-After").toInt(&ok);
+        if (ok && retryAfterSeconds > 0)
+            delayMs = qMax(delayMs, qMin(retryAfterSeconds * 1000, m_maxDelayMs));
+
+        qDebug() << "Ponowienie żądania" << job.request.url() << "za" << delayMs << "ms:" << reply->errorString();
+        ++job.attempt;
+        job.notBeforeMs = m_clock.elapsed() + delayMs;
+        m_queue.append(job);
+        schedule();
+        return;
+    }
+
+    job.onFinished(reply, false);
+    schedule();
+}
+
+/**
+ * @brief Sprawdza, czy grupa żądania została unieważniona po jego zleceniu.
+ * @param job Żądanie.
+ * @return True, jeśli żądanie należy do starszego pokolenia grupy.
+ */
+bool RequestScheduler::isSuperseded(const Job &job) const
+{
+    return !job.options.group.isEmpty() && job.generation != generation(job.options.group);
+}
@@ -0,0 +1,209 @@
+/**
+ * @file requestscheduler.h
+ * @brief Plik nagłówkowy dla klasy RequestScheduler.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje kolejkę żądań sieciowych z priorytetami, limitami częstości
+ * dla hostów, ponawianiem z wykładniczym opóźnieniem i unieważnianiem grup żądań.
+ */
+
+#ifndef REQUESTSCHEDULER_H
+#define REQUESTSCHEDULER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QString>
+#include <QTimer>
+#include <functional>
+
+/**
+ * @enum RequestPriority
+ * @brief Priorytet żądania; mniejsza wartość jest obsługiwana wcześniej.
+ */
+enum class RequestPriority {
+    Visible = 0,    ///< Dane oglądane właśnie przez użytkownika.
+    Prefetch = 1,   ///< Dane pobierane z wyprzedzeniem.
+    Background = 2  ///< Odświeżanie w tle (rewalidacja pamięci podręcznej).
+};
+
+/**
+ * @struct RequestOptions
+ * @brief Parametry szeregowania żądania.
+ */
+struct RequestOptions {
+    RequestPriority priority = RequestPriority::Visible;  ///< Priorytet żądania.
+    QString group;                                        ///< Grupa unieważniana razem; pusta oznacza brak grupy.
+};
+
+/**
+ * @struct HostPolicy
+ * @brief Limity żądań do jednego hosta.
+ *
+ * Częstość ograniczana jest kubełkiem żetonów: kubełek mieści burst żetonów,
+ * uzupełnianych w tempie ratePerSecond, a każde żądanie (także ponowione) zużywa jeden.
+ */
+struct HostPolicy {
+    double ratePerSecond = 4.0;  ///< Średnia liczba żądań na sekundę.
+    int burst = 4;               ///< Pojemność kubełka żetonów.
+    int maxConcurrent = 4;       ///< Maksymalna liczba równoległych żądań.
+};
+
+/**
+ * @class RequestScheduler
+ * @brief Kolejka żądań GET z priorytetami, limitami hostów, ponawianiem i unieważnianiem.
+ *
+ * Każde zlecone żądanie kończy się dokładnie jednym wywołaniem funkcji onFinished:
+ * z ostatnią odpowiedzią (po ewentualnych ponowieniach) albo z flagą anulowania, gdy
+ * jego grupa została unieważniona. Unieważnienie grupy (cancelGroup()) zwiększa jej
+ * numer pokolenia; żądania czekające w kolejce są usuwane, a trwające przerywane.
+ */
+class RequestScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    /// Funkcja wywoływana po wysłaniu każdej próby żądania (np. do podłączenia readyRead).
+    using StartedHandler = std::function<void(QNetworkReply *reply)>;
+
+    /// Funkcja wywoływana po zakończeniu żądania; reply jest nullptr, jeśli żądanie anulowano przed wysłaniem.
+    using FinishedHandler = std::function<void(QNetworkReply *reply, bool cancelled)>;
+
+    /**
+     * @brief Konstruktor obiektu RequestScheduler.
+     * @param manager Menedżer sieci wysyłający żądania.
+     * @param parent Rodzic QObject.
+     */
+    explicit RequestScheduler(QNetworkAccessManager *manager, QObject *parent = nullptr);
+
+    /**
+     * @brief Ustawia limity dla hosta.
+     * @param host Nazwa hosta (np. "api.gios.gov.pl").
+     * @param policy Limity hosta.
+     */
+    void setHostPolicy(const QString &host, const HostPolicy &policy);
+
+    /**
+     * @brief Pobiera limity hosta.
+     * @param host Nazwa hosta.
+     * @return Limity hosta lub limity domyślne.
+     */
+    HostPolicy hostPolicy(const QString &host) const;
+
+    /**
+     * @brief Ustawia zasady ponawiania.
+     * @param maxRetries Maksymalna liczba ponowień (0 wyłącza ponawianie).
+     * @param baseDelayMs Opóźnienie pierwszego ponowienia w ms.
+     * @param maxDelayMs Górna granica opóźnienia w ms.
+     */
+    void setRetryPolicy(int maxRetries, int baseDelayMs, int maxDelayMs);
+
+    /**
+     * @brief Zleca żądanie GET.
+     * @param request Żądanie sieciowe.
+     * @param options Priorytet i grupa żądania.
+     * @param onStarted Funkcja wywoływana po wysłaniu każdej próby (może być pusta).
+     * @param onFinished Funkcja wywoływana raz po zakończeniu lub anulowaniu żądania.
+     * @return Identyfikator żądania.
+     */
+    quint64 submit(const QNetworkRequest &request, const RequestOptions &options,
+                   const StartedHandler &onStarted, const FinishedHandler &onFinished);
+
+    /**
+     * @brief Unieważnia wszystkie żądania grupy.
+     * @param group Nazwa grupy.
+     */
+    void cancelGroup(const QString &group);
+
+    /**
+     * @brief Pobiera bieżący numer pokolenia grupy.
+     * @param group Nazwa grupy.
+     * @return Numer pokolenia (0, jeśli grupy nie unieważniano).
+     */
+    quint64 generation(const QString &group) const { return m_generations.value(group); }
+
+    /**
+     * @brief Pobiera liczbę żądań czekających w kolejce.
+     * @return Liczba żądań.
+     */
+    int pendingCount() const { return m_queue.size(); }
+
+    /**
+     * @brief Pobiera liczbę trwających żądań.
+     * @return Liczba żądań.
+     */
+    int runningCount() const { return m_running.size(); }
+
+    /**
+     * @brief Wyznacza opóźnienie ponowienia.
+     * @param attempt Numer ponowienia (od 0).
+     * @param baseDelayMs Opóźnienie pierwszego ponowienia w ms.
+     * @param maxDelayMs Górna granica opóźnienia w ms.
+     * @param jitter Wartość losowa z przedziału [0, 1).
+     * @return Opóźnienie w ms z przedziału [d/2, d), gdzie d = min(maxDelayMs, baseDelayMs * 2^attempt).
+     */
+    static int retryDelayMs(int attempt, int baseDelayMs, int maxDelayMs, double jitter);
+
+    /**
+     * @brief Sprawdza, czy nieudane żądanie można ponowić.
+     * @param error Błąd sieci.
+     * @param httpStatus Kod statusu HTTP (0, jeśli odpowiedź nie nadeszła).
+     * @return True dla błędów przejściowych (429, 502, 503, 504, zerwane lub odrzucone połączenie).
+     *
+     * Odpowiedź z innym kodem HTTP nie jest ponawiana, bo jej treść mogła już zostać przekazana dalej.
+     */
+    static bool isRetriable(QNetworkReply::NetworkError error, int httpStatus);
+
+private:
+    /**
+     * @struct Job
+     * @brief Żądanie w kolejce lub w toku.
+     */
+    struct Job {
+        quint64 id = 0;                 ///< Identyfikator żądania.
+        QNetworkRequest request;        ///< Żądanie sieciowe.
+        RequestOptions options;         ///< Priorytet i grupa.
+        quint64 generation = 0;         ///< Pokolenie grupy w chwili zlecenia.
+        int attempt = 0;                ///< Liczba wykonanych ponowień.
+        qint64 notBeforeMs = 0;         ///< Najwcześniejszy czas wysłania (zegar harmonogramu).
+        StartedHandler onStarted;       ///< Funkcja wywoływana po wysłaniu próby.
+        FinishedHandler onFinished;     ///< Funkcja wywoływana po zakończeniu.
+    };
+
+    /**
+     * @struct HostState
+     * @brief Stan limitów hosta.
+     */
+    struct HostState {
+        HostPolicy policy;          ///< Limity hosta.
+        double tokens = 0.0;        ///< Dostępne żetony.
+        qint64 refilledAtMs = 0;    ///< Czas ostatniego uzupełnienia kubełka.
+        int running = 0;            ///< Liczba trwających żądań.
+    };
+
+    HostState &hostState(const QString &host);
+    void refill(HostState &state, qint64 nowMs) const;
+    void schedule();
+    void start(Job job);
+    void onReplyFinished(QNetworkReply *reply);
+    bool isSuperseded(const Job &job) const;
+
+    QNetworkAccessManager *m_manager;         ///< Menedżer sieci.
+    QList<Job> m_queue;                       ///< Żądania czekające na wysłanie, w kolejności zlecenia.
+    QHash<QNetworkReply*, Job> m_running;     ///< Trwające żądania.
+    QHash<QString, HostState> m_hosts;        ///< Stan limitów według hosta.
+    QHash<QString, HostPolicy> m_policies;    ///< Limity ustawione dla hostów.
+    QHash<QString, quint64> m_generations;    ///< Pokolenia grup.
+    QTimer m_wakeTimer;                       ///< Wybudzenie po uzupełnieniu żetonów lub upływie opóźnienia.
+    QElapsedTimer m_clock;                    ///< Zegar harmonogramu.
+    quint64 m_nextId = 0;                     ///< Ostatni nadany identyfikator żądania.
+    int m_maxRetries = 3;                     ///< Maksymalna liczba ponowień.
+    int m_baseDelayMs = 500;                  ///< Opóźnienie pierwszego ponowienia.
+    int m_maxDelayMs = 30000;                 ///< Górna granica opóźnienia.
+};
+
+#endif // REQUESTSCHEDULER_H
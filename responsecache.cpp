@@ -0,0 +1,116 @@
+/**
+ * @file responsecache.cpp
+ * @brief Implementacja klasy ResponseCache.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera implementację dyskowej pamięci podręcznej odpowiedzi HTTP.
+ */
+
+#include "responsecache.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace {
+/// Sygnatura pliku wpisu ("GIOC").
+constexpr quint32 kCacheMagic = 0x47494F43;
+/// Wersja formatu pliku wpisu.
+constexpr quint16 kCacheVersion = 1;
+}
+
+/**
+ * @brief Konstruktor obiektu ResponseCache.
+ * @param directory Katalog pamięci podręcznej; pusty oznacza katalog domyślny aplikacji.
+ */
+ResponseCache::ResponseCache(const QString &directory)
+{
+    setDirectory(directory.isEmpty()
+                     ? QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/http"
+                     : directory);
+}
+
+/**
+ * @brief Ustawia katalog pamięci podręcznej i tworzy go, jeśli nie istnieje.
+ * @param directory Ścieżka katalogu.
+ */
+void ResponseCache::setDirectory(const QString &directory)
+{
+    m_directory = directory;
+    QDir().mkpath(m_directory);
+}
+
+/**
+ * @brief Wczytuje wpis dla adresu URL.
+ * @param url Adres żądania.
+ * @return Wpis lub pusty wpis.
+ *
+ * Wpis jest odrzucany, jeśli ma inną sygnaturę, wersję lub adres niż oczekiwany
+ * (np. przy kolizji skrótu).
+ */
+CacheEntry ResponseCache::load(const QUrl &url) const
+{
+    QFile file(filePathFor(url));
+    if (!file.open(QIODevice::ReadOnly))
+        return CacheEntry();
+
+    QDataStream in(&file);
+    quint32 magic = 0;
+    quint16 version = 0;
+    QString storedUrl;
+    in >> magic >> version;
+    if (magic != kCacheMagic || version != kCacheVersion)
+        return CacheEntry();
+
+    CacheEntry entry;
+    in >> storedUrl >> entry.etag >> entry.lastModified >> entry.storedAt >> entry.expiresAt >> entry.body;
+    if (in.status() != QDataStream::Ok || storedUrl != url.toString())
+        return CacheEntry();
+
+    return entry;
+}
+
+/**
+ * @brief Zapisuje wpis dla adresu URL.
+ * @param url Adres żądania.
+ * @param entry Wpis do zapisania.
+ * @return True, jeśli zapis się powiódł.
+ */
+bool ResponseCache::store(const QUrl &url, const CacheEntry &entry) const
+{
+    QSaveFile file(filePathFor(url));
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream out(&file);
+    out << kCacheMagic << kCacheVersion << url.toString()
+        << entry.etag << entry.lastModified << entry.storedAt << entry.expiresAt << entry.body;
+    if (out.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+/**
+ * @brief Usuwa wpis dla adresu URL.
+ * @param url Adres żądania.
+ */
+void ResponseCache::remove(const QUrl &url) const
+{
+    QFile::remove(filePathFor(url));
+}
+
+/**
+ * @brief Wyznacza ścieżkę pliku wpisu.
+ * @param url Adres żądania.
+ * @return Ścieżka pliku.
+ */
+QString ResponseCache::filePathFor(const QUrl &url) const
+{
+    const QByteArray hash = QCryptographicHash::hash(url.toString().toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QDir(m_directory).filePath(QString::fromLatin1(hash) + ".cache");
+}
@@ -0,0 +1,102 @@
+/**
+ * @file responsecache.h
+ * @brief Plik nagłówkowy dla klasy ResponseCache.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje trwałą pamięć podręczną odpowiedzi HTTP zapisywaną na dysku.
+ */
+
+#ifndef RESPONSECACHE_H
+#define RESPONSECACHE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+#include <QUrl>
+
+/**
+ * @struct CacheEntry
+ * @brief Wpis pamięci podręcznej: treść odpowiedzi i metadane do rewalidacji.
+ */
+struct CacheEntry {
+    QByteArray body;          ///< Treść odpowiedzi.
+    QByteArray etag;          ///< Nagłówek ETag zwrócony przez serwer.
+    QByteArray lastModified;  ///< Nagłówek Last-Modified zwrócony przez serwer.
+    QDateTime storedAt;       ///< Czas zapisania lub ostatniej rewalidacji.
+    QDateTime expiresAt;      ///< Czas, do którego wpis jest świeży.
+
+    /**
+     * @brief Sprawdza, czy wpis zawiera dane.
+     * @return True, jeśli wpis został wczytany.
+     */
+    bool isValid() const { return storedAt.isValid(); }
+
+    /**
+     * @brief Sprawdza, czy wpis jest świeży.
+     * @param now Bieżący czas.
+     * @return True, jeśli termin ważności nie minął.
+     */
+    bool isFresh(const QDateTime &now) const { return isValid() && now < expiresAt; }
+};
+
+/**
+ * @class ResponseCache
+ * @brief Pamięć podręczna odpowiedzi HTTP, jeden plik na adres URL.
+ *
+ * Pliki mają nazwę skrótu SHA-1 adresu i są zapisywane atomowo (QSaveFile),
+ * więc przerwany zapis nie pozostawia uszkodzonego wpisu.
+ */
+class ResponseCache {
+public:
+    /**
+     * @brief Konstruktor obiektu ResponseCache.
+     * @param directory Katalog pamięci podręcznej; pusty oznacza katalog domyślny aplikacji.
+     */
+    explicit ResponseCache(const QString &directory = QString());
+
+    /**
+     * @brief Ustawia katalog pamięci podręcznej.
+     * @param directory Ścieżka katalogu.
+     */
+    void setDirectory(const QString &directory);
+
+    /**
+     * @brief Pobiera katalog pamięci podręcznej.
+     * @return Ścieżka katalogu.
+     */
+    QString directory() const { return m_directory; }
+
+    /**
+     * @brief Wczytuje wpis dla adresu URL.
+     * @param url Adres żądania.
+     * @return Wpis lub pusty wpis, jeśli nie istnieje albo jest uszkodzony.
+     */
+    CacheEntry load(const QUrl &url) const;
+
+    /**
+     * @brief Zapisuje wpis dla adresu URL.
+     * @param url Adres żądania.
+     * @param entry Wpis do zapisania.
+     * @return True, jeśli zapis się powiódł.
+     */
+    bool store(const QUrl &url, const CacheEntry &entry) const;
+
+    /**
+     * @brief Usuwa wpis dla adresu URL.
+     * @param url Adres żądania.
+     */
+    void remove(const QUrl &url) const;
+
+    /**
+     * @brief Wyznacza ścieżkę pliku wpisu.
+     * @param url Adres żądania.
+     * @return Ścieżka pliku w katalogu pamięci podręcznej.
+     */
+    QString filePathFor(const QUrl &url) const;
+
+private:
+    QString m_directory;  ///< Katalog pamięci podręcznej.
+};
+
+#endif // RESPONSECACHE_H
@@ -0,0 +1,646 @@
+/**
+ * @file sensorchart.cpp
+ * @brief Implementacja klasy SensorChart.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera implementację wykresu szeregów czasowych rysowanego
+ * bezpośrednio węzłami grafu sceny, bez płótna JavaScript.
+ */
+
+#include "sensorchart.h"
+#include <QColor>
+#include <QDateTime>
+#include <QMatrix4x4>
+#include <QSGFlatColorMaterial>
+#include <QSGGeometryNode>
+#include <QSGTransformNode>
+#include <QSGVertexColorMaterial>
+#include <QTimeZone>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+/// Minimalny odstęp etykiet godzin w pikselach.
+constexpr double kMinHourLabelSpacing = 40.0;
+/// Minimalny odstęp etykiet dat w pikselach.
+constexpr double kMinDateLabelSpacing = 60.0;
+/// Długość kreski i przerwy linii północy w pikselach.
+constexpr double kDashLength = 5.0;
+
+/**
+ * @brief Wybiera najmniejszy krok, dla którego etykiety mieszczą się obok siebie.
+ * @param steps Dostępne kroki (rosnąco).
+ * @param pixelsPerUnit Liczba pikseli na jednostkę kroku.
+ * @param minSpacing Minimalny odstęp etykiet w pikselach.
+ * @return Wybrany krok.
+ */
+int pickStep(const QList<int> &steps, double pixelsPerUnit, double minSpacing)
+{
+    for (int step : steps) {
+        if (step * pixelsPerUnit >= minSpacing)
+            return step;
+    }
+    return steps.last();
+}
+}
+
+/**
+ * @brief Konstruktor obiektu SensorChart.
+ * @param parent Element nadrzędny.
+ */
+SensorChart::SensorChart(QQuickItem *parent)
+    : QQuickItem(parent)
+{
+    setFlag(ItemHasContents, true);
+}
+
+/**
+ * @brief Ustawia magazyn szeregów czasowych.
+ * @param store Magazyn danych sensorów.
+ */
+void SensorChart::setStore(SensorSeriesStore *store)
+{
+    if (m_store == store)
+        return;
+
+    if (m_store)
+        disconnect(m_store, nullptr, this, nullptr);
+    m_store = store;
+    if (m_store) {
+        connect(m_store, &SensorSeriesStore::seriesChanged, this, &SensorChart::onSeriesChanged);
+        connect(m_store, &SensorSeriesStore::seriesBatchChanged, this, &SensorChart::onSeriesBatchChanged);
+        connect(m_store, &SensorSeriesStore::seriesRemoved, this, &SensorChart::onSeriesChanged);
+        connect(m_store, &SensorSeriesStore::cleared, this, &SensorChart::onStoreCleared);
+    }
+
+    onStoreCleared();
+    emit storeChanged();
+}
+
+/**
+ * @brief Ustawia identyfikatory rysowanych sensorów.
+ * @param sensorIds Lista identyfikatorów w kolejności kolorów.
+ *
+ * Szeregi pozostające na wykresie nie są ponownie wczytywane.
+ */
+void SensorChart::setSensorIds(const QList<int> &sensorIds)
+{
+    if (m_sensorIds == sensorIds)
+        return;
+
+    for (int sensorId : std::as_const(m_sensorIds)) {
+        if (!sensorIds.contains(sensorId))
+            m_tracks.remove(sensorId);
+    }
+    m_sensorIds = sensorIds;
+    for (int sensorId : std::as_const(m_sensorIds)) {
+        if (!m_tracks.contains(sensorId))
+            rebuildTrack(sensorId);
+    }
+
+    updateRange();
+    update();
+    emit sensorIdsChanged();
+}
+
+/**
+ * @brief Ustawia kolory linii.
+ * @param colors Lista kolorów.
+ */
+void SensorChart::setColors(const QStringList &colors)
+{
+    if (m_colors == colors)
+        return;
+
+    m_colors = colors;
+    update();
+    emit colorsChanged();
+}
+
+/**
+ * @brief Wyszukuje pomiary najbliższe wskazanej pozycji.
+ * @param x Pozycja w pikselach względem lewej krawędzi wykresu.
+ * @return Mapa z polami x, date i values; pusta, jeśli brak danych.
+ *
+ * Wyszukiwanie binarne w szeregach magazynu, więc obsługa ruchu myszy nie zależy od długości szeregu.
+ */
+QVariantMap SensorChart::pointAt(qreal x) const
+{
+    QVariantMap result;
+    if (!m_hasData || !m_store || width() <= 0)
+        return result;
+
+    const double span = double(qMax<qint64>(1, m_endTime - m_startTime));
+    const qint64 time = m_startTime + qint64(std::llround(qBound(0.0, x / width(), 1.0) * span));
+
+    qint64 snapped = -1;
+    QVariantList values;
+    for (int i = 0; i < m_sensorIds.size() && i < m_colors.size(); ++i) {
+        const SensorSeries *series = m_store->series(m_sensorIds.at(i));
+        if (!series || series->isEmpty())
+            continue;
+
+        QVariantMap entry;
+        entry["sensorId"] = m_sensorIds.at(i);
+        entry["color"] = m_colors.at(i);
+
+        const SensorSeriesStore::Resolution resolution = m_tracks.value(m_sensorIds.at(i)).resolution;
+        if (resolution != SensorSeriesStore::Raw) {
+            // Linia pokazuje średnie okresów, więc podpowiedź też podaje średnią najbliższego okresu
+            const qint64 reach = resolution == SensorSeriesStore::Daily ? 86400 : 31 * 86400;
+            const QVector<SeriesBucket> buckets = m_store->querySeries(m_sensorIds.at(i), time - reach, time + reach, resolution);
+            if (buckets.isEmpty())
+                continue;
+            const SeriesBucket *nearest = &buckets.first();
+            for (const SeriesBucket &bucket : buckets) {
+                if (qAbs(bucket.start - time) < qAbs(nearest->start - time))
+                    nearest = &bucket;
+            }
+            if (snapped < 0)
+                snapped = nearest->start;
+            entry["value"] = nearest->mean();
+            values.append(entry);
+            continue;
+        }
+
+        const QVector<qint64> &timestamps = series->timestamps();
+        int index = int(std::lower_bound(timestamps.cbegin(), timestamps.cend(), time) - timestamps.cbegin());
+        if (index == timestamps.size() || (index > 0 && time - timestamps.at(index - 1) < timestamps.at(index) - time))
+            --index;
+        if (snapped < 0)
+            snapped = timestamps.at(index);
+
+        entry["value"] = series->isNull(index) ? QVariant() : QVariant(series->value(index));
+        values.append(entry);
+    }
+
+    if (snapped < 0)
+        return result;
+
+    result["x"] = (snapped - m_startTime) / span * width();
+    result["date"] = SensorSeries::formatTimestamp(snapped);
+    result["values"] = values;
+    return result;
+}
+
+/**
+ * @brief Zmniejsza liczbę punktów algorytmem LTTB.
+ * @param points Punkty uporządkowane rosnąco według x.
+ * @param threshold Docelowa liczba punktów.
+ * @return Zmniejszona lista punktów.
+ *
+ * Z każdego kubełka wybierany jest punkt tworzący największy trójkąt z punktem
+ * wybranym poprzednio i średnią następnego kubełka, dzięki czemu zachowane są szczyty.
+ */
+QVector<QPointF> SensorChart::downsampleLttb(const QVector<QPointF> &points, int threshold)
+{
+    const int count = points.size();
+    if (threshold < 3 || threshold >= count)
+        return points;
+
+    QVector<QPointF> sampled;
+    sampled.reserve(threshold);
+    sampled.append(points.first());
+
+    const double bucketSize = double(count - 2) / (threshold - 2);
+    int selected = 0;
+    for (int bucket = 0; bucket < threshold - 2; ++bucket) {
+        // Średnia następnego kubełka
+        const int averageStart = int((bucket + 1) * bucketSize) + 1;
+        const int averageEnd = qMin(int((bucket + 2) * bucketSize) + 1, count);
+        double averageX = 0.0;
+        double averageY = 0.0;
+        for (int i = averageStart; i < averageEnd; ++i) {
+            averageX += points.at(i).x();
+            averageY += points.at(i).y();
+        }
+        const int averageCount = qMax(1, averageEnd - averageStart);
+        averageX /= averageCount;
+        averageY /= averageCount;
+
+        // Punkt bieżącego kubełka tworzący największy trójkąt
+        const int rangeStart = int(bucket * bucketSize) + 1;
+        const int rangeEnd = int((bucket + 1) * bucketSize) + 1;
+        const QPointF &previous = points.at(selected);
+        double maxArea = -1.0;
+        int next = rangeStart;
+        for (int i = rangeStart; i < rangeEnd; ++i) {
+            const double area = std::abs((previous.x() - averageX) * (points.at(i).y() - previous.y())
+                                         - (previous.x() - points.at(i).x()) * (averageY - previous.y()));
+            if (area > maxArea) {
+                maxArea = area;
+                next = i;
+            }
+        }
+
+        sampled.append(points.at(next));
+        selected = next;
+    }
+
+    sampled.append(points.last());
+    return sampled;
+}
+
+/**
+ * @brief Aktualizuje węzły grafu sceny.
+ * @param oldNode Dotychczasowy węzeł główny lub nullptr.
+ * @param data Dane aktualizacji (nieużywane).
+ * @return Węzeł główny wykresu.
+ *
+ * Geometria szeregu jest przebudowywana tylko wtedy, gdy zmienił się sam szereg
+ * (lub jego zmniejszenie); zmiana zakresu osi i rozmiaru aktualizuje jedynie macierze.
+ */
+QSGNode *SensorChart::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data)
+
+    QSGNode *root = oldNode;
+    if (!root) {
+        root = new QSGNode;
+        m_gridNode = nullptr;
+        m_trackNodes.clear();
+        m_gridDirty = true;
+        for (Track &track : m_tracks)
+            track.geometryDirty = true;
+    }
+
+    if (!m_gridNode) {
+        m_gridNode = new QSGGeometryNode;
+        auto *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_ColoredPoint2D(), 0);
+        geometry->setDrawingMode(QSGGeometry::DrawLines);
+        m_gridNode->setGeometry(geometry);
+        m_gridNode->setFlag(QSGNode::OwnsGeometry);
+        m_gridNode->setMaterial(new QSGVertexColorMaterial);
+        m_gridNode->setFlag(QSGNode::OwnsMaterial);
+        root->appendChildNode(m_gridNode);
+    }
+    if (m_gridDirty) {
+        updateGridGeometry(m_gridNode);
+        m_gridNode->markDirty(QSGNode::DirtyGeometry);
+        m_gridDirty = false;
+    }
+
+    // Usuń węzły sensorów, które nie są już rysowane
+    for (auto it = m_trackNodes.begin(); it != m_trackNodes.end();) {
+        const int index = m_sensorIds.indexOf(it.key());
+        auto trackIt = m_tracks.constFind(it.key());
+        const bool drawn = index >= 0 && index < m_colors.size()
+                           && trackIt != m_tracks.constEnd() && !trackIt->points.isEmpty();
+        if (drawn) {
+            ++it;
+            continue;
+        }
+        root->removeChildNode(it.value());
+        delete it.value();
+        it = m_trackNodes.erase(it);
+    }
+
+    const double sx = width() / double(qMax<qint64>(1, m_endTime - m_startTime));
+    const double sy = height() / (m_maxValue - m_minValue);
+    for (int i = 0; i < m_sensorIds.size() && i < m_colors.size(); ++i) {
+        const int sensorId = m_sensorIds.at(i);
+        auto trackIt = m_tracks.find(sensorId);
+        if (trackIt == m_tracks.end() || trackIt->points.isEmpty())
+            continue;
+
+        QSGTransformNode *transform = m_trackNodes.value(sensorId);
+        if (!transform) {
+            auto *line = new QSGGeometryNode;
+            auto *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 0);
+            geometry->setDrawingMode(QSGGeometry::DrawLineStrip);
+            geometry->setLineWidth(2);
+            line->setGeometry(geometry);
+            line->setFlag(QSGNode::OwnsGeometry);
+            line->setMaterial(new QSGFlatColorMaterial);
+            line->setFlag(QSGNode::OwnsMaterial);
+
+            transform = new QSGTransformNode;
+            transform->appendChildNode(line);
+            root->appendChildNode(transform);
+            m_trackNodes.insert(sensorId, transform);
+            trackIt->geometryDirty = true;
+        }
+
+        auto *line = static_cast<QSGGeometryNode*>(transform->firstChild());
+        if (trackIt->geometryDirty) {
+            QSGGeometry *geometry = line->geometry();
+            geometry->allocate(trackIt->points.size());
+            QSGGeometry::Point2D *vertices = geometry->vertexDataAsPoint2D();
+            for (int p = 0; p < trackIt->points.size(); ++p)
+                vertices[p].set(float(trackIt->points.at(p).x()), float(trackIt->points.at(p).y()));
+            line->markDirty(QSGNode::DirtyGeometry);
+            trackIt->geometryDirty = false;
+        }
+
+        auto *material = static_cast<QSGFlatColorMaterial*>(line->material());
+        const QColor color(m_colors.at(i));
+        if (material->color() != color) {
+            material->setColor(color);
+            line->markDirty(QSGNode::DirtyMaterial);
+        }
+
+        // Układ danych -> piksele: x = (czas - początek osi) * sx, y = wysokość - (wartość - minimum) * sy
+        QMatrix4x4 matrix;
+        matrix.translate(float((trackIt->origin - m_startTime) * sx), float(height() + m_minValue * sy));
+        matrix.scale(float(sx), float(-sy));
+        transform->setMatrix(matrix);
+    }
+
+    return root;
+}
+
+/**
+ * @brief Reaguje na zmianę rozmiaru elementu.
+ * @param newGeometry Nowa geometria.
+ * @param oldGeometry Poprzednia geometria.
+ *
+ * Szereg jest ponownie zmniejszany tylko wtedy, gdy docelowa liczba punktów zmieniła się o więcej niż 25%.
+ */
+void SensorChart::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+    if (newGeometry.size() == oldGeometry.size())
+        return;
+
+    m_gridDirty = true;
+    const int target = targetPointCount();
+    for (int sensorId : std::as_const(m_sensorIds)) {
+        auto it = m_tracks.constFind(sensorId);
+        if (it == m_tracks.constEnd())
+            continue;
+        if (it->rawCount <= qMin(it->target, target))
+            continue;
+        if (qAbs(target - it->target) * 4 > it->target)
+            rebuildTrack(sensorId);
+    }
+
+    updateTimeTicks();
+    update();
+}
+
+/**
+ * @brief Wczytuje szereg sensora z magazynu i zmniejsza go do szerokości wykresu.
+ * @param sensorId Identyfikator sensora.
+ *
+ * Długie szeregi pobierane są jako gotowe średnie dobowe lub miesięczne
+ * (SensorSeriesStore::Auto), a dopiero wynik jest zmniejszany algorytmem LTTB.
+ */
+void SensorChart::rebuildTrack(int sensorId)
+{
+    Track track;
+    const SensorSeries *series = m_store ? m_store->series(sensorId) : nullptr;
+    if (series && !series->isEmpty()) {
+        const QVector<SeriesBucket> buckets = m_store->querySeries(sensorId, series->timestamp(0),
+                                                                   series->timestamp(series->size() - 1),
+                                                                   SensorSeriesStore::Auto, &track.resolution);
+        track.origin = buckets.isEmpty() ? series->timestamp(0) : qMin(series->timestamp(0), buckets.first().start);
+        track.end = series->timestamp(series->size() - 1);
+        track.minValue = std::numeric_limits<double>::max();
+        track.maxValue = std::numeric_limits<double>::lowest();
+
+        QVector<QPointF> points;
+        points.reserve(buckets.size());
+        for (const SeriesBucket &bucket : buckets) {
+            const double value = bucket.mean();
+            points.append(QPointF(double(bucket.start - track.origin), value));
+            track.minValue = qMin(track.minValue, value);
+            track.maxValue = qMax(track.maxValue, value);
+        }
+
+        track.rawCount = points.size();
+        track.target = targetPointCount();
+        track.points = downsampleLttb(points, track.target);
+    }
+    m_tracks.insert(sensorId, track);
+}
+
+/**
+ * @brief Wyznacza zakres osi na podstawie wszystkich szeregów.
+ */
+void SensorChart::updateRange()
+{
+    bool hasData = false;
+    double minValue = std::numeric_limits<double>::max();
+    double maxValue = std::numeric_limits<double>::lowest();
+    qint64 startTime = std::numeric_limits<qint64>::max();
+    qint64 endTime = std::numeric_limits<qint64>::min();
+    int resolution = SensorSeriesStore::Raw;
+
+    for (int sensorId : std::as_const(m_sensorIds)) {
+        auto it = m_tracks.constFind(sensorId);
+        if (it == m_tracks.constEnd() || it->points.isEmpty())
+            continue;
+        hasData = true;
+        resolution = qMax(resolution, int(it->resolution));
+        minValue = qMin(minValue, it->minValue);
+        maxValue = qMax(maxValue, it->maxValue);
+        startTime = qMin(startTime, it->origin);
+        endTime = qMax(endTime, it->end);
+    }
+
+    if (!hasData) {
+        minValue = 0.0;
+        maxValue = 1.0;
+        startTime = 0;
+        endTime = 0;
+    } else if (minValue == maxValue) {
+        minValue -= 1.0;
+        maxValue += 1.0;
+    }
+
+    if (hasData == m_hasData && minValue == m_minValue && maxValue == m_maxValue
+        && startTime == m_startTime && endTime == m_endTime && resolution == m_resolution)
+        return;
+
+    m_hasData = hasData;
+    m_resolution = resolution;
+    m_minValue = minValue;
+    m_maxValue = maxValue;
+    m_startTime = startTime;
+    m_endTime = endTime;
+    m_gridDirty = true;
+    emit rangeChanged();
+    updateTimeTicks();
+}
+
+/**
+ * @brief Wyznacza znaczniki osi czasu dla bieżącego zakresu i szerokości.
+ *
+ * Położenia znaczników dat zapamiętywane są dla linii siatki.
+ */
+void SensorChart::updateTimeTicks()
+{
+    const QVariantList ticks = m_hasData ? timeTicksFor(m_startTime, m_endTime, width()) : QVariantList();
+
+    QVector<qreal> dateTickXs;
+    for (const QVariant &tick : ticks) {
+        const QVariantMap map = tick.toMap();
+        if (map.value("isDate").toBool())
+            dateTickXs.append(map.value("x").toReal());
+    }
+
+    m_dateTickXs = dateTickXs;
+    m_gridDirty = true;
+    if (ticks != m_timeTicks) {
+        m_timeTicks = ticks;
+        emit timeTicksChanged();
+    }
+}
+
+/**
+ * @brief Wyznacza znaczniki osi czasu dla zakresu i szerokości wykresu.
+ * @param startTime Początek zakresu (czas ścienny jako UTC).
+ * @param endTime Koniec zakresu.
+ * @param width Szerokość wykresu w pikselach.
+ * @return Lista map {x, label, isDate}: daty (dni, miesiące lub lata) i godziny.
+ *
+ * Kroki godzin i dat dobierane są do szerokości wykresu przed przeglądaniem zakresu, aby
+ * etykiety się nie nakładały; zakres przeglądany jest od razu tym krokiem, więc koszt zależy
+ * od liczby etykiet, a nie od długości zakresu. Gdy dni się nie mieszczą, daty są oznaczane
+ * co miesiąc, kwartał, pół roku lub rok (i wielokrotności lat).
+ */
+QVariantList SensorChart::timeTicksFor(qint64 startTime, qint64 endTime, qreal width)
+{
+    QVariantList ticks;
+    if (endTime <= startTime || width <= 0)
+        return ticks;
+
+    const double span = double(endTime - startTime);
+    const double pixelsPerDay = width * 86400.0 / span;
+    const auto appendTick = [&](qint64 time, const QString &format, bool isDate) {
+        QVariantMap tick;
+        tick["x"] = (time - startTime) / span * width;
+        tick["label"] = QDateTime::fromSecsSinceEpoch(time, QTimeZone::utc()).toString(format);
+        tick["isDate"] = isDate;
+        ticks.append(tick);
+    };
+
+    if (pixelsPerDay * 14 >= kMinDateLabelSpacing) {
+        const qint64 stride = qint64(pickStep({ 1, 2, 7, 14 }, pixelsPerDay, kMinDateLabelSpacing)) * 86400;
+        for (qint64 time = (startTime + stride - 1) / stride * stride; time <= endTime; time += stride)
+            appendTick(time, "dd.MM.yy", true);
+    } else {
+        const int monthStep = pickStep({ 1, 2, 3, 6, 12, 24, 60, 120 }, pixelsPerDay * 30.44, kMinDateLabelSpacing);
+        const QDate startDate = QDateTime::fromSecsSinceEpoch(startTime, QTimeZone::utc()).date();
+        QDate date(startDate.year(), startDate.month(), 1);
+        if (date.startOfDay(QTimeZone::utc()).toSecsSinceEpoch() < startTime)
+            date = date.addMonths(1);
+        const int monthIndex = date.year() * 12 + date.month() - 1;
+        date = date.addMonths((monthStep - monthIndex % monthStep) % monthStep);
+        for (;; date = date.addMonths(monthStep)) {
+            const qint64 time = date.startOfDay(QTimeZone::utc()).toSecsSinceEpoch();
+            if (time > endTime)
+                break;
+            appendTick(time, monthStep >= 12 ? "yyyy" : "MM.yyyy", true);
+        }
+    }
+
+    const int hourStep = pickStep({ 4, 6, 12, 24 }, pixelsPerDay / 24.0, kMinHourLabelSpacing);
+    if (hourStep < 24) {
+        const qint64 stride = qint64(hourStep) * 3600;
+        for (qint64 time = (startTime + stride - 1) / stride * stride; time <= endTime; time += stride)
+            appendTick(time, "HH:mm", false);
+    }
+    return ticks;
+}
+
+/**
+ * @brief Wyznacza docelową liczbę punktów szeregu.
+ * @return Dwukrotność szerokości w pikselach.
+ */
+int SensorChart::targetPointCount() const
+{
+    return qMax(3, int(std::ceil(width())) * 2);
+}
+
+/**
+ * @brief Aktualizuje geometrię siatki, osi i linii północy.
+ * @param node Węzeł siatki.
+ */
+void SensorChart::updateGridGeometry(QSGGeometryNode *node) const
+{
+    const float w = float(width());
+    const float h = float(height());
+    const int dashesPerLine = h > 0 ? int(std::ceil(h / (2 * kDashLength))) : 0;
+    const int gridLines = 11;
+    const int vertexCount = gridLines * 4 + 4 + m_dateTickXs.size() * dashesPerLine * 2;
+
+    QSGGeometry *geometry = node->geometry();
+    geometry->allocate(vertexCount);
+    QSGGeometry::ColoredPoint2D *vertices = geometry->vertexDataAsColoredPoint2D();
+    int v = 0;
+
+    // Siatka
+    for (int i = 0; i < gridLines; ++i) {
+        const float x = w * i / (gridLines - 1);
+        const float y = h * i / (gridLines - 1);
+        vertices[v++].set(x, 0, 0xd3, 0xd3, 0xd3, 0xff);
+        vertices[v++].set(x, h, 0xd3, 0xd3, 0xd3, 0xff);
+        vertices[v++].set(0, y, 0xd3, 0xd3, 0xd3, 0xff);
+        vertices[v++].set(w, y, 0xd3, 0xd3, 0xd3, 0xff);
+    }
+
+    // Osie
+    vertices[v++].set(0, h, 0, 0, 0, 0xff);
+    vertices[v++].set(w, h, 0, 0, 0, 0xff);
+    vertices[v++].set(0, 0, 0, 0, 0, 0xff);
+    vertices[v++].set(0, h, 0, 0, 0, 0xff);
+
+    // Przerywane linie północy
+    for (qreal x : m_dateTickXs) {
+        for (int d = 0; d < dashesPerLine; ++d) {
+            const float top = float(d * 2 * kDashLength);
+            vertices[v++].set(float(x), top, 0, 0, 0, 0xff);
+            vertices[v++].set(float(x), qMin(h, top + float(kDashLength)), 0, 0, 0, 0xff);
+        }
+    }
+}
+
+/**
+ * @brief Obsługuje zmianę szeregu w magazynie.
+ * @param sensorId Identyfikator sensora.
+ */
+void SensorChart::onSeriesChanged(int sensorId)
+{
+    if (!m_sensorIds.contains(sensorId))
+        return;
+
+    rebuildTrack(sensorId);
+    updateRange();
+    update();
+}
+
+/**
+ * @brief Obsługuje jednoczesną zmianę szeregów wielu sensorów.
+ * @param sensorIds Identyfikatory zmienionych sensorów.
+ *
+ * Zakres osi i scena przeliczane są raz dla całej partii.
+ */
+void SensorChart::onSeriesBatchChanged(const QList<int> &sensorIds)
+{
+    bool changed = false;
+    for (int sensorId : sensorIds) {
+        if (!m_sensorIds.contains(sensorId))
+            continue;
+        rebuildTrack(sensorId);
+        changed = true;
+    }
+
+    if (!changed)
+        return;
+    updateRange();
+    update();
+}
+
+/**
+ * @brief Obsługuje usunięcie wszystkich szeregów z magazynu.
+ */
+void SensorChart::onStoreCleared()
+{
+    for (int sensorId : std::as_const(m_sensorIds))
+        rebuildTrack(sensorId);
+    updateRange();
+    update();
+}
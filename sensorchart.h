@@ -0,0 +1,267 @@
+/**
+ * @file sensorchart.h
+ * @brief Plik nagłówkowy dla klasy SensorChart.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje element QML rysujący wykres szeregów czasowych sensorów w grafie sceny.
+ */
+
+#ifndef SENSORCHART_H
+#define SENSORCHART_H
+
+#include <QQuickItem>
+#include <QHash>
+#include <QList>
+#include <QPointF>
+#include <QPointer>
+#include <QStringList>
+#include <QVariantList>
+#include <QVector>
+#include "sensorseries.h"
+
+class QSGGeometryNode;
+class QSGTransformNode;
+
+/**
+ * @class SensorChart
+ * @brief Wykres liniowy szeregów czasowych sensorów oparty na węzłach grafu sceny.
+ *
+ * Każdy sensor ma własny węzeł z geometrią przechowywaną w układzie danych
+ * (czas względem początku szeregu, wartość), a skalowanie do pikseli odbywa się
+ * macierzą węzła transformacji. Zmiana rozmiaru lub zakresu osi nie przebudowuje
+ * więc geometrii, a dodanie lub usunięcie sensora dotyka tylko jego węzła.
+ * Długie szeregi rysowane są ze średnich dobowych lub miesięcznych z magazynu, a szeregi
+ * dłuższe niż dwukrotność szerokości w pikselach są zmniejszane algorytmem LTTB.
+ * Etykiety osi rysowane są w QML na podstawie właściwości minValue, maxValue i timeTicks.
+ */
+class SensorChart : public QQuickItem {
+    Q_OBJECT
+    Q_PROPERTY(SensorSeriesStore* store READ store WRITE setStore NOTIFY storeChanged)
+    Q_PROPERTY(QList<int> sensorIds READ sensorIds WRITE setSensorIds NOTIFY sensorIdsChanged)
+    Q_PROPERTY(QStringList colors READ colors WRITE setColors NOTIFY colorsChanged)
+    Q_PROPERTY(bool hasData READ hasData NOTIFY rangeChanged)
+    Q_PROPERTY(double minValue READ minValue NOTIFY rangeChanged)
+    Q_PROPERTY(double maxValue READ maxValue NOTIFY rangeChanged)
+    Q_PROPERTY(QVariantList timeTicks READ timeTicks NOTIFY timeTicksChanged)
+    Q_PROPERTY(int resolution READ resolution NOTIFY rangeChanged)
+
+public:
+    /**
+     * @brief Konstruktor obiektu SensorChart.
+     * @param parent Element nadrzędny.
+     */
+    explicit SensorChart(QQuickItem *parent = nullptr);
+
+    /**
+     * @brief Pobiera magazyn szeregów czasowych.
+     * @return Magazyn danych sensorów.
+     */
+    SensorSeriesStore *store() const { return m_store; }
+
+    /**
+     * @brief Ustawia magazyn szeregów czasowych.
+     * @param store Magazyn danych sensorów.
+     */
+    void setStore(SensorSeriesStore *store);
+
+    /**
+     * @brief Pobiera identyfikatory rysowanych sensorów.
+     * @return Lista identyfikatorów w kolejności kolorów.
+     */
+    QList<int> sensorIds() const { return m_sensorIds; }
+
+    /**
+     * @brief Ustawia identyfikatory rysowanych sensorów.
+     * @param sensorIds Lista identyfikatorów w kolejności kolorów.
+     */
+    void setSensorIds(const QList<int> &sensorIds);
+
+    /**
+     * @brief Pobiera kolory linii.
+     * @return Lista kolorów.
+     */
+    QStringList colors() const { return m_colors; }
+
+    /**
+     * @brief Ustawia kolory linii.
+     * @param colors Lista kolorów; sensory bez koloru nie są rysowane.
+     */
+    void setColors(const QStringList &colors);
+
+    /**
+     * @brief Sprawdza, czy wykres ma dane do narysowania.
+     * @return True, jeśli co najmniej jeden szereg ma pomiary.
+     */
+    bool hasData() const { return m_hasData; }
+
+    /**
+     * @brief Pobiera dolną granicę osi wartości.
+     * @return Minimalna wartość osi.
+     */
+    double minValue() const { return m_minValue; }
+
+    /**
+     * @brief Pobiera górną granicę osi wartości.
+     * @return Maksymalna wartość osi.
+     */
+    double maxValue() const { return m_maxValue; }
+
+    /**
+     * @brief Pobiera znaczniki osi czasu.
+     * @return Lista map z polami x, label i isDate.
+     */
+    QVariantList timeTicks() const { return m_timeTicks; }
+
+    /**
+     * @brief Pobiera rozdzielczość rysowanych linii.
+     * @return Najgrubsza rozdzielczość wśród szeregów (wartość SensorSeriesStore::Resolution).
+     */
+    int resolution() const { return m_resolution; }
+
+    /**
+     * @brief Wyszukuje pomiary najbliższe wskazanej pozycji.
+     * @param x Pozycja w pikselach względem lewej krawędzi wykresu.
+     * @return Mapa z polami x (pozycja pomiaru), date oraz values (lista map sensorId, color, value).
+     */
+    Q_INVOKABLE QVariantMap pointAt(qreal x) const;
+
+    /**
+     * @brief Zmniejsza liczbę punktów algorytmem LTTB (Largest-Triangle-Three-Buckets).
+     * @param points Punkty uporządkowane rosnąco według x.
+     * @param threshold Docelowa liczba punktów (co najmniej 3).
+     * @return Punkty zachowujące kształt linii; pierwszy i ostatni punkt pozostają bez zmian.
+     */
+    static QVector<QPointF> downsampleLttb(const QVector<QPointF> &points, int threshold);
+
+    /**
+     * @brief Wyznacza znaczniki osi czasu dla zakresu i szerokości wykresu.
+     * @param startTime Początek zakresu (czas ścienny jako UTC).
+     * @param endTime Koniec zakresu.
+     * @param width Szerokość wykresu w pikselach.
+     * @return Lista map {x, label, isDate}: daty (dni, miesiące lub lata) i godziny.
+     */
+    static QVariantList timeTicksFor(qint64 startTime, qint64 endTime, qreal width);
+
+signals:
+    /**
+     * @brief Sygnał emitowany, gdy zmieni się magazyn danych.
+     */
+    void storeChanged();
+
+    /**
+     * @brief Sygnał emitowany, gdy zmieni się lista sensorów.
+     */
+    void sensorIdsChanged();
+
+    /**
+     * @brief Sygnał emitowany, gdy zmienią się kolory linii.
+     */
+    void colorsChanged();
+
+    /**
+     * @brief Sygnał emitowany, gdy zmieni się zakres osi.
+     */
+    void rangeChanged();
+
+    /**
+     * @brief Sygnał emitowany, gdy zmienią się znaczniki osi czasu.
+     */
+    void timeTicksChanged();
+
+protected:
+    /**
+     * @brief Aktualizuje węzły grafu sceny.
+     * @param oldNode Dotychczasowy węzeł główny lub nullptr.
+     * @param data Dane aktualizacji (nieużywane).
+     * @return Węzeł główny wykresu.
+     */
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+
+    /**
+     * @brief Reaguje na zmianę rozmiaru elementu.
+     * @param newGeometry Nowa geometria.
+     * @param oldGeometry Poprzednia geometria.
+     */
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+
+private:
+    /**
+     * @struct Track
+     * @brief Zmniejszony szereg jednego sensora w układzie danych.
+     */
+    struct Track {
+        QVector<QPointF> points;      ///< Punkty (sekundy od początku szeregu, wartość lub średnia okresu).
+        qint64 origin = 0;            ///< Znacznik czasu pierwszego punktu szeregu.
+        qint64 end = 0;               ///< Znacznik czasu ostatniego punktu szeregu.
+        double minValue = 0.0;        ///< Minimalna wartość szeregu.
+        double maxValue = 0.0;        ///< Maksymalna wartość szeregu.
+        int rawCount = 0;             ///< Liczba punktów przed zmniejszeniem.
+        int target = 0;               ///< Liczba punktów, do której zmniejszono szereg.
+        SensorSeriesStore::Resolution resolution = SensorSeriesStore::Raw; ///< Rozdzielczość punktów.
+        bool geometryDirty = true;    ///< Czy geometria węzła wymaga przebudowy.
+    };
+
+    /**
+     * @brief Wczytuje szereg sensora z magazynu i zmniejsza go do szerokości wykresu.
+     * @param sensorId Identyfikator sensora.
+     */
+    void rebuildTrack(int sensorId);
+
+    /**
+     * @brief Wyznacza zakres osi na podstawie wszystkich szeregów.
+     */
+    void updateRange();
+
+    /**
+     * @brief Wyznacza znaczniki osi czasu dla bieżącego zakresu i szerokości.
+     */
+    void updateTimeTicks();
+
+    /**
+     * @brief Wyznacza docelową liczbę punktów szeregu.
+     * @return Dwukrotność szerokości w pikselach.
+     */
+    int targetPointCount() const;
+
+    /**
+     * @brief Aktualizuje geometrię siatki, osi i linii północy.
+     * @param node Węzeł siatki.
+     */
+    void updateGridGeometry(QSGGeometryNode *node) const;
+
+    /**
+     * @brief Obsługuje zmianę szeregu w magazynie.
+     * @param sensorId Identyfikator sensora.
+     */
+    void onSeriesChanged(int sensorId);
+
+    /**
+     * @brief Obsługuje jednoczesną zmianę szeregów wielu sensorów.
+     * @param sensorIds Identyfikatory zmienionych sensorów.
+     */
+    void onSeriesBatchChanged(const QList<int> &sensorIds);
+
+    /**
+     * @brief Obsługuje usunięcie wszystkich szeregów z magazynu.
+     */
+    void onStoreCleared();
+
+    QPointer<SensorSeriesStore> m_store;       ///< Magazyn danych sensorów.
+    QList<int> m_sensorIds;                    ///< Rysowane sensory w kolejności kolorów.
+    QStringList m_colors;                      ///< Kolory linii.
+    QHash<int, Track> m_tracks;                ///< Zmniejszone szeregi według identyfikatora sensora.
+    QHash<int, QSGTransformNode*> m_trackNodes; ///< Węzły szeregów (wątek renderowania).
+    QSGGeometryNode *m_gridNode = nullptr;     ///< Węzeł siatki (wątek renderowania).
+    bool m_gridDirty = true;                   ///< Czy siatka wymaga przebudowy.
+    bool m_hasData = false;                    ///< Czy wykres ma dane.
+    double m_minValue = 0.0;                   ///< Dolna granica osi wartości.
+    double m_maxValue = 1.0;                   ///< Górna granica osi wartości.
+    int m_resolution = SensorSeriesStore::Raw; ///< Najgrubsza rozdzielczość linii.
+    qint64 m_startTime = 0;                    ///< Początek osi czasu (sekundy od epoki).
+    qint64 m_endTime = 0;                      ///< Koniec osi czasu (sekundy od epoki).
+    QVariantList m_timeTicks;                  ///< Znaczniki osi czasu.
+    QVector<qreal> m_dateTickXs;               ///< Pozycje linii północy w pikselach.
+};
+
+#endif // SENSORCHART_H
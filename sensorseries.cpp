@@ -0,0 +1,640 @@
+/**
+ * @file sensorseries.cpp
+ * @brief Implementacja klas SensorSeries i SensorSeriesStore.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera implementację kolumnowego magazynu szeregów czasowych
+ * oraz szybkiego parsowania dat w formacie GIOŚ.
+ */
+
+#include "sensorseries.h"
+#include <QDateTime>
+#include <QTimeZone>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+/**
+ * @brief Wyznacza liczbę dni od 1970-01-01 dla daty kalendarza gregoriańskiego.
+ * @param year Rok.
+ * @param month Miesiąc (1-12).
+ * @param day Dzień (1-31).
+ * @return Liczba dni od epoki.
+ */
+qint64 daysFromCivil(int year, int month, int day)
+{
+    year -= month <= 2;
+    const qint64 era = (year >= 0 ? year : year - 399) / 400;
+    const int yearOfEra = year - int(era * 400);
+    const int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+/**
+ * @brief Wyznacza liczbę dni miesiąca kalendarza gregoriańskiego.
+ * @param year Rok.
+ * @param month Miesiąc (1-12).
+ * @return Liczba dni miesiąca (luty 29 w latach przestępnych).
+ */
+int daysInMonth(int year, int month)
+{
+    static constexpr int days[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    const bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    return month == 2 && leap ? 29 : days[month - 1];
+}
+
+/**
+ * @brief Odczytuje liczbę dziesiętną o stałej liczbie cyfr.
+ * @param date Tekst daty.
+ * @param pos Pozycja pierwszej cyfry.
+ * @param digits Liczba cyfr.
+ * @return Liczba lub -1, jeśli znak nie jest cyfrą.
+ */
+int readNumber(const QString &date, int pos, int digits)
+{
+    int result = 0;
+    for (int i = pos; i < pos + digits; ++i) {
+        const char16_t c = date.at(i).unicode();
+        if (c < u'0' || c > u'9')
+            return -1;
+        result = result * 10 + (c - u'0');
+    }
+    return result;
+}
+}
+
+/**
+ * @brief Rezerwuje miejsce na punkty.
+ * @param size Oczekiwana liczba punktów.
+ */
+void SensorSeries::reserve(int size)
+{
+    m_timestamps.reserve(size);
+    m_values.reserve(size);
+    m_nullMask.reserve((size + 63) / 64);
+}
+
+/**
+ * @brief Dodaje punkt pomiarowy.
+ * @param timestamp Znacznik czasu w sekundach od epoki.
+ * @param value Wartość pomiaru.
+ * @param isNull True, jeśli pomiar jest pusty.
+ */
+void SensorSeries::append(qint64 timestamp, double value, bool isNull)
+{
+    const int index = m_timestamps.size();
+    if ((index & 63) == 0)
+        m_nullMask.append(0);
+    if (isNull || std::isnan(value)) {
+        m_nullMask[index >> 6] |= quint64(1) << (index & 63);
+        value = 0.0;
+    }
+    m_timestamps.append(timestamp);
+    m_values.append(value);
+}
+
+/**
+ * @brief Porządkuje punkty rosnąco według czasu.
+ */
+void SensorSeries::sortByTime()
+{
+    if (std::is_sorted(m_timestamps.cbegin(), m_timestamps.cend()))
+        return;
+
+    QVector<int> order(m_timestamps.size());
+    if (std::is_sorted(m_timestamps.crbegin(), m_timestamps.crend())) {
+        // API GIOŚ zwraca pomiary od najnowszego
+        for (int i = 0; i < order.size(); ++i)
+            order[i] = order.size() - 1 - i;
+    } else {
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+            return m_timestamps.at(a) < m_timestamps.at(b);
+        });
+    }
+
+    SensorSeries sorted;
+    sorted.reserve(order.size());
+    for (int index : order)
+        sorted.append(m_timestamps.at(index), m_values.at(index), isNull(index));
+    *this = sorted;
+}
+
+/**
+ * @brief Szacuje pamięć zajmowaną przez szereg.
+ * @return Liczba bajtów zarezerwowanych na dane.
+ */
+qsizetype SensorSeries::memoryUsage() const
+{
+    return m_timestamps.capacity() * qsizetype(sizeof(qint64))
+           + m_values.capacity() * qsizetype(sizeof(double))
+           + m_nullMask.capacity() * qsizetype(sizeof(quint64));
+}
+
+/**
+ * @brief Zamienia datę w formacie GIOŚ na znacznik czasu.
+ * @param date Data w formacie "yyyy-MM-dd HH:mm:ss".
+ * @param ok Opcjonalny wskaźnik powodzenia.
+ * @return Znacznik czasu w sekundach od epoki.
+ *
+ * Stały format jest parsowany bez QDateTime; inne formaty ISO obsługuje QDateTime. Data
+ * spoza kalendarza (np. 30 lutego) nie jest przenoszona na kolejny miesiąc, tylko trafia do
+ * QDateTime, które ją odrzuca, więc wynik nie zależy od ścieżki parsowania.
+ */
+qint64 SensorSeries::parseTimestamp(const QString &date, bool *ok)
+{
+    if (date.size() >= 19 && date.at(4) == u'-' && date.at(7) == u'-'
+        && (date.at(10) == u' ' || date.at(10) == u'T') && date.at(13) == u':' && date.at(16) == u':') {
+        const int year = readNumber(date, 0, 4);
+        const int month = readNumber(date, 5, 2);
+        const int day = readNumber(date, 8, 2);
+        const int hour = readNumber(date, 11, 2);
+        const int minute = readNumber(date, 14, 2);
+        const int second = readNumber(date, 17, 2);
+        if (year >= 0 && month >= 1 && month <= 12 && day >= 1 && day <= daysInMonth(year, month)
+            && hour >= 0 && hour < 24 && minute >= 0 && minute < 60 && second >= 0 && second < 60) {
+            if (ok)
+                *ok = true;
+            return daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+        }
+    }
+
+    QDateTime parsed = QDateTime::fromString(date, Qt::ISODate);
+    if (ok)
+        *ok = parsed.isValid();
+    if (!parsed.isValid())
+        return 0;
+    parsed.setTimeZone(QTimeZone::utc());
+    return parsed.toSecsSinceEpoch();
+}
+
+/**
+ * @brief Zamienia znacznik czasu na datę w formacie GIOŚ.
+ * @param timestamp Znacznik czasu w sekundach od epoki.
+ * @return Data w formacie "yyyy-MM-dd HH:mm:ss".
+ */
+QString SensorSeries::formatTimestamp(qint64 timestamp)
+{
+    return QDateTime::fromSecsSinceEpoch(timestamp, QTimeZone::utc()).toString("yyyy-MM-dd HH:mm:ss");
+}
+
+/**
+ * @brief Łączy szereg z nowszą odpowiedzią dla tego samego sensora.
+ * @param base Dotychczasowy szereg (uporządkowany rosnąco według czasu).
+ * @param update Nowe pomiary (uporządkowane rosnąco według czasu).
+ * @param changed Opcjonalnie: liczba pomiarów dodanych lub poprawionych.
+ * @return Połączony szereg.
+ *
+ * Oba szeregi są przeglądane jednocześnie, więc koszt jest liniowy względem ich długości.
+ */
+SensorSeries SensorSeries::merged(const SensorSeries &base, const SensorSeries &update, int *changed)
+{
+    SensorSeries result;
+    result.reserve(base.size() + update.size());
+    int count = 0;
+    int i = 0;
+    int j = 0;
+    while (i < base.size() || j < update.size()) {
+        if (j >= update.size() || (i < base.size() && base.timestamp(i) < update.timestamp(j))) {
+            result.append(base.timestamp(i), base.value(i), base.isNull(i));
+            ++i;
+        } else if (i >= base.size() || update.timestamp(j) < base.timestamp(i)) {
+            result.append(update.timestamp(j), update.value(j), update.isNull(j));
+            ++count;
+            ++j;
+        } else {
+            const bool same = base.isNull(i) == update.isNull(j) && (update.isNull(j) || base.value(i) == update.value(j));
+            if (same || update.isNull(j)) {
+                result.append(base.timestamp(i), base.value(i), base.isNull(i));
+            } else {
+                result.append(update.timestamp(j), update.value(j), false);
+                ++count;
+            }
+            ++i;
+            ++j;
+        }
+    }
+    if (changed)
+        *changed = count;
+    return result;
+}
+
+/**
+ * @brief Konstruktor obiektu SensorSeriesStore.
+ * @param parent Rodzic QObject.
+ */
+SensorSeriesStore::SensorSeriesStore(QObject *parent)
+    : QObject(parent)
+{
+}
+
+/**
+ * @brief Pobiera szereg sensora.
+ * @param sensorId Identyfikator sensora.
+ * @return Wskaźnik na szereg lub nullptr.
+ */
+const SensorSeries *SensorSeriesStore::series(int sensorId) const
+{
+    auto it = m_series.constFind(sensorId);
+    return it == m_series.constEnd() ? nullptr : &it.value();
+}
+
+/**
+ * @brief Ustawia szereg sensora.
+ * @param sensorId Identyfikator sensora.
+ * @param series Szereg.
+ */
+void SensorSeriesStore::setSeries(int sensorId, const SensorSeries &series)
+{
+    m_series.insert(sensorId, series);
+    m_rollups[sensorId].build(series);
+    m_statistics.remove(sensorId);
+    ++m_revision;
+    emit seriesChanged(sensorId);
+    emit revisionChanged();
+}
+
+/**
+ * @brief Ustawia szereg sensora, przejmując jego dane.
+ * @param sensorId Identyfikator sensora.
+ * @param series Szereg (uporządkowany rosnąco według czasu).
+ */
+void SensorSeriesStore::setSeries(int sensorId, SensorSeries &&series)
+{
+    const auto it = m_series.insert(sensorId, std::move(series));
+    m_rollups[sensorId].build(it.value());
+    m_statistics.remove(sensorId);
+    ++m_revision;
+    emit seriesChanged(sensorId);
+    emit revisionChanged();
+}
+
+/**
+ * @brief Dołącza do szeregu sensora nowe i poprawione pomiary.
+ * @param sensorId Identyfikator sensora.
+ * @param update Pomiary z kolejnej odpowiedzi.
+ * @return Liczba pomiarów dodanych lub poprawionych.
+ */
+int SensorSeriesStore::mergeSeries(int sensorId, const SensorSeries &update)
+{
+    const auto it = m_series.find(sensorId);
+    if (it == m_series.end())
+        return 0;
+
+    int changed = 0;
+    SensorSeries merged = SensorSeries::merged(it.value(), update, &changed);
+    if (changed == 0)
+        return 0;
+
+    it.value() = std::move(merged);
+    // Przeliczane są tylko doby i miesiące objęte nowymi pomiarami
+    m_rollups[sensorId].update(it.value(), update.timestamp(0), update.timestamp(update.size() - 1));
+    m_statistics.remove(sensorId);
+    ++m_revision;
+    emit seriesChanged(sensorId);
+    emit revisionChanged();
+    return changed;
+}
+
+/**
+ * @brief Ustawia szeregi wielu sensorów jedną zmianą.
+ * @param batch Szeregi według identyfikatora sensora.
+ */
+void SensorSeriesStore::setSeriesBatch(QHash<int, SensorSeries> &&batch)
+{
+    if (batch.isEmpty())
+        return;
+
+    QList<int> sensorIds;
+    sensorIds.reserve(batch.size());
+    for (auto it = batch.begin(); it != batch.end(); ++it) {
+        const auto inserted = m_series.insert(it.key(), std::move(it.value()));
+        m_rollups[it.key()].build(inserted.value());
+        m_statistics.remove(it.key());
+        sensorIds.append(it.key());
+    }
+    batch.clear();
+
+    ++m_revision;
+    emit seriesBatchChanged(sensorIds);
+    emit revisionChanged();
+}
+
+/**
+ * @brief Usuwa szereg sensora.
+ * @param sensorId Identyfikator sensora.
+ * @return True, jeśli szereg istniał.
+ */
+bool SensorSeriesStore::remove(int sensorId)
+{
+    if (!m_series.remove(sensorId))
+        return false;
+    m_rollups.remove(sensorId);
+    m_statistics.remove(sensorId);
+
+    ++m_revision;
+    emit seriesRemoved(sensorId);
+    emit revisionChanged();
+    return true;
+}
+
+/**
+ * @brief Usuwa wszystkie szeregi.
+ */
+void SensorSeriesStore::clear()
+{
+    if (m_series.isEmpty())
+        return;
+
+    m_series.clear();
+    m_rollups.clear();
+    m_statistics.clear();
+    ++m_revision;
+    emit cleared();
+    emit revisionChanged();
+}
+
+/**
+ * @brief Szacuje pamięć zajmowaną przez wszystkie szeregi.
+ * @return Liczba bajtów.
+ */
+qsizetype SensorSeriesStore::memoryUsage() const
+{
+    qsizetype total = 0;
+    for (const SensorSeries &series : m_series)
+        total += series.memoryUsage();
+    for (const SeriesRollup &rollup : m_rollups)
+        total += rollup.memoryUsage();
+    return total;
+}
+
+/**
+ * @brief Pobiera liczbę punktów szeregu.
+ * @param sensorId Identyfikator sensora.
+ * @return Liczba punktów.
+ */
+int SensorSeriesStore::size(int sensorId) const
+{
+    const SensorSeries *found = series(sensorId);
+    return found ? found->size() : 0;
+}
+
+/**
+ * @brief Pobiera znaczniki czasu szeregu.
+ * @param sensorId Identyfikator sensora.
+ * @return Znaczniki czasu w milisekundach.
+ */
+QList<double> SensorSeriesStore::timestamps(int sensorId) const
+{
+    QList<double> result;
+    const SensorSeries *found = series(sensorId);
+    if (!found)
+        return result;
+
+    result.reserve(found->size());
+    for (qint64 timestamp : found->timestamps())
+        result.append(double(timestamp) * 1000.0);
+    return result;
+}
+
+/**
+ * @brief Pobiera wartości szeregu.
+ * @param sensorId Identyfikator sensora.
+ * @return Wartości pomiarów; puste pomiary jako NaN.
+ */
+QList<double> SensorSeriesStore::values(int sensorId) const
+{
+    QList<double> result;
+    const SensorSeries *found = series(sensorId);
+    if (!found)
+        return result;
+
+    result.reserve(found->size());
+    for (int i = 0; i < found->size(); ++i)
+        result.append(found->isNull(i) ? std::numeric_limits<double>::quiet_NaN() : found->value(i));
+    return result;
+}
+
+/**
+ * @brief Pobiera agregaty szeregu sensora.
+ * @param sensorId Identyfikator sensora.
+ * @return Wskaźnik na agregaty lub nullptr.
+ */
+const SeriesRollup *SensorSeriesStore::rollup(int sensorId) const
+{
+    auto it = m_rollups.constFind(sensorId);
+    return it == m_rollups.constEnd() ? nullptr : &it.value();
+}
+
+/**
+ * @brief Pobiera szereg sensora z przedziału czasu w wybranej rozdzielczości.
+ * @param sensorId Identyfikator sensora.
+ * @param from Początek przedziału.
+ * @param to Koniec przedziału.
+ * @param resolution Rozdzielczość.
+ * @param used Opcjonalnie: rozdzielczość faktycznie użyta.
+ * @return Okresy z co najmniej jednym niepustym pomiarem.
+ *
+ * Dla Auto długość przedziału jest przycinana do zakresu danych, więc krótki szereg
+ * w szerokim oknie nadal jest zwracany bez agregacji.
+ */
+QVector<SeriesBucket> SensorSeriesStore::querySeries(int sensorId, qint64 from, qint64 to, Resolution resolution,
+                                                     Resolution *used) const
+{
+    const SensorSeries *found = series(sensorId);
+    const SeriesRollup *rollups = rollup(sensorId);
+    if (resolution == Auto) {
+        resolution = Raw;
+        if (found && !found->isEmpty()) {
+            const qint64 span = qMin(to, found->timestamp(found->size() - 1)) - qMax(from, found->timestamp(0));
+            if (span > qint64(kAutoMaxPoints) * 86400)
+                resolution = Monthly;
+            else if (span > qint64(kAutoMaxPoints) * 3600)
+                resolution = Daily;
+        }
+    }
+    if (used)
+        *used = resolution;
+
+    QVector<SeriesBucket> result;
+    if (!found || !rollups || from > to)
+        return result;
+
+    if (resolution == Daily)
+        return SeriesRollup::slice(rollups->daily(), SeriesRollup::dayStart(from), to);
+    if (resolution == Monthly)
+        return SeriesRollup::slice(rollups->monthly(), SeriesRollup::monthStart(from), to);
+
+    const QVector<qint64> &timestamps = found->timestamps();
+    const int first = int(std::lower_bound(timestamps.cbegin(), timestamps.cend(), from) - timestamps.cbegin());
+    const int last = int(std::upper_bound(timestamps.cbegin(), timestamps.cend(), to) - timestamps.cbegin());
+    result.reserve(last - first);
+    for (int i = first; i < last; ++i) {
+        if (found->isNull(i))
+            continue;
+        SeriesBucket point;
+        point.start = found->timestamp(i);
+        point.add(found->value(i));
+        result.append(point);
+    }
+    return result;
+}
+
+/**
+ * @brief Pobiera szereg sensora z przedziału czasu dla QML.
+ * @param sensorId Identyfikator sensora.
+ * @param fromMs Początek zakresu w milisekundach.
+ * @param toMs Koniec zakresu w milisekundach.
+ * @param resolution Rozdzielczość.
+ * @return Mapa z polami resolution, timestamps, values, min, max i counts.
+ */
+QVariantMap SensorSeriesStore::seriesInRange(int sensorId, double fromMs, double toMs, int resolution) const
+{
+    Resolution used = Raw;
+    const QVector<SeriesBucket> buckets = querySeries(sensorId, qint64(std::ceil(fromMs / 1000.0)),
+                                                      qint64(std::floor(toMs / 1000.0)),
+                                                      Resolution(qBound(int(Raw), resolution, int(Auto))), &used);
+    QList<double> timestamps;
+    QList<double> means;
+    QList<double> minimums;
+    QList<double> maximums;
+    QList<int> counts;
+    timestamps.reserve(buckets.size());
+    means.reserve(buckets.size());
+    minimums.reserve(buckets.size());
+    maximums.reserve(buckets.size());
+    counts.reserve(buckets.size());
+    for (const SeriesBucket &bucket : buckets) {
+        timestamps.append(double(bucket.start) * 1000.0);
+        means.append(bucket.mean());
+        minimums.append(bucket.min);
+        maximums.append(bucket.max);
+        counts.append(bucket.count);
+    }
+
+    QVariantMap result;
+    result["resolution"] = int(used);
+    result["timestamps"] = QVariant::fromValue(timestamps);
+    result["values"] = QVariant::fromValue(means);
+    result["min"] = QVariant::fromValue(minimums);
+    result["max"] = QVariant::fromValue(maximums);
+    result["counts"] = QVariant::fromValue(counts);
+    return result;
+}
+
+/**
+ * @brief Ustawia normę używaną do liczenia przekroczeń.
+ * @param sensorId Identyfikator sensora.
+ * @param threshold Norma w µg/m³.
+ * @param dayRule Reguła liczenia dni z przekroczeniem.
+ */
+void SensorSeriesStore::setExceedanceThreshold(int sensorId, double threshold, SensorStatistics::DayRule dayRule)
+{
+    auto it = m_thresholds.constFind(sensorId);
+    if (it != m_thresholds.constEnd() && (it.value() == threshold || (std::isnan(it.value()) && std::isnan(threshold)))
+        && m_dayRules.value(sensorId) == dayRule)
+        return;
+
+    m_thresholds.insert(sensorId, threshold);
+    m_dayRules.insert(sensorId, dayRule);
+    m_statistics.remove(sensorId);
+    if (m_series.contains(sensorId)) {
+        ++m_revision;
+        emit revisionChanged();
+    }
+}
+
+/**
+ * @brief Pobiera statystyki szeregu sensora.
+ * @param sensorId Identyfikator sensora.
+ * @return Statystyki.
+ */
+SensorStatistics SensorSeriesStore::statisticsFor(int sensorId) const
+{
+    auto cached = m_statistics.constFind(sensorId);
+    if (cached != m_statistics.constEnd())
+        return cached.value();
+
+    const SensorSeries *found = series(sensorId);
+    if (!found)
+        return SensorStatistics();
+
+    const double threshold = m_thresholds.value(sensorId, std::numeric_limits<double>::quiet_NaN());
+    const SensorStatistics stats = SensorStatistics::compute(*found, threshold, m_dayRules.value(sensorId));
+    m_statistics.insert(sensorId, stats);
+    return stats;
+}
+
+/**
+ * @brief Pobiera statystyki szeregu sensora dla QML.
+ * @param sensorId Identyfikator sensora.
+ * @return Mapa statystyk.
+ */
+QVariantMap SensorSeriesStore::statistics(int sensorId) const
+{
+    return statisticsFor(sensorId).toVariantMap();
+}
+
+/**
+ * @brief Pobiera statystyki fragmentu szeregu.
+ * @param sensorId Identyfikator sensora.
+ * @param fromMs Początek zakresu w milisekundach.
+ * @param toMs Koniec zakresu w milisekundach.
+ * @return Mapa statystyk.
+ */
+QVariantMap SensorSeriesStore::statisticsInRange(int sensorId, double fromMs, double toMs) const
+{
+    const double threshold = m_thresholds.value(sensorId, std::numeric_limits<double>::quiet_NaN());
+    const SensorSeries *found = series(sensorId);
+    if (!found)
+        return SensorStatistics().toVariantMap();
+
+    const QVector<qint64> &timestamps = found->timestamps();
+    const qint64 from = qint64(std::ceil(fromMs / 1000.0));
+    const qint64 to = qint64(std::floor(toMs / 1000.0));
+    const int first = int(std::lower_bound(timestamps.cbegin(), timestamps.cend(), from) - timestamps.cbegin());
+    const int last = int(std::upper_bound(timestamps.cbegin(), timestamps.cend(), to) - timestamps.cbegin());
+    return SensorStatistics::compute(*found, first, last, threshold, m_dayRules.value(sensorId)).toVariantMap();
+}
+
+/**
+ * @brief Pobiera ostatni niepusty pomiar.
+ * @param sensorId Identyfikator sensora.
+ * @return Wartość pomiaru lub NaN.
+ */
+double SensorSeriesStore::latestValue(int sensorId) const
+{
+    const SensorSeries *found = series(sensorId);
+    const int index = found ? latestIndex(*found) : -1;
+    return index >= 0 ? found->value(index) : std::numeric_limits<double>::quiet_NaN();
+}
+
+/**
+ * @brief Pobiera datę ostatniego niepustego pomiaru.
+ * @param sensorId Identyfikator sensora.
+ * @return Data w formacie "yyyy-MM-dd HH:mm:ss" lub pusty tekst.
+ */
+QString SensorSeriesStore::latestDate(int sensorId) const
+{
+    const SensorSeries *found = series(sensorId);
+    const int index = found ? latestIndex(*found) : -1;
+    return index >= 0 ? SensorSeries::formatTimestamp(found->timestamp(index)) : QString();
+}
+
+/**
+ * @brief Wyszukuje indeks ostatniego niepustego pomiaru.
+ * @param series Szereg.
+ * @return Indeks punktu lub -1.
+ */
+int SensorSeriesStore::latestIndex(const SensorSeries &series)
+{
+    for (int i = series.size() - 1; i >= 0; --i) {
+        if (!series.isNull(i))
+            return i;
+    }
+    return -1;
+}
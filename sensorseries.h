@@ -0,0 +1,404 @@
+/**
+ * @file sensorseries.h
+ * @brief Plik nagłówkowy dla klas SensorSeries i SensorSeriesStore.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje kolumnowy magazyn szeregów czasowych pomiarów sensorów.
+ */
+
+#ifndef SENSORSERIES_H
+#define SENSORSERIES_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+#include "sensorstatistics.h"
+#include "seriesrollup.h"
+
+/**
+ * @class SensorSeries
+ * @brief Szereg czasowy jednego sensora w układzie kolumnowym.
+ *
+ * Znaczniki czasu (sekundy od epoki) i wartości przechowywane są w ciągłych tablicach,
+ * a brakujące pomiary oznaczane w mapie bitowej. Czas jest czasem ściennym GIOŚ
+ * zakodowanym jako UTC, więc nie zależy od strefy czasowej komputera.
+ * Punkty są uporządkowane rosnąco według czasu.
+ */
+class SensorSeries {
+public:
+    /**
+     * @brief Rezerwuje miejsce na punkty.
+     * @param size Oczekiwana liczba punktów.
+     */
+    void reserve(int size);
+
+    /**
+     * @brief Dodaje punkt pomiarowy.
+     * @param timestamp Znacznik czasu w sekundach od epoki.
+     * @param value Wartość pomiaru.
+     * @param isNull True, jeśli pomiar jest pusty.
+     *
+     * Punkty mogą być dodawane w dowolnej kolejności; przed odczytem należy wywołać sortByTime().
+     */
+    void append(qint64 timestamp, double value, bool isNull = false);
+
+    /**
+     * @brief Porządkuje punkty rosnąco według czasu.
+     *
+     * Szereg malejący (kolejność zwracana przez API GIOŚ) jest odwracany bez sortowania.
+     */
+    void sortByTime();
+
+    /**
+     * @brief Pobiera liczbę punktów.
+     * @return Liczba punktów.
+     */
+    int size() const { return m_timestamps.size(); }
+
+    /**
+     * @brief Sprawdza, czy szereg jest pusty.
+     * @return True, jeśli szereg nie zawiera punktów.
+     */
+    bool isEmpty() const { return m_timestamps.isEmpty(); }
+
+    /**
+     * @brief Pobiera znacznik czasu punktu.
+     * @param index Indeks punktu.
+     * @return Znacznik czasu w sekundach od epoki.
+     */
+    qint64 timestamp(int index) const { return m_timestamps.at(index); }
+
+    /**
+     * @brief Pobiera wartość punktu.
+     * @param index Indeks punktu.
+     * @return Wartość pomiaru (0 dla pustego pomiaru).
+     */
+    double value(int index) const { return m_values.at(index); }
+
+    /**
+     * @brief Sprawdza, czy pomiar jest pusty.
+     * @param index Indeks punktu.
+     * @return True, jeśli pomiar jest pusty.
+     */
+    bool isNull(int index) const { return m_nullMask.at(index >> 6) & (quint64(1) << (index & 63)); }
+
+    /**
+     * @brief Pobiera tablicę znaczników czasu.
+     * @return Znaczniki czasu w sekundach od epoki.
+     */
+    const QVector<qint64> &timestamps() const { return m_timestamps; }
+
+    /**
+     * @brief Pobiera tablicę wartości.
+     * @return Wartości pomiarów (0 dla pustych pomiarów).
+     */
+    const QVector<double> &values() const { return m_values; }
+
+    /**
+     * @brief Pobiera mapę bitową pustych pomiarów.
+     * @return Słowa mapy bitowej; bit i oznacza pusty pomiar o indeksie i.
+     */
+    const QVector<quint64> &nullMask() const { return m_nullMask; }
+
+    /**
+     * @brief Szacuje pamięć zajmowaną przez szereg.
+     * @return Liczba bajtów zarezerwowanych na dane.
+     */
+    qsizetype memoryUsage() const;
+
+    /**
+     * @brief Zamienia datę w formacie GIOŚ na znacznik czasu.
+     * @param date Data w formacie "yyyy-MM-dd HH:mm:ss" (dopuszczalny także separator "T").
+     * @param ok Opcjonalny wskaźnik powodzenia.
+     * @return Znacznik czasu w sekundach od epoki (czas ścienny jako UTC).
+     */
+    static qint64 parseTimestamp(const QString &date, bool *ok = nullptr);
+
+    /**
+     * @brief Zamienia znacznik czasu na datę w formacie GIOŚ.
+     * @param timestamp Znacznik czasu w sekundach od epoki.
+     * @return Data w formacie "yyyy-MM-dd HH:mm:ss".
+     */
+    static QString formatTimestamp(qint64 timestamp);
+
+    /**
+     * @brief Łączy szereg z nowszą odpowiedzią dla tego samego sensora.
+     * @param base Dotychczasowy szereg (uporządkowany rosnąco według czasu).
+     * @param update Nowe pomiary (uporządkowane rosnąco według czasu).
+     * @param changed Opcjonalnie: liczba pomiarów dodanych lub poprawionych.
+     * @return Szereg ze wszystkimi znacznikami czasu obu szeregów.
+     *
+     * Dla wspólnego znacznika czasu obowiązuje wartość z update, chyba że jest pusta;
+     * pusty pomiar nie zastępuje zapisanej wartości (jak w HistoryStore::merge()).
+     */
+    static SensorSeries merged(const SensorSeries &base, const SensorSeries &update, int *changed = nullptr);
+
+private:
+    QVector<qint64> m_timestamps;  ///< Znaczniki czasu w sekundach od epoki.
+    QVector<double> m_values;      ///< Wartości pomiarów.
+    QVector<quint64> m_nullMask;   ///< Mapa bitowa pustych pomiarów.
+};
+
+/**
+ * @class SensorSeriesStore
+ * @brief Magazyn szeregów czasowych sensorów udostępniany w QML.
+ *
+ * QML odczytuje dane przez typowane metody zamiast kopiować całe drzewo QVariant.
+ * Puste pomiary są zwracane jako NaN. Dla każdego szeregu utrzymywane są agregaty dobowe
+ * i miesięczne (SeriesRollup): budowane przy ustawieniu szeregu (np. z archiwum)
+ * i przeliczane przyrostowo przy dołączaniu pomiarów, dzięki czemu zapytanie o rok
+ * danych zwraca kilkaset punktów zamiast kilku tysięcy pomiarów godzinowych.
+ */
+class SensorSeriesStore : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(int revision READ revision NOTIFY revisionChanged)
+
+public:
+    /**
+     * @brief Rozdzielczość zapytania o szereg.
+     */
+    enum Resolution {
+        Raw,      ///< Pomiary bez agregacji.
+        Daily,    ///< Agregaty dobowe.
+        Monthly,  ///< Agregaty miesięczne.
+        Auto      ///< Najdokładniejsza rozdzielczość dająca najwyżej kAutoMaxPoints punktów.
+    };
+    Q_ENUM(Resolution)
+
+    /// Największa liczba okresów w przedziale, dla której Auto wybiera daną rozdzielczość.
+    static constexpr int kAutoMaxPoints = 1000;
+
+    /**
+     * @brief Konstruktor obiektu SensorSeriesStore.
+     * @param parent Rodzic QObject.
+     */
+    explicit SensorSeriesStore(QObject *parent = nullptr);
+
+    /**
+     * @brief Pobiera numer zmiany magazynu.
+     * @return Licznik zwiększany przy każdej zmianie danych.
+     */
+    int revision() const { return m_revision; }
+
+    /**
+     * @brief Pobiera szereg sensora.
+     * @param sensorId Identyfikator sensora.
+     * @return Wskaźnik na szereg lub nullptr.
+     */
+    const SensorSeries *series(int sensorId) const;
+
+    /**
+     * @brief Ustawia szereg sensora.
+     * @param sensorId Identyfikator sensora.
+     * @param series Szereg (uporządkowany rosnąco według czasu).
+     */
+    void setSeries(int sensorId, const SensorSeries &series);
+
+    /**
+     * @brief Ustawia szereg sensora, przejmując jego dane.
+     * @param sensorId Identyfikator sensora.
+     * @param series Szereg (uporządkowany rosnąco według czasu).
+     */
+    void setSeries(int sensorId, SensorSeries &&series);
+
+    /**
+     * @brief Ustawia szeregi wielu sensorów jedną zmianą.
+     * @param batch Szeregi według identyfikatora sensora.
+     *
+     * Emituje jeden sygnał seriesBatchChanged() i jeden revisionChanged() zamiast
+     * osobnych sygnałów dla każdego sensora.
+     */
+    void setSeriesBatch(QHash<int, SensorSeries> &&batch);
+
+    /**
+     * @brief Dołącza do szeregu sensora nowe i poprawione pomiary.
+     * @param sensorId Identyfikator sensora.
+     * @param update Pomiary z kolejnej odpowiedzi (uporządkowane rosnąco według czasu).
+     * @return Liczba pomiarów dodanych lub poprawionych.
+     *
+     * Sygnały seriesChanged() i revisionChanged() są emitowane tylko wtedy, gdy szereg
+     * się zmienił. Sensor bez szeregu w magazynie jest pomijany.
+     */
+    int mergeSeries(int sensorId, const SensorSeries &update);
+
+    /**
+     * @brief Usuwa szereg sensora.
+     * @param sensorId Identyfikator sensora.
+     * @return True, jeśli szereg istniał.
+     */
+    bool remove(int sensorId);
+
+    /**
+     * @brief Usuwa wszystkie szeregi.
+     */
+    void clear();
+
+    /**
+     * @brief Pobiera identyfikatory sensorów z danymi.
+     * @return Lista identyfikatorów.
+     */
+    Q_INVOKABLE QList<int> sensorIds() const { return m_series.keys(); }
+
+    /**
+     * @brief Szacuje pamięć zajmowaną przez wszystkie szeregi.
+     * @return Liczba bajtów.
+     */
+    qsizetype memoryUsage() const;
+
+    /**
+     * @brief Sprawdza, czy sensor ma dane.
+     * @param sensorId Identyfikator sensora.
+     * @return True, jeśli szereg istnieje.
+     */
+    Q_INVOKABLE bool contains(int sensorId) const { return m_series.contains(sensorId); }
+
+    /**
+     * @brief Pobiera liczbę punktów szeregu.
+     * @param sensorId Identyfikator sensora.
+     * @return Liczba punktów (0, jeśli brak danych).
+     */
+    Q_INVOKABLE int size(int sensorId) const;
+
+    /**
+     * @brief Pobiera znaczniki czasu szeregu.
+     * @param sensorId Identyfikator sensora.
+     * @return Znaczniki czasu w milisekundach (zgodne z Date w JavaScript, czas ścienny jako UTC).
+     */
+    Q_INVOKABLE QList<double> timestamps(int sensorId) const;
+
+    /**
+     * @brief Pobiera wartości szeregu.
+     * @param sensorId Identyfikator sensora.
+     * @return Wartości pomiarów; puste pomiary jako NaN.
+     */
+    Q_INVOKABLE QList<double> values(int sensorId) const;
+
+    /**
+     * @brief Pobiera agregaty szeregu sensora.
+     * @param sensorId Identyfikator sensora.
+     * @return Wskaźnik na agregaty lub nullptr.
+     */
+    const SeriesRollup *rollup(int sensorId) const;
+
+    /**
+     * @brief Pobiera szereg sensora z przedziału czasu w wybranej rozdzielczości.
+     * @param sensorId Identyfikator sensora.
+     * @param from Początek przedziału (sekundy od epoki, włącznie).
+     * @param to Koniec przedziału (sekundy od epoki, włącznie).
+     * @param resolution Rozdzielczość; Auto wybiera ją według długości przedziału.
+     * @param used Opcjonalnie: rozdzielczość faktycznie użyta.
+     * @return Okresy z co najmniej jednym niepustym pomiarem; dla Raw każdy pomiar to osobny okres.
+     *
+     * Przedział wyznaczany jest wyszukiwaniem binarnym w znacznikach czasu lub agregatach,
+     * a agregaty dobowe i miesięczne są gotowe, więc koszt zależy od liczby zwróconych okresów.
+     */
+    QVector<SeriesBucket> querySeries(int sensorId, qint64 from, qint64 to, Resolution resolution,
+                                      Resolution *used = nullptr) const;
+
+    /**
+     * @brief Pobiera szereg sensora z przedziału czasu dla QML.
+     * @param sensorId Identyfikator sensora.
+     * @param fromMs Początek zakresu w milisekundach (włącznie).
+     * @param toMs Koniec zakresu w milisekundach (włącznie).
+     * @param resolution Rozdzielczość (wartość Resolution).
+     * @return Mapa z polami resolution, timestamps (ms), values (średnie), min, max i counts.
+     */
+    Q_INVOKABLE QVariantMap seriesInRange(int sensorId, double fromMs, double toMs, int resolution = Auto) const;
+
+    /**
+     * @brief Ustawia normę używaną do liczenia przekroczeń.
+     * @param sensorId Identyfikator sensora.
+     * @param threshold Norma w µg/m³ (NaN wyłącza liczenie przekroczeń).
+     * @param dayRule Reguła liczenia dni z przekroczeniem.
+     */
+    void setExceedanceThreshold(int sensorId, double threshold,
+                                SensorStatistics::DayRule dayRule = SensorStatistics::DailyMean);
+
+    /**
+     * @brief Pobiera statystyki szeregu sensora.
+     * @param sensorId Identyfikator sensora.
+     * @return Statystyki (z pamięci podręcznej, jeśli szereg się nie zmienił).
+     */
+    SensorStatistics statisticsFor(int sensorId) const;
+
+    /**
+     * @brief Pobiera statystyki szeregu sensora dla QML.
+     * @param sensorId Identyfikator sensora.
+     * @return Mapa z polami min, max, mean, stddev, p50, p95, p98, exceedances, exceedanceDays i innymi.
+     *
+     * Wynik jest przechowywany do czasu zmiany szeregu tego sensora lub jego normy.
+     */
+    Q_INVOKABLE QVariantMap statistics(int sensorId) const;
+
+    /**
+     * @brief Pobiera statystyki fragmentu szeregu (np. wybranych dni lub miesięcy archiwum).
+     * @param sensorId Identyfikator sensora.
+     * @param fromMs Początek zakresu w milisekundach (włącznie).
+     * @param toMs Koniec zakresu w milisekundach (włącznie).
+     * @return Mapa statystyk jak w statistics(); wynik nie jest przechowywany.
+     */
+    Q_INVOKABLE QVariantMap statisticsInRange(int sensorId, double fromMs, double toMs) const;
+
+    /**
+     * @brief Pobiera ostatni niepusty pomiar.
+     * @param sensorId Identyfikator sensora.
+     * @return Wartość pomiaru lub NaN.
+     */
+    Q_INVOKABLE double latestValue(int sensorId) const;
+
+    /**
+     * @brief Pobiera datę ostatniego niepustego pomiaru.
+     * @param sensorId Identyfikator sensora.
+     * @return Data w formacie "yyyy-MM-dd HH:mm:ss" lub pusty tekst.
+     */
+    Q_INVOKABLE QString latestDate(int sensorId) const;
+
+signals:
+    /**
+     * @brief Sygnał emitowany, gdy zmieni się szereg sensora.
+     * @param sensorId Identyfikator sensora.
+     */
+    void seriesChanged(int sensorId);
+
+    /**
+     * @brief Sygnał emitowany, gdy jedną zmianą ustawiono szeregi wielu sensorów.
+     * @param sensorIds Identyfikatory zmienionych sensorów.
+     */
+    void seriesBatchChanged(const QList<int> &sensorIds);
+
+    /**
+     * @brief Sygnał emitowany, gdy szereg sensora zostanie usunięty.
+     * @param sensorId Identyfikator sensora.
+     */
+    void seriesRemoved(int sensorId);
+
+    /**
+     * @brief Sygnał emitowany po usunięciu wszystkich szeregów.
+     */
+    void cleared();
+
+    /**
+     * @brief Sygnał emitowany po każdej zmianie danych.
+     */
+    void revisionChanged();
+
+private:
+    /**
+     * @brief Wyszukuje indeks ostatniego niepustego pomiaru.
+     * @param series Szereg.
+     * @return Indeks punktu lub -1.
+     */
+    static int latestIndex(const SensorSeries &series);
+
+    QHash<int, SensorSeries> m_series;  ///< Szeregi według identyfikatora sensora.
+    QHash<int, SeriesRollup> m_rollups; ///< Agregaty dobowe i miesięczne według identyfikatora sensora.
+    QHash<int, double> m_thresholds;    ///< Normy przekroczeń według identyfikatora sensora.
+    QHash<int, SensorStatistics::DayRule> m_dayRules; ///< Reguły dni z przekroczeniem według identyfikatora sensora.
+    mutable QHash<int, SensorStatistics> m_statistics; ///< Statystyki wyznaczone od ostatniej zmiany szeregu.
+    int m_revision = 0;                 ///< Licznik zmian danych.
+};
+
+#endif // SENSORSERIES_H
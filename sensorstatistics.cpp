@@ -0,0 +1,281 @@
+/**
+ * @file sensorstatistics.cpp
+ * @brief Implementacja struktury SensorStatistics.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera wyznaczanie statystyk szeregu czasowego sensora na ciągłych tablicach wartości.
+ */
+
+#include "sensorstatistics.h"
+#include "sensorseries.h"
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+/**
+ * @brief Wyznacza percentyl interpolacją liniową.
+ * @param values Wartości (kolejność zostaje zmieniona).
+ * @param fraction Rząd percentyla z przedziału [0, 1].
+ * @return Wartość percentyla.
+ */
+double percentile(QVector<double> &values, double fraction)
+{
+    const double rank = fraction * (values.size() - 1);
+    const int lower = int(std::floor(rank));
+    auto lowerIt = values.begin() + lower;
+    std::nth_element(values.begin(), lowerIt, values.end());
+    const double lowerValue = *lowerIt;
+    if (lower + 1 >= values.size())
+        return lowerValue;
+
+    // Po nth_element wszystkie dalsze elementy są nie mniejsze, więc kolejna wartość to ich minimum
+    const double upperValue = *std::min_element(lowerIt + 1, values.end());
+    return lowerValue + (upperValue - lowerValue) * (rank - lower);
+}
+
+/**
+ * @brief Wyznacza numer dnia dla znacznika czasu.
+ * @param timestamp Znacznik czasu w sekundach od epoki.
+ * @return Liczba dni od epoki (zaokrąglona w dół także dla czasu sprzed epoki).
+ */
+qint64 dayOf(qint64 timestamp)
+{
+    return timestamp >= 0 ? timestamp / 86400 : (timestamp - 86399) / 86400;
+}
+}
+
+/**
+ * @brief Zamienia statystyki na mapę dla QML.
+ * @return Mapa z polami statystyk.
+ */
+QVariantMap SensorStatistics::toVariantMap() const
+{
+    QVariantMap map;
+    map["count"] = count;
+    map["nullCount"] = nullCount;
+    if (!isValid())
+        return map;
+
+    map["min"] = min;
+    map["max"] = max;
+    map["mean"] = mean;
+    map["stddev"] = stddev;
+    map["p50"] = p50;
+    map["p95"] = p95;
+    map["p98"] = p98;
+    map["threshold"] = std::isnan(threshold) ? QVariant() : QVariant(threshold);
+    map["exceedances"] = exceedances;
+    map["days"] = days;
+    map["exceedanceDays"] = exceedanceDays;
+    map["dayRule"] = int(dayRule);
+    map["firstDate"] = SensorSeries::formatTimestamp(firstTimestamp);
+    map["lastDate"] = SensorSeries::formatTimestamp(lastTimestamp);
+    return map;
+}
+
+/**
+ * @brief Wyznacza statystyki fragmentu szeregu.
+ * @param series Szereg czasowy.
+ * @param first Indeks pierwszego punktu.
+ * @param last Indeks za ostatnim punktem.
+ * @param threshold Norma dla przekroczeń.
+ * @param dayRule Reguła liczenia dni z przekroczeniem.
+ * @return Statystyki.
+ *
+ * Bloki 64 punktów bez pustych pomiarów (słowo mapy bitowej równe zero) przetwarzane są
+ * pętlą bez rozgałęzień, którą kompilator może zwektoryzować.
+ */
+SensorStatistics SensorStatistics::compute(const SensorSeries &series, int first, int last, double threshold,
+                                           DayRule dayRule)
+{
+    SensorStatistics stats;
+    stats.threshold = threshold;
+    stats.dayRule = dayRule;
+    first = qMax(0, first);
+    last = qMin(series.size(), last);
+    if (first >= last)
+        return stats;
+
+    const double *values = series.values().constData();
+    const qint64 *timestamps = series.timestamps().constData();
+    const quint64 *nullMask = series.nullMask().constData();
+    const bool countExceedances = !std::isnan(threshold);
+    const double limit = countExceedances ? threshold : std::numeric_limits<double>::infinity();
+
+    QVector<double> present;
+    present.reserve(last - first);
+    double minValue = std::numeric_limits<double>::infinity();
+    double maxValue = -std::numeric_limits<double>::infinity();
+    double sum = 0.0;
+    int exceedances = 0;
+
+    for (int i = first; i < last;) {
+        const int blockEnd = qMin(last, ((i >> 6) + 1) << 6);
+        const quint64 bits = nullMask[i >> 6];
+        if (bits == 0) {
+            for (int j = i; j < blockEnd; ++j) {
+                const double value = values[j];
+                minValue = std::min(minValue, value);
+                maxValue = std::max(maxValue, value);
+                sum += value;
+                exceedances += value > limit;
+            }
+            const qsizetype offset = present.size();
+            present.resize(offset + (blockEnd - i));
+            std::copy(values + i, values + blockEnd, present.begin() + offset);
+        } else {
+            for (int j = i; j < blockEnd; ++j) {
+                if (bits & (quint64(1) << (j & 63))) {
+                    ++stats.nullCount;
+                    continue;
+                }
+                const double value = values[j];
+                minValue = std::min(minValue, value);
+                maxValue = std::max(maxValue, value);
+                sum += value;
+                exceedances += value > limit;
+                present.append(value);
+            }
+        }
+        i = blockEnd;
+    }
+
+    stats.count = present.size();
+    if (stats.count == 0)
+        return stats;
+
+    stats.min = minValue;
+    stats.max = maxValue;
+    stats.mean = sum / stats.count;
+    stats.exceedances = exceedances;
+
+    // Odchylenie standardowe w drugim przebiegu (stabilne numerycznie)
+    double squares = 0.0;
+    for (double value : std::as_const(present)) {
+        const double delta = value - stats.mean;
+        squares += delta * delta;
+    }
+    stats.stddev = std::sqrt(squares / stats.count);
+
+    stats.p50 = percentile(present, 0.50);
+    stats.p95 = percentile(present, 0.95);
+    stats.p98 = percentile(present, 0.98);
+
+    // Dni (czas ścienny GIOŚ) i dni z przekroczeniem według reguły parametru. Średnia
+    // ośmiogodzinna krocząca należy do dnia, w którym kończy się jej okno, więc pierwsze okna
+    // dnia obejmują godziny poprzedniego; liczona jest tylko przy co najmniej 6 pomiarach w oknie.
+    qint64 currentDay = std::numeric_limits<qint64>::min();
+    double daySum = 0.0;
+    int dayCount = 0;
+    bool dayHourExceeded = false;
+    bool dayWindowExceeded = false;
+    int windowFirst = first;
+    double windowSum = 0.0;
+    int windowCount = 0;
+    auto flushDay = [&]() {
+        if (dayCount == 0)
+            return;
+        ++stats.days;
+        const bool exceeded = dayRule == AnyHour ? dayHourExceeded
+                              : dayRule == RunningMean8h ? dayWindowExceeded
+                              : daySum / dayCount > limit;
+        if (countExceedances && exceeded)
+            ++stats.exceedanceDays;
+    };
+    bool firstSeen = false;
+    for (int i = first; i < last; ++i) {
+        if (series.isNull(i))
+            continue;
+        if (!firstSeen) {
+            stats.firstTimestamp = timestamps[i];
+            firstSeen = true;
+        }
+        stats.lastTimestamp = timestamps[i];
+
+        const qint64 day = dayOf(timestamps[i]);
+        if (day != currentDay) {
+            flushDay();
+            currentDay = day;
+            daySum = 0.0;
+            dayCount = 0;
+            dayHourExceeded = false;
+            dayWindowExceeded = false;
+        }
+        daySum += values[i];
+        ++dayCount;
+        dayHourExceeded = dayHourExceeded || values[i] > limit;
+
+        if (dayRule == RunningMean8h) {
+            windowSum += values[i];
+            ++windowCount;
+            for (; timestamps[windowFirst] <= timestamps[i] - 8 * 3600; ++windowFirst) {
+                if (!series.isNull(windowFirst)) {
+                    windowSum -= values[windowFirst];
+                    --windowCount;
+                }
+            }
+            if (windowCount >= kMinRunningMeanHours)
+                dayWindowExceeded = dayWindowExceeded || windowSum / windowCount > limit;
+        }
+    }
+    flushDay();
+
+    return stats;
+}
+
+/**
+ * @brief Wyznacza statystyki całego szeregu.
+ * @param series Szereg czasowy.
+ * @param threshold Norma dla przekroczeń.
+ * @param dayRule Reguła liczenia dni z przekroczeniem.
+ * @return Statystyki.
+ */
+SensorStatistics SensorStatistics::compute(const SensorSeries &series, double threshold, DayRule dayRule)
+{
+    return compute(series, 0, series.size(), threshold, dayRule);
+}
+
+/**
+ * @brief Zwraca normę dla kodu parametru GIOŚ.
+ * @param paramCode Kod parametru.
+ * @return Norma w µg/m³ lub NaN.
+ *
+ * PM10 i PM2.5: dopuszczalne stężenia dobowe/roczne, NO2 i SO2: dopuszczalne stężenia godzinowe,
+ * O3: próg informowania, CO: wartość dopuszczalna (ośmiogodzinna), C6H6: poziom roczny.
+ */
+double SensorStatistics::thresholdForParam(const QString &paramCode)
+{
+    static const QHash<QString, double> thresholds = {
+        { "PM10", 50.0 },
+        { "PM2.5", 25.0 },
+        { "NO2", 200.0 },
+        { "SO2", 350.0 },
+        { "O3", 180.0 },
+        { "CO", 10000.0 },
+        { "C6H6", 5.0 }
+    };
+    return thresholds.value(paramCode.toUpper(), std::numeric_limits<double>::quiet_NaN());
+}
+
+/**
+ * @brief Zwraca regułę liczenia dni z przekroczeniem dla kodu parametru GIOŚ.
+ * @param paramCode Kod parametru.
+ * @return Reguła dni.
+ *
+ * Normy NO2, SO2 i O3 dotyczą stężeń godzinowych, więc średnia dobowa zaniżałaby liczbę dni
+ * z przekroczeniem; dla nich liczy się dzień z choć jedną godziną powyżej normy. Norma CO dotyczy
+ * maksymalnej dobowej średniej ośmiogodzinnej kroczącej, więc pojedyncza godzina jej nie przekracza.
+ */
+SensorStatistics::DayRule SensorStatistics::dayRuleForParam(const QString &paramCode)
+{
+    static const QStringList hourly = { "NO2", "SO2", "O3" };
+    const QString code = paramCode.toUpper();
+    if (code == "CO")
+        return RunningMean8h;
+    return hourly.contains(code) ? AnyHour : DailyMean;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file sensorstatistics.h
+ * @brief Plik nagłówkowy dla struktury SensorStatistics.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje statystyki szeregu czasowego sensora: wartości skrajne, średnią,
+ * odchylenie standardowe, percentyle i przekroczenia normy.
+ */
+
+#ifndef SENSORSTATISTICS_H
+#define SENSORSTATISTICS_H
+
+#include <QString>
+#include <QVariantMap>
+
+class SensorSeries;
+
+/**
+ * @struct SensorStatistics
+ * @brief Statystyki szeregu czasowego wyznaczone w jednym przebiegu po danych.
+ *
+ * Percentyle liczone są interpolacją liniową między sąsiednimi wartościami uporządkowanymi.
+ * Przekroczenia liczone są dla pomiarów godzinowych oraz dla dni; regułę liczenia dni
+ * wybiera dayRuleForParam(): średnia dobowa dla norm dobowych (pyły, benzen), dzień z co najmniej
+ * jedną godziną powyżej normy dla norm godzinowych (NO2, SO2, O3) oraz maksymalna średnia
+ * ośmiogodzinna krocząca dla CO.
+ */
+struct SensorStatistics {
+    /**
+     * @brief Reguła liczenia dni z przekroczeniem.
+     */
+    enum DayRule {
+        DailyMean,      ///< Średnia dobowa powyżej normy.
+        AnyHour,        ///< Co najmniej jeden pomiar godzinowy powyżej normy.
+        RunningMean8h   ///< Co najmniej jedna średnia ośmiogodzinna krocząca kończąca się w danym dniu powyżej normy.
+    };
+
+    /// Najmniejsza liczba pomiarów w oknie ośmiogodzinnym (75%), dla której liczona jest średnia.
+    static constexpr int kMinRunningMeanHours = 6;
+
+    int count = 0;                 ///< Liczba niepustych pomiarów.
+    int nullCount = 0;             ///< Liczba pustych pomiarów.
+    double min = 0.0;              ///< Wartość minimalna.
+    double max = 0.0;              ///< Wartość maksymalna.
+    double mean = 0.0;             ///< Średnia.
+    double stddev = 0.0;           ///< Odchylenie standardowe (populacji).
+    double p50 = 0.0;              ///< Mediana.
+    double p95 = 0.0;              ///< Percentyl 95.
+    double p98 = 0.0;              ///< Percentyl 98.
+    double threshold = 0.0;        ///< Norma użyta do liczenia przekroczeń (NaN, jeśli brak).
+    int exceedances = 0;           ///< Liczba pomiarów powyżej normy.
+    int days = 0;                  ///< Liczba dni z co najmniej jednym pomiarem.
+    int exceedanceDays = 0;        ///< Liczba dni z przekroczeniem według dayRule.
+    DayRule dayRule = DailyMean;   ///< Reguła użyta do liczenia dni z przekroczeniem.
+    qint64 firstTimestamp = 0;     ///< Znacznik czasu pierwszego pomiaru (sekundy od epoki).
+    qint64 lastTimestamp = 0;      ///< Znacznik czasu ostatniego pomiaru (sekundy od epoki).
+
+    /**
+     * @brief Sprawdza, czy statystyki zawierają dane.
+     * @return True, jeśli był co najmniej jeden niepusty pomiar.
+     */
+    bool isValid() const { return count > 0; }
+
+    /**
+     * @brief Zamienia statystyki na mapę dla QML.
+     * @return Mapa z polami statystyk; pusta mapa z polem count = 0, jeśli brak danych.
+     */
+    QVariantMap toVariantMap() const;
+
+    /**
+     * @brief Wyznacza statystyki fragmentu szeregu.
+     * @param series Szereg czasowy.
+     * @param first Indeks pierwszego punktu.
+     * @param last Indeks za ostatnim punktem.
+     * @param threshold Norma dla przekroczeń (NaN wyłącza liczenie przekroczeń).
+     * @param dayRule Reguła liczenia dni z przekroczeniem.
+     * @return Statystyki.
+     */
+    static SensorStatistics compute(const SensorSeries &series, int first, int last, double threshold,
+                                    DayRule dayRule = DailyMean);
+
+    /**
+     * @brief Wyznacza statystyki całego szeregu.
+     * @param series Szereg czasowy.
+     * @param threshold Norma dla przekroczeń (NaN wyłącza liczenie przekroczeń).
+     * @param dayRule Reguła liczenia dni z przekroczeniem.
+     * @return Statystyki.
+     */
+    static SensorStatistics compute(const SensorSeries &series, double threshold, DayRule dayRule = DailyMean);
+
+    /**
+     * @brief Zwraca normę dla kodu parametru GIOŚ.
+     * @param paramCode Kod parametru (np. "PM10", "NO2").
+     * @return Norma w µg/m³ lub NaN dla nieznanego parametru.
+     */
+    static double thresholdForParam(const QString &paramCode);
+
+    /**
+     * @brief Zwraca regułę liczenia dni z przekroczeniem dla kodu parametru GIOŚ.
+     * @param paramCode Kod parametru.
+     * @return AnyHour dla norm godzinowych (NO2, SO2, O3), RunningMean8h dla CO, w pozostałych przypadkach DailyMean.
+     */
+    static DayRule dayRuleForParam(const QString &paramCode);
+};
+
+#endif // SENSORSTATISTICS_H
@@ -0,0 +1,217 @@
+/**
+ * @file seriesrollup.cpp
+ * @brief Implementacja struktury SeriesBucket i klasy SeriesRollup.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera agregację pomiarów w doby i miesiące oraz przyrostowe
+ * przeliczanie agregatów po zmianie fragmentu szeregu.
+ */
+
+#include "seriesrollup.h"
+#include "sensorseries.h"
+#include <QDateTime>
+#include <QTimeZone>
+#include <algorithm>
+
+/**
+ * @brief Dołącza pomiar do agregatu.
+ * @param value Wartość pomiaru.
+ */
+void SeriesBucket::add(double value)
+{
+    min = count == 0 ? value : qMin(min, value);
+    max = count == 0 ? value : qMax(max, value);
+    sum += value;
+    ++count;
+}
+
+/**
+ * @brief Dołącza inny agregat.
+ * @param other Agregat z co najmniej jednym pomiarem.
+ */
+void SeriesBucket::add(const SeriesBucket &other)
+{
+    min = count == 0 ? other.min : qMin(min, other.min);
+    max = count == 0 ? other.max : qMax(max, other.max);
+    sum += other.sum;
+    count += other.count;
+}
+
+/**
+ * @brief Buduje agregaty całego szeregu.
+ * @param series Szereg uporządkowany rosnąco według czasu.
+ */
+void SeriesRollup::build(const SensorSeries &series)
+{
+    m_daily = aggregateDays(series, 0, series.size());
+    m_monthly = aggregateMonths(m_daily, 0, m_daily.size());
+}
+
+/**
+ * @brief Przelicza agregaty okresów przecinających się z przedziałem.
+ * @param series Szereg po zmianie.
+ * @param from Początek zmienionego przedziału.
+ * @param to Koniec zmienionego przedziału.
+ *
+ * Koszt zależy od liczby pomiarów w dobach przedziału i liczby dób w jego miesiącach,
+ * a nie od długości całego szeregu.
+ */
+void SeriesRollup::update(const SensorSeries &series, qint64 from, qint64 to)
+{
+    if (from > to)
+        return;
+
+    const qint64 dayFrom = dayStart(from);
+    const qint64 dayTo = dayStart(to) + 86400;
+    const QVector<qint64> &timestamps = series.timestamps();
+    const int first = int(std::lower_bound(timestamps.cbegin(), timestamps.cend(), dayFrom) - timestamps.cbegin());
+    const int last = int(std::lower_bound(timestamps.cbegin(), timestamps.cend(), dayTo) - timestamps.cbegin());
+    replaceRange(m_daily, dayFrom, dayTo, aggregateDays(series, first, last));
+
+    const qint64 monthFrom = monthStart(from);
+    const qint64 monthTo = nextMonthStart(to);
+    replaceRange(m_monthly, monthFrom, monthTo,
+                 aggregateMonths(m_daily, lowerBound(m_daily, monthFrom), lowerBound(m_daily, monthTo)));
+}
+
+/**
+ * @brief Szacuje pamięć zajmowaną przez agregaty.
+ * @return Liczba bajtów zarezerwowanych na dane.
+ */
+qsizetype SeriesRollup::memoryUsage() const
+{
+    return (m_daily.capacity() + m_monthly.capacity()) * qsizetype(sizeof(SeriesBucket));
+}
+
+/**
+ * @brief Wybiera agregaty okresów rozpoczętych w przedziale.
+ * @param buckets Agregaty uporządkowane rosnąco.
+ * @param from Początek przedziału.
+ * @param to Koniec przedziału.
+ * @return Agregaty z przedziału.
+ */
+QVector<SeriesBucket> SeriesRollup::slice(const QVector<SeriesBucket> &buckets, qint64 from, qint64 to)
+{
+    if (from > to)
+        return {};
+    const int first = lowerBound(buckets, from);
+    const int last = to == std::numeric_limits<qint64>::max() ? buckets.size() : lowerBound(buckets, to + 1);
+    return buckets.mid(first, last - first);
+}
+
+/**
+ * @brief Wyznacza początek doby.
+ * @param timestamp Znacznik czasu.
+ * @return Północ tej doby (także dla znaczników sprzed epoki).
+ */
+qint64 SeriesRollup::dayStart(qint64 timestamp)
+{
+    return timestamp - ((timestamp % 86400) + 86400) % 86400;
+}
+
+/**
+ * @brief Wyznacza początek miesiąca.
+ * @param timestamp Znacznik czasu.
+ * @return Północ pierwszego dnia miesiąca.
+ */
+qint64 SeriesRollup::monthStart(qint64 timestamp)
+{
+    const QDate date = QDateTime::fromSecsSinceEpoch(timestamp, QTimeZone::utc()).date();
+    return QDate(date.year(), date.month(), 1).startOfDay(QTimeZone::utc()).toSecsSinceEpoch();
+}
+
+/**
+ * @brief Wyznacza początek następnego miesiąca.
+ * @param timestamp Znacznik czasu.
+ * @return Północ pierwszego dnia następnego miesiąca.
+ */
+qint64 SeriesRollup::nextMonthStart(qint64 timestamp)
+{
+    const QDate date = QDateTime::fromSecsSinceEpoch(timestamp, QTimeZone::utc()).date();
+    return QDate(date.year(), date.month(), 1).addMonths(1).startOfDay(QTimeZone::utc()).toSecsSinceEpoch();
+}
+
+/**
+ * @brief Agreguje pomiary w doby.
+ * @param series Szereg uporządkowany rosnąco według czasu.
+ * @param first Indeks pierwszego punktu.
+ * @param last Indeks za ostatnim punktem.
+ * @return Doby z co najmniej jednym niepustym pomiarem.
+ */
+QVector<SeriesBucket> SeriesRollup::aggregateDays(const SensorSeries &series, int first, int last)
+{
+    QVector<SeriesBucket> days;
+    for (int i = first; i < last; ++i) {
+        if (series.isNull(i))
+            continue;
+        const qint64 start = dayStart(series.timestamp(i));
+        if (days.isEmpty() || days.last().start != start) {
+            SeriesBucket day;
+            day.start = start;
+            days.append(day);
+        }
+        days.last().add(series.value(i));
+    }
+    return days;
+}
+
+/**
+ * @brief Agreguje doby w miesiące.
+ * @param days Doby uporządkowane rosnąco.
+ * @param first Indeks pierwszej doby.
+ * @param last Indeks za ostatnią dobą.
+ * @return Miesiące z co najmniej jedną dobą.
+ *
+ * Granice miesiąca wyznaczane są raz na miesiąc, nie dla każdej doby.
+ */
+QVector<SeriesBucket> SeriesRollup::aggregateMonths(const QVector<SeriesBucket> &days, int first, int last)
+{
+    QVector<SeriesBucket> months;
+    qint64 monthEnd = std::numeric_limits<qint64>::min();
+    for (int i = first; i < last; ++i) {
+        const SeriesBucket &day = days.at(i);
+        if (months.isEmpty() || day.start >= monthEnd) {
+            SeriesBucket month;
+            month.start = monthStart(day.start);
+            monthEnd = nextMonthStart(day.start);
+            months.append(month);
+        }
+        months.last().add(day);
+    }
+    return months;
+}
+
+/**
+ * @brief Zastępuje agregaty okresów rozpoczętych w przedziale [from, to).
+ * @param buckets Agregaty uporządkowane rosnąco.
+ * @param from Początek przedziału.
+ * @param to Koniec przedziału.
+ * @param replacement Nowe agregaty z tego przedziału.
+ */
+void SeriesRollup::replaceRange(QVector<SeriesBucket> &buckets, qint64 from, qint64 to,
+                                const QVector<SeriesBucket> &replacement)
+{
+    const int first = lowerBound(buckets, from);
+    const int last = lowerBound(buckets, to);
+    const int common = qMin(last - first, int(replacement.size()));
+    std::copy(replacement.cbegin(), replacement.cbegin() + common, buckets.begin() + first);
+    if (last - first > common)
+        buckets.remove(first + common, last - first - common);
+    else if (replacement.size() > common)
+        buckets.insert(first + common, replacement.size() - common, SeriesBucket());
+    std::copy(replacement.cbegin() + common, replacement.cend(), buckets.begin() + first + common);
+}
+
+/**
+ * @brief Wyszukuje pierwszy agregat rozpoczęty nie wcześniej niż znacznik czasu.
+ * @param buckets Agregaty uporządkowane rosnąco.
+ * @param timestamp Znacznik czasu.
+ * @return Indeks agregatu.
+ */
+int SeriesRollup::lowerBound(const QVector<SeriesBucket> &buckets, qint64 timestamp)
+{
+    return int(std::lower_bound(buckets.cbegin(), buckets.cend(), timestamp,
+                                [](const SeriesBucket &bucket, qint64 value) { return bucket.start < value; })
+               - buckets.cbegin());
+}
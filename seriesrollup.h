@@ -0,0 +1,163 @@
+/**
+ * @file seriesrollup.h
+ * @brief Plik nagłówkowy dla struktury SeriesBucket i klasy SeriesRollup.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje agregaty dobowe i miesięczne szeregu czasowego sensora,
+ * aktualizowane przyrostowo po dołączeniu nowych pomiarów.
+ */
+
+#ifndef SERIESROLLUP_H
+#define SERIESROLLUP_H
+
+#include <QVector>
+#include <limits>
+
+class SensorSeries;
+
+/**
+ * @struct SeriesBucket
+ * @brief Agregat pomiarów jednego okresu (godziny, doby lub miesiąca).
+ */
+struct SeriesBucket {
+    qint64 start = 0;   ///< Początek okresu (sekundy od epoki, czas ścienny jako UTC).
+    double sum = 0.0;   ///< Suma niepustych pomiarów.
+    double min = 0.0;   ///< Wartość minimalna.
+    double max = 0.0;   ///< Wartość maksymalna.
+    int count = 0;      ///< Liczba niepustych pomiarów.
+
+    /**
+     * @brief Wyznacza średnią okresu.
+     * @return Średnia lub NaN, jeśli okres nie ma pomiarów.
+     */
+    double mean() const { return count > 0 ? sum / count : std::numeric_limits<double>::quiet_NaN(); }
+
+    /**
+     * @brief Dołącza pomiar do agregatu.
+     * @param value Wartość pomiaru.
+     */
+    void add(double value);
+
+    /**
+     * @brief Dołącza inny agregat (np. dobę do miesiąca).
+     * @param other Agregat z co najmniej jednym pomiarem.
+     */
+    void add(const SeriesBucket &other);
+};
+
+/**
+ * @class SeriesRollup
+ * @brief Agregaty dobowe i miesięczne szeregu sensora.
+ *
+ * Doby liczone są z pomiarów, a miesiące z dób, więc po dołączeniu pomiarów z przedziału
+ * [from, to] przeliczane są tylko doby i miesiące, które się z nim przecinają.
+ * Okresy bez niepustych pomiarów nie mają agregatów. Agregaty są uporządkowane rosnąco
+ * według początku okresu, więc zapytanie o przedział to dwa wyszukiwania binarne.
+ */
+class SeriesRollup {
+public:
+    /**
+     * @brief Buduje agregaty całego szeregu.
+     * @param series Szereg uporządkowany rosnąco według czasu.
+     */
+    void build(const SensorSeries &series);
+
+    /**
+     * @brief Przelicza agregaty okresów przecinających się z przedziałem.
+     * @param series Szereg po zmianie (uporządkowany rosnąco według czasu).
+     * @param from Początek zmienionego przedziału (sekundy od epoki, włącznie).
+     * @param to Koniec zmienionego przedziału (sekundy od epoki, włącznie).
+     */
+    void update(const SensorSeries &series, qint64 from, qint64 to);
+
+    /**
+     * @brief Pobiera agregaty dobowe.
+     * @return Doby uporządkowane rosnąco.
+     */
+    const QVector<SeriesBucket> &daily() const { return m_daily; }
+
+    /**
+     * @brief Pobiera agregaty miesięczne.
+     * @return Miesiące uporządkowane rosnąco.
+     */
+    const QVector<SeriesBucket> &monthly() const { return m_monthly; }
+
+    /**
+     * @brief Szacuje pamięć zajmowaną przez agregaty.
+     * @return Liczba bajtów zarezerwowanych na dane.
+     */
+    qsizetype memoryUsage() const;
+
+    /**
+     * @brief Wybiera agregaty okresów rozpoczętych w przedziale.
+     * @param buckets Agregaty uporządkowane rosnąco.
+     * @param from Początek przedziału (sekundy od epoki, włącznie).
+     * @param to Koniec przedziału (sekundy od epoki, włącznie).
+     * @return Agregaty z przedziału.
+     */
+    static QVector<SeriesBucket> slice(const QVector<SeriesBucket> &buckets, qint64 from, qint64 to);
+
+    /**
+     * @brief Wyznacza początek doby.
+     * @param timestamp Znacznik czasu (sekundy od epoki).
+     * @return Północ tej doby.
+     */
+    static qint64 dayStart(qint64 timestamp);
+
+    /**
+     * @brief Wyznacza początek miesiąca.
+     * @param timestamp Znacznik czasu (sekundy od epoki).
+     * @return Północ pierwszego dnia miesiąca.
+     */
+    static qint64 monthStart(qint64 timestamp);
+
+    /**
+     * @brief Wyznacza początek następnego miesiąca.
+     * @param timestamp Znacznik czasu (sekundy od epoki).
+     * @return Północ pierwszego dnia następnego miesiąca.
+     */
+    static qint64 nextMonthStart(qint64 timestamp);
+
+private:
+    /**
+     * @brief Agreguje pomiary w doby.
+     * @param series Szereg uporządkowany rosnąco według czasu.
+     * @param first Indeks pierwszego punktu.
+     * @param last Indeks za ostatnim punktem.
+     * @return Doby z co najmniej jednym niepustym pomiarem.
+     */
+    static QVector<SeriesBucket> aggregateDays(const SensorSeries &series, int first, int last);
+
+    /**
+     * @brief Agreguje doby w miesiące.
+     * @param days Doby uporządkowane rosnąco.
+     * @param first Indeks pierwszej doby.
+     * @param last Indeks za ostatnią dobą.
+     * @return Miesiące z co najmniej jedną dobą.
+     */
+    static QVector<SeriesBucket> aggregateMonths(const QVector<SeriesBucket> &days, int first, int last);
+
+    /**
+     * @brief Zastępuje agregaty okresów rozpoczętych w przedziale [from, to).
+     * @param buckets Agregaty uporządkowane rosnąco.
+     * @param from Początek przedziału (włącznie).
+     * @param to Koniec przedziału (wyłącznie).
+     * @param replacement Nowe agregaty z tego przedziału.
+     */
+    static void replaceRange(QVector<SeriesBucket> &buckets, qint64 from, qint64 to,
+                             const QVector<SeriesBucket> &replacement);
+
+    /**
+     * @brief Wyszukuje pierwszy agregat rozpoczęty nie wcześniej niż znacznik czasu.
+     * @param buckets Agregaty uporządkowane rosnąco.
+     * @param timestamp Znacznik czasu.
+     * @return Indeks agregatu.
+     */
+    static int lowerBound(const QVector<SeriesBucket> &buckets, qint64 timestamp);
+
+    QVector<SeriesBucket> m_daily;    ///< Agregaty dobowe.
+    QVector<SeriesBucket> m_monthly;  ///< Agregaty miesięczne.
+};
+
+#endif // SERIESROLLUP_H
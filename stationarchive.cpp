@@ -0,0 +1,638 @@
+/**
+ * @file stationarchive.cpp
+ * @brief Implementacja klasy StationArchive.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera kodowanie plików archiwalnych stacji w formacie JSON i w formacie binarnym.
+ */
+
+#include "stationarchive.h"
+#include "metricsregistry.h"
+#include <QDataStream>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QtAlgorithms>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+/// Sygnatura pliku binarnego ("GARB").
+constexpr quint32 kArchiveMagic = 0x47415242;
+/// Wersja formatu binarnego.
+constexpr quint16 kArchiveVersion = 1;
+/// Flaga bloku szeregu: blok zawiera mapę pustych pomiarów.
+constexpr quint8 kSeriesHasNulls = 0x01;
+
+/**
+ * @class BitWriter
+ * @brief Zapis strumienia bitów od najstarszego bitu bajtu.
+ */
+class BitWriter {
+public:
+    /**
+     * @brief Konstruktor obiektu BitWriter.
+     * @param bytes Bufor, na końcu którego dopisywane są bity.
+     */
+    explicit BitWriter(QByteArray &bytes) : m_bytes(bytes) {}
+
+    /**
+     * @brief Dopisuje najmłodsze bity wartości.
+     * @param value Wartość.
+     * @param count Liczba bitów (1-64).
+     */
+    void write(quint64 value, int count)
+    {
+        while (count > 0) {
+            if (m_bitPos == 0)
+                m_bytes.append('\0');
+            const int free = 8 - m_bitPos;
+            const int take = qMin(free, count);
+            const quint64 chunk = (value >> (count - take)) & ((quint64(1) << take) - 1);
+            m_bytes.data()[m_bytes.size() - 1] |= char(chunk << (free - take));
+            count -= take;
+            m_bitPos = (m_bitPos + take) & 7;
+        }
+    }
+
+private:
+    QByteArray &m_bytes;   ///< Bufor wyjściowy.
+    int m_bitPos = 0;      ///< Liczba zajętych bitów ostatniego bajtu (0 - bajt pełny).
+};
+
+/**
+ * @class BitReader
+ * @brief Odczyt strumienia bitów zapisanego przez BitWriter.
+ */
+class BitReader {
+public:
+    /**
+     * @brief Konstruktor obiektu BitReader.
+     * @param data Wskaźnik na strumień.
+     * @param size Rozmiar strumienia w bajtach.
+     */
+    BitReader(const uchar *data, qint64 size) : m_data(data), m_sizeBits(size * 8) {}
+
+    /**
+     * @brief Odczytuje kolejne bity.
+     * @param count Liczba bitów (1-64).
+     * @return Odczytana wartość; po przekroczeniu końca strumienia ok() zwraca false.
+     */
+    quint64 read(int count)
+    {
+        quint64 value = 0;
+        while (count > 0) {
+            if (m_pos >= m_sizeBits) {
+                m_ok = false;
+                return 0;
+            }
+            const int available = 8 - int(m_pos & 7);
+            const int take = qMin(available, count);
+            const uint chunk = (uint(m_data[m_pos >> 3]) >> (available - take)) & ((1u << take) - 1);
+            value = (value << take) | chunk;
+            count -= take;
+            m_pos += take;
+        }
+        return value;
+    }
+
+    /**
+     * @brief Odczytuje jeden bit.
+     * @return True dla bitu 1.
+     */
+    bool readBit() { return read(1) != 0; }
+
+    /**
+     * @brief Sprawdza, czy wszystkie odczyty mieściły się w strumieniu.
+     * @return True, jeśli nie przekroczono końca strumienia.
+     */
+    bool ok() const { return m_ok; }
+
+private:
+    const uchar *m_data;   ///< Strumień.
+    qint64 m_sizeBits;     ///< Rozmiar strumienia w bitach.
+    qint64 m_pos = 0;      ///< Pozycja odczytu w bitach.
+    bool m_ok = true;      ///< Czy odczyty mieściły się w strumieniu.
+};
+
+/**
+ * @struct DeltaBucket
+ * @brief Przedział różnic drugiego rzędu kodowany stałą liczbą bitów.
+ */
+struct DeltaBucket {
+    quint64 prefix;    ///< Prefiks przedziału.
+    int prefixBits;    ///< Długość prefiksu w bitach.
+    qint64 low;        ///< Najmniejsza różnica w przedziale.
+    qint64 high;       ///< Największa różnica w przedziale.
+    int valueBits;     ///< Liczba bitów wartości.
+};
+
+/// Przedziały różnic drugiego rzędu (różnica 0 kodowana jest pojedynczym bitem 0).
+constexpr DeltaBucket kDeltaBuckets[] = {
+    { 0b10, 2, -63, 64, 7 },
+    { 0b110, 3, -255, 256, 9 },
+    { 0b1110, 4, -2047, 2048, 12 }
+};
+
+/**
+ * @brief Zamienia liczbę zmiennoprzecinkową na jej reprezentację bitową.
+ * @param value Wartość.
+ * @return Bity wartości.
+ */
+quint64 doubleBits(double value)
+{
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+/**
+ * @brief Zamienia reprezentację bitową na liczbę zmiennoprzecinkową.
+ * @param bits Bity wartości.
+ * @return Wartość.
+ */
+double bitsDouble(quint64 bits)
+{
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * @struct SensorTableEntry
+ * @brief Wiersz tabeli sensorów w pliku binarnym.
+ */
+struct SensorTableEntry {
+    qint32 sensorId = 0;    ///< Identyfikator sensora.
+    QByteArray paramName;   ///< Nazwa parametru w UTF-8.
+    QByteArray paramCode;   ///< Kod parametru w UTF-8.
+    quint32 count = 0;      ///< Liczba punktów szeregu.
+    quint32 offset = 0;     ///< Przesunięcie bloku względem początku bloków.
+    quint32 length = 0;     ///< Długość bloku w bajtach.
+};
+}
+
+/**
+ * @brief Wczytuje plik archiwalny w formacie wynikającym z rozszerzenia.
+ * @param path Ścieżka pliku.
+ * @param data Struktura, do której trafiają dane.
+ * @return True, jeśli plik został poprawnie wczytany.
+ */
+bool StationArchive::load(const QString &path, StationArchiveData &data)
+{
+    MetricsTimer timer("gios_archive_duration_ms", isBinary(path) ? "op=load,format=gar" : "op=load,format=json");
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    if (isBinary(path)) {
+        const qint64 size = file.size();
+        uchar *mapped = size > 0 ? file.map(0, size) : nullptr;
+        if (!mapped) {
+            const QByteArray bytes = file.readAll();
+            return decode(bytes.constData(), bytes.size(), data);
+        }
+        const bool ok = decode(reinterpret_cast<const char *>(mapped), size, data);
+        file.unmap(mapped);
+        return ok;
+    }
+
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    if (doc.isNull() || !doc.isObject())
+        return false;
+    data = fromJson(doc.object());
+    return true;
+}
+
+/**
+ * @brief Buduje nazwę pliku archiwalnego stacji.
+ * @param stationId Identyfikator stacji.
+ * @param savedAt Czas zapisu.
+ * @param compact True dla formatu .gar, false dla JSON.
+ * @return Nazwa pliku.
+ */
+QString StationArchive::fileName(int stationId, const QDateTime &savedAt, bool compact)
+{
+    return QString("station_%1_%2.%3").arg(stationId).arg(savedAt.toString("yyyyMMdd_HHmmss")).arg(compact ? "gar" : "json");
+}
+
+/**
+ * @brief Zapisuje plik archiwalny w formacie wynikającym z rozszerzenia.
+ * @param path Ścieżka pliku.
+ * @param data Dane stacji.
+ * @return True, jeśli zapis się powiódł.
+ */
+bool StationArchive::save(const QString &path, const StationArchiveData &data)
+{
+    MetricsTimer timer("gios_archive_duration_ms", isBinary(path) ? "op=save,format=gar" : "op=save,format=json");
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    const QByteArray bytes = isBinary(path) ? encode(data)
+                                            : QJsonDocument(toJson(data)).toJson(QJsonDocument::Indented);
+    if (file.write(bytes) != bytes.size()) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+/**
+ * @brief Przepisuje plik archiwalny do innego formatu.
+ * @param sourcePath Ścieżka pliku źródłowego.
+ * @param targetPath Ścieżka pliku docelowego; format wynika z rozszerzenia.
+ * @return True, jeśli konwersja się powiodła.
+ */
+bool StationArchive::convert(const QString &sourcePath, const QString &targetPath)
+{
+    StationArchiveData data;
+    return load(sourcePath, data) && save(targetPath, data);
+}
+
+/**
+ * @brief Wczytuje tylko nagłówek stacji z pliku archiwalnego.
+ * @param path Ścieżka pliku.
+ * @param data Struktura, do której trafiają pola nagłówka (bez sensorów).
+ * @return True, jeśli nagłówek został poprawnie wczytany.
+ */
+bool StationArchive::loadHeader(const QString &path, StationArchiveData &data)
+{
+    if (!isBinary(path)) {
+        if (!load(path, data))
+            return false;
+        data.sensors.clear();
+        return true;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    const qint64 size = file.size();
+    uchar *mapped = size > 0 ? file.map(0, size) : nullptr;
+    if (!mapped)
+        return false;
+    const bool ok = decode(reinterpret_cast<const char *>(mapped), size, data, true);
+    file.unmap(mapped);
+    return ok;
+}
+
+/**
+ * @brief Sprawdza, czy ścieżka wskazuje plik w formacie binarnym.
+ * @param path Ścieżka pliku.
+ * @return True dla rozszerzenia .gar.
+ */
+bool StationArchive::isBinary(const QString &path)
+{
+    return path.endsWith(".gar", Qt::CaseInsensitive);
+}
+
+/**
+ * @brief Zamienia dane stacji na obiekt JSON w formacie plików .json.
+ * @param data Dane stacji.
+ * @return Obiekt JSON.
+ */
+QJsonObject StationArchive::toJson(const StationArchiveData &data)
+{
+    QJsonObject jsonObj;
+    jsonObj["stationId"] = data.stationId;
+    jsonObj["stationName"] = data.stationName;
+    jsonObj["cityName"] = data.cityName;
+    jsonObj["address"] = data.address;
+    jsonObj["latitude"] = data.lat;
+    jsonObj["longitude"] = data.lon;
+    jsonObj["saveDate"] = data.saveDate;
+
+    QJsonArray sensorsArray;
+    for (const ArchivedSensor &sensor : data.sensors) {
+        QJsonObject sensorObj;
+        sensorObj["sensorId"] = sensor.sensorId;
+        sensorObj["paramName"] = sensor.paramName;
+        sensorObj["paramCode"] = sensor.paramCode;
+
+        QJsonArray measurementsArray;
+        for (int i = 0; i < sensor.series.size(); ++i) {
+            QJsonObject measurementObj;
+            measurementObj["date"] = SensorSeries::formatTimestamp(sensor.series.timestamp(i));
+            measurementObj["value"] = sensor.series.isNull(i) ? QJsonValue() : QJsonValue(sensor.series.value(i));
+            measurementsArray.append(measurementObj);
+        }
+        sensorObj["measurements"] = measurementsArray;
+        sensorsArray.append(sensorObj);
+    }
+    jsonObj["sensors"] = sensorsArray;
+    return jsonObj;
+}
+
+/**
+ * @brief Odczytuje dane stacji z obiektu JSON w formacie plików .json.
+ * @param jsonObj Obiekt JSON.
+ * @return Dane stacji; pomiary z nieprawidłową datą są pomijane.
+ */
+StationArchiveData StationArchive::fromJson(const QJsonObject &jsonObj)
+{
+    StationArchiveData data;
+    data.stationId = jsonObj["stationId"].toInt();
+    data.stationName = jsonObj["stationName"].toString();
+    data.cityName = jsonObj["cityName"].toString();
+    data.address = jsonObj["address"].toString();
+    data.lat = jsonObj["latitude"].toDouble();
+    data.lon = jsonObj["longitude"].toDouble();
+    data.saveDate = jsonObj["saveDate"].toString();
+
+    const QJsonArray sensorsArray = jsonObj["sensors"].toArray();
+    data.sensors.reserve(sensorsArray.size());
+    for (const QJsonValue &sensorValue : sensorsArray) {
+        const QJsonObject sensorObj = sensorValue.toObject();
+        ArchivedSensor sensor;
+        sensor.sensorId = sensorObj["sensorId"].toInt();
+        sensor.paramName = sensorObj["paramName"].toString();
+        sensor.paramCode = sensorObj["paramCode"].toString();
+
+        // Daty parsowane raz, przy wczytaniu
+        const QJsonArray measurementsArray = sensorObj["measurements"].toArray();
+        sensor.series.reserve(measurementsArray.size());
+        for (const QJsonValue &measurementValue : measurementsArray) {
+            const QJsonObject measurementObj = measurementValue.toObject();
+            bool ok = false;
+            const qint64 timestamp = SensorSeries::parseTimestamp(measurementObj["date"].toString(), &ok);
+            if (!ok)
+                continue;
+            const QJsonValue value = measurementObj["value"];
+            sensor.series.append(timestamp, value.toDouble(), !value.isDouble());
+        }
+        sensor.series.sortByTime();
+        data.sensors.append(sensor);
+    }
+    return data;
+}
+
+/**
+ * @brief Koduje dane stacji w formacie binarnym.
+ * @param data Dane stacji.
+ * @return Zawartość pliku .gar.
+ *
+ * Bloki szeregów kodowane są przed tabelą sensorów, aby znać ich przesunięcia i długości.
+ */
+QByteArray StationArchive::encode(const StationArchiveData &data)
+{
+    QList<QByteArray> blocks;
+    blocks.reserve(data.sensors.size());
+    for (const ArchivedSensor &sensor : data.sensors)
+        blocks.append(encodeSeries(sensor.series));
+
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kArchiveMagic << kArchiveVersion
+        << qint32(data.stationId) << data.stationName.toUtf8() << data.cityName.toUtf8()
+        << data.address.toUtf8() << data.lat << data.lon << data.saveDate.toUtf8();
+
+    out << quint32(data.sensors.size());
+    quint32 offset = 0;
+    for (int i = 0; i < data.sensors.size(); ++i) {
+        const ArchivedSensor &sensor = data.sensors.at(i);
+        out << qint32(sensor.sensorId) << sensor.paramName.toUtf8() << sensor.paramCode.toUtf8()
+            << quint32(sensor.series.size()) << offset << quint32(blocks.at(i).size());
+        offset += blocks.at(i).size();
+    }
+
+    for (const QByteArray &block : std::as_const(blocks))
+        bytes.append(block);
+    return bytes;
+}
+
+/**
+ * @brief Dekoduje dane stacji z formatu binarnego.
+ * @param bytes Wskaźnik na zawartość pliku .gar.
+ * @param size Rozmiar zawartości w bajtach.
+ * @param data Struktura, do której trafiają dane.
+ * @param headerOnly True, jeśli wystarczy nagłówek stacji.
+ * @return True, jeśli zawartość jest poprawna.
+ */
+bool StationArchive::decode(const char *bytes, qint64 size, StationArchiveData &data, bool headerOnly)
+{
+    // Strumień czyta bezpośrednio z przekazanej pamięci (np. pliku odwzorowanego w pamięci)
+    const QByteArray raw = QByteArray::fromRawData(bytes, size);
+    QDataStream in(raw);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    if (magic != kArchiveMagic || version != kArchiveVersion)
+        return false;
+
+    StationArchiveData loaded;
+    qint32 stationId = 0;
+    QByteArray stationName;
+    QByteArray cityName;
+    QByteArray address;
+    QByteArray saveDate;
+    in >> stationId >> stationName >> cityName >> address >> loaded.lat >> loaded.lon >> saveDate;
+    loaded.stationId = stationId;
+    loaded.stationName = QString::fromUtf8(stationName);
+    loaded.cityName = QString::fromUtf8(cityName);
+    loaded.address = QString::fromUtf8(address);
+    loaded.saveDate = QString::fromUtf8(saveDate);
+    if (in.status() != QDataStream::Ok)
+        return false;
+    if (headerOnly) {
+        data = loaded;
+        return true;
+    }
+
+    quint32 sensorCount = 0;
+    in >> sensorCount;
+    QList<SensorTableEntry> table;
+    table.reserve(qMin<quint32>(sensorCount, 1024));
+    for (quint32 i = 0; i < sensorCount && in.status() == QDataStream::Ok; ++i) {
+        SensorTableEntry entry;
+        in >> entry.sensorId >> entry.paramName >> entry.paramCode >> entry.count >> entry.offset >> entry.length;
+        table.append(entry);
+    }
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    const qint64 payloadStart = in.device()->pos();
+    const qint64 payloadSize = size - payloadStart;
+    const uchar *payload = reinterpret_cast<const uchar *>(bytes) + payloadStart;
+    loaded.sensors.reserve(table.size());
+    for (const SensorTableEntry &entry : std::as_const(table)) {
+        if (qint64(entry.offset) + entry.length > payloadSize)
+            return false;
+        ArchivedSensor sensor;
+        sensor.sensorId = entry.sensorId;
+        sensor.paramName = QString::fromUtf8(entry.paramName);
+        sensor.paramCode = QString::fromUtf8(entry.paramCode);
+        if (!decodeSeries(payload + entry.offset, entry.length, int(entry.count), sensor.series))
+            return false;
+        loaded.sensors.append(sensor);
+    }
+
+    data = loaded;
+    return true;
+}
+
+/**
+ * @brief Koduje szereg czasowy jako strumień bitów.
+ * @param series Szereg uporządkowany rosnąco według czasu.
+ * @return Blok szeregu (mapa pustych pomiarów i strumień bitów).
+ *
+ * Znacznik czasu: pierwszy zapisany w 64 bitach, dalej różnica drugiego rzędu
+ * (0 - jeden bit, większe w przedziałach 7, 9 i 12 bitów albo pełne 64 bity).
+ * Wartość: pierwsza w 64 bitach, dalej XOR z poprzednią - '0' dla identycznej,
+ * '10' z bitami znaczącymi w poprzednim oknie albo '11' z nowym oknem (5 bitów zer
+ * wiodących, 6 bitów długości). Puste pomiary powtarzają poprzednią wartość,
+ * więc kosztują jeden bit, a ich pozycje zapisane są w mapie bitowej.
+ */
+QByteArray StationArchive::encodeSeries(const SensorSeries &series)
+{
+    QByteArray block;
+    const int count = series.size();
+    if (count == 0)
+        return block;
+
+    bool hasNulls = false;
+    for (quint64 word : series.nullMask())
+        hasNulls |= word != 0;
+
+    block.append(char(hasNulls ? kSeriesHasNulls : 0));
+    if (hasNulls) {
+        for (quint64 word : series.nullMask()) {
+            const quint64 le = qToLittleEndian(word);
+            block.append(reinterpret_cast<const char *>(&le), sizeof(le));
+        }
+    }
+
+    BitWriter writer(block);
+    qint64 previousTimestamp = series.timestamp(0);
+    qint64 previousDelta = 0;
+    quint64 previousBits = doubleBits(series.isNull(0) ? 0.0 : series.value(0));
+    int previousLeading = -1;
+    int previousTrailing = 0;
+    writer.write(quint64(previousTimestamp), 64);
+    writer.write(previousBits, 64);
+
+    for (int i = 1; i < count; ++i) {
+        const qint64 timestamp = series.timestamp(i);
+        const qint64 delta = timestamp - previousTimestamp;
+        const qint64 deltaOfDelta = delta - previousDelta;
+        previousTimestamp = timestamp;
+        previousDelta = delta;
+
+        if (deltaOfDelta == 0) {
+            writer.write(0, 1);
+        } else {
+            bool written = false;
+            for (const DeltaBucket &bucket : kDeltaBuckets) {
+                if (deltaOfDelta >= bucket.low && deltaOfDelta <= bucket.high) {
+                    writer.write(bucket.prefix, bucket.prefixBits);
+                    writer.write(quint64(deltaOfDelta - bucket.low), bucket.valueBits);
+                    written = true;
+                    break;
+                }
+            }
+            if (!written) {
+                writer.write(0b1111, 4);
+                writer.write(quint64(deltaOfDelta), 64);
+            }
+        }
+
+        const quint64 bits = series.isNull(i) ? previousBits : doubleBits(series.value(i));
+        const quint64 xorBits = bits ^ previousBits;
+        previousBits = bits;
+        if (xorBits == 0) {
+            writer.write(0, 1);
+            continue;
+        }
+
+        const int leading = qMin(31, int(qCountLeadingZeroBits(xorBits)));
+        const int trailing = int(qCountTrailingZeroBits(xorBits));
+        if (previousLeading >= 0 && leading >= previousLeading && trailing >= previousTrailing) {
+            writer.write(0b10, 2);
+            writer.write(xorBits >> previousTrailing, 64 - previousLeading - previousTrailing);
+        } else {
+            const int meaningful = 64 - leading - trailing;
+            writer.write(0b11, 2);
+            writer.write(quint64(leading), 5);
+            writer.write(quint64(meaningful - 1), 6);
+            writer.write(xorBits >> trailing, meaningful);
+            previousLeading = leading;
+            previousTrailing = trailing;
+        }
+    }
+    return block;
+}
+
+/**
+ * @brief Dekoduje szereg czasowy ze strumienia bitów.
+ * @param bytes Wskaźnik na blok szeregu.
+ * @param size Rozmiar bloku w bajtach.
+ * @param count Liczba punktów szeregu.
+ * @param series Szereg, do którego trafiają punkty.
+ * @return True, jeśli blok był kompletny.
+ */
+bool StationArchive::decodeSeries(const uchar *bytes, qint64 size, int count, SensorSeries &series)
+{
+    series = SensorSeries();
+    if (count == 0)
+        return true;
+    // Każdy punkt po pierwszym zajmuje co najmniej dwa bity - chroni przed rezerwacją z uszkodzonej tabeli
+    if (count < 0 || size < 1 || qint64(count - 1) * 2 > size * 8)
+        return false;
+
+    const bool hasNulls = bytes[0] & kSeriesHasNulls;
+    const qint64 maskBytes = hasNulls ? qint64((count + 63) / 64) * 8 : 0;
+    if (1 + maskBytes > size)
+        return false;
+    const uchar *mask = bytes + 1;
+
+    auto isNullAt = [&](int index) {
+        return hasNulls && (qFromLittleEndian<quint64>(mask + (index >> 6) * 8) & (quint64(1) << (index & 63)));
+    };
+
+    BitReader reader(bytes + 1 + maskBytes, size - 1 - maskBytes);
+    series.reserve(count);
+
+    qint64 timestamp = qint64(reader.read(64));
+    quint64 bits = reader.read(64);
+    qint64 delta = 0;
+    int leading = 0;
+    int trailing = 0;
+    series.append(timestamp, bitsDouble(bits), isNullAt(0));
+
+    for (int i = 1; i < count && reader.ok(); ++i) {
+        qint64 deltaOfDelta = 0;
+        if (reader.readBit()) {
+            bool decoded = false;
+            for (const DeltaBucket &bucket : kDeltaBuckets) {
+                if (!reader.readBit()) {
+                    deltaOfDelta = qint64(reader.read(bucket.valueBits)) + bucket.low;
+                    decoded = true;
+                    break;
+                }
+            }
+            if (!decoded)
+                deltaOfDelta = qint64(reader.read(64));
+        }
+        delta += deltaOfDelta;
+        timestamp += delta;
+
+        if (reader.readBit()) {
+            if (reader.readBit()) {
+                leading = int(reader.read(5));
+                const int meaningful = int(reader.read(6)) + 1;
+                trailing = 64 - leading - meaningful;
+                if (trailing < 0)
+                    return false;
+            }
+            bits ^= reader.read(64 - leading - trailing) << trailing;
+        }
+        series.append(timestamp, bitsDouble(bits), isNullAt(i));
+    }
+
+    return reader.ok() && series.size() == count;
+}
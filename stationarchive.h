@@ -0,0 +1,160 @@
+/**
+ * @file stationarchive.h
+ * @brief Plik nagłówkowy dla struktur archiwum stacji i klasy StationArchive.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje zapisane dane stacji oraz ich zapis i odczyt w formacie JSON
+ * i w zwartym formacie binarnym z kompresją szeregów czasowych.
+ */
+
+#ifndef STATIONARCHIVE_H
+#define STATIONARCHIVE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include "sensorseries.h"
+
+/**
+ * @struct ArchivedSensor
+ * @brief Sensor zapisanej stacji wraz z szeregiem pomiarów.
+ */
+struct ArchivedSensor {
+    int sensorId = 0;      ///< Identyfikator sensora.
+    QString paramName;     ///< Nazwa parametru.
+    QString paramCode;     ///< Kod parametru (np. "PM10").
+    SensorSeries series;   ///< Pomiary uporządkowane rosnąco według czasu.
+};
+
+/**
+ * @struct StationArchiveData
+ * @brief Zawartość jednego pliku archiwalnego stacji.
+ */
+struct StationArchiveData {
+    int stationId = 0;               ///< Identyfikator stacji.
+    QString stationName;             ///< Nazwa stacji.
+    QString cityName;                ///< Nazwa miasta.
+    QString address;                 ///< Adres stacji.
+    double lat = 0.0;                ///< Szerokość geograficzna.
+    double lon = 0.0;                ///< Długość geograficzna.
+    QString saveDate;                ///< Data zapisu (ISO 8601).
+    QList<ArchivedSensor> sensors;   ///< Sensory z pomiarami.
+};
+
+/**
+ * @class StationArchive
+ * @brief Zapis i odczyt plików archiwalnych stacji.
+ *
+ * Obsługiwane są dwa formaty rozpoznawane po rozszerzeniu: dotychczasowy JSON (.json)
+ * oraz zwarty format binarny (.gar). Plik binarny składa się z nagłówka stacji, tabeli
+ * sensorów (liczba punktów, przesunięcie i długość bloku) oraz bloków szeregów.
+ * W bloku znaczniki czasu kodowane są jako różnice drugiego rzędu, a wartości jako XOR
+ * z poprzednią wartością (schemat Gorilla), więc pomiary godzinowe zajmują po kilka bitów.
+ * Odczyt pracuje na pliku odwzorowanym w pamięci, bez kopiowania jego zawartości.
+ * Konwersja między formatami jest bezstratna.
+ */
+class StationArchive {
+public:
+    /**
+     * @brief Wczytuje plik archiwalny w formacie wynikającym z rozszerzenia.
+     * @param path Ścieżka pliku.
+     * @param data Struktura, do której trafiają dane.
+     * @return True, jeśli plik został poprawnie wczytany.
+     */
+    static bool load(const QString &path, StationArchiveData &data);
+
+    /**
+     * @brief Zapisuje plik archiwalny w formacie wynikającym z rozszerzenia.
+     * @param path Ścieżka pliku.
+     * @param data Dane stacji.
+     * @return True, jeśli zapis się powiódł.
+     */
+    static bool save(const QString &path, const StationArchiveData &data);
+
+    /**
+     * @brief Buduje nazwę pliku archiwalnego stacji.
+     * @param stationId Identyfikator stacji.
+     * @param savedAt Czas zapisu.
+     * @param compact True dla formatu .gar, false dla JSON.
+     * @return Nazwa w postaci station_<id>_<yyyyMMdd_HHmmss>.<gar|json>.
+     */
+    static QString fileName(int stationId, const QDateTime &savedAt, bool compact);
+
+    /**
+     * @brief Przepisuje plik archiwalny do innego formatu.
+     * @param sourcePath Ścieżka pliku źródłowego.
+     * @param targetPath Ścieżka pliku docelowego; format wynika z rozszerzenia.
+     * @return True, jeśli konwersja się powiodła.
+     */
+    static bool convert(const QString &sourcePath, const QString &targetPath);
+
+    /**
+     * @brief Wczytuje tylko nagłówek stacji z pliku archiwalnego.
+     * @param path Ścieżka pliku.
+     * @param data Struktura, do której trafiają pola nagłówka (bez sensorów).
+     * @return True, jeśli nagłówek został poprawnie wczytany.
+     *
+     * Dla pliku binarnego odczytywany jest wyłącznie początek pliku.
+     */
+    static bool loadHeader(const QString &path, StationArchiveData &data);
+
+    /**
+     * @brief Sprawdza, czy ścieżka wskazuje plik w formacie binarnym.
+     * @param path Ścieżka pliku.
+     * @return True dla rozszerzenia .gar.
+     */
+    static bool isBinary(const QString &path);
+
+    /**
+     * @brief Zamienia dane stacji na obiekt JSON w formacie plików .json.
+     * @param data Dane stacji.
+     * @return Obiekt JSON.
+     */
+    static QJsonObject toJson(const StationArchiveData &data);
+
+    /**
+     * @brief Odczytuje dane stacji z obiektu JSON w formacie plików .json.
+     * @param jsonObj Obiekt JSON.
+     * @return Dane stacji; pomiary z nieprawidłową datą są pomijane.
+     */
+    static StationArchiveData fromJson(const QJsonObject &jsonObj);
+
+    /**
+     * @brief Koduje dane stacji w formacie binarnym.
+     * @param data Dane stacji.
+     * @return Zawartość pliku .gar.
+     */
+    static QByteArray encode(const StationArchiveData &data);
+
+    /**
+     * @brief Dekoduje dane stacji z formatu binarnego.
+     * @param bytes Wskaźnik na zawartość pliku .gar.
+     * @param size Rozmiar zawartości w bajtach.
+     * @param data Struktura, do której trafiają dane.
+     * @param headerOnly True, jeśli wystarczy nagłówek stacji.
+     * @return True, jeśli zawartość jest poprawna.
+     */
+    static bool decode(const char *bytes, qint64 size, StationArchiveData &data, bool headerOnly = false);
+
+    /**
+     * @brief Koduje szereg czasowy jako strumień bitów.
+     * @param series Szereg uporządkowany rosnąco według czasu.
+     * @return Blok szeregu (mapa pustych pomiarów i strumień bitów).
+     */
+    static QByteArray encodeSeries(const SensorSeries &series);
+
+    /**
+     * @brief Dekoduje szereg czasowy ze strumienia bitów.
+     * @param bytes Wskaźnik na blok szeregu.
+     * @param size Rozmiar bloku w bajtach.
+     * @param count Liczba punktów szeregu.
+     * @param series Szereg, do którego trafiają punkty.
+     * @return True, jeśli blok był kompletny.
+     */
+    static bool decodeSeries(const uchar *bytes, qint64 size, int count, SensorSeries &series);
+};
+
+#endif // STATIONARCHIVE_H
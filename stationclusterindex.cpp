@@ -0,0 +1,286 @@
+/**
+ * @file stationclusterindex.cpp
+ * @brief Implementacja klasy StationClusterIndex.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera budowę hierarchii grup stacji (od pojedynczych stacji do najmniejszego
+ * przybliżenia) i zapytania o grupy w prostokącie widoku mapy.
+ */
+
+#include "stationclusterindex.h"
+#include <QtMath>
+
+/**
+ * @brief Konstruktor obiektu StationClusterIndex.
+ * @param radiusPx Promień grupowania w pikselach ekranu.
+ * @param minZoom Najmniejszy poziom przybliżenia z grupowaniem.
+ * @param maxZoom Największy poziom przybliżenia z grupowaniem.
+ */
+StationClusterIndex::StationClusterIndex(double radiusPx, int minZoom, int maxZoom)
+    : m_radiusPx(radiusPx), m_minZoom(minZoom), m_maxZoom(maxZoom)
+{
+}
+
+/**
+ * @brief Rzutuje długość geograficzną na oś X odwzorowania Mercatora.
+ * @param lon Długość geograficzna.
+ * @return Współrzędna w zakresie [0, 1].
+ */
+double StationClusterIndex::lonToX(double lon)
+{
+    return qBound(0.0, lon / 360.0 + 0.5, 1.0);
+}
+
+/**
+ * @brief Rzutuje szerokość geograficzną na oś Y odwzorowania Mercatora.
+ * @param lat Szerokość geograficzna.
+ * @return Współrzędna w zakresie [0, 1] (0 na północy).
+ */
+double StationClusterIndex::latToY(double lat)
+{
+    const double sine = qSin(qDegreesToRadians(qBound(-85.0511, lat, 85.0511)));
+    return qBound(0.0, 0.5 - 0.25 * qLn((1.0 + sine) / (1.0 - sine)) / M_PI, 1.0);
+}
+
+/**
+ * @brief Odwraca rzut Mercatora na osi X.
+ * @param x Współrzędna w zakresie [0, 1].
+ * @return Długość geograficzna.
+ */
+double StationClusterIndex::xToLon(double x)
+{
+    return (x - 0.5) * 360.0;
+}
+
+/**
+ * @brief Odwraca rzut Mercatora na osi Y.
+ * @param y Współrzędna w zakresie [0, 1] (0 na północy).
+ * @return Szerokość geograficzna.
+ */
+double StationClusterIndex::yToLat(double y)
+{
+    return qRadiansToDegrees(qAtan(std::sinh(M_PI * (1.0 - 2.0 * y))));
+}
+
+/**
+ * @brief Wyznacza promień grupowania poziomu w jednostkach odwzorowania.
+ * @param zoom Poziom przybliżenia.
+ * @return Promień (Mercator); świat ma na poziomie zoom szerokość kTileSize * 2^zoom pikseli.
+ */
+double StationClusterIndex::radiusAt(int zoom) const
+{
+    return m_radiusPx / (kTileSize * std::ldexp(1.0, zoom));
+}
+
+/**
+ * @brief Składa klucz komórki z indeksów wiersza i kolumny.
+ * @param row Indeks wiersza.
+ * @param col Indeks kolumny.
+ * @return Klucz komórki.
+ */
+qint64 StationClusterIndex::cellKey(int row, int col)
+{
+    return (qint64(row) << 32) | quint32(col);
+}
+
+/**
+ * @brief Wypełnia siatkę poziomu.
+ * @param level Poziom z ustawionym rozmiarem komórki.
+ */
+void StationClusterIndex::indexLevel(Level &level)
+{
+    level.cells.clear();
+    for (int i = 0; i < level.nodes.size(); ++i) {
+        const Node &node = level.nodes.at(i);
+        level.cells[cellKey(int(node.y / level.cellSize), int(node.x / level.cellSize))].append(i);
+    }
+}
+
+/**
+ * @brief Buduje grupy wszystkich poziomów od nowa.
+ * @param points Lista punktów (stacji).
+ *
+ * Najwyższy poziom zawiera pojedyncze stacje; każdy niższy powstaje z poprzedniego,
+ * więc budowa kosztuje O(n) na poziom.
+ */
+void StationClusterIndex::build(const QList<Point> &points)
+{
+    clear();
+    m_levels.resize(m_maxZoom - m_minZoom + 2);
+
+    Level &leaves = m_levels.last();
+    leaves.cellSize = radiusAt(m_maxZoom + 1);
+    leaves.nodes.reserve(points.size());
+    for (const Point &point : points)
+        leaves.nodes.append({ lonToX(point.lon), latToY(point.lat), 1, point.stationId, m_maxZoom + 1, {} });
+    indexLevel(leaves);
+
+    for (int zoom = m_maxZoom; zoom >= m_minZoom; --zoom)
+        m_levels[zoom - m_minZoom] = clusterLevel(m_levels.at(zoom - m_minZoom + 1), zoom);
+}
+
+/**
+ * @brief Usuwa wszystkie punkty z indeksu.
+ */
+void StationClusterIndex::clear()
+{
+    m_levels.clear();
+}
+
+/**
+ * @brief Łączy grupy poziomu wyższego w grupy poziomu zoom.
+ * @param upper Poziom wyższy (zoom + 1).
+ * @param zoom Budowany poziom przybliżenia.
+ * @return Nowy poziom.
+ *
+ * Grupy są przeglądane w kolejności indeksów; każda jeszcze nieprzydzielona wchłania
+ * nieprzydzielone grupy w promieniu radiusAt(zoom). Siatka pomocnicza ma komórki o boku
+ * równym promieniowi, więc sąsiedzi leżą w otoczeniu 3×3 komórek.
+ */
+StationClusterIndex::Level StationClusterIndex::clusterLevel(const Level &upper, int zoom) const
+{
+    const double radius = radiusAt(zoom);
+    const double radiusSquared = radius * radius;
+
+    QHash<qint64, QVector<int>> grid;
+    for (int i = 0; i < upper.nodes.size(); ++i) {
+        const Node &node = upper.nodes.at(i);
+        grid[cellKey(int(node.y / radius), int(node.x / radius))].append(i);
+    }
+
+    Level level;
+    level.cellSize = radius;
+    QVector<bool> assigned(upper.nodes.size(), false);
+    for (int i = 0; i < upper.nodes.size(); ++i) {
+        if (assigned.at(i))
+            continue;
+        assigned[i] = true;
+
+        const Node &seed = upper.nodes.at(i);
+        Node cluster { seed.x * seed.count, seed.y * seed.count, seed.count, seed.stationId, seed.expansionZoom, { i } };
+        const int row = int(seed.y / radius);
+        const int col = int(seed.x / radius);
+        for (int r = row - 1; r <= row + 1; ++r) {
+            for (int c = col - 1; c <= col + 1; ++c) {
+                auto it = grid.constFind(cellKey(r, c));
+                if (it == grid.constEnd())
+                    continue;
+                for (int j : it.value()) {
+                    if (assigned.at(j))
+                        continue;
+                    const Node &neighbour = upper.nodes.at(j);
+                    const double dx = neighbour.x - seed.x;
+                    const double dy = neighbour.y - seed.y;
+                    if (dx * dx + dy * dy > radiusSquared)
+                        continue;
+                    assigned[j] = true;
+                    cluster.x += neighbour.x * neighbour.count;
+                    cluster.y += neighbour.y * neighbour.count;
+                    cluster.count += neighbour.count;
+                    cluster.children.append(j);
+                }
+            }
+        }
+
+        cluster.x /= cluster.count;
+        cluster.y /= cluster.count;
+        if (cluster.children.size() > 1) {
+            cluster.stationId = -1;
+            cluster.expansionZoom = zoom + 1;
+        }
+        level.nodes.append(cluster);
+    }
+
+    indexLevel(level);
+    return level;
+}
+
+/**
+ * @brief Wyszukuje grupy w prostokącie współrzędnych na danym poziomie przybliżenia.
+ * @param west Zachodnia granica (długość geograficzna).
+ * @param south Południowa granica (szerokość geograficzna).
+ * @param east Wschodnia granica (długość geograficzna).
+ * @param north Północna granica (szerokość geograficzna).
+ * @param zoom Całkowity poziom przybliżenia.
+ * @return Grupy, których środek leży w prostokącie.
+ *
+ * Liczba komórek siatki w widoku zależy tylko od rozmiaru widoku w pikselach; jeśli mimo to
+ * przekracza liczbę grup poziomu (np. widok znacznie większy od obszaru stacji), grupy
+ * są przeglądane bezpośrednio.
+ */
+QList<StationCluster> StationClusterIndex::clusters(double west, double south, double east, double north, int zoom) const
+{
+    QList<StationCluster> result;
+    if (m_levels.isEmpty())
+        return result;
+
+    const int levelIndex = qBound(m_minZoom, zoom, m_maxZoom + 1) - m_minZoom;
+    const Level &level = m_levels.at(levelIndex);
+    const double minX = lonToX(west);
+    const double maxX = lonToX(east);
+    const double minY = latToY(north);
+    const double maxY = latToY(south);
+
+    auto append = [&](int index) {
+        const Node &node = level.nodes.at(index);
+        if (node.x < minX || node.x > maxX || node.y < minY || node.y > maxY)
+            return;
+        StationCluster cluster;
+        cluster.clusterId = levelIndex * kIdStride + index;
+        cluster.lon = xToLon(node.x);
+        cluster.lat = yToLat(node.y);
+        cluster.count = node.count;
+        cluster.stationId = node.stationId;
+        cluster.expansionZoom = node.expansionZoom;
+        result.append(cluster);
+    };
+
+    const int minRow = int(minY / level.cellSize);
+    const int maxRow = int(maxY / level.cellSize);
+    const int minCol = int(minX / level.cellSize);
+    const int maxCol = int(maxX / level.cellSize);
+    if (qint64(maxRow - minRow + 1) * (maxCol - minCol + 1) > level.nodes.size()) {
+        for (int i = 0; i < level.nodes.size(); ++i)
+            append(i);
+        return result;
+    }
+
+    for (int row = minRow; row <= maxRow; ++row) {
+        for (int col = minCol; col <= maxCol; ++col) {
+            auto it = level.cells.constFind(cellKey(row, col));
+            if (it == level.cells.constEnd())
+                continue;
+            for (int index : it.value())
+                append(index);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Pobiera identyfikatory wszystkich stacji grupy.
+ * @param clusterId Identyfikator grupy.
+ * @return Identyfikatory stacji (pusta lista dla nieznanej grupy).
+ */
+QList<int> StationClusterIndex::leaves(int clusterId) const
+{
+    QList<int> stationIds;
+    const int levelIndex = clusterId / kIdStride;
+    const int index = clusterId % kIdStride;
+    if (clusterId < 0 || levelIndex >= m_levels.size() || index >= m_levels.at(levelIndex).nodes.size())
+        return stationIds;
+
+    QList<QPair<int, int>> pending = { { levelIndex, index } };
+    while (!pending.isEmpty()) {
+        const QPair<int, int> entry = pending.takeLast();
+        const Node &node = m_levels.at(entry.first).nodes.at(entry.second);
+        if (node.children.isEmpty()) {
+            stationIds.append(node.stationId);
+            continue;
+        }
+        for (int child : node.children)
+            pending.append({ entry.first + 1, child });
+    }
+    return stationIds;
+}
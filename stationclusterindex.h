@@ -0,0 +1,190 @@
+/**
+ * @file stationclusterindex.h
+ * @brief Plik nagłówkowy dla klasy StationClusterIndex.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje hierarchiczne grupowanie stacji na mapie, wyznaczane z góry
+ * dla każdego całkowitego poziomu przybliżenia.
+ */
+
+#ifndef STATIONCLUSTERINDEX_H
+#define STATIONCLUSTERINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QVector>
+#include "stationspatialindex.h"
+
+/**
+ * @struct StationCluster
+ * @brief Grupa stacji (lub pojedyncza stacja) widoczna na danym poziomie przybliżenia.
+ */
+struct StationCluster {
+    int clusterId = -1;      ///< Identyfikator grupy (ważny dla indeksu, z którego pochodzi).
+    double lat = 0.0;        ///< Szerokość geograficzna środka grupy.
+    double lon = 0.0;        ///< Długość geograficzna środka grupy.
+    int count = 0;           ///< Liczba stacji w grupie.
+    int stationId = -1;      ///< Identyfikator stacji dla grupy jednoelementowej, w przeciwnym razie -1.
+    int expansionZoom = 0;   ///< Najmniejszy poziom przybliżenia, na którym grupa się rozpada.
+};
+
+/**
+ * @class StationClusterIndex
+ * @brief Grupowanie stacji w siatce, wyznaczane dla każdego poziomu przybliżenia (jak supercluster).
+ *
+ * Współrzędne są rzutowane na odwzorowanie Mercatora w zakresie [0, 1]. Poziom maxZoom + 1
+ * zawiera pojedyncze stacje; każdy niższy poziom powstaje z wyższego przez połączenie grup
+ * odległych o mniej niż radiusPx pikseli ekranu w środek ciężkości ważony liczbą stacji.
+ * Dzięki temu środki grup na jednym poziomie są od siebie odległe co najmniej o promień,
+ * więc liczba grup w widoku jest ograniczona niezależnie od liczby stacji. Zapytanie o widok
+ * przegląda tylko komórki siatki poziomu, których rozmiar także skaluje się z przybliżeniem.
+ */
+class StationClusterIndex {
+public:
+    /// Punkt wejściowy indeksu (jak w indeksie przestrzennym).
+    using Point = StationSpatialIndex::Point;
+
+    /// Rozmiar kafelka mapy w pikselach, zgodny z poziomami przybliżenia Qt Location (OSM).
+    static constexpr int kTileSize = 256;
+
+    /**
+     * @brief Konstruktor obiektu StationClusterIndex.
+     * @param radiusPx Promień grupowania w pikselach ekranu.
+     * @param minZoom Najmniejszy poziom przybliżenia z grupowaniem.
+     * @param maxZoom Największy poziom przybliżenia z grupowaniem (wyżej tylko pojedyncze stacje).
+     */
+    explicit StationClusterIndex(double radiusPx = 40.0, int minZoom = 0, int maxZoom = 16);
+
+    /**
+     * @brief Buduje grupy wszystkich poziomów od nowa.
+     * @param points Lista punktów (stacji).
+     */
+    void build(const QList<Point> &points);
+
+    /**
+     * @brief Usuwa wszystkie punkty z indeksu.
+     */
+    void clear();
+
+    /**
+     * @brief Pobiera liczbę zaindeksowanych stacji.
+     * @return Liczba stacji.
+     */
+    int size() const { return m_levels.isEmpty() ? 0 : m_levels.constLast().nodes.size(); }
+
+    /**
+     * @brief Pobiera największy poziom przybliżenia z grupowaniem.
+     * @return Poziom przybliżenia.
+     */
+    int maxZoom() const { return m_maxZoom; }
+
+    /**
+     * @brief Wyszukuje grupy w prostokącie współrzędnych na danym poziomie przybliżenia.
+     * @param west Zachodnia granica (długość geograficzna).
+     * @param south Południowa granica (szerokość geograficzna).
+     * @param east Wschodnia granica (długość geograficzna).
+     * @param north Północna granica (szerokość geograficzna).
+     * @param zoom Całkowity poziom przybliżenia (przycinany do zakresu indeksu).
+     * @return Grupy, których środek leży w prostokącie.
+     */
+    QList<StationCluster> clusters(double west, double south, double east, double north, int zoom) const;
+
+    /**
+     * @brief Pobiera identyfikatory wszystkich stacji grupy.
+     * @param clusterId Identyfikator grupy.
+     * @return Identyfikatory stacji (pusta lista dla nieznanej grupy).
+     */
+    QList<int> leaves(int clusterId) const;
+
+    /**
+     * @brief Rzutuje długość geograficzną na oś X odwzorowania Mercatora.
+     * @param lon Długość geograficzna.
+     * @return Współrzędna w zakresie [0, 1].
+     */
+    static double lonToX(double lon);
+
+    /**
+     * @brief Rzutuje szerokość geograficzną na oś Y odwzorowania Mercatora.
+     * @param lat Szerokość geograficzna.
+     * @return Współrzędna w zakresie [0, 1] (0 na północy).
+     */
+    static double latToY(double lat);
+
+    /**
+     * @brief Odwraca rzut Mercatora na osi X.
+     * @param x Współrzędna w zakresie [0, 1].
+     * @return Długość geograficzna.
+     */
+    static double xToLon(double x);
+
+    /**
+     * @brief Odwraca rzut Mercatora na osi Y.
+     * @param y Współrzędna w zakresie [0, 1] (0 na północy).
+     * @return Szerokość geograficzna.
+     */
+    static double yToLat(double y);
+
+private:
+    /**
+     * @struct Node
+     * @brief Grupa jednego poziomu.
+     */
+    struct Node {
+        double x;                ///< Środek grupy (Mercator).
+        double y;                ///< Środek grupy (Mercator).
+        int count;               ///< Liczba stacji.
+        int stationId;           ///< Stacja grupy jednoelementowej lub -1.
+        int expansionZoom;       ///< Poziom, na którym grupa się rozpada.
+        QVector<int> children;   ///< Indeksy grup poziomu wyższego.
+    };
+
+    /**
+     * @struct Level
+     * @brief Grupy jednego poziomu przybliżenia z siatką do zapytań.
+     */
+    struct Level {
+        QVector<Node> nodes;                 ///< Grupy poziomu.
+        double cellSize = 1.0;               ///< Rozmiar komórki siatki (Mercator).
+        QHash<qint64, QVector<int>> cells;   ///< Komórka siatki -> indeksy grup.
+    };
+
+    /// Odstęp identyfikatorów grup kolejnych poziomów.
+    static constexpr int kIdStride = 1 << 24;
+
+    /**
+     * @brief Wyznacza promień grupowania poziomu w jednostkach odwzorowania.
+     * @param zoom Poziom przybliżenia.
+     * @return Promień (Mercator).
+     */
+    double radiusAt(int zoom) const;
+
+    /**
+     * @brief Składa klucz komórki z indeksów wiersza i kolumny.
+     * @param row Indeks wiersza.
+     * @param col Indeks kolumny.
+     * @return Klucz komórki.
+     */
+    static qint64 cellKey(int row, int col);
+
+    /**
+     * @brief Wypełnia siatkę poziomu.
+     * @param level Poziom z ustawionym rozmiarem komórki.
+     */
+    static void indexLevel(Level &level);
+
+    /**
+     * @brief Łączy grupy poziomu wyższego w grupy poziomu zoom.
+     * @param upper Poziom wyższy (zoom + 1).
+     * @param zoom Budowany poziom przybliżenia.
+     * @return Nowy poziom.
+     */
+    Level clusterLevel(const Level &upper, int zoom) const;
+
+    double m_radiusPx;          ///< Promień grupowania w pikselach.
+    int m_minZoom;              ///< Najmniejszy poziom przybliżenia.
+    int m_maxZoom;              ///< Największy poziom przybliżenia z grupowaniem.
+    QVector<Level> m_levels;    ///< Poziomy od minZoom do maxZoom + 1 (pojedyncze stacje).
+};
+
+#endif // STATIONCLUSTERINDEX_H
@@ -0,0 +1,328 @@
+/**
+ * @file stationclustermodel.cpp
+ * @brief Implementacja klasy StationClusterModel.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera odbudowę indeksu grup po zmianie katalogu stacji oraz różnicową
+ * aktualizację znaczników po zmianie widoku mapy.
+ */
+
+#include "stationclustermodel.h"
+#include "airqualityindex.h"
+#include "metricsregistry.h"
+#include "stationlistmodel.h"
+#include <QHash>
+#include <QtMath>
+#include <algorithm>
+
+/**
+ * @brief Konstruktor obiektu StationClusterModel.
+ * @param stations Model wszystkich stacji.
+ * @param parent Rodzic QObject.
+ */
+StationClusterModel::StationClusterModel(StationListModel *stations, QObject *parent)
+    : QAbstractListModel(parent),
+    m_stations(stations)
+{
+    m_rebuildTimer.setSingleShot(true);
+    m_rebuildTimer.setInterval(0);
+    connect(&m_rebuildTimer, &QTimer::timeout, this, &StationClusterModel::rebuild);
+
+    m_refreshTimer.setSingleShot(true);
+    m_refreshTimer.setInterval(0);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &StationClusterModel::refresh);
+
+    connect(m_stations, &QAbstractItemModel::rowsInserted, this, &StationClusterModel::scheduleRebuild);
+    connect(m_stations, &QAbstractItemModel::rowsRemoved, this, &StationClusterModel::scheduleRebuild);
+    connect(m_stations, &QAbstractItemModel::modelReset, this, &StationClusterModel::scheduleRebuild);
+    connect(m_stations, &QAbstractItemModel::dataChanged, this, &StationClusterModel::onStationsChanged);
+}
+
+/**
+ * @brief Zwraca liczbę wierszy modelu.
+ * @param parent Indeks rodzica.
+ * @return Liczba znaczników lub 0 dla poprawnego rodzica.
+ */
+int StationClusterModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return m_rows.size();
+}
+
+/**
+ * @brief Zwraca dane dla wskazanego wiersza i roli.
+ * @param index Indeks wiersza.
+ * @param role Rola danych.
+ * @return Wartość roli lub pusty QVariant.
+ *
+ * Dane stacji (nazwa, miasto, adres) są odczytywane z modelu stacji tylko dla
+ * znaczników pojedynczych stacji.
+ */
+QVariant StationClusterModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_rows.size())
+        return QVariant();
+
+    const Row &row = m_rows.at(index.row());
+    const StationCluster &cluster = row.cluster;
+    switch (role) {
+    case ClusterIdRole:
+        return cluster.clusterId;
+    case LatRole:
+        return cluster.lat;
+    case LonRole:
+        return cluster.lon;
+    case PointCountRole:
+        return cluster.count;
+    case IsClusterRole:
+        return cluster.count > 1;
+    case ExpansionZoomRole:
+        return cluster.expansionZoom;
+    case StationIdRole:
+        return cluster.stationId;
+    case IsSearchedRole:
+        return row.searched;
+    case AqiLevelRole:
+        return row.aqiLevel;
+    default:
+        break;
+    }
+
+    const int stationRow = cluster.stationId >= 0 ? m_stations->rowOf(cluster.stationId) : -1;
+    if (stationRow < 0)
+        return QVariant();
+    switch (role) {
+    case StationNameRole:
+    case Qt::DisplayRole:
+        return m_stations->stationName(stationRow);
+    case CityNameRole:
+        return m_stations->cityName(stationRow);
+    case AddressRole:
+        return m_stations->address(stationRow);
+    default:
+        return QVariant();
+    }
+}
+
+/**
+ * @brief Zwraca nazwy ról widoczne w QML.
+ * @return Mapa ról na nazwy (role stacji zgodne z StationListModel).
+ */
+QHash<int, QByteArray> StationClusterModel::roleNames() const
+{
+    return {
+        { ClusterIdRole, "clusterId" },
+        { LatRole, "lat" },
+        { LonRole, "lon" },
+        { PointCountRole, "pointCount" },
+        { IsClusterRole, "isCluster" },
+        { ExpansionZoomRole, "expansionZoom" },
+        { StationIdRole, "stationId" },
+        { StationNameRole, "stationName" },
+        { CityNameRole, "cityName" },
+        { AddressRole, "address" },
+        { IsSearchedRole, "isSearched" },
+        { AqiLevelRole, "aqiLevel" }
+    };
+}
+
+/**
+ * @brief Ustawia widoczny obszar mapy.
+ * @param west Zachodnia granica (długość geograficzna).
+ * @param south Południowa granica (szerokość geograficzna).
+ * @param east Wschodnia granica (długość geograficzna).
+ * @param north Północna granica (szerokość geograficzna).
+ * @param zoomLevel Poziom przybliżenia mapy.
+ *
+ * Przesunięcie w obrębie obszaru poprzedniego zapytania nie zmienia wierszy.
+ */
+void StationClusterModel::setViewport(double west, double south, double east, double north, double zoomLevel)
+{
+    if (!(west < east) || !(south < north) || qIsNaN(zoomLevel))
+        return;
+
+    m_visible = QRectF(west, south, east - west, north - south);
+    const int zoom = qBound(0, qFloor(zoomLevel), m_index.maxZoom() + 1);
+    if (zoom == m_zoom && m_queried.contains(m_visible))
+        return;
+
+    m_zoom = zoom;
+    refresh();
+}
+
+/**
+ * @brief Odbudowuje indeks grup natychmiast.
+ *
+ * Status wyszukiwania jest odczytywany od nowa, a znaczniki bieżącego widoku odświeżane.
+ */
+void StationClusterModel::rebuild()
+{
+    MetricsTimer timer("gios_model_build_duration_ms", "model=clusters");
+    m_rebuildTimer.stop();
+
+    QList<StationClusterIndex::Point> points;
+    points.reserve(m_stations->count());
+    m_searched.clear();
+    for (int row = 0; row < m_stations->count(); ++row) {
+        points.append({ m_stations->stationId(row), m_stations->lat(row), m_stations->lon(row) });
+        if (m_stations->isSearched(row))
+            m_searched.insert(m_stations->stationId(row));
+    }
+    m_index.build(points);
+    refresh();
+}
+
+/**
+ * @brief Podłącza indeks jakości powietrza wyznaczający role aqiLevel.
+ * @param airQuality Indeks jakości powietrza (nullptr odłącza).
+ *
+ * Zmiana poziomów stacji odświeża znaczniki w następnej iteracji pętli zdarzeń.
+ */
+void StationClusterModel::setAirQuality(AirQualityIndex *airQuality)
+{
+    if (m_airQuality == airQuality)
+        return;
+    if (m_airQuality)
+        disconnect(m_airQuality, nullptr, this, nullptr);
+    m_airQuality = airQuality;
+    if (m_airQuality) {
+        connect(m_airQuality, &AirQualityIndex::levelsChanged, this, [this]() { m_refreshTimer.start(); });
+        connect(m_airQuality, &AirQualityIndex::scaleChanged, this, [this]() { m_refreshTimer.start(); });
+    }
+    m_refreshTimer.start();
+}
+
+/**
+ * @brief Wyznacza poziom indeksu jakości powietrza znacznika.
+ * @param cluster Grupa lub pojedyncza stacja.
+ * @return Najgorszy poziom stacji znacznika lub -1.
+ */
+int StationClusterModel::aqiLevel(const StationCluster &cluster) const
+{
+    if (!m_airQuality || m_airQuality->ratedStations() == 0)
+        return -1;
+    if (cluster.count == 1)
+        return m_airQuality->level(cluster.stationId);
+
+    int level = -1;
+    for (int stationId : m_index.leaves(cluster.clusterId))
+        level = qMax(level, m_airQuality->level(stationId));
+    return level;
+}
+
+/**
+ * @brief Planuje odbudowę indeksu w następnej iteracji pętli zdarzeń.
+ */
+void StationClusterModel::scheduleRebuild()
+{
+    m_rebuildTimer.start();
+}
+
+/**
+ * @brief Nanosi zmiany statusu wyszukiwania stacji.
+ * @param topLeft Pierwszy zmieniony wiersz modelu stacji.
+ * @param bottomRight Ostatni zmieniony wiersz modelu stacji.
+ * @param roles Zmienione role.
+ *
+ * Zmiana samego statusu wyszukiwania odświeża tylko znaczniki; każda inna zmiana
+ * (np. zastąpienie stacji z nowymi współrzędnymi) wymaga odbudowy indeksu.
+ */
+void StationClusterModel::onStationsChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight,
+                                            const QList<int> &roles)
+{
+    if (roles != QList<int>{ StationListModel::IsSearchedRole }) {
+        scheduleRebuild();
+        return;
+    }
+
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        if (m_stations->isSearched(row))
+            m_searched.insert(m_stations->stationId(row));
+        else
+            m_searched.remove(m_stations->stationId(row));
+    }
+    m_refreshTimer.start();
+}
+
+/**
+ * @brief Odpytuje indeks o bieżący obszar i różnicowo aktualizuje wiersze.
+ *
+ * Wiersze są porównywane po kluczu: pojedyncza stacja zachowuje klucz na wszystkich
+ * poziomach przybliżenia, więc jej delegat przetrwa także zmianę przybliżenia.
+ * Wiersze spoza nowego wyniku są usuwane ciągłymi zakresami, zmienione zgłaszane
+ * sygnałem dataChanged (także po zmianie poziomu indeksu jakości powietrza), a nowe
+ * dopisywane jednym rowsInserted.
+ */
+void StationClusterModel::refresh()
+{
+    m_refreshTimer.stop();
+    if (m_zoom < 0)
+        return;
+
+    const double marginX = m_visible.width() * kViewportMargin;
+    const double marginY = m_visible.height() * kViewportMargin;
+    m_queried = m_visible.adjusted(-marginX, -marginY, marginX, marginY);
+    const QList<StationCluster> clusters = m_index.clusters(m_queried.left(), m_queried.top(),
+                                                           m_queried.right(), m_queried.bottom(), m_zoom);
+
+    QList<Row> next;
+    next.reserve(clusters.size());
+    QHash<qint64, int> nextByKey;
+    nextByKey.reserve(clusters.size());
+    for (const StationCluster &cluster : clusters) {
+        Row row { cluster.count == 1 ? qint64(cluster.stationId) : (qint64(1) << 32) | cluster.clusterId, cluster, false,
+                  aqiLevel(cluster) };
+        if (cluster.count == 1) {
+            row.searched = m_searched.contains(cluster.stationId);
+        } else if (!m_searched.isEmpty()) {
+            const QList<int> stationIds = m_index.leaves(cluster.clusterId);
+            row.searched = std::any_of(stationIds.cbegin(), stationIds.cend(),
+                                       [this](int stationId) { return m_searched.contains(stationId); });
+        }
+        nextByKey.insert(row.key, next.size());
+        next.append(row);
+    }
+
+    const int previousCount = m_rows.size();
+    for (int last = m_rows.size() - 1; last >= 0; --last) {
+        if (nextByKey.contains(m_rows.at(last).key))
+            continue;
+        int first = last;
+        while (first > 0 && !nextByKey.contains(m_rows.at(first - 1).key))
+            --first;
+        beginRemoveRows(QModelIndex(), first, last);
+        m_rows.erase(m_rows.begin() + first, m_rows.begin() + last + 1);
+        endRemoveRows();
+        last = first;
+    }
+
+    QSet<qint64> kept;
+    kept.reserve(m_rows.size());
+    for (int i = 0; i < m_rows.size(); ++i) {
+        Row &row = m_rows[i];
+        kept.insert(row.key);
+        const Row &updated = next.at(nextByKey.value(row.key));
+        if (row.searched == updated.searched && row.aqiLevel == updated.aqiLevel && row.cluster.clusterId == updated.cluster.clusterId
+            && row.cluster.count == updated.cluster.count && row.cluster.lat == updated.cluster.lat
+            && row.cluster.lon == updated.cluster.lon && row.cluster.expansionZoom == updated.cluster.expansionZoom)
+            continue;
+        row = updated;
+        emit dataChanged(index(i), index(i));
+    }
+
+    QList<Row> added;
+    for (const Row &row : std::as_const(next)) {
+        if (!kept.contains(row.key))
+            added.append(row);
+    }
+    if (!added.isEmpty()) {
+        beginInsertRows(QModelIndex(), m_rows.size(), m_rows.size() + added.size() - 1);
+        m_rows.append(added);
+        endInsertRows();
+    }
+
+    if (m_rows.size() != previousCount)
+        emit countChanged();
+}
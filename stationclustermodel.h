@@ -0,0 +1,181 @@
+/**
+ * @file stationclustermodel.h
+ * @brief Plik nagłówkowy dla klasy StationClusterModel.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje model znaczników mapy: grupy stacji lub pojedyncze stacje
+ * w bieżącym widoku i na bieżącym poziomie przybliżenia.
+ */
+
+#ifndef STATIONCLUSTERMODEL_H
+#define STATIONCLUSTERMODEL_H
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QRectF>
+#include <QSet>
+#include <QTimer>
+#include "stationclusterindex.h"
+
+class AirQualityIndex;
+class StationListModel;
+
+/**
+ * @class StationClusterModel
+ * @brief Model znaczników mapy zbudowany na StationClusterIndex.
+ *
+ * Indeks grup jest odbudowywany po zmianie modelu wszystkich stacji (zmiany z jednej
+ * iteracji pętli zdarzeń, np. kolejne fragmenty strumienia katalogu, łączone są w jedną
+ * odbudowę). Widok mapy zgłasza swój prostokąt metodą setViewport(); model odpytuje
+ * indeks o prostokąt powiększony o margines i ponownie dopiero wtedy, gdy widok wyjdzie
+ * poza ten obszar albo zmieni się całkowity poziom przybliżenia. Wiersze są zmieniane
+ * różnicowo (usunięcia, dopisania, dataChanged), więc przesunięcie mapy nie odtwarza
+ * delegatów znaczników, które pozostały w widoku. Po podłączeniu indeksu jakości
+ * powietrza znaczniki niosą poziom indeksu (dla grupy najgorszy poziom jej stacji).
+ */
+class StationClusterModel : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    /**
+     * @brief Role danych udostępniane delegatom QML.
+     */
+    enum ClusterRoles {
+        ClusterIdRole = Qt::UserRole + 1, ///< Identyfikator grupy.
+        LatRole,                          ///< Szerokość geograficzna znacznika.
+        LonRole,                          ///< Długość geograficzna znacznika.
+        PointCountRole,                   ///< Liczba stacji w grupie.
+        IsClusterRole,                    ///< Czy znacznik jest grupą kilku stacji.
+        ExpansionZoomRole,                ///< Poziom przybliżenia, na którym grupa się rozpada.
+        StationIdRole,                    ///< Identyfikator stacji (-1 dla grupy).
+        StationNameRole,                  ///< Nazwa stacji.
+        CityNameRole,                     ///< Nazwa miasta.
+        AddressRole,                      ///< Adres stacji.
+        IsSearchedRole,                   ///< Czy stacja (lub którakolwiek stacja grupy) jest wyszukana.
+        AqiLevelRole                      ///< Poziom indeksu jakości powietrza (dla grupy najgorszy, -1 bez danych).
+    };
+    Q_ENUM(ClusterRoles)
+
+    /// Margines zapytania jako ułamek szerokości i wysokości widoku z każdej strony.
+    static constexpr double kViewportMargin = 0.5;
+
+    /**
+     * @brief Konstruktor obiektu StationClusterModel.
+     * @param stations Model wszystkich stacji (źródło punktów i danych stacji).
+     * @param parent Rodzic QObject.
+     */
+    explicit StationClusterModel(StationListModel *stations, QObject *parent = nullptr);
+
+    /**
+     * @brief Zwraca liczbę wierszy modelu.
+     * @param parent Indeks rodzica (nieużywany w modelu listy).
+     * @return Liczba znaczników.
+     */
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    /**
+     * @brief Zwraca dane dla wskazanego wiersza i roli.
+     * @param index Indeks wiersza.
+     * @param role Rola danych.
+     * @return Wartość roli lub pusty QVariant.
+     */
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief Zwraca nazwy ról widoczne w QML.
+     * @return Mapa ról na nazwy.
+     */
+    QHash<int, QByteArray> roleNames() const override;
+
+    /**
+     * @brief Pobiera liczbę znaczników.
+     * @return Liczba wierszy modelu.
+     */
+    int count() const { return m_rows.size(); }
+
+    /**
+     * @brief Ustawia widoczny obszar mapy.
+     * @param west Zachodnia granica (długość geograficzna).
+     * @param south Południowa granica (szerokość geograficzna).
+     * @param east Wschodnia granica (długość geograficzna).
+     * @param north Północna granica (szerokość geograficzna).
+     * @param zoomLevel Poziom przybliżenia mapy (zaokrąglany w dół).
+     */
+    Q_INVOKABLE void setViewport(double west, double south, double east, double north, double zoomLevel);
+
+    /**
+     * @brief Pobiera identyfikatory stacji grupy.
+     * @param clusterId Identyfikator grupy.
+     * @return Lista identyfikatorów stacji.
+     */
+    Q_INVOKABLE QList<int> clusterStations(int clusterId) const { return m_index.leaves(clusterId); }
+
+    /**
+     * @brief Odbudowuje indeks grup natychmiast, bez czekania na pętlę zdarzeń.
+     */
+    void rebuild();
+
+    /**
+     * @brief Podłącza indeks jakości powietrza wyznaczający role aqiLevel.
+     * @param airQuality Indeks jakości powietrza (nullptr odłącza).
+     */
+    void setAirQuality(AirQualityIndex *airQuality);
+
+signals:
+    /**
+     * @brief Sygnał emitowany, gdy zmieni się liczba znaczników.
+     */
+    void countChanged();
+
+private:
+    /**
+     * @struct Row
+     * @brief Wiersz modelu.
+     */
+    struct Row {
+        qint64 key;               ///< Klucz wiersza (stacja lub grupa) do zmian różnicowych.
+        StationCluster cluster;   ///< Grupa z indeksu.
+        bool searched;            ///< Status wyszukiwania.
+        int aqiLevel;             ///< Poziom indeksu jakości powietrza.
+    };
+
+    /**
+     * @brief Planuje odbudowę indeksu w następnej iteracji pętli zdarzeń.
+     */
+    void scheduleRebuild();
+
+    /**
+     * @brief Nanosi zmiany statusu wyszukiwania stacji.
+     * @param topLeft Pierwszy zmieniony wiersz modelu stacji.
+     * @param bottomRight Ostatni zmieniony wiersz modelu stacji.
+     * @param roles Zmienione role.
+     */
+    void onStationsChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles);
+
+    /**
+     * @brief Odpytuje indeks o bieżący obszar i różnicowo aktualizuje wiersze.
+     */
+    void refresh();
+
+    /**
+     * @brief Wyznacza poziom indeksu jakości powietrza znacznika.
+     * @param cluster Grupa lub pojedyncza stacja.
+     * @return Najgorszy poziom stacji znacznika lub -1.
+     */
+    int aqiLevel(const StationCluster &cluster) const;
+
+    StationListModel *m_stations;     ///< Model wszystkich stacji.
+    AirQualityIndex *m_airQuality = nullptr; ///< Indeks jakości powietrza (opcjonalny).
+    StationClusterIndex m_index;      ///< Hierarchia grup.
+    QTimer m_rebuildTimer;            ///< Łączenie zmian modelu stacji w jedną odbudowę.
+    QTimer m_refreshTimer;            ///< Łączenie zmian statusu wyszukiwania i indeksu w jedno odświeżenie.
+    QSet<int> m_searched;             ///< Wyszukane stacje.
+    QList<Row> m_rows;                ///< Znaczniki w kolejności wierszy.
+    QRectF m_visible;                 ///< Ostatni zgłoszony widok (długość, szerokość).
+    QRectF m_queried;                 ///< Obszar ostatniego zapytania (widok z marginesem).
+    int m_zoom = -1;                  ///< Całkowity poziom przybliżenia ostatniego zapytania.
+};
+
+#endif // STATIONCLUSTERMODEL_H
@@ -0,0 +1,431 @@
+/**
+ * @file stationcomparison.cpp
+ * @brief Implementacja klasy StationComparison.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera pobieranie szeregów porównywanych stacji, ich wyrównanie do wspólnej
+ * siatki godzinowej oraz wyznaczanie kolumn podsumowania i rankingu.
+ */
+
+#include "stationcomparison.h"
+#include "historystore.h"
+#include "metricsregistry.h"
+#include "sensorstatistics.h"
+#include "stationlistmodel.h"
+#include "stationmonitor.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QSet>
+#include <QtConcurrent>
+#include <QtMath>
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+namespace {
+/// Grupa żądań porównania; unieważniana przez kolejne porównanie.
+const QString kComparisonRequests = QStringLiteral("comparison");
+}
+
+/**
+ * @brief Pobiera wartość komórki.
+ * @param row Wiersz (stacja).
+ * @param hour Kolumna (godzina od początku siatki).
+ * @return Wartość lub NaN poza macierzą i bez pomiaru.
+ */
+double ComparisonMatrix::value(int row, int hour) const
+{
+    if (row < 0 || row >= rows.size() || hour < 0 || hour >= hours)
+        return qQNaN();
+    return values.at(qsizetype(row) * hours + hour);
+}
+
+/**
+ * @brief Konstruktor obiektu StationComparison.
+ * @param apiClient Klient HTTP.
+ * @param parser Parser odpowiedzi (wspólny dla zadań w tle).
+ * @param history Historia pomiarów sensorów.
+ * @param stations Katalog stacji (nazwy w podsumowaniu).
+ * @param parent Rodzic QObject.
+ *
+ * Budowa ma jeden wątek, a nieaktualne zlecenia są pomijane; równoległość zapewniają
+ * wiersze i kolumny macierzy.
+ */
+StationComparison::StationComparison(ApiClient *apiClient, ReplyParser *parser, HistoryStore *history,
+                                     StationListModel *stations, QObject *parent)
+    : QObject(parent),
+    m_history(history),
+    m_stations(stations),
+    m_fetch(new StationFetchQueue(apiClient, parser, RequestOptions{ RequestPriority::Visible, kComparisonRequests },
+                                  kMaxRunningTasks, this))
+{
+    m_pool.setMaxThreadCount(1);
+
+    connect(m_fetch, &StationFetchQueue::sensorsReady, this, &StationComparison::onSensorsReady);
+    connect(m_fetch, &StationFetchQueue::sensorDataReady, this, &StationComparison::onSensorDataReady);
+    connect(m_fetch, &StationFetchQueue::drained, this, &StationComparison::startBuild);
+}
+
+/**
+ * @brief Destruktor; czeka na zakończenie trwającego obliczenia.
+ *
+ * Zadanie odwołuje się do obiektu przy przekazaniu wyniku, więc nie może go przeżyć.
+ */
+StationComparison::~StationComparison()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+/**
+ * @brief Pobiera początek siatki bieżącej macierzy.
+ * @return Data pierwszej godziny lub pusty napis.
+ */
+QString StationComparison::startText() const
+{
+    return m_matrix ? SensorSeries::formatTimestamp(m_matrix->gridStart) : QString();
+}
+
+/**
+ * @brief Pobiera normę parametru bieżącej macierzy.
+ * @return Norma w µg/m³ lub NaN.
+ */
+double StationComparison::threshold() const
+{
+    return m_matrix ? m_matrix->threshold : qQNaN();
+}
+
+/**
+ * @brief Pobiera największą wartość bieżącej macierzy.
+ * @return Maksimum wierszy lub 0 bez pomiarów.
+ */
+double StationComparison::maxValue() const
+{
+    double result = 0.0;
+    if (m_matrix) {
+        for (const ComparisonSummary &row : m_matrix->rows) {
+            if (row.coverage > 0)
+                result = qMax(result, row.max);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Pobiera kolumny podsumowania dla QML.
+ * @return Wiersze uporządkowane według rankingu; stacje bez pomiarów na końcu.
+ */
+QVariantList StationComparison::summary() const
+{
+    if (!m_matrix)
+        return {};
+
+    QVector<int> order(m_matrix->rowCount());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        const int rankA = m_matrix->rows.at(a).rank;
+        const int rankB = m_matrix->rows.at(b).rank;
+        return rankA > 0 && (rankB == 0 || rankA < rankB);
+    });
+
+    QVariantList result;
+    result.reserve(order.size());
+    for (int row : std::as_const(order)) {
+        const ComparisonSummary &summary = m_matrix->rows.at(row);
+        const int catalogRow = m_stations->rowOf(summary.stationId);
+        QVariantMap entry;
+        entry["row"] = row;
+        entry["stationId"] = summary.stationId;
+        entry["stationName"] = catalogRow >= 0 ? m_stations->stationName(catalogRow) : QString();
+        entry["cityName"] = catalogRow >= 0 ? m_stations->cityName(catalogRow) : QString();
+        entry["sensorId"] = summary.sensorId;
+        entry["mean"] = summary.mean;
+        entry["min"] = summary.min;
+        entry["max"] = summary.max;
+        entry["latest"] = summary.latest;
+        entry["coverage"] = summary.coverage;
+        entry["exceedances"] = summary.exceedances;
+        entry["rank"] = summary.rank;
+        result.append(entry);
+    }
+    return result;
+}
+
+/**
+ * @brief Pobiera parametry proponowane do porównania.
+ * @return Kody parametrów z normą w SensorStatistics.
+ */
+QStringList StationComparison::parameters() const
+{
+    static const QStringList codes = { "PM10", "PM2.5", "NO2", "O3", "SO2", "CO", "C6H6" };
+    return codes;
+}
+
+/**
+ * @brief Porównuje stacje dla jednego parametru.
+ * @param paramCode Kod parametru.
+ * @param stationIds Identyfikatory stacji; powtórzenia są pomijane.
+ * @param hours Liczba godzin siatki (ograniczana do kMaxHours).
+ *
+ * Siatka kończy się na bieżącej godzinie pomiarowej. Listy sensorów i pomiary aktualne
+ * w pamięci podręcznej odpowiedzi nie wymagają sieci, a sensory z aktualną historią nie są
+ * w ogóle pobierane, więc powtórne porównanie tych samych stacji to tylko budowa macierzy.
+ */
+void StationComparison::compare(const QString &paramCode, const QList<int> &stationIds, int hours)
+{
+    if (paramCode.isEmpty() || stationIds.isEmpty() || hours <= 0) {
+        qWarning() << "Porównanie stacji: brak parametru, stacji lub godzin";
+        return;
+    }
+
+    cancel();
+    m_paramCode = paramCode;
+    m_hours = qMin(hours, kMaxHours);
+    m_gridEnd = StationMonitor::currentMeasurementHour(QDateTime::currentDateTimeUtc());
+    m_stationIds.clear();
+    QSet<int> seen;
+    for (int stationId : stationIds) {
+        if (!seen.contains(stationId)) {
+            seen.insert(stationId);
+            m_stationIds.append(stationId);
+        }
+    }
+
+    setBusy(true);
+    for (int stationId : std::as_const(m_stationIds))
+        m_fetch->enqueueStation(stationId);
+}
+
+/**
+ * @brief Przerywa trwające porównanie.
+ *
+ * Unieważnia kolejkę i trwające żądania oraz wynik budowy, który jeszcze nie wrócił.
+ */
+void StationComparison::cancel()
+{
+    ++m_generation;
+    m_stationIds.clear();
+    m_sensorByStation.clear();
+    m_fetched.clear();
+    m_fetch->cancelAll();
+    setBusy(false);
+}
+
+/**
+ * @brief Pobiera wartość komórki bieżącej macierzy.
+ * @param row Wiersz.
+ * @param hour Godzina od początku siatki.
+ * @return Wartość lub NaN.
+ */
+double StationComparison::value(int row, int hour) const
+{
+    return m_matrix ? m_matrix->value(row, hour) : qQNaN();
+}
+
+/**
+ * @brief Pobiera wiersz bieżącej macierzy.
+ * @param row Wiersz.
+ * @return Wartości kolejnych godzin lub pusta lista.
+ */
+QVariantList StationComparison::rowValues(int row) const
+{
+    QVariantList result;
+    if (!m_matrix || row < 0 || row >= m_matrix->rowCount())
+        return result;
+
+    result.reserve(m_matrix->hours);
+    const double *cells = m_matrix->values.constData() + qsizetype(row) * m_matrix->hours;
+    for (int hour = 0; hour < m_matrix->hours; ++hour)
+        result.append(cells[hour]);
+    return result;
+}
+
+/**
+ * @brief Buduje macierz synchronicznie.
+ * @param paramCode Kod parametru.
+ * @param inputs Szeregi stacji.
+ * @param gridStart Początek pierwszej godziny siatki.
+ * @param hours Liczba godzin siatki.
+ * @return Macierz z podsumowaniem, rankingiem i średnią godzinową.
+ *
+ * Pomiar trafia do godziny, w której się zaczyna; z kilku pomiarów tej samej godziny
+ * zostaje ostatni. Każdy wiersz pisze tylko do własnych komórek i własnego podsumowania,
+ * a każda kolumna tylko do własnej średniej, więc obie części nie wymagają synchronizacji.
+ * Ranking porządkuje stacje z pomiarami malejąco według średniej.
+ */
+QSharedPointer<ComparisonMatrix> StationComparison::build(const QString &paramCode, const QList<ComparisonInput> &inputs,
+                                                          qint64 gridStart, int hours)
+{
+    MetricsTimer timer("gios_model_build_duration_ms", "model=station_comparison");
+    auto matrix = QSharedPointer<ComparisonMatrix>::create();
+    matrix->paramCode = paramCode;
+    matrix->gridStart = gridStart;
+    matrix->hours = qMax(0, hours);
+    matrix->threshold = SensorStatistics::thresholdForParam(paramCode);
+    matrix->values.fill(qQNaN(), qsizetype(inputs.size()) * matrix->hours);
+    matrix->rows.resize(inputs.size());
+    matrix->hourlyMean.fill(qQNaN(), matrix->hours);
+
+    // Wskaźniki pobierane przed podziałem, aby wątki nie odłączały danych
+    const int columns = matrix->hours;
+    const qint64 gridEnd = gridStart + qint64(columns) * 3600;
+    const double threshold = matrix->threshold;
+    double *values = matrix->values.data();
+    ComparisonSummary *rows = matrix->rows.data();
+    double *hourlyMean = matrix->hourlyMean.data();
+
+    QVector<int> rowIndexes(inputs.size());
+    std::iota(rowIndexes.begin(), rowIndexes.end(), 0);
+    QtConcurrent::blockingMap(rowIndexes, [&](int row) {
+        const ComparisonInput &input = inputs.at(row);
+        double *cells = values + qsizetype(row) * columns;
+        const QVector<qint64> &timestamps = input.series.timestamps();
+        for (auto it = std::lower_bound(timestamps.cbegin(), timestamps.cend(), gridStart);
+             it != timestamps.cend() && *it < gridEnd; ++it) {
+            const int index = int(it - timestamps.cbegin());
+            if (!input.series.isNull(index))
+                cells[(*it - gridStart) / 3600] = input.series.value(index);
+        }
+
+        ComparisonSummary &summary = rows[row];
+        summary.stationId = input.stationId;
+        summary.sensorId = input.sensorId;
+        summary.min = summary.max = summary.latest = qQNaN();
+        double sum = 0.0;
+        for (int hour = 0; hour < columns; ++hour) {
+            const double value = cells[hour];
+            if (qIsNaN(value))
+                continue;
+            summary.min = summary.coverage == 0 ? value : qMin(summary.min, value);
+            summary.max = summary.coverage == 0 ? value : qMax(summary.max, value);
+            summary.latest = value;
+            sum += value;
+            ++summary.coverage;
+            if (value > threshold)
+                ++summary.exceedances;
+        }
+        summary.mean = summary.coverage > 0 ? sum / summary.coverage : qQNaN();
+    });
+
+    QVector<int> hourIndexes(columns);
+    std::iota(hourIndexes.begin(), hourIndexes.end(), 0);
+    const int rowCount = inputs.size();
+    QtConcurrent::blockingMap(hourIndexes, [&](int hour) {
+        double sum = 0.0;
+        int count = 0;
+        for (int row = 0; row < rowCount; ++row) {
+            const double value = values[qsizetype(row) * columns + hour];
+            if (!qIsNaN(value)) {
+                sum += value;
+                ++count;
+            }
+        }
+        if (count > 0)
+            hourlyMean[hour] = sum / count;
+    });
+
+    QVector<int> ranked;
+    for (int row = 0; row < rowCount; ++row) {
+        if (rows[row].coverage > 0)
+            ranked.append(row);
+    }
+    std::stable_sort(ranked.begin(), ranked.end(), [rows](int a, int b) { return rows[a].mean > rows[b].mean; });
+    for (int i = 0; i < ranked.size(); ++i)
+        rows[ranked.at(i)].rank = i + 1;
+    return matrix;
+}
+
+/**
+ * @brief Wybiera sensor parametru i dodaje do kolejki jego pomiary.
+ * @param stationId Identyfikator stacji.
+ * @param sensors Sensory stacji.
+ *
+ * Pomiary są pobierane tylko wtedy, gdy w historii brakuje bieżącej godziny pomiarowej.
+ */
+void StationComparison::onSensorsReady(int stationId, const QList<SensorInfo> &sensors)
+{
+    for (const SensorInfo &sensor : sensors) {
+        if (sensor.paramCode.compare(m_paramCode, Qt::CaseInsensitive) != 0)
+            continue;
+        m_sensorByStation.insert(stationId, sensor.sensorId);
+        if (StationMonitor::isStale(m_history->lastTimestamp(sensor.sensorId), m_gridEnd))
+            m_fetch->enqueueSensor(stationId, sensor.sensorId);
+        break;
+    }
+}
+
+/**
+ * @brief Dopisuje pobrane pomiary do historii.
+ * @param stationId Identyfikator stacji.
+ * @param sensorId Identyfikator sensora.
+ * @param series Pomiary sensora.
+ *
+ * Pomiary zostają też w pamięci do budowy macierzy, na wypadek gdyby zapis historii się nie powiódł.
+ */
+void StationComparison::onSensorDataReady(int stationId, int sensorId, const SensorSeries &series)
+{
+    Q_UNUSED(stationId);
+    m_history->merge(sensorId, series);
+    m_fetched.insert(sensorId, series);
+}
+
+/**
+ * @brief Wczytuje szeregi z historii i buduje macierz w osobnym wątku.
+ *
+ * Odczytywane są tylko segmenty miesięcy siatki. Wielokrotne wywołanie po zakończeniu
+ * tych samych zadań buduje macierz raz, bo lista stacji jest przy tym opróżniana.
+ */
+void StationComparison::startBuild()
+{
+    const QList<int> stationIds = std::exchange(m_stationIds, {});
+    if (stationIds.isEmpty())
+        return;
+
+    const qint64 gridStart = m_gridEnd - qint64(m_hours - 1) * 3600;
+    const qint64 gridLast = m_gridEnd + 3599;
+    QList<ComparisonInput> inputs;
+    inputs.reserve(stationIds.size());
+    for (int stationId : stationIds) {
+        ComparisonInput input;
+        input.stationId = stationId;
+        input.sensorId = m_sensorByStation.value(stationId);
+        if (input.sensorId != 0) {
+            input.series = m_history->query(input.sensorId, gridStart, gridLast);
+            const auto fetched = m_fetched.constFind(input.sensorId);
+            if (fetched != m_fetched.constEnd())
+                input.series = SensorSeries::merged(input.series, fetched.value());
+        }
+        inputs.append(input);
+    }
+    m_sensorByStation.clear();
+    m_fetched.clear();
+
+    const quint64 generation = m_generation.load();
+    const QString paramCode = m_paramCode;
+    const int hours = m_hours;
+    QtConcurrent::run(&m_pool, [this, generation, paramCode, inputs, gridStart, hours]() {
+        if (generation != m_generation.load())
+            return; // Porównanie przerwane lub zastąpione nowszym
+        const QSharedPointer<const ComparisonMatrix> matrix = build(paramCode, inputs, gridStart, hours);
+        QMetaObject::invokeMethod(this, [this, generation, matrix]() {
+            if (generation != m_generation.load())
+                return;
+            m_matrix = matrix;
+            emit resultChanged();
+            setBusy(false);
+        }, Qt::QueuedConnection);
+    });
+}
+
+/**
+ * @brief Ustawia stan zajętości.
+ * @param busy Nowy stan.
+ */
+void StationComparison::setBusy(bool busy)
+{
+    if (m_busy == busy)
+        return;
+    m_busy = busy;
+    emit busyChanged();
+}
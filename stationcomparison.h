@@ -0,0 +1,291 @@
+/**
+ * @file stationcomparison.h
+ * @brief Plik nagłówkowy dla klasy StationComparison.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje porównanie wielu stacji dla jednego parametru: szeregi sensorów
+ * wyrównane do wspólnej siatki godzinowej w gęstej macierzy stacje × godziny
+ * wraz z kolumnami podsumowania i rankingiem.
+ */
+
+#ifndef STATIONCOMPARISON_H
+#define STATIONCOMPARISON_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVariantList>
+#include <QVector>
+#include <atomic>
+#include "apiclient.h"
+#include "replyparser.h"
+#include "sensorseries.h"
+#include "stationfetchqueue.h"
+
+class HistoryStore;
+class StationListModel;
+
+/**
+ * @struct ComparisonInput
+ * @brief Szereg jednej stacji wejściowej porównania.
+ */
+struct ComparisonInput {
+    int stationId = 0;    ///< Identyfikator stacji.
+    int sensorId = 0;     ///< Identyfikator sensora parametru (0, jeśli stacja go nie mierzy).
+    SensorSeries series;  ///< Pomiary uporządkowane rosnąco według czasu.
+};
+
+/**
+ * @struct ComparisonSummary
+ * @brief Kolumny podsumowania jednego wiersza macierzy.
+ */
+struct ComparisonSummary {
+    int stationId = 0;      ///< Identyfikator stacji.
+    int sensorId = 0;       ///< Identyfikator sensora.
+    double mean = 0.0;      ///< Średnia godzin z pomiarem (NaN bez pomiarów).
+    double min = 0.0;       ///< Wartość minimalna (NaN bez pomiarów).
+    double max = 0.0;       ///< Wartość maksymalna (NaN bez pomiarów).
+    double latest = 0.0;    ///< Ostatni pomiar w siatce (NaN bez pomiarów).
+    int coverage = 0;       ///< Liczba godzin z pomiarem.
+    int exceedances = 0;    ///< Liczba godzin powyżej normy parametru.
+    int rank = 0;           ///< Miejsce według średniej (1 = najwyższa; 0 bez pomiarów).
+};
+
+/**
+ * @struct ComparisonMatrix
+ * @brief Wyrównane szeregi stacji jednego parametru.
+ */
+struct ComparisonMatrix {
+    QString paramCode;                  ///< Kod parametru.
+    qint64 gridStart = 0;               ///< Początek pierwszej godziny siatki (czas ścienny jako UTC).
+    int hours = 0;                      ///< Liczba kolumn (godzin) siatki.
+    double threshold = 0.0;             ///< Norma parametru (NaN dla parametru bez normy).
+    QVector<double> values;             ///< Wartości wierszami: stacja × godzina (NaN bez pomiaru).
+    QVector<ComparisonSummary> rows;    ///< Podsumowanie wierszy w kolejności wejścia.
+    QVector<double> hourlyMean;         ///< Średnia wszystkich stacji w każdej godzinie (NaN bez pomiarów).
+
+    /**
+     * @brief Pobiera liczbę wierszy (stacji).
+     * @return Liczba wierszy.
+     */
+    int rowCount() const { return rows.size(); }
+
+    /**
+     * @brief Pobiera wartość komórki.
+     * @param row Wiersz (stacja).
+     * @param hour Kolumna (godzina od początku siatki).
+     * @return Wartość lub NaN poza macierzą i bez pomiaru.
+     */
+    double value(int row, int hour) const;
+};
+
+/**
+ * @class StationComparison
+ * @brief Porównanie wybranych stacji dla jednego parametru.
+ *
+ * compare() pobiera przez StationFetchQueue listy sensorów stacji (z pamięci podręcznej
+ * odpowiedzi, jeśli są aktualne),
+ * wybiera sensor zadanego parametru i wczytuje jego pomiary z HistoryStore. Pomiary z API
+ * pobierane są tylko dla sensorów, których historia nie ma bieżącej godziny pomiarowej;
+ * są wtedy dopisywane do historii. Gdy wszystkie dane są lokalne, macierz budowana jest
+ * w osobnym wątku: wiersze i kolumny są niezależne, więc wyrównanie i redukcje wykonuje
+ * równolegle globalna pula wątków. Nowe wywołanie compare() unieważnia poprzednie.
+ */
+class StationComparison : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool busy READ isBusy NOTIFY busyChanged)
+    Q_PROPERTY(QString paramCode READ paramCode NOTIFY resultChanged)
+    Q_PROPERTY(int rowCount READ rowCount NOTIFY resultChanged)
+    Q_PROPERTY(int hours READ hours NOTIFY resultChanged)
+    Q_PROPERTY(QString startText READ startText NOTIFY resultChanged)
+    Q_PROPERTY(double threshold READ threshold NOTIFY resultChanged)
+    Q_PROPERTY(double maxValue READ maxValue NOTIFY resultChanged)
+    Q_PROPERTY(QVariantList summary READ summary NOTIFY resultChanged)
+    Q_PROPERTY(QStringList parameters READ parameters CONSTANT)
+
+public:
+    /// Domyślna długość siatki w godzinach (tydzień).
+    static constexpr int kDefaultHours = 168;
+
+    /// Największa długość siatki w godzinach (rok).
+    static constexpr int kMaxHours = 366 * 24;
+
+    /// Maksymalna liczba żądań porównania w toku.
+    static constexpr int kMaxRunningTasks = 4;
+
+    /**
+     * @brief Konstruktor obiektu StationComparison.
+     * @param apiClient Klient HTTP.
+     * @param parser Parser odpowiedzi (wspólny dla zadań w tle).
+     * @param history Historia pomiarów sensorów.
+     * @param stations Katalog stacji (nazwy w podsumowaniu).
+     * @param parent Rodzic QObject.
+     */
+    StationComparison(ApiClient *apiClient, ReplyParser *parser, HistoryStore *history, StationListModel *stations,
+                      QObject *parent = nullptr);
+
+    /**
+     * @brief Destruktor; czeka na zakończenie trwającego obliczenia.
+     */
+    ~StationComparison() override;
+
+    /**
+     * @brief Sprawdza, czy trwa pobieranie danych lub budowa macierzy.
+     * @return True w trakcie porównania.
+     */
+    bool isBusy() const { return m_busy; }
+
+    /**
+     * @brief Pobiera kod parametru bieżącej macierzy.
+     * @return Kod parametru lub pusty napis.
+     */
+    QString paramCode() const { return m_matrix ? m_matrix->paramCode : QString(); }
+
+    /**
+     * @brief Pobiera liczbę stacji bieżącej macierzy.
+     * @return Liczba wierszy.
+     */
+    int rowCount() const { return m_matrix ? m_matrix->rowCount() : 0; }
+
+    /**
+     * @brief Pobiera liczbę godzin bieżącej macierzy.
+     * @return Liczba kolumn.
+     */
+    int hours() const { return m_matrix ? m_matrix->hours : 0; }
+
+    /**
+     * @brief Pobiera początek siatki bieżącej macierzy.
+     * @return Data w formacie SensorSeries::formatTimestamp() lub pusty napis.
+     */
+    QString startText() const;
+
+    /**
+     * @brief Pobiera normę parametru bieżącej macierzy.
+     * @return Norma w µg/m³ lub NaN.
+     */
+    double threshold() const;
+
+    /**
+     * @brief Pobiera największą wartość bieżącej macierzy (skala barw).
+     * @return Maksimum lub 0 bez pomiarów.
+     */
+    double maxValue() const;
+
+    /**
+     * @brief Pobiera kolumny podsumowania dla QML.
+     * @return Lista map {row, stationId, stationName, cityName, sensorId, mean, min, max, latest,
+     *         coverage, exceedances, rank} uporządkowana według rankingu.
+     */
+    QVariantList summary() const;
+
+    /**
+     * @brief Pobiera parametry proponowane do porównania.
+     * @return Kody zanieczyszczeń.
+     */
+    QStringList parameters() const;
+
+    /**
+     * @brief Pobiera bieżącą macierz.
+     * @return Macierz lub nullptr.
+     */
+    QSharedPointer<const ComparisonMatrix> matrix() const { return m_matrix; }
+
+    /**
+     * @brief Porównuje stacje dla jednego parametru.
+     * @param paramCode Kod parametru (np. "PM10").
+     * @param stationIds Identyfikatory stacji (kolejność wierszy macierzy).
+     * @param hours Liczba godzin siatki kończącej się na bieżącej godzinie pomiarowej.
+     */
+    Q_INVOKABLE void compare(const QString &paramCode, const QList<int> &stationIds, int hours = kDefaultHours);
+
+    /**
+     * @brief Przerywa trwające porównanie; bieżąca macierz zostaje.
+     */
+    Q_INVOKABLE void cancel();
+
+    /**
+     * @brief Pobiera wartość komórki bieżącej macierzy.
+     * @param row Wiersz.
+     * @param hour Godzina od początku siatki.
+     * @return Wartość lub NaN.
+     */
+    Q_INVOKABLE double value(int row, int hour) const;
+
+    /**
+     * @brief Pobiera wiersz bieżącej macierzy.
+     * @param row Wiersz.
+     * @return Wartości kolejnych godzin (NaN bez pomiaru) lub pusta lista.
+     */
+    Q_INVOKABLE QVariantList rowValues(int row) const;
+
+    /**
+     * @brief Buduje macierz synchronicznie; wiersze i godziny liczone są równolegle.
+     * @param paramCode Kod parametru.
+     * @param inputs Szeregi stacji (kolejność wierszy).
+     * @param gridStart Początek pierwszej godziny siatki.
+     * @param hours Liczba godzin siatki.
+     * @return Macierz z podsumowaniem, rankingiem i średnią godzinową.
+     */
+    static QSharedPointer<ComparisonMatrix> build(const QString &paramCode, const QList<ComparisonInput> &inputs,
+                                                  qint64 gridStart, int hours);
+
+signals:
+    /**
+     * @brief Sygnał emitowany po rozpoczęciu lub zakończeniu porównania.
+     */
+    void busyChanged();
+
+    /**
+     * @brief Sygnał emitowany po zmianie bieżącej macierzy.
+     */
+    void resultChanged();
+
+private slots:
+    /**
+     * @brief Wybiera sensor parametru i dodaje do kolejki jego pomiary.
+     * @param stationId Identyfikator stacji.
+     * @param sensors Sensory stacji.
+     */
+    void onSensorsReady(int stationId, const QList<SensorInfo> &sensors);
+
+    /**
+     * @brief Dopisuje pobrane pomiary do historii.
+     * @param stationId Identyfikator stacji.
+     * @param sensorId Identyfikator sensora.
+     * @param series Pomiary sensora.
+     */
+    void onSensorDataReady(int stationId, int sensorId, const SensorSeries &series);
+
+    /**
+     * @brief Wczytuje szeregi z historii i buduje macierz w osobnym wątku.
+     */
+    void startBuild();
+
+private:
+    /**
+     * @brief Ustawia stan zajętości.
+     * @param busy Nowy stan.
+     */
+    void setBusy(bool busy);
+
+    HistoryStore *m_history;                          ///< Historia pomiarów sensorów.
+    StationListModel *m_stations;                     ///< Katalog stacji.
+    StationFetchQueue *m_fetch;                       ///< Kolejka żądań porównania.
+    QThreadPool m_pool;                               ///< Wątek budowy macierzy.
+    std::atomic<quint64> m_generation{0};             ///< Numer bieżącego porównania.
+    bool m_busy = false;                              ///< Czy trwa porównanie.
+    QString m_paramCode;                              ///< Parametr trwającego porównania.
+    QList<int> m_stationIds;                          ///< Stacje trwającego porównania.
+    int m_hours = kDefaultHours;                      ///< Długość siatki trwającego porównania.
+    qint64 m_gridEnd = 0;                             ///< Ostatnia godzina siatki trwającego porównania.
+    QHash<int, int> m_sensorByStation;                ///< Sensor parametru według stacji.
+    QHash<int, SensorSeries> m_fetched;               ///< Pomiary pobrane w trwającym porównaniu według sensora.
+    QSharedPointer<const ComparisonMatrix> m_matrix;  ///< Bieżąca macierz.
+};
+
+#endif // STATIONCOMPARISON_H
@@ -0,0 +1,294 @@
+/**
+ * @file stationfetchqueue.cpp
+ * @brief Implementacja klasy StationFetchQueue.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera kolejkę żądań list sensorów i pomiarów, obsługę odpowiedzi 304
+ * oraz przyjmowanie wyników parsowania według numeru żądania.
+ */
+
+#include "stationfetchqueue.h"
+#include <QDebug>
+#include <QUrl>
+#include <algorithm>
+#include <memory>
+
+/**
+ * @brief Konstruktor obiektu StationFetchQueue.
+ * @param apiClient Klient HTTP.
+ * @param parser Parser odpowiedzi (może być współdzielony z innymi kolejkami).
+ * @param options Priorytet i grupa żądań kolejki.
+ * @param maxRunning Maksymalna liczba zadań w toku; 0 oznacza brak limitu.
+ * @param parent Rodzic QObject.
+ */
+StationFetchQueue::StationFetchQueue(ApiClient *apiClient, ReplyParser *parser, const RequestOptions &options,
+                                     int maxRunning, QObject *parent)
+    : QObject(parent),
+    m_apiClient(apiClient),
+    m_parser(parser),
+    m_options(options),
+    m_maxRunning(qMax(0, maxRunning)),
+    m_baseUrl(ApiClient::giosApiUrl())
+{
+    connect(m_parser, &ReplyParser::sensorsParsed, this, &StationFetchQueue::onSensorsParsed);
+    connect(m_parser, &ReplyParser::sensorDataParsed, this, &StationFetchQueue::onSensorDataParsed);
+}
+
+/**
+ * @brief Dodaje do kolejki pobranie listy sensorów stacji.
+ * @param stationId Identyfikator stacji.
+ */
+void StationFetchQueue::enqueueStation(int stationId)
+{
+    enqueue({ stationId, 0 });
+}
+
+/**
+ * @brief Dodaje do kolejki pobranie pomiarów sensora.
+ * @param stationId Identyfikator stacji sensora.
+ * @param sensorId Identyfikator sensora.
+ */
+void StationFetchQueue::enqueueSensor(int stationId, int sensorId)
+{
+    if (sensorId != 0)
+        enqueue({ stationId, sensorId });
+}
+
+/**
+ * @brief Usuwa z kolejki czekające zadania stacji.
+ * @param stationId Identyfikator stacji.
+ */
+void StationFetchQueue::removeStation(int stationId)
+{
+    const bool wasBusy = isBusy();
+    for (int i = m_tasks.size() - 1; i >= 0; --i) {
+        const Task &task = m_tasks.at(i);
+        if (task.stationId != stationId)
+            continue;
+        if (task.sensorId != 0)
+            m_queuedSensors.remove(task.sensorId);
+        else
+            m_queuedStations.remove(task.stationId);
+        m_tasks.removeAt(i);
+    }
+    if (wasBusy && !isBusy()) {
+        emit drained();
+        emit busyChanged();
+    }
+}
+
+/**
+ * @brief Unieważnia kolejkę i trwające żądania.
+ *
+ * Numery żądań są zapominane przed unieważnieniem grupy, więc odpowiedzi i wyniki
+ * parsowania, które nadejdą później, są pomijane. Sygnał drained() nie jest emitowany.
+ */
+void StationFetchQueue::cancelAll()
+{
+    const bool wasBusy = isBusy();
+    m_requests.clear();
+    m_tasks.clear();
+    m_queuedSensors.clear();
+    m_queuedStations.clear();
+    m_running = 0;
+    if (!m_options.group.isEmpty())
+        m_apiClient->scheduler()->cancelGroup(m_options.group);
+    if (wasBusy)
+        emit busyChanged();
+}
+
+/**
+ * @brief Dodaje zadanie do kolejki.
+ * @param task Zadanie.
+ */
+void StationFetchQueue::enqueue(const Task &task)
+{
+    if (task.sensorId != 0 ? m_queuedSensors.contains(task.sensorId) : m_queuedStations.contains(task.stationId))
+        return;
+
+    const bool wasBusy = isBusy();
+    if (task.sensorId != 0)
+        m_queuedSensors.insert(task.sensorId);
+    else
+        m_queuedStations.insert(task.stationId);
+    m_tasks.append(task);
+    if (!wasBusy)
+        emit busyChanged();
+    pump();
+}
+
+/**
+ * @brief Wysyła zadania z kolejki do wyczerpania limitu zadań w toku.
+ *
+ * Pomiary sensorów mają pierwszeństwo przed kolejnymi listami sensorów, więc wyniki
+ * kolejnych stacji pojawiają się w trakcie pracy kolejki, a nie dopiero na jej końcu.
+ */
+void StationFetchQueue::pump()
+{
+    while ((m_maxRunning == 0 || m_running < m_maxRunning) && !m_tasks.isEmpty()) {
+        const auto sensorTask = std::find_if(m_tasks.cbegin(), m_tasks.cend(), [](const Task &task) {
+            return task.sensorId != 0;
+        });
+        const Task task = sensorTask != m_tasks.cend() ? *sensorTask : m_tasks.constFirst();
+        m_tasks.removeAt(sensorTask != m_tasks.cend() ? int(sensorTask - m_tasks.cbegin()) : 0);
+
+        ++m_running;
+        const quint64 requestId = m_parser->nextRequestId();
+        m_requests.insert(requestId, task);
+        if (task.sensorId != 0)
+            requestSensorData(requestId, task.sensorId);
+        else
+            requestSensors(requestId, task.stationId);
+    }
+}
+
+/**
+ * @brief Wysyła żądanie listy sensorów stacji.
+ * @param requestId Numer żądania.
+ * @param stationId Identyfikator stacji.
+ */
+void StationFetchQueue::requestSensors(quint64 requestId, int stationId)
+{
+    const QUrl url(m_baseUrl + QString("/station/sensors/%1").arg(stationId));
+    const auto body = std::make_shared<QByteArray>();
+    m_apiClient->getLatest(url, this,
+        [body](const QByteArray &chunk) {
+            body->append(chunk);
+        },
+        [this, url, body, requestId](const ApiResponse &response) {
+            if (!m_requests.contains(requestId))
+                return; // Żądanie unieważnione w cancelAll()
+            if (response.notModified)
+                *body = m_apiClient->cache().load(url).body; // Lista bez zmian, ważność wpisu przedłużona
+            if (!response.ok() || body->isEmpty()) {
+                fail(requestId, response.ok() ? QString("pusta odpowiedź") : response.error);
+                return;
+            }
+            m_parser->parseSensors(*body, requestId);
+        }, m_options);
+}
+
+/**
+ * @brief Wysyła żądanie pomiarów sensora.
+ * @param requestId Numer żądania.
+ * @param sensorId Identyfikator sensora.
+ *
+ * Pomiary są odczytywane fragmentami w miarę pobierania. Po odpowiedzi 304 parsowana jest
+ * treść z pamięci podręcznej (odbiorca mógł jej jeszcze nie widzieć, np. po starcie), chyba
+ * że ustawiono setSkipUnchangedData().
+ */
+void StationFetchQueue::requestSensorData(quint64 requestId, int sensorId)
+{
+    const QUrl url(m_baseUrl + QString("/data/getData/%1").arg(sensorId));
+    const auto streamId = std::make_shared<quint64>(0);
+    m_apiClient->getLatest(url, this,
+        [this, streamId, sensorId, requestId](const QByteArray &chunk) {
+            if (*streamId == 0)
+                *streamId = m_parser->beginSensorData(sensorId, requestId);
+            m_parser->feed(*streamId, chunk);
+        },
+        [this, url, streamId, sensorId, requestId](const ApiResponse &response) {
+            const bool unchanged = response.ok() && response.notModified;
+            if (unchanged && !m_skipUnchangedData && *streamId == 0 && m_requests.contains(requestId)) {
+                const QByteArray body = m_apiClient->cache().load(url).body;
+                if (!body.isEmpty()) {
+                    *streamId = m_parser->beginSensorData(sensorId, requestId);
+                    m_parser->feed(*streamId, body);
+                }
+            }
+            if (!m_requests.contains(requestId) || !response.ok() || *streamId == 0) {
+                if (*streamId != 0)
+                    m_parser->abort(*streamId);
+                fail(requestId, !response.ok() ? response.error
+                                : unchanged && m_skipUnchangedData ? QString() : QString("pusta odpowiedź"));
+                return;
+            }
+            m_parser->finish(*streamId, response.fromCache);
+        }, m_options);
+}
+
+/**
+ * @brief Przekazuje listę sensorów trwającego żądania.
+ * @param result Lista sensorów.
+ */
+void StationFetchQueue::onSensorsParsed(SensorListResult result)
+{
+    Task task;
+    if (!take(result.requestId, task))
+        return;
+    emit sensorsReady(task.stationId, result.sensors);
+    taskDone();
+}
+
+/**
+ * @brief Przekazuje pomiary trwającego żądania.
+ * @param result Pomiary sensora.
+ *
+ * Szereg z niepełnej lub niepoprawnej treści nie jest przekazywany; zadanie kończy się błędem.
+ */
+void StationFetchQueue::onSensorDataParsed(SensorDataResult result)
+{
+    if (!result.complete) {
+        fail(result.requestId, QString("niepełna lub niepoprawna treść"));
+        return;
+    }
+    Task task;
+    if (!take(result.requestId, task))
+        return;
+    emit sensorDataReady(task.stationId, task.sensorId, result.series);
+    taskDone();
+}
+
+/**
+ * @brief Kończy trwające żądanie niepowodzeniem.
+ * @param requestId Numer żądania.
+ * @param error Opis błędu; pusty oznacza zakończenie bez wyniku i bez błędu.
+ */
+void StationFetchQueue::fail(quint64 requestId, const QString &error)
+{
+    Task task;
+    if (!take(requestId, task))
+        return;
+    if (!error.isEmpty()) {
+        if (task.sensorId != 0)
+            qWarning() << "Kolejka" << m_options.group << ": nie można pobrać pomiarów sensora" << task.sensorId << ":" << error;
+        else
+            qWarning() << "Kolejka" << m_options.group << ": nie można pobrać sensorów stacji" << task.stationId << ":" << error;
+        emit failed(task.stationId, task.sensorId, error);
+    }
+    taskDone();
+}
+
+/**
+ * @brief Zapomina trwające żądanie i zwalnia jego stację lub sensor.
+ * @param requestId Numer żądania.
+ * @param task Zadanie żądania.
+ * @return True, jeśli żądanie jeszcze trwało.
+ */
+bool StationFetchQueue::take(quint64 requestId, Task &task)
+{
+    const auto it = m_requests.constFind(requestId);
+    if (it == m_requests.constEnd())
+        return false;
+    task = it.value();
+    m_requests.erase(it);
+    if (task.sensorId != 0)
+        m_queuedSensors.remove(task.sensorId);
+    else
+        m_queuedStations.remove(task.stationId);
+    return true;
+}
+
+/**
+ * @brief Kończy zadanie i wysyła kolejne; po ostatnim zgłasza koniec pracy.
+ */
+void StationFetchQueue::taskDone()
+{
+    m_running = qMax(0, m_running - 1);
+    pump();
+    if (!isBusy()) {
+        emit drained();
+        emit busyChanged();
+    }
+}
@@ -0,0 +1,210 @@
+/**
+ * @file stationfetchqueue.h
+ * @brief Plik nagłówkowy dla klasy StationFetchQueue.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje kolejkę pobierania list sensorów stacji i pomiarów sensorów
+ * wspólną dla zadań działających w tle.
+ */
+
+#ifndef STATIONFETCHQUEUE_H
+#define STATIONFETCHQUEUE_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include "apiclient.h"
+#include "replyparser.h"
+#include "sensorseries.h"
+
+/**
+ * @class StationFetchQueue
+ * @brief Kolejka żądań list sensorów i pomiarów z limitem równoległości.
+ *
+ * Zadania czekają w kolejce i są wysyłane do wyczerpania limitu zadań w toku (żądanie
+ * i parsowanie); pomiary sensorów mają pierwszeństwo przed kolejnymi listami sensorów,
+ * więc kolejka nie rośnie do wszystkich sensorów wszystkich stacji naraz. Ta sama stacja
+ * i ten sam sensor nie trafiają do kolejki drugi raz, dopóki ich zadanie trwa.
+ *
+ * Każde żądanie dostaje numer z ReplyParser::nextRequestId(), więc kilka kolejek może
+ * korzystać z jednego parsera. Wynik jest przyjmowany tylko wtedy, gdy jego numer należy
+ * do trwającego żądania tej kolejki; cancelAll() zapomina numery, więc odpowiedzi i wyniki
+ * parsowania, które nadejdą później, są pomijane. Odpowiedź 304 oznacza, że treść
+ * w pamięci podręcznej jest aktualna, i jest ona wtedy parsowana zamiast treści z sieci.
+ */
+class StationFetchQueue : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Konstruktor obiektu StationFetchQueue.
+     * @param apiClient Klient HTTP.
+     * @param parser Parser odpowiedzi (może być współdzielony z innymi kolejkami).
+     * @param options Priorytet i grupa żądań kolejki.
+     * @param maxRunning Maksymalna liczba zadań w toku; 0 oznacza brak limitu.
+     * @param parent Rodzic QObject.
+     */
+    StationFetchQueue(ApiClient *apiClient, ReplyParser *parser, const RequestOptions &options,
+                      int maxRunning, QObject *parent = nullptr);
+
+    /**
+     * @brief Ustawia adres bazowy API.
+     * @param url Adres bazowy (domyślnie ApiClient::giosApiUrl()).
+     */
+    void setBaseUrl(const QString &url) { m_baseUrl = url; }
+
+    /**
+     * @brief Ustawia pomijanie pomiarów bez zmian.
+     * @param skip True, aby odpowiedź 304 pomiarów kończyła zadanie bez parsowania.
+     */
+    void setSkipUnchangedData(bool skip) { m_skipUnchangedData = skip; }
+
+    /**
+     * @brief Sprawdza, czy kolejka ma zadania.
+     * @return True, jeśli są zadania w kolejce lub w toku.
+     */
+    bool isBusy() const { return !m_tasks.isEmpty() || m_running > 0; }
+
+    /**
+     * @brief Dodaje do kolejki pobranie listy sensorów stacji.
+     * @param stationId Identyfikator stacji.
+     */
+    void enqueueStation(int stationId);
+
+    /**
+     * @brief Dodaje do kolejki pobranie pomiarów sensora.
+     * @param stationId Identyfikator stacji sensora.
+     * @param sensorId Identyfikator sensora.
+     */
+    void enqueueSensor(int stationId, int sensorId);
+
+    /**
+     * @brief Usuwa z kolejki czekające zadania stacji; trwające kończą się normalnie.
+     * @param stationId Identyfikator stacji.
+     */
+    void removeStation(int stationId);
+
+    /**
+     * @brief Unieważnia kolejkę i trwające żądania.
+     */
+    void cancelAll();
+
+signals:
+    /**
+     * @brief Sygnał emitowany po odczytaniu listy sensorów stacji.
+     * @param stationId Identyfikator stacji.
+     * @param sensors Sensory stacji.
+     */
+    void sensorsReady(int stationId, const QList<SensorInfo> &sensors);
+
+    /**
+     * @brief Sygnał emitowany po odczytaniu pełnych pomiarów sensora.
+     * @param stationId Identyfikator stacji.
+     * @param sensorId Identyfikator sensora.
+     * @param series Pomiary uporządkowane rosnąco według czasu.
+     */
+    void sensorDataReady(int stationId, int sensorId, const SensorSeries &series);
+
+    /**
+     * @brief Sygnał emitowany, gdy zadania nie udało się wykonać.
+     * @param stationId Identyfikator stacji.
+     * @param sensorId Identyfikator sensora; 0 dla listy sensorów.
+     * @param error Opis błędu.
+     */
+    void failed(int stationId, int sensorId, const QString &error);
+
+    /**
+     * @brief Sygnał emitowany po zakończeniu ostatniego zadania (nie po cancelAll()).
+     */
+    void drained();
+
+    /**
+     * @brief Sygnał emitowany po dodaniu pierwszego zadania, po zakończeniu ostatniego i po cancelAll().
+     */
+    void busyChanged();
+
+private slots:
+    /**
+     * @brief Przekazuje listę sensorów trwającego żądania.
+     * @param result Lista sensorów.
+     */
+    void onSensorsParsed(SensorListResult result);
+
+    /**
+     * @brief Przekazuje pomiary trwającego żądania.
+     * @param result Pomiary sensora.
+     */
+    void onSensorDataParsed(SensorDataResult result);
+
+private:
+    /**
+     * @struct Task
+     * @brief Zadanie kolejki.
+     */
+    struct Task {
+        int stationId = 0;  ///< Identyfikator stacji.
+        int sensorId = 0;   ///< Identyfikator sensora; 0 oznacza pobranie listy sensorów.
+    };
+
+    /**
+     * @brief Dodaje zadanie do kolejki.
+     * @param task Zadanie.
+     */
+    void enqueue(const Task &task);
+
+    /**
+     * @brief Wysyła zadania z kolejki do wyczerpania limitu zadań w toku.
+     */
+    void pump();
+
+    /**
+     * @brief Wysyła żądanie listy sensorów stacji.
+     * @param requestId Numer żądania.
+     * @param stationId Identyfikator stacji.
+     */
+    void requestSensors(quint64 requestId, int stationId);
+
+    /**
+     * @brief Wysyła żądanie pomiarów sensora.
+     * @param requestId Numer żądania.
+     * @param sensorId Identyfikator sensora.
+     */
+    void requestSensorData(quint64 requestId, int sensorId);
+
+    /**
+     * @brief Kończy trwające żądanie niepowodzeniem.
+     * @param requestId Numer żądania.
+     * @param error Opis błędu; pusty oznacza zakończenie bez wyniku i bez błędu.
+     */
+    void fail(quint64 requestId, const QString &error);
+
+    /**
+     * @brief Zapomina trwające żądanie i zwalnia jego stację lub sensor.
+     * @param requestId Numer żądania.
+     * @param task Zadanie żądania.
+     * @return True, jeśli żądanie jeszcze trwało.
+     */
+    bool take(quint64 requestId, Task &task);
+
+    /**
+     * @brief Kończy zadanie i wysyła kolejne; po ostatnim zgłasza koniec pracy.
+     */
+    void taskDone();
+
+    ApiClient *m_apiClient;                   ///< Klient HTTP.
+    ReplyParser *m_parser;                    ///< Parser odpowiedzi.
+    RequestOptions m_options;                 ///< Priorytet i grupa żądań.
+    int m_maxRunning;                         ///< Limit zadań w toku (0 bez limitu).
+    QString m_baseUrl;                        ///< Adres bazowy API.
+    bool m_skipUnchangedData = false;         ///< Czy 304 pomiarów kończy zadanie bez parsowania.
+    QList<Task> m_tasks;                      ///< Zadania czekające na wysłanie.
+    QSet<int> m_queuedStations;               ///< Stacje z listą sensorów w kolejce lub w toku.
+    QSet<int> m_queuedSensors;                ///< Sensory w kolejce lub w toku.
+    int m_running = 0;                        ///< Zadania w toku (żądanie lub parsowanie).
+    QHash<quint64, Task> m_requests;          ///< Zadanie według numeru trwającego żądania.
+};
+
+#endif // STATIONFETCHQUEUE_H
@@ -0,0 +1,375 @@
+/**
+ * @file stationlistmodel.cpp
+ * @brief Implementacja klasy StationListModel.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera implementację zwartego katalogu stacji z pulą internowanych
+ * napisów, bitowym statusem wyszukiwania i precyzyjnymi sygnałami zmian dla widoków QML.
+ */
+
+#include "stationlistmodel.h"
+
+/**
+ * @brief Konstruktor obiektu StationListModel.
+ * @param parent Rodzic QObject.
+ */
+StationListModel::StationListModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+/**
+ * @brief Zwraca liczbę wierszy modelu.
+ * @param parent Indeks rodzica.
+ * @return Liczba stacji lub 0 dla poprawnego rodzica.
+ */
+int StationListModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return m_entries.size();
+}
+
+/**
+ * @brief Zwraca dane dla wskazanego wiersza i roli.
+ * @param index Indeks wiersza.
+ * @param role Rola danych.
+ * @return Wartość roli lub pusty QVariant.
+ */
+QVariant StationListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_entries.size())
+        return QVariant();
+
+    const int row = index.row();
+    switch (role) {
+    case StationIdRole:
+        return stationId(row);
+    case StationNameRole:
+    case Qt::DisplayRole:
+        return stationName(row);
+    case CityNameRole:
+        return cityName(row);
+    case AddressRole:
+        return address(row);
+    case LatRole:
+        return lat(row);
+    case LonRole:
+        return lon(row);
+    case IsSearchedRole:
+        return isSearched(row);
+    default:
+        return QVariant();
+    }
+}
+
+/**
+ * @brief Zwraca nazwy ról widoczne w QML.
+ * @return Mapa ról na nazwy.
+ */
+QHash<int, QByteArray> StationListModel::roleNames() const
+{
+    return {
+        { StationIdRole, "stationId" },
+        { StationNameRole, "stationName" },
+        { CityNameRole, "cityName" },
+        { AddressRole, "address" },
+        { LatRole, "lat" },
+        { LonRole, "lon" },
+        { IsSearchedRole, "isSearched" }
+    };
+}
+
+/**
+ * @brief Odtwarza rekord katalogu dla wiersza.
+ * @param row Numer wiersza.
+ * @return Rekord stacji; napisy współdzielą dane z pulą.
+ */
+StationRecord StationListModel::record(int row) const
+{
+    StationRecord result;
+    result.stationId = stationId(row);
+    result.stationName = stationName(row);
+    result.cityName = cityName(row);
+    result.address = address(row);
+    result.lat = lat(row);
+    result.lon = lon(row);
+    return result;
+}
+
+/**
+ * @brief Zastępuje całą zawartość modelu.
+ * @param records Nowa lista stacji.
+ */
+void StationListModel::setRecords(const QList<StationRecord> &records)
+{
+    beginResetModel();
+    m_entries.clear();
+    clearStrings();
+    m_entries.reserve(records.size());
+    for (const StationRecord &record : records)
+        m_entries.append(makeEntry(record));
+    m_searched.fill(false, m_entries.size());
+    m_searchedCount = 0;
+    rebuildRowIndex();
+    endResetModel();
+    emit countChanged();
+}
+
+/**
+ * @brief Dodaje stację na końcu modelu.
+ * @param record Stacja do dodania.
+ * @return False, jeśli stacja o tym identyfikatorze jest już w modelu.
+ */
+bool StationListModel::appendRecord(const StationRecord &record)
+{
+    if (m_rowById.contains(record.stationId))
+        return false;
+
+    const int row = m_entries.size();
+    beginInsertRows(QModelIndex(), row, row);
+    m_entries.append(makeEntry(record));
+    m_searched.resize(row + 1);
+    m_rowById.insert(record.stationId, row);
+    endInsertRows();
+    emit countChanged();
+    return true;
+}
+
+/**
+ * @brief Usuwa stację z modelu.
+ * @param stationId Identyfikator stacji.
+ * @return True, jeśli stacja była w modelu.
+ */
+bool StationListModel::removeStation(int stationId)
+{
+    return removeStations({ stationId }) > 0;
+}
+
+/**
+ * @brief Usuwa wiele stacji z modelu w jednym przebiegu.
+ * @param stationIds Identyfikatory stacji; nieznane i powtórzone są pomijane.
+ * @return Liczba usuniętych stacji.
+ *
+ * Pozostałe wiersze i ich bity statusu są przesuwane w jednym przejściu od pierwszego
+ * usuwanego wiersza, a mapowanie identyfikatorów odbudowywane raz, więc koszt nie zależy
+ * od liczby usuwanych stacji. Ciągły zakres wierszy zgłaszany jest sygnałem rowsRemoved,
+ * rozproszone wiersze resetem modelu. Napisy używane tylko przez usunięte stacje są
+ * zwalniane z puli.
+ */
+int StationListModel::removeStations(const QList<int> &stationIds)
+{
+    QBitArray removed(m_entries.size());
+    int first = m_entries.size();
+    int last = -1;
+    int count = 0;
+    for (int stationId : stationIds) {
+        const int row = rowOf(stationId);
+        if (row < 0 || removed.testBit(row))
+            continue;
+        removed.setBit(row);
+        first = qMin(first, row);
+        last = qMax(last, row);
+        ++count;
+    }
+    if (count == 0)
+        return 0;
+
+    const bool contiguous = last - first + 1 == count;
+    if (contiguous)
+        beginRemoveRows(QModelIndex(), first, last);
+    else
+        beginResetModel();
+
+    int kept = first;
+    for (int row = first; row < m_entries.size(); ++row) {
+        if (removed.testBit(row)) {
+            if (m_searched.testBit(row))
+                --m_searchedCount;
+            releaseEntry(m_entries.at(row));
+            continue;
+        }
+        m_entries[kept] = m_entries.at(row);
+        m_searched.setBit(kept, m_searched.testBit(row));
+        ++kept;
+    }
+    m_entries.resize(kept);
+    m_searched.resize(kept);
+    rebuildRowIndex();
+
+    if (contiguous)
+        endRemoveRows();
+    else
+        endResetModel();
+    emit countChanged();
+    return count;
+}
+
+/**
+ * @brief Zastępuje dane stacji o tym samym identyfikatorze.
+ * @param record Nowe dane stacji.
+ * @return True, jeśli stacja była w modelu.
+ *
+ * Nowe napisy są internowane przed zwolnieniem dotychczasowych, więc napisy wspólne
+ * dla obu wersji wiersza zostają w puli na swoim miejscu.
+ */
+bool StationListModel::replaceRecord(const StationRecord &record)
+{
+    const int row = rowOf(record.stationId);
+    if (row < 0)
+        return false;
+
+    const Entry previous = m_entries.at(row);
+    m_entries[row] = makeEntry(record);
+    releaseEntry(previous);
+    const QModelIndex changed = index(row);
+    emit dataChanged(changed, changed);
+    return true;
+}
+
+/**
+ * @brief Usuwa wszystkie stacje z modelu.
+ */
+void StationListModel::clear()
+{
+    if (m_entries.isEmpty())
+        return;
+
+    beginRemoveRows(QModelIndex(), 0, m_entries.size() - 1);
+    m_entries.clear();
+    clearStrings();
+    m_searched.clear();
+    m_searchedCount = 0;
+    m_rowById.clear();
+    endRemoveRows();
+    emit countChanged();
+}
+
+/**
+ * @brief Ustawia status wyszukiwania stacji.
+ * @param stationId Identyfikator stacji.
+ * @param searched Nowy status wyszukiwania.
+ * @return True, jeśli status się zmienił.
+ */
+bool StationListModel::setSearched(int stationId, bool searched)
+{
+    const int row = rowOf(stationId);
+    if (row < 0 || m_searched.testBit(row) == searched)
+        return false;
+
+    m_searched.setBit(row, searched);
+    m_searchedCount += searched ? 1 : -1;
+    const QModelIndex changed = index(row);
+    emit dataChanged(changed, changed, { IsSearchedRole });
+    return true;
+}
+
+/**
+ * @brief Resetuje status wyszukiwania wszystkich stacji.
+ *
+ * Przeglądanie kończy się po wyzerowaniu ostatniego ustawionego bitu.
+ */
+void StationListModel::clearSearched()
+{
+    for (int row = 0; row < m_entries.size() && m_searchedCount > 0; ++row) {
+        if (m_searched.testBit(row)) {
+            m_searched.clearBit(row);
+            --m_searchedCount;
+            const QModelIndex changed = index(row);
+            emit dataChanged(changed, changed, { IsSearchedRole });
+        }
+    }
+}
+
+/**
+ * @brief Buduje wiersz katalogu z rekordu.
+ * @param record Rekord stacji.
+ * @return Wiersz z napisami dodanymi do puli.
+ */
+StationListModel::Entry StationListModel::makeEntry(const StationRecord &record)
+{
+    Entry entry;
+    entry.stationId = record.stationId;
+    entry.name = intern(record.stationName);
+    entry.city = intern(record.cityName);
+    entry.address = intern(record.address);
+    entry.lat = record.lat;
+    entry.lon = record.lon;
+    return entry;
+}
+
+/**
+ * @brief Zwraca indeks napisu w puli, dodając go w razie potrzeby.
+ * @param text Napis.
+ * @return Indeks napisu.
+ */
+quint32 StationListModel::intern(const QString &text)
+{
+    auto it = m_stringIds.constFind(text);
+    if (it != m_stringIds.constEnd()) {
+        ++m_stringRefs[it.value()];
+        return it.value();
+    }
+
+    quint32 id;
+    if (!m_freeStrings.isEmpty()) {
+        id = m_freeStrings.takeLast();
+        m_strings[id] = text;
+        m_stringRefs[id] = 1;
+    } else {
+        id = quint32(m_strings.size());
+        m_strings.append(text);
+        m_stringRefs.append(1);
+    }
+    m_stringIds.insert(text, id);
+    return id;
+}
+
+/**
+ * @brief Zwalnia odwołanie do napisu w puli; nieużywany napis jest usuwany.
+ * @param id Indeks napisu.
+ *
+ * Miejsce napisu trafia na listę wolnych miejsc, więc indeksy pozostałych napisów się nie zmieniają.
+ */
+void StationListModel::release(quint32 id)
+{
+    if (--m_stringRefs[id] > 0)
+        return;
+    m_stringIds.remove(m_strings.at(id));
+    m_strings[id] = QString();
+    m_freeStrings.append(id);
+}
+
+/**
+ * @brief Zwalnia odwołania wiersza do napisów w puli.
+ * @param entry Wiersz katalogu.
+ */
+void StationListModel::releaseEntry(const Entry &entry)
+{
+    release(entry.name);
+    release(entry.city);
+    release(entry.address);
+}
+
+/**
+ * @brief Czyści pulę napisów.
+ */
+void StationListModel::clearStrings()
+{
+    m_strings.clear();
+    m_stringIds.clear();
+    m_stringRefs.clear();
+    m_freeStrings.clear();
+}
+
+/**
+ * @brief Odbudowuje mapowanie identyfikatorów stacji na wiersze.
+ */
+void StationListModel::rebuildRowIndex()
+{
+    m_rowById.clear();
+    m_rowById.reserve(m_entries.size());
+    for (int row = 0; row < m_entries.size(); ++row)
+        m_rowById.insert(m_entries.at(row).stationId, row);
+}
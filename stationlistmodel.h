@@ -0,0 +1,290 @@
+/**
+ * @file stationlistmodel.h
+ * @brief Plik nagłówkowy dla klasy StationListModel.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje model katalogu stacji udostępniany widokom QML (mapa) oraz
+ * widokom indeksowym (lista wyników wyszukiwania).
+ */
+
+#ifndef STATIONLISTMODEL_H
+#define STATIONLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QBitArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+#include "stationsnapshot.h"
+
+/**
+ * @class StationListModel
+ * @brief Zwarty katalog stacji z rolami dla widoków QML.
+ *
+ * Stacje przechowywane są jako wartości w jednym wektorze; nazwy, miasta i adresy
+ * są internowane w puli napisów, więc powtarzające się miasta i ulice zajmują pamięć raz.
+ * Napisy pula liczy odwołaniami: napis, którego nie używa już żaden wiersz, jest zwalniany,
+ * a jego miejsce zajmuje kolejny nowy napis, więc odświeżanie katalogu nie powiększa puli.
+ * Status wyszukiwania to bit w tablicy bitowej indeksowanej wierszem. Zmiany statusu są
+ * zgłaszane sygnałem dataChanged tylko dla wierszy, które faktycznie się zmieniły,
+ * a nowe stacje sygnałem rowsInserted, dzięki czemu widoki nie odtwarzają wszystkich delegatów.
+ */
+class StationListModel : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    /**
+     * @brief Role danych udostępniane delegatom QML.
+     */
+    enum StationRoles {
+        StationIdRole = Qt::UserRole + 1, ///< Identyfikator stacji.
+        StationNameRole,                  ///< Nazwa stacji.
+        CityNameRole,                     ///< Nazwa miasta.
+        AddressRole,                      ///< Adres stacji.
+        LatRole,                          ///< Szerokość geograficzna.
+        LonRole,                          ///< Długość geograficzna.
+        IsSearchedRole                    ///< Status wyszukiwania.
+    };
+    Q_ENUM(StationRoles)
+
+    /**
+     * @brief Konstruktor obiektu StationListModel.
+     * @param parent Rodzic QObject.
+     */
+    explicit StationListModel(QObject *parent = nullptr);
+
+    /**
+     * @brief Zwraca liczbę wierszy modelu.
+     * @param parent Indeks rodzica (nieużywany w modelu listy).
+     * @return Liczba stacji.
+     */
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    /**
+     * @brief Zwraca dane dla wskazanego wiersza i roli.
+     * @param index Indeks wiersza.
+     * @param role Rola danych.
+     * @return Wartość roli lub pusty QVariant.
+     */
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief Zwraca nazwy ról widoczne w QML.
+     * @return Mapa ról na nazwy.
+     */
+    QHash<int, QByteArray> roleNames() const override;
+
+    /**
+     * @brief Pobiera liczbę stacji w modelu.
+     * @return Liczba stacji.
+     */
+    int count() const { return m_entries.size(); }
+
+    /**
+     * @brief Wyszukuje wiersz stacji po identyfikatorze.
+     * @param stationId Identyfikator stacji.
+     * @return Numer wiersza lub -1, jeśli stacji nie ma w katalogu.
+     */
+    int rowOf(int stationId) const { return m_rowById.value(stationId, -1); }
+
+    /**
+     * @brief Sprawdza, czy stacja jest w katalogu.
+     * @param stationId Identyfikator stacji.
+     * @return True, jeśli stacja jest w katalogu.
+     */
+    bool contains(int stationId) const { return m_rowById.contains(stationId); }
+
+    /**
+     * @brief Pobiera identyfikator stacji.
+     * @param row Numer wiersza.
+     * @return Identyfikator stacji.
+     */
+    int stationId(int row) const { return m_entries.at(row).stationId; }
+
+    /**
+     * @brief Pobiera nazwę stacji.
+     * @param row Numer wiersza.
+     * @return Nazwa stacji (napis z puli).
+     */
+    const QString &stationName(int row) const { return m_strings.at(m_entries.at(row).name); }
+
+    /**
+     * @brief Pobiera nazwę miasta.
+     * @param row Numer wiersza.
+     * @return Nazwa miasta (napis z puli).
+     */
+    const QString &cityName(int row) const { return m_strings.at(m_entries.at(row).city); }
+
+    /**
+     * @brief Pobiera adres stacji.
+     * @param row Numer wiersza.
+     * @return Adres stacji (napis z puli).
+     */
+    const QString &address(int row) const { return m_strings.at(m_entries.at(row).address); }
+
+    /**
+     * @brief Pobiera szerokość geograficzną.
+     * @param row Numer wiersza.
+     * @return Współrzędna szerokości geograficznej.
+     */
+    double lat(int row) const { return m_entries.at(row).lat; }
+
+    /**
+     * @brief Pobiera długość geograficzną.
+     * @param row Numer wiersza.
+     * @return Współrzędna długości geograficznej.
+     */
+    double lon(int row) const { return m_entries.at(row).lon; }
+
+    /**
+     * @brief Pobiera status wyszukiwania.
+     * @param row Numer wiersza.
+     * @return True, jeśli stacja jest oznaczona jako wyszukana.
+     */
+    bool isSearched(int row) const { return m_searched.testBit(row); }
+
+    /**
+     * @brief Odtwarza rekord katalogu dla wiersza.
+     * @param row Numer wiersza.
+     * @return Rekord stacji.
+     */
+    StationRecord record(int row) const;
+
+    /**
+     * @brief Pobiera liczbę napisów w puli.
+     * @return Liczba różnych nazw, miast i adresów używanych przez wiersze.
+     */
+    int internedStrings() const { return m_strings.size() - m_freeStrings.size(); }
+
+    /**
+     * @brief Pobiera liczbę stacji oznaczonych jako wyszukane.
+     * @return Liczba ustawionych bitów statusu.
+     */
+    int searchedCount() const { return m_searchedCount; }
+
+    /**
+     * @brief Zastępuje całą zawartość modelu.
+     * @param records Nowa lista stacji.
+     *
+     * Pula napisów budowana jest od nowa.
+     */
+    void setRecords(const QList<StationRecord> &records);
+
+    /**
+     * @brief Dodaje stację na końcu modelu.
+     * @param record Stacja do dodania.
+     * @return False, jeśli stacja o tym identyfikatorze jest już w modelu.
+     */
+    bool appendRecord(const StationRecord &record);
+
+    /**
+     * @brief Usuwa stację z modelu.
+     * @param stationId Identyfikator stacji.
+     * @return True, jeśli stacja była w modelu.
+     */
+    bool removeStation(int stationId);
+
+    /**
+     * @brief Usuwa wiele stacji z modelu w jednym przebiegu.
+     * @param stationIds Identyfikatory stacji; nieznane i powtórzone są pomijane.
+     * @return Liczba usuniętych stacji.
+     */
+    int removeStations(const QList<int> &stationIds);
+
+    /**
+     * @brief Zastępuje dane stacji o tym samym identyfikatorze.
+     * @param record Nowe dane stacji.
+     * @return True, jeśli stacja była w modelu; status wyszukiwania jest zachowywany.
+     */
+    bool replaceRecord(const StationRecord &record);
+
+    /**
+     * @brief Usuwa wszystkie stacje z modelu.
+     */
+    void clear();
+
+    /**
+     * @brief Ustawia status wyszukiwania stacji.
+     * @param stationId Identyfikator stacji.
+     * @param searched Nowy status wyszukiwania.
+     * @return True, jeśli status się zmienił.
+     */
+    bool setSearched(int stationId, bool searched);
+
+    /**
+     * @brief Resetuje status wyszukiwania wszystkich stacji.
+     *
+     * Emituje dataChanged wyłącznie dla wierszy, które były oznaczone jako wyszukane.
+     */
+    void clearSearched();
+
+signals:
+    /**
+     * @brief Sygnał emitowany, gdy zmieni się liczba stacji.
+     */
+    void countChanged();
+
+private:
+    /**
+     * @struct Entry
+     * @brief Wiersz katalogu: napisy jako indeksy w puli.
+     */
+    struct Entry {
+        int stationId = 0;   ///< Identyfikator stacji.
+        quint32 name = 0;    ///< Indeks nazwy stacji w puli.
+        quint32 city = 0;    ///< Indeks nazwy miasta w puli.
+        quint32 address = 0; ///< Indeks adresu w puli.
+        double lat = 0.0;    ///< Szerokość geograficzna.
+        double lon = 0.0;    ///< Długość geograficzna.
+    };
+
+    /**
+     * @brief Buduje wiersz katalogu z rekordu.
+     * @param record Rekord stacji.
+     * @return Wiersz z napisami dodanymi do puli.
+     */
+    Entry makeEntry(const StationRecord &record);
+
+    /**
+     * @brief Zwraca indeks napisu w puli, dodając go w razie potrzeby.
+     * @param text Napis.
+     * @return Indeks napisu.
+     */
+    quint32 intern(const QString &text);
+
+    /**
+     * @brief Zwalnia odwołanie do napisu w puli; nieużywany napis jest usuwany.
+     * @param id Indeks napisu.
+     */
+    void release(quint32 id);
+
+    /**
+     * @brief Zwalnia odwołania wiersza do napisów w puli.
+     * @param entry Wiersz katalogu.
+     */
+    void releaseEntry(const Entry &entry);
+
+    /**
+     * @brief Czyści pulę napisów.
+     */
+    void clearStrings();
+
+    /**
+     * @brief Odbudowuje mapowanie identyfikatorów stacji na wiersze.
+     */
+    void rebuildRowIndex();
+
+    QVector<Entry> m_entries;            ///< Stacje w kolejności wierszy.
+    QVector<QString> m_strings;          ///< Pula internowanych napisów.
+    QHash<QString, quint32> m_stringIds; ///< Mapowanie napisu na indeks w puli.
+    QVector<int> m_stringRefs;           ///< Liczba odwołań wierszy do napisu w puli.
+    QVector<quint32> m_freeStrings;      ///< Zwolnione miejsca w puli do ponownego użycia.
+    QBitArray m_searched;                ///< Status wyszukiwania, bit na wiersz.
+    int m_searchedCount = 0;             ///< Liczba ustawionych bitów statusu.
+    QHash<int, int> m_rowById;           ///< Mapowanie identyfikatora stacji na wiersz.
+};
+
+#endif // STATIONLISTMODEL_H
@@ -0,0 +1,324 @@
+/**
+ * @file stationmonitor.cpp
+ * @brief Implementacja klasy StationMonitor.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera cogodzinny cykl odświeżania obserwowanych stacji: kolejkę żądań
+ * z limitem równoległości, wybór nieaktualnych sensorów i dopisywanie różnic.
+ */
+
+#include "stationmonitor.h"
+#include "metricsregistry.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTimeZone>
+#include <algorithm>
+#include <utility>
+
+namespace {
+/// Grupa żądań monitora; unieważniana po wyłączeniu monitorowania.
+const QString kMonitorRequests = QStringLiteral("monitor");
+
+/// Maksymalna liczba zadań monitora w toku; reszta limitu hosta zostaje dla użytkownika.
+constexpr int kMaxRunningTasks = 2;
+}
+
+/**
+ * @brief Konstruktor obiektu StationMonitor.
+ * @param apiClient Klient HTTP.
+ * @param parser Parser odpowiedzi (wspólny dla zadań w tle).
+ * @param history Historia pomiarów.
+ * @param store Magazyn szeregów otwartej stacji.
+ * @param watchListPath Ścieżka pliku listy obserwowanych stacji; pusta oznacza domyślną.
+ * @param parent Rodzic QObject.
+ *
+ * Wczytuje listę obserwowanych stacji; jeśli monitorowanie było włączone przy poprzednim
+ * uruchomieniu, pierwszy cykl rusza w kolejnej iteracji pętli zdarzeń.
+ */
+StationMonitor::StationMonitor(ApiClient *apiClient, ReplyParser *parser, HistoryStore *history, SensorSeriesStore *store,
+                               const QString &watchListPath, QObject *parent)
+    : QObject(parent),
+    m_history(history),
+    m_store(store),
+    m_fetch(new StationFetchQueue(apiClient, parser, RequestOptions{ RequestPriority::Background, kMonitorRequests },
+                                  kMaxRunningTasks, this)),
+    m_watchListPath(!watchListPath.isEmpty()
+                        ? watchListPath
+                        : QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/watchlist.json")
+{
+    m_wakeTimer.setSingleShot(true);
+    m_wakeTimer.setTimerType(Qt::VeryCoarseTimer);
+    connect(&m_wakeTimer, &QTimer::timeout, this, [this]() {
+        scheduleNext();
+        startCycle();
+    });
+
+    // Odpowiedź 304 oznacza, że od poprzedniego pobrania nic się nie zmieniło
+    m_fetch->setSkipUnchangedData(true);
+    connect(m_fetch, &StationFetchQueue::sensorsReady, this, &StationMonitor::onSensorsReady);
+    connect(m_fetch, &StationFetchQueue::sensorDataReady, this, &StationMonitor::onSensorDataReady);
+    connect(m_fetch, &StationFetchQueue::drained, this, &StationMonitor::finishCycle);
+    connect(m_fetch, &StationFetchQueue::busyChanged, this, &StationMonitor::busyChanged);
+
+    loadWatchList();
+    if (m_enabled) {
+        scheduleNext();
+        QTimer::singleShot(0, this, &StationMonitor::startCycle);
+    }
+}
+
+/**
+ * @brief Włącza lub wyłącza monitorowanie.
+ * @param enabled True, aby włączyć monitorowanie.
+ */
+void StationMonitor::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled)
+        return;
+    m_enabled = enabled;
+    saveWatchList();
+
+    if (m_enabled) {
+        scheduleNext();
+        startCycle();
+    } else {
+        m_wakeTimer.stop();
+        cancelAll();
+    }
+    emit enabledChanged();
+}
+
+/**
+ * @brief Pobiera obserwowane stacje.
+ * @return Identyfikatory stacji posortowane rosnąco.
+ */
+QList<int> StationMonitor::watchedStations() const
+{
+    QList<int> stationIds = m_watched.values();
+    std::sort(stationIds.begin(), stationIds.end());
+    return stationIds;
+}
+
+/**
+ * @brief Dodaje stację do obserwowanych.
+ * @param stationId Identyfikator stacji.
+ */
+void StationMonitor::watch(int stationId)
+{
+    if (stationId <= 0 || m_watched.contains(stationId))
+        return;
+    m_watched.insert(stationId);
+    saveWatchList();
+    emit watchListChanged();
+
+    if (m_enabled) {
+        if (!isBusy())
+            m_cycleHour = currentMeasurementHour(QDateTime::currentDateTimeUtc());
+        m_fetch->enqueueStation(stationId);
+    }
+}
+
+/**
+ * @brief Usuwa stację z obserwowanych.
+ * @param stationId Identyfikator stacji.
+ *
+ * Zadania stacji czekające w kolejce są usuwane; trwające kończą się normalnie.
+ */
+void StationMonitor::unwatch(int stationId)
+{
+    if (!m_watched.remove(stationId))
+        return;
+    saveWatchList();
+    emit watchListChanged();
+    m_fetch->removeStation(stationId);
+}
+
+/**
+ * @brief Uruchamia cykl odświeżania bez czekania na pełną godzinę.
+ */
+void StationMonitor::refreshNow()
+{
+    startCycle();
+}
+
+/**
+ * @brief Ustawia opóźnienie wybudzenia względem pełnej godziny.
+ * @param minutes Liczba minut (0-59).
+ */
+void StationMonitor::setPublicationDelayMinutes(int minutes)
+{
+    m_delayMinutes = qBound(0, minutes, 59);
+    if (m_enabled)
+        scheduleNext();
+}
+
+/**
+ * @brief Wyznacza chwilę następnego wybudzenia.
+ * @param now Bieżący czas.
+ * @param delayMinutes Opóźnienie względem pełnej godziny w minutach.
+ * @return Najbliższa chwila HH:delayMinutes późniejsza niż now.
+ */
+QDateTime StationMonitor::nextWakeUp(const QDateTime &now, int delayMinutes)
+{
+    QDateTime wakeUp = now;
+    wakeUp.setTime(QTime(now.time().hour(), qBound(0, delayMinutes, 59)));
+    if (wakeUp <= now)
+        wakeUp = wakeUp.addSecs(3600);
+    return wakeUp;
+}
+
+/**
+ * @brief Wyznacza początek bieżącej godziny pomiarowej.
+ * @param now Bieżący czas.
+ * @return Pełna godzina czasu polskiego jako znacznik czasu ściennego.
+ *
+ * GIOŚ podaje daty pomiarów w czasie polskim; SensorSeries zapisuje je jako czas ścienny
+ * w UTC, więc godzinę porównywaną z historią trzeba wyznaczyć tak samo.
+ */
+qint64 StationMonitor::currentMeasurementHour(const QDateTime &now)
+{
+    const QTimeZone poland("Europe/Warsaw");
+    const QDateTime local = poland.isValid() ? now.toTimeZone(poland) : now.toLocalTime();
+    return QDateTime(local.date(), QTime(local.time().hour(), 0), QTimeZone::utc()).toSecsSinceEpoch();
+}
+
+/**
+ * @brief Rozpoczyna cykl odświeżania wszystkich obserwowanych stacji.
+ *
+ * Stacje, które są jeszcze w kolejce z poprzedniego cyklu, nie są dodawane ponownie.
+ */
+void StationMonitor::startCycle()
+{
+    if (m_watched.isEmpty())
+        return;
+
+    m_cycleHour = currentMeasurementHour(QDateTime::currentDateTimeUtc());
+    for (int stationId : watchedStations())
+        m_fetch->enqueueStation(stationId);
+}
+
+/**
+ * @brief Ustawia wybudzenie na najbliższą godzinę publikacji.
+ */
+void StationMonitor::scheduleNext()
+{
+    const QDateTime now = QDateTime::currentDateTime();
+    m_wakeTimer.start(int(qMax<qint64>(1000, now.msecsTo(nextWakeUp(now, m_delayMinutes)))));
+}
+
+/**
+ * @brief Wyznacza nieaktualne sensory stacji i dodaje je do kolejki.
+ * @param stationId Identyfikator stacji.
+ * @param sensors Sensory stacji.
+ */
+void StationMonitor::onSensorsReady(int stationId, const QList<SensorInfo> &sensors)
+{
+    if (!m_watched.contains(stationId))
+        return;
+    for (const SensorInfo &sensor : sensors) {
+        if (isStale(m_history->lastTimestamp(sensor.sensorId), m_cycleHour))
+            m_fetch->enqueueSensor(stationId, sensor.sensorId);
+    }
+}
+
+/**
+ * @brief Dopisuje pobrane pomiary do historii i otwartego szeregu.
+ * @param stationId Identyfikator stacji.
+ * @param sensorId Identyfikator sensora.
+ * @param series Pomiary sensora.
+ *
+ * HistoryStore::merge() zapisuje tylko pomiary nowe i poprawione; te same pomiary trafiają
+ * do szeregu w SensorSeriesStore, jeśli sensor jest akurat wyświetlany.
+ */
+void StationMonitor::onSensorDataReady(int stationId, int sensorId, const SensorSeries &series)
+{
+    ++m_fetchedSensors;
+    const HistoryMergeResult merged = m_history->merge(sensorId, series);
+    if (merged.appended + merged.corrected > 0) {
+        ++m_updatedSensors;
+        m_store->mergeSeries(sensorId, series);
+        emit sensorUpdated(stationId, sensorId, merged.appended, merged.corrected);
+    }
+}
+
+/**
+ * @brief Zamyka cykl po zakończeniu ostatniego zadania kolejki.
+ *
+ * Liczba cykli oraz pobranych i zmienionych sensorów trafia do MetricsRegistry.
+ */
+void StationMonitor::finishCycle()
+{
+    MetricsRegistry &metrics = MetricsRegistry::instance();
+    metrics.add("gios_monitor_cycles_total", m_updatedSensors > 0 ? "result=updated" : "result=unchanged");
+    metrics.add("gios_monitor_sensors_total", "result=fetched", m_fetchedSensors);
+    metrics.add("gios_monitor_sensors_total", "result=updated", m_updatedSensors);
+    emit cycleFinished(std::exchange(m_fetchedSensors, 0), std::exchange(m_updatedSensors, 0));
+}
+
+/**
+ * @brief Unieważnia kolejkę i trwające żądania monitora.
+ *
+ * Wyniki, które nadejdą później, są pomijane przez StationFetchQueue.
+ */
+void StationMonitor::cancelAll()
+{
+    m_fetch->cancelAll();
+    m_fetchedSensors = 0;
+    m_updatedSensors = 0;
+}
+
+/**
+ * @brief Wczytuje listę obserwowanych stacji i stan monitorowania.
+ */
+void StationMonitor::loadWatchList()
+{
+    QFile file(m_watchListPath);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError || !document.isObject()) {
+        qWarning() << "Niepoprawna lista obserwowanych stacji:" << m_watchListPath << error.errorString();
+        return;
+    }
+
+    const QJsonObject root = document.object();
+    const QJsonArray stations = root.value("stations").toArray();
+    for (const QJsonValue &station : stations) {
+        if (station.toInt() > 0)
+            m_watched.insert(station.toInt());
+    }
+    m_enabled = root.value("enabled").toBool();
+}
+
+/**
+ * @brief Zapisuje listę obserwowanych stacji i stan monitorowania.
+ * @return True, jeśli zapis się powiódł.
+ */
+bool StationMonitor::saveWatchList() const
+{
+    QDir().mkpath(QFileInfo(m_watchListPath).absolutePath());
+    QSaveFile file(m_watchListPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Nie można zapisać listy obserwowanych stacji:" << m_watchListPath;
+        return false;
+    }
+
+    QJsonArray stations;
+    for (int stationId : watchedStations())
+        stations.append(stationId);
+    QJsonObject root;
+    root["enabled"] = m_enabled;
+    root["stations"] = stations;
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
@@ -0,0 +1,248 @@
+/**
+ * @file stationmonitor.h
+ * @brief Plik nagłówkowy dla klasy StationMonitor.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje monitorowanie obserwowanych stacji w tle: cogodzinne pobieranie
+ * tylko nieaktualnych sensorów i dopisywanie nowych pomiarów do historii.
+ */
+
+#ifndef STATIONMONITOR_H
+#define STATIONMONITOR_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+#include "apiclient.h"
+#include "historystore.h"
+#include "replyparser.h"
+#include "sensorseries.h"
+#include "stationfetchqueue.h"
+
+/**
+ * @class StationMonitor
+ * @brief Cogodzinne odświeżanie pomiarów obserwowanych stacji.
+ *
+ * GIOŚ publikuje pomiary raz na godzinę, więc monitor budzi się kilka minut po pełnej
+ * godzinie (publicationDelayMinutes()). W każdym cyklu pobiera listy sensorów obserwowanych
+ * stacji (z pamięci podręcznej, ważnej dobę), a pomiary tylko tych sensorów, których
+ * najnowszy pomiar w HistoryStore jest starszy niż bieżąca godzina. Do historii i do
+ * otwartych szeregów w SensorSeriesStore trafiają wyłącznie nowe i poprawione pomiary,
+ * a sygnał sensorUpdated() jest emitowany tylko dla sensorów, które się zmieniły.
+ *
+ * Żądania przechodzą przez StationFetchQueue z priorytetem Background i grupą "monitor",
+ * a monitor utrzymuje najwyżej kilka własnych żądań naraz, więc cykl dla kilkuset stacji
+ * rozkłada się w czasie i nie zajmuje limitu hosta potrzebnego żądaniom użytkownika.
+ * Odpowiedzi są parsowane we wspólnym parserze zadań w tle, poza wątkiem GUI.
+ */
+class StationMonitor : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(QList<int> watchedStations READ watchedStations NOTIFY watchListChanged)
+    Q_PROPERTY(bool busy READ isBusy NOTIFY busyChanged)
+
+public:
+    /**
+     * @brief Konstruktor obiektu StationMonitor.
+     * @param apiClient Klient HTTP.
+     * @param parser Parser odpowiedzi (wspólny dla zadań w tle).
+     * @param history Historia pomiarów, do której dopisywane są nowe pomiary.
+     * @param store Magazyn szeregów otwartej stacji.
+     * @param watchListPath Ścieżka pliku listy obserwowanych stacji; pusta oznacza domyślną.
+     * @param parent Rodzic QObject.
+     */
+    StationMonitor(ApiClient *apiClient, ReplyParser *parser, HistoryStore *history, SensorSeriesStore *store,
+                   const QString &watchListPath = QString(), QObject *parent = nullptr);
+
+    /**
+     * @brief Sprawdza, czy monitorowanie jest włączone.
+     * @return True, jeśli monitor budzi się co godzinę.
+     */
+    bool isEnabled() const { return m_enabled; }
+
+    /**
+     * @brief Włącza lub wyłącza monitorowanie.
+     * @param enabled True, aby włączyć monitorowanie.
+     *
+     * Włączenie uruchamia od razu cykl nadrabiający zaległości; wyłączenie unieważnia
+     * trwające żądania monitora.
+     */
+    void setEnabled(bool enabled);
+
+    /**
+     * @brief Pobiera obserwowane stacje.
+     * @return Identyfikatory stacji posortowane rosnąco.
+     */
+    QList<int> watchedStations() const;
+
+    /**
+     * @brief Sprawdza, czy trwa cykl odświeżania.
+     * @return True, jeśli monitor ma żądania w kolejce lub w toku.
+     */
+    bool isBusy() const { return m_fetch->isBusy(); }
+
+    /**
+     * @brief Dodaje stację do obserwowanych.
+     * @param stationId Identyfikator stacji.
+     *
+     * Przy włączonym monitorowaniu stacja jest odświeżana od razu.
+     */
+    Q_INVOKABLE void watch(int stationId);
+
+    /**
+     * @brief Usuwa stację z obserwowanych.
+     * @param stationId Identyfikator stacji.
+     */
+    Q_INVOKABLE void unwatch(int stationId);
+
+    /**
+     * @brief Sprawdza, czy stacja jest obserwowana.
+     * @param stationId Identyfikator stacji.
+     * @return True, jeśli stacja jest na liście obserwowanych.
+     */
+    Q_INVOKABLE bool isWatched(int stationId) const { return m_watched.contains(stationId); }
+
+    /**
+     * @brief Uruchamia cykl odświeżania bez czekania na pełną godzinę.
+     */
+    Q_INVOKABLE void refreshNow();
+
+    /**
+     * @brief Pobiera opóźnienie wybudzenia względem pełnej godziny.
+     * @return Liczba minut.
+     */
+    int publicationDelayMinutes() const { return m_delayMinutes; }
+
+    /**
+     * @brief Ustawia opóźnienie wybudzenia względem pełnej godziny.
+     * @param minutes Liczba minut (0-59).
+     */
+    void setPublicationDelayMinutes(int minutes);
+
+    /**
+     * @brief Pobiera plik listy obserwowanych stacji.
+     * @return Ścieżka pliku.
+     */
+    QString watchListPath() const { return m_watchListPath; }
+
+    /**
+     * @brief Wyznacza chwilę następnego wybudzenia.
+     * @param now Bieżący czas.
+     * @param delayMinutes Opóźnienie względem pełnej godziny w minutach.
+     * @return Najbliższa chwila HH:delayMinutes późniejsza niż now.
+     */
+    static QDateTime nextWakeUp(const QDateTime &now, int delayMinutes);
+
+    /**
+     * @brief Wyznacza początek bieżącej godziny pomiarowej.
+     * @param now Bieżący czas.
+     * @return Pełna godzina czasu polskiego jako znacznik czasu ściennego (jak w SensorSeries).
+     */
+    static qint64 currentMeasurementHour(const QDateTime &now);
+
+    /**
+     * @brief Sprawdza, czy sensor wymaga pobrania pomiarów.
+     * @param lastTimestamp Znacznik najnowszego pomiaru w historii (-1, jeśli brak historii).
+     * @param measurementHour Początek bieżącej godziny pomiarowej.
+     * @return True, jeśli w historii brakuje pomiaru z bieżącej godziny.
+     */
+    static bool isStale(qint64 lastTimestamp, qint64 measurementHour) { return lastTimestamp < measurementHour; }
+
+signals:
+    /**
+     * @brief Sygnał emitowany po włączeniu lub wyłączeniu monitorowania.
+     */
+    void enabledChanged();
+
+    /**
+     * @brief Sygnał emitowany po zmianie listy obserwowanych stacji.
+     */
+    void watchListChanged();
+
+    /**
+     * @brief Sygnał emitowany po rozpoczęciu lub zakończeniu cyklu odświeżania.
+     */
+    void busyChanged();
+
+    /**
+     * @brief Sygnał emitowany, gdy do historii sensora trafiły nowe lub poprawione pomiary.
+     * @param stationId Identyfikator stacji.
+     * @param sensorId Identyfikator sensora.
+     * @param appended Liczba nowych pomiarów.
+     * @param corrected Liczba poprawionych pomiarów.
+     */
+    void sensorUpdated(int stationId, int sensorId, int appended, int corrected);
+
+    /**
+     * @brief Sygnał emitowany po zakończeniu cyklu odświeżania.
+     * @param fetchedSensors Liczba sensorów, których pomiary pobrano.
+     * @param updatedSensors Liczba sensorów z nowymi lub poprawionymi pomiarami.
+     */
+    void cycleFinished(int fetchedSensors, int updatedSensors);
+
+private slots:
+    /**
+     * @brief Wyznacza nieaktualne sensory stacji i dodaje je do kolejki.
+     * @param stationId Identyfikator stacji.
+     * @param sensors Sensory stacji.
+     */
+    void onSensorsReady(int stationId, const QList<SensorInfo> &sensors);
+
+    /**
+     * @brief Dopisuje pobrane pomiary do historii i otwartego szeregu.
+     * @param stationId Identyfikator stacji.
+     * @param sensorId Identyfikator sensora.
+     * @param series Pomiary sensora.
+     */
+    void onSensorDataReady(int stationId, int sensorId, const SensorSeries &series);
+
+    /**
+     * @brief Zamyka cykl po zakończeniu ostatniego zadania kolejki.
+     */
+    void finishCycle();
+
+private:
+    /**
+     * @brief Rozpoczyna cykl odświeżania wszystkich obserwowanych stacji.
+     */
+    void startCycle();
+
+    /**
+     * @brief Ustawia wybudzenie na najbliższą godzinę publikacji.
+     */
+    void scheduleNext();
+
+    /**
+     * @brief Unieważnia kolejkę i trwające żądania monitora.
+     */
+    void cancelAll();
+
+    /**
+     * @brief Wczytuje listę obserwowanych stacji i stan monitorowania.
+     */
+    void loadWatchList();
+
+    /**
+     * @brief Zapisuje listę obserwowanych stacji i stan monitorowania.
+     * @return True, jeśli zapis się powiódł.
+     */
+    bool saveWatchList() const;
+
+    HistoryStore *m_history;                  ///< Historia pomiarów.
+    SensorSeriesStore *m_store;               ///< Szeregi otwartej stacji.
+    StationFetchQueue *m_fetch;               ///< Kolejka żądań monitora.
+    QString m_watchListPath;                  ///< Plik listy obserwowanych stacji.
+    QSet<int> m_watched;                      ///< Obserwowane stacje.
+    bool m_enabled = false;                   ///< Czy monitorowanie jest włączone.
+    int m_delayMinutes = ApiClient::kPublicationDelayMinutes; ///< Opóźnienie wybudzenia po pełnej godzinie.
+    QTimer m_wakeTimer;                       ///< Wybudzenie w najbliższej godzinie publikacji.
+    qint64 m_cycleHour = 0;                   ///< Godzina pomiarowa bieżącego cyklu.
+    int m_fetchedSensors = 0;                 ///< Sensory pobrane w bieżącym cyklu.
+    int m_updatedSensors = 0;                 ///< Sensory zmienione w bieżącym cyklu.
+};
+
+#endif // STATIONMONITOR_H
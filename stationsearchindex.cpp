@@ -0,0 +1,194 @@
+/**
+ * @file stationsearchindex.cpp
+ * @brief Implementacja klasy StationSearchIndex.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera implementację indeksu tekstowego katalogu stacji
+ * używanego do lokalnego dopasowania miast i podpowiedzi w polu wyszukiwania.
+ */
+
+#include "stationsearchindex.h"
+#include <QVariantMap>
+#include <algorithm>
+
+namespace {
+/**
+ * @struct Suggestion
+ * @brief Kandydat na podpowiedź przed sortowaniem.
+ */
+struct Suggestion {
+    int rank;         ///< Ranga (niższa = wyżej na liście).
+    QString text;     ///< Wyświetlany tekst.
+    int recordIndex;  ///< Indeks rekordu.
+    int field;        ///< Pole katalogu.
+};
+}
+
+/**
+ * @brief Buduje indeks od nowa.
+ * @param records Dane stacji z katalogu.
+ *
+ * Dla każdego pola zapisywane są klucze zaczynające się od kolejnych wyrazów,
+ * a następnie cała tablica jest sortowana jednorazowo.
+ */
+void StationSearchIndex::build(const QList<Record> &records)
+{
+    clear();
+    m_records = records;
+    m_entries.reserve(records.size() * 6);
+
+    for (int i = 0; i < m_records.size(); ++i) {
+        const Record &record = m_records.at(i);
+        addField(record.cityName, i, CityField);
+        addField(record.stationName, i, NameField);
+        addField(record.address, i, StreetField);
+
+        const QString cityKey = fold(record.cityName);
+        if (!cityKey.isEmpty())
+            m_cityIndex[cityKey].append(record.stationId);
+    }
+
+    std::sort(m_entries.begin(), m_entries.end(), [](const Entry &a, const Entry &b) {
+        return a.key < b.key;
+    });
+}
+
+/**
+ * @brief Usuwa zawartość indeksu.
+ */
+void StationSearchIndex::clear()
+{
+    m_records.clear();
+    m_entries.clear();
+    m_cityIndex.clear();
+}
+
+/**
+ * @brief Zwraca stacje w mieście o podanej nazwie.
+ * @param city Nazwa miasta w dowolnej pisowni.
+ * @return Identyfikatory stacji.
+ */
+QList<int> StationSearchIndex::stationsInCity(const QString &city) const
+{
+    return m_cityIndex.value(fold(city));
+}
+
+/**
+ * @brief Zwraca podpowiedzi dla wpisywanego tekstu.
+ * @param prefix Wpisany tekst.
+ * @param limit Maksymalna liczba podpowiedzi.
+ * @return Lista podpowiedzi: najpierw miasta, potem nazwy stacji i ulice;
+ *         w obrębie pola wyżej są dopasowania od pierwszego wyrazu.
+ */
+QVariantList StationSearchIndex::suggest(const QString &prefix, int limit) const
+{
+    QVariantList result;
+    const QString key = fold(prefix);
+    if (key.isEmpty() || limit <= 0)
+        return result;
+
+    auto it = std::lower_bound(m_entries.cbegin(), m_entries.cend(), key, [](const Entry &entry, const QString &value) {
+        return entry.key < value;
+    });
+
+    QList<Suggestion> candidates;
+    QHash<QString, int> seen;
+    for (; it != m_entries.cend() && it->key.startsWith(key); ++it) {
+        const Record &record = m_records.at(it->recordIndex);
+
+        // Miasto podpowiadane jest raz, stacje i ulice osobno dla każdej stacji
+        const QString dedupeKey = it->field == CityField
+                                      ? QStringLiteral("c:") + fold(record.cityName)
+                                      : QString::number(it->field) + QLatin1Char(':') + QString::number(record.stationId);
+        if (seen.contains(dedupeKey))
+            continue;
+        seen.insert(dedupeKey, candidates.size());
+
+        QString text;
+        switch (it->field) {
+        case CityField: text = record.cityName; break;
+        case NameField: text = record.stationName; break;
+        case StreetField: text = record.address; break;
+        }
+        candidates.append({ int(it->field) * 2 + (it->wordStart ? 0 : 1), text, it->recordIndex, int(it->field) });
+    }
+
+    std::stable_sort(candidates.begin(), candidates.end(), [](const Suggestion &a, const Suggestion &b) {
+        if (a.rank != b.rank)
+            return a.rank < b.rank;
+        return a.text.localeAwareCompare(b.text) < 0;
+    });
+
+    static const char *const kinds[] = { "city", "station", "street" };
+    for (int i = 0; i < candidates.size() && i < limit; ++i) {
+        const Suggestion &candidate = candidates.at(i);
+        const Record &record = m_records.at(candidate.recordIndex);
+
+        QVariantMap suggestion;
+        suggestion["text"] = candidate.text;
+        suggestion["kind"] = QString::fromLatin1(kinds[candidate.field]);
+        suggestion["cityName"] = record.cityName;
+        suggestion["stationId"] = candidate.field == CityField ? -1 : record.stationId;
+        suggestion["stationCount"] = candidate.field == CityField
+                                         ? m_cityIndex.value(fold(record.cityName)).size()
+                                         : 1;
+        result.append(suggestion);
+    }
+    return result;
+}
+
+/**
+ * @brief Normalizuje tekst do postaci klucza.
+ * @param text Tekst wejściowy.
+ * @return Znormalizowany klucz.
+ *
+ * Rozkłada znaki (NFKD) i odrzuca znaki łączące, a litery bez rozkładu
+ * (np. "ł", "ø", "đ") zamienia ręcznie. Znaki interpunkcyjne traktowane są jak spacje.
+ */
+QString StationSearchIndex::fold(const QString &text)
+{
+    const QString decomposed = text.normalized(QString::NormalizationForm_KD);
+    QString result;
+    result.reserve(decomposed.size());
+    bool pendingSpace = false;
+
+    for (QChar ch : decomposed) {
+        if (ch.category() == QChar::Mark_NonSpacing)
+            continue;
+
+        switch (ch.unicode()) {
+        case 0x0141: case 0x0142: ch = QLatin1Char('l'); break; // Ł ł
+        case 0x00D8: case 0x00F8: ch = QLatin1Char('o'); break; // Ø ø
+        case 0x0110: case 0x0111: ch = QLatin1Char('d'); break; // Đ đ
+        default: break;
+        }
+
+        if (ch.isLetterOrNumber()) {
+            if (pendingSpace && !result.isEmpty())
+                result += QLatin1Char(' ');
+            pendingSpace = false;
+            result += ch.toLower();
+        } else {
+            pendingSpace = true;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Dodaje klucze dla wszystkich wyrazów pola.
+ * @param text Tekst pola.
+ * @param recordIndex Indeks rekordu.
+ * @param field Pole katalogu.
+ */
+void StationSearchIndex::addField(const QString &text, int recordIndex, Field field)
+{
+    const QString folded = fold(text);
+    if (folded.isEmpty())
+        return;
+
+    m_entries.append({ folded, recordIndex, field, true });
+    for (int pos = folded.indexOf(QLatin1Char(' ')); pos >= 0; pos = folded.indexOf(QLatin1Char(' '), pos + 1))
+        m_entries.append({ folded.mid(pos + 1), recordIndex, field, false });
+}
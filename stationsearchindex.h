@@ -0,0 +1,109 @@
+/**
+ * @file stationsearchindex.h
+ * @brief Plik nagłówkowy dla klasy StationSearchIndex.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje indeks tekstowy katalogu stacji (miasto, nazwa stacji, ulica)
+ * z normalizacją znaków diakrytycznych i wyszukiwaniem po prefiksie.
+ */
+
+#ifndef STATIONSEARCHINDEX_H
+#define STATIONSEARCHINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVariantList>
+#include <QVector>
+
+/**
+ * @class StationSearchIndex
+ * @brief Posortowana tablica znormalizowanych kluczy do podpowiedzi i dopasowania miast.
+ *
+ * Klucze są zapisywane małymi literami, bez znaków diakrytycznych ("Łódź" -> "lodz"),
+ * a każdy wyraz pola jest indeksowany osobno, więc prefiks "polan" znajduje "Poznań, ul. Polanka".
+ * Zapytanie po prefiksie to wyszukiwanie binarne w posortowanej tablicy.
+ */
+class StationSearchIndex {
+public:
+    /**
+     * @enum Field
+     * @brief Pole katalogu, z którego pochodzi klucz.
+     */
+    enum Field {
+        CityField,     ///< Nazwa miasta.
+        NameField,     ///< Nazwa stacji.
+        StreetField    ///< Ulica (adres).
+    };
+
+    /**
+     * @struct Record
+     * @brief Dane stacji przekazywane do budowy indeksu.
+     */
+    struct Record {
+        int stationId;        ///< Identyfikator stacji.
+        QString stationName;  ///< Nazwa stacji.
+        QString cityName;     ///< Nazwa miasta.
+        QString address;      ///< Adres stacji.
+    };
+
+    /**
+     * @brief Buduje indeks od nowa.
+     * @param records Dane stacji z katalogu.
+     */
+    void build(const QList<Record> &records);
+
+    /**
+     * @brief Usuwa zawartość indeksu.
+     */
+    void clear();
+
+    /**
+     * @brief Zwraca stacje w mieście o podanej nazwie.
+     * @param city Nazwa miasta w dowolnej pisowni (wielkość liter i znaki diakrytyczne są ignorowane).
+     * @return Identyfikatory stacji w kolejności katalogu.
+     */
+    QList<int> stationsInCity(const QString &city) const;
+
+    /**
+     * @brief Zwraca podpowiedzi dla wpisywanego tekstu.
+     * @param prefix Wpisany tekst.
+     * @param limit Maksymalna liczba podpowiedzi.
+     * @return Lista map z polami text, kind ("city", "station", "street"), stationId, cityName i stationCount.
+     */
+    QVariantList suggest(const QString &prefix, int limit) const;
+
+    /**
+     * @brief Normalizuje tekst do postaci klucza.
+     * @param text Tekst wejściowy.
+     * @return Tekst małymi literami, bez znaków diakrytycznych, z pojedynczymi spacjami między wyrazami.
+     */
+    static QString fold(const QString &text);
+
+private:
+    /**
+     * @struct Entry
+     * @brief Pojedynczy klucz indeksu.
+     */
+    struct Entry {
+        QString key;      ///< Znormalizowany klucz (od początku wyrazu do końca pola).
+        int recordIndex;  ///< Indeks rekordu w m_records.
+        Field field;      ///< Pole, z którego pochodzi klucz.
+        bool wordStart;   ///< True, jeśli klucz zaczyna się od pierwszego wyrazu pola.
+    };
+
+    /**
+     * @brief Dodaje klucze dla wszystkich wyrazów pola.
+     * @param text Tekst pola.
+     * @param recordIndex Indeks rekordu.
+     * @param field Pole katalogu.
+     */
+    void addField(const QString &text, int recordIndex, Field field);
+
+    QList<Record> m_records;                  ///< Rekordy katalogu.
+    QVector<Entry> m_entries;                 ///< Klucze posortowane leksykograficznie.
+    QHash<QString, QList<int>> m_cityIndex;   ///< Znormalizowane miasto -> identyfikatory stacji.
+};
+
+#endif // STATIONSEARCHINDEX_H
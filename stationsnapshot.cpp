@@ -0,0 +1,109 @@
+/**
+ * @file stationsnapshot.cpp
+ * @brief Implementacja klasy StationSnapshot.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera implementację zapisu i odczytu binarnej migawki katalogu stacji.
+ */
+
+#include "stationsnapshot.h"
+#include "metricsregistry.h"
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace {
+/// Sygnatura pliku migawki ("GIOS").
+constexpr quint32 kSnapshotMagic = 0x47494F53;
+/// Wersja formatu migawki.
+constexpr quint16 kSnapshotVersion = 1;
+}
+
+/**
+ * @brief Wczytuje migawkę katalogu.
+ * @param path Ścieżka pliku.
+ * @param records Lista, do której trafiają wczytane rekordy.
+ * @return True, jeśli migawka została poprawnie wczytana.
+ */
+bool StationSnapshot::load(const QString &path, QList<StationRecord> &records)
+{
+    MetricsTimer timer("gios_snapshot_duration_ms", "op=load");
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint32 count = 0;
+    in >> magic >> version >> count;
+    if (magic != kSnapshotMagic || version != kSnapshotVersion)
+        return false;
+
+    QList<StationRecord> loaded;
+    loaded.reserve(qMin<quint32>(count, 100000));
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        qint32 stationId = 0;
+        QByteArray name;
+        QByteArray city;
+        QByteArray address;
+        StationRecord record;
+        in >> stationId >> name >> city >> address >> record.lat >> record.lon;
+        record.stationId = stationId;
+        record.stationName = QString::fromUtf8(name);
+        record.cityName = QString::fromUtf8(city);
+        record.address = QString::fromUtf8(address);
+        loaded.append(record);
+    }
+
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    records = loaded;
+    return true;
+}
+
+/**
+ * @brief Zapisuje migawkę katalogu.
+ * @param path Ścieżka pliku.
+ * @param records Rekordy katalogu.
+ * @return True, jeśli zapis się powiódł.
+ */
+bool StationSnapshot::save(const QString &path, const QList<StationRecord> &records)
+{
+    MetricsTimer timer("gios_snapshot_duration_ms", "op=save");
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kSnapshotMagic << kSnapshotVersion << quint32(records.size());
+    for (const StationRecord &record : records) {
+        out << qint32(record.stationId) << record.stationName.toUtf8() << record.cityName.toUtf8()
+            << record.address.toUtf8() << record.lat << record.lon;
+    }
+
+    if (out.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+/**
+ * @brief Zwraca domyślną ścieżkę migawki w katalogu danych aplikacji.
+ * @return Ścieżka pliku migawki.
+ */
+QString StationSnapshot::defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/stations.snapshot";
+}
@@ -0,0 +1,81 @@
+/**
+ * @file stationsnapshot.h
+ * @brief Plik nagłówkowy dla struktury StationRecord i klasy StationSnapshot.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje rekord katalogu stacji oraz binarną migawkę katalogu
+ * wczytywaną przy starcie aplikacji przed odpowiedzią API.
+ */
+
+#ifndef STATIONSNAPSHOT_H
+#define STATIONSNAPSHOT_H
+
+#include <QList>
+#include <QString>
+
+/**
+ * @struct StationRecord
+ * @brief Dane jednej stacji z katalogu GIOŚ, niezależne od QObject.
+ */
+struct StationRecord {
+    int stationId = 0;    ///< Identyfikator stacji.
+    QString stationName;  ///< Nazwa stacji.
+    QString cityName;     ///< Nazwa miasta.
+    QString address;      ///< Adres stacji.
+    double lat = 0.0;     ///< Szerokość geograficzna.
+    double lon = 0.0;     ///< Długość geograficzna.
+
+    /**
+     * @brief Porównuje dwa rekordy.
+     * @param other Drugi rekord.
+     * @return True, jeśli wszystkie pola są równe.
+     */
+    bool operator==(const StationRecord &other) const
+    {
+        return stationId == other.stationId && stationName == other.stationName
+               && cityName == other.cityName && address == other.address
+               && lat == other.lat && lon == other.lon;
+    }
+
+    /**
+     * @brief Porównuje dwa rekordy.
+     * @param other Drugi rekord.
+     * @return True, jeśli którekolwiek pole się różni.
+     */
+    bool operator!=(const StationRecord &other) const { return !(*this == other); }
+};
+
+/**
+ * @class StationSnapshot
+ * @brief Zapis i odczyt binarnej migawki katalogu stacji.
+ *
+ * Format: sygnatura, wersja, liczba rekordów, a następnie rekordy z tekstami w UTF-8.
+ * Plik zapisywany jest atomowo, a uszkodzona lub nieznana migawka jest ignorowana.
+ */
+class StationSnapshot {
+public:
+    /**
+     * @brief Wczytuje migawkę katalogu.
+     * @param path Ścieżka pliku.
+     * @param records Lista, do której trafiają wczytane rekordy.
+     * @return True, jeśli migawka została poprawnie wczytana.
+     */
+    static bool load(const QString &path, QList<StationRecord> &records);
+
+    /**
+     * @brief Zapisuje migawkę katalogu.
+     * @param path Ścieżka pliku.
+     * @param records Rekordy katalogu.
+     * @return True, jeśli zapis się powiódł.
+     */
+    static bool save(const QString &path, const QList<StationRecord> &records);
+
+    /**
+     * @brief Zwraca domyślną ścieżkę migawki w katalogu danych aplikacji.
+     * @return Ścieżka pliku migawki.
+     */
+    static QString defaultPath();
+};
+
+#endif // STATIONSNAPSHOT_H
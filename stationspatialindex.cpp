@@ -0,0 +1,220 @@
+/**
+ * @file stationspatialindex.cpp
+ * @brief Implementacja klasy StationSpatialIndex.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera implementację siatkowego indeksu przestrzennego stacji
+ * z dokładnym dopasowaniem odległości wzorem haversine.
+ */
+
+#include "stationspatialindex.h"
+#include <QtMath>
+#include <algorithm>
+
+namespace {
+/// Średni promień Ziemi w kilometrach.
+constexpr double kEarthRadiusKm = 6371.0088;
+/// Długość łuku jednego stopnia szerokości geograficznej w kilometrach.
+constexpr double kKmPerDegree = kEarthRadiusKm * M_PI / 180.0;
+
+/**
+ * @brief Porównuje wyniki według odległości.
+ */
+bool closerThan(const StationDistance &a, const StationDistance &b)
+{
+    return a.distanceKm < b.distanceKm;
+}
+}
+
+/**
+ * @brief Konstruktor obiektu StationSpatialIndex.
+ * @param cellSizeDeg Rozmiar komórki siatki w stopniach.
+ */
+StationSpatialIndex::StationSpatialIndex(double cellSizeDeg)
+    : m_cellSizeDeg(cellSizeDeg)
+{
+}
+
+/**
+ * @brief Buduje indeks od nowa.
+ * @param points Lista punktów (stacji) do zaindeksowania.
+ *
+ * Każdy punkt trafia do jednej komórki siatki; zapamiętywany jest też zakres zajętych komórek,
+ * który ogranicza rozszerzanie pierścieni podczas wyszukiwania najbliższych stacji.
+ */
+void StationSpatialIndex::build(const QList<Point> &points)
+{
+    clear();
+    m_points.reserve(points.size());
+
+    for (const Point &point : points) {
+        const int row = cellIndex(point.lat);
+        const int col = cellIndex(point.lon);
+        m_cells[cellKey(row, col)].append(m_points.size());
+        m_points.append(point);
+
+        if (m_maxRow < m_minRow) {
+            m_minRow = m_maxRow = row;
+            m_minCol = m_maxCol = col;
+        } else {
+            m_minRow = qMin(m_minRow, row);
+            m_maxRow = qMax(m_maxRow, row);
+            m_minCol = qMin(m_minCol, col);
+            m_maxCol = qMax(m_maxCol, col);
+        }
+    }
+}
+
+/**
+ * @brief Usuwa wszystkie punkty z indeksu.
+ */
+void StationSpatialIndex::clear()
+{
+    m_points.clear();
+    m_cells.clear();
+    m_minRow = m_minCol = 0;
+    m_maxRow = m_maxCol = -1;
+}
+
+/**
+ * @brief Wyszukuje k najbliższych stacji.
+ * @param lat Szerokość geograficzna punktu zapytania.
+ * @param lon Długość geograficzna punktu zapytania.
+ * @param k Maksymalna liczba wyników.
+ * @return Stacje posortowane rosnąco według odległości.
+ *
+ * Przegląda kolejne pierścienie komórek wokół punktu zapytania i kończy, gdy k-ty kandydat
+ * jest bliżej niż dowolny punkt spoza przejrzanego obszaru.
+ */
+QList<StationDistance> StationSpatialIndex::nearest(double lat, double lon, int k) const
+{
+    QList<StationDistance> candidates;
+    if (k <= 0 || m_points.isEmpty())
+        return candidates;
+    k = qMin(k, int(m_points.size()));
+
+    const int row0 = cellIndex(lat);
+    const int col0 = cellIndex(lon);
+    const int maxRing = qMax(qMax(qAbs(row0 - m_minRow), qAbs(row0 - m_maxRow)),
+                             qMax(qAbs(col0 - m_minCol), qAbs(col0 - m_maxCol)));
+
+    for (int ring = 0; ring <= maxRing; ++ring) {
+        if (ring == 0) {
+            collectCell(row0, col0, lat, lon, candidates);
+        } else {
+            for (int col = col0 - ring; col <= col0 + ring; ++col) {
+                collectCell(row0 - ring, col, lat, lon, candidates);
+                collectCell(row0 + ring, col, lat, lon, candidates);
+            }
+            for (int row = row0 - ring + 1; row <= row0 + ring - 1; ++row) {
+                collectCell(row, col0 - ring, lat, lon, candidates);
+                collectCell(row, col0 + ring, lat, lon, candidates);
+            }
+        }
+
+        if (candidates.size() < k)
+            continue;
+
+        // Punkty spoza przejrzanego kwadratu są oddalone o co najmniej ring komórek
+        std::nth_element(candidates.begin(), candidates.begin() + (k - 1), candidates.end(), closerThan);
+        const double kthDistance = candidates.at(k - 1).distanceKm;
+        const double boundDeg = ring * m_cellSizeDeg;
+        const double farthestLat = qMin(89.0, qAbs(lat) + boundDeg);
+        const double boundKm = boundDeg * kKmPerDegree * qCos(qDegreesToRadians(farthestLat));
+        if (kthDistance <= boundKm)
+            break;
+    }
+
+    std::sort(candidates.begin(), candidates.end(), closerThan);
+    if (candidates.size() > k)
+        candidates.resize(k);
+    return candidates;
+}
+
+/**
+ * @brief Wyszukuje stacje w zadanym promieniu.
+ * @param lat Szerokość geograficzna punktu zapytania.
+ * @param lon Długość geograficzna punktu zapytania.
+ * @param radiusKm Promień w kilometrach.
+ * @return Stacje posortowane rosnąco według odległości.
+ *
+ * Przegląda tylko komórki prostokąta opisanego na okręgu zapytania.
+ */
+QList<StationDistance> StationSpatialIndex::within(double lat, double lon, double radiusKm) const
+{
+    QList<StationDistance> candidates;
+    if (radiusKm <= 0.0 || m_points.isEmpty())
+        return candidates;
+
+    const double latSpan = radiusKm / kKmPerDegree;
+    const double farthestLat = qMin(89.0, qAbs(lat) + latSpan);
+    const double lonSpan = qMin(180.0, latSpan / qCos(qDegreesToRadians(farthestLat)));
+
+    const int rowFrom = qMax(m_minRow, cellIndex(lat - latSpan));
+    const int rowTo = qMin(m_maxRow, cellIndex(lat + latSpan));
+    const int colFrom = qMax(m_minCol, cellIndex(lon - lonSpan));
+    const int colTo = qMin(m_maxCol, cellIndex(lon + lonSpan));
+
+    for (int row = rowFrom; row <= rowTo; ++row) {
+        for (int col = colFrom; col <= colTo; ++col)
+            collectCell(row, col, lat, lon, candidates);
+    }
+
+    QList<StationDistance> results;
+    for (const StationDistance &candidate : candidates) {
+        if (candidate.distanceKm <= radiusKm)
+            results.append(candidate);
+    }
+    std::sort(results.begin(), results.end(), closerThan);
+    return results;
+}
+
+/**
+ * @brief Oblicza odległość po okręgu wielkim między dwoma punktami.
+ * @return Odległość w kilometrach.
+ */
+double StationSpatialIndex::haversineKm(double lat1, double lon1, double lat2, double lon2)
+{
+    const double dLat = qDegreesToRadians(lat2 - lat1);
+    const double dLon = qDegreesToRadians(lon2 - lon1);
+    const double sinLat = qSin(dLat / 2.0);
+    const double sinLon = qSin(dLon / 2.0);
+    const double a = sinLat * sinLat
+                     + qCos(qDegreesToRadians(lat1)) * qCos(qDegreesToRadians(lat2)) * sinLon * sinLon;
+    return 2.0 * kEarthRadiusKm * qAsin(qMin(1.0, qSqrt(a)));
+}
+
+/**
+ * @brief Wyznacza indeks komórki dla współrzędnej.
+ * @param degrees Współrzędna w stopniach.
+ * @return Indeks komórki.
+ */
+int StationSpatialIndex::cellIndex(double degrees) const
+{
+    return static_cast<int>(qFloor(degrees / m_cellSizeDeg));
+}
+
+/**
+ * @brief Składa klucz komórki z indeksów wiersza i kolumny.
+ * @return Klucz komórki.
+ */
+qint64 StationSpatialIndex::cellKey(int row, int col)
+{
+    return (qint64(row) << 32) | quint32(col);
+}
+
+/**
+ * @brief Dodaje kandydatów z jednej komórki do listy wyników.
+ */
+void StationSpatialIndex::collectCell(int row, int col, double lat, double lon, QList<StationDistance> &results) const
+{
+    auto it = m_cells.constFind(cellKey(row, col));
+    if (it == m_cells.constEnd())
+        return;
+
+    for (int pointIndex : it.value()) {
+        const Point &point = m_points.at(pointIndex);
+        results.append({ point.stationId, haversineKm(lat, lon, point.lat, point.lon) });
+    }
+}
@@ -0,0 +1,133 @@
+/**
+ * @file stationspatialindex.h
+ * @brief Plik nagłówkowy dla klasy StationSpatialIndex.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje indeks przestrzenny stacji oparty na siatce szerokości i długości geograficznej,
+ * używany do wyszukiwania najbliższych stacji oraz stacji w zadanym promieniu.
+ */
+
+#ifndef STATIONSPATIALINDEX_H
+#define STATIONSPATIALINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QVector>
+
+/**
+ * @struct StationDistance
+ * @brief Wynik zapytania przestrzennego: stacja i jej odległość od punktu zapytania.
+ */
+struct StationDistance {
+    int stationId;      ///< Identyfikator stacji.
+    double distanceKm;  ///< Odległość w kilometrach (wzór haversine).
+};
+
+/**
+ * @class StationSpatialIndex
+ * @brief Indeks przestrzenny stacji w postaci siatki komórek o stałym rozmiarze w stopniach.
+ *
+ * Zapytania przeglądają tylko komórki w otoczeniu punktu, a dokładna odległość
+ * liczona jest wzorem haversine wyłącznie dla kandydatów z tych komórek.
+ * Indeks budowany jest jednorazowo po załadowaniu katalogu stacji.
+ */
+class StationSpatialIndex {
+public:
+    /**
+     * @struct Point
+     * @brief Punkt wejściowy indeksu.
+     */
+    struct Point {
+        int stationId;  ///< Identyfikator stacji.
+        double lat;     ///< Szerokość geograficzna.
+        double lon;     ///< Długość geograficzna.
+    };
+
+    /**
+     * @brief Konstruktor obiektu StationSpatialIndex.
+     * @param cellSizeDeg Rozmiar komórki siatki w stopniach.
+     */
+    explicit StationSpatialIndex(double cellSizeDeg = 0.25);
+
+    /**
+     * @brief Buduje indeks od nowa.
+     * @param points Lista punktów (stacji) do zaindeksowania.
+     */
+    void build(const QList<Point> &points);
+
+    /**
+     * @brief Usuwa wszystkie punkty z indeksu.
+     */
+    void clear();
+
+    /**
+     * @brief Pobiera liczbę zaindeksowanych punktów.
+     * @return Liczba punktów.
+     */
+    int size() const { return m_points.size(); }
+
+    /**
+     * @brief Wyszukuje k najbliższych stacji.
+     * @param lat Szerokość geograficzna punktu zapytania.
+     * @param lon Długość geograficzna punktu zapytania.
+     * @param k Maksymalna liczba wyników.
+     * @return Stacje posortowane rosnąco według odległości.
+     */
+    QList<StationDistance> nearest(double lat, double lon, int k) const;
+
+    /**
+     * @brief Wyszukuje stacje w zadanym promieniu.
+     * @param lat Szerokość geograficzna punktu zapytania.
+     * @param lon Długość geograficzna punktu zapytania.
+     * @param radiusKm Promień w kilometrach.
+     * @return Stacje posortowane rosnąco według odległości.
+     */
+    QList<StationDistance> within(double lat, double lon, double radiusKm) const;
+
+    /**
+     * @brief Oblicza odległość po okręgu wielkim między dwoma punktami.
+     * @param lat1 Szerokość geograficzna pierwszego punktu.
+     * @param lon1 Długość geograficzna pierwszego punktu.
+     * @param lat2 Szerokość geograficzna drugiego punktu.
+     * @param lon2 Długość geograficzna drugiego punktu.
+     * @return Odległość w kilometrach.
+     */
+    static double haversineKm(double lat1, double lon1, double lat2, double lon2);
+
+private:
+    /**
+     * @brief Wyznacza indeks komórki dla współrzędnej.
+     * @param degrees Współrzędna w stopniach.
+     * @return Indeks komórki.
+     */
+    int cellIndex(double degrees) const;
+
+    /**
+     * @brief Składa klucz komórki z indeksów wiersza i kolumny.
+     * @param row Indeks wiersza (szerokość).
+     * @param col Indeks kolumny (długość).
+     * @return Klucz komórki.
+     */
+    static qint64 cellKey(int row, int col);
+
+    /**
+     * @brief Dodaje kandydatów z jednej komórki do listy wyników.
+     * @param row Indeks wiersza komórki.
+     * @param col Indeks kolumny komórki.
+     * @param lat Szerokość geograficzna punktu zapytania.
+     * @param lon Długość geograficzna punktu zapytania.
+     * @param results Lista, do której dopisywane są kandydaci.
+     */
+    void collectCell(int row, int col, double lat, double lon, QList<StationDistance> &results) const;
+
+    double m_cellSizeDeg;                    ///< Rozmiar komórki w stopniach.
+    QVector<Point> m_points;                 ///< Zaindeksowane punkty.
+    QHash<qint64, QVector<int>> m_cells;     ///< Komórka siatki -> indeksy punktów.
+    int m_minRow = 0;                        ///< Najmniejszy zajęty wiersz siatki.
+    int m_maxRow = -1;                       ///< Największy zajęty wiersz siatki.
+    int m_minCol = 0;                        ///< Najmniejsza zajęta kolumna siatki.
+    int m_maxCol = -1;                       ///< Największa zajęta kolumna siatki.
+};
+
+#endif // STATIONSPATIALINDEX_H
@@ -0,0 +1,144 @@
+/**
+ * @file stationviewmodel.cpp
+ * @brief Implementacja klasy StationViewModel.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik zawiera implementację widoku indeksowego katalogu stacji.
+ */
+
+#include "stationviewmodel.h"
+#include "stationlistmodel.h"
+
+/**
+ * @brief Konstruktor obiektu StationViewModel.
+ * @param catalog Katalog stacji.
+ * @param parent Rodzic QObject.
+ */
+StationViewModel::StationViewModel(StationListModel *catalog, QObject *parent)
+    : QAbstractListModel(parent), m_catalog(catalog)
+{
+    connect(m_catalog, &QAbstractItemModel::dataChanged, this, &StationViewModel::onCatalogChanged);
+    connect(m_catalog, &QAbstractItemModel::rowsRemoved, this, &StationViewModel::dropMissing);
+    connect(m_catalog, &QAbstractItemModel::modelReset, this, &StationViewModel::dropMissing);
+}
+
+/**
+ * @brief Zwraca liczbę wierszy modelu.
+ * @param parent Indeks rodzica.
+ * @return Liczba stacji lub 0 dla poprawnego rodzica.
+ */
+int StationViewModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return m_stationIds.size();
+}
+
+/**
+ * @brief Zwraca dane dla wskazanego wiersza i roli.
+ * @param index Indeks wiersza.
+ * @param role Rola danych.
+ * @return Wartość roli z katalogu lub pusty QVariant.
+ */
+QVariant StationViewModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid())
+        return QVariant();
+
+    const int row = catalogRow(index.row());
+    if (row < 0)
+        return QVariant();
+    return m_catalog->data(m_catalog->index(row), role);
+}
+
+/**
+ * @brief Zwraca nazwy ról widoczne w QML.
+ * @return Mapa ról katalogu stacji.
+ */
+QHash<int, QByteArray> StationViewModel::roleNames() const
+{
+    return m_catalog->roleNames();
+}
+
+/**
+ * @brief Pobiera wiersz katalogu dla wiersza widoku.
+ * @param row Wiersz widoku.
+ * @return Wiersz katalogu lub -1.
+ */
+int StationViewModel::catalogRow(int row) const
+{
+    if (row < 0 || row >= m_stationIds.size())
+        return -1;
+    return m_catalog->rowOf(m_stationIds.at(row));
+}
+
+/**
+ * @brief Zastępuje zawartość widoku.
+ * @param stationIds Identyfikatory stacji.
+ */
+void StationViewModel::setStationIds(const QList<int> &stationIds)
+{
+    clear();
+
+    // removeIf nie odłącza współdzielonej listy, gdy nie ma czego usuwać
+    QList<int> valid = stationIds;
+    valid.removeIf([this](int stationId) { return !m_catalog->contains(stationId); });
+    if (valid.isEmpty())
+        return;
+
+    beginInsertRows(QModelIndex(), 0, valid.size() - 1);
+    m_stationIds = valid;
+    endInsertRows();
+    emit countChanged();
+}
+
+/**
+ * @brief Usuwa wszystkie stacje z widoku.
+ */
+void StationViewModel::clear()
+{
+    if (m_stationIds.isEmpty())
+        return;
+
+    beginRemoveRows(QModelIndex(), 0, m_stationIds.size() - 1);
+    m_stationIds.clear();
+    endRemoveRows();
+    emit countChanged();
+}
+
+/**
+ * @brief Przekazuje zmiany danych katalogu do widocznych wierszy.
+ * @param topLeft Pierwszy zmieniony wiersz katalogu.
+ * @param bottomRight Ostatni zmieniony wiersz katalogu.
+ * @param roles Zmienione role.
+ *
+ * Lista wyników jest krótka, więc wystarcza jej liniowe przejrzenie.
+ */
+void StationViewModel::onCatalogChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles)
+{
+    for (int row = 0; row < m_stationIds.size(); ++row) {
+        const int source = catalogRow(row);
+        if (source >= topLeft.row() && source <= bottomRight.row()) {
+            const QModelIndex changed = index(row);
+            emit dataChanged(changed, changed, roles);
+        }
+    }
+}
+
+/**
+ * @brief Usuwa z widoku stacje, których nie ma już w katalogu.
+ */
+void StationViewModel::dropMissing()
+{
+    const int before = m_stationIds.size();
+    for (int row = m_stationIds.size() - 1; row >= 0; --row) {
+        if (m_catalog->contains(m_stationIds.at(row)))
+            continue;
+        beginRemoveRows(QModelIndex(), row, row);
+        m_stationIds.removeAt(row);
+        endRemoveRows();
+    }
+    if (m_stationIds.size() != before)
+        emit countChanged();
+}
@@ -0,0 +1,124 @@
+/**
+ * @file stationviewmodel.h
+ * @brief Plik nagłówkowy dla klasy StationViewModel.
+ * @author Adam Fedorowicz
+ * @date 2025-04-21
+ *
+ * Ten plik definiuje widok indeksowy katalogu stacji używany jako lista wyników wyszukiwania.
+ */
+
+#ifndef STATIONVIEWMODEL_H
+#define STATIONVIEWMODEL_H
+
+#include <QAbstractListModel>
+#include <QList>
+
+class StationListModel;
+
+/**
+ * @class StationViewModel
+ * @brief Lista wybranych stacji katalogu bez kopiowania ich danych.
+ *
+ * Model przechowuje wyłącznie identyfikatory stacji, a dane ról pobiera z katalogu
+ * (StationListModel), dlatego wyświetlenie wyników wyszukiwania nie tworzy obiektów stacji.
+ * Zmiany danych katalogu są przekazywane jako dataChanged dla widocznych wierszy,
+ * a stacje usunięte z katalogu znikają z widoku.
+ */
+class StationViewModel : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(QList<int> stationIds READ stationIds NOTIFY countChanged)
+
+public:
+    /**
+     * @brief Konstruktor obiektu StationViewModel.
+     * @param catalog Katalog stacji (źródło danych ról).
+     * @param parent Rodzic QObject.
+     */
+    explicit StationViewModel(StationListModel *catalog, QObject *parent = nullptr);
+
+    /**
+     * @brief Zwraca liczbę wierszy modelu.
+     * @param parent Indeks rodzica (nieużywany w modelu listy).
+     * @return Liczba stacji w widoku.
+     */
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    /**
+     * @brief Zwraca dane dla wskazanego wiersza i roli.
+     * @param index Indeks wiersza.
+     * @param role Rola danych (role StationListModel).
+     * @return Wartość roli lub pusty QVariant.
+     */
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief Zwraca nazwy ról widoczne w QML.
+     * @return Mapa ról katalogu stacji.
+     */
+    QHash<int, QByteArray> roleNames() const override;
+
+    /**
+     * @brief Pobiera liczbę stacji w widoku.
+     * @return Liczba stacji.
+     */
+    int count() const { return m_stationIds.size(); }
+
+    /**
+     * @brief Pobiera identyfikatory stacji widoku.
+     * @return Identyfikatory w kolejności wierszy.
+     */
+    const QList<int> &stationIds() const { return m_stationIds; }
+
+    /**
+     * @brief Pobiera wiersz katalogu dla wiersza widoku.
+     * @param row Wiersz widoku.
+     * @return Wiersz katalogu lub -1.
+     */
+    int catalogRow(int row) const;
+
+    /**
+     * @brief Pobiera katalog stacji.
+     * @return Katalog stacji.
+     */
+    StationListModel *catalog() const { return m_catalog; }
+
+    /**
+     * @brief Zastępuje zawartość widoku.
+     * @param stationIds Identyfikatory stacji; nieobecne w katalogu są pomijane.
+     *
+     * Gdy wszystkie identyfikatory są w katalogu, lista jest współdzielona bez kopiowania.
+     */
+    void setStationIds(const QList<int> &stationIds);
+
+    /**
+     * @brief Usuwa wszystkie stacje z widoku.
+     */
+    void clear();
+
+signals:
+    /**
+     * @brief Sygnał emitowany, gdy zmieni się liczba stacji.
+     */
+    void countChanged();
+
+private slots:
+    /**
+     * @brief Przekazuje zmiany danych katalogu do widocznych wierszy.
+     * @param topLeft Pierwszy zmieniony wiersz katalogu.
+     * @param bottomRight Ostatni zmieniony wiersz katalogu.
+     * @param roles Zmienione role.
+     */
+    void onCatalogChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles);
+
+    /**
+     * @brief Usuwa z widoku stacje, których nie ma już w katalogu.
+     */
+    void dropMissing();
+
+private:
+    StationListModel *m_catalog; ///< Katalog stacji.
+    QList<int> m_stationIds;     ///< Identyfikatory stacji w kolejności wierszy.
+};
+
+#endif // STATIONVIEWMODEL_H
@@ -1,20 +1,212 @@
 /**
  * @file tst_mainwindow.cpp
- * @brief Testy jednostkowe dla klas MainWindow i Station.
+ * @brief Testy jednostkowe dla klasy MainWindow i modeli stacji.
  * @author Jan Kowalski
  * @date 2025-04-22
  *
- * Ten plik zawiera testy jednostkowe dla klas MainWindow i Station przy użyciu frameworka Qt Test.
+ * Ten plik zawiera testy jednostkowe dla klasy MainWindow i modeli stacji przy użyciu frameworka Qt Test.
  */
 
 #include <QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+#include <QTimer>
+#include "harvester.h"
 #include "mainwindow.h"
+#include "metricsregistry.h"
+#include "requestscheduler.h"
+#include "sensorchart.h"
+
+/**
+ * @class StubHttpServer
+ * @brief Lokalny serwer HTTP zastępujący API GIOŚ i Nominatim w testach.
+ *
+ * Każde żądanie ścieżki zdejmuje kolejną odpowiedź z jej listy (ostatnia jest powtarzana);
+ * żądanie z parametrami bez własnej odpowiedzi dostaje odpowiedź samej ścieżki (np. "/search").
+ * Ścieżki z listy held nie dostają odpowiedzi, dopóki klient nie zamknie połączenia.
+ * Opóźnienie (latencyMs, Reply::delayMs) i zerwanie połączenia (Reply::drop) odtwarzają
+ * wolne i zawodne łącze, a replayArchive() i catalogJson() budują odpowiedzi API
+ * z zapisanego pliku stacji i z syntetycznego katalogu.
+ */
+class StubHttpServer
+{
+public:
+    /// Przygotowana odpowiedź.
+    struct Reply {
+        int status = 200;    ///< Kod statusu HTTP.
+        QByteArray body;     ///< Treść odpowiedzi.
+        int delayMs = 0;     ///< Opóźnienie odpowiedzi w ms (dodawane do latencyMs).
+        bool drop = false;   ///< Zerwanie połączenia zamiast odpowiedzi.
+    };
+
+    StubHttpServer()
+    {
+        QObject::connect(&m_server, &QTcpServer::newConnection, &m_server, [this]() {
+            while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+                QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+                QObject::connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() {
+                    QByteArray &buffer = m_buffers[socket];
+                    buffer += socket->readAll();
+                    if (!buffer.contains("\r\n\r\n"))
+                        return;
+                    const QString target = QString::fromLatin1(buffer.split(' ').value(1));
+                    m_buffers.remove(socket);
+                    requests.append(target);
+                    const QString path = responses.contains(target) ? target : target.section('?', 0, 0);
+                    if (held.contains(path))
+                        return;
+                    QList<Reply> &queue = responses[path];
+                    const Reply reply = queue.size() > 1 ? queue.takeFirst() : queue.value(0);
+                    QTimer::singleShot(latencyMs + reply.delayMs, socket, [socket, reply]() {
+                        respond(socket, reply);
+                    });
+                });
+            }
+        });
+        m_server.listen(QHostAddress::LocalHost);
+    }
+
+    /**
+     * @brief Buduje adres ścieżki na serwerze.
+     * @param path Ścieżka (np. "/data").
+     * @return Pełny adres URL.
+     */
+    QUrl url(const QString &path) const
+    {
+        return QUrl(QString("http://127.0.0.1:%1%2").arg(m_server.serverPort()).arg(path));
+    }
+
+    /**
+     * @brief Przygotowuje odpowiedzi API GIOŚ odtwarzające zapisany plik stacji.
+     * @param path Plik archiwalny stacji (np. station_515_20250424_142935.json).
+     * @return True, jeśli plik został wczytany.
+     *
+     * Lista sensorów trafia pod /station/sensors/{id}, a pomiary każdego sensora
+     * pod /data/getData/{id}.
+     */
+    bool replayArchive(const QString &path)
+    {
+        StationArchiveData data;
+        if (!StationArchive::load(path, data))
+            return false;
+
+        QJsonArray sensors;
+        for (const ArchivedSensor &sensor : std::as_const(data.sensors)) {
+            QJsonObject param;
+            param["paramName"] = sensor.paramName;
+            param["paramCode"] = sensor.paramCode;
+            QJsonObject entry;
+            entry["id"] = sensor.sensorId;
+            entry["stationId"] = data.stationId;
+            entry["param"] = param;
+            sensors.append(entry);
+            responses[QString("/data/getData/%1").arg(sensor.sensorId)] = { { 200, seriesJson(sensor.paramCode, sensor.series) } };
+        }
+        responses[QString("/station/sensors/%1").arg(data.stationId)] = { { 200, QJsonDocument(sensors).toJson(QJsonDocument::Compact) } };
+        return true;
+    }
+
+    /**
+     * @brief Przygotowuje odpowiedź Nominatim dla wyszukiwania miasta.
+     * @param name Nazwa miejscowości.
+     * @param lat Szerokość geograficzna.
+     * @param lon Długość geograficzna.
+     */
+    void setGeocode(const QString &name, double lat, double lon)
+    {
+        QJsonObject place;
+        place["name"] = name;
+        place["lat"] = QString::number(lat, 'f', 7);
+        place["lon"] = QString::number(lon, 'f', 7);
+        responses["/search"] = { { 200, QJsonDocument(QJsonArray{ place }).toJson(QJsonDocument::Compact) } };
+    }
+
+    /**
+     * @brief Buduje syntetyczny katalog stacji w formacie /station/findAll.
+     * @param count Liczba stacji.
+     * @return Treść odpowiedzi.
+     *
+     * Stacje o identyfikatorach od 1 leżą na siatce pokrywającej Polskę, po cztery
+     * w każdym mieście "Miasto N".
+     */
+    static QByteArray catalogJson(int count)
+    {
+        QJsonArray stations;
+        for (int i = 0; i < count; ++i) {
+            QJsonObject city;
+            city["name"] = QString("Miasto %1").arg(i / 4 + 1);
+            QJsonObject station;
+            station["id"] = i + 1;
+            station["stationName"] = QString("Stacja %1").arg(i + 1);
+            station["gegrLat"] = QString::number(49.0 + (i % 40) * 0.145, 'f', 6);
+            station["gegrLon"] = QString::number(14.1 + (i / 40 % 50) * 0.2, 'f', 6);
+            station["city"] = city;
+            station["addressStreet"] = QString("ul. Testowa %1").arg(i + 1);
+            stations.append(station);
+        }
+        return QJsonDocument(stations).toJson(QJsonDocument::Compact);
+    }
+
+    /**
+     * @brief Buduje odpowiedź /data/getData dla szeregu.
+     * @param key Kod parametru.
+     * @param series Pomiary.
+     * @return Treść odpowiedzi z pomiarami od najnowszego, jak w API GIOŚ.
+     */
+    static QByteArray seriesJson(const QString &key, const SensorSeries &series)
+    {
+        QJsonArray values;
+        for (int i = series.size() - 1; i >= 0; --i) {
+            QJsonObject value;
+            value["date"] = SensorSeries::formatTimestamp(series.timestamp(i));
+            value["value"] = series.isNull(i) ? QJsonValue() : QJsonValue(series.value(i));
+            values.append(value);
+        }
+        QJsonObject body;
+        body["key"] = key;
+        body["values"] = values;
+        return QJsonDocument(body).toJson(QJsonDocument::Compact);
+    }
+
+    QHash<QString, QList<Reply>> responses;  ///< Odpowiedzi według ścieżki.
+    QStringList held;                        ///< Ścieżki bez odpowiedzi.
+    QStringList requests;                    ///< Odebrane żądania w kolejności.
+    int latencyMs = 0;                       ///< Opóźnienie każdej odpowiedzi w ms.
+
+private:
+    /**
+     * @brief Wysyła odpowiedź i zamyka połączenie.
+     * @param socket Połączenie klienta.
+     * @param reply Odpowiedź.
+     */
+    static void respond(QTcpSocket *socket, const Reply &reply)
+    {
+        if (reply.drop) {
+            socket->abort();
+            return;
+        }
+        socket->write("HTTP/1.1 " + QByteArray::number(reply.status) + " Stub\r\n"
+                      "Content-Type: application/json\r\n"
+                      "Content-Length: " + QByteArray::number(reply.body.size()) + "\r\n"
+                      "Connection: close\r\n\r\n" + reply.body);
+        socket->disconnectFromHost();
+    }
+
+    QTcpServer m_server;                         ///< Gniazdo nasłuchujące.
+    QHash<QTcpSocket*, QByteArray> m_buffers;    ///< Niepełne nagłówki żądań.
+};
 
 /**
  * @class TestMainWindow
- * @brief Klasa testowa dla funkcjonalności MainWindow i Station.
+ * @brief Klasa testowa dla funkcjonalności MainWindow i modeli stacji.
  *
- * Ta klasa zawiera testy jednostkowe weryfikujące poprawność działania klas MainWindow i Station.
+ * Ta klasa zawiera testy jednostkowe weryfikujące poprawność działania klasy MainWindow i modeli stacji.
+ * Wszystkie obiekty MainWindow korzystają ze wspólnego lokalnego serwera zamiast API GIOŚ
+ * i Nominatim, a funkcje benchmark* mierzą wydajność kluczowych ścieżek (QBENCHMARK).
  */
 class TestMainWindow : public QObject
 {
@@ -22,27 +214,122 @@ class TestMainWindow : public QObject
 
 private slots:
     /**
-     * @brief Testuje właściwości klasy Station.
+     * @brief Przygotowuje środowisko testów.
      *
-     * Sprawdza, czy właściwości stacji (ID, nazwa, miasto, adres, współrzędne, status wyszukiwania)
-     * są poprawnie ustawiane i zwracane.
+     * Pamięć podręczna, migawka katalogu i lista obserwowanych stacji trafiają do katalogów
+     * testowych, a adresy API wskazują lokalny serwer z syntetycznym katalogiem stacji.
      */
-    void testStationProperties()
+    void initTestCase()
     {
-        Station station(1, "Test Station", "Test City", "Test Address", 50.0, 20.0, false, nullptr);
-        QCOMPARE(station.stationId(), 1);
-        QCOMPARE(station.stationName(), QString("Test Station"));
-        QCOMPARE(station.cityName(), QString("Test City"));
-        QCOMPARE(station.address(), QString("Test Address"));
-        QCOMPARE(station.lat(), 50.0);
-        QCOMPARE(station.lon(), 20.0);
-        QCOMPARE(station.isSearched(), false);
+        QStandardPaths::setTestModeEnabled(true);
+        m_server.responses["/station/findAll"] = { { 200, StubHttpServer::catalogJson(kCatalogStations) } };
+        qputenv("GIOS_API_URL", m_server.url("").toString().toUtf8());
+        qputenv("GIOS_GEOCODER_URL", m_server.url("/search").toString().toUtf8());
+    }
+
+    /**
+     * @brief Testuje zwarty katalog stacji i widok wyników.
+     *
+     * Sprawdza, czy dane stacji (ID, nazwa, miasto, adres, współrzędne, status wyszukiwania)
+     * są poprawnie zwracane, czy powtarzające się miasta zajmują w puli jeden napis, czy bity
+     * statusu przesuwają się razem z wierszami (także przy usuwaniu wielu stacji naraz), czy pula
+     * napisów nie rośnie przy zmianach i usunięciach stacji oraz czy widok wyników przekazuje
+     * zmiany katalogu.
+     */
+    void testStationCatalog()
+    {
+        StationListModel catalog;
+        QVERIFY(catalog.appendRecord(stationRecord(1, "Poznań", 52.40, 16.90, "ul. Polanka")));
+        QVERIFY(catalog.appendRecord(stationRecord(2, "Poznań", 52.41, 16.88, "ul. Dąbrowskiego")));
+        QVERIFY(!catalog.appendRecord(stationRecord(2, "Poznań", 52.41, 16.88, "ul. Dąbrowskiego")));
+        QCOMPARE(catalog.stationId(0), 1);
+        QCOMPARE(catalog.stationName(0), QString("Stacja 1"));
+        QCOMPARE(catalog.cityName(1), QString("Poznań"));
+        QCOMPARE(catalog.address(1), QString("ul. Dąbrowskiego"));
+        QCOMPARE(catalog.lat(1), 52.41);
+        QCOMPARE(catalog.lon(1), 16.88);
+        QCOMPARE(catalog.isSearched(1), false);
+        QVERIFY(catalog.record(0) == stationRecord(1, "Poznań", 52.40, 16.90, "ul. Polanka"));
+
+        // Dwie nazwy, dwa adresy i jedno wspólne miasto
+        QCOMPARE(catalog.internedStrings(), 5);
+        QCOMPARE(catalog.cityName(0).constData(), catalog.cityName(1).constData());
+
+        // Zastąpienie zachowuje status, a usunięcie przesuwa bity kolejnych wierszy
+        QVERIFY(catalog.appendRecord(stationRecord(3, "Łódź", 51.76, 19.53)));
+        QVERIFY(catalog.setSearched(3, true));
+        QVERIFY(catalog.replaceRecord(stationRecord(3, "Łódź", 51.77, 19.53)));
+        QVERIFY(catalog.isSearched(2));
+        QVERIFY(catalog.removeStation(2));
+        QCOMPARE(catalog.rowOf(3), 1);
+        QVERIFY(!catalog.isSearched(0));
+        QVERIFY(catalog.isSearched(1));
+        QCOMPARE(catalog.searchedCount(), 1);
+
+        // Widok wyników przechowuje identyfikatory i korzysta z danych katalogu
+        StationViewModel view(&catalog);
+        view.setStationIds({ 3, 99, 1 });
+        QCOMPARE(view.count(), 2);
+        QCOMPARE(view.data(view.index(0), StationListModel::CityNameRole).toString(), QString("Łódź"));
+        QCOMPARE(view.data(view.index(0), StationListModel::LatRole).toDouble(), 51.77);
+
+        QSignalSpy changedSpy(&view, &QAbstractItemModel::dataChanged);
+        catalog.clearSearched();
+        QCOMPARE(changedSpy.count(), 1);
+        QCOMPARE(changedSpy.at(0).at(0).toModelIndex().row(), 0);
+
+        catalog.removeStation(3);
+        QCOMPARE(view.stationIds(), QList<int>{ 1 });
+
+        // Usunięcie wielu stacji: rozproszone wiersze resetem, ciągły zakres sygnałem rowsRemoved
+        StationListModel batch;
+        for (int id = 1; id <= 6; ++id)
+            QVERIFY(batch.appendRecord(stationRecord(id, "Kraków", 50.0 + id * 0.01, 19.9)));
+        QVERIFY(batch.setSearched(3, true));
+        QVERIFY(batch.setSearched(4, true));
+        QVERIFY(batch.setSearched(6, true));
+        QSignalSpy resetSpy(&batch, &QAbstractItemModel::modelReset);
+        QSignalSpy removedSpy(&batch, &QAbstractItemModel::rowsRemoved);
+        QCOMPARE(batch.removeStations({ 4, 2, 99, 4 }), 2);
+        QCOMPARE(resetSpy.count(), 1);
+        QCOMPARE(batch.count(), 4);
+        QCOMPARE(batch.stationId(1), 3);
+        QCOMPARE(batch.rowOf(6), 3);
+        QVERIFY(batch.isSearched(1));
+        QVERIFY(!batch.isSearched(2));
+        QVERIFY(batch.isSearched(3));
+        QCOMPARE(batch.searchedCount(), 2);
+        QCOMPARE(batch.removeStations({ 6, 5 }), 2);
+        QCOMPARE(removedSpy.count(), 1);
+        QCOMPARE(removedSpy.first().at(1).toInt(), 2);
+        QCOMPARE(removedSpy.first().at(2).toInt(), 3);
+        QCOMPARE(batch.searchedCount(), 1);
+        QVERIFY(!batch.contains(5));
+        QCOMPARE(batch.removeStations({ 99 }), 0);
+
+        // Pula napisów nie rośnie przy kolejnych zmianach i usunięciach stacji
+        StationListModel pool;
+        QVERIFY(pool.appendRecord(stationRecord(1, "Gdańsk", 54.35, 18.65, "ul. Leczkowa")));
+        QVERIFY(pool.appendRecord(stationRecord(2, "Gdańsk", 54.38, 18.62, "ul. Wyzwolenia")));
+        const int strings = pool.internedStrings();
+        for (int i = 0; i < 20; ++i) {
+            QVERIFY(pool.replaceRecord(stationRecord(1, "Gdańsk", 54.35, 18.65, QString("ul. Nowa %1").arg(i))));
+            QCOMPARE(pool.internedStrings(), strings);
+            QVERIFY(pool.appendRecord(stationRecord(3, "Gdynia", 54.52, 18.53, "ul. Portowa")));
+            QVERIFY(pool.removeStation(3));
+            QCOMPARE(pool.internedStrings(), strings);
+        }
+        QCOMPARE(pool.address(0), QString("ul. Nowa 19"));
+        QCOMPARE(pool.address(1), QString("ul. Wyzwolenia"));
+        QCOMPARE(pool.cityName(1), QString("Gdańsk"));
+        QCOMPARE(pool.cityName(0).constData(), pool.cityName(1).constData());
     }
 
     /**
      * @brief Testuje centrum mapy.
      *
-     * Sprawdza, czy centrum mapy jest poprawnie ustawiane i zmieniane po wyszukiwaniu miasta.
+     * Sprawdza, czy centrum mapy jest poprawnie ustawiane i zmieniane po wyszukiwaniu miasta
+     * oraz czy spóźniona odpowiedź geokodowania nie nadpisuje późniejszego wyszukiwania lokalnego.
      */
     void testMapCenter()
     {
@@ -51,10 +338,42 @@ private slots:
         QCOMPARE(initial.latitude(), 52.4064); // Poznań, zgodnie z konstruktorem MainWindow
         QCOMPARE(initial.longitude(), 16.9252);
 
-        // Test wyszukiwania miasta wymaga mockowania odpowiedzi sieciowej, co jest bardziej złożone
-        // Na razie pomijamy zmianę centrum mapy, ponieważ wymaga to symulacji API
-        // mainWindow.searchCity("Krakow");
-        // QVERIFY(mainWindow.mapCenter().latitude() != 52.4064 || mainWindow.mapCenter().longitude() != 16.9252);
+        // Miasto z katalogu lokalnego serwera jest rozwiązywane bez zapytania do Nominatim
+        QTRY_VERIFY(mainWindow.allStations()->contains(kCatalogStations));
+        mainWindow.searchCity("Miasto 3");
+        QCOMPARE(mainWindow.stations()->count(), 4);
+        QVERIFY(mainWindow.mapCenter().latitude() != 52.4064 || mainWindow.mapCenter().longitude() != 16.9252);
+        QVERIFY(m_server.requests.filter("/search").isEmpty());
+
+        // Kolejne wyszukiwania nie tworzą obiektów stacji ani nie powiększają katalogu
+        const int children = mainWindow.children().size();
+        const int strings = mainWindow.allStations()->internedStrings();
+        for (int i = 0; i < 20; ++i)
+            mainWindow.searchCity(QString("Miasto %1").arg(3 + i % 2));
+        QCOMPARE(mainWindow.children().size(), children);
+        QCOMPARE(mainWindow.allStations()->internedStrings(), strings);
+        QCOMPARE(mainWindow.allStations()->searchedCount(), 4);
+
+        // Miasto spoza katalogu: geokodowanie i najbliższa stacja (wschodni skraj siatki)
+        m_server.setGeocode("Zakopane", 49.2992, 19.9496);
+        mainWindow.searchCity("Zakopane");
+        QTRY_VERIFY(mainWindow.status().startsWith("Nie znaleziono stacji w Zakopane."));
+        QCOMPARE(mainWindow.stations()->count(), 1);
+        QCOMPARE(mainWindow.mapCenter().longitude(), 14.9);
+
+        // Geokodowanie w toku jest unieważniane przez wyszukiwanie miasta z katalogu
+        m_server.responses["/search"].first().delayMs = 500;
+        const int geocodeRequests = m_server.requests.filter("/search").size();
+        mainWindow.searchCity("Zakopane");
+        QTRY_COMPARE(m_server.requests.filter("/search").size(), geocodeRequests + 1);
+        mainWindow.searchCity("Miasto 3");
+        const QGeoCoordinate localCenter = mainWindow.mapCenter();
+        const QString localStatus = mainWindow.status();
+        QTest::qWait(800);
+        QCOMPARE(mainWindow.stations()->count(), 4);
+        QCOMPARE(mainWindow.mapCenter(), localCenter);
+        QCOMPARE(mainWindow.status(), localStatus);
+        m_server.responses["/search"].first().delayMs = 0;
     }
 
     /**
@@ -65,49 +384,1868 @@ private slots:
     void testStationSearchStatus()
     {
         MainWindow mainWindow;
-        Station *station = new Station(2, "Test Station", "Test City", "Test Address", 50.0, 20.0, false, &mainWindow);
 
-        // Dodajemy stację do listy m_allStations, aby metoda updateStationSearchStatus mogła ją znaleźć
-        QMetaObject::invokeMethod(&mainWindow, "appendToAllStations", Q_ARG(Station*, station));
+        // Dodajemy stację do katalogu, aby metoda updateStationSearchStatus mogła ją znaleźć
+        StationListModel *catalog = mainWindow.allStations();
+        catalog->appendRecord(stationRecord(2, "Test City", 50.0, 20.0, "Test Address"));
 
         mainWindow.updateStationSearchStatus(2, true);
-        QCOMPARE(station->isSearched(), true);
+        QCOMPARE(catalog->isSearched(catalog->rowOf(2)), true);
         mainWindow.updateStationSearchStatus(2, false);
-        QCOMPARE(station->isSearched(), false);
+        QCOMPARE(catalog->isSearched(catalog->rowOf(2)), false);
+    }
+
+    /**
+     * @brief Testuje sygnały modelu listy stacji.
+     *
+     * Sprawdza, czy zmiana statusu wyszukiwania emituje dataChanged tylko dla zmienionego wiersza
+     * i tylko wtedy, gdy status faktycznie się zmienił.
+     */
+    void testStationListModelSignals()
+    {
+        StationListModel model;
+
+        QSignalSpy insertedSpy(&model, &QAbstractItemModel::rowsInserted);
+        model.appendRecord(stationRecord(1, "Poznań", 52.4, 16.9, "Polanka"));
+        model.appendRecord(stationRecord(2, "Poznań", 52.41, 16.88, "Dąbrowskiego"));
+        QCOMPARE(insertedSpy.count(), 2);
+        QCOMPARE(model.rowCount(), 2);
+        QCOMPARE(model.data(model.index(1), StationListModel::StationIdRole).toInt(), 2);
+
+        QSignalSpy changedSpy(&model, &QAbstractItemModel::dataChanged);
+        QVERIFY(model.setSearched(2, true));
+        QCOMPARE(changedSpy.count(), 1);
+        QCOMPARE(changedSpy.at(0).at(0).toModelIndex().row(), 1);
+
+        // Ponowne ustawienie tego samego statusu nie powinno emitować sygnału
+        QVERIFY(!model.setSearched(2, true));
+        QCOMPARE(changedSpy.count(), 1);
+
+        // Reset dotyczy wyłącznie wierszy, które były wyszukane
+        model.clearSearched();
+        QCOMPARE(changedSpy.count(), 2);
+        QCOMPARE(model.isSearched(1), false);
+    }
+
+    /**
+     * @brief Testuje zapytania indeksu przestrzennego.
+     *
+     * Porównuje wyniki wyszukiwania najbliższych stacji i stacji w promieniu
+     * z przeglądem wszystkich punktów.
+     */
+    void testSpatialIndexQueries()
+    {
+        QList<StationSpatialIndex::Point> points;
+        int id = 0;
+        for (double lat = 49.0; lat <= 54.8; lat += 0.37) {
+            for (double lon = 14.1; lon <= 24.1; lon += 0.53) {
+                points.append({ ++id, lat, lon });
+            }
+        }
+
+        StationSpatialIndex index;
+        index.build(points);
+        QCOMPARE(index.size(), points.size());
+
+        const double lat = 52.4064;
+        const double lon = 16.9252;
+
+        QList<StationDistance> bruteForce;
+        for (const StationSpatialIndex::Point &point : points)
+            bruteForce.append({ point.stationId, StationSpatialIndex::haversineKm(lat, lon, point.lat, point.lon) });
+        std::sort(bruteForce.begin(), bruteForce.end(), [](const StationDistance &a, const StationDistance &b) {
+            return a.distanceKm < b.distanceKm;
+        });
+
+        const QList<StationDistance> nearest = index.nearest(lat, lon, 5);
+        QCOMPARE(nearest.size(), 5);
+        for (int i = 0; i < nearest.size(); ++i)
+            QCOMPARE(nearest.at(i).distanceKm, bruteForce.at(i).distanceKm);
+
+        int expectedWithin = 0;
+        for (const StationDistance &entry : bruteForce) {
+            if (entry.distanceKm <= 25.0)
+                ++expectedWithin;
+        }
+        const QList<StationDistance> within = index.within(lat, lon, 25.0);
+        QCOMPARE(within.size(), expectedWithin);
+        for (const StationDistance &entry : within)
+            QVERIFY(entry.distanceKm <= 25.0);
+    }
+
+    /**
+     * @brief Testuje grupowanie stacji na mapie.
+     *
+     * Sprawdza, że każdy poziom przybliżenia obejmuje wszystkie stacje, grupa rozpada się
+     * na poziomie expansionZoom, a model znaczników zmienia wiersze tylko po wyjściu widoku
+     * poza obszar zapytania i zgłasza wyszukane stacje w grupach.
+     */
+    void testStationClustering()
+    {
+        QList<StationClusterIndex::Point> points;
+        int id = 0;
+        for (double lat = 49.0; lat <= 54.8; lat += 0.37) {
+            for (double lon = 14.1; lon <= 24.1; lon += 0.53)
+                points.append({ ++id, lat, lon });
+        }
+
+        StationClusterIndex index;
+        index.build(points);
+        QCOMPARE(index.size(), points.size());
+
+        int previousClusters = 0;
+        for (int zoom = 0; zoom <= index.maxZoom() + 1; ++zoom) {
+            const QList<StationCluster> clusters = index.clusters(-180, -85, 180, 85, zoom);
+            int stations = 0;
+            for (const StationCluster &cluster : clusters)
+                stations += cluster.count;
+            QCOMPARE(stations, points.size());
+            QVERIFY(clusters.size() >= previousClusters);
+            previousClusters = clusters.size();
+        }
+        QCOMPARE(index.clusters(-180, -85, 180, 85, 0).size(), 1);
+        QCOMPARE(previousClusters, points.size());
+
+        const QList<int> allIds = index.leaves(index.clusters(-180, -85, 180, 85, 0).first().clusterId);
+        QCOMPARE(allIds.size(), points.size());
+
+        StationCluster group;
+        for (const StationCluster &cluster : index.clusters(-180, -85, 180, 85, 6)) {
+            if (cluster.count > 1)
+                group = cluster;
+        }
+        QVERIFY(group.count > 1);
+        QCOMPARE(group.stationId, -1);
+        const QList<int> groupIds = index.leaves(group.clusterId);
+        const QSet<int> members(groupIds.cbegin(), groupIds.cend());
+        QCOMPARE(members.size(), group.count);
+        int parts = 0;
+        for (const StationCluster &cluster : index.clusters(-180, -85, 180, 85, group.expansionZoom)) {
+            if (members.contains(index.leaves(cluster.clusterId).first()))
+                ++parts;
+        }
+        QVERIFY(parts > 1);
+
+        StationListModel stations;
+        for (const StationClusterIndex::Point &point : std::as_const(points))
+            stations.appendRecord(stationRecord(point.stationId, "Miasto", point.lat, point.lon));
+        StationClusterModel model(&stations);
+        model.rebuild();
+
+        // Cały kraj na małym przybliżeniu: kilka grup obejmujących wszystkie stacje
+        model.setViewport(14.0, 49.0, 24.2, 54.9, 4.5);
+        QVERIFY(model.rowCount() > 1 && model.rowCount() < 20);
+        int covered = 0;
+        for (int row = 0; row < model.rowCount(); ++row)
+            covered += model.data(model.index(row), StationClusterModel::PointCountRole).toInt();
+        QCOMPARE(covered, points.size());
+
+        // Duże przybliżenie: pojedyncze stacje z danymi z modelu stacji
+        model.setViewport(16.5, 51.5, 17.5, 52.0, 12.0);
+        QVERIFY(model.rowCount() > 0);
+        for (int row = 0; row < model.rowCount(); ++row) {
+            QVERIFY(!model.data(model.index(row), StationClusterModel::IsClusterRole).toBool());
+            QCOMPARE(model.data(model.index(row), StationClusterModel::CityNameRole).toString(), QString("Miasto"));
+        }
+
+        // Przesunięcie w obrębie marginesu nie zmienia wierszy
+        QSignalSpy insertedSpy(&model, &QAbstractItemModel::rowsInserted);
+        QSignalSpy removedSpy(&model, &QAbstractItemModel::rowsRemoved);
+        model.setViewport(16.6, 51.55, 17.6, 52.05, 12.3);
+        QCOMPARE(insertedSpy.count(), 0);
+        QCOMPARE(removedSpy.count(), 0);
+
+        // Wyszukana stacja oznacza grupę, w której się znajduje
+        model.setViewport(14.0, 49.0, 24.2, 54.9, 4.5);
+        stations.setSearched(groupIds.first(), true);
+        QTRY_VERIFY([&]() {
+            for (int row = 0; row < model.rowCount(); ++row) {
+                if (model.data(model.index(row), StationClusterModel::IsSearchedRole).toBool())
+                    return true;
+            }
+            return false;
+        }());
+    }
+
+    /**
+     * @brief Testuje indeks jakości powietrza.
+     *
+     * Sprawdza granice indeksów cząstkowych obu skal, wybór najgorszego zanieczyszczenia
+     * z pominięciem nieaktualnych pomiarów oraz przyrostowe przeliczenie stacji po nowym
+     * pomiarze sensora i oznaczenie grupy znaczników najgorszym poziomem jej stacji.
+     */
+    void testAirQualityIndex()
+    {
+        QCOMPARE(AirQualityIndex::subIndex(AirQualityIndex::Polish, "PM10", 20.0), 0);
+        QCOMPARE(AirQualityIndex::subIndex(AirQualityIndex::Polish, "PM10", 20.1), 1);
+        QCOMPARE(AirQualityIndex::subIndex(AirQualityIndex::Polish, "pm2.5", 120.0), 5);
+        QCOMPARE(AirQualityIndex::subIndex(AirQualityIndex::Caqi, "NO2", 150.0), 2);
+        QCOMPARE(AirQualityIndex::subIndex(AirQualityIndex::Caqi, "O3", 500.0), 4);
+        QCOMPARE(AirQualityIndex::subIndex(AirQualityIndex::Polish, "CO", 1.0), -1);
+        QCOMPARE(AirQualityIndex::subIndex(AirQualityIndex::Polish, "SO2", -1.0), -1);
+
+        // Najgorszy aktualny indeks cząstkowy decyduje; stary pomiar NO2 jest pomijany
+        const qint64 hour = 1745503200;
+        StationAirQuality station;
+        station.readings["PM10"] = { hour, 60.0 };
+        station.readings["O3"] = { hour - 3600, 30.0 };
+        station.readings["NO2"] = { hour - 5 * 3600, 300.0 };
+        AirQualityIndex::evaluate(AirQualityIndex::Polish, station);
+        QCOMPARE(station.level, 2);
+        QCOMPARE(station.pollutant, QString("PM10"));
+        QCOMPARE(station.timestamp, hour);
+
+        ApiClient apiClient;
+        ReplyParser parser;
+        AirQualityIndex airQuality(&apiClient, &parser);
+        QVERIFY(!airQuality.isEnabled());
+        airQuality.setStations({ 1, 2 });
+        airQuality.setSensors(1, { { 11, "pył zawieszony PM10", "PM10" }, { 12, "benzen", "C6H6" } });
+        airQuality.setSensors(2, { { 21, "dwutlenek azotu", "NO2" } });
+
+        QSignalSpy levelsSpy(&airQuality, &AirQualityIndex::levelsChanged);
+        SensorSeries pm10;
+        pm10.append(hour - 3600, 40.0);
+        pm10.append(hour, 0.0, true);
+        airQuality.updateSensor(11, pm10);
+        airQuality.updateSensor(12, pm10);
+        SensorSeries no2;
+        no2.append(hour, 250.0);
+        airQuality.updateSensor(21, no2);
+        QTRY_COMPARE(levelsSpy.count(), 1);
+        QCOMPARE(airQuality.level(1), 1);
+        QCOMPARE(airQuality.level(2), 4);
+        QCOMPARE(airQuality.ratedStations(), 2);
+        QCOMPARE(airQuality.stationIndex(2).value("pollutant").toString(), QString("NO2"));
+
+        // Ten sam pomiar nie przelicza stacji
+        airQuality.updateSensor(11, pm10);
+        QTest::qWait(10);
+        QCOMPARE(levelsSpy.count(), 1);
+
+        airQuality.setScale(AirQualityIndex::Caqi);
+        QCOMPARE(airQuality.level(2), 3);
+        QCOMPARE(airQuality.legend().size(), 5);
+
+        // Grupa dwóch bliskich stacji ma najgorszy poziom
+        StationListModel stations;
+        stations.appendRecord(stationRecord(1, "Miasto", 52.40, 16.90));
+        stations.appendRecord(stationRecord(2, "Miasto", 52.41, 16.91));
+        StationClusterModel model(&stations);
+        model.setAirQuality(&airQuality);
+        model.rebuild();
+        model.setViewport(14.0, 49.0, 24.2, 54.9, 5.0);
+        QCOMPARE(model.rowCount(), 1);
+        QCOMPARE(model.data(model.index(0), StationClusterModel::AqiLevelRole).toInt(), 3);
+
+        airQuality.setStations({ 1 });
+        QCOMPARE(airQuality.ratedStations(), 1);
+        QTRY_COMPARE(model.data(model.index(0), StationClusterModel::AqiLevelRole).toInt(), 1);
+    }
+
+    /**
+     * @brief Testuje interpolację pomiarów i pole stężeń.
+     *
+     * Sprawdza metody IDW i krigingu (wartość w punkcie pomiaru, odtworzenie pola stałego,
+     * brak wartości poza zasięgiem stacji), podział siatki na kafelki oraz przeliczanie pola
+     * po nowych pomiarach z użyciem pamięci podręcznej.
+     */
+    void testPollutantRaster()
+    {
+        const QList<FieldSample> samples = {
+            { 1, 52.40, 16.90, 10.0 },
+            { 2, 52.23, 21.01, 90.0 },
+            { 3, 50.06, 19.94, 40.0 }
+        };
+        InverseDistanceInterpolator idw;
+        idw.prepare(samples);
+        QCOMPARE(idw.estimate(52.40, 16.90), 10.0);
+        const double between = idw.estimate(52.35, 17.50);
+        QVERIFY(between > 10.0 && between < 90.0);
+        QVERIFY(qIsNaN(idw.estimate(54.9, 23.9)));
+
+        KrigingInterpolator kriging;
+        kriging.prepare({ { 1, 52.40, 16.90, 25.0 }, { 2, 52.50, 17.30, 25.0 }, { 3, 52.10, 17.10, 25.0 } });
+        QVERIFY(qAbs(kriging.estimate(52.30, 17.05) - 25.0) < 1e-6);
+        kriging.prepare(samples);
+        QVERIFY(qAbs(kriging.estimate(52.23, 21.01) - 90.0) < 20.0);
+        QVERIFY(qIsNaN(kriging.estimate(54.9, 23.9)));
+
+        const RasterGrid grid = RasterGrid::cover(14.0, 49.0, 24.2, 55.0, 5, 16);
+        int cells = 0;
+        for (int tile = 0; tile < grid.tileCount(); ++tile)
+            cells += grid.tileRect(tile).width() * grid.tileRect(tile).height();
+        QCOMPARE(cells, grid.width * grid.height);
+        QVERIFY(qAbs(grid.rowLat(0) - 55.0) < 0.5);
+
+        const QSharedPointer<PollutantRaster> raster = PollutantRasterEngine::compute(
+            "PM10", 0, PollutantRasterEngine::InverseDistance, AirQualityIndex::Polish, samples, grid);
+        QCOMPARE(raster->sampleCount, samples.size());
+        QVERIFY(qAbs(raster->valueAt(52.40, 16.90) - 10.0) < 10.0);
+        QVERIFY(qIsNaN(raster->valueAt(54.9, 23.9)));
+        QVERIFY(std::any_of(raster->tiles.cbegin(), raster->tiles.cend(), [](const QImage &image) { return !image.isNull(); }));
+        QVERIFY(std::any_of(raster->tiles.cbegin(), raster->tiles.cend(), [](const QImage &image) { return image.isNull(); }));
+
+        // Pole z pomiarów indeksu jakości powietrza
+        StationListModel stations;
+        for (const FieldSample &sample : samples)
+            stations.appendRecord(stationRecord(sample.stationId, "Miasto", sample.lat, sample.lon));
+        ApiClient apiClient;
+        ReplyParser parser;
+        AirQualityIndex airQuality(&apiClient, &parser);
+        airQuality.setStations({ 1, 2, 3 });
+        const qint64 hour = 1745503200;
+        for (const FieldSample &sample : samples) {
+            airQuality.setSensors(sample.stationId, { { sample.stationId * 10, "pył zawieszony PM10", "PM10" } });
+            SensorSeries series;
+            series.append(hour, sample.value);
+            airQuality.updateSensor(sample.stationId * 10, series);
+        }
+        QTRY_COMPARE(airQuality.ratedStations(), 3);
+
+        PollutantRasterEngine engine(&airQuality, &stations);
+        QVERIFY(engine.tiles().isEmpty());
+        engine.setParameter("PM10");
+        QTRY_VERIFY(engine.raster() && !engine.isBusy());
+        QCOMPARE(engine.sampleCount(), 3);
+        QCOMPARE(engine.raster()->hour, hour);
+        const QVariantList tiles = engine.tiles();
+        QVERIFY(!tiles.isEmpty());
+        const QString source = tiles.first().toMap().value("source").toString();
+        QVERIFY(!engine.tileImage(source.mid(QString("image://pollution/").size())).isNull());
+
+        // Powrót do parametru z tej samej godziny korzysta z pamięci podręcznej
+        const QSharedPointer<const PollutantRaster> first = engine.raster();
+        engine.setParameter("");
+        QVERIFY(engine.tiles().isEmpty());
+        engine.setParameter("PM10");
+        QCOMPARE(engine.raster(), first);
+        QVERIFY(!engine.isBusy());
+        QCOMPARE(engine.cachedRasters(), 1);
+
+        // Nowy pomiar z tej samej godziny przelicza pole
+        SensorSeries corrected;
+        corrected.append(hour, 150.0);
+        airQuality.updateSensor(10, corrected);
+        QTRY_VERIFY(engine.raster() != first && !engine.isBusy());
+        QVERIFY(engine.valueAt(52.40, 16.90) > first->valueAt(52.40, 16.90));
+        QCOMPARE(engine.cachedRasters(), 1);
+    }
+
+    /**
+     * @brief Testuje porównanie stacji dla jednego parametru.
+     *
+     * Sprawdza wyrównanie pomiarów do siatki godzinowej (pomiary spoza siatki i puste są
+     * pomijane), kolumny podsumowania, ranking, średnią godzinową oraz porównanie na lokalnym
+     * serwerze: pobranie tylko sensora parametru i ponowne porównanie bez pobierania pomiarów,
+     * gdy historia ma już bieżącą godzinę, oraz pominięcie odpowiedzi przerwanego porównania.
+     */
+    void testStationComparison()
+    {
+        const qint64 start = SensorSeries::parseTimestamp("2025-04-24 00:00:00");
+        ComparisonInput first;
+        first.stationId = 1;
+        first.sensorId = 11;
+        first.series.append(start - 3600, 500.0);
+        first.series.append(start, 10.0);
+        first.series.append(start + 3600, 60.0);
+        first.series.append(start + 7200, 0.0, true);
+        first.series.append(start + 3 * 3600, 20.0);
+        first.series.append(start + 6 * 3600, 99.0);
+        ComparisonInput second;
+        second.stationId = 2;
+        second.sensorId = 12;
+        second.series.append(start + 3600, 30.0);
+        second.series.append(start + 5 * 3600, 50.0);
+        ComparisonInput missing;
+        missing.stationId = 3;
+
+        const QSharedPointer<ComparisonMatrix> matrix =
+            StationComparison::build("PM10", { first, second, missing }, start, 6);
+        QCOMPARE(matrix->values.size(), 18);
+        QCOMPARE(matrix->value(0, 0), 10.0);
+        QCOMPARE(matrix->value(0, 1), 60.0);
+        QVERIFY(qIsNaN(matrix->value(0, 2)));
+        QVERIFY(qIsNaN(matrix->value(0, 6)));
+        QVERIFY(qIsNaN(matrix->value(2, 0)));
+
+        const ComparisonSummary &a = matrix->rows.at(0);
+        QCOMPARE(a.coverage, 3);
+        QCOMPARE(a.mean, 30.0);
+        QCOMPARE(a.min, 10.0);
+        QCOMPARE(a.max, 60.0);
+        QCOMPARE(a.latest, 20.0);
+        QCOMPARE(a.exceedances, 1);
+        QCOMPARE(a.rank, 2);
+        const ComparisonSummary &b = matrix->rows.at(1);
+        QCOMPARE(b.mean, 40.0);
+        QCOMPARE(b.exceedances, 0);
+        QCOMPARE(b.rank, 1);
+        QCOMPARE(matrix->rows.at(2).coverage, 0);
+        QCOMPARE(matrix->rows.at(2).rank, 0);
+        QVERIFY(qIsNaN(matrix->rows.at(2).mean));
+        QCOMPARE(matrix->hourlyMean.at(1), 45.0);
+        QVERIFY(qIsNaN(matrix->hourlyMean.at(2)));
+        QCOMPARE(matrix->hourlyMean.at(5), 50.0);
+
+        // Siatka kończy się na bieżącej godzinie pomiarowej
+        const qint64 hour = StationMonitor::currentMeasurementHour(QDateTime::currentDateTimeUtc());
+        m_server.responses["/station/sensors/9114"] = { { 200, R"([
+            {"id":93575,"param":{"paramName":"pył zawieszony PM10","paramCode":"PM10"}},
+            {"id":93576,"param":{"paramName":"dwutlenek azotu","paramCode":"NO2"}}])" } };
+        m_server.responses["/station/sensors/9117"] = { { 200,
+            R"([{"id":93580,"param":{"paramName":"dwutlenek azotu","paramCode":"NO2"}}])" } };
+        m_server.responses["/data/getData/93575"] = { { 200, QString(R"({"key":"PM10","values":[
+            {"date":"%1","value":21.5},{"date":"%2","value":19.25}]})")
+            .arg(SensorSeries::formatTimestamp(hour), SensorSeries::formatTimestamp(hour - 3600)).toUtf8() } };
+
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        ApiClient apiClient;
+        HistoryStore history(dir.filePath("history"));
+        StationListModel stations;
+        stations.appendRecord(stationRecord(9114, "Wrocław", 51.1, 17.1));
+        stations.appendRecord(stationRecord(9117, "Poznań", 52.4, 16.9));
+        ReplyParser parser;
+        StationComparison comparison(&apiClient, &parser, &history, &stations);
+        QSignalSpy resultSpy(&comparison, &StationComparison::resultChanged);
+        comparison.compare("pm10", { 9114, 9117, 9114 }, 24);
+        QVERIFY(comparison.isBusy());
+        QVERIFY(resultSpy.wait(10000));
+        QVERIFY(!comparison.isBusy());
+        QCOMPARE(comparison.rowCount(), 2);
+        QCOMPARE(comparison.hours(), 24);
+        QCOMPARE(comparison.value(0, 23), 21.5);
+        QCOMPARE(comparison.value(0, 22), 19.25);
+        QCOMPARE(history.lastTimestamp(93575), hour);
+        QVERIFY(!m_server.requests.contains("/data/getData/93576"));
+        const QVariantList summary = comparison.summary();
+        QCOMPARE(summary.size(), 2);
+        QCOMPARE(summary.at(0).toMap()["stationName"].toString(), QString("Stacja 9114"));
+        QCOMPARE(summary.at(0).toMap()["rank"].toInt(), 1);
+        QCOMPARE(summary.at(1).toMap()["sensorId"].toInt(), 0);
+        QCOMPARE(comparison.rowValues(0).size(), 24);
+
+        const int dataRequests = m_server.requests.count("/data/getData/93575");
+        comparison.compare("PM10", { 9114 }, 24);
+        QVERIFY(resultSpy.wait(10000));
+        QCOMPARE(comparison.rowCount(), 1);
+        QCOMPARE(comparison.value(0, 23), 21.5);
+        QCOMPARE(m_server.requests.count("/data/getData/93575"), dataRequests);
+
+        // Odpowiedzi przerwanego porównania nie trafiają do nowego
+        comparison.compare("NO2", { 9114, 9117 }, 24);
+        comparison.compare("PM10", { 9114 }, 24);
+        QVERIFY(resultSpy.wait(10000));
+        QTest::qWait(200);
+        QCOMPARE(comparison.paramCode(), QString("PM10"));
+        QCOMPARE(comparison.rowCount(), 1);
+        QVERIFY(!comparison.isBusy());
+    }
+
+    /**
+     * @brief Testuje indeks tekstowy katalogu stacji.
+     *
+     * Sprawdza normalizację znaków diakrytycznych, dopasowanie miasta i podpowiedzi po prefiksie.
+     */
+    void testSearchIndex()
+    {
+        QCOMPARE(StationSearchIndex::fold(QString::fromUtf8("Łódź")), QString("lodz"));
+        QCOMPARE(StationSearchIndex::fold(QString::fromUtf8("  Bielsko-Biała ")), QString("bielsko biala"));
+
+        StationSearchIndex index;
+        index.build({
+            { 1, QString::fromUtf8("Łódź, ul. Czernika"), QString::fromUtf8("Łódź"), QString::fromUtf8("ul. Czernika 1/3") },
+            { 2, QString::fromUtf8("Łódź, ul. Gdańska"), QString::fromUtf8("Łódź"), QString::fromUtf8("ul. Gdańska 16") },
+            { 3, QString::fromUtf8("Poznań, ul. Polanka"), QString::fromUtf8("Poznań"), QString::fromUtf8("ul. Polanka") }
+        });
+
+        QCOMPARE(index.stationsInCity("LODZ"), QList<int>({ 1, 2 }));
+        QVERIFY(index.stationsInCity("Lublin").isEmpty());
+
+        const QVariantList cities = index.suggest("lo", 5);
+        QVERIFY(!cities.isEmpty());
+        QCOMPARE(cities.first().toMap()["kind"].toString(), QString("city"));
+        QCOMPARE(cities.first().toMap()["stationCount"].toInt(), 2);
+
+        const QVariantList streets = index.suggest("polan", 5);
+        QVERIFY(!streets.isEmpty());
+        QCOMPARE(streets.first().toMap()["stationId"].toInt(), 3);
+    }
+
+    /**
+     * @brief Testuje pamięć podręczną odpowiedzi i czasy ważności zasobów.
+     *
+     * Sprawdza zapis i odczyt wpisu oraz czas ważności katalogu stacji i pomiarów.
+     */
+    void testResponseCache()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+
+        ResponseCache cache(dir.path());
+        const QUrl url("https://api.gios.gov.pl/pjp-api/rest/data/getData/92");
+        QVERIFY(!cache.load(url).isValid());
+
+        CacheEntry entry;
+        entry.body = "{\"key\":\"PM10\"}";
+        entry.etag = "\"abc\"";
+        entry.storedAt = QDateTime::currentDateTimeUtc();
+        entry.expiresAt = entry.storedAt.addSecs(60);
+        QVERIFY(cache.store(url, entry));
+
+        const CacheEntry loaded = cache.load(url);
+        QVERIFY(loaded.isFresh(QDateTime::currentDateTimeUtc()));
+        QCOMPARE(loaded.body, entry.body);
+        QCOMPARE(loaded.etag, entry.etag);
+        QVERIFY(!cache.load(QUrl("https://api.gios.gov.pl/pjp-api/rest/data/getData/93")).isValid());
+
+        const QDateTime now(QDate(2025, 4, 24), QTime(14, 25, 30), QTimeZone::utc());
+        QCOMPARE(ApiClient::ttlForUrl(url, now), qint64(44 * 60 + 30));
+        QCOMPARE(ApiClient::ttlForUrl(url, QDateTime(QDate(2025, 4, 24), QTime(14, 4), QTimeZone::utc())), qint64(6 * 60));
+        QCOMPARE(ApiClient::ttlForUrl(QUrl("https://api.gios.gov.pl/pjp-api/rest/station/findAll"), now), qint64(3 * 24 * 3600));
+        QCOMPARE(ApiClient::ttlForUrl(QUrl("https://nominatim.openstreetmap.org/search"), now), qint64(0));
+    }
+
+    /**
+     * @brief Testuje migawkę katalogu stacji.
+     *
+     * Sprawdza zapis i odczyt rekordów (w tym polskich znaków) oraz odrzucenie uszkodzonego pliku.
+     */
+    void testStationSnapshot()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString path = dir.filePath("stations.snapshot");
+
+        QList<StationRecord> records;
+        StationRecord record;
+        record.stationId = 944;
+        record.stationName = "Poznań, ul. Polanka";
+        record.cityName = "Poznań";
+        record.address = "ul. Polanka";
+        record.lat = 52.420319;
+        record.lon = 16.953046;
+        records.append(record);
+        record.stationId = 117;
+        record.stationName = "Łódź, ul. Czernika";
+        record.cityName = "Łódź";
+        record.address = "ul. Czernika 1/3";
+        record.lat = 51.75948;
+        record.lon = 19.529911;
+        records.append(record);
+
+        QVERIFY(StationSnapshot::save(path, records));
+
+        QList<StationRecord> loaded;
+        QVERIFY(StationSnapshot::load(path, loaded));
+        QCOMPARE(loaded.size(), records.size());
+        QVERIFY(loaded == records);
+
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write("uszkodzony");
+        file.close();
+        QVERIFY(!StationSnapshot::load(path, loaded));
+        QVERIFY(!StationSnapshot::load(dir.filePath("brak.snapshot"), loaded));
+    }
+
+    /**
+     * @brief Testuje indeks plików archiwalnych.
+     *
+     * Sprawdza wyszukiwanie pliku po stacji i dacie, dopisywanie zapisu oraz to,
+     * że plik o niezmienionym rozmiarze i czasie modyfikacji nie jest ponownie parsowany.
+     */
+    void testArchiveManifest()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+
+        auto writeArchive = [&dir](const QString &fileName, int stationId, const QString &saveDate) {
+            QJsonObject jsonObj;
+            jsonObj["stationId"] = stationId;
+            jsonObj["cityName"] = "Poznań";
+            jsonObj["address"] = "ul. Polanka";
+            jsonObj["saveDate"] = saveDate;
+            QFile file(dir.filePath(fileName));
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            file.write(QJsonDocument(jsonObj).toJson());
+        };
+        writeArchive("station_944_20250420_120000.json", 944, "2025-04-20T12:00:00");
+        writeArchive("station_944_20250421_080000.json", 944, "2025-04-21T08:00:00");
+
+        ArchiveManifest manifest(dir.path());
+        manifest.load();
+        QCOMPARE(manifest.entries().size(), 2);
+        QCOMPARE(manifest.filePath(944, "2025-04-21T08:00:00"), dir.filePath("station_944_20250421_080000.json"));
+        QVERIFY(manifest.filePath(944, "2025-04-22T08:00:00").isEmpty());
+        QVERIFY(QFile::exists(manifest.manifestPath()));
+
+        QSignalSpy spy(&manifest, &ArchiveManifest::entriesChanged);
+        writeArchive("station_117_20250419_100000.json", 117, "2025-04-19T10:00:00");
+        ArchiveEntry entry;
+        entry.fileName = "station_117_20250419_100000.json";
+        entry.stationId = 117;
+        entry.saveDate = "2025-04-19T10:00:00";
+        manifest.insert(entry);
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(manifest.entries().first().stationId, 117);
+        QVERIFY(!manifest.rescan());
+
+        // Nadpisanie treści przy zachowaniu rozmiaru i czasu modyfikacji: nowy indeks korzysta z zapisanych nagłówków
+        const QString path = dir.filePath("station_944_20250420_120000.json");
+        const QDateTime modified = QFileInfo(path).lastModified();
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        const qint64 size = file.size();
+        file.seek(0);
+        file.write(QByteArray(size, ' '));
+        QVERIFY(file.setFileTime(modified, QFileDevice::FileModificationTime));
+        file.close();
+
+        ArchiveManifest reloaded(dir.path());
+        reloaded.load();
+        QCOMPARE(reloaded.entries().size(), 3);
+        QCOMPARE(reloaded.filePath(944, "2025-04-20T12:00:00"), path);
+
+        QVERIFY(QFile::remove(dir.filePath("station_944_20250421_080000.json")));
+        QVERIFY(reloaded.rescan());
+        QCOMPARE(reloaded.entries().size(), 2);
+    }
+
+    /**
+     * @brief Testuje zwarty format binarny plików archiwalnych.
+     *
+     * Sprawdza bezstratną konwersję JSON -> binarny -> JSON (w tym puste pomiary,
+     * nieregularne odstępy i wartości niecałkowite) oraz rozmiar pliku binarnego.
+     */
+    void testStationArchive()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+
+        StationArchiveData data;
+        data.stationId = 515;
+        data.stationName = "Poznań, ul. Dąbrowskiego";
+        data.cityName = "Poznań";
+        data.address = "ul. Dąbrowskiego 169";
+        data.lat = 52.420319;
+        data.lon = 16.877289;
+        data.saveDate = "2025-04-24T14:29:35";
+
+        const qint64 start = SensorSeries::parseTimestamp("2025-04-21 01:00:00");
+        for (int s = 0; s < 3; ++s) {
+            ArchivedSensor sensor;
+            sensor.sensorId = 3000 + s;
+            sensor.paramName = "pył zawieszony PM10";
+            sensor.paramCode = "PM10";
+            for (int i = 0; i < 96; ++i) {
+                const qint64 timestamp = start + i * 3600 + (i == 50 ? 7200 : 0);
+                sensor.series.append(timestamp, 20.0 + (i % 7) * 1.5 + s * 0.1, i % 17 == 5);
+            }
+            data.sensors.append(sensor);
+        }
+
+        const QString jsonPath = dir.filePath("station_515_20250424_142935.json");
+        const QString binaryPath = dir.filePath("station_515_20250424_142935.gar");
+        const QString exportPath = dir.filePath("export.json");
+        QVERIFY(StationArchive::save(jsonPath, data));
+        QVERIFY(StationArchive::convert(jsonPath, binaryPath));
+        QVERIFY(StationArchive::convert(binaryPath, exportPath));
+
+        StationArchiveData loaded;
+        QVERIFY(StationArchive::load(binaryPath, loaded));
+        QCOMPARE(loaded.stationName, data.stationName);
+        QCOMPARE(loaded.saveDate, data.saveDate);
+        QCOMPARE(loaded.sensors.size(), 3);
+        for (int s = 0; s < 3; ++s) {
+            const SensorSeries &expected = data.sensors.at(s).series;
+            const SensorSeries &actual = loaded.sensors.at(s).series;
+            QCOMPARE(actual.timestamps(), expected.timestamps());
+            QCOMPARE(actual.values(), expected.values());
+            QCOMPARE(actual.nullMask(), expected.nullMask());
+        }
+        QCOMPARE(StationArchive::toJson(StationArchive::fromJson(StationArchive::toJson(loaded))),
+                 StationArchive::toJson(data));
+
+        QFile jsonFile(jsonPath);
+        QFile exportFile(exportPath);
+        QVERIFY(jsonFile.open(QIODevice::ReadOnly));
+        QVERIFY(exportFile.open(QIODevice::ReadOnly));
+        QCOMPARE(exportFile.readAll(), jsonFile.readAll());
+        QVERIFY(QFileInfo(binaryPath).size() * 10 < QFileInfo(jsonPath).size());
+
+        StationArchiveData header;
+        QVERIFY(StationArchive::loadHeader(binaryPath, header));
+        QCOMPARE(header.stationId, 515);
+        QVERIFY(header.sensors.isEmpty());
+
+        // Obcięty plik nie może zostać wczytany
+        const QByteArray encoded = StationArchive::encode(data);
+        QVERIFY(!StationArchive::decode(encoded.constData(), encoded.size() - 8, loaded));
+    }
+
+    /**
+     * @brief Testuje historię pomiarów sensorów.
+     *
+     * Sprawdza, że nakładające się zapisy dopisują tylko nowe pomiary, poprawki zastępują
+     * wcześniejsze wartości, a zapytanie obejmuje dane z kilku miesięcy.
+     */
+    void testHistoryStore()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        HistoryStore history(dir.path());
+
+        const qint64 start = SensorSeries::parseTimestamp("2025-03-30 00:00:00");
+        auto window = [start](int firstHour, int hours, int correctedHour) {
+            SensorSeries series;
+            for (int i = firstHour; i < firstHour + hours; ++i)
+                series.append(start + i * 3600, i == correctedHour ? 99.0 : i * 0.5);
+            return series;
+        };
+
+        HistoryMergeResult result = history.merge(7, window(0, 72, -1));
+        QCOMPARE(result.appended, 72);
+        QCOMPARE(history.lastTimestamp(7), start + 71 * 3600);
+
+        // Kolejny zapis: 24 nowe godziny i jedna poprawiona wartość
+        result = history.merge(7, window(24, 72, 30));
+        QCOMPARE(result.appended, 24);
+        QCOMPARE(result.corrected, 1);
+        QCOMPARE(result.unchanged, 47);
+
+        const SensorSeries all = history.query(7, start, start + 200 * 3600);
+        QCOMPARE(all.size(), 96);
+        QCOMPARE(all.value(30), 99.0);
+        QCOMPARE(all.value(95), 47.5);
+        QVERIFY(std::is_sorted(all.timestamps().cbegin(), all.timestamps().cend()));
+
+        const SensorSeries april = history.query(7, SensorSeries::parseTimestamp("2025-04-01 00:00:00"),
+                                                 SensorSeries::parseTimestamp("2025-04-01 23:00:00"));
+        QCOMPARE(april.size(), 24);
+        QCOMPARE(april.timestamp(0), start + 48 * 3600);
+
+        QCOMPARE(history.compact(7), 1);
+        HistoryStore reopened(dir.path());
+        QCOMPARE(reopened.sensorIds(), QList<int>({ 7 }));
+        QCOMPARE(reopened.lastTimestamp(7), start + 95 * 3600);
+        QCOMPARE(reopened.query(7, start, start + 200 * 3600).values(), all.values());
+    }
+
+    /**
+     * @brief Testuje parsowanie odpowiedzi w wątkach roboczych.
+     *
+     * Sprawdza, że wynik jest odczytany poprawnie i trafia do odbiorcy w wątku GUI.
+     */
+    void testReplyParser()
+    {
+        const QByteArray body = R"({"key":"PM10","values":[
+            {"date":"2025-04-21 03:00:00","value":null},
+            {"date":"2025-04-21 02:00:00","value":21.5},
+            {"date":"2025-04-21 01:00:00","value":19.25}]})";
+
+        ReplyParser parser;
+        QThread *receiverThread = nullptr;
+        SensorDataResult received;
+        connect(&parser, &ReplyParser::sensorDataParsed, this, [&](const SensorDataResult &result) {
+            receiverThread = QThread::currentThread();
+            received = result;
+        });
+
+        QSignalSpy spy(&parser, &ReplyParser::sensorDataParsed);
+        parser.parseSensorData(body, 42);
+        QVERIFY(spy.wait(5000));
+        QTRY_COMPARE(received.sensorId, 42);
+        QCOMPARE(receiverThread, QThread::currentThread());
+        QCOMPARE(received.series.size(), 3);
+        QCOMPARE(received.series.value(0), 19.25);
+        QVERIFY(received.series.isNull(2));
+
+        const QList<SensorInfo> sensors = ReplyParser::sensorsFromJson(
+            R"([{"id":3575,"param":{"paramName":"pył zawieszony PM10","paramCode":"PM10"}}])");
+        QCOMPARE(sensors.size(), 1);
+        QCOMPARE(sensors.first().sensorId, 3575);
+        QCOMPARE(sensors.first().paramCode, QString("PM10"));
+        QVERIFY(ReplyParser::stationsFromJson("niepoprawny JSON").isEmpty());
+    }
+
+    /**
+     * @brief Testuje strumieniowe parsowanie odpowiedzi.
+     *
+     * Sprawdza, że podział treści na fragmenty w dowolnym miejscu daje ten sam wynik,
+     * a urwana treść pomiarów jest oznaczana jako niepełna.
+     */
+    void testStreamingParser()
+    {
+        const QByteArray catalog = R"([
+            {"id":114,"stationName":"Wroc\u0142aw - Bartnicza","gegrLat":"51.115933","gegrLon":"17.141125",
+             "city":{"id":1064,"name":"Wrocław","commune":{"communeName":"Wrocław","name":"ignorowane"}},
+             "addressStreet":"ul. Bartnicza"},
+            {"id":117,"stationName":"Poznań \"Dąbrowskiego\"","gegrLat":52.420319,"gegrLon":16.877289,
+             "city":{"name":"Poznań"},"addressStreet":null}])";
+
+        // Fragmenty po 5 bajtów dzielą klucze, liczby, sekwencje ucieczki i znaki UTF-8
+        StationCatalogStream stream;
+        QList<StationRecord> streamed;
+        int batches = 0;
+        for (qsizetype offset = 0; offset < catalog.size(); offset += 5) {
+            QVERIFY(stream.feed(catalog.mid(offset, 5)));
+            const QList<StationRecord> completed = stream.takeCompleted();
+            if (!completed.isEmpty()) {
+                ++batches;
+                streamed += completed;
+            }
+        }
+        QVERIFY(stream.finish());
+        QCOMPARE(batches, 2);
+        QCOMPARE(streamed, stream.records());
+        QCOMPARE(streamed.size(), 2);
+        QCOMPARE(streamed[0].stationName, QString("Wrocław - Bartnicza"));
+        QCOMPARE(streamed[0].cityName, QString("Wrocław"));
+        QCOMPARE(streamed[0].lat, 51.115933);
+        QCOMPARE(streamed[1].stationName, QString("Poznań \"Dąbrowskiego\""));
+        QCOMPARE(streamed[1].lon, 16.877289);
+        QVERIFY(streamed[1].address.isEmpty());
+        QCOMPARE(ReplyParser::stationsFromJson(catalog), streamed);
+
+        bool complete = true;
+        QCOMPARE(ReplyParser::stationsFromJson(catalog.left(catalog.size() - 20), &complete).size(), 1);
+        QVERIFY(!complete);
+
+        // Strumień w wątku parsera: stacje przychodzą przed końcem odpowiedzi
+        ReplyParser parser;
+        QSignalSpy streamedSpy(&parser, &ReplyParser::stationsStreamed);
+        QSignalSpy parsedSpy(&parser, &ReplyParser::stationsParsed);
+        const qsizetype firstEnd = catalog.indexOf("Bartnicza\"}") + 11;
+        const quint64 streamId = parser.beginStations();
+        parser.feed(streamId, catalog.left(firstEnd));
+        QVERIFY(streamedSpy.wait(5000));
+        QCOMPARE(parsedSpy.count(), 0);
+        parser.feed(streamId, catalog.mid(firstEnd));
+        parser.finish(streamId, false);
+        QVERIFY(parsedSpy.wait(5000));
+        QCOMPARE(streamedSpy.count(), 2);
+        const StationCatalogResult result = parsedSpy.first().first().value<StationCatalogResult>();
+        QVERIFY(result.complete);
+        QCOMPARE(result.records, streamed);
+
+        QSignalSpy dataSpy(&parser, &ReplyParser::sensorDataParsed);
+        const quint64 dataStream = parser.beginSensorData(7);
+        parser.feed(dataStream, R"({"key":"PM10","values":[{"date":"2025-04-21 02:00:00","va)");
+        parser.feed(dataStream, R"(lue":null},{"date":"2025-04-21 01:00:00","value":1.5e1}]})");
+        parser.finish(dataStream, false);
+        QVERIFY(dataSpy.wait(5000));
+        const SensorDataResult data = dataSpy.first().first().value<SensorDataResult>();
+        QVERIFY(data.complete);
+        QCOMPARE(data.sensorId, 7);
+        QCOMPARE(data.series.size(), 2);
+        QCOMPARE(data.series.value(0), 15.0);
+        QVERIFY(data.series.isNull(1));
+
+        // Urwana treść daje szereg oznaczony jako niepełny
+        const quint64 truncatedStream = parser.beginSensorData(8);
+        parser.feed(truncatedStream, R"({"key":"PM10","values":[{"date":"2025-04-21 02:00:00","va)");
+        parser.finish(truncatedStream, false);
+        QVERIFY(dataSpy.wait(5000));
+        const SensorDataResult truncated = dataSpy.last().first().value<SensorDataResult>();
+        QCOMPARE(truncated.sensorId, 8);
+        QVERIFY(!truncated.complete);
+        bool ok = true;
+        ReplyParser::seriesFromJson(R"({"key":"PM10","values":[)", &ok);
+        QVERIFY(!ok);
+    }
+
+    /**
+     * @brief Testuje kolejkę żądań na lokalnym serwerze.
+     *
+     * Sprawdza ponowienie po 503, kolejność priorytetów przy jednym wolnym miejscu,
+     * unieważnienie grupy oraz limit częstości kubełka żetonów.
+     */
+    void testRequestScheduler()
+    {
+        QVERIFY(RequestScheduler::retryDelayMs(0, 100, 5000, 0.0) == 50);
+        QVERIFY(RequestScheduler::retryDelayMs(2, 100, 5000, 0.99) < 400);
+        QCOMPARE(RequestScheduler::retryDelayMs(20, 100, 5000, 0.0), 2500);
+        QVERIFY(RequestScheduler::isRetriable(QNetworkReply::UnknownContentError, 503));
+        QVERIFY(RequestScheduler::isRetriable(QNetworkReply::ConnectionRefusedError, 0));
+        QVERIFY(!RequestScheduler::isRetriable(QNetworkReply::ContentNotFoundError, 404));
+        QVERIFY(!RequestScheduler::isRetriable(QNetworkReply::OperationCanceledError, 0));
+
+        StubHttpServer server;
+        server.responses["/flaky"] = {{503, "{}"}, {200, "ok"}};
+        server.responses["/a"] = {{200, "a"}};
+        server.responses["/b"] = {{200, "b"}};
+        server.responses["/c"] = {{200, "c"}};
+        server.responses["/d"] = {{200, "d"}};
+        server.held = {"/slow"};
+
+        QNetworkAccessManager manager;
+        RequestScheduler scheduler(&manager);
+        scheduler.setRetryPolicy(3, 10, 50);
+        HostPolicy policy;
+        policy.ratePerSecond = 1000.0;
+        policy.burst = 10;
+        policy.maxConcurrent = 1;
+        scheduler.setHostPolicy("127.0.0.1", policy);
+
+        // Ponowienie po błędzie przejściowym
+        QByteArray flakyBody;
+        bool flakyDone = false;
+        scheduler.submit(QNetworkRequest(server.url("/flaky")), RequestOptions(), nullptr,
+                         [&](QNetworkReply *reply, bool cancelled) {
+            QVERIFY(!cancelled);
+            flakyBody = reply->readAll();
+            flakyDone = true;
+        });
+        QTRY_VERIFY_WITH_TIMEOUT(flakyDone, 5000);
+        QCOMPARE(flakyBody, QByteArray("ok"));
+        QCOMPARE(server.requests.count("/flaky"), 2);
+
+        // Jedno wolne miejsce: po pierwszym żądaniu kolejne według priorytetów
+        server.requests.clear();
+        int finished = 0;
+        const auto count = [&](QNetworkReply *, bool) { ++finished; };
+        RequestOptions background;
+        background.priority = RequestPriority::Background;
+        RequestOptions prefetch;
+        prefetch.priority = RequestPriority::Prefetch;
+        scheduler.submit(QNetworkRequest(server.url("/a")), background, nullptr, count);
+        scheduler.submit(QNetworkRequest(server.url("/b")), background, nullptr, count);
+        scheduler.submit(QNetworkRequest(server.url("/c")), prefetch, nullptr, count);
+        scheduler.submit(QNetworkRequest(server.url("/d")), RequestOptions(), nullptr, count);
+        QTRY_COMPARE_WITH_TIMEOUT(finished, 4, 5000);
+        QCOMPARE(server.requests, QStringList({"/a", "/d", "/c", "/b"}));
+
+        // Unieważnienie grupy przerywa trwające i usuwa oczekujące żądania
+        RequestOptions station;
+        station.group = "station";
+        int cancelledCount = 0;
+        const auto onCancel = [&](QNetworkReply *, bool cancelled) { cancelledCount += cancelled ? 1 : 0; };
+        scheduler.submit(QNetworkRequest(server.url("/slow")), station, nullptr, onCancel);
+        scheduler.submit(QNetworkRequest(server.url("/a")), station, nullptr, onCancel);
+        QTRY_VERIFY_WITH_TIMEOUT(server.requests.contains("/slow"), 5000);
+        QCOMPARE(scheduler.runningCount(), 1);
+        QCOMPARE(scheduler.pendingCount(), 1);
+        scheduler.cancelGroup("station");
+        QCOMPARE(cancelledCount, 2);
+        QCOMPARE(scheduler.runningCount(), 0);
+        QCOMPARE(scheduler.pendingCount(), 0);
+        QCOMPARE(scheduler.generation("station"), quint64(1));
+
+        // Kubełek z jednym żetonem i 10 żądaniami na sekundę
+        policy.ratePerSecond = 10.0;
+        policy.burst = 1;
+        policy.maxConcurrent = 4;
+        scheduler.setHostPolicy("127.0.0.1", policy);
+        finished = 0;
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < 3; ++i)
+            scheduler.submit(QNetworkRequest(server.url("/a")), RequestOptions(), nullptr, count);
+        QTRY_COMPARE_WITH_TIMEOUT(finished, 3, 5000);
+        QVERIFY(timer.elapsed() >= 180);
     }
 
     /**
      * @brief Testuje dane sensorów.
      *
-     * Sprawdza, czy dane sensorów są poprawnie ustawiane, usuwane i zwracane.
+     * Sprawdza, czy dane sensorów są poprawnie ustawiane, usuwane i zwracane,
+     * w tym porządkowanie punktów według czasu i obsługę pustych pomiarów.
      */
     void testSensorData()
     {
         MainWindow mainWindow;
-        QVariantMap sensorData;
-        sensorData["test"] = QVariantList{ QVariantMap{{"date", "2025-04-22"}, {"value", 10.0}} };
-        mainWindow.setSensorData(sensorData);
-        QCOMPARE(mainWindow.sensorData().size(), 1);
-        QVERIFY(mainWindow.sensorData().contains("test"));
+        SensorSeriesStore *store = mainWindow.sensorSeries();
+
+        bool ok = false;
+        const qint64 midnight = SensorSeries::parseTimestamp("2025-04-22 00:00:00", &ok);
+        QVERIFY(ok);
+        QCOMPARE(midnight, QDateTime(QDate(2025, 4, 22), QTime(0, 0), QTimeZone::utc()).toSecsSinceEpoch());
+        QCOMPARE(SensorSeries::formatTimestamp(midnight + 3600), QString("2025-04-22 01:00:00"));
+        SensorSeries::parseTimestamp("brak daty", &ok);
+        QVERIFY(!ok);
+
+        // Daty spoza kalendarza są odrzucane, a nie przenoszone na kolejny miesiąc
+        SensorSeries::parseTimestamp("2025-02-30 10:00:00", &ok);
+        QVERIFY(!ok);
+        SensorSeries::parseTimestamp("2025-02-29 10:00:00", &ok);
+        QVERIFY(!ok);
+        SensorSeries::parseTimestamp("2025-04-31 10:00:00", &ok);
+        QVERIFY(!ok);
+        SensorSeries::parseTimestamp("2025-04-22 10:00:60", &ok);
+        QVERIFY(!ok);
+        QCOMPARE(SensorSeries::parseTimestamp("2024-02-29 10:00:00", &ok),
+                 QDateTime(QDate(2024, 2, 29), QTime(10, 0), QTimeZone::utc()).toSecsSinceEpoch());
+        QVERIFY(ok);
+
+        // Kolejność jak w API GIOŚ: od najnowszego pomiaru
+        SensorSeries series;
+        series.append(midnight + 7200, 0.0, true);
+        series.append(midnight + 3600, 12.5);
+        series.append(midnight, 10.0);
+        series.sortByTime();
+        QCOMPARE(series.size(), 3);
+        QCOMPARE(series.timestamp(0), midnight);
+        QCOMPARE(series.value(1), 12.5);
+        QVERIFY(series.isNull(2));
+
+        QSignalSpy changedSpy(store, &SensorSeriesStore::seriesChanged);
+        store->setSeries(3, series);
+        QCOMPARE(changedSpy.count(), 1);
+        QCOMPARE(store->size(3), 3);
+        QVERIFY(qIsNaN(store->values(3).at(2)));
+        QCOMPARE(store->latestValue(3), 12.5);
+        QCOMPARE(store->latestDate(3), QString("2025-04-22 01:00:00"));
 
         mainWindow.removeSensorData(999);
-        QCOMPARE(mainWindow.sensorData().size(), 1);
+        QCOMPARE(store->sensorIds().size(), 1);
 
-        mainWindow.setSensorData(QVariantMap());
-        QCOMPARE(mainWindow.sensorData().size(), 0);
+        mainWindow.removeSensorData(3);
+        QVERIFY(!store->contains(3));
+        QCOMPARE(store->size(3), 0);
+    }
+
+    /**
+     * @brief Testuje ustawianie szeregów wielu sensorów jedną zmianą.
+     */
+    void testSeriesBatch()
+    {
+        SensorSeriesStore store;
+        SensorSeries first;
+        first.append(1000, 5.0);
+        SensorSeries second;
+        second.append(1000, 7.0);
+        second.append(4600, 0.0, true);
+
+        QHash<int, SensorSeries> batch;
+        batch.insert(1, first);
+        batch.insert(2, second);
+
+        QSignalSpy changedSpy(&store, &SensorSeriesStore::seriesChanged);
+        QSignalSpy batchSpy(&store, &SensorSeriesStore::seriesBatchChanged);
+        QSignalSpy revisionSpy(&store, &SensorSeriesStore::revisionChanged);
+        store.setSeriesBatch(std::move(batch));
+
+        // Jedna zmiana widoku dla całej partii
+        QCOMPARE(changedSpy.count(), 0);
+        QCOMPARE(batchSpy.count(), 1);
+        QCOMPARE(revisionSpy.count(), 1);
+        QList<int> changed = batchSpy.first().first().value<QList<int>>();
+        std::sort(changed.begin(), changed.end());
+        QCOMPARE(changed, QList<int>({1, 2}));
+        QCOMPARE(store.size(2), 2);
+        QCOMPARE(store.latestValue(1), 5.0);
+
+        store.setSeriesBatch(QHash<int, SensorSeries>());
+        QCOMPARE(revisionSpy.count(), 1);
+    }
+
+    /**
+     * @brief Testuje monitor obserwowanych stacji.
+     *
+     * Sprawdza łączenie szeregu z nowszą odpowiedzią, sygnały tylko dla zmienionych
+     * szeregów, godzinę wybudzenia, wybór nieaktualnych sensorów i zapis listy stacji.
+     */
+    void testStationMonitor()
+    {
+        const qint64 hour = SensorSeries::parseTimestamp("2025-04-24 12:00:00");
+        SensorSeries base;
+        base.append(hour, 10.0);
+        base.append(hour + 3600, 11.0);
+        base.append(hour + 7200, 0.0, true);
+
+        // Pusty pomiar nie zastępuje wartości, uzupełniony i nowy są liczone jako zmiany
+        SensorSeries update;
+        update.append(hour + 3600, 0.0, true);
+        update.append(hour + 7200, 12.0);
+        update.append(hour + 10800, 0.0, true);
+        int changed = -1;
+        const SensorSeries merged = SensorSeries::merged(base, update, &changed);
+        QCOMPARE(changed, 2);
+        QCOMPARE(merged.size(), 4);
+        QCOMPARE(merged.value(1), 11.0);
+        QCOMPARE(merged.value(2), 12.0);
+        QVERIFY(!merged.isNull(2));
+        QVERIFY(merged.isNull(3));
+
+        SensorSeriesStore store;
+        store.setSeries(7, base);
+        QSignalSpy changedSpy(&store, &SensorSeriesStore::seriesChanged);
+        QCOMPARE(store.mergeSeries(7, update), 2);
+        QCOMPARE(store.mergeSeries(7, update), 0);
+        QCOMPARE(store.mergeSeries(8, update), 0);
+        QCOMPARE(changedSpy.count(), 1);
+        QCOMPARE(store.size(7), 4);
+        QCOMPARE(store.latestValue(7), 12.0);
+
+        const QDateTime now(QDate(2025, 4, 24), QTime(14, 25), QTimeZone::utc());
+        QCOMPARE(StationMonitor::nextWakeUp(now, 10), QDateTime(QDate(2025, 4, 24), QTime(15, 10), QTimeZone::utc()));
+        QCOMPARE(StationMonitor::nextWakeUp(now, 30), QDateTime(QDate(2025, 4, 24), QTime(14, 30), QTimeZone::utc()));
+        if (QTimeZone("Europe/Warsaw").isValid()) {
+            // 12:25 UTC to 14:25 czasu letniego w Polsce
+            const QDateTime utc(QDate(2025, 4, 24), QTime(12, 25), QTimeZone::utc());
+            QCOMPARE(StationMonitor::currentMeasurementHour(utc), SensorSeries::parseTimestamp("2025-04-24 14:00:00"));
+        }
+        QVERIFY(StationMonitor::isStale(-1, hour));
+        QVERIFY(StationMonitor::isStale(hour - 3600, hour));
+        QVERIFY(!StationMonitor::isStale(hour, hour));
+
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        ApiClient apiClient;
+        ReplyParser parser;
+        HistoryStore history(dir.filePath("history"));
+        const QString path = dir.filePath("watchlist.json");
+        {
+            StationMonitor monitor(&apiClient, &parser, &history, &store, path);
+            QSignalSpy watchSpy(&monitor, &StationMonitor::watchListChanged);
+            monitor.watch(117);
+            monitor.watch(114);
+            monitor.watch(114);
+            monitor.unwatch(999);
+            QCOMPARE(watchSpy.count(), 2);
+            QVERIFY(monitor.isWatched(114));
+            QVERIFY(!monitor.isEnabled());
+            QVERIFY(!monitor.isBusy());
+        }
+        StationMonitor reloaded(&apiClient, &parser, &history, &store, path);
+        QCOMPARE(reloaded.watchedStations(), QList<int>({114, 117}));
+        QVERIFY(!reloaded.isEnabled());
+        reloaded.unwatch(117);
+        QCOMPARE(reloaded.watchedStations(), QList<int>({114}));
+    }
+
+    /**
+     * @brief Testuje wspólną kolejkę pobierania sensorów i pomiarów na lokalnym serwerze.
+     *
+     * Sprawdza pobranie listy sensorów i pomiarów, kolejki korzystające z jednego parsera,
+     * pominięcie wyniku żądania unieważnionego w cancelAll() (także dla tego samego sensora
+     * pobieranego ponownie), pomiary z pamięci podręcznej po odpowiedzi 304 oraz błąd
+     * niepełnej treści.
+     */
+    void testStationFetchQueue()
+    {
+        m_server.responses["/station/sensors/9301"] = { { 200,
+            R"([{"id":93011,"param":{"paramName":"pył zawieszony PM10","paramCode":"PM10"}}])" } };
+        const QByteArray body = R"({"key":"PM10","values":[{"date":"2025-04-21 02:00:00","value":21.5}]})";
+        m_server.responses["/data/getData/93011"] = { { 200, body } };
+        m_server.responses["/data/getData/93012"] = { { 200, R"({"key":"PM10","values":[{"date":)" } };
+
+        ApiClient apiClient;
+        ReplyParser parser;
+        StationFetchQueue queue(&apiClient, &parser, RequestOptions{ RequestPriority::Background, "fetch-test" }, 1);
+        StationFetchQueue other(&apiClient, &parser, RequestOptions{ RequestPriority::Background, "fetch-other" }, 1);
+        QSignalSpy sensorsSpy(&queue, &StationFetchQueue::sensorsReady);
+        QSignalSpy dataSpy(&queue, &StationFetchQueue::sensorDataReady);
+        QSignalSpy failedSpy(&queue, &StationFetchQueue::failed);
+        QSignalSpy drainedSpy(&queue, &StationFetchQueue::drained);
+        QSignalSpy otherSpy(&other, &StationFetchQueue::sensorDataReady);
+        connect(&queue, &StationFetchQueue::sensorsReady, this, [&queue](int stationId, const QList<SensorInfo> &sensors) {
+            for (const SensorInfo &sensor : sensors)
+                queue.enqueueSensor(stationId, sensor.sensorId);
+        });
+
+        queue.enqueueStation(9301);
+        queue.enqueueStation(9301);
+        QVERIFY(queue.isBusy());
+        QVERIFY(drainedSpy.wait(10000));
+        QCOMPARE(sensorsSpy.count(), 1);
+        QCOMPARE(dataSpy.count(), 1);
+        QCOMPARE(dataSpy.first().at(0).toInt(), 9301);
+        QCOMPARE(dataSpy.first().at(1).toInt(), 93011);
+        QCOMPARE(dataSpy.first().at(2).value<SensorSeries>().size(), 1);
+        QCOMPARE(otherSpy.count(), 0);
+
+        // Wynik żądania sprzed cancelAll() nie jest przyjmowany, choć sensor jest znów w kolejce
+        const quint64 cancelledRequest = parser.nextRequestId() + 1;
+        queue.enqueueSensor(9301, 93011);
+        queue.cancelAll();
+        QVERIFY(!queue.isBusy());
+        queue.enqueueSensor(9301, 93011);
+        SensorDataResult stale;
+        stale.requestId = cancelledRequest;
+        stale.sensorId = 93011;
+        emit parser.sensorDataParsed(stale);
+        QCOMPARE(dataSpy.count(), 1);
+        QVERIFY(drainedSpy.wait(10000));
+        QCOMPARE(dataSpy.count(), 2);
+        QCOMPARE(dataSpy.last().at(2).value<SensorSeries>().size(), 1);
+
+        // Odpowiedź 304 dla nieaktualnego wpisu daje pomiary z pamięci podręcznej
+        const QUrl dataUrl = m_server.url("/data/getData/93011");
+        CacheEntry entry = apiClient.cache().load(dataUrl);
+        QVERIFY(entry.isValid());
+        entry.etag = "\"93011\"";
+        entry.expiresAt = QDateTime::currentDateTimeUtc().addSecs(-60);
+        QVERIFY(apiClient.cache().store(dataUrl, entry));
+        m_server.responses["/data/getData/93011"] = { { 304, QByteArray() } };
+        queue.enqueueSensor(9301, 93011);
+        QVERIFY(drainedSpy.wait(10000));
+        QCOMPARE(dataSpy.count(), 3);
+        QCOMPARE(dataSpy.last().at(2).value<SensorSeries>().size(), 1);
+
+        // Niepełna treść kończy zadanie błędem bez pomiarów
+        queue.enqueueSensor(9301, 93012);
+        QVERIFY(drainedSpy.wait(10000));
+        QCOMPARE(dataSpy.count(), 3);
+        QCOMPARE(failedSpy.count(), 1);
+        QCOMPARE(failedSpy.first().at(1).toInt(), 93012);
+        QCOMPARE(otherSpy.count(), 0);
     }
 
-private:
     /**
-     * @brief Dodaje stację do listy m_allStations w MainWindow.
+     * @brief Testuje zbieranie danych bez interfejsu na lokalnym serwerze.
      *
-     * Używa QMetaObject::invokeMethod, aby uzyskać dostęp do prywatnej listy m_allStations.
-     * @param mainWindow Wskaźnik do obiektu MainWindow.
-     * @param station Wskaźnik do stacji do dodania.
+     * Sprawdza zapis pliku archiwalnego i historii, błąd jednej stacji (kod wyjścia 2),
+     * przebieg ograniczony do wybranych stacji (kod wyjścia 0) oraz katalog i pomiary z odpowiedzi 304.
      */
-    void appendToAllStations(MainWindow *mainWindow, Station *station) {
-        QMetaObject::invokeMethod(mainWindow, "appendToAllStations", Q_ARG(Station*, station));
+    void testHarvester()
+    {
+        StubHttpServer server;
+        server.responses["/station/findAll"] = { { 200, R"([
+            {"id":114,"stationName":"Wrocław - Bartnicza","gegrLat":"51.115933","gegrLon":"17.141125",
+             "city":{"name":"Wrocław"},"addressStreet":"ul. Bartnicza"},
+            {"id":117,"stationName":"Poznań - Dąbrowskiego","gegrLat":"52.420319","gegrLon":"16.877289",
+             "city":{"name":"Poznań"},"addressStreet":null}])" } };
+        server.responses["/station/sensors/114"] = { { 200,
+            R"([{"id":3575,"param":{"paramName":"pył zawieszony PM10","paramCode":"PM10"}}])" } };
+        server.responses["/station/sensors/117"] = { { 404, "{}" } };
+        server.responses["/data/getData/3575"] = { { 200, R"({"key":"PM10","values":[
+            {"date":"2025-04-21 02:00:00","value":21.5},{"date":"2025-04-21 01:00:00","value":19.25}]})" } };
+
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        HarvestOptions options;
+        options.outputDirectory = dir.path();
+        options.apiBaseUrl = server.url("").toString();
+
+        Harvester harvester(options);
+        QSignalSpy progressSpy(&harvester, &Harvester::progress);
+        QSignalSpy finishedSpy(&harvester, &Harvester::finished);
+        harvester.start();
+        QVERIFY(finishedSpy.wait(10000));
+        QCOMPARE(finishedSpy.first().first().toInt(), int(Harvester::PartialFailure));
+        QCOMPARE(progressSpy.count(), 2);
+        QCOMPARE(harvester.summary().stations, 2);
+        QCOMPARE(harvester.summary().savedStations, 1);
+        QCOMPARE(harvester.summary().failedStations, 1);
+        QCOMPARE(harvester.summary().measurements, 2);
+        QCOMPARE(harvester.summary().appended, 2);
+
+        const QStringList files = QDir(dir.path()).entryList({ "station_114_*.gar" });
+        QCOMPARE(files.size(), 1);
+        StationArchiveData data;
+        QVERIFY(StationArchive::load(QDir(dir.path()).filePath(files.first()), data));
+        QCOMPARE(data.cityName, QString("Wrocław"));
+        QCOMPARE(data.sensors.size(), 1);
+        QCOMPARE(data.sensors.first().series.size(), 2);
+        HistoryStore history(QDir(dir.path()).filePath("history"));
+        QCOMPARE(history.lastTimestamp(3575), SensorSeries::parseTimestamp("2025-04-21 02:00:00"));
+
+        options.stationIds = { 114 };
+        Harvester selected(options);
+        QSignalSpy selectedSpy(&selected, &Harvester::finished);
+        selected.start();
+        QVERIFY(selectedSpy.wait(10000));
+        QCOMPARE(selectedSpy.first().first().toInt(), int(Harvester::Success));
+        QCOMPARE(selected.summary().appended, 0);
+
+        // Odpowiedź 304 dla nieaktualnego wpisu katalogu wczytuje katalog z pamięci podręcznej
+        Harvester revalidated(options);
+        const QUrl catalogUrl = server.url("/station/findAll");
+        CacheEntry stale = revalidated.apiClient()->cache().load(catalogUrl);
+        QVERIFY(stale.isValid());
+        stale.etag = "\"catalog\"";
+        stale.expiresAt = QDateTime::currentDateTimeUtc().addSecs(-60);
+        QVERIFY(revalidated.apiClient()->cache().store(catalogUrl, stale));
+        server.responses["/station/findAll"] = { { 304, QByteArray() } };
+        const int catalogRequests = server.requests.count("/station/findAll");
+        QSignalSpy revalidatedSpy(&revalidated, &Harvester::finished);
+        revalidated.start();
+        QVERIFY(revalidatedSpy.wait(10000));
+        QCOMPARE(server.requests.count("/station/findAll"), catalogRequests + 1);
+        QCOMPARE(revalidatedSpy.first().first().toInt(), int(Harvester::Success));
+        QCOMPARE(revalidated.summary().stations, 1);
+        QCOMPARE(revalidated.summary().savedStations, 1);
+
+        // Odpowiedź 304 dla pomiarów sensora obsługuje wspólna kolejka pobierania
+        Harvester unchanged(options);
+        const QUrl dataUrl = server.url("/data/getData/3575");
+        CacheEntry staleData = unchanged.apiClient()->cache().load(dataUrl);
+        QVERIFY(staleData.isValid());
+        staleData.etag = "\"data\"";
+        staleData.expiresAt = QDateTime::currentDateTimeUtc().addSecs(-60);
+        QVERIFY(unchanged.apiClient()->cache().store(dataUrl, staleData));
+        server.responses["/data/getData/3575"] = { { 304, QByteArray() } };
+        QSignalSpy unchangedSpy(&unchanged, &Harvester::finished);
+        unchanged.start();
+        QVERIFY(unchangedSpy.wait(10000));
+        QCOMPARE(unchangedSpy.first().first().toInt(), int(Harvester::Success));
+        QCOMPARE(unchanged.summary().sensors, 1);
+        QCOMPARE(unchanged.summary().measurements, 2);
     }
+
+    /**
+     * @brief Testuje pobieranie danych stacji z lokalnego serwera odtwarzającego zapisany plik.
+     *
+     * Sprawdza, czy pomiary wszystkich sensorów trafiają do widoku mimo opóźnionych odpowiedzi,
+     * a zerwane połączenie jednego sensora nie blokuje pozostałych.
+     */
+    void testStationReplay()
+    {
+        const QString fixture = QFINDTESTDATA("testdata/station_515_20250424_142935.json");
+        StationArchiveData data;
+        QVERIFY(StationArchive::load(fixture, data));
+        QVERIFY(m_server.replayArchive(fixture));
+        m_server.responses["/data/getData/3486"].first().delayMs = 300;
+        m_server.responses["/data/getData/3502"] = { { 200, QByteArray(), 0, true } };
+
+        MainWindow mainWindow;
+        SensorSeriesStore *store = mainWindow.sensorSeries();
+        mainWindow.fetchStationData(515);
+        QTRY_COMPARE(mainWindow.sensors().size(), data.sensors.size());
+        for (const ArchivedSensor &sensor : std::as_const(data.sensors)) {
+            if (sensor.sensorId == 3502)
+                continue;
+            QTRY_VERIFY_WITH_TIMEOUT(store->contains(sensor.sensorId), 10000);
+            QCOMPARE(store->size(sensor.sensorId), sensor.series.size());
+            QCOMPARE(store->latestDate(sensor.sensorId),
+                     SensorSeries::formatTimestamp(sensor.series.timestamp(sensor.series.size() - 1)));
+        }
+        QVERIFY(m_server.requests.contains("/data/getData/3502"));
+    }
+
+    /**
+     * @brief Testuje ponowne otwarcie stacji w trakcie pobierania i parsowania pomiarów.
+     *
+     * Sprawdza, czy spóźniony wynik parsowania poprzedniego otwarcia nie zwalnia sensora,
+     * który jest nadal pobierany, czy szereg czekający na wspólną zmianę magazynu nie jest
+     * pobierany drugi raz oraz czy ponownie otwarta stacja dostaje pomiary wszystkich sensorów.
+     */
+    void testStationReopen()
+    {
+        const QByteArray body = R"({"key":"PM10","values":[{"date":"2025-04-21 02:00:00","value":21.5}]})";
+        m_server.responses["/station/sensors/7001"] = { { 200, R"([
+            {"id":70011,"param":{"paramName":"pył zawieszony PM10","paramCode":"PM10"}},
+            {"id":70012,"param":{"paramName":"dwutlenek azotu","paramCode":"NO2"}}])" } };
+        m_server.responses["/data/getData/70011"] = { { 200, body, 1000 } };
+        m_server.responses["/data/getData/70012"] = { { 200, body } };
+        ResponseCache cache;
+        cache.remove(QUrl(ApiClient::giosApiUrl() + "/data/getData/70011"));
+        cache.remove(QUrl(ApiClient::giosApiUrl() + "/data/getData/70012"));
+
+        MainWindow mainWindow;
+        SensorSeriesStore *store = mainWindow.sensorSeries();
+        ReplyParser *parser = mainWindow.findChild<ReplyParser*>("parser");
+        QVERIFY(parser);
+        mainWindow.fetchStationData(7001);
+        QTRY_VERIFY(m_server.requests.contains("/data/getData/70011"));
+        const int firstRequests = m_server.requests.count("/data/getData/70011");
+
+        // Wynik z nieaktualnym numerem żądania nie kończy trwającego pobierania
+        SensorDataResult stale;
+        stale.requestId = 0;
+        stale.sensorId = 70011;
+        emit parser->sensorDataParsed(stale);
+        mainWindow.fetchSensorData(70011);
+        QTest::qWait(200);
+        QCOMPARE(m_server.requests.count("/data/getData/70011"), firstRequests);
+        QVERIFY(!store->contains(70011));
+
+        // Szereg odczytany, ale czekający na zakończenie pozostałych żądań, nie jest pobierany ponownie
+        QCOMPARE(m_server.requests.count("/data/getData/70012"), 1);
+        QVERIFY(!store->contains(70012));
+        mainWindow.fetchSensorData(70012);
+        QTest::qWait(100);
+        QCOMPARE(m_server.requests.count("/data/getData/70012"), 1);
+
+        // Ponowne otwarcie pobiera sensor od nowa, choć poprzednie żądanie jeszcze trwało
+        mainWindow.fetchStationData(7001);
+        emit parser->sensorDataParsed(stale);
+        QTRY_VERIFY_WITH_TIMEOUT(store->contains(70011), 10000);
+        QTRY_VERIFY(store->contains(70012));
+        QCOMPARE(store->size(70011), 1);
+        QVERIFY(m_server.requests.count("/data/getData/70011") > firstRequests);
+    }
+
+    /**
+     * @brief Testuje rejestr metryk i jego eksport.
+     *
+     * Sprawdza liczbę pomiarów i percentyle histogramu, skumulowane przedziały w formacie
+     * Prometheus oraz zliczanie emisji sygnałów przez SignalCounter.
+     */
+    void testMetricsRegistry()
+    {
+        MetricsRegistry &registry = MetricsRegistry::instance();
+        for (int i = 1; i <= 100; ++i)
+            registry.observe("test_duration_ms", "op=probe", i);
+        registry.add("test_total", "op=probe", 3);
+        QCOMPARE(registry.observations("test_duration_ms", "op=probe"), 100);
+        QCOMPARE(registry.counter("test_total", "op=probe"), 3);
+
+        QVariantMap histogram;
+        const QVariantList histograms = registry.toVariant().value("histograms").toList();
+        for (const QVariant &entry : histograms) {
+            if (entry.toMap().value("name") == "test_duration_ms")
+                histogram = entry.toMap();
+        }
+        QCOMPARE(histogram.value("count").toLongLong(), 100);
+        QCOMPARE(histogram.value("maxMs").toDouble(), 100.0);
+        QCOMPARE(histogram.value("meanMs").toDouble(), 50.5);
+        QVERIFY(histogram.value("p50Ms").toDouble() > 25 && histogram.value("p50Ms").toDouble() <= 50);
+        QVERIFY(histogram.value("p95Ms").toDouble() > 50 && histogram.value("p95Ms").toDouble() <= 100);
+
+        const QByteArray text = registry.toPrometheus();
+        QVERIFY(text.contains("# TYPE test_duration_ms histogram\n"));
+        QVERIFY(text.contains("test_duration_ms_bucket{op=\"probe\",le=\"10\"} 10\n"));
+        QVERIFY(text.contains("test_duration_ms_bucket{op=\"probe\",le=\"+Inf\"} 100\n"));
+        QVERIFY(text.contains("test_duration_ms_count{op=\"probe\"} 100\n"));
+        QVERIFY(text.contains("# TYPE test_total counter\ntest_total{op=\"probe\"} 3\n"));
+
+        SensorSeriesStore store;
+        store.setObjectName("probe");
+        new SignalCounter(&store);
+        const QString label = "signal=SensorSeriesStore::seriesChanged,object=probe";
+        const qint64 before = registry.counter("gios_signal_emissions_total", label);
+        store.setSeries(1, SensorSeries());
+        store.setSeries(2, SensorSeries());
+        QCOMPARE(registry.counter("gios_signal_emissions_total", label), before + 2);
+    }
+
+    /**
+     * @brief Testuje statystyki szeregu i ich unieważnianie.
+     *
+     * Sprawdza wartości skrajne, średnią, percentyle, przekroczenia (dni według reguły parametru,
+     * w tym średniej ośmiogodzinnej kroczącej dla CO) i pomijanie pustych pomiarów.
+     */
+    void testSensorStatistics()
+    {
+        const qint64 start = SensorSeries::parseTimestamp("2025-04-20 00:00:00");
+        SensorSeries series;
+        for (int i = 0; i < 100; ++i)
+            series.append(start + i * 3600, i + 1);
+        series.append(start + 100 * 3600, 0.0, true);
+
+        const SensorStatistics stats = SensorStatistics::compute(series, 90.0);
+        QCOMPARE(stats.count, 100);
+        QCOMPARE(stats.nullCount, 1);
+        QCOMPARE(stats.min, 1.0);
+        QCOMPARE(stats.max, 100.0);
+        QCOMPARE(stats.mean, 50.5);
+        QVERIFY(qAbs(stats.stddev - 28.8661) < 1e-3);
+        QCOMPARE(stats.p50, 50.5);
+        QVERIFY(qAbs(stats.p95 - 95.05) < 1e-9);
+        QCOMPARE(stats.exceedances, 10);
+        QCOMPARE(stats.days, 5);
+        QCOMPARE(stats.exceedanceDays, 1);
+        // Norma godzinowa: liczą się też dni ze średnią poniżej normy, ale z godziną powyżej
+        QCOMPARE(SensorStatistics::compute(series, 90.0, SensorStatistics::AnyHour).exceedanceDays, 2);
+        QCOMPARE(SensorStatistics::dayRuleForParam("no2"), SensorStatistics::AnyHour);
+        QCOMPARE(SensorStatistics::dayRuleForParam("PM10"), SensorStatistics::DailyMean);
+
+        // CO: pojedyncza godzina powyżej normy nie przekracza normy ośmiogodzinnej, osiem godzin tak
+        SensorSeries carbonMonoxide;
+        for (int i = 0; i < 48; ++i)
+            carbonMonoxide.append(start + i * 3600, i == 5 ? 15000.0 : i >= 30 && i < 38 ? 12000.0 : 1000.0);
+        QCOMPARE(SensorStatistics::dayRuleForParam("co"), SensorStatistics::RunningMean8h);
+        QCOMPARE(SensorStatistics::compute(carbonMonoxide, 10000.0, SensorStatistics::RunningMean8h).exceedanceDays, 1);
+        QCOMPARE(SensorStatistics::compute(carbonMonoxide, 10000.0, SensorStatistics::AnyHour).exceedanceDays, 2);
+        QCOMPARE(SensorStatistics::compute(series, 24, 48, 90.0).mean, 36.5);
+        QVERIFY(qIsNaN(SensorStatistics::thresholdForParam("XYZ")));
+
+        SensorSeriesStore store;
+        store.setExceedanceThreshold(7, SensorStatistics::thresholdForParam("PM10"));
+        store.setSeries(7, series);
+        QCOMPARE(store.statistics(7)["exceedances"].toInt(), 50);
+
+        SensorSeries shorter;
+        shorter.append(start, 60.0);
+        store.setSeries(7, shorter);
+        QCOMPARE(store.statistics(7)["count"].toInt(), 1);
+        QCOMPARE(store.statistics(8)["count"].toInt(), 0);
+    }
+
+    /**
+     * @brief Testuje zapytania o przedział czasu i agregaty dobowe i miesięczne.
+     *
+     * Sprawdza agregaty na granicy miesięcy, pomijanie pustych pomiarów, wybór rozdzielczości
+     * i zgodność agregatów przeliczonych przyrostowo po mergeSeries() z pełną przebudową.
+     */
+    void testSeriesRollup()
+    {
+        const qint64 start = SensorSeries::parseTimestamp("2025-01-30 00:00:00");
+        SensorSeries series;
+        for (int i = 0; i < 72; ++i)
+            series.append(start + i * 3600, i, i == 5);
+
+        SensorSeriesStore store;
+        store.setSeries(1, series);
+        const qint64 end = start + 71 * 3600;
+
+        const QVector<SeriesBucket> days = store.querySeries(1, start, end, SensorSeriesStore::Daily);
+        QCOMPARE(days.size(), 3);
+        QCOMPARE(days.at(0).count, 23);
+        QCOMPARE(days.at(0).min, 0.0);
+        QCOMPARE(days.at(0).max, 23.0);
+        QCOMPARE(days.at(0).sum, 271.0);
+        QCOMPARE(days.at(1).mean(), 35.5);
+
+        const QVector<SeriesBucket> months = store.querySeries(1, start, end, SensorSeriesStore::Monthly);
+        QCOMPARE(months.size(), 2);
+        QCOMPARE(months.at(0).count, 47);
+        QCOMPARE(months.at(1).start, SensorSeries::parseTimestamp("2025-02-01 00:00:00"));
+        QCOMPARE(months.at(1).mean(), 59.5);
+
+        // Przedział pomiarów wyznaczany wyszukiwaniem binarnym, bez pustych pomiarów
+        QCOMPARE(store.querySeries(1, start + 4 * 3600, start + 6 * 3600, SensorSeriesStore::Raw).size(), 2);
+        QCOMPARE(store.querySeries(1, start + 24 * 3600, end, SensorSeriesStore::Daily).size(), 2);
+        SensorSeriesStore::Resolution used = SensorSeriesStore::Monthly;
+        QCOMPARE(store.querySeries(1, 0, end, SensorSeriesStore::Auto, &used).size(), 71);
+        QCOMPARE(used, SensorSeriesStore::Raw);
+
+        // Poprawka i nowa doba przeliczają tylko swoje okresy
+        SensorSeries update;
+        update.append(start + 48 * 3600, 1000.0);
+        update.append(start + 72 * 3600, 10.0);
+        QCOMPARE(store.mergeSeries(1, update), 2);
+        SeriesRollup rebuilt;
+        rebuilt.build(*store.series(1));
+        const SeriesRollup *rollup = store.rollup(1);
+        QCOMPARE(rollup->daily().size(), 4);
+        QCOMPARE(rollup->daily().at(2).max, 1000.0);
+        QCOMPARE(rollup->monthly().at(1).count, 25);
+        const auto sameBuckets = [](const QVector<SeriesBucket> &a, const QVector<SeriesBucket> &b) {
+            return std::equal(a.cbegin(), a.cend(), b.cbegin(), b.cend(), [](const SeriesBucket &x, const SeriesBucket &y) {
+                return x.start == y.start && x.sum == y.sum && x.min == y.min && x.max == y.max && x.count == y.count;
+            });
+        };
+        QVERIFY(sameBuckets(rollup->daily(), rebuilt.daily()));
+        QVERIFY(sameBuckets(rollup->monthly(), rebuilt.monthly()));
+
+        const QVariantMap forQml = store.seriesInRange(1, start * 1000.0, (end + 3600) * 1000.0, SensorSeriesStore::Monthly);
+        QCOMPARE(forQml["resolution"].toInt(), int(SensorSeriesStore::Monthly));
+        QCOMPARE(forQml["counts"].value<QList<int>>(), QList<int>({ 47, 25 }));
+
+        store.remove(1);
+        QVERIFY(!store.rollup(1));
+        QVERIFY(store.querySeries(1, start, end, SensorSeriesStore::Daily).isEmpty());
+    }
+
+    /**
+     * @brief Testuje zmniejszanie szeregu algorytmem LTTB.
+     *
+     * Sprawdza liczbę punktów, zachowanie skrajnych punktów i pojedynczego szczytu.
+     */
+    void testChartDownsampling()
+    {
+        QVector<QPointF> points;
+        for (int i = 0; i < 1000; ++i)
+            points.append(QPointF(i, i == 437 ? 500.0 : 10.0));
+
+        const QVector<QPointF> sampled = SensorChart::downsampleLttb(points, 100);
+        QCOMPARE(sampled.size(), 100);
+        QCOMPARE(sampled.first(), points.first());
+        QCOMPARE(sampled.last(), points.last());
+        QVERIFY(sampled.contains(QPointF(437, 500.0)));
+        for (int i = 1; i < sampled.size(); ++i)
+            QVERIFY(sampled.at(i - 1).x() < sampled.at(i).x());
+
+        QCOMPARE(SensorChart::downsampleLttb(points.mid(0, 50), 100).size(), 50);
+    }
+
+    /**
+     * @brief Testuje znaczniki osi czasu wykresu.
+     *
+     * Sprawdza krok dni i godzin dla kilku dni, znaczniki miesięcy dla pół roku i lat dla
+     * dziesięciu lat, których liczba zależy od szerokości, a nie od długości zakresu.
+     */
+    void testChartTimeTicks()
+    {
+        const auto countDates = [](const QVariantList &ticks) {
+            int dates = 0;
+            for (const QVariant &tick : ticks)
+                dates += tick.toMap().value("isDate").toBool() ? 1 : 0;
+            return dates;
+        };
+
+        const qint64 start = SensorSeries::parseTimestamp("2025-04-21 00:00:00");
+        const QVariantList days = SensorChart::timeTicksFor(start, start + 3 * 86400, 600);
+        QCOMPARE(countDates(days), 4);
+        QCOMPARE(days.size(), 4 + 13);
+        QCOMPARE(days.first().toMap().value("label").toString(), QString("21.04.25"));
+        QCOMPARE(days.first().toMap().value("x").toDouble(), 0.0);
+
+        const QVariantList months = SensorChart::timeTicksFor(SensorSeries::parseTimestamp("2025-01-15 00:00:00"),
+                                                              SensorSeries::parseTimestamp("2025-07-15 00:00:00"), 600);
+        QCOMPARE(months.size(), 6);
+        QCOMPARE(countDates(months), 6);
+        QCOMPARE(months.first().toMap().value("label").toString(), QString("02.2025"));
+
+        const QVariantList years = SensorChart::timeTicksFor(SensorSeries::parseTimestamp("2015-01-01 00:00:00"),
+                                                             SensorSeries::parseTimestamp("2025-01-01 00:00:00"), 800);
+        QCOMPARE(years.size(), 11);
+        QCOMPARE(years.first().toMap().value("label").toString(), QString("2015"));
+        QCOMPARE(years.last().toMap().value("label").toString(), QString("2025"));
+
+        QVERIFY(SensorChart::timeTicksFor(start, start, 600).isEmpty());
+    }
+
+    /**
+     * @brief Dane benchmarku parsowania katalogu: cały dokument lub strumień fragmentów.
+     */
+    void benchmarkCatalogParsing_data()
+    {
+        QTest::addColumn<bool>("streamed");
+        QTest::newRow("dokument") << false;
+        QTest::newRow("strumień") << true;
+    }
+
+    /**
+     * @brief Mierzy parsowanie katalogu kBenchmarkStations stacji.
+     *
+     * Wariant strumieniowy podaje treść fragmentami po 16 KiB, jak przy pobieraniu.
+     */
+    void benchmarkCatalogParsing()
+    {
+        QFETCH(bool, streamed);
+        const QByteArray body = StubHttpServer::catalogJson(kBenchmarkStations);
+
+        int parsed = 0;
+        QBENCHMARK {
+            if (streamed) {
+                StationCatalogStream stream;
+                for (qsizetype offset = 0; offset < body.size(); offset += 16 * 1024)
+                    stream.feed(body.mid(offset, 16 * 1024));
+                QVERIFY(stream.finish());
+                parsed = stream.records().size();
+            } else {
+                parsed = ReplyParser::stationsFromJson(body).size();
+            }
+        }
+        QCOMPARE(parsed, kBenchmarkStations);
+    }
+
+    /**
+     * @brief Mierzy wyszukiwanie miast i podpowiedzi w indeksie tekstowym.
+     */
+    void benchmarkCitySearch()
+    {
+        QList<StationSearchIndex::Record> records;
+        const QList<StationRecord> catalog = ReplyParser::stationsFromJson(StubHttpServer::catalogJson(kBenchmarkStations));
+        for (const StationRecord &record : catalog)
+            records.append({ record.stationId, record.stationName, record.cityName, record.address });
+        StationSearchIndex index;
+        index.build(records);
+
+        QStringList cities;
+        for (int city = 1; city <= 100; ++city)
+            cities.append(QString("Miasto %1").arg(city));
+
+        int matches = 0;
+        QBENCHMARK {
+            matches = 0;
+            for (const QString &city : std::as_const(cities))
+                matches += index.stationsInCity(city).size();
+            matches += index.suggest("miasto 1", 10).size();
+        }
+        QCOMPARE(matches, 100 * 4 + 10);
+    }
+
+    /**
+     * @brief Mierzy wyszukiwanie najbliższych stacji w indeksie przestrzennym.
+     */
+    void benchmarkNearestStation()
+    {
+        QList<StationSpatialIndex::Point> points;
+        const QList<StationRecord> catalog = ReplyParser::stationsFromJson(StubHttpServer::catalogJson(kBenchmarkStations));
+        for (const StationRecord &record : catalog)
+            points.append({ record.stationId, record.lat, record.lon });
+        StationSpatialIndex index;
+        index.build(points);
+
+        int found = 0;
+        QBENCHMARK {
+            found = 0;
+            for (double lat = 49.0; lat < 55.0; lat += 0.5) {
+                for (double lon = 14.0; lon < 24.5; lon += 0.5)
+                    found += index.nearest(lat, lon, 5).size();
+            }
+        }
+        QCOMPARE(found, 12 * 21 * 5);
+    }
+
+    /**
+     * @brief Mierzy zapytania o grupy stacji przy przesuwaniu mapy na kilku przybliżeniach.
+     */
+    void benchmarkClusterViewport()
+    {
+        QList<StationClusterIndex::Point> points;
+        const QList<StationRecord> catalog = ReplyParser::stationsFromJson(StubHttpServer::catalogJson(kBenchmarkStations));
+        for (const StationRecord &record : catalog)
+            points.append({ record.stationId, record.lat, record.lon });
+        StationClusterIndex index;
+        index.build(points);
+
+        int markers = 0;
+        QBENCHMARK {
+            markers = 0;
+            for (int zoom = 6; zoom <= 10; ++zoom) {
+                const double span = 360.0 / (1 << zoom) * 4;
+                for (double lon = 14.0; lon < 24.5; lon += span / 8)
+                    markers += index.clusters(lon, 51.0, lon + span, 51.0 + span / 2, zoom).size();
+            }
+        }
+        QVERIFY(markers > 0);
+    }
+
+    /**
+     * @brief Mierzy wyznaczenie pola stężeń nad Polską metodą IDW.
+     *
+     * Pomiary pochodzą z 300 stacji, czyli więcej niż mierzy PM10 w sieci GIOŚ.
+     */
+    void benchmarkPollutantRaster()
+    {
+        QList<FieldSample> samples;
+        const QList<StationRecord> catalog = ReplyParser::stationsFromJson(StubHttpServer::catalogJson(kBenchmarkStations));
+        for (int i = 0; i < qMin(300, catalog.size()); ++i)
+            samples.append({ catalog.at(i).stationId, catalog.at(i).lat, catalog.at(i).lon, 10.0 + catalog.at(i).stationId % 70 });
+        const RasterGrid grid = PollutantRasterEngine::defaultGrid();
+
+        QSharedPointer<PollutantRaster> raster;
+        QBENCHMARK {
+            raster = PollutantRasterEngine::compute("PM10", 0, PollutantRasterEngine::InverseDistance,
+                                                    AirQualityIndex::Polish, samples, grid);
+        }
+        QCOMPARE(raster->tiles.size(), grid.tileCount());
+    }
+
+    /**
+     * @brief Mierzy zapytanie o rok pomiarów godzinowych w rozdzielczości wybranej automatycznie.
+     *
+     * Zamiast 8760 pomiarów zapytanie zwraca 365 gotowych agregatów dobowych.
+     */
+    void benchmarkSeriesQuery()
+    {
+        const qint64 start = SensorSeries::parseTimestamp("2024-04-24 00:00:00");
+        SensorSeries year;
+        for (int hour = 0; hour < 365 * 24; ++hour)
+            year.append(start + hour * 3600, 20.0 + hour % 17, hour % 97 == 0);
+        SensorSeriesStore store;
+        store.setSeries(1, year);
+
+        QVector<SeriesBucket> buckets;
+        QBENCHMARK {
+            buckets = store.querySeries(1, start, start + 365 * 86400 - 1, SensorSeriesStore::Auto);
+        }
+        QCOMPARE(buckets.size(), 365);
+    }
+
+    /**
+     * @brief Mierzy budowę macierzy porównania 50 stacji z rocznych szeregów godzinowych.
+     *
+     * Dane są już lokalne, więc mierzone jest tylko wyrównanie, podsumowanie i ranking.
+     */
+    void benchmarkStationComparison()
+    {
+        const qint64 start = SensorSeries::parseTimestamp("2024-04-24 00:00:00");
+        const int hours = 365 * 24;
+        QList<ComparisonInput> inputs;
+        for (int station = 0; station < 50; ++station) {
+            ComparisonInput input;
+            input.stationId = station + 1;
+            input.sensorId = station + 1000;
+            for (int hour = 0; hour < hours; ++hour)
+                input.series.append(start + hour * 3600, 10.0 + (hour + station) % 60, (hour + station) % 89 == 0);
+            inputs.append(input);
+        }
+
+        QSharedPointer<ComparisonMatrix> matrix;
+        QBENCHMARK {
+            matrix = StationComparison::build("PM10", inputs, start, hours);
+        }
+        QCOMPARE(matrix->rowCount(), 50);
+        QVERIFY(matrix->rows.first().rank > 0);
+    }
+
+    /**
+     * @brief Mierzy wczytanie rocznego szeregu godzinowego z odpowiedzi API do magazynu.
+     */
+    void benchmarkSensorIngest()
+    {
+        const qint64 start = SensorSeries::parseTimestamp("2024-04-24 00:00:00");
+        SensorSeries year;
+        for (int hour = 0; hour < 365 * 24; ++hour)
+            year.append(start + hour * 3600, 20.0 + hour % 17, hour % 97 == 0);
+        const QByteArray body = StubHttpServer::seriesJson("PM10", year);
+
+        SensorSeriesStore store;
+        QBENCHMARK {
+            store.setSeries(1, ReplyParser::seriesFromJson(body));
+        }
+        QCOMPARE(store.size(1), year.size());
+    }
+
+    /**
+     * @brief Dane benchmarku archiwum: format JSON i zwarty format binarny.
+     */
+    void benchmarkArchiveSaveLoad_data()
+    {
+        QTest::addColumn<bool>("compact");
+        QTest::newRow("json") << false;
+        QTest::newRow("gar") << true;
+    }
+
+    /**
+     * @brief Mierzy zapis i odczyt pliku archiwalnego stacji z nagranego pliku station_515.
+     */
+    void benchmarkArchiveSaveLoad()
+    {
+        QFETCH(bool, compact);
+        StationArchiveData data;
+        QVERIFY(StationArchive::load(QFINDTESTDATA("testdata/station_515_20250424_142935.json"), data));
+
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString path = dir.filePath(StationArchive::fileName(data.stationId, QDateTime::currentDateTime(), compact));
+        StationArchiveData loaded;
+        QBENCHMARK {
+            QVERIFY(StationArchive::save(path, data));
+            QVERIFY(StationArchive::load(path, loaded));
+        }
+        QCOMPARE(loaded.sensors.size(), data.sensors.size());
+    }
+
+private:
+    /// Liczba stacji katalogu serwowanego obiektom MainWindow.
+    static constexpr int kCatalogStations = 200;
+
+    /// Liczba stacji katalogu w benchmarkach (rząd wielkości rzeczywistego katalogu GIOŚ).
+    static constexpr int kBenchmarkStations = 2000;
+
+    /**
+     * @brief Buduje rekord stacji o nazwie "Stacja <id>".
+     * @param stationId Identyfikator stacji.
+     * @param cityName Nazwa miasta.
+     * @param lat Szerokość geograficzna.
+     * @param lon Długość geograficzna.
+     * @param address Adres stacji.
+     * @return Rekord katalogu.
+     */
+    static StationRecord stationRecord(int stationId, const QString &cityName, double lat, double lon,
+                                       const QString &address = QString())
+    {
+        StationRecord record;
+        record.stationId = stationId;
+        record.stationName = QString("Stacja %1").arg(stationId);
+        record.cityName = cityName;
+        record.address = address;
+        record.lat = lat;
+        record.lon = lon;
+        return record;
+    }
+
+    StubHttpServer m_server;  ///< Lokalny serwer zastępujący API GIOŚ i Nominatim.
 };
 
 QTEST_MAIN(TestMainWindow)